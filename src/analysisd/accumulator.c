@@ -243,6 +243,7 @@ void Accumulate_CleanUp(OSHash **acm_store, int *acm_lookups, time_t *acm_purge_
     int expired = 0;
 
     OSHashNode *curr;
+    OSHashNode *next;
     OS_ACM_Store *stored_data;
     char *key;
     unsigned int ti;
@@ -264,28 +265,25 @@ void Accumulate_CleanUp(OSHash **acm_store, int *acm_lookups, time_t *acm_purge_
     *acm_purge_ts = current_ts;
 
     /* Loop through the hash */
-    for (ti = 0; ti < (*acm_store)->rows; ti++) {
-        curr = (*acm_store)->table[ti];
-        while ( curr != NULL ) {
-            /* Get the Key and Data */
-            key  = (char *) curr->key;
-            stored_data = (OS_ACM_Store *) curr->data;
-            /* Increment to the next element */
-            curr = curr->next;
-
-            mdebug2("accumulator: DEBUG: CleanUp() evaluating cached key: %s ", key);
-            /* Check for a valid element */
-            if ( stored_data != NULL ) {
-                /* Check for expiration */
-                mdebug2("accumulator: DEBUG: CleanUp() elm:%ld, curr:%ld", (long int)stored_data->timestamp, (long int)current_ts);
-                if ( stored_data->timestamp < current_ts - OS_ACM_EXPIRE_ELM ) {
-                    mdebug2("accumulator: DEBUG: CleanUp() Expiring '%s'", key);
-                    if (OSHash_Delete_ex(*acm_store, key) != NULL) {
-                        FreeACMStore(stored_data);
-                        expired++;
-                    } else {
-                        mdebug1("accumulator: DEBUG: CleanUp() failed to find key '%s'", key);
-                    }
+    for (curr = OSHash_Begin(*acm_store, &ti); curr != NULL; curr = next) {
+        /* Get the Key and Data */
+        key  = (char *) curr->key;
+        stored_data = (OS_ACM_Store *) curr->data;
+        /* Increment to the next element */
+        next = OSHash_Next(*acm_store, &ti, curr);
+
+        mdebug2("accumulator: DEBUG: CleanUp() evaluating cached key: %s ", key);
+        /* Check for a valid element */
+        if ( stored_data != NULL ) {
+            /* Check for expiration */
+            mdebug2("accumulator: DEBUG: CleanUp() elm:%ld, curr:%ld", (long int)stored_data->timestamp, (long int)current_ts);
+            if ( stored_data->timestamp < current_ts - OS_ACM_EXPIRE_ELM ) {
+                mdebug2("accumulator: DEBUG: CleanUp() Expiring '%s'", key);
+                if (OSHash_Delete_ex(*acm_store, key) != NULL) {
+                    FreeACMStore(stored_data);
+                    expired++;
+                } else {
+                    mdebug1("accumulator: DEBUG: CleanUp() failed to find key '%s'", key);
                 }
             }
         }
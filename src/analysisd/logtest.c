@@ -12,6 +12,19 @@
 
 
 OSHash *w_logtest_sessions;
+w_logtest_ruleset_t *w_logtest_ruleset;
+
+/* Protect the latest ruleset and the references to the rulesets */
+static pthread_mutex_t w_logtest_ruleset_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* Sessions created while a ruleset is built wait for it instead of building their own */
+static pthread_mutex_t w_logtest_ruleset_build_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static int w_logtest_rule_compare(const void * a, const void * b);
+static int w_logtest_rule_index(const w_logtest_ruleset_t * ruleset, const RuleInfo * rule);
+static void w_logtest_rules_collect(const RuleNode * node, w_logtest_rule_t * rules, unsigned int * size);
+static RuleNode * w_logtest_rule_nodes_copy(const w_logtest_ruleset_t * ruleset, const RuleNode * node, RuleInfo ** rules);
+static void w_logtest_rule_nodes_free(RuleNode * node);
 
 
 void *w_logtest_init() {
@@ -290,12 +303,12 @@ void w_logtest_decoding_phase(Eventinfo * lf, w_logtest_session_t * session) {
     OSDecoderNode * decodernode = NULL;
 
     if (lf->program_name) {
-        decodernode = session->decoderlist_forpname;
+        decodernode = session->ruleset->decoderlist_forpname;
     } else {
-        decodernode = session->decoderlist_nopname;
+        decodernode = session->ruleset->decoderlist_nopname;
     }
 
-    DecodeEvent(lf, session->g_rules_hash, &session->decoder_match, decodernode);
+    DecodeEvent(lf, session->ruleset->g_rules_hash, &session->decoder_match, decodernode);
 }
 
 
@@ -323,7 +336,7 @@ int w_logtest_rulesmatching_phase(Eventinfo * lf, w_logtest_session_t * session,
 
         /* Search the rule that match */
         ruleinformation = OS_CheckIfRuleMatch(lf, session->eventlist,
-                                              &session->cdblistnode, rulenode,
+                                              &session->ruleset->cdblistnode, rulenode,
                                               &session->rule_match,
                                               &session->fts_list,
                                               &session->fts_store, false,
@@ -394,11 +407,8 @@ int w_logtest_rulesmatching_phase(Eventinfo * lf, w_logtest_session_t * session,
 w_logtest_session_t * w_logtest_initialize_session(OSList * list_msg) {
 
     w_logtest_session_t * session = NULL;
-    _Config ruleset_config = {0};
     bool retval = true;
 
-    char ** files = NULL;
-
     /*Generate session token*/
     char *token = w_logtest_generate_token();
 
@@ -419,137 +429,424 @@ w_logtest_session_t * w_logtest_initialize_session(OSList * list_msg) {
     os_calloc(1, sizeof(EventList), session->eventlist);
     OS_CreateEventList(Config.memorysize, session->eventlist);
 
+    /* Get the decoders, CDB lists and rules */
+    if (session->ruleset = w_logtest_ruleset_get(list_msg), !session->ruleset) {
+        goto cleanup;
+    }
+
+    session->eventlist->_max_freq = session->ruleset->max_freq;
+
+    /* Copy the rules, which keep the state of the session */
+    w_logtest_session_rules_create(session);
+
+    /* Initiate the FTS list */
+    if (!w_logtest_fts_init(&session->fts_list, &session->fts_store)) {
+        goto cleanup;
+    }
+
+    /* Initialize the Accumulator */
+    if (!Accumulate_Init(&session->acm_store, &session->acm_lookups, &session->acm_purge_ts)) {
+        goto cleanup;
+    }
+
+    /* Set rule_match and decoder_match to zero */
+    memset(&session->decoder_match, 0, sizeof(regex_matching));
+    memset(&session->rule_match, 0, sizeof(regex_matching));
+
+    /* Set custom level for alerts */
+    session->logbylevel = session->ruleset->logbylevel;
+
+    retval = false;
+
+cleanup:
+
+    if (retval) {
+
+        /* Remove list of previous events */
+        os_remove_eventlist(session->eventlist);
+
+        /* Remove the rules of the session and release the ruleset */
+        w_logtest_session_rules_free(session);
+        w_logtest_ruleset_release(session->ruleset);
+
+        /* Remove fts list and hash */
+        if (session->fts_store) {
+            OSHash_Free(session->fts_store);
+        }
+        os_free(session->fts_list);
+
+        /* Remove accumulator hash */
+        if (session->acm_store) {
+            OSHash_Free(session->acm_store);
+        }
+
+        /* Free memory allocated in OSRegex execution */
+        OSRegex_free_regex_matching(&session->decoder_match);
+        OSRegex_free_regex_matching(&session->rule_match);
+
+        /* Remove session */
+        w_mutex_destroy(&session->mutex);
+        os_free(token);
+        os_free(session);
+    }
+
+    return session;
+}
+
+w_logtest_ruleset_t * w_logtest_ruleset_get(OSList * list_msg) {
+
+    w_logtest_ruleset_t * ruleset = NULL;
+    _Config ruleset_config = {0};
+    char * version;
+
     /* Get ruleset files */
     if (!w_logtest_ruleset_load(&ruleset_config, list_msg)) {
-        goto cleanup;
+        w_logtest_ruleset_free_config(&ruleset_config);
+        return NULL;
     }
 
-    /* Load decoders */
-    session->decoderlist_forpname = NULL;
-    session->decoderlist_nopname = NULL;
-    session->decoder_store = NULL;
+    version = w_logtest_ruleset_version(&ruleset_config);
+
+    w_mutex_lock(&w_logtest_ruleset_build_mutex);
+
+    w_mutex_lock(&w_logtest_ruleset_mutex);
+    if (w_logtest_ruleset && strcmp(w_logtest_ruleset->version, version) == 0) {
+        ruleset = w_logtest_ruleset;
+        ruleset->references++;
+    }
+    w_mutex_unlock(&w_logtest_ruleset_mutex);
 
-    files = ruleset_config.decoders;
+    /* The files have changed, build the new version of the ruleset */
+    if (!ruleset && (ruleset = w_logtest_ruleset_build(&ruleset_config, list_msg), ruleset)) {
+        ruleset->version = version;
+        ruleset->references = 2;
+        version = NULL;
+
+        /* The sessions of the previous version keep it until they are removed */
+        w_mutex_lock(&w_logtest_ruleset_mutex);
+        if (w_logtest_ruleset && --w_logtest_ruleset->references == 0) {
+            w_logtest_ruleset_free(w_logtest_ruleset);
+        }
+        w_logtest_ruleset = ruleset;
+        w_mutex_unlock(&w_logtest_ruleset_mutex);
+    }
+
+    w_mutex_unlock(&w_logtest_ruleset_build_mutex);
+
+    os_free(version);
+    w_logtest_ruleset_free_config(&ruleset_config);
+
+    return ruleset;
+}
+
+w_logtest_ruleset_t * w_logtest_ruleset_build(_Config * ruleset_config, OSList * list_msg) {
+
+    w_logtest_ruleset_t * ruleset = NULL;
+    EventList eventlist = {0};
+    EventList * last_events = &eventlist;
+    bool retval = true;
+
+    char ** files = NULL;
+
+    os_calloc(1, sizeof(w_logtest_ruleset_t), ruleset);
+
+    /* Load decoders */
+    files = ruleset_config->decoders;
 
     while (files != NULL && *files != NULL) {
-        if (ReadDecodeXML(*files, &session->decoderlist_forpname,
-            &session->decoderlist_nopname, &session->decoder_store, list_msg) == 0) {
+        if (ReadDecodeXML(*files, &ruleset->decoderlist_forpname,
+            &ruleset->decoderlist_nopname, &ruleset->decoder_store, list_msg) == 0) {
             goto cleanup;
         }
         files++;
     }
 
-    if (SetDecodeXML(list_msg, &session->decoder_store, &session->decoderlist_nopname, 
-                     &session->decoderlist_forpname) == 0) {
+    if (SetDecodeXML(list_msg, &ruleset->decoder_store, &ruleset->decoderlist_nopname,
+                     &ruleset->decoderlist_forpname) == 0) {
         goto cleanup;
     }
 
     /* Load CDB list */
-    session->cdblistnode = NULL;
-    session->cdblistrule = NULL;
-
-    files = ruleset_config.lists;
+    files = ruleset_config->lists;
 
     while (files != NULL && *files != NULL) {
-        if (Lists_OP_LoadList(*files, &session->cdblistnode, list_msg) < 0) {
+        if (Lists_OP_LoadList(*files, &ruleset->cdblistnode, list_msg) < 0) {
             goto cleanup;
         }
         files++;
     }
 
-    Lists_OP_MakeAll(0, 0, &session->cdblistnode);
-
-    /* Load rules */
-    session->rule_list = NULL;
+    Lists_OP_MakeAll(0, 0, &ruleset->cdblistnode);
 
-    files = ruleset_config.includes;
+    /* Load rules. The event list only gets the highest frequency of the rules */
+    files = ruleset_config->includes;
 
     while (files != NULL && *files != NULL) {
-        if (Rules_OP_ReadRules(*files, &session->rule_list, &session->cdblistnode,
-                            &session->eventlist, &session->decoder_store, list_msg) < 0) {
+        if (Rules_OP_ReadRules(*files, &ruleset->rule_list, &ruleset->cdblistnode,
+                            &last_events, &ruleset->decoder_store, list_msg) < 0) {
             goto cleanup;
         }
         files++;
     }
 
     /* Associate rules and CDB lists */
-    OS_ListLoadRules(&session->cdblistnode, &session->cdblistrule);
+    OS_ListLoadRules(&ruleset->cdblistnode, &ruleset->cdblistrule);
 
     /* _setlevels */
-    _setlevels(session->rule_list, 0);
+    _setlevels(ruleset->rule_list, 0);
 
     /* Creating rule hash */
-    if (session->g_rules_hash = OSHash_Create(), !session->g_rules_hash) {
+    if (ruleset->g_rules_hash = OSHash_Create(), !ruleset->g_rules_hash) {
         goto cleanup;
     }
 
-    AddHash_Rule(session->rule_list);
-
-    /* Initiate the FTS list */
-    if (!w_logtest_fts_init(&session->fts_list, &session->fts_store)) {
-        goto cleanup;
-    }
+    AddHash_Rule(ruleset->rule_list);
 
-    /* Initialize the Accumulator */
-    if (!Accumulate_Init(&session->acm_store, &session->acm_lookups, &session->acm_purge_ts)) {
-        goto cleanup;
-    }
+    /* Index the rules to copy them for the sessions */
+    w_logtest_ruleset_index(ruleset);
 
-    /* Set rule_match and decoder_match to zero */
-    memset(&session->decoder_match, 0, sizeof(regex_matching));
-    memset(&session->rule_match, 0, sizeof(regex_matching));
+    ruleset->max_freq = eventlist._max_freq;
 
     /* Set custom level for alerts */
-    session->logbylevel = ruleset_config.logbylevel;
+    ruleset->logbylevel = ruleset_config->logbylevel;
 
     retval = false;
 
 cleanup:
 
     if (retval) {
+        w_logtest_ruleset_free(ruleset);
+        ruleset = NULL;
+    }
 
-        /* Remove list of previous events */
-        os_remove_eventlist(session->eventlist);
+    return ruleset;
+}
+
+void w_logtest_ruleset_release(w_logtest_ruleset_t * ruleset) {
+
+    if (!ruleset) {
+        return;
+    }
 
-        /* Remove rule list and rule hash */
-        os_remove_rules_list(session->rule_list);
-        if (session->g_rules_hash) {
-            OSHash_Free(session->g_rules_hash);
+    w_mutex_lock(&w_logtest_ruleset_mutex);
+
+    if (--ruleset->references == 0) {
+        w_logtest_ruleset_free(ruleset);
+    }
+
+    w_mutex_unlock(&w_logtest_ruleset_mutex);
+}
+
+void w_logtest_ruleset_free(w_logtest_ruleset_t * ruleset) {
+
+    /* Remove rule list and rule hash */
+    os_remove_rules_list(ruleset->rule_list);
+    if (ruleset->g_rules_hash) {
+        OSHash_Free(ruleset->g_rules_hash);
+    }
+
+    /* Remove decoder lists */
+    os_remove_decoders_list(ruleset->decoderlist_forpname, ruleset->decoderlist_nopname);
+    if (ruleset->decoder_store != NULL) {
+        OSStore_Free(ruleset->decoder_store);
+    }
+
+    /* Remove cdblistnode and cdblistrule */
+    os_remove_cdblist(&ruleset->cdblistnode);
+    os_remove_cdbrules(&ruleset->cdblistrule);
+
+    /* Remove the index of the rules */
+    for (unsigned int i = 0; i < ruleset->rules_size; i++) {
+        os_free(ruleset->rules[i].group_prev_matched);
+    }
+    os_free(ruleset->rules);
+
+    os_free(ruleset->version);
+    os_free(ruleset);
+}
+
+char * w_logtest_ruleset_version(const _Config * ruleset_config) {
+
+    char ** const files_lists[] = { ruleset_config->decoders, ruleset_config->lists, ruleset_config->includes };
+    char entry[PATH_MAX + 64];
+    char * version = NULL;
+    size_t length = 0;
+    struct stat file_stat;
+    int entry_length;
+
+    entry_length = snprintf(entry, sizeof(entry), "%u", (unsigned int) ruleset_config->logbylevel);
+    os_strdup(entry, version);
+    length = entry_length;
+
+    for (unsigned int i = 0; i < sizeof(files_lists) / sizeof(files_lists[0]); i++) {
+        for (char ** files = files_lists[i]; files != NULL && *files != NULL; files++) {
+
+            if (stat(*files, &file_stat) == 0) {
+                entry_length = snprintf(entry, sizeof(entry), "\n%s %lld %lld", *files,
+                                        (long long) file_stat.st_mtime, (long long) file_stat.st_size);
+            } else {
+                entry_length = snprintf(entry, sizeof(entry), "\n%s", *files);
+            }
+
+            if (entry_length < 0 || (size_t) entry_length >= sizeof(entry)) {
+                entry_length = strlen(entry);
+            }
+
+            os_realloc(version, length + entry_length + 1, version);
+            memcpy(version + length, entry, entry_length + 1);
+            length += entry_length;
         }
+    }
+
+    return version;
+}
+
+void w_logtest_ruleset_index(w_logtest_ruleset_t * ruleset) {
 
-        /* Remove decoder lists */
-        os_remove_decoders_list(session->decoderlist_forpname, session->decoderlist_nopname);
-        if (session->decoder_store != NULL) {
-            OSStore_Free(session->decoder_store);
+    w_logtest_rule_t * rules = NULL;
+    unsigned int size = 0;
+    int num_nodes = 0;
+
+    os_count_rules(ruleset->rule_list, &num_nodes);
+
+    if (num_nodes == 0) {
+        return;
+    }
+
+    os_calloc(num_nodes, sizeof(w_logtest_rule_t), rules);
+    w_logtest_rules_collect(ruleset->rule_list, rules, &size);
+
+    /* A rule which has several parents is in several nodes */
+    qsort(rules, size, sizeof(w_logtest_rule_t), w_logtest_rule_compare);
+
+    ruleset->rules_size = 0;
+
+    for (unsigned int i = 0; i < size; i++) {
+        if (ruleset->rules_size == 0 || rules[ruleset->rules_size - 1].rule != rules[i].rule) {
+            rules[ruleset->rules_size++] = rules[i];
         }
+    }
 
-        /* Remove cdblistnode and cdblistrule */
-        os_remove_cdblist(&session->cdblistnode);
-        os_remove_cdbrules(&session->cdblistrule);
+    ruleset->rules = rules;
 
-        /* Remove fts list and hash */
-        if (session->fts_store) {
-            OSHash_Free(session->fts_store);
+    /* Find the owners of the lists of previous events */
+    for (unsigned int i = 0; i < ruleset->rules_size; i++) {
+        RuleInfo * rule = rules[i].rule;
+
+        rules[i].sid_search = -1;
+
+        if (rule->group_prev_matched) {
+            os_calloc(rule->group_prev_matched_sz, sizeof(int), rules[i].group_prev_matched);
         }
-        os_free(session->fts_list);
 
-        /* Remove accumulator hash */
-        if (session->acm_store) {
-            OSHash_Free(session->acm_store);
+        for (unsigned int k = 0; k < rule->group_prev_matched_sz; k++) {
+            rules[i].group_prev_matched[k] = -1;
         }
 
-        /* Free memory allocated in OSRegex execution */
-        OSRegex_free_regex_matching(&session->decoder_match);
-        OSRegex_free_regex_matching(&session->rule_match);
+        for (unsigned int j = 0; j < ruleset->rules_size; j++) {
+            RuleInfo * owner = rules[j].rule;
 
-        /* Remove session */
-        w_mutex_destroy(&session->mutex);
-        os_free(token);
-        os_free(session);
+            if (rule->sid_search && rule->sid_search == owner->sid_prev_matched) {
+                rules[i].sid_search = j;
+            }
+
+            for (unsigned int k = 0; owner->group_search && k < rule->group_prev_matched_sz; k++) {
+                if (rule->group_prev_matched[k] == owner->group_search) {
+                    rules[i].group_prev_matched[k] = j;
+                }
+            }
+        }
     }
-    w_logtest_ruleset_free_config(&ruleset_config);
+}
 
-    return session;
+void w_logtest_session_rules_create(w_logtest_session_t * session) {
+
+    const w_logtest_ruleset_t * ruleset = session->ruleset;
+
+    if (ruleset->rules_size == 0) {
+        return;
+    }
+
+    os_calloc(ruleset->rules_size, sizeof(RuleInfo *), session->rules);
+
+    /* Copy the rules with empty counters and lists of previous events */
+    for (unsigned int i = 0; i < ruleset->rules_size; i++) {
+        const RuleInfo * rule = ruleset->rules[i].rule;
+        RuleInfo * copy;
+
+        os_malloc(sizeof(RuleInfo), copy);
+        *copy = *rule;
+
+        copy->firedtimes = 0;
+        copy->time_ignored = 0;
+        copy->mutex = (pthread_mutex_t) PTHREAD_MUTEX_INITIALIZER;
+        copy->prev_rule = NULL;
+        copy->sid_prev_matched = NULL;
+        copy->sid_search = NULL;
+        copy->group_prev_matched = NULL;
+        copy->group_search = NULL;
+
+        if (rule->sid_prev_matched && (copy->sid_prev_matched = OSList_Create(), !copy->sid_prev_matched)) {
+            merror_exit(MEM_ERROR, errno, strerror(errno));
+        }
+
+        if (rule->group_search && (copy->group_search = OSList_Create(), !copy->group_search)) {
+            merror_exit(MEM_ERROR, errno, strerror(errno));
+        }
+
+        session->rules[i] = copy;
+    }
+
+    /* Point the copies to the lists of the copies */
+    for (unsigned int i = 0; i < ruleset->rules_size; i++) {
+        const w_logtest_rule_t * indexed = &ruleset->rules[i];
+        RuleInfo * copy = session->rules[i];
+
+        if (indexed->sid_search >= 0) {
+            copy->sid_search = session->rules[indexed->sid_search]->sid_prev_matched;
+        }
+
+        if (indexed->rule->group_prev_matched) {
+            unsigned int size = 0;
+
+            os_calloc(indexed->rule->group_prev_matched_sz + 1, sizeof(OSList *), copy->group_prev_matched);
+
+            for (unsigned int k = 0; k < indexed->rule->group_prev_matched_sz; k++) {
+                if (indexed->group_prev_matched[k] >= 0) {
+                    copy->group_prev_matched[size++] = session->rules[indexed->group_prev_matched[k]]->group_search;
+                }
+            }
+
+            copy->group_prev_matched_sz = size;
+        }
+    }
+
+    session->rule_list = w_logtest_rule_nodes_copy(ruleset, ruleset->rule_list, session->rules);
+}
+
+void w_logtest_session_rules_free(w_logtest_session_t * session) {
+
+    w_logtest_rule_nodes_free(session->rule_list);
+    session->rule_list = NULL;
+
+    if (!session->rules) {
+        return;
+    }
+
+    /* The rest of the copy belongs to the ruleset */
+    for (unsigned int i = 0; i < session->ruleset->rules_size; i++) {
+        RuleInfo * copy = session->rules[i];
+
+        if (copy->group_search) {
+            OSList_Destroy(copy->group_search);
+        }
+
+        os_free(copy->sid_prev_matched);
+        os_free(copy->group_prev_matched);
+        os_free(copy);
+    }
+
+    os_free(session->rules);
 }
 
 void w_logtest_remove_session(char *token) {
@@ -568,17 +865,9 @@ void w_logtest_remove_session(char *token) {
     /* Remove list of previous events */
     os_remove_eventlist(session->eventlist);
 
-    /* Remove rule list and rule hash */
-    os_remove_rules_list(session->rule_list);
-    OSHash_Free(session->g_rules_hash);
-
-    /* Remove decoder lists */
-    os_remove_decoders_list(session->decoderlist_forpname, session->decoderlist_nopname);
-    OSStore_Free(session->decoder_store);
-
-    /* Remove cdblistnode and cdblistrule */
-    os_remove_cdblist(&session->cdblistnode);
-    os_remove_cdbrules(&session->cdblistrule);
+    /* Remove the rules of the session and release the ruleset */
+    w_logtest_session_rules_free(session);
+    w_logtest_ruleset_release(session->ruleset);
 
     /* Remove fts list and hash */
     OSHash_Free(session->fts_store);
@@ -1298,3 +1587,66 @@ void w_logtest_ruleset_free_config (_Config * ruleset_config) {
 
     return;
 }
+
+static int w_logtest_rule_compare(const void * a, const void * b) {
+
+    uintptr_t rule_a = (uintptr_t) ((const w_logtest_rule_t *) a)->rule;
+    uintptr_t rule_b = (uintptr_t) ((const w_logtest_rule_t *) b)->rule;
+
+    return (rule_a > rule_b) - (rule_a < rule_b);
+}
+
+static int w_logtest_rule_index(const w_logtest_ruleset_t * ruleset, const RuleInfo * rule) {
+
+    w_logtest_rule_t key = { .rule = (RuleInfo *) rule };
+    w_logtest_rule_t * found;
+
+    found = bsearch(&key, ruleset->rules, ruleset->rules_size, sizeof(w_logtest_rule_t), w_logtest_rule_compare);
+
+    return found ? (int) (found - ruleset->rules) : -1;
+}
+
+static void w_logtest_rules_collect(const RuleNode * node, w_logtest_rule_t * rules, unsigned int * size) {
+
+    while (node) {
+        rules[(*size)++].rule = node->ruleinfo;
+
+        if (node->child) {
+            w_logtest_rules_collect(node->child, rules, size);
+        }
+
+        node = node->next;
+    }
+}
+
+static RuleNode * w_logtest_rule_nodes_copy(const w_logtest_ruleset_t * ruleset, const RuleNode * node, RuleInfo ** rules) {
+
+    RuleNode * first = NULL;
+    RuleNode ** last = &first;
+
+    while (node) {
+        os_calloc(1, sizeof(RuleNode), *last);
+        (*last)->ruleinfo = rules[w_logtest_rule_index(ruleset, node->ruleinfo)];
+
+        if (node->child) {
+            (*last)->child = w_logtest_rule_nodes_copy(ruleset, node->child, rules);
+        }
+
+        last = &(*last)->next;
+        node = node->next;
+    }
+
+    return first;
+}
+
+static void w_logtest_rule_nodes_free(RuleNode * node) {
+
+    RuleNode * next;
+
+    while (node) {
+        w_logtest_rule_nodes_free(node->child);
+        next = node->next;
+        os_free(node);
+        node = next;
+    }
+}
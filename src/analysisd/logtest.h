@@ -79,22 +79,53 @@
 
 
 /**
- * @brief A w_logtest_session_t instance represents a client
+ * @brief A rule of the shared ruleset and the rules whose lists of previous events it uses
  */
-typedef struct w_logtest_session_t {
+typedef struct w_logtest_rule_t {
 
-    char *token;                            ///< Client ID
-    time_t last_connection;                 ///< Timestamp of the last query
-    pthread_mutex_t mutex;                  ///< Prevent race condition between get a session and remove it
+    RuleInfo *rule;                         ///< Rule of the ruleset
+    int sid_search;                         ///< Rule whose sid_prev_matched list is the sid_search list, -1 if none
+    int *group_prev_matched;                ///< Rules whose group_search lists are the group_prev_matched lists
+
+} w_logtest_rule_t;
 
+/**
+ * @brief Decoders, CDB lists and rules shared by the sessions
+ *
+ * A ruleset is built once per version of its files and it is not modified afterwards.
+ * Each session works on its own copy of the rules, which holds the state of the stateful rules.
+ */
+typedef struct w_logtest_ruleset_t {
+
+    char *version;                          ///< Ruleset files with their size and modification time
+    unsigned int references;                ///< Sessions using the ruleset, plus one while it is the latest
     RuleNode *rule_list;                    ///< Rule list
     OSDecoderNode *decoderlist_forpname;    ///< Decoder list to match logs which have a program name
     OSDecoderNode *decoderlist_nopname;     ///< Decoder list to match logs which haven't a program name
     OSStore *decoder_store;                 ///< Decoder list to save internals decoders
     ListNode *cdblistnode;                  ///< List of CDB lists
     ListRule *cdblistrule;                  ///< List to attach rules and CDB lists
-    EventList *eventlist;                   ///< Previous events list
     OSHash *g_rules_hash;                   ///< Hash table of rules
+    w_logtest_rule_t *rules;                ///< Rules of the rule list without repetitions, sorted by address
+    unsigned int rules_size;                ///< Number of rules
+    int max_freq;                           ///< Highest frequency of the rules
+    u_int8_t logbylevel;                    ///< Custom severity level for generate alerts
+
+} w_logtest_ruleset_t;
+
+/**
+ * @brief A w_logtest_session_t instance represents a client
+ */
+typedef struct w_logtest_session_t {
+
+    char *token;                            ///< Client ID
+    time_t last_connection;                 ///< Timestamp of the last query
+    pthread_mutex_t mutex;                  ///< Prevent race condition between get a session and remove it
+
+    w_logtest_ruleset_t *ruleset;           ///< Shared ruleset
+    RuleNode *rule_list;                    ///< Rule list, made of the session copies of the rules
+    RuleInfo **rules;                       ///< Session copies of the rules, in the order of the ruleset
+    EventList *eventlist;                   ///< Previous events list
     OSList *fts_list;                       ///< Save FTS previous events
     OSHash *fts_store;                      ///< Save FTS values processed
     OSHash *acm_store;                      ///< Hash to save data which have the same id
@@ -119,6 +150,11 @@ typedef struct {
  */
 extern OSHash *w_logtest_sessions;
 
+/**
+ * @brief Latest ruleset, used by the new sessions
+ */
+extern w_logtest_ruleset_t *w_logtest_ruleset;
+
 /**
  * @brief An instance of w_logtest_connection allow managing the connections with the logtest socket
  */
@@ -209,6 +245,61 @@ int w_logtest_rulesmatching_phase(Eventinfo * lf, w_logtest_session_t * session,
  */
 w_logtest_session_t *w_logtest_initialize_session(OSList * list_msg);
 
+/**
+ * @brief Get the latest ruleset, building it if the ruleset files have changed
+ * @param list_msg list of \ref os_analysisd_log_msg_t for store messages
+ * @return NULL on failure, otherwise the ruleset. It must be released with w_logtest_ruleset_release
+ */
+w_logtest_ruleset_t * w_logtest_ruleset_get(OSList * list_msg);
+
+/**
+ * @brief Load the decoders, CDB lists and rules of the ruleset files
+ * @param ruleset_config List files of ruleset
+ * @param list_msg list of \ref os_analysisd_log_msg_t for store messages
+ * @return NULL on failure, otherwise the ruleset
+ */
+w_logtest_ruleset_t * w_logtest_ruleset_build(_Config * ruleset_config, OSList * list_msg);
+
+/**
+ * @brief Release a ruleset got with w_logtest_ruleset_get. It's freed when nothing uses it
+ * @param ruleset ruleset to release
+ */
+void w_logtest_ruleset_release(w_logtest_ruleset_t * ruleset);
+
+/**
+ * @brief Frees a ruleset
+ * @param ruleset ruleset to free
+ */
+void w_logtest_ruleset_free(w_logtest_ruleset_t * ruleset);
+
+/**
+ * @brief Describe the ruleset files with their size and modification time
+ * @param ruleset_config List files of ruleset
+ * @return string which changes when any ruleset file changes
+ */
+char * w_logtest_ruleset_version(const _Config * ruleset_config);
+
+/**
+ * @brief Index the rules of a ruleset and the rules whose lists of previous events they use
+ * @param ruleset ruleset to index
+ */
+void w_logtest_ruleset_index(w_logtest_ruleset_t * ruleset);
+
+/**
+ * @brief Copy the rules of the session ruleset, with empty state
+ *
+ * The copies share everything with the ruleset rules but the counters and the lists of previous events
+ *
+ * @param session client session
+ */
+void w_logtest_session_rules_create(w_logtest_session_t * session);
+
+/**
+ * @brief Frees the session copies of the rules
+ * @param session client session
+ */
+void w_logtest_session_rules_free(w_logtest_session_t * session);
+
 /**
  * @brief Frees resources after client closes connection
  * @param token client identifier
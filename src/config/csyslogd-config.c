@@ -19,6 +19,7 @@ int Read_CSyslog(XML_NODE node, void *config, __attribute__((unused)) void *conf
     /* XML definitions */
     const char *xml_syslog_server = "server";
     const char *xml_syslog_port = "port";
+    const char *xml_syslog_protocol = "protocol";
     const char *xml_syslog_format = "format";
     const char *xml_syslog_level = "level";
     const char *xml_syslog_id = "rule_id";
@@ -47,6 +48,7 @@ int Read_CSyslog(XML_NODE node, void *config, __attribute__((unused)) void *conf
     syslog_config[s]->location = NULL;
     syslog_config[s]->level = 0;
     syslog_config[s]->port = 514;
+    syslog_config[s]->protocol = IPPROTO_UDP;
     syslog_config[s]->format = DEFAULT_CSYSLOG;
     syslog_config[s]->use_fqdn = 0;
     /* local 0 facility (16) + severity 4 - warning. --default */
@@ -73,6 +75,16 @@ int Read_CSyslog(XML_NODE node, void *config, __attribute__((unused)) void *conf
             }
 
             syslog_config[s]->port = (unsigned int) atoi(node[i]->content);
+        } else if (strcmp(node[i]->element, xml_syslog_protocol) == 0) {
+            if (strcasecmp(node[i]->content, "udp") == 0) {
+                syslog_config[s]->protocol = IPPROTO_UDP;
+            } else if (strcasecmp(node[i]->content, "tcp") == 0) {
+                /* Octet-counted stream (RFC 6587) */
+                syslog_config[s]->protocol = IPPROTO_TCP;
+            } else {
+                merror(XML_VALUEERR, node[i]->element, node[i]->content);
+                goto fail;
+            }
         } else if (strcmp(node[i]->element, xml_syslog_server) == 0) {
             os_strdup(node[i]->content, syslog_config[s]->server);
         } else if (strcmp(node[i]->element, xml_syslog_id) == 0) {
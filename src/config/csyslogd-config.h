@@ -13,15 +13,19 @@
 #ifndef CSYSLOGCONFIG_H
 #define CSYSLOGCONFIG_H
 
+struct csyslog_buffer;
+
 /* Database config structure */
 typedef struct _SyslogConfig {
     unsigned int port;
+    unsigned int protocol;
     unsigned int format;
     unsigned int level;
     unsigned int *rule_id;
     unsigned int priority;
     unsigned int use_fqdn;
     int socket;
+    struct csyslog_buffer *buffer;
 
     char *server;
     OSMatch *group;
@@ -25,6 +25,7 @@ int Read_Integrator(XML_NODE node, void *config, __attribute__((unused)) void *c
     char *xml_integrator_location = "event_location";
     char *xml_integrator_max_log = "max_log";
     char *xml_integrator_alert_format = "alert_format";
+    char *xml_integrator_persistent = "persistent";
 
     IntegratorConfig **integrator_config = *(IntegratorConfig ***)config;
 
@@ -52,6 +53,7 @@ int Read_Integrator(XML_NODE node, void *config, __attribute__((unused)) void *c
     integrator_config[s]->level = 0;
     integrator_config[s]->enabled = 0;
     integrator_config[s]->max_log = 165;
+    integrator_config[s]->persistent = 0;
 
     while(node[i])
     {
@@ -178,6 +180,15 @@ int Read_Integrator(XML_NODE node, void *config, __attribute__((unused)) void *c
                 merror(XML_VALUEERR,node[i]->element, node[i]->content);
                 return(OS_INVALID);
             }
+        } else if (strcmp(node[i]->element, xml_integrator_persistent) == 0) {
+            if (strcmp(node[i]->content, "yes") == 0) {
+                integrator_config[s]->persistent = 1;
+            } else if (strcmp(node[i]->content, "no") == 0) {
+                integrator_config[s]->persistent = 0;
+            } else {
+                merror(XML_VALUEERR,node[i]->element, node[i]->content);
+                return(OS_INVALID);
+            }
         } else
         {
             merror(XML_INVELEM, node[i]->element);
@@ -24,6 +24,7 @@ typedef struct _IntegratorConfig
     unsigned int enabled;
     unsigned int *rule_id;
     unsigned int max_log;
+    unsigned int persistent;    // Feed alerts to a long-lived worker
 
     char *name;
     char *apikey;
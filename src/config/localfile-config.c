@@ -55,6 +55,8 @@ int Read_Localfile(XML_NODE node, void *d1, __attribute__((unused)) void *d2)
     const char *xml_localfile_exclude = "exclude";
     const char *xml_localfile_binaries = "ignore_binaries";
     const char *xml_localfile_multiline_regex =  "multiline_regex";
+    const char *xml_localfile_filter = "filter";
+    const char *xml_localfile_filter_field_attr = "field";
 
     logreader *logf;
     logreader_config *log_config;
@@ -365,6 +367,10 @@ int Read_Localfile(XML_NODE node, void *d1, __attribute__((unused)) void *d2)
                 }
 #endif
 
+            } else if (strcmp(logf[pl].logformat, JOURNALD) == 0) {
+                if (logf[pl].journald_log == NULL) {
+                    os_calloc(1, sizeof(w_journald_config_t), logf[pl].journald_log);
+                }
             } else {
                 merror(XML_VALUEERR, node[i]->element, node[i]->content);
                 return (OS_INVALID);
@@ -387,11 +393,38 @@ int Read_Localfile(XML_NODE node, void *d1, __attribute__((unused)) void *d2)
                 logf[pl].multiline->match_type = w_get_attr_match(node[i]);
                 logf[pl].multiline->replace_type = w_get_attr_replace(node[i]);
                 logf[pl].multiline->timeout = w_get_attr_timeout(node[i]);
+                logf[pl].multiline->match_data = w_expression_create_match_data(logf[pl].multiline->regex);
+                logf[pl].multiline->start_prefix = w_multiline_get_start_prefix(node[i]->content,
+                                                                                &logf[pl].multiline->start_prefix_only);
+                if (logf[pl].multiline->start_prefix != NULL) {
+                    logf[pl].multiline->start_prefix_len = strlen(logf[pl].multiline->start_prefix);
+                }
 
             } else {
                 mwarn("Duplicate tag '%s' is ignored", xml_localfile_multiline_regex);
             }
 
+        } else if (strcasecmp(node[i]->element, xml_localfile_filter) == 0) {
+            const char * field = w_get_attr_val_by_name(node[i], xml_localfile_filter_field_attr);
+
+            if (field == NULL || *field == '\0' || strchr(field, '=') != NULL) {
+                mwarn(LOGCOLLECTOR_JOURNALD_INV_FILTER, node[i]->content);
+            } else {
+                int n = 0;
+
+                if (logf[pl].journald_log == NULL) {
+                    os_calloc(1, sizeof(w_journald_config_t), logf[pl].journald_log);
+                }
+                while (logf[pl].journald_log->filters != NULL && logf[pl].journald_log->filters[n] != NULL) {
+                    n++;
+                }
+
+                /* sd-journal matches are "FIELD=value" */
+                os_realloc(logf[pl].journald_log->filters, (n + 2) * sizeof(char *), logf[pl].journald_log->filters);
+                os_malloc(strlen(field) + strlen(node[i]->content) + 2, logf[pl].journald_log->filters[n]);
+                sprintf(logf[pl].journald_log->filters[n], "%s=%s", field, node[i]->content);
+                logf[pl].journald_log->filters[n + 1] = NULL;
+            }
         } else if (strcasecmp(node[i]->element, xml_localfile_exclude) == 0) {
             if (logf[pl].exclude) {
                 os_free(logf[pl].exclude);
@@ -472,6 +505,10 @@ int Read_Localfile(XML_NODE node, void *d1, __attribute__((unused)) void *d2)
             mwarn(LOGCOLLECTOR_MISSING_LOCATION_MACOS);
             // Neceesary to check duplicated blocks
             os_strdup(MACOS, logf[pl].file);
+        } else if (strcmp(logf[pl].logformat, JOURNALD) == 0) {
+            mwarn(LOGCOLLECTOR_MISSING_LOCATION_JOURNALD);
+            // Neceesary to check duplicated blocks
+            os_strdup(JOURNALD, logf[pl].file);
         } else {
             merror(MISS_FILE);
             os_strdup("", logf[pl].file);
@@ -515,6 +552,48 @@ int Read_Localfile(XML_NODE node, void *d1, __attribute__((unused)) void *d2)
             mwarn(LOGCOLLECTOR_OPTION_IGNORED, MACOS, xml_localfile_alias);
         }
     }
+    /* Verify journald config */
+    if (strcmp(logf[pl].logformat, JOURNALD) == 0) {
+
+        if (strcmp(logf[pl].file, JOURNALD) != 0) {
+            /* Invalid journald configuration */
+            mwarn(LOGCOLLECTOR_INV_JOURNALD, logf[pl].file);
+            os_free(logf[pl].file);
+            // Neceesary to check duplicated blocks
+            w_strdup(JOURNALD, logf[pl].file);
+        }
+
+        if (logf[pl].reconnect_time != DEFAULT_EVENTCHANNEL_REC_TIME) {
+            mwarn(LOGCOLLECTOR_OPTION_IGNORED, JOURNALD, xml_localfile_reconnect_time);
+        }
+        if (logf[pl].age != 0) {
+            mwarn(LOGCOLLECTOR_OPTION_IGNORED, JOURNALD, xml_localfile_age);
+        }
+        if (logf[pl].filter_binary != 0) {
+            mwarn(LOGCOLLECTOR_OPTION_IGNORED, JOURNALD, xml_localfile_binaries);
+        }
+        if (logf[pl].exclude != NULL) {
+            mwarn(LOGCOLLECTOR_OPTION_IGNORED, JOURNALD, xml_localfile_exclude);
+        }
+        if (logf[pl].multiline != NULL) {
+            mwarn(LOGCOLLECTOR_OPTION_IGNORED, JOURNALD, xml_localfile_multiline_regex);
+        }
+        if (logf[pl].labels != NULL) {
+            mwarn(LOGCOLLECTOR_OPTION_IGNORED, JOURNALD, xml_localfile_label);
+        }
+        if (logf[pl].ign != DEFAULT_FREQUENCY_SECS) {
+            mwarn(LOGCOLLECTOR_OPTION_IGNORED, JOURNALD, xml_localfile_frequency);
+        }
+        if (logf[pl].alias != NULL) {
+            mwarn(LOGCOLLECTOR_OPTION_IGNORED, JOURNALD, xml_localfile_alias);
+        }
+    } else if (logf[pl].journald_log != NULL) {
+        /* Only log format journald supports filter */
+        mwarn(LOGCOLLECTOR_OPTION_IGNORED, logf[pl].logformat, xml_localfile_filter);
+        free_strarray(logf[pl].journald_log->filters);
+        os_free(logf[pl].journald_log);
+    }
+
     /* Verify Multiline Regex Config */
     if (strcmp(logf[pl].logformat, MULTI_LINE_REGEX) == 0) {
 
@@ -533,8 +612,7 @@ int Read_Localfile(XML_NODE node, void *d1, __attribute__((unused)) void *d2)
     } else if (logf[pl].multiline) {
         /* Only log format multi-line-regex support multiline_regex */
         mwarn(LOGCOLLECTOR_MULTILINE_SUPPORT, logf[pl].logformat);
-        w_free_expression_t(&logf[pl].multiline->regex);
-        os_free(logf[pl].multiline);
+        w_multiline_config_free(&logf[pl].multiline);
     }
 
         /* Verify a valid event log config */
@@ -745,6 +823,11 @@ void Free_Logreader(logreader * logf) {
         os_free(logf->exclude);
         os_free(logf->query_level);
 
+        if (logf->journald_log) {
+            free_strarray(logf->journald_log->filters);
+            os_free(logf->journald_log);
+        }
+
         if (logf->target) {
             for (i = 0; logf->target[i]; i++) {
                 free(logf->target[i]);
@@ -796,6 +879,11 @@ int Remove_Localfile(logreader **logf, int i, int gl, int fr, logreader_glob *gl
             #endif
             }
 
+            /* Each file of a glob owns a copy of the multiline configuration */
+            if (gl) {
+                w_multiline_config_free(&(*logf)[i].multiline);
+            }
+
             for (x = i; x < size; x++) {
                 memcpy(&(*logf)[x], &(*logf)[x + 1], sizeof(logreader));
             }
@@ -889,6 +977,108 @@ unsigned int w_get_attr_timeout(xml_node * node) {
     return retval;
 }
 
+char * w_multiline_get_start_prefix(const char * pattern, bool * literal_only) {
+
+    const char * metachars = "\\^$.[]|()?*+{}";
+    char * prefix = NULL;
+    size_t len = 0;
+    const char * ptr;
+    char literal;
+
+    *literal_only = false;
+
+    if (pattern == NULL || *pattern != '^' || strchr(pattern, '|') != NULL) {
+        return NULL;
+    }
+
+    os_calloc(strlen(pattern), sizeof(char), prefix);
+
+    for (ptr = pattern + 1; *ptr != '\0';) {
+        if (*ptr == '\\' && ispunct((unsigned char) ptr[1])) {
+            /* Escaped metacharacter */
+            literal = ptr[1];
+            ptr += 2;
+        } else if (*ptr == '\\' || strchr(metachars, *ptr) != NULL) {
+            /* Character class, group or assertion */
+            break;
+        } else {
+            literal = *ptr++;
+        }
+
+        /* A quantified atom may not be present, or may repeat */
+        if (*ptr == '?' || *ptr == '*' || *ptr == '{') {
+            break;
+        }
+
+        prefix[len++] = literal;
+
+        if (*ptr == '+') {
+            break;
+        }
+    }
+
+    if (len == 0) {
+        os_free(prefix);
+        return NULL;
+    }
+
+    *literal_only = (*ptr == '\0');
+    return prefix;
+}
+
+w_multiline_config_t * w_multiline_config_clone(const w_multiline_config_t * ml_cfg) {
+
+    w_multiline_config_t * clone = NULL;
+
+    if (ml_cfg == NULL) {
+        return NULL;
+    }
+
+    os_calloc(1, sizeof(w_multiline_config_t), clone);
+    w_calloc_expression_t(&clone->regex, EXP_TYPE_PCRE2);
+
+    /* The pattern was already compiled, so only a lack of memory can make it fail */
+    if (!w_expression_compile(clone->regex, ml_cfg->regex->pcre2->raw_pattern, 0)) {
+        merror_exit(MEM_ERROR, ENOMEM, strerror(ENOMEM));
+    }
+
+    clone->match_type = ml_cfg->match_type;
+    clone->replace_type = ml_cfg->replace_type;
+    clone->timeout = ml_cfg->timeout;
+    clone->match_data = w_expression_create_match_data(clone->regex);
+
+    if (ml_cfg->start_prefix != NULL) {
+        os_strdup(ml_cfg->start_prefix, clone->start_prefix);
+        clone->start_prefix_len = ml_cfg->start_prefix_len;
+        clone->start_prefix_only = ml_cfg->start_prefix_only;
+    }
+
+    return clone;
+}
+
+void w_multiline_config_free(w_multiline_config_t ** ml_cfg) {
+
+    if (ml_cfg == NULL || *ml_cfg == NULL) {
+        return;
+    }
+
+    w_free_expression_t(&(*ml_cfg)->regex);
+
+    if ((*ml_cfg)->match_data != NULL) {
+        pcre2_match_data_free((*ml_cfg)->match_data);
+    }
+
+    if ((*ml_cfg)->ctxt != NULL) {
+        os_free((*ml_cfg)->ctxt->buffer);
+        os_free((*ml_cfg)->ctxt);
+    }
+
+    os_free((*ml_cfg)->start_prefix);
+    os_free((*ml_cfg)->pending_line);
+    os_free((*ml_cfg)->raw_data);
+    os_free(*ml_cfg);
+}
+
 const char * multiline_attr_replace_str(w_multiline_replace_type_t replace_type) {
     const char * const replace_str[ML_REPLACE_MAX] = {"no-replace", "none", "wspace", "tab"};
     return replace_str[replace_type];
@@ -14,6 +14,7 @@
 #define EVENTLOG     "eventlog"
 #define EVENTCHANNEL "eventchannel"
 #define MACOS        "macos"
+#define JOURNALD     "journald"
 #define MULTI_LINE_REGEX              "multi-line-regex"
 #define MULTI_LINE_REGEX_TIMEOUT      5
 #define MULTI_LINE_REGEX_MAX_TIMEOUT  120
@@ -101,6 +102,7 @@ typedef enum {
 typedef struct {
     int lines_count;   ///< number of readed lines from a multiline log
     char * buffer;     ///< backup buffer. Contains readed line so far
+    size_t size;       ///< allocated size of the backup buffer
     time_t timestamp;  ///< last successful read
 } w_multiline_ctxt_t;
 
@@ -115,6 +117,14 @@ typedef struct {
     unsigned int timeout;
     w_multiline_ctxt_t * ctxt; ///< store current status when multiline log is in process
     int64_t offset_last_read;  ///< absolut file offset of last complete multiline log processed
+    char * start_prefix;       ///< literal text that the anchored regex requires at the beginning. NULL if none
+    size_t start_prefix_len;   ///< length of start_prefix
+    bool start_prefix_only;    ///< the regex is just the anchored literal prefix, so it does not need to run
+    pcre2_match_data * match_data; ///< PCRE2 match block reused on every line of this reader
+    char * pending_line;       ///< line read ahead that starts the next log (match="start")
+    char * raw_data;           ///< unmodified content read since offset_last_read, used to update the file hash
+    size_t raw_len;            ///< length of raw_data
+    size_t raw_size;           ///< allocated size of raw_data
 } w_multiline_config_t;
 
 typedef enum _w_macos_log_state_t {
@@ -165,6 +175,14 @@ typedef struct {
     bool store_current_settings;        ///< True if current_settings is stored in vault
 } w_macos_log_config_t;
 
+/**
+ * @brief An instance of w_journald_config_t represents the state of the systemd journal reader
+ */
+typedef struct {
+    char ** filters;    ///< Field matches ("FIELD=value") applied by the journal before reading entries
+    void * journal;     ///< sd_journal handle. NULL if the journal could not be opened
+} w_journald_config_t;
+
 /* Logreader config */
 typedef struct _logreader {
     off_t size;
@@ -187,6 +205,7 @@ typedef struct _logreader {
     char *logformat;
     w_multiline_config_t * multiline; ///< Multiline regex config & state
     w_macos_log_config_t * macos_log;   ///< macOS log config & state
+    w_journald_config_t * journald_log; ///< systemd journal config & state
     long linecount;
     char *djb_program_name;
     char * channel_str;
@@ -215,6 +234,7 @@ typedef struct _logreader {
 
     FILE *fp;
     fpos_t position; // Pointer offset when closed
+    bool compressed; ///< The file is gzip-compressed and fp reads its decompressed content
 } logreader;
 
 typedef struct _logreader_glob {
@@ -268,6 +288,34 @@ w_multiline_replace_type_t w_get_attr_replace(xml_node * node);
  */
 unsigned int w_get_attr_timeout(xml_node * node);
 
+/**
+ * @brief Get the literal text that an anchored regex requires at the beginning of the subject
+ *
+ * Only patterns starting with `^` and without alternations are considered. Escaped punctuation
+ * is taken as literal and the extraction stops at the first metacharacter or quantified atom.
+ * @param pattern PCRE2 pattern
+ * @param literal_only output parameter, true if the whole pattern is the anchored literal
+ * @return allocated literal prefix. NULL if the pattern has no literal prefix
+ */
+char * w_multiline_get_start_prefix(const char * pattern, bool * literal_only);
+
+/**
+ * @brief Copy a multiline configuration for a file matched by a glob
+ *
+ * The copy gets its own compiled regex and match block, and an empty reading state
+ * (backup context, line read ahead and raw data), so that files of the same glob
+ * do not share it.
+ * @param ml_cfg multiline configuration of the glob
+ * @return allocated copy. NULL if ml_cfg is NULL
+ */
+w_multiline_config_t * w_multiline_config_clone(const w_multiline_config_t * ml_cfg);
+
+/**
+ * @brief Free a multiline configuration and its reading state
+ * @param ml_cfg multiline configuration to free. It is set to NULL
+ */
+void w_multiline_config_free(w_multiline_config_t ** ml_cfg);
+
 /**
  * @brief Get replace type in string format
  * @param replace_type replace type of multiline matching
@@ -35,6 +35,7 @@ typedef struct _monitor_config {
     int keep_log_days;
     unsigned long size_rotate;
     int daily_rotations;
+    int rotation_threads;
 
     char *smtpserver;
     char *emailfrom;
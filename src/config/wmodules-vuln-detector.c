@@ -63,6 +63,7 @@ static const char *XML_UPDATE_INTERVAL = "update_interval";
 static const char *XML_RUN_ON_START = "run_on_start";
 static const char *XML_MIN_FULL_SCAN_INTERVAL = "min_full_scan_interval";
 static const char *XML_RETRY_INTERVAL = "retry_interval";
+static const char *XML_SCAN_WORKERS = "scan_workers";
 static const char *XML_URL = "url";
 static const char *XML_PATH = "path";
 static const char *XML_PORT = "port";
@@ -467,6 +468,7 @@ int Read_Vuln(const OS_XML *xml, xml_node **nodes, void *d1, char d2) {
     vuldet->flags.enabled = 1;
     vuldet->min_full_scan_interval = VU_DEF_MIN_FULL_SCAN_INTERVAL;
     vuldet->retry_interval = VU_DEF_RETRY_INTERVAL;
+    vuldet->scan_workers = VU_DEF_SCAN_WORKERS;
     vuldet->scan_interval = WM_VULNDETECTOR_DEFAULT_INTERVAL;
     vuldet->scan_agents = NULL;
     cur_wmodule->context = &WM_VULNDETECTOR_CONTEXT;
@@ -536,6 +538,14 @@ int Read_Vuln(const OS_XML *xml, xml_node **nodes, void *d1, char d2) {
                 merror("Invalid retry_interval at module '%s'", WM_VULNDETECTOR_CONTEXT.name);
                 return OS_INVALID;
             }
+        } else if (!strcmp(nodes[i]->element, XML_SCAN_WORKERS)) {
+            char * end;
+            long workers = strtol(nodes[i]->content, &end, 10);
+            if (*end != '\0' || workers < 1 || workers > VU_MAX_SCAN_WORKERS) {
+                merror("Invalid content for '%s' option at module '%s'. It must be between 1 and %d", XML_SCAN_WORKERS, WM_VULNDETECTOR_CONTEXT.name, VU_MAX_SCAN_WORKERS);
+                return OS_INVALID;
+            }
+            vuldet->scan_workers = (int) workers;
         } else {
             merror("No such tag '%s' at module '%s'", nodes[i]->element, WM_VULNDETECTOR_CONTEXT.name);
             return OS_INVALID;
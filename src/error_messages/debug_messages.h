@@ -102,6 +102,10 @@
 #define VU_DEP_FLAG           "(5493): Dependency '%s' is installed on agent '%.3d': Version (%s) '%s' '%s'"
 #define VU_DEP_PRESCAN_START  "(5494): Starting SUSE dependency analysis for agent '%.3d'"
 #define VU_DEP_PRESCAN_FINISH "(5495): Finished SUSE dependency analysis for agent '%.3d'"
+#define VU_FEED_UNCHANGED     "(5496): The content of the '%s' feed has not changed. Skipping its refresh."
+#define VU_PKG_HASHES_UPDATE  "(5497): The vulnerability conditions of '%d' packages changed in the '%s' feed."
+#define VU_AG_FEED_UNAFFECTED "(5498): No package of agent '%.3d' changed in the feeds since its last full scan. A partial scan will be run instead."
+#define VU_AG_FEED_PACKAGES   "(5499): Only the packages of agent '%.3d' that changed in the feeds since its last full scan will be scanned again, along with the new ones."
 
 /* File integrity monitoring debug messages */
 #define FIM_DIFF_SKIPPED                    "(6200): Diff execution skipped for containing insecure characters."
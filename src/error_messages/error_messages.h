@@ -235,6 +235,9 @@
 #define GET_FLAGS_ERROR "(1972): The flags couldn't be obtained from the file descriptor: %s (%d)."
 #define SET_FLAGS_ERROR "(1973): The flags couldn't be set in the file descriptor: %s (%d)."
 #define WPOPENV_ERROR   "(1974): An error ocurred while calling wpopenv(): %s (%d)."
+#define JOURNALD_LIB_ERROR  "(1975): Unable to load the systemd journal library '%s': %s"
+#define JOURNALD_OPEN_ERROR "(1976): Unable to open the systemd journal: %s (%d)."
+#define JOURNALD_READ_ERROR "(1977): Unable to read the systemd journal: %s (%d)."
 
 /* Encryption/auth errors */
 #define INVALID_KEY     "(1401): Error reading authentication key: '%s'."
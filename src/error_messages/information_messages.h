@@ -75,5 +75,6 @@
 /* Logcollector info messages */
 #define LOGCOLLECTOR_INVALID_HANDLE_VALUE   "(9200): File '%s' can not be handled."
 #define LOGCOLLECTOR_ONLY_MACOS             "(9201): 'macos' log format is only supported on macOS."
+#define LOGCOLLECTOR_ONLY_LINUX_JOURNALD    "(9202): 'journald' log format is only supported on Linux."
 
 #endif /* INFO_MESSAGES_H */
@@ -133,6 +133,11 @@
                                                 "'log_format'. Default value will be used."
 #define LOGCOLLECTOR_MISSING_LOCATION_MACOS     "(8006): Missing 'location' element when using 'macos' as " \
                                                 "'log_format'. Default value will be used."
+#define LOGCOLLECTOR_INV_JOURNALD               "(8007): Invalid location value '%s' when using 'journald' as " \
+                                                "'log_format'. Default value will be used."
+#define LOGCOLLECTOR_MISSING_LOCATION_JOURNALD  "(8008): Missing 'location' element when using 'journald' as " \
+                                                "'log_format'. Default value will be used."
+#define LOGCOLLECTOR_JOURNALD_INV_FILTER        "(8009): Invalid journald filter '%s'. Filter will be ignored."
 
 /* Remoted */
 #define REMOTED_NET_PROTOCOL_ERROR              "(9000): Error getting protocol. Default value (%s) will be used."
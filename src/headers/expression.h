@@ -102,6 +102,25 @@ bool w_expression_compile(w_expression_t * expression, char * pattern, int flags
 bool w_expression_match(w_expression_t * expression, const char * str_test, const char ** end_match,
                         regex_matching * regex_match);
 
+/**
+ * @brief Create a PCRE2 match block sized for the expression, to be reused across matches
+ * @param expression expression with compiled pattern
+ * @return match block, or NULL if the expression is not PCRE2
+ */
+pcre2_match_data * w_expression_create_match_data(w_expression_t * expression);
+
+/**
+ * @brief Test match a compiled pattern to string reusing a caller-owned PCRE2 match block
+ *
+ * Avoids allocating a match block on every call. Non PCRE2 expressions, or a NULL match block,
+ * fall back to w_expression_match().
+ * @param expression expression with compiled pattern
+ * @param str_test string to test
+ * @param match_data match block created by w_expression_create_match_data()
+ * @return true if match. false otherwise
+ */
+bool w_expression_match_ex(w_expression_t * expression, const char * str_test, pcre2_match_data * match_data);
+
 /**
  * @brief Fill a match_data with PCRE2 result
  * @param captured_groups number of matches of PCRE2 execute
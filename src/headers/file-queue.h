@@ -13,6 +13,7 @@
 
 #define MAX_FQUEUE  256
 #define FQ_TIMEOUT  5
+#define FQ_NOWAIT   0   /* Read_FileMon() timeout: try one read without waiting */
 
 /* File queue */
 typedef struct _file_queue {
@@ -26,6 +27,14 @@ typedef struct _file_queue {
 
     FILE *fp;
     struct stat f_status;
+
+    int notify;                 /* 1 if the file is watched, -1 if it cannot be watched */
+    int notify_fd;              /* inotify instance watching the file directory */
+
+    char *buffer;               /* Data read ahead from the file */
+    size_t buffer_start;        /* First byte not returned yet */
+    size_t buffer_end;          /* End of the data read */
+    int skip_line;              /* Discard data up to the end of an overlong line */
 } file_queue;
 
 #include "read-alert.h"
@@ -33,4 +42,18 @@ int Init_FileQueue(file_queue *fileq, const struct tm *p, int flags) __attribute
 
 alert_data *Read_FileMon(file_queue *fileq, const struct tm *p, unsigned int timeout) __attribute__((nonnull));
 
+/**
+ * @brief Wait until the file of the queue is written or replaced
+ *
+ * @param fileq File queue.
+ * @param timeout Maximum time to wait, in seconds.
+ * @retval 1 The file changed.
+ * @retval 0 The timeout expired.
+ * @retval -1 The file cannot be watched. The function returns at once.
+ */
+int Wait_FileQueue(file_queue *fileq, unsigned int timeout) __attribute__((nonnull));
+
+// Stop watching the file of the queue
+void Unwatch_FileQueue(file_queue *fileq) __attribute__((nonnull));
+
 #endif /* CFQUEUE_H */
@@ -14,6 +14,8 @@
 #define OS_HASHOP
 #include <pthread.h>
 
+#define OSHASH_STRIPES 16   // Bucket locks of a table, a power of two
+
 /* Node structure */
 typedef struct _OSHashNode {
     struct _OSHashNode *next;
@@ -21,10 +23,18 @@ typedef struct _OSHashNode {
 
     char *key;
     void *data;
+    unsigned int hash;      // Hash of the key, to skip comparisons and rehash
 } OSHashNode;
 
+/* The table doubles when it holds more elements than rows. The nodes of the
+ * previous table are moved by the following insertions, a few buckets each.
+ * The _ex calls share mutex and lock the stripe of their key, so that calls
+ * on different stripes run in parallel, even the writers. Holding mutex for
+ * reading does not keep them out: walking the table from outside needs mutex
+ * for writing, or OSHash_It_ex(), which also locks every stripe.
+ */
 typedef struct _OSHash {
-    unsigned int rows;
+    unsigned int rows;          // Buckets of table, a power of two
     unsigned int initial_seed;
     unsigned int constant;
     pthread_rwlock_t mutex;
@@ -32,6 +42,12 @@ typedef struct _OSHash {
 
     void (*free_data_function)(void *data);
     OSHashNode **table;
+
+    OSHashNode **old_table;     // Table being moved into table, or NULL
+    unsigned int old_rows;
+    unsigned int rehash_pending;                // Stripes with buckets left in old_table
+    unsigned int rehash_next[OSHASH_STRIPES];   // Old buckets of each stripe already moved
+    pthread_rwlock_t stripes[OSHASH_STRIPES];
 } OSHash;
 
 typedef enum _OSHash_results_codes {
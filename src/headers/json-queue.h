@@ -28,6 +28,12 @@ int jqueue_open(file_queue * queue, int tail);
  */
 cJSON * jqueue_next(file_queue * queue);
 
+/*
+ * Wait until new alerts are written or the file is rotated, for up to timeout seconds.
+ * If the file cannot be watched, sleep for one second.
+ */
+void jqueue_wait(file_queue * queue, unsigned int timeout);
+
 // Close queue
 void jqueue_close(file_queue * queue);
 
@@ -36,8 +42,8 @@ void jqueue_close(file_queue * queue);
  *
  * @param queue pointer to the file_queue struct
  * @post The flag variable may be set to CRALERT_READ_FAILED if the read operation got no data.
- * @post The read position is restored if failed to get a JSON object.
- * @retval NULL No data read or could not get a valid JSON object. Pointer to the JSON object otherwise.
+ * @post An incomplete alert is kept until the rest of the line is written.
+ * @retval NULL No data read or could not get a valid JSON object or read overlong alert. Pointer to the JSON object otherwise.
  */
 cJSON * jqueue_parse_json(file_queue * queue);
 
@@ -75,6 +75,7 @@ typedef struct _keystore {
     /* Key file stat */
     time_t file_change;
     ino_t inode;
+    off_t file_size;
 
     /* ID counter */
     int id_counter;
@@ -98,7 +99,7 @@ typedef enum key_states {
     KS_ENCKEY
 } key_states;
 
-#define KEYSTORE_INITIALIZER { NULL, NULL, NULL, NULL, 0, 0, 0, 0, { 0, 0 }, NULL, 0, NULL, PTHREAD_MUTEX_INITIALIZER }
+#define KEYSTORE_INITIALIZER { NULL, NULL, NULL, NULL, 0, 0, 0, 0, 0, { 0, 0 }, NULL, 0, NULL, PTHREAD_MUTEX_INITIALIZER }
 
 /** Function prototypes -- key management **/
 
@@ -137,6 +138,18 @@ int OS_DeleteKey(keystore *keys, const char *id, int purge);
 /* Write keystore on client keys file */
 int OS_WriteKeys(const keystore *keys);
 
+/**
+ * @brief Append key entries to the client keys file and their timestamps to
+ *        the timestamps file, without rewriting them
+ *
+ * @param entries Array of key entries.
+ * @param size Number of entries.
+ * @return Status of the operation.
+ * @retval 0 On success.
+ * @retval -1 On failure. The files may hold a partial line.
+ */
+int OS_AppendKeys(keyentry * const *entries, unsigned int size);
+
 /* Duplicate keystore except key hashes and file pointer */
 keystore* OS_DupKeys(const keystore *keys);
 
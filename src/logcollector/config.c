@@ -51,6 +51,7 @@ int LogCollectorConfig(const char *cfgfile)
     reload_delay = getDefine_Int("logcollector", "reload_delay", 0, 30000);
     free_excluded_files_interval = getDefine_Int("logcollector", "exclude_files_interval", 1, 172800);
     state_interval = getDefine_Int("logcollector", "state_interval", 0, 3600);
+    gzip_max_rate = getDefine_Int("logcollector", "gzip_max_rate", 0, 1048576);
 
     /* Current and total files counter */
     total_files = 0;
@@ -195,6 +196,13 @@ void _getLocalfilesListJSON(logreader *list, cJSON *array, int gl) {
             cJSON_AddNumberToObject(multiline, "timeout", list[i].multiline->timeout);
             cJSON_AddItemToObject(file, "multiline_regex", multiline);
         }
+        if (list[i].journald_log && list[i].journald_log->filters) {
+            cJSON *filter = cJSON_CreateArray();
+            for (j=0;list[i].journald_log->filters[j];j++) {
+                cJSON_AddItemToArray(filter, cJSON_CreateString(list[i].journald_log->filters[j]));
+            }
+            cJSON_AddItemToObject(file,"filter",filter);
+        }
         cJSON_AddItemToArray(array, file);
         i++;
     }
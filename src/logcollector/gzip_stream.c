@@ -0,0 +1,321 @@
+/* Copyright (C) 2015, Wazuh Inc.
+ * All right reserved.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation
+ */
+
+/* Read gzip-compressed files through a stdio stream */
+
+#include "shared.h"
+#include "logcollector.h"
+#include "gzip_stream.h"
+
+// Remove STATIC qualifier from tests
+#ifdef WAZUH_UNIT_TESTING
+#define STATIC
+#else
+#define STATIC static
+#endif
+
+#define GZIP_MAGIC_ID1  0x1f
+#define GZIP_MAGIC_ID2  0x8b
+
+#if defined(__linux__) || defined(Darwin) || defined(FreeBSD) || defined(OpenBSD) || defined(NetBSD)
+#define GZIP_STREAM_SUPPORT
+#endif
+
+#ifdef GZIP_STREAM_SUPPORT
+
+/**
+ * @brief Decompress the next chunk into the window, keeping the tail of the previous data
+ *
+ * @param stream gzip stream
+ * @return Number of new bytes, 0 on EOF or -1 on error
+ */
+STATIC int w_gzip_stream_refill(w_gzip_stream_t * stream) {
+
+    size_t keep = stream->length < GZIP_STREAM_HISTORY ? stream->length : GZIP_STREAM_HISTORY;
+
+    if (keep < stream->length) {
+        memmove(stream->buffer, stream->buffer + stream->length - keep, keep);
+        stream->base += stream->length - keep;
+        stream->length = keep;
+    }
+
+    int nbytes = gzread(stream->gz, stream->buffer + stream->length, GZIP_STREAM_CHUNK);
+
+    if (nbytes < 0) {
+        int gz_errnum = 0;
+        mdebug1("Cannot decompress gzip stream: %s", gzerror(stream->gz, &gz_errnum));
+        errno = EIO;
+        return -1;
+    }
+
+    stream->length += nbytes;
+    return nbytes;
+}
+
+/**
+ * @brief Get how many bytes may be delivered now according to `logcollector.gzip_max_rate`
+ *
+ * @param stream gzip stream
+ * @param size Bytes requested
+ * @return Bytes allowed, 0 if the budget for the current second is exhausted
+ */
+STATIC size_t w_gzip_stream_budget(w_gzip_stream_t * stream, size_t size) {
+
+    if (gzip_max_rate <= 0) {
+        return size;
+    }
+
+    time_t now = time(NULL);
+
+    if (now != stream->slot) {
+        stream->slot = now;
+        stream->slot_bytes = 0;
+    }
+
+    int64_t allowed = (int64_t)gzip_max_rate * 1024 - stream->slot_bytes;
+
+    if (allowed <= 0) {
+        return 0;
+    }
+
+    return (int64_t)size < allowed ? size : (size_t)allowed;
+}
+
+/**
+ * @brief Read callback: copy decompressed data from the window
+ *
+ * Returning 0 when the rate budget is exhausted makes the reader behave as on EOF, so it stops and
+ * rewinds to the last complete line, which is still in the window.
+ */
+STATIC ssize_t w_gzip_stream_read(void * cookie, char * buf, size_t size) {
+
+    w_gzip_stream_t * stream = cookie;
+
+    if (size = w_gzip_stream_budget(stream, size), size == 0) {
+        return 0;
+    }
+
+    if (stream->position >= stream->base + (int64_t)stream->length) {
+        int result = w_gzip_stream_refill(stream);
+
+        if (result <= 0) {
+            return result;
+        }
+    }
+
+    size_t available = stream->base + stream->length - stream->position;
+    size_t nbytes = size < available ? size : available;
+
+    memcpy(buf, stream->buffer + (stream->position - stream->base), nbytes);
+    stream->position += nbytes;
+    stream->slot_bytes += nbytes;
+
+    return nbytes;
+}
+
+/**
+ * @brief Seek callback: offsets refer to the decompressed data
+ *
+ * Targets inside the window are served from memory. Other forward targets are reached by
+ * inflating and discarding, and targets behind the window make zlib restart from the beginning.
+ */
+STATIC int w_gzip_stream_seek(void * cookie, int64_t * offset, int whence) {
+
+    w_gzip_stream_t * stream = cookie;
+    int64_t target;
+
+    switch (whence) {
+    case SEEK_SET:
+        target = *offset;
+        break;
+
+    case SEEK_CUR:
+        target = stream->position + *offset;
+        break;
+
+    case SEEK_END:
+        /* The decompressed size is only known after inflating the whole file */
+        for (;;) {
+            stream->position = stream->base + stream->length;
+            int result = w_gzip_stream_refill(stream);
+
+            if (result < 0) {
+                return -1;
+            } else if (result == 0) {
+                break;
+            }
+        }
+
+        target = stream->base + stream->length + *offset;
+        break;
+
+    default:
+        errno = EINVAL;
+        return -1;
+    }
+
+    if (target < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    if (target < stream->base || target > stream->base + (int64_t)stream->length) {
+        if (target < stream->base) {
+            mdebug2("Rewinding gzip stream to offset %" PRIi64 ". The file will be decompressed again.", target);
+        }
+
+        if (gzseek(stream->gz, target, SEEK_SET) < 0) {
+            errno = EIO;
+            return -1;
+        }
+
+        stream->base = target;
+        stream->length = 0;
+    }
+
+    stream->position = target;
+    *offset = target;
+
+    return 0;
+}
+
+STATIC int w_gzip_stream_close(void * cookie) {
+
+    w_gzip_stream_t * stream = cookie;
+    int result = gzclose(stream->gz) == Z_OK ? 0 : EOF;
+
+    os_free(stream->buffer);
+    os_free(stream);
+
+    return result;
+}
+
+#if !defined(__linux__)
+/* BSD funopen() callbacks */
+
+static int w_gzip_stream_read_bsd(void * cookie, char * buf, int size) {
+    return (int)w_gzip_stream_read(cookie, buf, (size_t)size);
+}
+
+static fpos_t w_gzip_stream_seek_bsd(void * cookie, fpos_t offset, int whence) {
+    int64_t position = offset;
+    return w_gzip_stream_seek(cookie, &position, whence) == 0 ? (fpos_t)position : -1;
+}
+#endif
+
+#endif /* GZIP_STREAM_SUPPORT */
+
+bool w_gzip_is_compressed(FILE * fp) {
+
+    unsigned char magic[2] = {0};
+    size_t nbytes = fread(magic, 1, sizeof(magic), fp);
+
+    rewind(fp);
+
+    return nbytes == sizeof(magic) && magic[0] == GZIP_MAGIC_ID1 && magic[1] == GZIP_MAGIC_ID2;
+}
+
+bool w_gzip_is_compressed_file(const char * path) {
+
+#ifdef GZIP_STREAM_SUPPORT
+    FILE * fp = fopen(path, "rb");
+
+    if (fp == NULL) {
+        return false;
+    }
+
+    bool compressed = w_gzip_is_compressed(fp);
+    fclose(fp);
+
+    return compressed;
+#else
+    /* Compressed files cannot be decompressed on the fly on this platform */
+    (void)path;
+    return false;
+#endif
+}
+
+FILE * w_gzip_fopen(const char * path) {
+
+#ifdef GZIP_STREAM_SUPPORT
+    w_gzip_stream_t * stream;
+    FILE * fp;
+
+    os_calloc(1, sizeof(w_gzip_stream_t), stream);
+
+    if (stream->gz = gzopen(path, "rb"), stream->gz == NULL) {
+        os_free(stream);
+        return NULL;
+    }
+
+    gzbuffer(stream->gz, GZIP_STREAM_CHUNK);
+    os_malloc(GZIP_STREAM_HISTORY + GZIP_STREAM_CHUNK, stream->buffer);
+
+#ifdef __linux__
+    cookie_io_functions_t functions = {
+        .read = w_gzip_stream_read,
+        .write = NULL,
+        .seek = (cookie_seek_function_t *)w_gzip_stream_seek,
+        .close = w_gzip_stream_close
+    };
+
+    fp = fopencookie(stream, "r", functions);
+#else
+    fp = funopen(stream, w_gzip_stream_read_bsd, NULL, w_gzip_stream_seek_bsd, w_gzip_stream_close);
+#endif
+
+    if (fp == NULL) {
+        gzclose(stream->gz);
+        os_free(stream->buffer);
+        os_free(stream);
+    }
+
+    return fp;
+#else
+    (void)path;
+    errno = ENOTSUP;
+    return NULL;
+#endif
+}
+
+int w_gzip_sha1_nbytes(const char * path, SHA_CTX * context, os_sha1 output, int64_t nbytes) {
+
+    char buffer[OS_MAXSTR];
+    unsigned char md[SHA_DIGEST_LENGTH];
+    gzFile gz;
+
+    memset(output, 0, sizeof(os_sha1));
+    SHA1_Init(context);
+
+    if (gz = gzopen(path, "rb"), gz == NULL) {
+        return -1;
+    }
+
+    while (nbytes > 0) {
+        int length = gzread(gz, buffer, nbytes < (int64_t)sizeof(buffer) ? (unsigned)nbytes : sizeof(buffer));
+
+        if (length < 0) {
+            gzclose(gz);
+            return -1;
+        } else if (length == 0) {
+            break;
+        }
+
+        SHA1_Update(context, buffer, length);
+        nbytes -= length;
+    }
+
+    gzclose(gz);
+
+    SHA_CTX aux = *context;
+    SHA1_Final(md, &aux);
+    OS_SHA1_Hexdigest(md, output);
+
+    return 0;
+}
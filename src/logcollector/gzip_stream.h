@@ -0,0 +1,86 @@
+/* Copyright (C) 2015, Wazuh Inc.
+ * All right reserved.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation
+ */
+
+#ifndef GZIP_STREAM_H
+#define GZIP_STREAM_H
+
+/* ******************  INCLUDES  ****************** */
+
+#include "shared.h"
+#include "external/zlib/zlib.h"
+#include "os_crypto/sha1/sha1_op.h"
+
+/* ******************  DEFINES  ****************** */
+
+#define GZIP_STREAM_CHUNK       65536       ///< Decompressed bytes produced per refill
+#define GZIP_STREAM_HISTORY     OS_MAXSTR   ///< Decompressed bytes kept to serve short backward seeks
+
+/* ******************  DATATYPES  ****************** */
+
+/**
+ * @brief State of a decompressing stream wrapped as a stdio FILE
+ *
+ * The buffer holds a window of the decompressed data, starting at the stream offset `base`.
+ * Readers rewind to the beginning of an incomplete line when they hit EOF, so the tail of the
+ * data already delivered is kept in the window to avoid re-inflating the archive from the start.
+ */
+typedef struct {
+    gzFile gz;              ///< zlib handle
+    char * buffer;          ///< Window of decompressed data
+    size_t length;          ///< Valid bytes in buffer
+    int64_t base;           ///< Decompressed offset of buffer[0]
+    int64_t position;       ///< Current decompressed offset
+    time_t slot;            ///< Second in which the rate budget is being consumed
+    int64_t slot_bytes;     ///< Bytes delivered during the current slot
+} w_gzip_stream_t;
+
+/* ******************  PROTOTYPES  ****************** */
+
+/**
+ * @brief Check whether an open file starts with the gzip magic number
+ *
+ * The file position is restored to the beginning of the file.
+ *
+ * @param fp File pointer, positioned at the beginning of the file
+ * @return true if the file is gzip-compressed, false otherwise
+ */
+bool w_gzip_is_compressed(FILE * fp);
+
+/**
+ * @brief Check whether a file starts with the gzip magic number
+ *
+ * @param path Path of the file
+ * @return true if the file is gzip-compressed, false otherwise or if it cannot be opened
+ */
+bool w_gzip_is_compressed_file(const char * path);
+
+/**
+ * @brief Open a gzip-compressed file as a stdio stream of its decompressed content
+ *
+ * Offsets reported by ftell() and accepted by fseek() refer to the decompressed data, so the
+ * line readers and the file_status checkpoints work unchanged.
+ *
+ * @param path Path of the compressed file
+ * @return FILE pointer on success, NULL on error or if the platform does not support custom streams
+ */
+FILE * w_gzip_fopen(const char * path);
+
+/**
+ * @brief Calculate the SHA1 of the first N decompressed bytes of a gzip-compressed file
+ *
+ * @param path Path of the compressed file
+ * @param context[out] SHA1 context after hashing `nbytes` bytes
+ * @param output[out] Hexadecimal digest
+ * @param nbytes Number of decompressed bytes to hash
+ * @retval 0 on success
+ * @retval -1 when the file cannot be opened or decompressed
+ */
+int w_gzip_sha1_nbytes(const char * path, SHA_CTX * context, os_sha1 output, int64_t nbytes);
+
+#endif /* GZIP_STREAM_H */
@@ -0,0 +1,243 @@
+/* Copyright (C) 2015, Wazuh Inc.
+ * All right reserved.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation
+ */
+
+#if defined(__linux__)
+#include "logcollector.h"
+#include "journald_log.h"
+#include "sym_load.h"
+
+/* Removes STATIC qualifier from the tests */
+#ifdef WAZUH_UNIT_TESTING
+#define STATIC
+#else
+#define STATIC static
+#endif
+
+w_journald_lib_t journald_lib = { .handle = NULL };
+
+STATIC w_journald_vault_t journald_vault = { .mutex = PTHREAD_RWLOCK_INITIALIZER, .cursor = NULL };
+
+/**
+ * @brief Load the sd-journal functions from the systemd library
+ *
+ * @return true if every function was found. false otherwise
+ */
+STATIC bool w_journald_load_library(void) {
+
+    if (journald_lib.handle != NULL) {
+        return true;
+    }
+
+    void * handle = dlopen(JOURNALD_LIBRARY, RTLD_LAZY);
+
+    if (handle == NULL) {
+        merror(JOURNALD_LIB_ERROR, JOURNALD_LIBRARY, dlerror());
+        return false;
+    }
+
+#define JOURNALD_LOAD_SYM(member, symbol) \
+    if (journald_lib.member = so_get_function_sym(handle, symbol), journald_lib.member == NULL) { \
+        merror(JOURNALD_LIB_ERROR, JOURNALD_LIBRARY, "missing symbol " symbol); \
+        so_free_library(handle); \
+        return false; \
+    }
+
+    JOURNALD_LOAD_SYM(open, "sd_journal_open");
+    JOURNALD_LOAD_SYM(close, "sd_journal_close");
+    JOURNALD_LOAD_SYM(add_match, "sd_journal_add_match");
+    JOURNALD_LOAD_SYM(seek_head, "sd_journal_seek_head");
+    JOURNALD_LOAD_SYM(seek_tail, "sd_journal_seek_tail");
+    JOURNALD_LOAD_SYM(seek_cursor, "sd_journal_seek_cursor");
+    JOURNALD_LOAD_SYM(test_cursor, "sd_journal_test_cursor");
+    JOURNALD_LOAD_SYM(next, "sd_journal_next");
+    JOURNALD_LOAD_SYM(previous, "sd_journal_previous");
+    JOURNALD_LOAD_SYM(process, "sd_journal_process");
+    JOURNALD_LOAD_SYM(get_cursor, "sd_journal_get_cursor");
+    JOURNALD_LOAD_SYM(get_data, "sd_journal_get_data");
+    JOURNALD_LOAD_SYM(get_realtime_usec, "sd_journal_get_realtime_usec");
+
+#undef JOURNALD_LOAD_SYM
+
+    journald_lib.handle = handle;
+    return true;
+}
+
+/**
+ * @brief Place the journal right after the entry of `cursor`
+ *
+ * If the entry no longer exists (the journal was vacuumed), the journal is placed before the
+ * oldest entry that follows it.
+ * @param journal sd_journal handle
+ * @param cursor cursor of the last entry read
+ * @return true on success. false if the cursor is not valid
+ */
+STATIC bool w_journald_seek_cursor(void * journal, const char * cursor) {
+
+    if (journald_lib.seek_cursor(journal, cursor) < 0) {
+        return false;
+    }
+
+    if (journald_lib.next(journal) > 0 && journald_lib.test_cursor(journal, cursor) <= 0) {
+        /* Positioned on an entry that has not been read yet */
+        journald_lib.previous(journal);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Store the cursor of the current entry in the vault
+ *
+ * @param journal sd_journal handle
+ */
+STATIC void w_journald_save_position(void * journal) {
+
+    char * cursor = NULL;
+
+    if (journald_lib.get_cursor(journal, &cursor) >= 0 && cursor != NULL) {
+        w_journald_set_cursor(cursor);
+    }
+
+    /* Allocated by libsystemd */
+    free(cursor);
+}
+
+void w_journald_create_log_env(logreader * lf) {
+
+    void * journal = NULL;
+    char * cursor = NULL;
+    int retval;
+
+    if (!w_journald_load_library()) {
+        return;
+    }
+
+    if (retval = journald_lib.open(&journal, JOURNALD_LOCAL_ONLY), retval < 0) {
+        merror(JOURNALD_OPEN_ERROR, strerror(-retval), -retval);
+        return;
+    }
+
+    /* Matches of the same field are ORed, and matches of different fields are ANDed */
+    for (int i = 0; lf->journald_log->filters != NULL && lf->journald_log->filters[i] != NULL; i++) {
+        if (retval = journald_lib.add_match(journal, lf->journald_log->filters[i], 0), retval < 0) {
+            mwarn(LOGCOLLECTOR_JOURNALD_INV_FILTER, lf->journald_log->filters[i]);
+        }
+    }
+
+    if (cursor = w_journald_get_cursor(), cursor != NULL && w_journald_seek_cursor(journal, cursor)) {
+        mdebug1("Reading journal from cursor '%s'", cursor);
+    } else if (lf->future) {
+        journald_lib.seek_tail(journal);
+        if (journald_lib.previous(journal) > 0) {
+            w_journald_save_position(journal);
+        }
+    } else {
+        journald_lib.seek_head(journal);
+    }
+
+    os_free(cursor);
+    lf->journald_log->journal = journal;
+}
+
+size_t w_journald_format_entry(void * journal, char * buffer, size_t size) {
+
+    const char * fields[] = { "MESSAGE", "_HOSTNAME", "SYSLOG_IDENTIFIER", "_COMM", "_PID" };
+    const char * values[sizeof(fields) / sizeof(fields[0])];
+    int lengths[sizeof(fields) / sizeof(fields[0])];
+    char timestamp[OS_SIZE_32] = "";
+    uint64_t usec = 0;
+    int retval;
+
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+        const void * data = NULL;
+        size_t length = 0;
+        size_t prefix = strlen(fields[i]) + 1;
+
+        /* Data is returned as "FIELD=value", not null-terminated */
+        if (journald_lib.get_data(journal, fields[i], &data, &length) >= 0 && length >= prefix) {
+            values[i] = (const char *) data + prefix;
+            lengths[i] = (int) (length - prefix);
+        } else {
+            values[i] = NULL;
+            lengths[i] = 0;
+        }
+    }
+
+    if (values[0] == NULL) {
+        return 0;
+    }
+
+    if (journald_lib.get_realtime_usec(journal, &usec) >= 0) {
+        time_t seconds = (time_t) (usec / 1000000);
+        struct tm tm_result = { .tm_sec = 0 };
+
+        localtime_r(&seconds, &tm_result);
+        strftime(timestamp, sizeof(timestamp), JOURNALD_TIMESTAMP_FORMAT, &tm_result);
+    }
+
+    const char * identifier = values[2] != NULL ? values[2] : values[3];
+    int identifier_len = values[2] != NULL ? lengths[2] : lengths[3];
+
+    if (values[4] != NULL) {
+        retval = snprintf(buffer, size, "%s %.*s %.*s[%.*s]: %.*s", timestamp, lengths[1], values[1] ? values[1] : "",
+                          identifier_len, identifier ? identifier : "", lengths[4], values[4], lengths[0], values[0]);
+    } else {
+        retval = snprintf(buffer, size, "%s %.*s %.*s: %.*s", timestamp, lengths[1], values[1] ? values[1] : "",
+                          identifier_len, identifier ? identifier : "", lengths[0], values[0]);
+    }
+
+    if (retval < 0) {
+        return 0;
+    }
+
+    return (size_t) retval < size ? (size_t) retval : size - 1;
+}
+
+void w_journald_set_cursor(const char * cursor) {
+
+    w_rwlock_wrlock(&journald_vault.mutex);
+    os_free(journald_vault.cursor);
+    w_strdup(cursor, journald_vault.cursor);
+    w_rwlock_unlock(&journald_vault.mutex);
+}
+
+char * w_journald_get_cursor(void) {
+
+    char * cursor = NULL;
+    w_rwlock_rdlock(&journald_vault.mutex);
+    w_strdup(journald_vault.cursor, cursor);
+    w_rwlock_unlock(&journald_vault.mutex);
+    return cursor;
+}
+
+cJSON * w_journald_get_status_as_JSON(void) {
+
+    cJSON * journald_log = NULL;
+    char * cursor = w_journald_get_cursor();
+
+    if (cursor != NULL) {
+        journald_log = cJSON_CreateObject();
+        cJSON_AddItemToObject(journald_log, OS_LOGCOLLECTOR_JSON_CURSOR, cJSON_CreateString(cursor));
+    }
+    os_free(cursor);
+
+    return journald_log;
+}
+
+void w_journald_set_status_from_JSON(cJSON * global_json) {
+
+    cJSON * journald_log = cJSON_GetObjectItem(global_json, OS_LOGCOLLECTOR_JSON_JOURNALD);
+    char * cursor = cJSON_GetStringValue(cJSON_GetObjectItem(journald_log, OS_LOGCOLLECTOR_JSON_CURSOR));
+
+    if (cursor != NULL && *cursor != '\0') {
+        w_journald_set_cursor(cursor);
+    }
+}
+
+#endif
@@ -0,0 +1,113 @@
+/* Copyright (C) 2015, Wazuh Inc.
+ * All right reserved.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation
+ */
+
+#ifndef JOURNALD_LOG_H
+#define JOURNALD_LOG_H
+
+/* ******************  INCLUDES  ****************** */
+
+#include "shared.h"
+#include "config/localfile-config.h"
+
+/* ******************  DEFINES  ****************** */
+
+#define JOURNALD_LOG_NAME           "journald"          ///< Name to be displayed in the localfile' statistics
+#define JOURNALD_LIBRARY            "libsystemd.so.0"   ///< Library that provides the sd-journal API
+#define JOURNALD_LOCAL_ONLY         (1 << 0)            ///< SD_JOURNAL_LOCAL_ONLY: skip journals of other machines
+#define JOURNALD_TIMESTAMP_FORMAT   "%b %e %T"          ///< Syslog timestamp, as `journalctl -o short` prints it
+
+///< JSON fields for file_status related to the systemd journal
+#define OS_LOGCOLLECTOR_JSON_JOURNALD   JOURNALD_LOG_NAME
+#define OS_LOGCOLLECTOR_JSON_CURSOR     "cursor"
+
+/* ******************  DATATYPES  ****************** */
+
+/**
+ * @brief sd-journal functions used by the reader
+ *
+ * The library is loaded at runtime, so neither building nor running the agent requires systemd.
+ */
+typedef struct {
+    void * handle;
+    int (*open)(void ** journal, int flags);
+    void (*close)(void * journal);
+    int (*add_match)(void * journal, const void * data, size_t size);
+    int (*seek_head)(void * journal);
+    int (*seek_tail)(void * journal);
+    int (*seek_cursor)(void * journal, const char * cursor);
+    int (*test_cursor)(void * journal, const char * cursor);
+    int (*next)(void * journal);
+    int (*previous)(void * journal);
+    int (*process)(void * journal);
+    int (*get_cursor)(void * journal, char ** cursor);
+    int (*get_data)(void * journal, const char * field, const void ** data, size_t * length);
+    int (*get_realtime_usec)(void * journal, uint64_t * usec);
+} w_journald_lib_t;
+
+/**
+ * @brief Stores the position of the last entry read, to continue from it on the next startup
+ */
+typedef struct {
+    pthread_rwlock_t mutex;     ///< Prevent the RC on this structure
+    char * cursor;              ///< Cursor of the last entry read
+} w_journald_vault_t;
+
+extern w_journald_lib_t journald_lib;
+
+/* ******************  PROTOTYPES  ****************** */
+
+/**
+ * @brief Open the systemd journal and place it after the last entry read
+ *
+ * The journal continues from the cursor stored in file_status. Without a cursor, it starts at
+ * the end of the journal if `only-future-events` is enabled, or at the beginning otherwise.
+ * @param lf logreader with the journald configuration. `journald_log->journal` is NULL on failure
+ */
+void w_journald_create_log_env(logreader * lf);
+
+/**
+ * @brief Set the cursor of the last entry read
+ *
+ * @param cursor sd-journal cursor
+ */
+void w_journald_set_cursor(const char * cursor);
+
+/**
+ * @brief Get the cursor of the last entry read
+ *
+ * @return Allocated string containing the cursor. NULL if no entry has been read
+ */
+char * w_journald_get_cursor(void);
+
+/**
+ * @brief Get journald vault as JSON
+ *
+ * @return cJSON* journald vault. NULL if there is no cursor to store
+ */
+cJSON * w_journald_get_status_as_JSON(void);
+
+/**
+ * @brief Set journald vault from JSON
+ *
+ * @param global_json JSON object containing journald vault information
+ */
+void w_journald_set_status_from_JSON(cJSON * global_json);
+
+/**
+ * @brief Format the current journal entry as a syslog line
+ *
+ * Output follows `journalctl -o short`: "<timestamp> <hostname> <identifier>[<pid>]: <message>".
+ * @param journal sd_journal handle, placed on an entry
+ * @param buffer output buffer
+ * @param size size of the output buffer
+ * @return length of the formatted line. 0 if the entry has no message
+ */
+size_t w_journald_format_entry(void * journal, char * buffer, size_t size);
+
+#endif /* JOURNALD_LOG_H */
@@ -83,6 +83,15 @@ STATIC int64_t w_set_to_pos(logreader *lf, int64_t pos, int mode);
  */
 STATIC int w_update_hash_node(char * path, int64_t pos);
 
+/**
+ * @brief Update or add (if it not exit) hash node, hashing the decompressed content for gzip files
+ * @param path Hash key
+ * @param pos Offset of hash
+ * @param compressed The file is gzip-compressed and pos refers to its decompressed content
+ * @return 0 on success, otherwise -1
+ */
+STATIC int w_update_hash_node_ex(char * path, int64_t pos, bool compressed);
+
 /* Global variables */
 int loop_timeout;
 int logr_queue;
@@ -98,6 +107,7 @@ int reload_interval;
 int reload_delay;
 int free_excluded_files_interval;
 int state_interval;
+int gzip_max_rate;
 OSHash * msg_queues_table;
 
 ///< To asociate the path, the position to read, and the hash key of lines read.
@@ -373,6 +383,26 @@ void LogCollectorStart()
             os_free(current->fp);
         }
 
+        else if (strcmp(current->logformat, JOURNALD) == 0) {
+#if defined(__linux__)
+            w_journald_create_log_env(current);
+            current->read = read_journald;
+            if (current->journald_log->journal != NULL) {
+                minfo(READING_FILE, JOURNALD_LOG_NAME);
+
+                for (int tg_idx = 0; current->target[tg_idx]; tg_idx++) {
+                    mdebug1("Socket target for '%s' -> %s", JOURNALD_LOG_NAME, current->target[tg_idx]);
+                    w_logcollector_state_add_target(JOURNALD_LOG_NAME, current->target[tg_idx]);
+                }
+            }
+#else
+            minfo(LOGCOLLECTOR_ONLY_LINUX_JOURNALD);
+#endif
+            os_free(current->file);
+            os_free(current->command);
+            current->fp = NULL;
+        }
+
         else if (j < 0) {
             set_read(current, i, j);
             if (current->file) {
@@ -989,6 +1019,22 @@ int handle_file(int i, int j, __attribute__((unused)) int do_fseek, int do_log)
     lf->size =  stat_fd.st_size;
     lf->dev =  stat_fd.st_dev;
 
+    /* Rotated archives are read through their decompressed content */
+    lf->compressed = false;
+
+    if (S_ISREG(stat_fd.st_mode) && w_gzip_is_compressed(lf->fp)) {
+        FILE * gz_fp = w_gzip_fopen(lf->file);
+
+        if (gz_fp != NULL) {
+            fclose(lf->fp);
+            lf->fp = gz_fp;
+            lf->compressed = true;
+            mdebug1("Reading gzip-compressed file '%s'.", lf->file);
+        } else {
+            mdebug1("Cannot open '%s' as a gzip stream. Reading it as plain file.", lf->file);
+        }
+    }
+
 #else
     BY_HANDLE_FILE_INFORMATION lpFileInformation;
     memset(&lpFileInformation, 0, sizeof(BY_HANDLE_FILE_INFORMATION));
@@ -1053,7 +1099,7 @@ int handle_file(int i, int j, __attribute__((unused)) int do_fseek, int do_log)
             if (offset = w_set_to_pos(lf, 0, SEEK_END), offset < 0) {
                 goto error;
             }
-            w_update_hash_node(lf->file, offset);
+            w_update_hash_node_ex(lf->file, offset, lf->compressed);
         }
     }
 #endif
@@ -1078,7 +1124,7 @@ error:
 /* Reload file: open after close, and restore position */
 int reload_file(logreader * lf) {
 #ifndef WIN32
-    lf->fp = fopen(lf->file, "r");
+    lf->fp = lf->compressed ? w_gzip_fopen(lf->file) : fopen(lf->file, "r");
 
     if (!lf->fp) {
         return -1;
@@ -1366,6 +1412,8 @@ int check_pattern_expand(int do_seek) {
                         globs[j].gfiles[i].exists = 1;
                         globs[j].gfiles[i + 1].file = NULL;
                         globs[j].gfiles[i + 1].target = NULL;
+                        /* The reading state of multiline logs belongs to each file */
+                        globs[j].gfiles[i].multiline = w_multiline_config_clone(globs[j].gfiles[i + 1].multiline);
                         current_files++;
                         globs[j].num_files++;
                         mdebug2(CURRENT_FILES, current_files, maximum_files);
@@ -1393,6 +1441,8 @@ int check_pattern_expand(int do_seek) {
                         globs[j].gfiles[i].exists = 1;
                         globs[j].gfiles[i + 1].file = NULL;
                         globs[j].gfiles[i + 1].target = NULL;
+                        /* The reading state of multiline logs belongs to each file */
+                        globs[j].gfiles[i].multiline = w_multiline_config_clone(globs[j].gfiles[i + 1].multiline);
                         current_files++;
                         globs[j].num_files++;
                         mdebug2(CURRENT_FILES, current_files, maximum_files);
@@ -1610,6 +1660,8 @@ int check_pattern_expand(int do_seek) {
                             globs[j].gfiles[i].exists = 1;
                             globs[j].gfiles[i + 1].file = NULL;
                             globs[j].gfiles[i + 1].target = NULL;
+                            /* The reading state of multiline logs belongs to each file */
+                            globs[j].gfiles[i].multiline = w_multiline_config_clone(globs[j].gfiles[i + 1].multiline);
                             current_files++;
                             globs[j].num_files++;
                             mdebug2(CURRENT_FILES, current_files, maximum_files);
@@ -1637,6 +1689,8 @@ int check_pattern_expand(int do_seek) {
                             globs[j].gfiles[i].exists = 1;
                             globs[j].gfiles[i + 1].file = NULL;
                             globs[j].gfiles[i + 1].target = NULL;
+                            /* The reading state of multiline logs belongs to each file */
+                            globs[j].gfiles[i].multiline = w_multiline_config_clone(globs[j].gfiles[i + 1].multiline);
                             current_files++;
                             globs[j].num_files++;
                             mdebug2(CURRENT_FILES, current_files, maximum_files);
@@ -2052,26 +2106,20 @@ void * w_output_thread(void * args){
 
 void w_create_output_threads(){
     unsigned int i;
-    const OSHashNode *curr_node;
-
-    for(i = 0; i <= msg_queues_table->rows; i++){
-        if(msg_queues_table->table[i]){
-            curr_node = msg_queues_table->table[i];
+    OSHashNode *curr_node;
 
-            /* Create one thread per valid hash entry */
-            if(curr_node->key){
+    /* Create one thread per valid hash entry */
+    for (curr_node = OSHash_Begin(msg_queues_table, &i); curr_node; curr_node = OSHash_Next(msg_queues_table, &i, curr_node)) {
 #ifndef WIN32
-                w_create_thread(w_output_thread, curr_node->key);
+        w_create_thread(w_output_thread, curr_node->key);
 #else
-                w_create_thread(NULL,
-                    0,
-                    w_output_thread,
-                    curr_node->key,
-                    0,
-                    NULL);
+        w_create_thread(NULL,
+            0,
+            w_output_thread,
+            curr_node->key,
+            0,
+            NULL);
 #endif
-            }
-        }
     }
 }
 
@@ -2152,6 +2200,12 @@ void * w_input_thread(__attribute__((unused)) void * t_id){
                     else if (current->macos_log != NULL && current->macos_log->state != LOG_NOT_RUNNING) {
                         current->read(current, &r, 0);
                     }
+#endif
+#if defined(__linux__)
+                    /* Read the systemd journal */
+                    else if (current->journald_log != NULL && current->journald_log->journal != NULL) {
+                        current->read(current, &r, 0);
+                    }
 #endif
                     w_mutex_unlock(&current->mutex);
                     w_rwlock_unlock(&files_update_rwlock);
@@ -2166,7 +2220,7 @@ void * w_input_thread(__attribute__((unused)) void * t_id){
     #ifndef WIN32
 
                 if(current->age) {
-                    if ((fstat(fileno(current->fp), &tmp_stat)) == -1) {
+                    if ((current->compressed ? stat(current->file, &tmp_stat) : fstat(fileno(current->fp), &tmp_stat)) == -1) {
                         merror(FSTAT_ERROR, current->file, errno, strerror(errno));
 
                     } else {
@@ -2415,8 +2469,8 @@ static void check_text_only() {
             }
         }
 
-        /* Check for files to exclude */
-        if(current->file && !current->command && current->filter_binary) {
+        /* Check for files to exclude. Compressed files are decompressed while reading. */
+        if(current->file && !current->command && current->filter_binary && !w_gzip_is_compressed_file(current->file)) {
             snprintf(file_name, PATH_MAX, "%s", current->file);
 
             char *file_excluded = OSHash_Get(excluded_files,file_name);
@@ -2777,6 +2831,11 @@ STATIC void w_load_files_status(cJSON * global_json) {
 
    w_macos_set_status_from_JSON(global_json);
 
+#endif
+#if defined(__linux__)
+
+    w_journald_set_status_from_JSON(global_json);
+
 #endif
 
 }
@@ -2788,7 +2847,8 @@ STATIC char * w_save_files_status_to_cJSON() {
     char * global_json_str = NULL;
     OSHashNode * hash_node = NULL;
 
-    w_rwlock_rdlock(&files_status->mutex);
+    /* The _ex writers hold the mutex for reading, so only a writer keeps them out of the walk */
+    w_rwlock_wrlock(&files_status->mutex);
     if (hash_node = OSHash_Begin(files_status, &index), hash_node != NULL) {
         os_file_status_t * data = NULL;
         cJSON * array = NULL;
@@ -2828,6 +2888,17 @@ STATIC char * w_save_files_status_to_cJSON() {
         cJSON_AddItemToObject(global_json, OS_LOGCOLLECTOR_JSON_MACOS, macos_status);
     }
 
+#endif
+#if defined(__linux__)
+
+    cJSON * journald_status = w_journald_get_status_as_JSON();
+    if (journald_status != NULL) {
+        if (global_json == NULL) {
+            global_json = cJSON_CreateObject();
+        }
+        cJSON_AddItemToObject(global_json, OS_LOGCOLLECTOR_JSON_JOURNALD, journald_status);
+    }
+
 #endif
 
     if (global_json != NULL) {
@@ -2848,7 +2919,7 @@ STATIC int w_set_to_last_line_read(logreader * lf) {
 
     if (data = (os_file_status_t *)OSHash_Get_ex(files_status, lf->file), data == NULL) {
         w_set_to_pos(lf, 0, SEEK_END);
-        if (w_update_hash_node(lf->file, w_ftell(lf->fp)) == -1) {
+        if (w_update_hash_node_ex(lf->file, w_ftell(lf->fp), lf->compressed) == -1) {
             merror(HUPDATE_ERROR, lf->file, files_status_name);
         }
         return 0;
@@ -2856,7 +2927,7 @@ STATIC int w_set_to_last_line_read(logreader * lf) {
 
     struct stat stat_fd;
 
-    if (fstat(fileno(lf->fp), &stat_fd) == -1) {
+    if ((lf->compressed ? stat(lf->file, &stat_fd) : fstat(fileno(lf->fp), &stat_fd)) == -1) {
         merror(FSTAT_ERROR, lf->file, errno, strerror(errno));
         return -1;
     }
@@ -2866,13 +2937,18 @@ STATIC int w_set_to_last_line_read(logreader * lf) {
     SHA_CTX context;
     os_sha1 output;
 
-    if (OS_SHA1_File_Nbytes(lf->file, &context, output, OS_BINARY, data->offset) < 0) {
+    if ((lf->compressed ? w_gzip_sha1_nbytes(lf->file, &context, output, data->offset)
+                        : OS_SHA1_File_Nbytes(lf->file, &context, output, OS_BINARY, data->offset)) < 0) {
         merror(FAIL_SHA1_GEN, lf->file);
         return -1;
     }
 
     if (strcmp(output, data->hash)) {
         result = w_set_to_pos(lf, 0, SEEK_SET);
+    } else if (lf->compressed) {
+        /* The offset refers to the decompressed content: the whole archive is backfilled */
+        data->context = context;
+        return w_set_to_pos(lf, data->offset, SEEK_SET);
     } else if (stat_fd.st_size - data->offset > lf->diff_max_size) {
         result = w_set_to_pos(lf, 0, SEEK_END);
     } else {
@@ -2880,7 +2956,7 @@ STATIC int w_set_to_last_line_read(logreader * lf) {
     }
 
     if (result >= 0) {
-        if (w_update_hash_node(lf->file, result) == -1) {
+        if (w_update_hash_node_ex(lf->file, result, lf->compressed) == -1) {
             merror(HUPDATE_ERROR, lf->file, files_status_name);
         }
     }
@@ -2889,6 +2965,10 @@ STATIC int w_set_to_last_line_read(logreader * lf) {
 }
 
 STATIC int w_update_hash_node(char * path, int64_t pos) {
+    return w_update_hash_node_ex(path, pos, false);
+}
+
+STATIC int w_update_hash_node_ex(char * path, int64_t pos, bool compressed) {
 
     os_file_status_t * data;
 
@@ -2903,7 +2983,8 @@ STATIC int w_update_hash_node(char * path, int64_t pos) {
     SHA_CTX context;
     os_sha1 output;
 
-    if (OS_SHA1_File_Nbytes(path, &context, output, OS_BINARY, pos) < 0) {
+    if ((compressed ? w_gzip_sha1_nbytes(path, &context, output, pos)
+                    : OS_SHA1_File_Nbytes(path, &context, output, OS_BINARY, pos)) < 0) {
         merror(FAIL_SHA1_GEN, path);
         os_free(data);
         return -1;
@@ -2943,7 +3024,11 @@ bool w_get_hash_context(logreader *lf, SHA_CTX * context, int64_t position) {
 
     if (data == NULL) {
         os_sha1 output;
-        if (OS_SHA1_File_Nbytes_with_fp_check(lf->file, context, output, OS_BINARY, position, lf->fd) < 0) {
+        if (lf->compressed) {
+            if (w_gzip_sha1_nbytes(lf->file, context, output, position) < 0) {
+                return false;
+            }
+        } else if (OS_SHA1_File_Nbytes_with_fp_check(lf->file, context, output, OS_BINARY, position, lf->fd) < 0) {
             return false;
         }
     } else {
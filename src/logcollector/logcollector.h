@@ -42,6 +42,8 @@
 #include "config/config.h"
 #include "os_crypto/sha1/sha1_op.h"
 #include "macos_log.h"
+#include "journald_log.h"
+#include "gzip_stream.h"
 
 
 /*** Function prototypes ***/
@@ -121,6 +123,18 @@ void *read_macos(logreader *lf, int *rc, int drop_it);
 
 #endif
 
+#if defined(__linux__)
+/**
+ * @brief Read entries from the systemd journal
+ *
+ * @param lf status and configuration of the journal reader
+ * @param rc output parameter, returns zero
+ * @param drop_it if drop_it is different from 0, the logs will be read and discarded
+ * @return NULL
+ */
+void *read_journald(logreader *lf, int *rc, int drop_it);
+#endif
+
 /* Read DJB multilog format */
 /* Initializes multilog */
 int init_djbmultilog(logreader *lf);
@@ -167,6 +181,7 @@ extern int reload_interval;
 extern int reload_delay;
 extern int free_excluded_files_interval;
 extern int state_interval;
+extern int gzip_max_rate;
 
 typedef enum {
     CONTINUE_IT,
@@ -0,0 +1,65 @@
+/* Copyright (C) 2015, Wazuh Inc.
+ * All right reserved.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation
+ */
+
+#if defined(__linux__)
+
+#include "shared.h"
+#include "logcollector.h"
+#include "journald_log.h"
+
+void * read_journald(logreader * lf, int * rc, int drop_it) {
+    char read_buffer[OS_MAXSTR + 1];
+    int count_logs = 0;
+    int retval;
+    size_t size;
+    void * journal = lf->journald_log->journal;
+
+    *rc = 0;
+
+    if (journal == NULL) {
+        return NULL;
+    }
+
+    /* Pick up journal files created or rotated since the last call */
+    journald_lib.process(journal);
+
+    while ((maximum_lines == 0 || count_logs < maximum_lines) && can_read()) {
+
+        if (retval = journald_lib.next(journal), retval <= 0) {
+            if (retval < 0) {
+                merror(JOURNALD_READ_ERROR, strerror(-retval), -retval);
+            }
+            break;
+        }
+
+        count_logs++;
+
+        if (drop_it == 0 && (size = w_journald_format_entry(journal, read_buffer, sizeof(read_buffer)), size > 0)) {
+            mdebug2("Reading journal message: '%.*s'%s", sample_log_length, read_buffer,
+                    (int) size > sample_log_length ? "..." : "");
+            w_msg_hash_queues_push(read_buffer, JOURNALD_LOG_NAME, size + 1, lf->log_target, LOCALFILE_MQ);
+        }
+    }
+
+    /* Keep the position once per batch, not per entry */
+    if (count_logs > 0) {
+        char * cursor = NULL;
+
+        if (journald_lib.get_cursor(journal, &cursor) >= 0 && cursor != NULL) {
+            w_journald_set_cursor(cursor);
+        }
+
+        /* Allocated by libsystemd */
+        free(cursor);
+    }
+
+    return NULL;
+}
+
+#endif
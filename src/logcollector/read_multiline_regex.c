@@ -106,14 +106,45 @@ STATIC int multiline_getlog_end(char * buffer, int length, FILE * stream, w_mult
 STATIC int multiline_getlog_all(char * buffer, int length, FILE * stream, w_multiline_config_t * ml_cfg);
 
 /**
- * @brief Get specific chunk of file between two positions
- * 
- * @param stream File stream 
- * @param initial_pos initial position 
- * @param final_pos final position
- * @return allocated buffer containing the readed chunk. NULL on error
+ * @brief Read the next line, taking first the line read ahead by a previous call
+ *
+ * The unmodified line is appended to the raw data used to update the file hash.
+ * @param str destination buffer
+ * @param size max length, including the terminating null byte
+ * @param stream log file
+ * @param ml_cfg multiline configuration
+ * @return str on success, NULL if there is no line available
+ */
+STATIC char * multiline_gets(char * str, int size, FILE * stream, w_multiline_config_t * ml_cfg);
+
+/**
+ * @brief Test whether a line or log matches the multiline regex
+ *
+ * The literal prefix of anchored regexes is checked first, and the regex runs with the reader's
+ * own match block instead of allocating one on every call.
+ * @param ml_cfg multiline configuration
+ * @param str string to test
+ * @return true if match. Otherwise returns false
+ */
+STATIC bool multiline_match(w_multiline_config_t * ml_cfg, const char * str);
+
+/**
+ * @brief Append unmodified content read from the file to the raw data buffer
+ *
+ * The buffer grows geometrically, so appending a line costs amortized O(line length).
+ * @param ml_cfg multiline configuration
+ * @param data content to append
+ * @param len length of data
+ */
+STATIC void multiline_raw_append(w_multiline_config_t * ml_cfg, const char * data, size_t len);
+
+/**
+ * @brief Skip the rest of a line that does not fit in the log buffer
+ *
+ * @param stream log file
+ * @param ml_cfg multiline configuration
  */
-STATIC char * get_file_chunk(FILE * stream, int64_t initial_pos, int64_t final_pos);
+STATIC void multiline_discard_line(FILE * stream, w_multiline_config_t * ml_cfg);
 
 /* Misc functions */
 
@@ -138,46 +169,48 @@ void * read_multiline_regex(logreader * lf, int * rc, int drop_it) {
 
     /* Continue from last read line */
     SHA_CTX context;
-    int64_t initial_pos;
-    char * raw_data = NULL;
+    w_multiline_config_t * ml_cfg = lf->multiline;
+    int64_t current_pos;
 
     if (can_read() == 0) {
         return NULL;
-    } else if (lf->multiline->offset_last_read == 0 || w_ftell(lf->fp) < lf->multiline->offset_last_read) {
-        lf->multiline->offset_last_read = w_ftell(lf->fp);
+    } else if (current_pos = w_ftell(lf->fp), current_pos < ml_cfg->offset_last_read) {
+        /* The file has been reopened or truncated: content read ahead is no longer valid */
+        ml_cfg->offset_last_read = current_pos;
+        os_free(ml_cfg->pending_line);
+        ml_cfg->raw_len = 0;
+    } else if (ml_cfg->offset_last_read == 0) {
+        ml_cfg->offset_last_read = current_pos;
     }
 
-    bool is_valid_context_file = w_get_hash_context(lf, &context, lf->multiline->offset_last_read);
+    bool is_valid_context_file = w_get_hash_context(lf, &context, ml_cfg->offset_last_read);
 
     read_buffer[OS_MAXSTR] = '\0';
     *rc = 0;
 
-    while (rlines = multiline_getlog(read_buffer, max_line_len, lf->fp, lf->multiline),
-           rlines > 0 && (maximum_lines == 0 || count_lines < maximum_lines)) {
+    while ((maximum_lines == 0 || count_lines < maximum_lines)
+           && (rlines = multiline_getlog(read_buffer, max_line_len, lf->fp, ml_cfg), rlines > 0)) {
 
         if (drop_it == 0) {
             w_msg_hash_queues_push(read_buffer, lf->file, strlen(read_buffer) + 1, lf->log_target, LOCALFILE_MQ);
         }
         count_lines += rlines;
 
-        /* Continue from last read line */
-        initial_pos = lf->multiline->offset_last_read;
-        lf->multiline->offset_last_read = w_ftell(lf->fp);
-
-        raw_data = get_file_chunk(lf->fp, initial_pos, lf->multiline->offset_last_read);
-        if (raw_data == NULL) {
-            continue;
+        /* Continue from last read line. A line read ahead belongs to the next log */
+        ml_cfg->offset_last_read = w_ftell(lf->fp);
+        if (ml_cfg->pending_line != NULL) {
+            ml_cfg->offset_last_read -= strlen(ml_cfg->pending_line);
         }
 
-        if (is_valid_context_file) {
-            OS_SHA1_Stream(&context, NULL, raw_data);
+        if (is_valid_context_file && ml_cfg->raw_len > 0) {
+            OS_SHA1_Stream(&context, NULL, ml_cfg->raw_data);
         }
 
-        os_free(raw_data);
+        ml_cfg->raw_len = 0;
     }
 
     if (is_valid_context_file) {
-        w_update_file_status(lf->file, lf->multiline->offset_last_read, &context);
+        w_update_file_status(lf->file, ml_cfg->offset_last_read, &context);
     }
 
     return NULL;
@@ -216,9 +249,7 @@ STATIC int multiline_getlog_start(char * buffer, int length, FILE * stream, w_mu
     int chunk_sz = 0;
     bool collecting_lines = false;
     int readed_lines = 0;
-    int c = 0;
     *str = '\0';
-    int64_t pos = w_ftell(stream);
 
     /* Check if a context restore is needed */
     if (ml_cfg->ctxt) {
@@ -235,14 +266,16 @@ STATIC int multiline_getlog_start(char * buffer, int length, FILE * stream, w_mu
         }
     }
 
-    while (can_read() && (retstr = fgets(str, length - offset, stream)) != NULL) {
+    while (can_read() && (retstr = multiline_gets(str, length - offset, stream, ml_cfg)) != NULL) {
 
         /* Check if current line match start regex */
-        if (collecting_lines && w_expression_match(ml_cfg->regex, str, NULL, NULL)) {
-            /* Rewind. This line dont belong to last log */
+        if (collecting_lines && multiline_match(ml_cfg, str)) {
+            /* This line dont belong to last log. Keep it for the next one instead of rewinding */
+            ml_cfg->raw_len -= strlen(str);
+            ml_cfg->raw_data[ml_cfg->raw_len] = '\0';
+            os_strdup(str, ml_cfg->pending_line);
             buffer[offset] = '\0';
             multiline_replace(buffer, ML_REPLACE_NONE);
-            w_fseek(stream, pos, SEEK_SET);
             break;
         }
 
@@ -251,8 +284,6 @@ STATIC int multiline_getlog_start(char * buffer, int length, FILE * stream, w_mu
         offset += chunk_sz;
         str += chunk_sz;
         readed_lines++;
-        /* Save current posistion in case we have to rewind */
-        pos = w_ftell(stream);
         collecting_lines = true;
         /* Allow save new content in the context in case can_read() fail */
         retstr = NULL;
@@ -269,12 +300,7 @@ STATIC int multiline_getlog_start(char * buffer, int length, FILE * stream, w_mu
         readed_lines = 0;
     } else if (length == offset + 1) {
         // Discard the rest of the log, moving the pointer to the next end of line
-        while (true) {
-            c = fgetc(stream);
-            if (c == '\n' || c == '\0' || c == EOF) {
-                break;
-            }
-        }
+        multiline_discard_line(stream, ml_cfg);
     }
 
     /* If the lastest line complete the multiline log, free the context */
@@ -292,7 +318,6 @@ STATIC int multiline_getlog_end(char * buffer, int length, FILE * stream, w_mult
     int chunk_sz = 0;
     bool collecting_lines = false;
     int readed_lines = 0;
-    int c = 0;
     *str = '\0';
 
     /* Check if a context restore is needed */
@@ -310,10 +335,10 @@ STATIC int multiline_getlog_end(char * buffer, int length, FILE * stream, w_mult
         }
     }
 
-    while (can_read() && (retstr = fgets(str, length - offset, stream)) != NULL) {
+    while (can_read() && (retstr = multiline_gets(str, length - offset, stream, ml_cfg)) != NULL) {
 
         readed_lines++;
-        if (w_expression_match(ml_cfg->regex, str, NULL, NULL)) {
+        if (multiline_match(ml_cfg, str)) {
             multiline_replace(buffer, ML_REPLACE_NONE);
             collecting_lines = false;
             break;
@@ -338,12 +363,7 @@ STATIC int multiline_getlog_end(char * buffer, int length, FILE * stream, w_mult
         readed_lines = 0;
     } else if (length == offset + 1) {
         // Discard the rest of the log, moving the pointer to the next end of line
-        while (true) {
-            c = fgetc(stream);
-            if (c == '\n' || c == '\0' || c == EOF) {
-                break;
-            }
-        }
+        multiline_discard_line(stream, ml_cfg);
     }
 
     /* If the lastest line complete the multiline log, free the context */
@@ -362,7 +382,6 @@ STATIC int multiline_getlog_all(char * buffer, int length, FILE * stream, w_mult
     int chunk_sz = 0;
     bool collecting_lines = false;
     int readed_lines = 0;
-    int c = 0;
     *str = '\0';
 
     /* Check if a context restore is needed */
@@ -380,10 +399,10 @@ STATIC int multiline_getlog_all(char * buffer, int length, FILE * stream, w_mult
         }
     }
 
-    while (can_read() && (retstr = fgets(str, length - offset, stream)) != NULL) {
+    while (can_read() && (retstr = multiline_gets(str, length - offset, stream, ml_cfg)) != NULL) {
 
         readed_lines++;
-        if (w_expression_match(ml_cfg->regex, buffer, NULL, NULL)) {
+        if (multiline_match(ml_cfg, buffer)) {
             multiline_replace(buffer, ML_REPLACE_NONE);
             collecting_lines = false;
             break;
@@ -409,12 +428,7 @@ STATIC int multiline_getlog_all(char * buffer, int length, FILE * stream, w_mult
         readed_lines = 0;
     } else if (length == offset + 1) {
         // Discard the rest of the log, moving the pointer to the next end of line
-        while (true) {
-            c = fgetc(stream);
-            if (c == '\n' || c == '\0' || c == EOF) {
-                break;
-            }
-        }
+        multiline_discard_line(stream, ml_cfg);
     }
 
     /* If the lastest line complete the multiline log, free the context */
@@ -489,12 +503,18 @@ STATIC void multiline_ctxt_backup(char * buffer, int readed_lines, w_multiline_c
 
     if (*ctxt) {
         size_t old_size = strlen((*ctxt)->buffer);
-        os_realloc((*ctxt)->buffer, sizeof(char) * (current_bsize + 1), (*ctxt)->buffer);
+        if (current_bsize + 1 > (*ctxt)->size) {
+            /* Grow geometrically: the same log is backed up again each time new lines arrive */
+            size_t new_size = (*ctxt)->size * 2 > current_bsize + 1 ? (*ctxt)->size * 2 : current_bsize + 1;
+            os_realloc((*ctxt)->buffer, sizeof(char) * new_size, (*ctxt)->buffer);
+            (*ctxt)->size = new_size;
+        }
         strcpy((*ctxt)->buffer + old_size, buffer + old_size);
 
     } else {
         os_calloc(1, sizeof(w_multiline_ctxt_t), *ctxt);
         os_calloc(current_bsize + 1, sizeof(char), (*ctxt)->buffer);
+        (*ctxt)->size = current_bsize + 1;
         strcpy((*ctxt)->buffer, buffer);
     }
 
@@ -537,22 +557,90 @@ STATIC bool multiline_ctxt_is_expired(time_t timeout, w_multiline_ctxt_t * ctxt)
     return false;
 }
 
-STATIC char * get_file_chunk(FILE * stream, int64_t initial_pos, int64_t final_pos) {
+STATIC char * multiline_gets(char * str, int size, FILE * stream, w_multiline_config_t * ml_cfg) {
 
-    char * ret_buffer = NULL;
-    int64_t read_length = final_pos - initial_pos;
+    if (ml_cfg->pending_line != NULL) {
+        size_t len = strlen(ml_cfg->pending_line);
 
-    if (read_length <= 0 || w_fseek(stream, initial_pos, SEEK_SET) != 0) {
-        return ret_buffer;
+        /* Take the line read ahead. It fits: it was read into a buffer of at most this size */
+        if (len > (size_t) size - 1) {
+            len = (size_t) size - 1;
+        }
+
+        memcpy(str, ml_cfg->pending_line, len);
+        str[len] = '\0';
+        os_free(ml_cfg->pending_line);
+
+        /* The line was cut by the previous buffer: read the rest of it */
+        if ((len == 0 || str[len - 1] != '\n') && len < (size_t) size - 1 && fgets(str + len, size - len, stream) == NULL) {
+            str[len] = '\0';
+        }
+    } else if (fgets(str, size, stream) == NULL) {
+        return NULL;
+    }
+
+    multiline_raw_append(ml_cfg, str, strlen(str));
+    return str;
+}
+
+STATIC bool multiline_match(w_multiline_config_t * ml_cfg, const char * str) {
+
+    if (ml_cfg->start_prefix != NULL) {
+        if (strncmp(str, ml_cfg->start_prefix, ml_cfg->start_prefix_len) != 0) {
+            return false;
+        } else if (ml_cfg->start_prefix_only) {
+            return true;
+        }
     }
 
-    os_calloc((size_t) read_length + 1, sizeof(char), ret_buffer);
-    int64_t ret = (int64_t) fread(ret_buffer, sizeof(char), read_length, stream);
+    if (ml_cfg->match_data != NULL) {
+        return w_expression_match_ex(ml_cfg->regex, str, ml_cfg->match_data);
+    }
+
+    return w_expression_match(ml_cfg->regex, str, NULL, NULL);
+}
+
+STATIC void multiline_raw_append(w_multiline_config_t * ml_cfg, const char * data, size_t len) {
+
+    if (ml_cfg->raw_len + len + 1 > ml_cfg->raw_size) {
+        size_t new_size = ml_cfg->raw_size ? ml_cfg->raw_size : OS_SIZE_1024;
+
+        while (new_size < ml_cfg->raw_len + len + 1) {
+            new_size *= 2;
+        }
+
+        os_realloc(ml_cfg->raw_data, new_size, ml_cfg->raw_data);
+        ml_cfg->raw_size = new_size;
+    }
+
+    memcpy(ml_cfg->raw_data + ml_cfg->raw_len, data, len);
+    ml_cfg->raw_len += len;
+    ml_cfg->raw_data[ml_cfg->raw_len] = '\0';
+}
+
+STATIC void multiline_discard_line(FILE * stream, w_multiline_config_t * ml_cfg) {
+
+    char discarded[OS_SIZE_1024];
+    size_t len = 0;
+    int c;
+
+    while (true) {
+        c = fgetc(stream);
+        if (c == '\n' || c == '\0' || c == EOF) {
+            break;
+        }
+
+        discarded[len++] = (char) c;
+
+        if (len == sizeof(discarded)) {
+            multiline_raw_append(ml_cfg, discarded, len);
+            len = 0;
+        }
+    }
 
-    if (ret != read_length) {
-        /* do not move the pointer to the file, it will remain at the end */
-        os_free(ret_buffer);
+    if (c == '\n') {
+        discarded[len++] = (char) c;
     }
 
-    return ret_buffer;
+    multiline_raw_append(ml_cfg, discarded, len);
 }
@@ -15,45 +15,113 @@ static const char *(months[]) = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
                                  "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
                                 };
 
+/* Logs signed and compressed at the end of the day */
+static const struct {
+    const char *logdir;
+    const char *tag;
+    const char *ext;
+} manage_jobs[] = {
+    { EVENTS, "archive", "log" },
+    { EVENTS, "archive", "json" },
+    { ALERTS, "alerts", "log" },
+    { ALERTS, "alerts", "json" },
+    { FWLOGS, "firewall", "log" },
+};
+
+#define MANAGE_JOBS (sizeof(manage_jobs) / sizeof(manage_jobs[0]))
+
+/* State of the running pass, shared by the workers */
+static struct {
+    int cday;
+    int cmon;
+    int cyear;
+    struct tm pp_old;
+    unsigned int next;      // Next job to take
+    unsigned int workers;   // Workers still running
+} manage_state;
+
+static pthread_mutex_t manage_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 static void manage_log(const char * logdir, int cday, int cmon, int cyear, const struct tm * pp_old, const char * tag, const char * ext);
+static void * manage_files_worker(void * arg);
 
+/* Sign and compress the logs of the day in the background. The logs are
+ * shared out among mond.rotation_threads workers.
+ */
 void manage_files(int cday, int cmon, int cyear)
 {
     time_t tm;
-    struct tm tm_result;
+    unsigned int i;
+
+    w_mutex_lock(&manage_mutex);
+
+    if (manage_state.workers > 0) {
+        w_mutex_unlock(&manage_mutex);
+        mwarn("Logs of the previous day are still being processed. Skipping signature and compression.");
+        return;
+    }
 
     /* Get time from the day before (for log signing) */
     tm = time(NULL);
     tm -= 93500;
 
-    localtime_r(&tm, &tm_result);
+    localtime_r(&tm, &manage_state.pp_old);
 
-    manage_log(EVENTS, cday, cmon, cyear, &tm_result, "archive", "log");
-    manage_log(EVENTS, cday, cmon, cyear, &tm_result, "archive", "json");
-    manage_log(ALERTS, cday, cmon, cyear, &tm_result, "alerts", "log");
-    manage_log(ALERTS, cday, cmon, cyear, &tm_result, "alerts", "json");
-    manage_log(FWLOGS, cday, cmon, cyear, &tm_result, "firewall", "log");
+    manage_state.cday = cday;
+    manage_state.cmon = cmon;
+    manage_state.cyear = cyear;
+    manage_state.next = 0;
+    manage_state.workers = mond.rotation_threads > 0 ? (unsigned int)mond.rotation_threads : 1;
+
+    for (i = 0; i < manage_state.workers; i++) {
+        w_create_thread(manage_files_worker, NULL);
+    }
+
+    w_mutex_unlock(&manage_mutex);
+}
+
+/* Take logs until there are none left */
+void * manage_files_worker(__attribute__((unused)) void * arg)
+{
+    unsigned int job;
+    int cday;
+    int cmon;
+    int cyear;
+    struct tm pp_old;
+
+    while (1) {
+        w_mutex_lock(&manage_mutex);
+
+        if (manage_state.next >= MANAGE_JOBS) {
+            if (--manage_state.workers == 0) {
+                mdebug1("Signature and compression of the logs completed.");
+            }
+
+            w_mutex_unlock(&manage_mutex);
+            break;
+        }
+
+        job = manage_state.next++;
+        cday = manage_state.cday;
+        cmon = manage_state.cmon;
+        cyear = manage_state.cyear;
+        pp_old = manage_state.pp_old;
+
+        w_mutex_unlock(&manage_mutex);
+
+        manage_log(manage_jobs[job].logdir, cday, cmon, cyear, &pp_old, manage_jobs[job].tag, manage_jobs[job].ext);
+    }
+
+    return NULL;
 }
 
 void manage_log(const char * logdir, int cday, int cmon, int cyear, const struct tm * pp_old, const char * tag, const char * ext) {
-    int i;
     char logfile[OS_FLSIZE + 1];
-    char logfile_r[OS_FLSIZE + 1];
     char logfile_old[OS_FLSIZE + 1];
 
     snprintf(logfile, OS_FLSIZE + 1, "%s/%d/%s/ossec-%s-%02d", logdir, cyear, months[cmon], tag, cday);
     snprintf(logfile_old, OS_FLSIZE + 1, "%s/%d/%s/ossec-%s-%02d", logdir, pp_old->tm_year + 1900, months[pp_old->tm_mon], tag, pp_old->tm_mday);
 
-    OS_SignLog(logfile, logfile_old, ext);
-
-    if (mond.compress) {
-        os_snprintf(logfile_r, OS_FLSIZE + 1, "%s.%s", logfile, ext);
-        OS_CompressLog(logfile_r);
-
-        for (i = 1; !IsFile(logfile_r) && FileSize(logfile_r) > 0; i++) {
-            if (os_snprintf(logfile_r, OS_FLSIZE + 1, "%s-%.3d.%s", logfile, i, ext) < OS_FLSIZE + 1) {
-                OS_CompressLog(logfile_r);
-            }
-        }
-    }
+    /* Each file is read once to sign and compress it */
+    OS_SignLog(logfile, logfile_old, ext, mond.compress);
 }
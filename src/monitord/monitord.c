@@ -113,6 +113,7 @@ cJSON *getMonitorInternalOptions(void) {
     cJSON_AddNumberToObject(monconf,"rotate_log",mond.rotate_log);
     cJSON_AddNumberToObject(monconf,"size_rotate",mond.size_rotate);
     cJSON_AddNumberToObject(monconf,"daily_rotations",mond.daily_rotations);
+    cJSON_AddNumberToObject(monconf,"rotation_threads",mond.rotation_threads);
     cJSON_AddNumberToObject(monconf,"delete_old_agents",mond.delete_old_agents);
 
     cJSON_AddItemToObject(root,"monitord",monconf);
@@ -178,6 +179,7 @@ int MonitordConfig(const char *cfg, monitor_config *mond, int no_agents, short d
     mond->keep_log_days = getDefine_Int("monitord", "keep_log_days", 0, 500);
     mond->size_rotate = (unsigned long) getDefine_Int("monitord", "size_rotate", 0, 4096) * 1024 * 1024;
     mond->daily_rotations = getDefine_Int("monitord", "daily_rotations", 1, 256);
+    mond->rotation_threads = getDefine_Int("monitord", "rotation_threads", 1, 5);
     mond->delete_old_agents = (unsigned int)getDefine_Int("monitord", "delete_old_agents", 0, 9600);
 
     mond->agents = NULL;
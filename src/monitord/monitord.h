@@ -23,12 +23,13 @@
 #define MONITORD_MSG_HEADER "1:" ARGV0 ":"
 #define AG_DISCON_MSG MONITORD_MSG_HEADER OS_AG_DISCON
 #define CHECK_LOGS_SIZE TRUE
+#define SIGN_LOG_BUFFER 262144  // Read size when signing and compressing logs
 
 /* Prototypes */
 void Monitord(void) __attribute__((noreturn));
 void manage_files(int cday, int cmon, int cyear);
 void generate_reports(int cday, int cmon, int cyear, const struct tm *p);
-void OS_SignLog(const char *logfile, const char *logfile_old, const char * ext);
+void OS_SignLog(const char *logfile, const char *logfile_old, const char * ext, int compress);
 void OS_CompressLog(const char *logfile);
 void w_rotate_log(int compress, int keep_log_days, int new_day, int rotate_json, int daily_rotations);
 int delete_old_agent(const char *agent_id);
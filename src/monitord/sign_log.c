@@ -15,9 +15,73 @@
 #include "monitord.h"
 #include <openssl/md5.h>
 #include <openssl/sha.h>
+#include "../external/zlib/zlib.h"
+
+/* Digests of a log and its rotations */
+typedef struct log_digest {
+    MD5_CTX md5;
+    SHA_CTX sha1;
+    SHA256_CTX sha256;
+} log_digest;
+
+/* Read a file once to update the digests and, if compress is set, to gzip
+ * it. The uncompressed file is removed once compressed.
+ * Returns 0 on success or -1 if the file cannot be opened.
+ */
+static int sign_file(const char *path, log_digest *digest, int compress, char *buffer)
+{
+    FILE *fp;
+    gzFile zlog = NULL;
+    char path_gz[OS_FLSIZE + 1];
+    size_t n;
+    int err;
+
+    if (fp = fopen(path, "r"), !fp) {
+        return -1;
+    }
+
+    if (compress) {
+        snprintf(path_gz, OS_FLSIZE + 1, "%s.gz", path);
+
+        if (zlog = gzopen(path_gz, "w"), !zlog) {
+            merror(FOPEN_ERROR, path_gz, errno, strerror(errno));
+        } else {
+            gzbuffer(zlog, SIGN_LOG_BUFFER);
+        }
+    }
+
+    while (n = fread(buffer, 1, SIGN_LOG_BUFFER, fp), n > 0) {
+        MD5_Update(&digest->md5, buffer, (unsigned long)n);
+        SHA1_Update(&digest->sha1, buffer, n);
+        SHA256_Update(&digest->sha256, buffer, n);
+
+        if (zlog && gzwrite(zlog, buffer, (unsigned)n) != (int)n) {
+            merror("Compression error: %s", gzerror(zlog, &err));
+            gzclose(zlog);
+            zlog = NULL;
+            unlink(path_gz);
+        }
+    }
+
+    fclose(fp);
+
+    /* Remove uncompressed file */
+    if (zlog) {
+        if (gzclose(zlog) != Z_OK) {
+            merror("Compression error: cannot close '%s'", path_gz);
+            unlink(path_gz);
+        } else if (unlink(path) == -1) {
+            merror("Unable to delete '%s' due to '%s'", path, strerror(errno));
+        }
+    }
+
+    return 0;
+}
 
-/* Sign a log file */
-void OS_SignLog(const char *logfile, const char *logfile_old, const char * ext)
+/* Sign a log file and its rotations, compressing them in the same pass if
+ * compress is set
+ */
+void OS_SignLog(const char *logfile, const char *logfile_old, const char * ext, int compress)
 {
     int i;
     size_t n;
@@ -31,14 +95,12 @@ void OS_SignLog(const char *logfile, const char *logfile_old, const char * ext)
     os_sha256 sf256_sum;
     os_sha256 sf256_sum_old;
 
-    SHA_CTX sha1_ctx;
-    MD5_CTX md5_ctx;
-    SHA256_CTX sha256_ctx;
+    log_digest digest;
 
     char logfilesum[OS_FLSIZE + 1];
     char logfilesum_old[OS_FLSIZE + 1];
     char logfile_r[OS_FLSIZE + 1];
-    char buffer[4096];
+    char *buffer;
 
     FILE *fp;
 
@@ -58,9 +120,9 @@ void OS_SignLog(const char *logfile, const char *logfile_old, const char * ext)
     os_snprintf(logfilesum, OS_FLSIZE, "%s.sum", logfile_r);
     snprintf(logfilesum_old, OS_FLSIZE, "%s.%s.sum", logfile_old, ext);
 
-    MD5_Init(&md5_ctx);
-    SHA1_Init(&sha1_ctx);
-    SHA256_Init(&sha256_ctx);
+    MD5_Init(&digest.md5);
+    SHA1_Init(&digest.sha1);
+    SHA256_Init(&digest.sha256);
 
     /* Generate MD5 of the old file */
     if (OS_MD5_File(logfilesum_old, mf_sum_old, OS_TEXT) < 0) {
@@ -85,47 +147,34 @@ void OS_SignLog(const char *logfile, const char *logfile_old, const char * ext)
 
     /* Generate MD5, SHA-1, and SHA-256 of the current file */
 
-    if (fp = fopen(logfile_r, "r"), fp) {
-        while (n = fread(buffer, 1, 2048, fp), n > 0) {
-            SHA1_Update(&sha1_ctx, buffer, n);
-            MD5_Update(&md5_ctx, buffer, (unsigned long)n);
-            SHA256_Update(&sha256_ctx, buffer, n);
-        }
+    os_malloc(SIGN_LOG_BUFFER, buffer);
 
-        fclose(fp);
+    if (sign_file(logfile_r, &digest, compress, buffer) == 0) {
 
         // Include rotated files
 
         for (i = 1; snprintf(logfile_r, OS_FLSIZE + 1, "%s-%.3d.%s", logfile, i, ext), !IsFile(logfile_r) && FileSize(logfile_r) > 0; i++) {
-            if (fp = fopen(logfile_r, "r"), fp) {
-                while (n = fread(buffer, 1, 2048, fp), n > 0) {
-                    SHA1_Update(&sha1_ctx, buffer, n);
-                    MD5_Update(&md5_ctx, buffer, (unsigned long)n);
-                    SHA256_Update(&sha256_ctx, buffer, n);
-                }
-
-                fclose(fp);
-            } else {
+            if (sign_file(logfile_r, &digest, compress, buffer) < 0) {
                 merror(FOPEN_ERROR, logfile_r, errno, strerror(errno));
                 break;
             }
         }
 
-        MD5_Final(md5_digest, &md5_ctx);
+        MD5_Final(md5_digest, &digest.md5);
         char *mpos = mf_sum;
         for (n = 0; n < 16; n++) {
             snprintf(mpos, 3, "%02x", md5_digest[n]);
             mpos += 2;
         }
 
-        SHA1_Final(&(md[0]), &sha1_ctx);
+        SHA1_Final(&(md[0]), &digest.sha1);
         char *spos = sf_sum;
         for (n = 0; n < SHA_DIGEST_LENGTH; n++) {
             snprintf(spos, 3, "%02x", md[n]);
             spos += 2;
         }
 
-        SHA256_Final(&(md256[0]), &sha256_ctx);
+        SHA256_Final(&(md256[0]), &digest.sha256);
         char *sspos = sf256_sum;
         for (n = 0; n < SHA256_DIGEST_LENGTH; n++) {
             snprintf(sspos, 3, "%02x", md256[n]);
@@ -138,6 +187,8 @@ void OS_SignLog(const char *logfile, const char *logfile_old, const char * ext)
         strncpy(sf256_sum, "none", 6);
     }
 
+    os_free(buffer);
+
     fp = fopen(logfilesum, "w");
     if (!fp) {
         merror(FOPEN_ERROR, logfilesum, errno, strerror(errno));
@@ -57,6 +57,7 @@ static void cleanup();
 static char *authpass = NULL;
 static SSL_CTX *ctx;
 static int remote_sock = -1;
+static int handshake_threads = 1;
 
 /* client queue */
 static w_queue_t *client_queue = NULL;
@@ -138,7 +139,7 @@ int main(int argc, char **argv)
     char buf[4096 + 1];
 
     pthread_t thread_local_server = 0;
-    pthread_t thread_dispatcher = 0;
+    pthread_t *thread_dispatchers = NULL;
     pthread_t thread_remote_server = 0;
     pthread_t thread_writer = 0;
     pthread_t thread_key_request = 0;
@@ -385,6 +386,8 @@ int main(int argc, char **argv)
             merror_exit(CONFIG_ERROR, OSSECCONF);
         }
 
+        handshake_threads = getDefine_Int("authd", "handshake_threads", 1, 64);
+
         // Overwrite arguments
 
         if (use_pass) {
@@ -578,9 +581,14 @@ int main(int argc, char **argv)
     if (config.flags.remote_enrollment) {
         client_queue = queue_init(AUTH_POOL);
 
-        if (status = pthread_create(&thread_dispatcher, NULL, (void *)&run_dispatcher, NULL), status != 0) {
-            merror("Couldn't create thread: %s", strerror(status));
-            return EXIT_FAILURE;
+        /* Handshakes are the bottleneck of mass enrollments: run them in parallel */
+        os_calloc(handshake_threads, sizeof(pthread_t), thread_dispatchers);
+
+        for (int i = 0; i < handshake_threads; i++) {
+            if (status = pthread_create(&thread_dispatchers[i], NULL, (void *)&run_dispatcher, NULL), status != 0) {
+                merror("Couldn't create thread: %s", strerror(status));
+                return EXIT_FAILURE;
+            }
         }
 
         if (status = pthread_create(&thread_remote_server, NULL, (void *)&run_remote_server, NULL), status != 0) {
@@ -608,8 +616,12 @@ int main(int argc, char **argv)
     /* Join threads */
     pthread_join(thread_local_server, NULL);
     if (config.flags.remote_enrollment) {
-        pthread_join(thread_dispatcher, NULL);
+        for (int i = 0; i < handshake_threads; i++) {
+            pthread_join(thread_dispatchers[i], NULL);
+        }
         pthread_join(thread_remote_server, NULL);
+        os_free(thread_dispatchers);
+        SSL_CTX_free(ctx);
     }
     if (!config.worker_node) {
         /* Send signal to writer thread */
@@ -768,14 +780,18 @@ void* run_dispatcher(__attribute__((unused)) void *arg) {
                     merror("Agent key not saved for %s", agentname);
                     ERR_print_errors_fp(stderr);
                     w_mutex_lock(&mutex_keys);
-                    OS_DeleteKey(&keys, keys.keyentries[keys.keysize - 1]->id, 1);
+                    OS_DeleteKey(&keys, new_id, 1);
                     w_mutex_unlock(&mutex_keys);
                 } else {
-                    /* Add pending key to write */
+                    /* Add pending key to write. Other dispatchers may have added keys meanwhile. */
                     w_mutex_lock(&mutex_keys);
-                    add_insert(keys.keyentries[keys.keysize - 1], centralized_group);
-                    write_pending = 1;
-                    w_cond_signal(&cond_pending);
+                    int index = OS_IsAllowedID(&keys, new_id);
+
+                    if (index >= 0) {
+                        add_insert(keys.keyentries[index], centralized_group);
+                        write_pending = 1;
+                        w_cond_signal(&cond_pending);
+                    }
                     w_mutex_unlock(&mutex_keys);
                 }
             }
@@ -804,7 +820,6 @@ void* run_dispatcher(__attribute__((unused)) void *arg) {
 
     mdebug1("Dispatch thread finished");
 
-    SSL_CTX_free(ctx);
     return NULL;
 }
 
@@ -898,6 +913,8 @@ void* run_remote_server(__attribute__((unused)) void *arg) {
 /* Thread for writing keystore onto disk */
 void* run_writer(__attribute__((unused)) void *arg) {
     keystore *copy_keys;
+    keyentry **new_keys;
+    unsigned int new_size;
     struct keynode *copy_insert;
     struct keynode *copy_remove;
     struct keynode *cur;
@@ -927,7 +944,30 @@ void* run_writer(__attribute__((unused)) void *arg) {
 
         gettime(&global_t0);
 
-        copy_keys = OS_DupKeys(&keys);
+        copy_keys = NULL;
+        new_keys = NULL;
+        new_size = 0;
+
+        /* New keys are appended to the files. Removals compact them with a full rewrite. */
+        if (queue_remove) {
+            copy_keys = OS_DupKeys(&keys);
+        } else if (queue_insert) {
+            for (cur = queue_insert; cur; cur = cur->next) {
+                new_size++;
+            }
+
+            os_calloc(new_size, sizeof(keyentry *), new_keys);
+            new_size = 0;
+
+            for (cur = queue_insert; cur; cur = cur->next) {
+                int index = OS_IsAllowedID(&keys, cur->id);
+
+                if (index >= 0) {
+                    new_keys[new_size++] = OS_DupKeyEntry(keys.keyentries[index]);
+                }
+            }
+        }
+
         copy_insert = queue_insert;
         copy_remove = queue_remove;
         queue_insert = NULL;
@@ -937,28 +977,51 @@ void* run_writer(__attribute__((unused)) void *arg) {
         write_pending = 0;
         w_mutex_unlock(&mutex_keys);
 
-        gettime(&t0);
+        if (new_keys) {
+            gettime(&t0);
 
-        if (OS_WriteKeys(copy_keys) < 0) {
-            merror("Couldn't write file client.keys");
-            sleep(1);
-        }
+            if (OS_AppendKeys(new_keys, new_size) < 0) {
+                mdebug1("Couldn't append keys. Rewriting file client.keys.");
 
-        gettime(&t1);
-        mdebug2("[Writer] OS_WriteKeys(): %d µs.", (int)(1000000. * (double)time_diff(&t0, &t1)));
+                w_mutex_lock(&mutex_keys);
+                copy_keys = OS_DupKeys(&keys);
+                w_mutex_unlock(&mutex_keys);
+            }
 
-        gettime(&t0);
+            gettime(&t1);
+            mdebug2("[Writer] OS_AppendKeys(): %d µs.", (int)(1000000. * (double)time_diff(&t0, &t1)));
 
-        if (OS_WriteTimestamps(copy_keys) < 0) {
-            merror("Couldn't write file agents-timestamp.");
-            sleep(1);
+            for (unsigned int i = 0; i < new_size; i++) {
+                OS_FreeKey(new_keys[i]);
+            }
+
+            os_free(new_keys);
         }
 
-        gettime(&t1);
-        mdebug2("[Writer] OS_WriteTimestamps(): %d µs.", (int)(1000000. * (double)time_diff(&t0, &t1)));
+        if (copy_keys) {
+            gettime(&t0);
+
+            if (OS_WriteKeys(copy_keys) < 0) {
+                merror("Couldn't write file client.keys");
+                sleep(1);
+            }
+
+            gettime(&t1);
+            mdebug2("[Writer] OS_WriteKeys(): %d µs.", (int)(1000000. * (double)time_diff(&t0, &t1)));
 
-        OS_FreeKeys(copy_keys);
-        os_free(copy_keys);
+            gettime(&t0);
+
+            if (OS_WriteTimestamps(copy_keys) < 0) {
+                merror("Couldn't write file agents-timestamp.");
+                sleep(1);
+            }
+
+            gettime(&t1);
+            mdebug2("[Writer] OS_WriteTimestamps(): %d µs.", (int)(1000000. * (double)time_diff(&t0, &t1)));
+
+            OS_FreeKeys(copy_keys);
+            os_free(copy_keys);
+        }
 
         for (cur = copy_insert; cur; cur = next) {
             next = cur->next;
@@ -195,6 +195,7 @@ void OS_ReadKeys(keystore *keys, key_mode_t key_mode, int save_removed)
     }
 
     keys->inode = File_Inode(keys_file);
+    keys->file_size = FileSize(keys_file);
     fp = fopen(keys_file, "r");
     if (!fp) {
         if (!pass_empty_keyfile) {
@@ -421,7 +422,8 @@ void OS_FreeKeys(keystore *keys)
 /* Check if key changed */
 int OS_CheckUpdateKeys(const keystore *keys)
 {
-    return keys->file_change != File_DateofChange(KEYS_FILE) || keys->inode != File_Inode(KEYS_FILE);
+    /* Keys appended within the same second only change the size */
+    return keys->file_change != File_DateofChange(KEYS_FILE) || keys->inode != File_Inode(KEYS_FILE) || keys->file_size != FileSize(KEYS_FILE);
 }
 
 /* Update the keys if changed */
@@ -621,6 +623,69 @@ error:
     return -1;
 }
 
+/* Append key entries and their timestamps to the files */
+int OS_AppendKeys(keyentry * const *entries, unsigned int size) {
+    FILE *fp_keys;
+    FILE *fp_timestamps;
+    char cidr[IPSIZE + 1];
+    char timestamp[40];
+    struct tm tm_result = { .tm_sec = 0 };
+    unsigned int i;
+    int r = 0;
+
+    /* Do not create the files here: they would not get their permissions */
+    if (FileSize(KEYS_FILE) < 0 || FileSize(TIMESTAMP_FILE) < 0) {
+        mdebug1("Cannot append keys: '%s' or '%s' does not exist.", KEYS_FILE, TIMESTAMP_FILE);
+        return -1;
+    }
+
+    if (fp_keys = fopen(KEYS_FILE, "a"), !fp_keys) {
+        merror(FOPEN_ERROR, KEYS_FILE, errno, strerror(errno));
+        return -1;
+    }
+
+    if (fp_timestamps = fopen(TIMESTAMP_FILE, "a"), !fp_timestamps) {
+        merror(FOPEN_ERROR, TIMESTAMP_FILE, errno, strerror(errno));
+        fclose(fp_keys);
+        return -1;
+    }
+
+    for (i = 0; i < size; i++) {
+        keyentry *entry = entries[i];
+        const char *ip = OS_CIDRtoStr(entry->ip, cidr, IPSIZE) ? entry->ip->ip : cidr;
+
+        if (fprintf(fp_keys, "%s %s %s %s\n", entry->id, entry->name, ip, entry->raw_key) < 0) {
+            merror(FWRITE_ERROR, KEYS_FILE, errno, strerror(errno));
+            r = -1;
+            break;
+        }
+
+        if (entry->time_added == 0) {
+            continue;
+        }
+
+        strftime(timestamp, 40, "%Y-%m-%d %H:%M:%S", localtime_r(&entry->time_added, &tm_result));
+
+        if (fprintf(fp_timestamps, "%s %s %s %s\n", entry->id, entry->name, ip, timestamp) < 0) {
+            merror(FWRITE_ERROR, TIMESTAMP_FILE, errno, strerror(errno));
+            r = -1;
+            break;
+        }
+    }
+
+    if (fclose(fp_keys) != 0) {
+        merror(FCLOSE_ERROR, KEYS_FILE, errno, strerror(errno));
+        r = -1;
+    }
+
+    if (fclose(fp_timestamps) != 0) {
+        merror(FCLOSE_ERROR, TIMESTAMP_FILE, errno, strerror(errno));
+        r = -1;
+    }
+
+    return r;
+}
+
 /* Duplicate keystore except key hashes and file pointer */
 keystore* OS_DupKeys(const keystore *keys) {
     keystore *copy;
@@ -632,6 +697,7 @@ keystore* OS_DupKeys(const keystore *keys) {
     copy->keysize = keys->keysize;
     copy->file_change = keys->file_change;
     copy->inode = keys->inode;
+    copy->file_size = keys->file_size;
     copy->id_counter = keys->id_counter;
     w_mutex_init(&copy->keytree_sock_mutex, NULL);
 
@@ -24,18 +24,6 @@ int OS_Alert_SendSyslog(alert_data *al_data, SyslogConfig *syslog_config) {
     char *hostname;
     char syslog_msg[OS_MAXSTR];
 
-
-    /* Invalid socket, reconnect */
-    if (syslog_config->socket < 0) {
-        resolve_hostname(&syslog_config->server, 5);
-
-        syslog_config->socket = OS_ConnectUDP(syslog_config->port, get_ip_from_resolved_hostname(syslog_config->server), 0);
-        if (syslog_config->socket < 0) {
-            return (0);
-        }
-        mdebug2(SUCCESSFULLY_RECONNECTED_SOCKET, syslog_config->server);
-    }
-
     /* Clear the memory before insert */
     memset(syslog_msg, '\0', OS_MAXSTR);
 
@@ -310,11 +298,8 @@ int OS_Alert_SendSyslog(alert_data *al_data, SyslogConfig *syslog_config) {
         field_add_truncated(syslog_msg, OS_SIZE_61440, " message=\"%s\"", al_data->log[0], 2 );
     }
 
-    if (OS_SendUDPbySize(syslog_config->socket, strlen(syslog_msg), syslog_msg) != 0) {
-        OS_CloseSocket(syslog_config->socket);
-        syslog_config->socket = -1;
-        merror(ERROR_SENDING_MSG, syslog_config->server);
-    }
+    /* Buffered until the batch is full or the queue goes idle */
+    csyslog_send(syslog_config, syslog_msg, strlen(syslog_msg));
 
     return (1);
 }
@@ -431,23 +416,8 @@ int OS_Alert_SendSyslog_JSON(cJSON *json_data, SyslogConfig *syslog_config) {
              string
             );
 
-    /* Invalid socket, reconnect */
-    if (syslog_config->socket < 0) {
-        resolve_hostname(&syslog_config->server, 5);
-
-        syslog_config->socket = OS_ConnectUDP(syslog_config->port, get_ip_from_resolved_hostname(syslog_config->server), 0);
-        if (syslog_config->socket < 0) {
-            return (0);
-        }
-        mdebug2(SUCCESSFULLY_RECONNECTED_SOCKET, syslog_config->server);
-    }
-
     mdebug2("OS_Alert_SendSyslog_JSON(): sending '%s'", msg);
-    if (OS_SendUDPbySize(syslog_config->socket, strlen(msg), msg) != 0) {
-        OS_CloseSocket(syslog_config->socket);
-        syslog_config->socket = -1;
-        merror(ERROR_SENDING_MSG, syslog_config->server);
-    }
+    csyslog_send(syslog_config, msg, strlen(msg));
     free(string);
 
     return 1;
@@ -32,6 +32,7 @@ void OS_CSyslogD(SyslogConfig **syslog_config)
     time_t tm;
     struct tm tm_result = { .tm_sec = 0 };
     int tries = 0;
+    unsigned int buffered = 0;
     alert_source_t sources = get_alert_sources(syslog_config);
     file_queue *fileq = NULL;
     file_queue jfileq;
@@ -83,12 +84,9 @@ void OS_CSyslogD(SyslogConfig **syslog_config)
 
     for (s = 0; syslog_config[s]; s++) {
         mdebug2("Resolving server hostname: %s", syslog_config[s]->server);
-        resolve_hostname(&syslog_config[s]->server, 5);
 
-        syslog_config[s]->socket = OS_ConnectUDP(syslog_config[s]->port, get_ip_from_resolved_hostname(syslog_config[s]->server), 0);
-
-        if (syslog_config[s]->socket < 0) {
-            merror(CONNS_ERROR, syslog_config[s]->server, syslog_config[s]->port, "udp", strerror(errno));
+        if (csyslog_connect(syslog_config[s]) < 0) {
+            merror(CONNS_ERROR, syslog_config[s]->server, syslog_config[s]->port, syslog_config[s]->protocol == IPPROTO_TCP ? "tcp" : "udp", strerror(errno));
         } else {
             minfo("Forwarding alerts via syslog to: '%s:%d'.",
                    syslog_config[s]->server, syslog_config[s]->port);
@@ -102,13 +100,19 @@ void OS_CSyslogD(SyslogConfig **syslog_config)
 
         if (sources.alert_log) {
             /* Get message if available (timeout of 5 seconds) */
+            /* Do not wait for alerts while there are messages to send */
             mdebug2("Read_FileMon()");
-            al_data = Read_FileMon(fileq, &tm_result, 1);
+            al_data = Read_FileMon(fileq, &tm_result, buffered ? FQ_NOWAIT : 1);
         }
 
         if (sources.alert_json) {
             mdebug2("jqueue_next()");
             json_data = jqueue_next(&jfileq);
+
+            /* Read_FileMon() waits for the log alerts */
+            if (!json_data && !sources.alert_log && !buffered) {
+                jqueue_wait(&jfileq, FQ_TIMEOUT);
+            }
         }
 
         /* Send via syslog */
@@ -123,6 +127,9 @@ void OS_CSyslogD(SyslogConfig **syslog_config)
             }
         }
 
+        /* Send the buffered messages once the queues are idle */
+        buffered = csyslog_flush_all(syslog_config, !al_data && !json_data);
+
         /* Clear the memory */
 
         if (al_data) {
@@ -16,6 +16,22 @@
 
 #define OS_CSYSLOGD_MAX_TRIES 10
 
+#define CSYSLOG_BUFFER_SIZE     (OS_MAXSTR * 4) // Bytes buffered per server
+#define CSYSLOG_BATCH_SIZE      64              // Messages buffered per server
+#define CSYSLOG_FLUSH_INTERVAL  1               // Seconds a message may wait in the buffer
+#define CSYSLOG_SEND_TIMEOUT    10              // Seconds to wait for a stalled TCP server
+
+/* Messages waiting to be sent to a server. Messages are stored back to back
+ * in data, already framed for stream servers (RFC 6587 octet counting).
+ */
+typedef struct csyslog_buffer {
+    char *data;
+    size_t length;              // Bytes used in data
+    size_t ends[CSYSLOG_BATCH_SIZE];    // End offset of every message
+    unsigned int count;         // Messages in the buffer
+    time_t since;               // Arrival of the oldest message
+} csyslog_buffer;
+
 /** Prototypes **/
 
 /* Read syslog config */
@@ -37,6 +53,28 @@ int OS_Alert_SendSyslog(alert_data *al_data, SyslogConfig *syslog_config);
  */
 int OS_Alert_SendSyslog_JSON(cJSON *json_data, SyslogConfig *syslog_config);
 
+/* Connect to the server of an output
+ * Returns the socket or -1 on error
+ */
+int csyslog_connect(SyslogConfig *syslog_config);
+
+/* Queue a message to a server, sending the buffer if it gets full
+ * Returns 0 on success or -1 if the message was dropped
+ */
+int csyslog_send(SyslogConfig *syslog_config, const char *msg, size_t length);
+
+/* Send the buffered messages: datagrams in a single sendmmsg() call, or
+ * the stream in as few writes as possible
+ * Returns 0 on success or -1 if messages were dropped
+ */
+int csyslog_flush(SyslogConfig *syslog_config);
+
+/* Send the buffers that are older than CSYSLOG_FLUSH_INTERVAL, or all of
+ * them if force is set
+ * Returns the number of messages left in the buffers
+ */
+unsigned int csyslog_flush_all(SyslogConfig **syslog_config, int force);
+
 /* Database inserting main function */
 void OS_CSyslogD(SyslogConfig **syslog_config) __attribute__((noreturn));
 
@@ -0,0 +1,232 @@
+/* Copyright (C) 2015, Wazuh Inc.
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include "shared.h"
+#include "csyslogd.h"
+#include "os_net/os_net.h"
+
+static int csyslog_send_datagrams(int sock, csyslog_buffer *buffer, unsigned int *sent);
+static int csyslog_send_stream(int sock, const csyslog_buffer *buffer, unsigned int *sent);
+
+/* Connect to the server of an output */
+int csyslog_connect(SyslogConfig *syslog_config) {
+    const char *ip;
+
+    resolve_hostname(&syslog_config->server, 5);
+    ip = get_ip_from_resolved_hostname(syslog_config->server);
+
+    if (syslog_config->protocol == IPPROTO_TCP) {
+        syslog_config->socket = OS_ConnectTCP(syslog_config->port, ip, 0);
+
+        /* Do not let a stalled server block the daemon */
+        if (syslog_config->socket >= 0 && OS_SetSendTimeout(syslog_config->socket, CSYSLOG_SEND_TIMEOUT) < 0) {
+            mwarn("Cannot set send timeout for '%s': %s (%d)", syslog_config->server, strerror(errno), errno);
+        }
+    } else {
+        syslog_config->socket = OS_ConnectUDP(syslog_config->port, ip, 0);
+    }
+
+    return syslog_config->socket;
+}
+
+/* Queue a message to a server */
+int csyslog_send(SyslogConfig *syslog_config, const char *msg, size_t length) {
+    csyslog_buffer *buffer;
+    char header[32] = "";
+    size_t header_len = 0;
+
+    if (!syslog_config->buffer) {
+        os_calloc(1, sizeof(csyslog_buffer), syslog_config->buffer);
+        os_malloc(CSYSLOG_BUFFER_SIZE, syslog_config->buffer->data);
+    }
+
+    buffer = syslog_config->buffer;
+
+    /* Octet counting: MSG-LEN SP SYSLOG-MSG */
+    if (syslog_config->protocol == IPPROTO_TCP) {
+        header_len = (size_t)snprintf(header, sizeof(header), "%zu ", length);
+    }
+
+    if (header_len + length > CSYSLOG_BUFFER_SIZE) {
+        merror(ERROR_SENDING_MSG, syslog_config->server);
+        return -1;
+    }
+
+    if (buffer->length + header_len + length > CSYSLOG_BUFFER_SIZE) {
+        csyslog_flush(syslog_config);
+    }
+
+    if (buffer->count == 0) {
+        buffer->since = time(NULL);
+    }
+
+    memcpy(buffer->data + buffer->length, header, header_len);
+    memcpy(buffer->data + buffer->length + header_len, msg, length);
+    buffer->length += header_len + length;
+    buffer->ends[buffer->count++] = buffer->length;
+
+    return buffer->count < CSYSLOG_BATCH_SIZE ? 0 : csyslog_flush(syslog_config);
+}
+
+/* Send the buffered messages */
+int csyslog_flush(SyslogConfig *syslog_config) {
+    csyslog_buffer *buffer = syslog_config->buffer;
+    unsigned int sent = 0;
+    int retval = -1;
+    int tries;
+
+    if (!buffer || buffer->count == 0) {
+        return 0;
+    }
+
+    /* Try once more on a new connection, from the first message not sent */
+    for (tries = 0; tries < 2; tries++) {
+        /* Invalid socket, reconnect */
+        if (syslog_config->socket < 0) {
+            if (csyslog_connect(syslog_config) < 0) {
+                break;
+            }
+
+            mdebug2(SUCCESSFULLY_RECONNECTED_SOCKET, syslog_config->server);
+        }
+
+        if (syslog_config->protocol == IPPROTO_TCP) {
+            retval = csyslog_send_stream(syslog_config->socket, buffer, &sent);
+        } else {
+            retval = csyslog_send_datagrams(syslog_config->socket, buffer, &sent);
+        }
+
+        if (retval == 0) {
+            break;
+        }
+
+        OS_CloseSocket(syslog_config->socket);
+        syslog_config->socket = -1;
+        merror(ERROR_SENDING_MSG, syslog_config->server);
+    }
+
+    if (sent < buffer->count) {
+        mdebug1("Discarding %u messages to '%s'.", buffer->count - sent, syslog_config->server);
+    }
+
+    buffer->length = 0;
+    buffer->count = 0;
+
+    return retval;
+}
+
+/* Send the buffers that are too old, or all of them if force is set */
+unsigned int csyslog_flush_all(SyslogConfig **syslog_config, int force) {
+    unsigned int buffered = 0;
+    time_t now = time(NULL);
+    int s;
+
+    for (s = 0; syslog_config[s]; s++) {
+        csyslog_buffer *buffer = syslog_config[s]->buffer;
+
+        if (!buffer || buffer->count == 0) {
+            continue;
+        }
+
+        if (force || now - buffer->since >= CSYSLOG_FLUSH_INTERVAL) {
+            csyslog_flush(syslog_config[s]);
+        } else {
+            buffered += buffer->count;
+        }
+    }
+
+    return buffered;
+}
+
+/* Send a datagram per message. sent counts the messages delivered. */
+static int csyslog_send_datagrams(int sock, csyslog_buffer *buffer, unsigned int *sent) {
+    unsigned int i;
+    size_t start = 0;
+
+#ifdef __linux__
+    struct mmsghdr msgs[CSYSLOG_BATCH_SIZE];
+    struct iovec iov[CSYSLOG_BATCH_SIZE];
+    unsigned int retries = 0;
+    int n;
+
+    memset(msgs, 0, sizeof(msgs));
+
+    for (i = 0; i < buffer->count; i++) {
+        iov[i].iov_base = buffer->data + start;
+        iov[i].iov_len = buffer->ends[i] - start;
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        start = buffer->ends[i];
+    }
+
+    while (*sent < buffer->count) {
+        if (n = sendmmsg(sock, msgs + *sent, buffer->count - *sent, 0), n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            /* Drop only the message that does not fit in a datagram */
+            if (errno == EMSGSIZE) {
+                mdebug1("Message of %zu bytes too long for a datagram.", iov[*sent].iov_len);
+                ++*sent;
+                continue;
+            }
+
+            /* Maximum attempts is 5 */
+            if (errno != ENOBUFS || retries >= 5) {
+                return OS_SOCKTERR;
+            }
+
+            retries++;
+            minfo("Remote socket busy, waiting %d s.", retries);
+            sleep(retries);
+            continue;
+        }
+
+        *sent += n;
+    }
+#else
+    for (i = 0; i < buffer->count; i++) {
+        if (OS_SendUDPbySize(sock, buffer->ends[i] - start, buffer->data + start) != 0) {
+            return OS_SOCKTERR;
+        }
+
+        start = buffer->ends[i];
+        ++*sent;
+    }
+#endif
+
+    return 0;
+}
+
+/* Write the stream, resuming at message sent. sent counts the messages
+ * written completely.
+ */
+static int csyslog_send_stream(int sock, const csyslog_buffer *buffer, unsigned int *sent) {
+    size_t offset = *sent ? buffer->ends[*sent - 1] : 0;
+    ssize_t n;
+
+    while (offset < buffer->length) {
+        if (n = send(sock, buffer->data + offset, buffer->length - offset, 0), n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            return OS_SOCKTERR;
+        }
+
+        offset += n;
+
+        while (*sent < buffer->count && buffer->ends[*sent] <= offset) {
+            ++*sent;
+        }
+    }
+
+    return 0;
+}
@@ -9,7 +9,6 @@
  */
 
 #include "shared.h"
-#include "list_op.h"
 #include "os_regex/os_regex.h"
 #include "os_net/os_net.h"
 #include "wazuh_modules/wmodules.h"
@@ -27,8 +26,13 @@
 int repeated_offenders_timeout[] = {0, 0, 0, 0, 0, 0, 0};
 time_t pending_upg = 0;
 
-STATIC OSList *timeout_list;
-STATIC OSListNode *timeout_node;
+/* Pending timeouts: a min-heap by expiration time, indexed by rkey */
+STATIC timeout_data **timeout_heap;
+STATIC unsigned int timeout_count;
+STATIC OSHash *timeout_hash;
+static unsigned int timeout_capacity;
+static pthread_mutex_t timeout_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 STATIC OSHash *repeated_hash;
 
 #ifdef WIN32
@@ -39,6 +43,15 @@ extern w_queue_t * winexec_queue;
 DWORD WINAPI win_exec_main(void * args);
 #endif
 
+static void timeout_sift_up(unsigned int i);
+static void timeout_sift_down(unsigned int i);
+static timeout_data * timeout_remove_top(void);
+static timeout_data * timeout_pop(void);
+static void timeout_run_pending(const timeout_data *list_entry);
+
+/* Time after which the entry must be executed */
+#define TIMEOUT_EXPIRATION(entry) ((entry)->time_of_addition + (entry)->time_to_block)
+
 
 /* Free the timeout entry
  * Must be called after popping it from the timeout list
@@ -70,16 +83,153 @@ void FreeTimeoutEntry(timeout_data *timeout_entry)
     os_free(timeout_entry);
 }
 
+/* Create the timeout list
+ * Returns 0 on success or -1 on error
+ */
+int CreateTimeoutList() {
+    timeout_heap = NULL;
+    timeout_count = 0;
+    timeout_capacity = 0;
+
+    if (timeout_hash = OSHash_Create(), !timeout_hash) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/* Add an entry to the timeout list
+ * Returns 0 on success or -1 if its rkey is already in the list
+ */
+int AddTimeoutEntry(timeout_data *timeout_entry) {
+    int retval = -1;
+
+    w_mutex_lock(&timeout_mutex);
+
+    if (OSHash_Add_ex(timeout_hash, timeout_entry->rkey, timeout_entry) == 2) {
+        if (timeout_count == timeout_capacity) {
+            timeout_capacity = timeout_capacity ? timeout_capacity * 2 : MAX_AR;
+            os_realloc(timeout_heap, timeout_capacity * sizeof(timeout_data *), timeout_heap);
+        }
+
+        timeout_entry->index = timeout_count;
+        timeout_heap[timeout_count++] = timeout_entry;
+        timeout_sift_up(timeout_entry->index);
+        retval = 0;
+    }
+
+    w_mutex_unlock(&timeout_mutex);
+    return retval;
+}
+
 /* Free the timeout list
  */
 void FreeTimeoutList() {
-    timeout_node = OSList_GetFirstNode(timeout_list);
-    while (timeout_node) {
-        FreeTimeoutEntry((timeout_data *)timeout_node->data);
-        OSList_DeleteCurrentlyNode(timeout_list);
-        timeout_node = OSList_GetCurrentlyNode(timeout_list);
+    timeout_data *timeout_entry;
+
+    while (timeout_entry = timeout_pop(), timeout_entry) {
+        FreeTimeoutEntry(timeout_entry);
+    }
+
+    os_free(timeout_heap);
+    timeout_capacity = 0;
+
+    if (timeout_hash) {
+        OSHash_Free(timeout_hash);
+        timeout_hash = NULL;
+    }
+}
+
+/* Move an entry up while it expires before its parent */
+static void timeout_sift_up(unsigned int i) {
+    timeout_data *entry = timeout_heap[i];
+
+    while (i > 0) {
+        unsigned int parent = (i - 1) / 2;
+
+        if (TIMEOUT_EXPIRATION(timeout_heap[parent]) <= TIMEOUT_EXPIRATION(entry)) {
+            break;
+        }
+
+        timeout_heap[i] = timeout_heap[parent];
+        timeout_heap[i]->index = i;
+        i = parent;
+    }
+
+    timeout_heap[i] = entry;
+    entry->index = i;
+}
+
+/* Move an entry down while any child expires before it */
+static void timeout_sift_down(unsigned int i) {
+    timeout_data *entry = timeout_heap[i];
+
+    while (2 * i + 1 < timeout_count) {
+        unsigned int child = 2 * i + 1;
+
+        if (child + 1 < timeout_count && TIMEOUT_EXPIRATION(timeout_heap[child + 1]) < TIMEOUT_EXPIRATION(timeout_heap[child])) {
+            child++;
+        }
+
+        if (TIMEOUT_EXPIRATION(entry) <= TIMEOUT_EXPIRATION(timeout_heap[child])) {
+            break;
+        }
+
+        timeout_heap[i] = timeout_heap[child];
+        timeout_heap[i]->index = i;
+        i = child;
+    }
+
+    timeout_heap[i] = entry;
+    entry->index = i;
+}
+
+/* Remove the entry that expires first from a non-empty list
+ * The caller must hold timeout_mutex
+ */
+static timeout_data * timeout_remove_top() {
+    timeout_data *timeout_entry = timeout_heap[0];
+
+    OSHash_Delete_ex(timeout_hash, timeout_entry->rkey);
+
+    if (--timeout_count > 0) {
+        timeout_heap[0] = timeout_heap[timeout_count];
+        timeout_sift_down(0);
+    }
+
+    return timeout_entry;
+}
+
+/* Remove the entry that expires first from the list
+ * Returns NULL if the list is empty
+ */
+static timeout_data * timeout_pop() {
+    timeout_data *timeout_entry = NULL;
+
+    w_mutex_lock(&timeout_mutex);
+
+    if (timeout_count > 0) {
+        timeout_entry = timeout_remove_top();
+    }
+
+    w_mutex_unlock(&timeout_mutex);
+    return timeout_entry;
+}
+
+/* Run the command of a pending active response so that it is reverted */
+static void timeout_run_pending(const timeout_data *list_entry)
+{
+    mdebug2("Delete pending AR: '%s' '%s'", list_entry->command[0], list_entry->parameters);
+
+    wfd_t *wfd = wpopenv(list_entry->command[0], list_entry->command, W_BIND_STDIN);
+    if (wfd) {
+        /* Send alert to AR script */
+        fprintf(wfd->file_in, "%s\n", list_entry->parameters);
+        fflush(wfd->file_in);
+        wpclose(wfd);
+    } else {
+        merror(EXEC_CMD_FAIL, strerror(errno), errno);
     }
-    os_free(timeout_list);
 }
 
 #ifdef WIN32
@@ -91,85 +241,86 @@ void ExecdShutdown(int sig)
     /* Remove pending active responses */
     minfo(EXEC_SHUTDOWN);
 
-    timeout_node = timeout_list ? OSList_GetFirstNode(timeout_list) : NULL;
-    while (timeout_node) {
-        timeout_data *list_entry;
-
-        list_entry = (timeout_data *)timeout_node->data;
-
-        mdebug2("Delete pending AR: '%s' '%s'", list_entry->command[0], list_entry->parameters);
-
-        wfd_t *wfd = wpopenv(list_entry->command[0], list_entry->command, W_BIND_STDIN);
-        if (wfd) {
-            /* Send alert to AR script */
-            fprintf(wfd->file_in, "%s\n", list_entry->parameters);
-            fflush(wfd->file_in);
-            wpclose(wfd);
-        } else {
-            merror(EXEC_CMD_FAIL, strerror(errno), errno);
-        }
+#ifdef WIN32
+    timeout_data *list_entry;
 
-        /* Delete current node - already sets the pointer to next */
-        OSList_DeleteCurrentlyNode(timeout_list);
-        timeout_node = OSList_GetCurrentlyNode(timeout_list);
+    while (timeout_hash && (list_entry = timeout_pop(), list_entry)) {
+        timeout_run_pending(list_entry);
 
         /* Clear the memory */
         FreeTimeoutEntry(list_entry);
     }
+#else
+    unsigned int i;
+
+    /* This is a signal handler: the interrupted code may hold timeout_mutex,
+     * so the heap is walked without locking it. The process exits next.
+     */
+    for (i = 0; timeout_heap && i < timeout_count; i++) {
+        timeout_run_pending(timeout_heap[i]);
+    }
 
-#ifndef WIN32
     HandleSIG(sig);
 #endif
 }
 
+/* Execute the timed out commands
+ * Returns the seconds until the next one times out, or -1 if there are none
+ */
 #ifdef WIN32
-void ExecdTimeoutRun()
+int ExecdTimeoutRun()
 #else
-void ExecdTimeoutRun(int *childcount)
+int ExecdTimeoutRun(int *childcount)
 #endif
 {
     time_t curr_time = time(NULL);
+    int wait_time = -1;
 
-    /* Check if there is any timed out command to execute */
-    timeout_node = OSList_GetFirstNode(timeout_list);
-    while (timeout_node) {
-        timeout_data *list_entry;
-
-        list_entry = (timeout_data *)timeout_node->data;
-
-        /* Timed out */
-        if ((curr_time - list_entry->time_of_addition) > list_entry->time_to_block) {
+    /* Only the entry at the top of the heap can be timed out */
+    while (1) {
+        timeout_data *list_entry = NULL;
 
-            mdebug1("Executing command '%s %s' after a timeout of '%ds'",
-                list_entry->command[0],
-                list_entry->parameters ? list_entry->parameters : "",
-                list_entry->time_to_block
-            );
+        w_mutex_lock(&timeout_mutex);
 
-            wfd_t *wfd = wpopenv(list_entry->command[0], list_entry->command, W_BIND_STDIN);
-            if (wfd) {
-                /* Send alert to AR script */
-                fprintf(wfd->file_in, "%s\n", list_entry->parameters);
-                fflush(wfd->file_in);
-                wpclose(wfd);
+        if (timeout_count > 0) {
+            if ((curr_time - timeout_heap[0]->time_of_addition) > timeout_heap[0]->time_to_block) {
+                list_entry = timeout_remove_top();
             } else {
-                merror(EXEC_CMD_FAIL, strerror(errno), errno);
+                wait_time = (int)(TIMEOUT_EXPIRATION(timeout_heap[0]) - curr_time + 1);
             }
+        }
 
-            /* Delete currently node - already sets the pointer to next */
-            OSList_DeleteCurrentlyNode(timeout_list);
-            timeout_node = OSList_GetCurrentlyNode(timeout_list);
+        w_mutex_unlock(&timeout_mutex);
 
-            /* Clear the memory */
-            FreeTimeoutEntry(list_entry);
+        if (!list_entry) {
+            break;
+        }
 
-#ifndef WIN32
-            (*childcount)++;
-#endif
+        mdebug1("Executing command '%s %s' after a timeout of '%ds'",
+            list_entry->command[0],
+            list_entry->parameters ? list_entry->parameters : "",
+            list_entry->time_to_block
+        );
+
+        wfd_t *wfd = wpopenv(list_entry->command[0], list_entry->command, W_BIND_STDIN);
+        if (wfd) {
+            /* Send alert to AR script */
+            fprintf(wfd->file_in, "%s\n", list_entry->parameters);
+            fflush(wfd->file_in);
+            wpclose(wfd);
         } else {
-            timeout_node = OSList_GetNextNode(timeout_list);
+            merror(EXEC_CMD_FAIL, strerror(errno), errno);
         }
+
+        /* Clear the memory */
+        FreeTimeoutEntry(list_entry);
+
+#ifndef WIN32
+        (*childcount)++;
+#endif
     }
+
+    return wait_time;
 }
 
 #ifdef WIN32
@@ -336,26 +487,23 @@ void ExecdRun(char *exec_msg, int *childcount)
             }
 
             /* Check if this command was already executed */
-            timeout_node = OSList_GetFirstNode(timeout_list);
-            while (timeout_node) {
-                timeout_data *list_entry;
-
-                list_entry = (timeout_data *)timeout_node->data;
-                if (strcmp(list_entry->rkey, rkey) == 0) {
-                    /* Means we executed this command before and we don't need to add it again */
-                    added_before = 1;
-
-                    /* Update the timeout */
-                    mdebug1("Command already received, updating time of addition to now.");
-                    list_entry->time_of_addition = curr_time;
-                    list_entry->time_to_block = timeout_value;
-                    break;
-                }
-
-                /* Continue with the next entry in timeout list */
-                timeout_node = OSList_GetNextNode(timeout_list);
+            w_mutex_lock(&timeout_mutex);
+
+            timeout_data *list_entry = OSHash_Get_ex(timeout_hash, rkey);
+            if (list_entry) {
+                /* Means we executed this command before and we don't need to add it again */
+                added_before = 1;
+
+                /* Update the timeout and its place in the heap */
+                mdebug1("Command already received, updating time of addition to now.");
+                list_entry->time_of_addition = curr_time;
+                list_entry->time_to_block = timeout_value;
+                timeout_sift_down(list_entry->index);
+                timeout_sift_up(list_entry->index);
             }
 
+            w_mutex_unlock(&timeout_mutex);
+
             /* If it wasn't added before, do it now */
             if (!added_before) {
                 /* Timeout parameters */
@@ -378,7 +526,7 @@ void ExecdRun(char *exec_msg, int *childcount)
                     timeout_entry->time_to_block
                 );
 
-                if (!OSList_AddData(timeout_list, timeout_entry)) {
+                if (AddTimeoutEntry(timeout_entry) < 0) {
                     merror(LIST_ADD_ERROR);
                     FreeTimeoutEntry(timeout_entry);
                 }
@@ -425,14 +573,14 @@ void ExecdStart(int q)
     /* Select */
     fd_set fdset;
     struct timeval socket_timeout;
+    int wait_time;
 
     /* Clear the buffer */
     memset(buffer, '\0', OS_MAXSTR + 1);
 
 #ifndef WAZUH_UNIT_TESTING
     /* Create list for timeout */
-    timeout_list = OSList_Create();
-    if (!timeout_list) {
+    if (CreateTimeoutList() < 0) {
         merror_exit(LIST_ERROR);
     }
 #endif
@@ -463,10 +611,14 @@ void ExecdStart(int q)
             }
         }
 
-        ExecdTimeoutRun(&childcount);
+        wait_time = ExecdTimeoutRun(&childcount);
+
+        /* Wake up for the next timeout, or every EXECD_TIMEOUT while children are pending */
+        if (childcount && (wait_time < 0 || wait_time > EXECD_TIMEOUT)) {
+            wait_time = EXECD_TIMEOUT;
+        }
 
-        /* Set timeout to EXECD_TIMEOUT */
-        socket_timeout.tv_sec = EXECD_TIMEOUT;
+        socket_timeout.tv_sec = wait_time;
         socket_timeout.tv_usec = 0;
 
         /* Set FD values */
@@ -474,7 +626,7 @@ void ExecdStart(int q)
         FD_SET(q, &fdset);
 
         /* Add timeout */
-        if (select(q + 1, &fdset, NULL, NULL, &socket_timeout) == 0) {
+        if (select(q + 1, &fdset, NULL, NULL, wait_time < 0 ? NULL : &socket_timeout) == 0) {
             /* Timeout */
             continue;
         }
@@ -521,8 +673,7 @@ int WinExecdStart()
     }
 
     /* Create list for timeout */
-    timeout_list = OSList_Create();
-    if (!timeout_list) {
+    if (CreateTimeoutList() < 0) {
         merror_exit(LIST_ERROR);
     }
 
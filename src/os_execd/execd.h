@@ -50,7 +50,7 @@ int ExecdConfig(const char *cfgfile) __attribute__((nonnull));
 #ifdef WIN32
 int WinExecdStart(void);
 void ExecdRun(char *exec_msg);
-void ExecdTimeoutRun();
+int ExecdTimeoutRun();
 void ExecdShutdown();
 #else
 #ifdef WAZUH_UNIT_TESTING
@@ -59,7 +59,7 @@ void ExecdStart(int q);
 void ExecdStart(int q) __attribute__((noreturn));
 #endif
 void ExecdRun(char *exec_msg, int *childcount);
-void ExecdTimeoutRun(int *childcount);
+int ExecdTimeoutRun(int *childcount);
 void ExecdShutdown(int sig) __attribute__((noreturn));
 #endif
 
@@ -83,8 +83,11 @@ typedef struct _timeout_data {
     char **command;
     char *parameters;
     char *rkey;
+    unsigned int index;     // Position in the timeout heap
 } timeout_data;
 
+int CreateTimeoutList();
+int AddTimeoutEntry(timeout_data *timeout_entry);
 void FreeTimeoutEntry(timeout_data *timeout_entry);
 void FreeTimeoutList();
 
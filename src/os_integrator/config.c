@@ -46,6 +46,7 @@ cJSON *getIntegratorConfig(void) {
         if (integrator_config[i]->apikey) cJSON_AddStringToObject(cfg,"api_key",integrator_config[i]->apikey);
         cJSON_AddNumberToObject(cfg,"level",integrator_config[i]->level);
         cJSON_AddNumberToObject(cfg,"max_log",integrator_config[i]->max_log);
+        cJSON_AddStringToObject(cfg,"persistent",integrator_config[i]->persistent ? "yes" : "no");
         if (integrator_config[i]->rule_id) {
             cJSON *ids = cJSON_CreateArray();
             for(j=0;integrator_config[i]->rule_id[j];j++){
@@ -13,6 +13,192 @@
 #include <external/cJSON/cJSON.h>
 #include "os_net/os_net.h"
 
+/* Long-lived integration process reading one JSON alert per line */
+typedef struct integrator_worker {
+    wfd_t *wfd;
+    char *batch[INTEGRATOR_WORKER_BATCH];   // Alerts written since the last flush
+    unsigned int pending;                   // Number of alerts in batch
+    time_t last_start;
+} integrator_worker;
+
+/* Start the worker of a persistent integration. The first argument "-" tells
+ * the script to read alerts from its standard input until it gets closed.
+ */
+static int integrator_worker_start(const IntegratorConfig *config, integrator_worker *worker)
+{
+    time_t now = time(NULL);
+    char *argv[] = { config->path, "-", config->apikey ? config->apikey : "", config->hookurl ? config->hookurl : "", isDebug() > 0 ? "debug" : NULL, NULL };
+
+    if (worker->last_start && now - worker->last_start < INTEGRATOR_WORKER_RESTART) {
+        return -1;
+    }
+
+    worker->last_start = now;
+
+    if (worker->wfd = wpopenv(config->path, argv, W_BIND_STDIN | W_CHECK_WRITE), !worker->wfd) {
+        merror("Could not launch integration '%s': %s (%d)", config->name, strerror(errno), errno);
+        return -1;
+    }
+
+    mdebug1("Integration '%s' worker started (pid %d).", config->name, (int)worker->wfd->pid);
+    return 0;
+}
+
+/* Close the worker input and wait for it to exit. The alerts of the current
+ * batch are kept, since the worker may not have got them.
+ */
+static void integrator_worker_stop(const IntegratorConfig *config, integrator_worker *worker)
+{
+    int wstatus;
+
+    if (!worker->wfd) {
+        return;
+    }
+
+    wstatus = wpclose(worker->wfd);
+    worker->wfd = NULL;
+
+    if (wstatus != -1 && WIFEXITED(wstatus)) {
+        if (WEXITSTATUS(wstatus) == 127) {
+            merror("Couldn't execute integration '%s'. Check file and permissions.", config->name);
+        } else {
+            mwarn("Integration '%s' worker exited with status %d.", config->name, WEXITSTATUS(wstatus));
+        }
+    } else {
+        mwarn("Integration '%s' worker exited abnormally.", config->name);
+    }
+}
+
+/* Forget the alerts of the current batch */
+static void integrator_worker_clear(integrator_worker *worker)
+{
+    unsigned int i;
+
+    for (i = 0; i < worker->pending; i++) {
+        os_free(worker->batch[i]);
+    }
+
+    worker->pending = 0;
+}
+
+/* Write an alert line to the worker pipe */
+static int integrator_worker_write(integrator_worker *worker, const char *alert)
+{
+    if (fputs(alert, worker->wfd->file_in) == EOF || fputc('\n', worker->wfd->file_in) == EOF) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/* Run the script once for an alert, as the non-persistent integrations do.
+ * Used while the worker cannot be restarted.
+ */
+static void integrator_worker_run_once(const IntegratorConfig *config, const char *alert)
+{
+    char alert_file[2048 + 1];
+    char buffer[4096];
+    char *argv[] = { config->path, alert_file, config->apikey ? config->apikey : "", config->hookurl ? config->hookurl : "", isDebug() > 0 ? "debug" : NULL, NULL };
+    wfd_t *wfd;
+    FILE *fp;
+    int wstatus;
+
+    snprintf(alert_file, sizeof(alert_file), "/tmp/%s-%d-%ld.alert", config->name, (int)time(0), (long int)os_random());
+
+    if (fp = fopen(alert_file, "w"), !fp) {
+        merror("Unable to deliver alert to integration '%s'. Could not create '%s': %s (%d)", config->name, alert_file, strerror(errno), errno);
+        return;
+    }
+
+    fprintf(fp, "%s", alert);
+    fclose(fp);
+
+    mdebug1("Integration '%s' worker is down: running the script for the alert.", config->name);
+
+    if (wfd = wpopenv(config->path, argv, W_BIND_STDOUT | W_BIND_STDERR | W_CHECK_WRITE), wfd) {
+        while (fgets(buffer, sizeof(buffer), wfd->file_out)) {
+            mdebug2("integratord: %s", buffer);
+        }
+
+        wstatus = wpclose(wfd);
+
+        if (wstatus == -1 || !WIFEXITED(wstatus)) {
+            merror("Integration '%s' exited abnormally.", config->name);
+        } else if (WEXITSTATUS(wstatus) != 0) {
+            merror("Unable to run integration for %s. Exit status was: %d", config->name, WEXITSTATUS(wstatus));
+        }
+    } else {
+        merror("Could not launch integration '%s': %s (%d)", config->name, strerror(errno), errno);
+    }
+
+    unlink(alert_file);
+}
+
+/* Deliver the batch of a worker that died. A new worker gets the whole batch
+ * again; while restarts are throttled, or if the new worker fails too, the
+ * script is run once per alert.
+ */
+static void integrator_worker_replay(const IntegratorConfig *config, integrator_worker *worker)
+{
+    unsigned int i;
+
+    if (!worker->wfd && integrator_worker_start(config, worker) == 0) {
+        for (i = 0; i < worker->pending && integrator_worker_write(worker, worker->batch[i]) == 0; i++);
+
+        if (i == worker->pending && fflush(worker->wfd->file_in) != EOF) {
+            integrator_worker_clear(worker);
+            return;
+        }
+
+        integrator_worker_stop(config, worker);
+    }
+
+    for (i = 0; i < worker->pending; i++) {
+        integrator_worker_run_once(config, worker->batch[i]);
+    }
+
+    integrator_worker_clear(worker);
+}
+
+/* Push the batch to the worker. A broken pipe means that the worker died:
+ * the batch is delivered again.
+ */
+static void integrator_worker_flush(const IntegratorConfig *config, integrator_worker *worker)
+{
+    if (!worker->wfd || !worker->pending) {
+        return;
+    }
+
+    if (fflush(worker->wfd->file_in) == EOF) {
+        integrator_worker_stop(config, worker);
+        integrator_worker_replay(config, worker);
+    } else {
+        integrator_worker_clear(worker);
+    }
+}
+
+/* Queue an alert line to the worker, flushing every INTEGRATOR_WORKER_BATCH
+ * alerts. Writes block while the worker pipe is full, so a slow integration
+ * holds integratord back and alerts wait in the alerts file. The alerts are
+ * kept until they are flushed: if the worker dies they are sent again.
+ */
+static void integrator_worker_send(const IntegratorConfig *config, integrator_worker *worker, const char *alert)
+{
+    if (!worker->wfd && integrator_worker_start(config, worker) < 0) {
+        integrator_worker_run_once(config, alert);
+        return;
+    }
+
+    os_strdup(alert, worker->batch[worker->pending]);
+    worker->pending++;
+
+    if (integrator_worker_write(worker, alert) < 0) {
+        integrator_worker_stop(config, worker);
+        integrator_worker_replay(config, worker);
+    } else if (worker->pending >= INTEGRATOR_WORKER_BATCH) {
+        integrator_worker_flush(config, worker);
+    }
+}
 
 void OS_IntegratorD(IntegratorConfig **integrator_config)
 {
@@ -24,7 +210,9 @@ void OS_IntegratorD(IntegratorConfig **integrator_config)
     char integration_path[2048 + 1];
     char exec_tmp_file[2048 + 1];
     char exec_full_cmd[4096 + 1];
+    char *alert_line;
     FILE *fp;
+    integrator_worker *workers;
 
     file_queue jfileq;
     cJSON *al_json = NULL;
@@ -114,10 +302,25 @@ void OS_IntegratorD(IntegratorConfig **integrator_config)
         {
             minfo("Enabling integration for: '%s'.",
                    integrator_config[s]->name);
+
+            if(integrator_config[s]->persistent && (!integrator_config[s]->alert_format || strncmp(integrator_config[s]->alert_format, "json", 4) != 0))
+            {
+                mwarn("Integration '%s' is persistent: alerts will be sent in JSON format.", integrator_config[s]->name);
+            }
         }
         s++;
     }
 
+    os_calloc(s, sizeof(integrator_worker), workers);
+
+    for(s = 0; integrator_config[s]; s++)
+    {
+        if(integrator_config[s]->enabled && integrator_config[s]->persistent)
+        {
+            integrator_worker_start(integrator_config[s], &workers[s]);
+        }
+    }
+
     /* Infinite loop reading the alerts and inserting them. */
     while(1)
     {
@@ -126,12 +329,19 @@ void OS_IntegratorD(IntegratorConfig **integrator_config)
         mdebug2("jqueue_next()");
         al_json = jqueue_next(&jfileq);
         if(!al_json) {
-            sleep(1);
+            /* The queue is idle: hand the buffered alerts to the workers */
+            for(s = 0; integrator_config[s]; s++)
+            {
+                integrator_worker_flush(integrator_config[s], &workers[s]);
+            }
+
+            jqueue_wait(&jfileq, FQ_TIMEOUT);
             continue;
         }
 
         mdebug1("sending new alert.");
         temp_file_created = 0;
+        alert_line = NULL;
 
         /* If JSON does not contain rule block, continue */
         if (rule = cJSON_GetObjectItem(al_json, "rule"), !rule){
@@ -246,6 +456,19 @@ void OS_IntegratorD(IntegratorConfig **integrator_config)
                 }
             }
 
+            /* Persistent integrations get the alert through their worker */
+            if(integrator_config[s]->persistent)
+            {
+                if(!alert_line)
+                {
+                    alert_line = cJSON_PrintUnformatted(al_json);
+                }
+
+                integrator_worker_send(integrator_config[s], &workers[s], alert_line);
+                s++;
+                continue;
+            }
+
             /* Create temp file once per alert. */
             if(temp_file_created == 0)
             {
@@ -432,6 +655,7 @@ void OS_IntegratorD(IntegratorConfig **integrator_config)
         if(temp_file_created == 1)
             unlink(exec_tmp_file);
 
+        os_free(alert_line);
 
         if (al_json) {
             cJSON_Delete(al_json);
@@ -14,6 +14,9 @@
 
 #include "config/integrator-config.h"
 
+#define INTEGRATOR_WORKER_BATCH     64  // Alerts buffered before flushing a worker
+#define INTEGRATOR_WORKER_RESTART   10  // Seconds between worker restarts
+
 /** Prototypes **/
 
 /* Read syslog config */
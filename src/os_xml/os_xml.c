@@ -15,17 +15,24 @@
 #include <string.h>
 #include <stdlib.h>
 #include <ctype.h>
+#include <sys/stat.h>
 
 #include "os_xml.h"
 #include "os_xml_internal.h"
 #include "file_op.h"
 
+#define XML_READ_BLOCK      65536   /* Read size when the file size is unknown */
+#define XML_INITIAL_SIZE    64      /* Items allocated by the first element */
+
 /* Prototypes */
 static int _oscomment(OS_XML *_lxml) __attribute__((nonnull));
 static int _writecontent(const char *str, __attribute__((unused)) size_t size, unsigned int parent, OS_XML *_lxml) __attribute__((nonnull));
 static int _writememory(const char *str, XML_TYPE type, size_t size,
                         unsigned int parent, OS_XML *_lxml) __attribute__((nonnull));
 static int _xml_fgetc(FILE *fp, OS_XML *_lxml) __attribute__((nonnull));
+static int _xml_readfile(FILE *fp, OS_XML *_lxml) __attribute__((nonnull));
+static void _xml_close(OS_XML *_lxml, char *str_base) __attribute__((nonnull(1)));
+static int _xml_grow(OS_XML *_lxml) __attribute__((nonnull));
 int _xml_sgetc(OS_XML *_lxml)  __attribute__((nonnull));
 static int _getattributes(unsigned int parent, OS_XML *_lxml) __attribute__((nonnull));
 static void xml_error(OS_XML *_lxml, const char *msg, ...) __attribute__((format(printf, 2, 3), nonnull));
@@ -62,6 +69,10 @@ int _xml_sgetc(OS_XML *_lxml){
     if (_lxml->stash_i > 0) {
         c = _lxml->stash[--_lxml->stash_i];
     }
+    else if (_lxml->buffer) {
+        /* Same values as fgetc() */
+        c = (_lxml->buffer_pos < _lxml->buffer_len) ? (unsigned char)_lxml->buffer[_lxml->buffer_pos++] : EOF;
+    }
     else if (_lxml->string) {
         c = *(_lxml->string++);
     }
@@ -133,11 +144,72 @@ void OS_ClearXML(OS_XML *_lxml)
     free(_lxml->ln);
     _lxml->ln = NULL;
 
+    _lxml->size = 0;
+
     memset(_lxml->err, '\0', XML_ERR_LENGTH);
     _lxml->line = 0;
     _lxml->stash_i = 0;
 }
 
+/* Release the source of the XML once it is parsed */
+static void _xml_close(OS_XML *_lxml, char *str_base)
+{
+    if (_lxml->fp) {
+        fclose(_lxml->fp);
+        _lxml->fp = NULL;
+    } else if (_lxml->buffer) {
+        free(_lxml->buffer);
+        _lxml->buffer = NULL;
+        _lxml->buffer_len = 0;
+        _lxml->buffer_pos = 0;
+    } else if (str_base) {
+        free(str_base);
+    }
+}
+
+/* Read the whole file, so that it is parsed from memory in a single pass */
+static int _xml_readfile(FILE *fp, OS_XML *_lxml)
+{
+    struct stat statbuf;
+    size_t size = XML_READ_BLOCK;
+    size_t len = 0;
+    size_t nread;
+    char *buffer;
+    char *tmp;
+
+    if (fstat(fileno(fp), &statbuf) == 0 && S_ISREG(statbuf.st_mode)) {
+        size = (size_t)statbuf.st_size + 1;
+    }
+
+    if (buffer = malloc(size), buffer == NULL) {
+        return (-1);
+    }
+
+    /* The file may grow while it is read */
+    while (nread = fread(buffer + len, 1, size - len, fp), nread > 0) {
+        len += nread;
+
+        if (len == size) {
+            if (tmp = realloc(buffer, size * 2), tmp == NULL) {
+                free(buffer);
+                return (-1);
+            }
+            buffer = tmp;
+            size *= 2;
+        }
+    }
+
+    if (ferror(fp)) {
+        free(buffer);
+        return (-1);
+    }
+
+    _lxml->buffer = buffer;
+    _lxml->buffer_len = len;
+    _lxml->buffer_pos = 0;
+    return (0);
+}
+
 int ParseXML(OS_XML *_lxml, bool flag_truncate) {
     int r;
     unsigned int i;
@@ -152,11 +224,7 @@ int ParseXML(OS_XML *_lxml, bool flag_truncate) {
     if ((r = _ReadElem(0, _lxml, 0, flag_truncate)) < 0) { /* First position */
         if (r != LEOF) {
 
-            if(_lxml->fp){
-                fclose(_lxml->fp);
-            } else if (str_base){
-                free(str_base);
-            }
+            _xml_close(_lxml, str_base);
 
             return (-1);
         }
@@ -166,21 +234,13 @@ int ParseXML(OS_XML *_lxml, bool flag_truncate) {
         if (_lxml->ck[i] == 0) {
             xml_error(_lxml, "XMLERR: Element '%s' not closed.", _lxml->el[i]);
 
-            if(_lxml->fp){
-                fclose(_lxml->fp);
-            } else if (str_base){
-                free(str_base);
-            }
+            _xml_close(_lxml, str_base);
 
             return (-1);
         }
     }
 
-    if(_lxml->fp){
-        fclose(_lxml->fp);
-    } else if (str_base){
-        free(str_base);
-    }
+    _xml_close(_lxml, str_base);
 
     return (0);
 }
@@ -212,7 +272,15 @@ int OS_ReadXML_Ex(const char *file, OS_XML *_lxml, bool flag_truncate) {
         return (-2);
     }
     w_file_cloexec(fp);
-    _lxml->fp = fp;
+
+    /* Parse the file from memory. If it cannot be read at once, read it character by character */
+    if (_xml_readfile(fp, _lxml) == 0) {
+        fclose(fp);
+        _lxml->fp = NULL;
+    } else {
+        rewind(fp);
+        _lxml->fp = fp;
+    }
     _lxml->string = NULL;
 
     return ParseXML(_lxml, flag_truncate);
@@ -282,6 +350,8 @@ static int _ReadElem(unsigned int parent, OS_XML *_lxml, unsigned int recursion_
     if (_lxml->fp){
         cmp = EOF;
         _lxml->string = NULL;
+    } else if (_lxml->buffer){
+        cmp = EOF;
     } else if (_lxml->string){
         cmp = '\0';
     }
@@ -360,9 +430,9 @@ static int _ReadElem(unsigned int parent, OS_XML *_lxml, unsigned int recursion_
                 count = 0;
                 location = -1;
 
-                memset(elem, '\0', XML_MAXSIZE);
-                memset(closedelim, '\0', XML_MAXSIZE);
-                memset(cont, '\0', XML_MAXSIZE);
+                elem[0] = '\0';
+                closedelim[0] = '\0';
+                cont[0] = '\0';
 
                 if (parent > 0) {
                     retval = 0;
@@ -384,9 +454,9 @@ static int _ReadElem(unsigned int parent, OS_XML *_lxml, unsigned int recursion_
                 goto end;
             }
             _lxml->ck[_currentlycont] = 1;
-            memset(elem, '\0', XML_MAXSIZE);
-            memset(closedelim, '\0', XML_MAXSIZE);
-            memset(cont, '\0', XML_MAXSIZE);
+            elem[0] = '\0';
+            closedelim[0] = '\0';
+            cont[0] = '\0';
             _currentlycont = 0;
             count = 0;
             location = -1;
@@ -445,64 +515,73 @@ end:
     return retval;
 }
 
-static int _writememory(const char *str, XML_TYPE type, size_t size,
-                        unsigned int parent, OS_XML *_lxml)
+/* Grow the item arrays geometrically */
+static int _xml_grow(OS_XML *_lxml)
 {
+    unsigned int size = _lxml->size ? _lxml->size * 2 : XML_INITIAL_SIZE;
     char **tmp;
     int *tmp2;
     unsigned int *tmp3;
     XML_TYPE *tmp4;
 
-    /* Allocate for the element */
-    tmp = (char **)realloc(_lxml->el, (_lxml->cur + 1) * sizeof(char *));
+    tmp = (char **)realloc(_lxml->el, size * sizeof(char *));
     if (tmp == NULL) {
-        goto fail;
+        return (-1);
     }
     _lxml->el = tmp;
-    _lxml->el[_lxml->cur] = (char *)calloc(size, sizeof(char));
-    if (_lxml->el[_lxml->cur] == NULL) {
-        goto fail;
-    }
-    strncpy(_lxml->el[_lxml->cur], str, size - 1);
 
-    /* Allocate for the content */
-    tmp = (char **)realloc(_lxml->ct, (_lxml->cur + 1) * sizeof(char *));
+    tmp = (char **)realloc(_lxml->ct, size * sizeof(char *));
     if (tmp == NULL) {
-        goto fail;
+        return (-1);
     }
     _lxml->ct = tmp;
-    _lxml->ct[_lxml->cur] = NULL;
 
-    /* Allocate for the type */
-    tmp4 = (XML_TYPE *) realloc(_lxml->tp, (_lxml->cur + 1) * sizeof(XML_TYPE));
+    tmp4 = (XML_TYPE *) realloc(_lxml->tp, size * sizeof(XML_TYPE));
     if (tmp4 == NULL) {
-        goto fail;
+        return (-1);
     }
     _lxml->tp = tmp4;
-    _lxml->tp[_lxml->cur] = type;
 
-    /* Allocate for the relation */
-    tmp3 = (unsigned int *) realloc(_lxml->rl, (_lxml->cur + 1) * sizeof(unsigned int));
+    tmp3 = (unsigned int *) realloc(_lxml->rl, size * sizeof(unsigned int));
     if (tmp3 == NULL) {
-        goto fail;
+        return (-1);
     }
     _lxml->rl = tmp3;
-    _lxml->rl[_lxml->cur] = parent;
 
-    /* Allocate for the "check" */
-    tmp2 = (int *) realloc(_lxml->ck, (_lxml->cur + 1) * sizeof(int));
+    tmp2 = (int *) realloc(_lxml->ck, size * sizeof(int));
     if (tmp2 == NULL) {
-        goto fail;
+        return (-1);
     }
     _lxml->ck = tmp2;
-    _lxml->ck[_lxml->cur] = 0;
 
-    /* Allocate for the line */
-    tmp3 = (unsigned int *) realloc(_lxml->ln, (_lxml->cur + 1) * sizeof(unsigned int));
+    tmp3 = (unsigned int *) realloc(_lxml->ln, size * sizeof(unsigned int));
     if (tmp3 == NULL) {
-        goto fail;
+        return (-1);
     }
     _lxml->ln = tmp3;
+
+    _lxml->size = size;
+    return (0);
+}
+
+static int _writememory(const char *str, XML_TYPE type, size_t size,
+                        unsigned int parent, OS_XML *_lxml)
+{
+    if (_lxml->cur == _lxml->size && _xml_grow(_lxml) < 0) {
+        goto fail;
+    }
+
+    /* Allocate for the element */
+    _lxml->el[_lxml->cur] = (char *)calloc(size, sizeof(char));
+    if (_lxml->el[_lxml->cur] == NULL) {
+        goto fail;
+    }
+    strncpy(_lxml->el[_lxml->cur], str, size - 1);
+
+    _lxml->ct[_lxml->cur] = NULL;
+    _lxml->tp[_lxml->cur] = type;
+    _lxml->rl[_lxml->cur] = parent;
+    _lxml->ck[_lxml->cur] = 0;
     _lxml->ln[_lxml->cur] = _lxml->line;
 
     /* Attributes does not need to be closed */
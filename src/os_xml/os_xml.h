@@ -47,6 +47,10 @@ typedef struct _OS_XML {
     int stash_i;                /* Stash index */
     FILE *fp;                   /* File descriptor */
     char *string;               /* XML string */
+    char *buffer;               /* File contents, read at once */
+    size_t buffer_len;          /* Length of the file contents */
+    size_t buffer_pos;          /* Current position in the file contents */
+    unsigned int size;          /* Allocated items */
 } OS_XML;
 
 typedef xml_node **XML_NODE;
@@ -12,15 +12,30 @@
 #include "shared.h"
 #include "rootcheck.h"
 
+/* Spare PIDs scanned over the number of forks, for the processes created during the scan */
+#define PID_SCAN_MARGIN 4096
+
+#define PID_ISSET(map, pid) ((map)[(pid) >> 3] & (1 << ((pid) & 7)))
+#define PID_SET(map, pid)   ((map)[(pid) >> 3] |= (unsigned char)(1 << ((pid) & 7)))
+
 /* Prototypes */
 static int  proc_read(int pid);
+static int  proc_listed(int pid);
 static int  proc_opendir(int pid);
 static int  proc_stat(int pid);
-static void loop_all_pids(const char *ps, pid_t max_pid, int *_errors, int *_total);
+static int  ps_listed(const char *ps, int pid);
+static pid_t get_max_pid(int *wrapped);
+static void snapshot_proc(pid_t max_pid);
+static void snapshot_ps(const char *ps, pid_t max_pid);
+static void loop_all_pids(const char *ps, pid_t max_pid, int wrapped, int *_errors, int *_total);
 
 /* Global variables */
 static int noproc;
 
+/* PIDs listed in /proc and by ps(1) when the scan started */
+static unsigned char *proc_pids;
+static unsigned char *ps_pids;
+
 
 /* If /proc is mounted, check to see if the pid is present */
 static int proc_read(int pid)
@@ -38,6 +53,18 @@ static int proc_read(int pid)
     return (0);
 }
 
+/* Check if the pid was present in the /proc listing at the start of the
+ * scan. Reading the whole /proc directory once per pid is too expensive.
+ */
+static int proc_listed(int pid)
+{
+    if (noproc) {
+        return (0);
+    }
+
+    return proc_pids ? PID_ISSET(proc_pids, pid) != 0 : proc_read(pid);
+}
+
 /* If /proc is mounted, check to see if the pid is present */
 static int proc_opendir(int pid)
 {
@@ -47,13 +74,7 @@ static int proc_opendir(int pid)
     if (noproc) {
         return (0);
     }
-    
-    dp  = opendir("/proc");
-    if (!dp) {
-        return 0;
-    }
-    closedir(dp);
-    
+
     snprintf(dir, OS_SIZE_1024, "/proc/%d", pid);
     dp  = opendir(dir);
     if (!dp) {
@@ -82,8 +103,137 @@ static int proc_stat(int pid)
     return (0);
 }
 
+/* Check if the process appears in ps(1) output. Only the processes that
+ * were not listed at the start of the scan run ps(1) again.
+ */
+static int ps_listed(const char *ps, int pid)
+{
+    char command[OS_SIZE_1024 + 64];
+
+    if (ps_pids && PID_ISSET(ps_pids, pid)) {
+        return (1);
+    }
+
+    snprintf(command, sizeof(command), "%s -p %d > /dev/null 2>&1", ps, pid);
+
+    /* If we are run in the context of OSSEC-HIDS, sleep here (no rush) */
+#ifdef OSSECHIDS
+    struct timeval timeout = {0, rootcheck.tsleep * 1000};
+    select(0, NULL, NULL, NULL, &timeout);
+#endif
+
+    return system(command) == 0;
+}
+
+/* Get the highest pid that a process may have. Without a wraparound of the
+ * pid counter, no pid can be greater than the number of forks since boot.
+ * The bound is never lower than MAX_PID. wrapped is set when the bound is
+ * kernel.pid_max because the counter may have wrapped around.
+ */
+static pid_t get_max_pid(int *wrapped)
+{
+    pid_t max_pid = MAX_PID;
+
+    *wrapped = 0;
+
+#ifdef __linux__
+    char buffer[OS_SIZE_1024];
+    unsigned long forks = 0;
+    long pid_max = 0;
+    FILE *fp;
+
+    if (fp = fopen("/proc/sys/kernel/pid_max", "r"), fp) {
+        if (fgets(buffer, sizeof(buffer), fp)) {
+            pid_max = strtol(buffer, NULL, 10);
+        }
+        fclose(fp);
+    }
+
+    if (pid_max <= 0) {
+        return max_pid;
+    }
+
+    if (fp = fopen("/proc/stat", "r"), fp) {
+        while (fgets(buffer, sizeof(buffer), fp)) {
+            if (sscanf(buffer, "processes %lu", &forks) == 1) {
+                break;
+            }
+        }
+        fclose(fp);
+    }
+
+    if (forks > 0 && forks + PID_SCAN_MARGIN < (unsigned long)pid_max) {
+        max_pid = (pid_t)(forks + PID_SCAN_MARGIN);
+    } else {
+        max_pid = (pid_t)pid_max;
+        *wrapped = max_pid > MAX_PID;
+    }
+
+    if (max_pid < MAX_PID) {
+        max_pid = MAX_PID;
+    }
+#endif
+
+    return max_pid;
+}
+
+/* List the pids in /proc once */
+static void snapshot_proc(pid_t max_pid)
+{
+    struct dirent *entry;
+    DIR *dp;
+
+    if (noproc || (dp = opendir("/proc"), !dp)) {
+        return;
+    }
+
+    os_calloc(max_pid / 8 + 1, sizeof(unsigned char), proc_pids);
+
+    while ((entry = readdir(dp)) != NULL) {
+        char *end;
+        long pid = strtol(entry->d_name, &end, 10);
+
+        if (*end == '\0' && pid > 0 && pid <= max_pid) {
+            PID_SET(proc_pids, pid);
+        }
+    }
+
+    closedir(dp);
+}
+
+/* List the pids shown by ps(1) once */
+static void snapshot_ps(const char *ps, pid_t max_pid)
+{
+    char command[OS_SIZE_1024 + 64];
+    char buffer[OS_SIZE_128];
+    int found = 0;
+    FILE *fp;
+
+    snprintf(command, sizeof(command), "%s -A -o pid= 2> /dev/null", ps);
+
+    if (fp = popen(command, "r"), !fp) {
+        return;
+    }
+
+    os_calloc(max_pid / 8 + 1, sizeof(unsigned char), ps_pids);
+
+    while (fgets(buffer, sizeof(buffer), fp)) {
+        long pid = strtol(buffer, NULL, 10);
+
+        if (pid > 0 && pid <= max_pid) {
+            PID_SET(ps_pids, pid);
+            found = 1;
+        }
+    }
+
+    /* ps(1) does not support these options: ask for every pid */
+    if (pclose(fp) != 0 || !found) {
+        os_free(ps_pids);
+    }
+}
+
 /* Check all the available PIDs for hidden stuff */
-static void loop_all_pids(const char *ps, pid_t max_pid, int *_errors, int *_total)
+static void loop_all_pids(const char *ps, pid_t max_pid, int wrapped, int *_errors, int *_total)
 {
     int _kill0 = 0;
     int _kill1 = 0;
@@ -99,8 +249,6 @@ static void loop_all_pids(const char *ps, pid_t max_pid, int *_errors, int *_tot
     pid_t i = 1;
     pid_t my_pid;
 
-    char command[OS_SIZE_1024 + 64];
-
     my_pid = getpid();
 
     for (;; i++) {
@@ -110,6 +258,14 @@ static void loop_all_pids(const char *ps, pid_t max_pid, int *_errors, int *_tot
 
         (*_total)++;
 
+        /* When the scan goes up to pid_max, a pid listed both in /proc and
+         * by ps(1) is not hidden, so only the missing ones are probed.
+         */
+        if (wrapped && proc_pids && ps_pids &&
+                PID_ISSET(proc_pids, i) && PID_ISSET(ps_pids, i)) {
+            continue;
+        }
+
         _kill0 = 0;
         _kill1 = 0;
         _gsid0 = 0;
@@ -135,7 +291,7 @@ static void loop_all_pids(const char *ps, pid_t max_pid, int *_errors, int *_tot
 
         /* /proc test */
         _proc_stat = proc_stat(i);
-        _proc_read = proc_read(i);
+        _proc_read = proc_listed(i);
         _proc_opendir = proc_opendir(i);
 
         /* If PID does not exist, move on */
@@ -161,23 +317,9 @@ static void loop_all_pids(const char *ps, pid_t max_pid, int *_errors, int *_tot
 
         /* Check if the process appears in ps(1) output */
         if (*ps) {
-            snprintf(command, sizeof(command), "%s -p %d > /dev/null 2>&1", ps, (int)i);
-            _ps0 = 0;
-            if (system(command) == 0) {
-                _ps0 = 1;
-            }
+            _ps0 = ps_listed(ps, (int)i);
         }
 
-        /* If we are run in the context of OSSEC-HIDS, sleep here (no rush) */
-#ifdef OSSECHIDS
-#ifdef WIN32
-        Sleep(rootcheck.tsleep);
-#else
-        struct timeval timeout = {0, rootcheck.tsleep * 1000};
-        select(0, NULL, NULL, NULL, &timeout);
-#endif
-#endif
-
         /* Everything fine, move on */
         if (_ps0 && _kill0 && _gsid0 && _gpid0 && _proc_stat && _proc_read) {
             continue;
@@ -290,7 +432,8 @@ void check_rc_pids()
     char proc_0[] = "/proc";
     char proc_1[] = "/proc/1";
 
-    pid_t max_pid = MAX_PID;
+    int wrapped;
+    pid_t max_pid = get_max_pid(&wrapped);
     noproc = 1;
 
     /* Checking where ps is */
@@ -308,7 +451,19 @@ void check_rc_pids()
         noproc = 0;
     }
 
-    loop_all_pids(ps, max_pid, &_errors, &_total);
+    /* Processes missing from these lists are probed again, so the lists
+     * only save work on the processes that are not hidden.
+     */
+    snapshot_proc(max_pid);
+
+    if (*ps) {
+        snapshot_ps(ps, max_pid);
+    }
+
+    loop_all_pids(ps, max_pid, wrapped, &_errors, &_total);
+
+    os_free(proc_pids);
+    os_free(ps_pids);
 
     if (_errors == 0) {
         char op_msg[OS_SIZE_2048];
@@ -16,13 +16,16 @@
 #if defined(sun) || defined(__sun__)
 #define NETSTAT         "netstat -an -P %s | "\
                         "grep \"[^0-9]%d \" > /dev/null 2>&1"
+#define NETSTAT_ALL     "netstat -an -P %s 2> /dev/null"
 #else
 #define NETSTAT         "netstat -an | grep \"^%s\" | " \
                         "grep \"[^0-9]%d \" > /dev/null 2>&1"
+#define NETSTAT_ALL     "netstat -an 2> /dev/null | grep \"^%s\""
 #endif
 
 /* Prototypes */
 static int  run_netstat(int proto, int port);
+static void snapshot_netstat(int proto, char *ports);
 static int  conn_port(int proto, int port);
 static void test_ports(int proto, int *_errors, int *_total);
 
@@ -52,6 +55,44 @@ static int run_netstat(int proto, int port)
     return (1);
 }
 
+/* Mark the ports that netstat shows for a protocol, the same way the grep
+ * in NETSTAT matches them. Running netstat once per port in use is
+ * expensive on busy hosts.
+ */
+static void snapshot_netstat(int proto, char *ports)
+{
+    const char *name = (proto == IPPROTO_UDP) ? "udp" : "tcp";
+    char command[OS_SIZE_1024 + 1];
+    char buffer[OS_SIZE_2048 + 1];
+    FILE *fp;
+
+    snprintf(command, OS_SIZE_1024, NETSTAT_ALL, name);
+
+    if (fp = popen(command, "r"), !fp) {
+        return;
+    }
+
+    while (fgets(buffer, OS_SIZE_2048, fp) != NULL) {
+        char *str;
+
+        /* A port is a number after a non-digit and before a space */
+        for (str = buffer + 1; *str != '\0'; str++) {
+            if (isdigit((int)*str) && !isdigit((int)str[-1])) {
+                char *end;
+                long port = strtol(str, &end, 10);
+
+                if (*end == ' ' && port <= 65535) {
+                    ports[port] = 1;
+                }
+
+                str = end - 1;
+            }
+        }
+    }
+
+    pclose(fp);
+}
+
 static int conn_port(int proto, int port)
 {
     int rc = 0;
@@ -93,15 +134,19 @@ static int conn_port(int proto, int port)
 
 static void test_ports(int proto, int *_errors, int *_total)
 {
+    char *netstat_ports;
     int i;
 
+    os_calloc(65535 + 1, sizeof(char), netstat_ports);
+    snapshot_netstat(proto, netstat_ports);
+
     for (i = 0; i <= 65535; i++) {
         (*_total)++;
         if (conn_port(proto, i)) {
             /* Check if we can find it using netstat. If not,
              * check again to see if the port is still being used.
              */
-            if (run_netstat(proto, i)) {
+            if (netstat_ports[i] || run_netstat(proto, i)) {
                 continue;
             }
 
@@ -137,10 +182,11 @@ static void test_ports(int proto, int *_errors, int *_total)
                      "something really bad is going on.",
                      (proto == IPPROTO_UDP) ? "udp" : "tcp" );
             notify_rk(ALERT_SYSTEM_CRIT, op_msg);
-            return;
+            break;
         }
     }
 
+    os_free(netstat_ports);
 }
 
 void check_rc_ports()
@@ -225,6 +225,28 @@ bool w_expression_match(w_expression_t * expression, const char * str_test, cons
     return retval;
 }
 
+pcre2_match_data * w_expression_create_match_data(w_expression_t * expression) {
+
+    if (expression == NULL || expression->exp_type != EXP_TYPE_PCRE2 || expression->pcre2->code == NULL) {
+        return NULL;
+    }
+
+    return pcre2_match_data_create_from_pattern(expression->pcre2->code, NULL);
+}
+
+bool w_expression_match_ex(w_expression_t * expression, const char * str_test, pcre2_match_data * match_data) {
+
+    if (expression == NULL || str_test == NULL) {
+        return false;
+    }
+
+    if (expression->exp_type != EXP_TYPE_PCRE2 || match_data == NULL) {
+        return w_expression_match(expression, str_test, NULL, NULL);
+    }
+
+    return pcre2_match(expression->pcre2->code, (PCRE2_SPTR) str_test, strlen(str_test), 0, 0, match_data, NULL) > 0;
+}
+
 void w_expression_PCRE2_fill_regex_match(int captured_groups, const char * str_test, pcre2_match_data * match_data,
                                          regex_matching * regex_match) {
 
@@ -14,9 +14,17 @@
 #include "file-queue.h"
 
 #ifndef WIN32
+#ifdef INOTIFY_ENABLED
+#include <sys/inotify.h>
+
+#define FQ_NOTIFY_MASK (IN_MODIFY | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO)
+#define FQ_NOTIFY_BUFFER_SIZE (sizeof(struct inotify_event) + NAME_MAX + 1) * 16
+#endif
+
 static void file_sleep(void);
 static void GetFile_Queue(file_queue *fileq) __attribute__((nonnull));
 static int Handle_Queue(file_queue *fileq, int flags) __attribute__((nonnull));
+static int Watch_FileQueue(file_queue *fileq) __attribute__((nonnull));
 
 /* To translate between month (int) to month (char) */
 static const char *(s_month[]) = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
@@ -126,16 +134,21 @@ int Init_FileQueue(file_queue *fileq, const struct tm *p, int flags)
     return (0);
 }
 
-/* Reads from the monitored file */
+/* Reads from the monitored file
+ * With a timeout of FQ_NOWAIT, it tries a single read and never waits
+ */
 alert_data *Read_FileMon(file_queue *fileq, const struct tm *p, unsigned int timeout)
 {
     unsigned int i = 0;
     alert_data *al_data;
+    struct stat buf;
 
     /* If the file queue is not available, try to access it */
     if (!fileq->fp) {
         if (Handle_Queue(fileq, 0) != 1) {
-            file_sleep();
+            if (timeout != FQ_NOWAIT) {
+                file_sleep();
+            }
             return (NULL);
         }
     }
@@ -155,9 +168,24 @@ alert_data *Read_FileMon(file_queue *fileq, const struct tm *p, unsigned int tim
     /* Get latest file */
     GetFile_Queue(fileq);
 
-    if (Handle_Queue(fileq, 0) != 1) {
-        file_sleep();
-        return (NULL);
+    /* Keep reading the same file unless it was rotated */
+    if (fileq->flags & CRALERT_FP_SET || stat(fileq->file_name, &buf) < 0 || buf.st_ino != fileq->f_status.st_ino) {
+        if (!(fileq->flags & CRALERT_FP_SET)) {
+            mdebug2("Read_FileMon(): Alert file inode changed. Reloading.");
+        }
+
+        /* A new file is read from the beginning */
+        if (Handle_Queue(fileq, fileq->flags & CRALERT_FP_SET ? 0 : CRALERT_READ_ALL) != 1) {
+            if (timeout != FQ_NOWAIT) {
+                file_sleep();
+            }
+            return (NULL);
+        }
+
+        /* Without waiting, the new file still gets its single read */
+        if (timeout == FQ_NOWAIT) {
+            return GetAlertData(fileq->flags, fileq->fp);
+        }
     }
 
     /* Try up to timeout times to get an event */
@@ -168,10 +196,132 @@ alert_data *Read_FileMon(file_queue *fileq, const struct tm *p, unsigned int tim
         }
 
         i++;
-        file_sleep();
+
+        if (Wait_FileQueue(fileq, FQ_TIMEOUT) < 0) {
+            file_sleep();
+        }
     }
 
     /* Return NULL if timeout expires */
     return (NULL);
 }
+
+/* Watch the directory of the file, so that writes and rotations are notified */
+static int Watch_FileQueue(file_queue *fileq)
+{
+#ifdef INOTIFY_ENABLED
+    char dir[MAX_FQUEUE + 1];
+    char *sep;
+
+    if (fileq->notify) {
+        return fileq->notify > 0 ? 0 : -1;
+    }
+
+    if (fileq->flags & CRALERT_FP_SET || fileq->file_name[0] == '\0') {
+        return -1;
+    }
+
+    fileq->notify = -1;
+
+    snprintf(dir, sizeof(dir), "%s", fileq->file_name);
+
+    if (sep = strrchr(dir, '/'), !sep) {
+        snprintf(dir, sizeof(dir), ".");
+    } else {
+        *(sep == dir ? sep + 1 : sep) = '\0';
+    }
+
+    if (fileq->notify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC), fileq->notify_fd < 0) {
+        mwarn("Couldn't init inotify: %s. Polling '%s'.", strerror(errno), fileq->file_name);
+        return -1;
+    }
+
+    if (inotify_add_watch(fileq->notify_fd, dir, FQ_NOTIFY_MASK) < 0) {
+        mwarn("Couldn't watch directory '%s': %s. Polling '%s'.", dir, strerror(errno), fileq->file_name);
+        close(fileq->notify_fd);
+        return -1;
+    }
+
+    mdebug1("Watching file '%s'.", fileq->file_name);
+    fileq->notify = 1;
+    return 0;
+#else
+    fileq->notify = -1;
+    return -1;
+#endif
+}
+
+/* Wait until the file of the queue is written or replaced */
+int Wait_FileQueue(file_queue *fileq, unsigned int timeout)
+{
+#ifdef INOTIFY_ENABLED
+    char buffer[FQ_NOTIFY_BUFFER_SIZE] __attribute__((aligned(__alignof__(struct inotify_event))));
+    const char *file;
+    const struct inotify_event *event;
+    struct timeval fp_timeout;
+    fd_set fdset;
+    time_t deadline;
+    time_t now;
+    ssize_t count;
+    ssize_t i;
+
+    if (!fileq->notify) {
+        /* Data written before the watch was added would not be notified */
+        return Watch_FileQueue(fileq) == 0 ? 1 : -1;
+    }
+
+    if (fileq->notify < 0) {
+        return -1;
+    }
+
+    file = strrchr(fileq->file_name, '/');
+    file = file ? file + 1 : fileq->file_name;
+
+    for (deadline = time(NULL) + timeout; now = time(NULL), now < deadline; ) {
+        fp_timeout.tv_sec = deadline - now;
+        fp_timeout.tv_usec = 0;
+
+        FD_ZERO(&fdset);
+        FD_SET(fileq->notify_fd, &fdset);
+
+        switch (select(fileq->notify_fd + 1, &fdset, NULL, NULL, &fp_timeout)) {
+        case -1:
+            if (errno != EINTR) {
+                merror("Waiting for changes of '%s': %s", fileq->file_name, strerror(errno));
+                return -1;
+            }
+            continue;
+
+        case 0:
+            return 0;
+        }
+
+        if (count = read(fileq->notify_fd, buffer, sizeof(buffer)), count <= 0) {
+            continue;
+        }
+
+        for (i = 0; i < count; i += sizeof(struct inotify_event) + event->len) {
+            event = (const struct inotify_event *)(buffer + i);
+
+            if (event->mask & IN_Q_OVERFLOW || (event->len > 0 && strcmp(event->name, file) == 0)) {
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+#else
+    return Watch_FileQueue(fileq);
+#endif
+}
+
+// Stop watching the file of the queue
+void Unwatch_FileQueue(file_queue *fileq)
+{
+    if (fileq->notify > 0) {
+        close(fileq->notify_fd);
+    }
+
+    fileq->notify = 0;
+}
 #endif
\ No newline at end of file
@@ -12,16 +12,38 @@
 
 #include "shared.h"
 
-static unsigned int _os_genhash(const OSHash *self, const char *key) __attribute__((nonnull));
+#define OSHASH_INITIAL_ROWS 32      // Power of two, not below OSHASH_STRIPES
+#define OSHASH_MAX_ROWS     (1U << 30)
+#define OSHASH_REHASH_STEP  4       // Old buckets moved by each insertion
+#define OSHASH_MULTIPLIER   0x9e3779b97f4a7c15ULL
+
+#define OSHASH_STRIPE(hash) ((hash) & (OSHASH_STRIPES - 1))
 
-int _OSHash_Add(OSHash *self, const char *key, void *data, int update);
+static unsigned int _os_genhash(const OSHash *self, const char *key) __attribute__((nonnull));
+static OSHashNode *_os_find_row(OSHashNode *curr_node, const char *key, unsigned int hash);
+static OSHashNode *_os_find(const OSHash *self, const char *key, unsigned int hash, OSHashNode ***row);
+static void _os_link(OSHashNode **row, OSHashNode *node);
+static void _os_unlink(OSHashNode **row, OSHashNode *node);
+static void _os_rehash_bucket(OSHash *self, unsigned int index);
+static int _os_rehash_step(OSHash *self, unsigned int stripe);
+static void _os_rehash_all(OSHash *self);
+static int _os_grow(OSHash *self, unsigned int rows);
+static void _os_maintain(OSHash *self);
+static void _os_free_nodes(OSHashNode **table, unsigned int rows, void (*free_data_function)(void *));
+static OSHashNode *_os_bucket(const OSHash *self, unsigned int i);
+static void _os_lock_stripes(const OSHash *self);
+static void _os_unlock_stripes(const OSHash *self);
+
+static int _OSHash_Add(OSHash *self, const char *key, unsigned int hash, void *data, int update, int *maintain);
+static int _OSHash_Add_ex(OSHash *self, const char *key, void *data, int update);
+static void *_OSHash_Delete(OSHash *self, const char *key, unsigned int hash);
 
 /* Create hash
  * Returns NULL on error
  */
 OSHash *OSHash_Create()
 {
-    unsigned int i = 0;
+    unsigned int i;
     OSHash *self;
 
     /* Allocate memory for the hash */
@@ -31,11 +53,7 @@ OSHash *OSHash_Create()
     }
 
     /* Set default row size */
-    self->rows = os_getprime(32);
-    if (self->rows == 0) {
-        free(self);
-        return (NULL);
-    }
+    self->rows = OSHASH_INITIAL_ROWS;
 
     /* Create hashing table */
     self->table = (OSHashNode **)calloc(self->rows + 1, sizeof(OSHashNode *));
@@ -44,16 +62,16 @@ OSHash *OSHash_Create()
         return (NULL);
     }
 
-    /* Zero our tables */
-    for (i = 0; i <= self->rows; i++) {
-        self->table[i] = NULL;
-    }
-
     /* Get seed */
     srandom((unsigned int)time(0));
-    self->initial_seed = os_getprime((unsigned)os_random() % self->rows);
-    self->constant = os_getprime((unsigned)os_random() % self->rows);
+    self->initial_seed = (unsigned int)os_random();
+    self->constant = (unsigned int)os_random();
     w_rwlock_init(&self->mutex, NULL);
+
+    for (i = 0; i < OSHASH_STRIPES; i++) {
+        w_rwlock_init(&self->stripes[i], NULL);
+    }
+
     return (self);
 }
 
@@ -67,100 +85,297 @@ int OSHash_SetFreeDataPointer(OSHash *self, void (free_data_function)(void *))
 /* Free the memory used by the hash */
 void *OSHash_Free(OSHash *self)
 {
-    unsigned int i = 0;
-    OSHashNode *curr_node;
-    OSHashNode *next_node;
+    unsigned int i;
 
     /* Free each entry */
-    while (i <= self->rows) {
-        curr_node = self->table[i];
-        next_node = curr_node;
-        while (next_node) {
-            next_node = next_node->next;
-            if (curr_node->key) free(curr_node->key);
-            /* Take care of the data as well (if a function has been defined) */
-            if (curr_node->data && self->free_data_function) self->free_data_function(curr_node->data);
-            free(curr_node);
-            curr_node = next_node;
-        }
-        i++;
+    _os_free_nodes(self->table, self->rows + 1, self->free_data_function);
+
+    if (self->old_table) {
+        _os_free_nodes(self->old_table, self->old_rows, self->free_data_function);
     }
 
     /* Free the hash table */
     free(self->table);
+    free(self->old_table);
     pthread_rwlock_destroy(&self->mutex);
+
+    for (i = 0; i < OSHASH_STRIPES; i++) {
+        pthread_rwlock_destroy(&self->stripes[i]);
+    }
+
     free(self);
     return (NULL);
 }
 
-/* Generates hash for key */
+/* Generates hash for key, a word at a time */
 static unsigned int _os_genhash(const OSHash *self, const char *key)
 {
-    unsigned int hash_key = self->initial_seed;
+    size_t length = strlen(key);
+    uint64_t hash_key = ((uint64_t)self->initial_seed << 32 | self->constant) ^ (length * OSHASH_MULTIPLIER);
+    uint64_t word;
+
+    for (; length >= sizeof(word); length -= sizeof(word), key += sizeof(word)) {
+        memcpy(&word, key, sizeof(word));
+        hash_key = (hash_key ^ word) * OSHASH_MULTIPLIER;
+        hash_key ^= hash_key >> 29;
+    }
 
-    /* What we have here is a simple polynomial hash.
-     * x0 * a^k-1 .. xk * a^k-k +1
-     */
-    while (*key) {
-        hash_key *= self->constant;
-        hash_key += (unsigned int) * key;
-        key++;
+    if (length > 0) {
+        word = 0;
+        memcpy(&word, key, length);
+        hash_key = (hash_key ^ word) * OSHASH_MULTIPLIER;
     }
 
-    return (hash_key);
+    /* The bucket and the stripe come from the lowest bits */
+    hash_key ^= hash_key >> 32;
+    hash_key *= OSHASH_MULTIPLIER;
+    hash_key ^= hash_key >> 29;
+
+    return (unsigned int)hash_key;
 }
 
-/* Set new size for hash
- * Returns 0 on error (out of memory)
+/* Find the node of a key in a bucket */
+static OSHashNode *_os_find_row(OSHashNode *curr_node, const char *key, unsigned int hash)
+{
+    for (; curr_node; curr_node = curr_node->next) {
+        /* We may have collisions, so double check with strcmp */
+        if (curr_node->hash == hash && curr_node->key && strcmp(curr_node->key, key) == 0) {
+            return curr_node;
+        }
+    }
+
+    return NULL;
+}
+
+/* Find the node of a key. If row is set, it gets the bucket of the node. */
+static OSHashNode *_os_find(const OSHash *self, const char *key, unsigned int hash, OSHashNode ***row)
+{
+    OSHashNode **bucket = &self->table[hash & (self->rows - 1)];
+    OSHashNode *curr_node = _os_find_row(*bucket, key, hash);
+
+    /* The key may not have been moved yet */
+    if (!curr_node && self->old_table) {
+        bucket = &self->old_table[hash & (self->old_rows - 1)];
+        curr_node = _os_find_row(*bucket, key, hash);
+    }
+
+    if (curr_node && row) {
+        *row = bucket;
+    }
+
+    return curr_node;
+}
+
+/* Add a node to the beginning of a bucket */
+static void _os_link(OSHashNode **row, OSHashNode *node)
+{
+    node->prev = NULL;
+    node->next = *row;
+
+    if (*row) {
+        (*row)->prev = node;
+    }
+
+    *row = node;
+}
+
+/* Remove a node from its bucket */
+static void _os_unlink(OSHashNode **row, OSHashNode *node)
+{
+    if (node->prev) {
+        node->prev->next = node->next;
+    } else {
+        *row = node->next;
+    }
+
+    if (node->next) {
+        node->next->prev = node->prev;
+    }
+}
+
+/* Move a bucket of the old table to the new one. Its nodes keep their
+ * stripe, since both sizes are multiples of OSHASH_STRIPES.
  */
-int OSHash_setSize(OSHash *self, unsigned int new_size)
+static void _os_rehash_bucket(OSHash *self, unsigned int index)
 {
-    unsigned int i = 0, orig_size = self->rows;
-    OSHashNode **tmpTable = NULL;
+    OSHashNode *curr_node = self->old_table[index];
+    OSHashNode *next_node;
 
-    /* We can't decrease the size */
-    if (new_size <= self->rows) {
-        return (1);
+    self->old_table[index] = NULL;
+
+    for (; curr_node; curr_node = next_node) {
+        next_node = curr_node->next;
+        _os_link(&self->table[curr_node->hash & (self->rows - 1)], curr_node);
+    }
+}
+
+/* Move the next buckets of a stripe. The stripe must be locked.
+ * Returns 1 if this emptied the old table.
+ */
+static int _os_rehash_step(OSHash *self, unsigned int stripe)
+{
+    unsigned int buckets;
+    unsigned int i;
+
+    if (!self->old_table) {
+        return 0;
+    }
+
+    buckets = self->old_rows / OSHASH_STRIPES;
+
+    if (self->rehash_next[stripe] >= buckets) {
+        return 0;
+    }
+
+    for (i = 0; i < OSHASH_REHASH_STEP && self->rehash_next[stripe] < buckets; i++) {
+        _os_rehash_bucket(self, self->rehash_next[stripe]++ * OSHASH_STRIPES + stripe);
+    }
+
+    if (self->rehash_next[stripe] < buckets) {
+        return 0;
+    }
+
+    /* Other stripes may finish at the same time */
+    return __sync_sub_and_fetch(&self->rehash_pending, 1) == 0;
+}
+
+/* Finish the rehash in progress. Needs exclusive access. */
+static void _os_rehash_all(OSHash *self)
+{
+    unsigned int i;
+
+    if (!self->old_table) {
+        return;
+    }
+
+    for (i = 0; i < self->old_rows; i++) {
+        _os_rehash_bucket(self, i);
     }
 
-    /* Get next prime */
-    self->rows = os_getprime(new_size);
-    if (self->rows == 0) {
+    os_free(self->old_table);
+    self->old_rows = 0;
+    self->rehash_pending = 0;
+}
+
+/* Replace the table with an empty one of the given rows. Its nodes are
+ * moved later. Needs exclusive access and no rehash in progress.
+ * Returns 0 on error (out of memory)
+ */
+static int _os_grow(OSHash *self, unsigned int rows)
+{
+    OSHashNode **table;
+
+    table = (OSHashNode **)calloc(rows + 1, sizeof(OSHashNode *));
+    if (!table) {
         return (0);
     }
 
-    /* Resize hash table */
-    /* If a call to realloc() fails, the pointer passed to it will remain unchanged */
-    tmpTable = (OSHashNode **) realloc(self->table, (self->rows + 1) * sizeof(OSHashNode *));
-    if (!tmpTable) return (0);
+    /* The extra slot of the old table is always empty */
+    self->old_table = self->table;
+    self->old_rows = self->rows;
+    self->table = table;
+    self->rows = rows;
+    self->rehash_pending = OSHASH_STRIPES;
+    memset(self->rehash_next, 0, sizeof(self->rehash_next));
 
-    /* If a call to realloc() succeeds, the pointer passed to it would have been freed */
-    self->table = tmpTable;
+    return (1);
+}
 
-    /* Check if previous tables had allocated data */
-    OSHashNode *curr_node, *next_node;
-    for(i = 0; i < orig_size; i++) {
-        curr_node = self->table[i];
-        next_node = curr_node;
-        while(next_node) {
-            next_node = next_node->next;
+/* Release the old table once it is empty, and grow the table if it holds
+ * more elements than rows. Needs exclusive access.
+ */
+static void _os_maintain(OSHash *self)
+{
+    if (self->old_table) {
+        /* Still in progress: the coming insertions will finish it */
+        if (self->rehash_pending > 0) {
+            return;
+        }
+
+        os_free(self->old_table);
+        self->old_rows = 0;
+    }
+
+    if (self->elements > self->rows && self->rows < OSHASH_MAX_ROWS) {
+        if (!_os_grow(self, self->rows * 2)) {
+            mdebug1("hash_op: calloc() failed!");
+        }
+    }
+}
+
+/* Free the nodes of a table */
+static void _os_free_nodes(OSHashNode **table, unsigned int rows, void (*free_data_function)(void *))
+{
+    unsigned int i;
+    OSHashNode *curr_node;
+    OSHashNode *next_node;
+
+    for (i = 0; i < rows; i++) {
+        for (curr_node = table[i]; curr_node; curr_node = next_node) {
+            next_node = curr_node->next;
             if (curr_node->key) free(curr_node->key);
             /* Take care of the data as well (if a function has been defined) */
-            if (curr_node->data && self->free_data_function) self->free_data_function(curr_node->data);
+            if (curr_node->data && free_data_function) free_data_function(curr_node->data);
             free(curr_node);
-            curr_node = next_node;
         }
     }
+}
 
-    /* Zero our tables */
-    for (i = 0; i <= self->rows; i++) {
-        self->table[i] = NULL;
+/* Get the bucket at position i, counting the old table after the new one */
+static OSHashNode *_os_bucket(const OSHash *self, unsigned int i)
+{
+    if (i <= self->rows) {
+        return self->table[i];
     }
 
-    /* New seed */
-    self->initial_seed = os_getprime(456 % self->rows);
-    self->constant = os_getprime(789 % self->rows);
+    i -= self->rows + 1;
+    return self->old_table && i < self->old_rows ? self->old_table[i] : NULL;
+}
 
+/* Stop the _ex writers while holding mutex for reading */
+static void _os_lock_stripes(const OSHash *self)
+{
+    unsigned int i;
+
+    for (i = 0; i < OSHASH_STRIPES; i++) {
+        w_rwlock_rdlock((pthread_rwlock_t *)&self->stripes[i]);
+    }
+}
+
+static void _os_unlock_stripes(const OSHash *self)
+{
+    unsigned int i;
+
+    for (i = OSHASH_STRIPES; i > 0; i--) {
+        w_rwlock_unlock((pthread_rwlock_t *)&self->stripes[i - 1]);
+    }
+}
+
+/* Set new size for hash. The table keeps its elements.
+ * Returns 0 on error (out of memory)
+ */
+int OSHash_setSize(OSHash *self, unsigned int new_size)
+{
+    unsigned int rows;
+
+    /* We can't decrease the size */
+    if (new_size <= self->rows) {
+        return (1);
+    }
+
+    /* Get next power of two */
+    rows = self->rows;
+    while (rows < new_size && rows < OSHASH_MAX_ROWS) {
+        rows *= 2;
+    }
+
+    _os_rehash_all(self);
+
+    if (!_os_grow(self, rows)) {
+        return (0);
+    }
+
+    _os_rehash_all(self);
     return (1);
 }
 
@@ -181,30 +396,18 @@ int OSHash_setSize_ex(OSHash *self, unsigned int new_size)
  */
 int OSHash_Update(OSHash *self, const char *key, void *data)
 {
-    unsigned int hash_key;
-    unsigned int index;
     OSHashNode *curr_node;
 
-    /* Generate hash of the message */
-    hash_key = _os_genhash(self, key);
+    if (curr_node = _os_find(self, key, _os_genhash(self, key), NULL), !curr_node) {
+        return (0);
+    }
 
-    /* Get array index */
-    index = hash_key % self->rows;
-
-    /* Check for duplicated entries in the index */
-    curr_node = self->table[index];
-    while (curr_node) {
-        /* Checking for duplicated key -- not adding */
-        if (strcmp(curr_node->key, key) == 0) {
-            if (curr_node->data && self->free_data_function) {
-                self->free_data_function(curr_node->data);
-            }
-            curr_node->data = data;
-            return (1);
-        }
-        curr_node = curr_node->next;
+    if (curr_node->data && self->free_data_function) {
+        self->free_data_function(curr_node->data);
     }
-    return (0);
+
+    curr_node->data = data;
+    return (1);
 }
 
 /** int OSHash_Update_ex(OSHash *self, char *key, void *data)
@@ -214,12 +417,27 @@ int OSHash_Update(OSHash *self, const char *key, void *data)
  */
 int OSHash_Update_ex(OSHash *self, const char *key, void *data)
 {
-    int result;
+    unsigned int hash_key = _os_genhash(self, key);
+    OSHashNode *curr_node;
+    void *old_data = NULL;
+    int result = 0;
 
-    w_rwlock_wrlock((pthread_rwlock_t *)&self->mutex);
-    result = OSHash_Update(self,key,data);
+    w_rwlock_rdlock((pthread_rwlock_t *)&self->mutex);
+    w_rwlock_wrlock(&self->stripes[OSHASH_STRIPE(hash_key)]);
+
+    if (curr_node = _os_find(self, key, hash_key, NULL), curr_node) {
+        old_data = curr_node->data;
+        curr_node->data = data;
+        result = 1;
+    }
+
+    w_rwlock_unlock(&self->stripes[OSHASH_STRIPE(hash_key)]);
     w_rwlock_unlock((pthread_rwlock_t *)&self->mutex);
 
+    if (old_data && self->free_data_function) {
+        self->free_data_function(old_data);
+    }
+
     return result;
 }
 
@@ -230,7 +448,14 @@ int OSHash_Update_ex(OSHash *self, const char *key, void *data)
  * Key must not be NULL.
  */
 int OSHash_Add(OSHash *self, const char *key, void *data) {
-    return _OSHash_Add(self, key, data, 0);
+    int maintain = 0;
+    int result = _OSHash_Add(self, key, _os_genhash(self, key), data, 0, &maintain);
+
+    if (maintain) {
+        _os_maintain(self);
+    }
+
+    return result;
 }
 
 /** int OSHash_Set(OSHash *self, char *key, void *data)
@@ -240,33 +465,30 @@ int OSHash_Add(OSHash *self, const char *key, void *data) {
  * Key must not be NULL.
  */
 int OSHash_Set(OSHash *self, const char *key, void *data) {
-    return _OSHash_Add(self, key, data, 1);
+    int maintain = 0;
+    int result = _OSHash_Add(self, key, _os_genhash(self, key), data, 1, &maintain);
+
+    if (maintain) {
+        _os_maintain(self);
+    }
+
+    return result;
 }
 
-int _OSHash_Add(OSHash *self, const char *key, void *data, int update)
+/* Add or update a key. The stripe of the hash must be locked.
+ * maintain is set if _os_maintain() must run after releasing the stripe.
+ */
+static int _OSHash_Add(OSHash *self, const char *key, unsigned int hash, void *data, int update, int *maintain)
 {
-    unsigned int hash_key;
-    unsigned int index;
     OSHashNode *curr_node;
     OSHashNode *new_node;
 
-    /* Generate hash of the message */
-    hash_key = _os_genhash(self, key);
-
-    /* Get array index */
-    index = hash_key % self->rows;
-
-    /* Check for duplicated entries in the index */
-    curr_node = self->table[index];
-    while (curr_node) {
-        /* Checking for duplicated key */
-        if (strcmp(curr_node->key, key) == 0) {
-            if (update) {
-                 curr_node->data = data;
-            }
-            return (1);
+    /* Check for duplicated entries */
+    if (curr_node = _os_find(self, key, hash, NULL), curr_node) {
+        if (update) {
+            curr_node->data = data;
         }
-        curr_node = curr_node->next;
+        return (1);
     }
 
     /* Create new node */
@@ -275,9 +497,8 @@ int _OSHash_Add(OSHash *self, const char *key, void *data, int update)
         mdebug1("hash_op: calloc() failed!");
         return (0);
     }
-    new_node->next = NULL;
-    new_node->prev = NULL;
     new_node->data = data;
+    new_node->hash = hash;
     new_node->key = strdup(key);
     if ( new_node->key == NULL ) {
         free(new_node);
@@ -285,22 +506,44 @@ int _OSHash_Add(OSHash *self, const char *key, void *data, int update)
         return (0);
     }
 
-    /* Add to table */
-    if (!self->table[index]) {
-        self->table[index] = new_node;
-    }
-    /* If there is duplicated, add to the beginning */
-    else {
-        new_node->next = self->table[index];
-        self->table[index]->prev = new_node;
-        self->table[index] = new_node;
+    /* Add to the beginning of the bucket */
+    _os_link(&self->table[hash & (self->rows - 1)], new_node);
+
+    /* Each insertion moves some buckets of its stripe */
+    if (_os_rehash_step(self, OSHASH_STRIPE(hash))) {
+        *maintain = 1;
     }
 
-    self->elements = self->elements + 1;
+    if (__sync_add_and_fetch(&self->elements, 1) > self->rows && !self->old_table) {
+        *maintain = 1;
+    }
 
     return (2);
 }
 
+/* Add or update a key locking its stripe only */
+static int _OSHash_Add_ex(OSHash *self, const char *key, void *data, int update)
+{
+    unsigned int hash_key = _os_genhash(self, key);
+    int maintain = 0;
+    int result;
+
+    w_rwlock_rdlock((pthread_rwlock_t *)&self->mutex);
+    w_rwlock_wrlock(&self->stripes[OSHASH_STRIPE(hash_key)]);
+    result = _OSHash_Add(self, key, hash_key, data, update, &maintain);
+    w_rwlock_unlock(&self->stripes[OSHASH_STRIPE(hash_key)]);
+    w_rwlock_unlock((pthread_rwlock_t *)&self->mutex);
+
+    /* Resizing needs the whole table */
+    if (maintain) {
+        w_rwlock_wrlock((pthread_rwlock_t *)&self->mutex);
+        _os_maintain(self);
+        w_rwlock_unlock((pthread_rwlock_t *)&self->mutex);
+    }
+
+    return result;
+}
+
 /** int OSHash_Numeric_Add_ex(OSHash *self, int key, void *data)
  * Returns 0 on error.
  * Returns 1 on duplicated key (not added)
@@ -326,12 +569,7 @@ int OSHash_Numeric_Add_ex(OSHash *self, int key, void *data)
  */
 int OSHash_Add_ex(OSHash *self, const char *key, void *data)
 {
-    int result;
-    w_rwlock_wrlock((pthread_rwlock_t *)&self->mutex);
-    result = OSHash_Add(self,key,data);
-    w_rwlock_unlock((pthread_rwlock_t *)&self->mutex);
-
-    return result;
+    return _OSHash_Add_ex(self, key, data, 0);
 }
 
 /** int OSHash_Set_ex(OSHash *self, char *key, void *data)
@@ -342,12 +580,7 @@ int OSHash_Add_ex(OSHash *self, const char *key, void *data)
  */
 int OSHash_Set_ex(OSHash *self, const char *key, void *data)
 {
-    int result;
-    w_rwlock_wrlock((pthread_rwlock_t *)&self->mutex);
-    result = OSHash_Set(self,key,data);
-    w_rwlock_unlock((pthread_rwlock_t *)&self->mutex);
-
-    return result;
+    return _OSHash_Add_ex(self, key, data, 1);
 }
 
 /** int OSHash_Add_ins(OSHash *self, char *key, void *data)
@@ -373,31 +606,8 @@ int OSHash_Add_ins(OSHash *self, const char *key, void *data)
  */
 void *OSHash_Get(const OSHash *self, const char *key)
 {
-    unsigned int hash_key;
-    unsigned int index;
-    const OSHashNode *curr_node;
-
-    /* Generate hash of the message */
-    hash_key = _os_genhash(self, key);
-
-    /* Get array index */
-    index = hash_key % self->rows;
-
-    /* Get entry */
-    curr_node = self->table[index];
-
-    while (curr_node != NULL) {
-        /* Skip null pointers */
-        if (curr_node->key != NULL) {
-            /* We may have collisions, so double check with strcmp */
-            if (strcmp(curr_node->key, key) == 0) {
-                return (curr_node->data);
-            }
-        }
-        curr_node = curr_node->next;
-    }
-
-    return (NULL);
+    const OSHashNode *curr_node = _os_find(self, key, _os_genhash(self, key), NULL);
+    return curr_node ? curr_node->data : NULL;
 }
 
 /** void *OSHash_Numeric_Get_ex(OSHash *self, int key)
@@ -423,9 +633,15 @@ void *OSHash_Numeric_Get_ex(const OSHash *self, int key)
  */
 void *OSHash_Get_ex(const OSHash *self, const char *key)
 {
+    unsigned int hash_key = _os_genhash(self, key);
+    const OSHashNode *curr_node;
     void *result;
+
     w_rwlock_rdlock((pthread_rwlock_t *)&self->mutex);
-    result = OSHash_Get(self,key);
+    w_rwlock_rdlock((pthread_rwlock_t *)&self->stripes[OSHASH_STRIPE(hash_key)]);
+    curr_node = _os_find(self, key, hash_key, NULL);
+    result = curr_node ? curr_node->data : NULL;
+    w_rwlock_unlock((pthread_rwlock_t *)&self->stripes[OSHASH_STRIPE(hash_key)]);
     w_rwlock_unlock((pthread_rwlock_t *)&self->mutex);
 
     return result;
@@ -450,49 +666,37 @@ void *OSHash_Get_ins(const OSHash *self, const char *key)
 unsigned int OSHash_Get_Elem_ex(OSHash *self) {
     unsigned int ret;
     w_rwlock_rdlock((pthread_rwlock_t *)&self->mutex);
-    ret = self->elements;
+    /* The writers of other stripes may be updating it */
+    ret = __atomic_load_n(&self->elements, __ATOMIC_RELAXED);
     w_rwlock_unlock((pthread_rwlock_t *)&self->mutex);
 
     return ret;
 }
 
-/* Return a pointer to a hash node if found, that hash node is removed from the table */
-void *OSHash_Delete(OSHash *self, const char *key)
+/* Remove a key from its bucket. The stripe of the hash must be locked. */
+static void *_OSHash_Delete(OSHash *self, const char *key, unsigned int hash)
 {
     OSHashNode *curr_node;
-    OSHashNode *prev_node = NULL;
-    unsigned int hash_key;
-    unsigned int index;
+    OSHashNode **row;
     void *data;
 
-    /* Generate hash of the message */
-    hash_key = _os_genhash(self, key);
-
-    /* Get array index */
-    index = hash_key % self->rows;
-
-    curr_node = self->table[index];
-    while ( curr_node != NULL ) {
-        if (strcmp(curr_node->key, key) == 0) {
-            if ( prev_node == NULL ) {
-                self->table[index] = curr_node->next;
-            } else {
-                prev_node->next = curr_node->next;
-            }
-            if (curr_node->next) {
-                curr_node->next->prev = prev_node;
-            }
-            free(curr_node->key);
-            data = curr_node->data;
-            free(curr_node);
-            self->elements = self->elements - 1;
-            return data;
-        }
-        prev_node = curr_node;
-        curr_node = curr_node->next;
+    if (curr_node = _os_find(self, key, hash, &row), !curr_node) {
+        return NULL;
     }
 
-    return NULL;
+    _os_unlink(row, curr_node);
+    free(curr_node->key);
+    data = curr_node->data;
+    free(curr_node);
+    __sync_sub_and_fetch(&self->elements, 1);
+
+    return data;
+}
+
+/* Return a pointer to a hash node if found, that hash node is removed from the table */
+void *OSHash_Delete(OSHash *self, const char *key)
+{
+    return _OSHash_Delete(self, key, _os_genhash(self, key));
 }
 
 void *OSHash_Numeric_Delete_ex(OSHash *self, int key)
@@ -509,9 +713,13 @@ void *OSHash_Numeric_Delete_ex(OSHash *self, int key)
 /* Return a pointer to a hash node if found, that hash node is removed from the table */
 void *OSHash_Delete_ex(OSHash *self, const char *key)
 {
+    unsigned int hash_key = _os_genhash(self, key);
     void *result;
-    w_rwlock_wrlock((pthread_rwlock_t *)&self->mutex);
-    result = OSHash_Delete(self,key);
+
+    w_rwlock_rdlock((pthread_rwlock_t *)&self->mutex);
+    w_rwlock_wrlock(&self->stripes[OSHASH_STRIPE(hash_key)]);
+    result = _OSHash_Delete(self, key, hash_key);
+    w_rwlock_unlock(&self->stripes[OSHASH_STRIPE(hash_key)]);
     w_rwlock_unlock((pthread_rwlock_t *)&self->mutex);
 
     return result;
@@ -527,30 +735,33 @@ void *OSHash_Delete_ins(OSHash *self, const char *key)
     return result;
 }
 
+/* The copy gets a single table with the nodes of both tables */
 OSHash *OSHash_Duplicate(const OSHash *hash) {
     OSHash *self;
     unsigned int i;
     OSHashNode *curr_node;
-    OSHashNode **next_addr;
+    OSHashNode *new_node;
 
     os_calloc(1, sizeof(OSHash), self);
     self->rows = hash->rows;
     self->initial_seed = hash->initial_seed;
     self->constant = hash->constant;
+    self->elements = hash->elements;
     self->free_data_function = hash->free_data_function;
 
     os_calloc(self->rows + 1, sizeof(OSHashNode*), self->table);
     w_rwlock_init(&self->mutex, NULL);
 
-    for (i = 0; i <= self->rows; i++) {
-        next_addr = &self->table[i];
+    for (i = 0; i < OSHASH_STRIPES; i++) {
+        w_rwlock_init(&self->stripes[i], NULL);
+    }
 
-        for (curr_node = hash->table[i]; curr_node; curr_node = curr_node->next) {
-            os_calloc(1, sizeof(OSHashNode), *next_addr);
-            (*next_addr)->key = strdup(curr_node->key);
-            (*next_addr)->data = curr_node->data;
-            next_addr = &(*next_addr)->next;
-        }
+    for (curr_node = OSHash_Begin(hash, &i); curr_node; curr_node = OSHash_Next(hash, &i, curr_node)) {
+        os_calloc(1, sizeof(OSHashNode), new_node);
+        new_node->key = strdup(curr_node->key);
+        new_node->data = curr_node->data;
+        new_node->hash = curr_node->hash;
+        _os_link(&self->table[new_node->hash & (self->rows - 1)], new_node);
     }
 
     return self;
@@ -561,21 +772,26 @@ OSHash *OSHash_Duplicate_ex(const OSHash *hash) {
     OSHash *result;
 
     w_rwlock_rdlock((pthread_rwlock_t *)&hash->mutex);
+    _os_lock_stripes(hash);
     result = OSHash_Duplicate(hash);
+    _os_unlock_stripes(hash);
     w_rwlock_unlock((pthread_rwlock_t *)&hash->mutex);
 
     return result;
 }
 
 
+/* The positions after the table's belong to the buckets of the old table
+ * that have not been moved yet.
+ */
 OSHashNode *OSHash_Begin(const OSHash *self, unsigned int *i){
 
     OSHashNode *curr_node;
     *i = 0;
 
     if (self) {
-        while (*i <= self->rows) {
-            curr_node = self->table[*i];
+        while (*i <= self->rows + (self->old_table ? self->old_rows : 0)) {
+            curr_node = _os_bucket(self, *i);
             if (curr_node && curr_node->key) {
                 return curr_node;
             }
@@ -594,8 +810,8 @@ OSHashNode *OSHash_Next(const OSHash *self, unsigned int *i, OSHashNode *current
 
     (*i)++;
 
-    while (*i <= self->rows) {
-        current = self->table[*i];
+    while (*i <= self->rows + (self->old_table ? self->old_rows : 0)) {
+        current = _os_bucket(self, *i);
         if (current && current->key) {
             return current;
         }
@@ -627,21 +843,29 @@ void *OSHash_Clean(OSHash *self, void (*cleaner)(void*)){
 
     /* Free the hash table */
     free(self->table);
+    free(self->old_table);
     pthread_rwlock_destroy(&self->mutex);
+
+    for (i = 0; i < OSHASH_STRIPES; i++) {
+        pthread_rwlock_destroy(&self->stripes[i]);
+    }
+
     free(self);
     return NULL;
 }
 
 void OSHash_It(const OSHash *hash, void *data, void (*iterating_function)(OSHashNode **row, OSHashNode **node, void *data)) {
     unsigned int i;
+    OSHashNode **row;
     OSHashNode *node_it;
 
-    for (i = 0; i < hash->rows; i++) {
-        node_it = hash->table[i];
+    for (i = 0; i < hash->rows + (hash->old_table ? hash->old_rows : 0); i++) {
+        row = i < hash->rows ? &hash->table[i] : &hash->old_table[i - hash->rows];
+        node_it = *row;
         while (node_it && node_it->key) {
             OSHashNode *node_cpy = node_it;
 
-            iterating_function(&hash->table[i], &node_it, data);
+            iterating_function(row, &node_it, data);
 
             // To avoid infinite loops
             if (node_cpy == node_it) {
@@ -655,6 +879,7 @@ void OSHash_It_ex(const OSHash *hash, char mode, void *data, void (*iterating_fu
     switch (mode) {
         case 0:
             w_rwlock_rdlock((pthread_rwlock_t *)&hash->mutex);
+            _os_lock_stripes(hash);
         break;
         case 1:
             w_rwlock_wrlock((pthread_rwlock_t *)&hash->mutex);
@@ -667,6 +892,11 @@ void OSHash_It_ex(const OSHash *hash, char mode, void *data, void (*iterating_fu
             return;
     }
     OSHash_It(hash, data, iterating_function);
+
+    if (mode == 0) {
+        _os_unlock_stripes(hash);
+    }
+
     w_rwlock_unlock((pthread_rwlock_t *)&hash->mutex);
 }
 
@@ -684,7 +914,7 @@ int OSHash_GetIndex(OSHash *self, const char *key)
     hash_key = _os_genhash(self, key);
 
     /* Get array index */
-    index = hash_key % self->rows;
+    index = hash_key & (self->rows - 1);
 
     return index;
 }
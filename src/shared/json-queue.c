@@ -9,6 +9,10 @@
 
 #include "shared.h"
 
+#define JQUEUE_BUFFER_SIZE (OS_MAXSTR * 4)
+
+static char * jqueue_read_line(file_queue * queue);
+
 // Initializes queue. Equivalent to initialize every field to 0.
 void jqueue_init(file_queue * queue) {
     memset(queue, 0, sizeof(file_queue));
@@ -26,6 +30,11 @@ int jqueue_open(file_queue * queue, int tail) {
         fclose(queue->fp);
     }
 
+    /* Data read ahead from the previous file is discarded */
+    queue->buffer_start = 0;
+    queue->buffer_end = 0;
+    queue->skip_line = 0;
+
     if (queue->fp = fopen(queue->file_name, "r"), !queue->fp) {
         merror(FOPEN_ERROR, queue->file_name, errno, strerror(errno));
         return -1;
@@ -98,78 +107,120 @@ cJSON * jqueue_next(file_queue * queue) {
     }
 }
 
+/*
+ * Wait until new alerts are written or the file is rotated, for up to timeout seconds.
+ * If the file cannot be watched, sleep for one second.
+ */
+void jqueue_wait(file_queue * queue, unsigned int timeout) {
+#ifndef WIN32
+    if (Wait_FileQueue(queue, timeout) >= 0) {
+        return;
+    }
+#endif
+    sleep(1);
+}
+
 // Close queue
 void jqueue_close(file_queue * queue) {
     fclose(queue->fp);
     queue->fp = NULL;
+    os_free(queue->buffer);
+#ifndef WIN32
+    Unwatch_FileQueue(queue);
+#endif
 }
 
 /**
- * @brief Read and validate a JSON alert from the file queue
+ * @brief Read a complete line from the file queue
+ *
+ * Data is read in large blocks. An incomplete line is kept in the buffer until the rest is written.
  *
  * @param queue pointer to the file_queue struct
- * @post The flag variable may be set to CRALERT_READ_FAILED if the read operation got no data.
- * @post The read position is restored if failed to get a JSON object.
- * @retval NULL No data read or could not get a valid JSON object or read overlong alert. Pointer to the JSON object otherwise.
+ * @post The flag variable is set to CRALERT_READ_FAILED if no complete line is available.
+ * @retval NULL No complete line available, or overlong line. Pointer to the line, valid until the next read, otherwise.
  */
-cJSON * jqueue_parse_json(file_queue * queue) {
-    cJSON * object = NULL;
-    char buffer[OS_MAXSTR + 1];
-    int64_t initial_pos;
-    int64_t current_pos;
-    int64_t offset;
-    const char * jsonErrPtr;
-    char * end;
-
-    initial_pos = w_ftell(queue->fp);
-
-    if (fgets(buffer, OS_MAXSTR + 1, queue->fp)) {
+static char * jqueue_read_line(file_queue * queue) {
+    char * line;
+    char * newline;
+    size_t nread;
+
+    if (!queue->buffer) {
+        os_malloc(JQUEUE_BUFFER_SIZE, queue->buffer);
+        queue->buffer_start = 0;
+        queue->buffer_end = 0;
+    }
 
-        offset = w_ftell(queue->fp);
+    while (1) {
+        line = queue->buffer + queue->buffer_start;
 
-        if (end = buffer + offset - initial_pos - 1, *end == '\n') {
-            *end = '\0';
+        if (newline = memchr(line, '\n', queue->buffer_end - queue->buffer_start), newline) {
+            *newline = '\0';
+            queue->buffer_start = newline - queue->buffer + 1;
 
-            if ((object = cJSON_ParseWithOpts(buffer, &jsonErrPtr, 0), object) && (*jsonErrPtr == '\0')) {
-                return object;
+            if (queue->skip_line || newline - line >= OS_MAXSTR) {
+                queue->skip_line = 0;
+                mwarn("Overlong JSON alert read from '%s'", queue->file_name);
+                return NULL;
             }
 
-            // The read JSON is invalid
-            cJSON_Delete(object);
+            return line;
+        }
 
-            mwarn("Invalid JSON alert read from '%s': '%s'", queue->file_name, buffer);
-            return NULL;
+        if (queue->skip_line || queue->buffer_end - queue->buffer_start >= OS_MAXSTR) {
+            // The line is too long: discard it up to its end
+            queue->skip_line = 1;
+            queue->buffer_start = 0;
+            queue->buffer_end = 0;
+        } else if (queue->buffer_start > 0) {
+            // Move the incomplete line to the beginning of the buffer
+            memmove(queue->buffer, line, queue->buffer_end - queue->buffer_start);
+            queue->buffer_end -= queue->buffer_start;
+            queue->buffer_start = 0;
         }
 
-        current_pos = initial_pos;
+        if (nread = fread(queue->buffer + queue->buffer_end, 1, JQUEUE_BUFFER_SIZE - queue->buffer_end, queue->fp), nread == 0) {
+            queue->flags = CRALERT_READ_FAILED;
+            return NULL;
+        }
 
-        while ((offset-current_pos) == OS_MAXSTR) {
-            if (fgets(buffer, OS_MAXSTR + 1, queue->fp)) {
+        queue->buffer_end += nread;
+    }
+}
 
-                current_pos = offset;
-                offset = w_ftell(queue->fp);
+/**
+ * @brief Read and validate a JSON alert from the file queue
+ *
+ * Invalid and overlong alerts are dropped, and the next line is read.
+ *
+ * @param queue pointer to the file_queue struct
+ * @post The flag variable is reset, and set to CRALERT_READ_FAILED if no valid alert is available.
+ * @post An incomplete alert is kept until the rest of the line is written.
+ * @retval NULL No complete valid alert available. Pointer to the JSON object otherwise.
+ */
+cJSON * jqueue_parse_json(file_queue * queue) {
+    cJSON * object = NULL;
+    const char * jsonErrPtr;
+    char * line;
 
-                if (buffer[offset - current_pos - 1] == '\n') {
-                    mwarn("Overlong JSON alert read from '%s'", queue->file_name);
-                    return NULL;
-                }
+    queue->flags = 0;
 
-            } else {
-                break;
+    while (1) {
+        if (line = jqueue_read_line(queue), !line) {
+            if (queue->flags & CRALERT_READ_FAILED) {
+                return NULL;
             }
-        }
 
-        mdebug2("Can't read from '%s'. Trying again", queue->file_name);
+            // The overlong line was dropped
+            continue;
+        }
 
-        if (initial_pos >= 0) {
-            if (fseek(queue->fp, initial_pos, SEEK_SET) != 0) {
-                queue->flags = CRALERT_READ_FAILED;
-            }
+        if ((object = cJSON_ParseWithOpts(line, &jsonErrPtr, 0), object) && (*jsonErrPtr == '\0')) {
+            return object;
         }
-    } else {
-        // Force the queue reload when the read fails
-        queue->flags = CRALERT_READ_FAILED;
-    }
 
-    return NULL;
+        // The read JSON is invalid
+        cJSON_Delete(object);
+
+        mwarn("Invalid JSON alert read from '%s': '%s'", queue->file_name, line);
+    }
 }
@@ -918,16 +918,27 @@ int whodata_audit_start() {
     return 0;
 }
 
+/* Remove a directory of syscheck.wdata.directories not seen since stale_time */
+static void remove_stale_directory(__attribute__((unused)) OSHashNode **row, OSHashNode **node, void *stale_time) {
+    whodata_directory *w_dir = (*node)->data;
+    OSHashNode *w_dir_node = *node;
+
+    if (w_dir->QuadPart < ((ULARGE_INTEGER *)stale_time)->QuadPart) {
+        // Continue from the next node, as this one is freed
+        *node = w_dir_node->next;
+
+        if (w_dir = OSHash_Delete(syscheck.wdata.directories, w_dir_node->key), w_dir) {
+            free(w_dir);
+        }
+    }
+}
+
 long unsigned int WINAPI state_checker(__attribute__((unused)) void *_void) {
     int exists;
     whodata_dir_status *d_status;
     int interval;
-    OSHashNode *w_dir_node;
-    OSHashNode *w_dir_node_next;
-    whodata_directory *w_dir;
     directory_t *dir_it;
     OSListNode *node_it;
-    unsigned int w_dir_it;
     FILETIME current_time;
     ULARGE_INTEGER stale_time;
 
@@ -1016,27 +1027,8 @@ long unsigned int WINAPI state_checker(__attribute__((unused)) void *_void) {
         // 5 seconds ago
         stale_time.QuadPart -= 5 * FILETIME_SECOND;
 
-        w_dir_it = 0;
         w_rwlock_wrlock(&syscheck.wdata.directories->mutex);
-
-        while (w_dir_it <= syscheck.wdata.directories->rows) {
-            w_dir_node = syscheck.wdata.directories->table[w_dir_it];
-            w_dir_node_next = w_dir_node;
-
-            while(w_dir_node_next) {
-                w_dir_node_next = w_dir_node_next->next;
-
-                w_dir = w_dir_node->data;
-                if (w_dir->QuadPart < stale_time.QuadPart) {
-                    if (w_dir = OSHash_Delete(syscheck.wdata.directories, w_dir_node->key), w_dir) {
-                        free(w_dir);
-                    }
-                }
-                w_dir_node = w_dir_node_next;
-            }
-            w_dir_it++;
-        }
-
+        OSHash_It(syscheck.wdata.directories, &stale_time, remove_stale_directory);
         w_rwlock_unlock(&syscheck.wdata.directories->mutex);
 
         sleep(interval);
@@ -72,6 +72,12 @@ extern OSHash *w_logtest_sessions;
 
 int session_level_alert = 7;
 
+/* Forget the latest ruleset, so that the next session builds it again */
+static void reset_ruleset(void) {
+    os_free(w_logtest_ruleset->version);
+    os_free(w_logtest_ruleset);
+}
+
 /* setup/teardown */
 
 static int setup_group(void **state) {
@@ -899,10 +905,6 @@ void test_w_logtest_remove_session_OK(void **state)
     expect_value(__wrap_OSHash_Delete, key, "test");
     will_return(__wrap_OSHash_Delete, session);
 
-    will_return(__wrap_OSStore_Free, session->decoder_store);
-
-    will_return(__wrap_OSHash_Free, session);
-
     will_return(__wrap_OSHash_Free, session);
 
     will_return(__wrap_pthread_mutex_destroy, 0);
@@ -997,10 +999,6 @@ void test_w_logtest_check_inactive_sessions_remove(void **state)
     expect_value(__wrap_OSHash_Delete, key, "test");
     will_return(__wrap_OSHash_Delete, session);
 
-    will_return(__wrap_OSStore_Free, NULL);
-
-    will_return(__wrap_OSHash_Free, session);
-
     will_return(__wrap_OSHash_Free, session);
 
     will_return(__wrap_pthread_mutex_destroy, 0);
@@ -1061,10 +1059,6 @@ void test_w_logtest_remove_old_session_one(void ** state) {
     expect_string(__wrap_OSHash_Delete, key, "old_session");
     will_return(__wrap_OSHash_Delete, old_session);
 
-    will_return(__wrap_OSStore_Free, old_session->decoder_store);
-
-    will_return(__wrap_OSHash_Free, old_session);
-
     will_return(__wrap_OSHash_Free, old_session);
 
     will_return(__wrap_pthread_mutex_destroy, 0);
@@ -1116,10 +1110,6 @@ void test_w_logtest_remove_old_session_many(void ** state) {
     expect_value(__wrap_OSHash_Delete, key, old_session->token);
     will_return(__wrap_OSHash_Delete, old_session);
 
-    will_return(__wrap_OSStore_Free, NULL);
-
-    will_return(__wrap_OSHash_Free, old_session);
-
     will_return(__wrap_OSHash_Free, old_session);
 
     will_return(__wrap_pthread_mutex_destroy, 0);
@@ -1198,10 +1188,6 @@ void test_w_logtest_register_session_remove_old(void ** state) {
     expect_value(__wrap_OSHash_Delete, key, old_session->token);
     will_return(__wrap_OSHash_Delete, old_session);
 
-    will_return(__wrap_OSStore_Free, NULL);
-
-    will_return(__wrap_OSHash_Free, old_session);
-
     will_return(__wrap_OSHash_Free, old_session);
 
     will_return(__wrap_pthread_mutex_destroy, 0);
@@ -1299,6 +1285,12 @@ void test_w_logtest_initialize_session_error_decoders(void ** state) {
     will_return(__wrap_OS_GetElementsbyNode, (xml_node **) calloc(1, sizeof(xml_node *)));
     will_return(__wrap_Read_Rules, 0);
 
+    /* w_logtest_ruleset_get: build mutex and ruleset mutex */
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+
     will_return(__wrap_ReadDecodeXML, 0);
 
 
@@ -1351,6 +1343,12 @@ void test_w_logtest_initialize_session_error_set_decoders(void ** state) {
     will_return(__wrap_OS_GetElementsbyNode, (xml_node **) calloc(1, sizeof(xml_node *)));
     will_return(__wrap_Read_Rules, 0);
 
+    /* w_logtest_ruleset_get: build mutex and ruleset mutex */
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+
 
     will_return(__wrap_ReadDecodeXML, 1);
     will_return(__wrap_SetDecodeXML, 0);
@@ -1406,6 +1404,12 @@ void test_w_logtest_initialize_session_error_cbd_list(void ** state) {
     will_return(__wrap_OS_GetElementsbyNode, (xml_node **) calloc(1, sizeof(xml_node *)));
     will_return(__wrap_Read_Rules, 0);
 
+    /* w_logtest_ruleset_get: build mutex and ruleset mutex */
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+
 
     will_return(__wrap_ReadDecodeXML, 1);
     will_return(__wrap_SetDecodeXML, 1);
@@ -1462,6 +1466,12 @@ void test_w_logtest_initialize_session_error_rules(void ** state) {
     will_return(__wrap_OS_GetElementsbyNode, (xml_node **) calloc(1, sizeof(xml_node *)));
     will_return(__wrap_Read_Rules, 0);
 
+    /* w_logtest_ruleset_get: build mutex and ruleset mutex */
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+
     will_return(__wrap_ReadDecodeXML, 1);
     will_return(__wrap_SetDecodeXML, 1);
     will_return(__wrap_Lists_OP_LoadList, 0);
@@ -1518,6 +1528,12 @@ void test_w_logtest_initialize_session_error_hash_rules(void ** state) {
     will_return(__wrap_OS_GetElementsbyNode, (xml_node **) calloc(1, sizeof(xml_node *)));
     will_return(__wrap_Read_Rules, 0);
 
+    /* w_logtest_ruleset_get: build mutex and ruleset mutex */
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+
     will_return(__wrap_ReadDecodeXML, 1);
     will_return(__wrap_SetDecodeXML, 1);
     will_return(__wrap_Lists_OP_LoadList, 0);
@@ -1577,6 +1593,14 @@ void test_w_logtest_initialize_session_error_fts_init(void ** state) {
     will_return(__wrap_OS_GetElementsbyNode, (xml_node **) calloc(1, sizeof(xml_node *)));
     will_return(__wrap_Read_Rules, 0);
 
+    /* w_logtest_ruleset_get: build mutex and twice the ruleset mutex */
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+
     will_return(__wrap_ReadDecodeXML, 1);
     will_return(__wrap_SetDecodeXML, 1);
     will_return(__wrap_Lists_OP_LoadList, 0);
@@ -1593,8 +1617,9 @@ void test_w_logtest_initialize_session_error_fts_init(void ** state) {
     expect_string(__wrap__merror, formatted_msg, "(1290): Unable to create a new list (calloc).");
 
     // test_w_logtest_remove_session_ok_error_FTS_INIT
-    will_return(__wrap_OSStore_Free, (OSStore *) 8);
-    will_return(__wrap_OSHash_Free, (OSHash *) 0);
+    /* w_logtest_ruleset_release: the ruleset is kept as the latest one */
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
 
     will_return(__wrap_pthread_mutex_destroy, 0);
 
@@ -1602,6 +1627,8 @@ void test_w_logtest_initialize_session_error_fts_init(void ** state) {
 
     assert_null(session);
 
+    reset_ruleset();
+
     os_free(token);
 }
 
@@ -1645,6 +1672,14 @@ void test_w_logtest_initialize_session_error_accumulate_init(void ** state) {
     will_return(__wrap_OS_GetElementsbyNode, (xml_node **) calloc(1, sizeof(xml_node *)));
     will_return(__wrap_Read_Rules, 0);
 
+    /* w_logtest_ruleset_get: build mutex and twice the ruleset mutex */
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+
     will_return(__wrap_ReadDecodeXML, 1);
     will_return(__wrap_SetDecodeXML, 1);
     will_return(__wrap_Lists_OP_LoadList, 0);
@@ -1670,8 +1705,9 @@ void test_w_logtest_initialize_session_error_accumulate_init(void ** state) {
     will_return(__wrap_Accumulate_Init, 0);
 
     // test_w_logtest_remove_session_ok_error_acm
-    will_return(__wrap_OSStore_Free, (OSStore *) 8);
-    will_return(__wrap_OSHash_Free, (OSStore *) 8);
+    /* w_logtest_ruleset_release: the ruleset is kept as the latest one */
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
     will_return(__wrap_OSHash_Free, (OSStore *) 8);
 
     will_return(__wrap_OSHash_Free, (OSStore *) 8);
@@ -1685,6 +1721,8 @@ void test_w_logtest_initialize_session_error_accumulate_init(void ** state) {
 
     assert_null(session);
 
+    reset_ruleset();
+
     os_free(token);
 }
 
@@ -1728,6 +1766,14 @@ void test_w_logtest_initialize_session_success(void ** state) {
     will_return(__wrap_OS_GetElementsbyNode, (xml_node **) calloc(1, sizeof(xml_node *)));
     will_return(__wrap_Read_Rules, 0);
 
+    /* w_logtest_ruleset_get: build mutex and twice the ruleset mutex */
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+
     will_return(__wrap_ReadDecodeXML, 1);
     will_return(__wrap_SetDecodeXML, 1);
     will_return(__wrap_Lists_OP_LoadList, 0);
@@ -1756,6 +1802,93 @@ void test_w_logtest_initialize_session_success(void ** state) {
     assert_non_null(session);
     assert_int_equal(session->last_connection, 1212);
 
+    reset_ruleset();
+
+    os_free(token);
+    os_free(session->eventlist);
+    os_free(session->token);
+    os_free(session);
+
+}
+
+void test_w_logtest_initialize_session_success_shared_ruleset(void ** state) {
+
+    char * token = strdup("test");
+    OSList * msg = (OSList *) 8;
+    w_logtest_session_t * session;
+
+    random_bytes_result = 1234565555; // 0x49_95_f9_b3
+    expect_value(__wrap_randombytes, length, W_LOGTEST_TOKEN_LENGH >> 1);
+
+    expect_string(__wrap_OSHash_Get_ex, key, "4995f9b3");
+    will_return(__wrap_OSHash_Get_ex, NULL);
+
+    will_return(__wrap_time, 1212);
+    will_return(__wrap_pthread_mutex_init, 0);
+
+    /* w_logtest_ruleset_load */
+    expect_function_call_any(__wrap_OS_ClearNode);
+    will_return(__wrap_OS_ReadXML, 0);
+    XML_NODE node;
+    os_calloc(2, sizeof(xml_node *), node);
+    /* <ossec_config></> */
+    os_calloc(1, sizeof(xml_node), node[0]);
+    os_strdup("ossec_config", node[0]->element);
+    will_return(__wrap_OS_GetElementsbyNode, node);
+    // w_logtest_ruleset_load_config ok
+    XML_NODE conf_section_nodes;
+    os_calloc(3, sizeof(xml_node *), conf_section_nodes);
+    // Alert
+    os_calloc(1, sizeof(xml_node), conf_section_nodes[0]);
+    // Ruleset
+    os_calloc(1, sizeof(xml_node), conf_section_nodes[1]);
+    will_return(__wrap_OS_GetElementsbyNode, conf_section_nodes);
+    /* xml ruleset */
+    os_strdup("alerts", conf_section_nodes[0]->element);
+    os_strdup("ruleset", conf_section_nodes[1]->element);
+    will_return(__wrap_OS_GetElementsbyNode, (xml_node **) calloc(1, sizeof(xml_node *)));
+    will_return(__wrap_Read_Alerts, 0);
+    will_return(__wrap_OS_GetElementsbyNode, (xml_node **) calloc(1, sizeof(xml_node *)));
+    will_return(__wrap_Read_Rules, 0);
+
+    /* w_logtest_ruleset_get: same files, the ruleset is not built again */
+    w_logtest_ruleset_t * ruleset;
+    os_calloc(1, sizeof(w_logtest_ruleset_t), ruleset);
+    os_strdup("7\ntest_decoder.xml\ntest_list.xml\ntest_rule.xml", ruleset->version);
+    ruleset->references = 1;
+    ruleset->logbylevel = session_level_alert;
+    w_logtest_ruleset = ruleset;
+
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+
+    /* FTS init success */
+    OSList * fts_list;
+    OSHash * fts_store;
+    OSList * list = (OSList *) 8;
+    OSHash * hash = (OSHash *) 8;
+    will_return(__wrap_getDefine_Int, 5);
+    will_return(__wrap_OSList_Create, list);
+    will_return(__wrap_OSList_SetMaxSize, 1);
+    will_return(__wrap_OSHash_Create, hash);
+    expect_value(__wrap_OSHash_setSize, new_size, 2048);
+    will_return(__wrap_OSHash_setSize, 1);
+    will_return(__wrap_OSHash_SetFreeDataPointer, 1);
+
+    will_return(__wrap_Accumulate_Init, 1);
+
+    session = w_logtest_initialize_session(msg);
+
+    assert_non_null(session);
+    assert_int_equal(session->last_connection, 1212);
+    assert_ptr_equal(session->ruleset, ruleset);
+    assert_int_equal(ruleset->references, 2);
+    assert_int_equal(session->logbylevel, session_level_alert);
+
+    reset_ruleset();
+
     os_free(token);
     os_free(session->eventlist);
     os_free(session->token);
@@ -1809,6 +1942,14 @@ void test_w_logtest_initialize_session_success_duplicate_key(void ** state) {
     will_return(__wrap_OS_GetElementsbyNode, (xml_node **) calloc(1, sizeof(xml_node *)));
     will_return(__wrap_Read_Rules, 0);
 
+    /* w_logtest_ruleset_get: build mutex and twice the ruleset mutex */
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+
     will_return(__wrap_ReadDecodeXML, 1);
     will_return(__wrap_SetDecodeXML, 1);
     will_return(__wrap_Lists_OP_LoadList, 0);
@@ -1837,6 +1978,8 @@ void test_w_logtest_initialize_session_success_duplicate_key(void ** state) {
     assert_non_null(session);
     assert_int_equal(session->last_connection, 1212);
 
+    reset_ruleset();
+
     os_free(token);
     os_free(session->eventlist);
     os_free(session->token);
@@ -3140,6 +3283,12 @@ void test_w_logtest_process_request_type_log_processing(void ** state) {
     will_return(__wrap_OS_GetElementsbyNode, (xml_node **) calloc(1, sizeof(xml_node *)));
     will_return(__wrap_Read_Rules, 0);
 
+    /* w_logtest_ruleset_get: build mutex and ruleset mutex */
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+
     will_return(__wrap_ReadDecodeXML, 0);
 
     // test_w_logtest_remove_session_ok_error_load_decoder_cbd_rules_hash
@@ -3232,31 +3381,33 @@ void test_w_logtest_generate_error_response_ok(void ** state) {
 void test_w_logtest_decoding_phase_program_name(void ** state)
 {
     Eventinfo lf = {0};
-    w_logtest_session_t session = {0};
+    w_logtest_ruleset_t ruleset = {0};
+    w_logtest_session_t session = {.ruleset = &ruleset};
 
     lf.program_name = strdup("program name test");
-    os_calloc(1, sizeof(OSDecoderNode), session.decoderlist_forpname);
+    os_calloc(1, sizeof(OSDecoderNode), ruleset.decoderlist_forpname);
 
-    expect_value(__wrap_DecodeEvent, node, session.decoderlist_forpname);
+    expect_value(__wrap_DecodeEvent, node, ruleset.decoderlist_forpname);
     w_logtest_decoding_phase(&lf, &session);
 
     os_free(lf.program_name);
-    os_free(session.decoderlist_forpname);
+    os_free(ruleset.decoderlist_forpname);
 
 }
 
 void test_w_logtest_decoding_phase_no_program_name(void ** state)
 {
     Eventinfo lf = {0};
-    w_logtest_session_t session = {0};
+    w_logtest_ruleset_t ruleset = {0};
+    w_logtest_session_t session = {.ruleset = &ruleset};
 
     lf.program_name = NULL;
-    os_calloc(1, sizeof(OSDecoderNode), session.decoderlist_nopname);
+    os_calloc(1, sizeof(OSDecoderNode), ruleset.decoderlist_nopname);
 
-    expect_value(__wrap_DecodeEvent, node, session.decoderlist_nopname);
+    expect_value(__wrap_DecodeEvent, node, ruleset.decoderlist_nopname);
     w_logtest_decoding_phase(&lf, &session);
 
-    os_free(session.decoderlist_nopname);
+    os_free(ruleset.decoderlist_nopname);
 }
 
 // w_logtest_preprocessing_phase
@@ -3445,7 +3596,8 @@ void test_w_logtest_preprocessing_phase_str_event_fail(void ** state)
 void test_w_logtest_rulesmatching_phase_no_load_rules(void ** state)
 {
     Eventinfo lf = {0};
-    w_logtest_session_t session = {0};
+    w_logtest_ruleset_t ruleset = {0};
+    w_logtest_session_t session = {.ruleset = &ruleset};
     OSList list_msg = {0};
     const int expect_retval = -1;
     int retval;
@@ -3464,7 +3616,8 @@ void test_w_logtest_rulesmatching_phase_no_load_rules(void ** state)
 void test_w_logtest_rulesmatching_phase_ossec_alert(void ** state)
 {
     Eventinfo lf = {0};
-    w_logtest_session_t session = {0};
+    w_logtest_ruleset_t ruleset = {0};
+    w_logtest_session_t session = {.ruleset = &ruleset};
     OSList list_msg = {0};
     const int expect_retval = 0;
     int retval;
@@ -3491,7 +3644,8 @@ void test_w_logtest_rulesmatching_phase_ossec_alert(void ** state)
 void test_w_logtest_rulesmatching_phase_dont_match_category(void ** state)
 {
     Eventinfo lf = {0};
-    w_logtest_session_t session = {0};
+    w_logtest_ruleset_t ruleset = {0};
+    w_logtest_session_t session = {.ruleset = &ruleset};
     OSList list_msg = {0};
     const int expect_retval = 0;
     int retval;
@@ -3524,7 +3678,8 @@ void test_w_logtest_rulesmatching_phase_dont_match_category(void ** state)
 void test_w_logtest_rulesmatching_phase_dont_match(void ** state)
 {
     Eventinfo lf = {0};
-    w_logtest_session_t session = {0};
+    w_logtest_ruleset_t ruleset = {0};
+    w_logtest_session_t session = {.ruleset = &ruleset};
     OSList list_msg = {0};
     const int expect_retval = 0;
     int retval;
@@ -3559,7 +3714,8 @@ void test_w_logtest_rulesmatching_phase_dont_match(void ** state)
 void test_w_logtest_rulesmatching_phase_match_level_0(void ** state)
 {
     Eventinfo lf = {0};
-    w_logtest_session_t session = {0};
+    w_logtest_ruleset_t ruleset = {0};
+    w_logtest_session_t session = {.ruleset = &ruleset};
     OSList list_msg = {0};
     const int expect_retval = 0;
     int retval;
@@ -3595,7 +3751,8 @@ void test_w_logtest_rulesmatching_phase_match_level_0(void ** state)
 void test_w_logtest_rulesmatching_phase_match_dont_ignore_first_time(void ** state)
 {
     Eventinfo lf = {0};
-    w_logtest_session_t session = {0};
+    w_logtest_ruleset_t ruleset = {0};
+    w_logtest_session_t session = {.ruleset = &ruleset};
     OSList list_msg = {0};
     const int expect_retval = 1;
     int retval;
@@ -3635,7 +3792,8 @@ void test_w_logtest_rulesmatching_phase_match_dont_ignore_first_time(void ** sta
 void test_w_logtest_rulesmatching_phase_match_ignore_time_ignore(void ** state)
 {
     Eventinfo lf = {0};
-    w_logtest_session_t session = {0};
+    w_logtest_ruleset_t ruleset = {0};
+    w_logtest_session_t session = {.ruleset = &ruleset};
     OSList list_msg = {0};
     const int expect_retval = 0;
     int retval;
@@ -3675,7 +3833,8 @@ void test_w_logtest_rulesmatching_phase_match_ignore_time_ignore(void ** state)
 void test_w_logtest_rulesmatching_phase_match_dont_ignore_time_out_windows(void ** state)
 {
     Eventinfo lf = {0};
-    w_logtest_session_t session = {0};
+    w_logtest_ruleset_t ruleset = {0};
+    w_logtest_session_t session = {.ruleset = &ruleset};
     OSList list_msg = {0};
     const int expect_retval = 1;
     int retval;
@@ -3716,7 +3875,8 @@ void test_w_logtest_rulesmatching_phase_match_dont_ignore_time_out_windows(void
 void test_w_logtest_rulesmatching_phase_match_ignore_event(void ** state)
 {
     Eventinfo lf = {0};
-    w_logtest_session_t session = {0};
+    w_logtest_ruleset_t ruleset = {0};
+    w_logtest_session_t session = {.ruleset = &ruleset};
     OSList list_msg = {0};
     const int expect_retval = 0;
     int retval;
@@ -3754,7 +3914,8 @@ void test_w_logtest_rulesmatching_phase_match_ignore_event(void ** state)
 void test_w_logtest_rulesmatching_phase_match_and_if_matched_sid_ok(void ** state)
 {
     Eventinfo lf = {0};
-    w_logtest_session_t session = {0};
+    w_logtest_ruleset_t ruleset = {0};
+    w_logtest_session_t session = {.ruleset = &ruleset};
     OSList list_msg = {0};
     const int expect_retval = 1;
     int retval;
@@ -3798,7 +3959,8 @@ void test_w_logtest_rulesmatching_phase_match_and_if_matched_sid_ok(void ** stat
 void test_w_logtest_rulesmatching_phase_match_and_if_matched_sid_fail(void ** state)
 {
     Eventinfo lf = {0};
-    w_logtest_session_t session = {0};
+    w_logtest_ruleset_t ruleset = {0};
+    w_logtest_session_t session = {.ruleset = &ruleset};
     OSList list_msg = {0};
     const int expect_retval = 1;
     int retval;
@@ -3845,7 +4007,8 @@ void test_w_logtest_rulesmatching_phase_match_and_if_matched_sid_fail(void ** st
 void test_w_logtest_rulesmatching_phase_match_and_group_prev_matched_fail(void ** state)
 {
     Eventinfo lf = {0};
-    w_logtest_session_t session = {0};
+    w_logtest_ruleset_t ruleset = {0};
+    w_logtest_session_t session = {.ruleset = &ruleset};
     OSList list_msg = {0};
     const int expect_retval = 1;
     int retval;
@@ -3896,7 +4059,8 @@ void test_w_logtest_rulesmatching_phase_match_and_group_prev_matched_fail(void *
 void test_w_logtest_rulesmatching_phase_match_and_group_prev_matched(void ** state)
 {
     Eventinfo lf = {0};
-    w_logtest_session_t session = {0};
+    w_logtest_ruleset_t ruleset = {0};
+    w_logtest_session_t session = {.ruleset = &ruleset};
     OSList list_msg = {0};
     const int expect_retval = 1;
     int retval;
@@ -3954,7 +4118,8 @@ void test_w_logtest_process_log_preprocessing_fail(void ** state)
     char * raw_event = strdup("event");
     char * str_location = strdup("location");
 
-    w_logtest_session_t session = {0};
+    w_logtest_ruleset_t ruleset = {0};
+    w_logtest_session_t session = {.ruleset = &ruleset};
     OSList list_msg = {0};
 
     cJSON * retval;
@@ -3994,7 +4159,8 @@ void test_w_logtest_process_log_rule_match_fail(void ** state)
     char * raw_event = strdup("event");
     char * str_location = strdup("location");
 
-    w_logtest_session_t session = {0};
+    w_logtest_ruleset_t ruleset = {0};
+    w_logtest_session_t session = {.ruleset = &ruleset};
     OSList list_msg = {0};
     OSDecoderInfo decoder_info = {0};
     decoder_info.accumulate = 0;
@@ -4010,7 +4176,7 @@ void test_w_logtest_process_log_rule_match_fail(void ** state)
 
     refill_OS_CleanMSG = true;
     will_return(__wrap_OS_CleanMSG, 0);
-    expect_value(__wrap_DecodeEvent, node, session.decoderlist_forpname);
+    expect_value(__wrap_DecodeEvent, node, ruleset.decoderlist_forpname);
 
     retval = w_logtest_process_log(&request, &session, &extra_data, &list_msg);
 
@@ -4040,7 +4206,8 @@ void test_w_logtest_process_log_rule_dont_match(void ** state)
     char * raw_event = strdup("event");
     char * str_location = strdup("location");
 
-    w_logtest_session_t session = {0};
+    w_logtest_ruleset_t ruleset = {0};
+    w_logtest_session_t session = {.ruleset = &ruleset};
     OSList list_msg = {0};
     OSDecoderInfo decoder_info = {0};
     decoder_info.accumulate = 1;
@@ -4066,7 +4233,7 @@ void test_w_logtest_process_log_rule_dont_match(void ** state)
     refill_OS_CleanMSG = true;
     will_return(__wrap_OS_CleanMSG, 0);
     // w_logtest_decoding_phase
-    expect_value(__wrap_DecodeEvent, node, session.decoderlist_forpname);
+    expect_value(__wrap_DecodeEvent, node, ruleset.decoderlist_forpname);
 
     will_return(__wrap_Eventinfo_to_jsonstr, strdup("output example"));
     will_return(__wrap_cJSON_Parse, output);
@@ -4105,7 +4272,8 @@ void test_w_logtest_process_log_rule_match(void ** state)
     char * raw_event = strdup("event");
     char * str_location = strdup("location");
 
-    w_logtest_session_t session = {0};
+    w_logtest_ruleset_t ruleset = {0};
+    w_logtest_session_t session = {.ruleset = &ruleset};
     OSList list_msg = {0};
     OSDecoderInfo decoder_info = {0};
     decoder_info.accumulate = 1;
@@ -4133,7 +4301,7 @@ void test_w_logtest_process_log_rule_match(void ** state)
     will_return(__wrap_OS_CleanMSG, 0);
 
     // w_logtest_decoding_phase
-    expect_value(__wrap_DecodeEvent, node, session.decoderlist_forpname);
+    expect_value(__wrap_DecodeEvent, node, ruleset.decoderlist_forpname);
 
     // w_logtest_rulesmatching_phase
     will_return(__wrap_OS_CheckIfRuleMatch, &ruleinfo);
@@ -4178,7 +4346,8 @@ void test_w_logtest_process_log_rule_match_level_0(void ** state)
     char * raw_event = strdup("event");
     char * str_location = strdup("location");
 
-    w_logtest_session_t session = {0};
+    w_logtest_ruleset_t ruleset = {0};
+    w_logtest_session_t session = {.ruleset = &ruleset};
     OSList list_msg = {0};
     OSDecoderInfo decoder_info = {0};
     decoder_info.accumulate = 1;
@@ -4206,7 +4375,7 @@ void test_w_logtest_process_log_rule_match_level_0(void ** state)
     will_return(__wrap_OS_CleanMSG, 0);
 
     // w_logtest_decoding_phase
-    expect_value(__wrap_DecodeEvent, node, session.decoderlist_forpname);
+    expect_value(__wrap_DecodeEvent, node, ruleset.decoderlist_forpname);
 
     // w_logtest_rulesmatching_phase
     will_return(__wrap_OS_CheckIfRuleMatch, &ruleinfo);
@@ -4446,10 +4615,6 @@ void test_w_logtest_process_request_remove_session_ok(void ** state)
     expect_value(__wrap_OSHash_Delete, key, "000015b3");
     will_return(__wrap_OSHash_Delete, session);
 
-    will_return(__wrap_OSStore_Free, session->decoder_store);
-
-    will_return(__wrap_OSHash_Free, session);
-
     will_return(__wrap_OSHash_Free, session);
 
     will_return(__wrap_pthread_mutex_destroy, 0);
@@ -4788,6 +4953,12 @@ void test_w_logtest_process_request_log_processing_fail_session(void ** state)
     will_return(__wrap_OS_GetElementsbyNode, (xml_node **) calloc(1, sizeof(xml_node *)));
     will_return(__wrap_Read_Rules, 0);
 
+    /* w_logtest_ruleset_get: build mutex and ruleset mutex */
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+
     will_return(__wrap_ReadDecodeXML, 0);
 
     // test_w_logtest_remove_session_ok_error_load_decoder_cbd_rules_hash
@@ -4847,6 +5018,7 @@ void test_w_logtest_process_request_log_processing_fail_process_log(void ** stat
 
     // get session
     cJSON * json_request_token;
+    w_logtest_ruleset_t ruleset = {0};
     w_logtest_session_t active_session;
     char * token = strdup("test_token");
     const time_t now = (time_t) 2020;
@@ -4854,6 +5026,7 @@ void test_w_logtest_process_request_log_processing_fail_process_log(void ** stat
     os_calloc(1, sizeof(cJSON), json_request_token);
     json_request_token->valuestring = token;
     active_session.last_connection = 0;
+    active_session.ruleset = &ruleset;
 
     will_return(__wrap_cJSON_GetObjectItemCaseSensitive, json_request_token);
 
@@ -4975,6 +5148,7 @@ void test_w_logtest_process_request_log_processing_ok_and_alert(void ** state)
 
     // get session
     cJSON * json_request_token;
+    w_logtest_ruleset_t ruleset = {0};
     w_logtest_session_t active_session;
     char * token = strdup("test_token");
     const time_t now = (time_t) 2020;
@@ -4982,6 +5156,7 @@ void test_w_logtest_process_request_log_processing_ok_and_alert(void ** state)
     os_calloc(1, sizeof(cJSON), json_request_token);
     json_request_token->valuestring = token;
     active_session.last_connection = 0;
+    active_session.ruleset = &ruleset;
     active_session.logbylevel = 3;
 
     will_return(__wrap_cJSON_GetObjectItemCaseSensitive, json_request_token);
@@ -5178,6 +5353,14 @@ void test_w_logtest_process_request_log_processing_ok_session_expired(void ** st
     will_return(__wrap_OS_GetElementsbyNode, (xml_node **) calloc(1, sizeof(xml_node *)));
     will_return(__wrap_Read_Rules, 0);
 
+    /* w_logtest_ruleset_get: build mutex and twice the ruleset mutex */
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+
     will_return(__wrap_ReadDecodeXML, 1);
     will_return(__wrap_SetDecodeXML, 1);
     will_return(__wrap_Lists_OP_LoadList, 0);
@@ -5315,6 +5498,9 @@ void test_w_logtest_process_request_log_processing_ok_session_expired(void ** st
     os_free(stored_session->token);
     os_free(stored_session->eventlist);
     os_free(stored_session);
+
+    reset_ruleset();
+
     os_free(token);
     os_free(json_request_token);
     os_free(list_msg);
@@ -5339,6 +5525,7 @@ void test_w_logtest_process_request_log_processing_options_without_rules_debug(v
 
     // get session
     cJSON * json_request_token;
+    w_logtest_ruleset_t ruleset = {0};
     w_logtest_session_t active_session;
     char * token = strdup("test_token");
     const time_t now = (time_t) 2020;
@@ -5346,6 +5533,7 @@ void test_w_logtest_process_request_log_processing_options_without_rules_debug(v
     os_calloc(1, sizeof(cJSON), json_request_token);
     json_request_token->valuestring = token;
     active_session.last_connection = 0;
+    active_session.ruleset = &ruleset;
 
     will_return(__wrap_cJSON_GetObjectItemCaseSensitive, json_request_token);
 
@@ -5550,6 +5738,7 @@ void test_w_logtest_process_request_log_processing_rules_debug_not_bolean(void *
 
     // get session
     cJSON * json_request_token;
+    w_logtest_ruleset_t ruleset = {0};
     w_logtest_session_t active_session;
     char * token = strdup("test_token");
     const time_t now = (time_t) 2020;
@@ -5557,6 +5746,7 @@ void test_w_logtest_process_request_log_processing_rules_debug_not_bolean(void *
     os_calloc(1, sizeof(cJSON), json_request_token);
     json_request_token->valuestring = token;
     active_session.last_connection = 0;
+    active_session.ruleset = &ruleset;
 
     will_return(__wrap_cJSON_GetObjectItemCaseSensitive, json_request_token);
 
@@ -5767,6 +5957,7 @@ void test_w_logtest_process_request_log_processing_rules_debug_false(void ** sta
 
     // get session
     cJSON * json_request_token;
+    w_logtest_ruleset_t ruleset = {0};
     w_logtest_session_t active_session;
     char * token = strdup("test_token");
     const time_t now = (time_t) 2020;
@@ -5774,6 +5965,7 @@ void test_w_logtest_process_request_log_processing_rules_debug_false(void ** sta
     os_calloc(1, sizeof(cJSON), json_request_token);
     json_request_token->valuestring = token;
     active_session.last_connection = 0;
+    active_session.ruleset = &ruleset;
 
     will_return(__wrap_cJSON_GetObjectItemCaseSensitive, json_request_token);
 
@@ -5980,6 +6172,7 @@ void test_w_logtest_process_request_log_processing_rules_debug_true(void ** stat
 
     // get session
     cJSON * json_request_token;
+    w_logtest_ruleset_t ruleset = {0};
     w_logtest_session_t active_session;
     char * token = strdup("test_token");
     const time_t now = (time_t) 2020;
@@ -5987,6 +6180,7 @@ void test_w_logtest_process_request_log_processing_rules_debug_true(void ** stat
     os_calloc(1, sizeof(cJSON), json_request_token);
     json_request_token->valuestring = token;
     active_session.last_connection = 0;
+    active_session.ruleset = &ruleset;
 
     will_return(__wrap_cJSON_GetObjectItemCaseSensitive, json_request_token);
 
@@ -6582,6 +6776,7 @@ int main(void)
         cmocka_unit_test(test_w_logtest_initialize_session_error_accumulate_init),
         cmocka_unit_test(test_w_logtest_initialize_session_success),
         cmocka_unit_test(test_w_logtest_initialize_session_success_duplicate_key),
+        cmocka_unit_test(test_w_logtest_initialize_session_success_shared_ruleset),
         // Tests w_logtest_generate_token
         cmocka_unit_test(test_w_logtest_generate_token_success),
         cmocka_unit_test(test_w_logtest_generate_token_success_empty_bytes),
@@ -0,0 +1,498 @@
+/*
+ * Copyright (C) 2015, Wazuh Inc.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "../../headers/shared.h"
+#include "../../logcollector/logcollector.h"
+#include "../../logcollector/gzip_stream.h"
+#include "../wrappers/common.h"
+#include "../wrappers/posix/time_wrappers.h"
+#include "../wrappers/wazuh/shared/debug_op_wrappers.h"
+
+#define SMALL_LINES     4
+#define LARGE_LINES     5000
+#define LARGE_LINE_LEN  64
+
+int w_gzip_stream_refill(w_gzip_stream_t * stream);
+size_t w_gzip_stream_budget(w_gzip_stream_t * stream, size_t size);
+ssize_t w_gzip_stream_read(void * cookie, char * buf, size_t size);
+int w_gzip_stream_seek(void * cookie, int64_t * offset, int whence);
+int w_gzip_stream_close(void * cookie);
+
+static const char * small_lines[SMALL_LINES] = {
+    "Oct 18 04:20:02 host sshd[101]: Accepted publickey for root\n",
+    "Oct 18 04:20:03 host sshd[101]: pam_unix(sshd:session): session opened\n",
+    "Oct 18 04:20:05 host sudo: root : TTY=pts/0 ; COMMAND=/bin/ls\n",
+    "Oct 18 04:20:09 host sshd[101]: Disconnected from user root\n"
+};
+
+// Auxiliar structs
+typedef struct test_gzip_s {
+    char small_path[PATH_MAX];  // Compressed SMALL_LINES
+    char large_path[PATH_MAX];  // Compressed content spanning several windows
+    char plain_path[PATH_MAX];  // Uncompressed SMALL_LINES
+    char * large;               // Decompressed content of large_path
+    size_t large_len;
+} test_gzip_t;
+
+/* auxiliar functions */
+
+static int write_gzip(char * path, const char * data, size_t len) {
+    int fd = mkstemp(path);
+    gzFile gz;
+
+    if (fd < 0) {
+        return -1;
+    }
+
+    if (gz = gzdopen(fd, "wb"), gz == NULL) {
+        close(fd);
+        return -1;
+    }
+
+    if (gzwrite(gz, data, len) != (int)len) {
+        gzclose(gz);
+        return -1;
+    }
+
+    return gzclose(gz) == Z_OK ? 0 : -1;
+}
+
+static void sha1_of(const char * data, size_t len, os_sha1 output) {
+    unsigned char md[SHA_DIGEST_LENGTH];
+    SHA_CTX context;
+
+    SHA1_Init(&context);
+    SHA1_Update(&context, data, len);
+    SHA1_Final(md, &context);
+    OS_SHA1_Hexdigest(md, output);
+}
+
+/* Allocate a stream as w_gzip_fopen() does, to call the callbacks directly */
+static w_gzip_stream_t * open_stream(const char * path) {
+    w_gzip_stream_t * stream;
+
+    os_calloc(1, sizeof(w_gzip_stream_t), stream);
+    stream->gz = gzopen(path, "rb");
+    os_malloc(GZIP_STREAM_HISTORY + GZIP_STREAM_CHUNK, stream->buffer);
+
+    return stream;
+}
+
+/* setup/teardown */
+
+static int group_setup(void ** state) {
+    test_gzip_t * data;
+    char small[OS_SIZE_1024] = "";
+    FILE * fp;
+    int i;
+
+    os_calloc(1, sizeof(test_gzip_t), data);
+
+    for (i = 0; i < SMALL_LINES; i++) {
+        strcat(small, small_lines[i]);
+    }
+
+    data->large_len = LARGE_LINES * LARGE_LINE_LEN;
+    os_malloc(data->large_len + 1, data->large);
+
+    for (i = 0; i < LARGE_LINES; i++) {
+        snprintf(data->large + i * LARGE_LINE_LEN, LARGE_LINE_LEN + 1, "line %05d: %-51s\n", i, "rotated archive content");
+    }
+
+    strcpy(data->small_path, "/tmp/test_gzip_stream_small-XXXXXX");
+    strcpy(data->large_path, "/tmp/test_gzip_stream_large-XXXXXX");
+    strcpy(data->plain_path, "/tmp/test_gzip_stream_plain-XXXXXX");
+
+    if (write_gzip(data->small_path, small, strlen(small)) < 0 ||
+        write_gzip(data->large_path, data->large, data->large_len) < 0) {
+        return -1;
+    }
+
+    int fd = mkstemp(data->plain_path);
+
+    if (fd < 0 || (fp = fdopen(fd, "w"), fp == NULL)) {
+        return -1;
+    }
+
+    fputs(small, fp);
+    fclose(fp);
+
+    gzip_max_rate = 0;
+    *state = data;
+    return 0;
+}
+
+static int group_teardown(void ** state) {
+    test_gzip_t * data = *state;
+
+    unlink(data->small_path);
+    unlink(data->large_path);
+    unlink(data->plain_path);
+    os_free(data->large);
+    os_free(data);
+
+    return 0;
+}
+
+/* tests */
+
+/* w_gzip_is_compressed_file */
+
+void test_w_gzip_is_compressed_file_gzip(void ** state) {
+    test_gzip_t * data = *state;
+
+    assert_true(w_gzip_is_compressed_file(data->small_path));
+}
+
+void test_w_gzip_is_compressed_file_plain(void ** state) {
+    test_gzip_t * data = *state;
+
+    assert_false(w_gzip_is_compressed_file(data->plain_path));
+}
+
+void test_w_gzip_is_compressed_file_missing(void ** state) {
+
+    assert_false(w_gzip_is_compressed_file("/tmp/test_gzip_stream-missing.gz"));
+}
+
+/* w_gzip_fopen */
+
+void test_w_gzip_fopen_missing(void ** state) {
+
+    assert_null(w_gzip_fopen("/tmp/test_gzip_stream-missing.gz"));
+}
+
+void test_w_gzip_fopen_read_lines(void ** state) {
+    test_gzip_t * data = *state;
+    char buffer[OS_SIZE_1024];
+    long offset = 0;
+    int i;
+
+    FILE * fp = w_gzip_fopen(data->small_path);
+    assert_non_null(fp);
+
+    for (i = 0; i < SMALL_LINES; i++) {
+        assert_non_null(fgets(buffer, sizeof(buffer), fp));
+        assert_string_equal(buffer, small_lines[i]);
+
+        offset += strlen(small_lines[i]);
+        assert_int_equal(ftell(fp), offset);
+    }
+
+    assert_null(fgets(buffer, sizeof(buffer), fp));
+    assert_true(feof(fp));
+
+    assert_int_equal(fclose(fp), 0);
+}
+
+void test_w_gzip_fopen_resume_offset(void ** state) {
+    test_gzip_t * data = *state;
+    char buffer[OS_SIZE_1024];
+    long offset = 3000 * LARGE_LINE_LEN;
+
+    FILE * fp = w_gzip_fopen(data->large_path);
+    assert_non_null(fp);
+
+    assert_int_equal(fseek(fp, offset, SEEK_SET), 0);
+    assert_int_equal(ftell(fp), offset);
+
+    assert_non_null(fgets(buffer, sizeof(buffer), fp));
+    assert_memory_equal(buffer, data->large + offset, LARGE_LINE_LEN);
+    assert_int_equal(ftell(fp), offset + LARGE_LINE_LEN);
+
+    assert_int_equal(fclose(fp), 0);
+}
+
+void test_w_gzip_fopen_seek_end(void ** state) {
+    test_gzip_t * data = *state;
+
+    FILE * fp = w_gzip_fopen(data->large_path);
+    assert_non_null(fp);
+
+    assert_int_equal(fseek(fp, 0, SEEK_END), 0);
+    assert_int_equal(ftell(fp), data->large_len);
+
+    assert_int_equal(fclose(fp), 0);
+}
+
+/* w_gzip_stream_refill */
+
+void test_w_gzip_stream_refill_keeps_history(void ** state) {
+    test_gzip_t * data = *state;
+    w_gzip_stream_t * stream = open_stream(data->large_path);
+
+    assert_int_equal(w_gzip_stream_refill(stream), GZIP_STREAM_CHUNK);
+    assert_int_equal(stream->base, 0);
+    assert_int_equal(stream->length, GZIP_STREAM_CHUNK);
+
+    assert_int_equal(w_gzip_stream_refill(stream), GZIP_STREAM_CHUNK);
+    assert_int_equal(w_gzip_stream_refill(stream), GZIP_STREAM_CHUNK);
+
+    /* Only GZIP_STREAM_HISTORY bytes of the previous data are kept */
+    assert_int_equal(stream->base, 3 * GZIP_STREAM_CHUNK - GZIP_STREAM_HISTORY - GZIP_STREAM_CHUNK);
+    assert_int_equal(stream->length, GZIP_STREAM_HISTORY + GZIP_STREAM_CHUNK);
+    assert_memory_equal(stream->buffer, data->large + stream->base, stream->length);
+
+    assert_int_equal(w_gzip_stream_close(stream), 0);
+}
+
+void test_w_gzip_stream_refill_eof(void ** state) {
+    test_gzip_t * data = *state;
+    w_gzip_stream_t * stream = open_stream(data->small_path);
+    size_t len = 0;
+    int i;
+
+    for (i = 0; i < SMALL_LINES; i++) {
+        len += strlen(small_lines[i]);
+    }
+
+    assert_int_equal(w_gzip_stream_refill(stream), len);
+    assert_int_equal(w_gzip_stream_refill(stream), 0);
+    assert_int_equal(stream->length, len);
+
+    assert_int_equal(w_gzip_stream_close(stream), 0);
+}
+
+/* w_gzip_stream_seek */
+
+void test_w_gzip_stream_seek_inside_window(void ** state) {
+    test_gzip_t * data = *state;
+    w_gzip_stream_t * stream = open_stream(data->large_path);
+    char buffer[LARGE_LINE_LEN];
+    int64_t offset;
+
+    assert_int_equal(w_gzip_stream_refill(stream), GZIP_STREAM_CHUNK);
+    assert_int_equal(w_gzip_stream_refill(stream), GZIP_STREAM_CHUNK);
+    assert_int_equal(w_gzip_stream_refill(stream), GZIP_STREAM_CHUNK);
+    stream->position = stream->base + stream->length;
+
+    /* Rewind to a line that is still in the window */
+    offset = stream->base + LARGE_LINE_LEN;
+    assert_int_equal(w_gzip_stream_seek(stream, &offset, SEEK_SET), 0);
+    assert_int_equal(offset, GZIP_STREAM_CHUNK + LARGE_LINE_LEN);
+    assert_int_equal(stream->position, offset);
+    assert_int_equal(stream->base, GZIP_STREAM_CHUNK);
+    assert_int_equal(stream->length, GZIP_STREAM_HISTORY + GZIP_STREAM_CHUNK);
+
+    offset = -LARGE_LINE_LEN;
+    assert_int_equal(w_gzip_stream_seek(stream, &offset, SEEK_CUR), 0);
+    assert_int_equal(offset, GZIP_STREAM_CHUNK);
+
+    assert_int_equal(w_gzip_stream_read(stream, buffer, sizeof(buffer)), sizeof(buffer));
+    assert_memory_equal(buffer, data->large + GZIP_STREAM_CHUNK, sizeof(buffer));
+    assert_int_equal(stream->base, GZIP_STREAM_CHUNK);
+
+    assert_int_equal(w_gzip_stream_close(stream), 0);
+}
+
+void test_w_gzip_stream_seek_behind_window(void ** state) {
+    test_gzip_t * data = *state;
+    w_gzip_stream_t * stream = open_stream(data->large_path);
+    char buffer[LARGE_LINE_LEN];
+    int64_t offset = LARGE_LINE_LEN;
+
+    assert_int_equal(w_gzip_stream_refill(stream), GZIP_STREAM_CHUNK);
+    assert_int_equal(w_gzip_stream_refill(stream), GZIP_STREAM_CHUNK);
+    assert_int_equal(w_gzip_stream_refill(stream), GZIP_STREAM_CHUNK);
+    stream->position = stream->base + stream->length;
+
+    expect_string(__wrap__mdebug2, formatted_msg, "Rewinding gzip stream to offset 64. The file will be decompressed again.");
+
+    assert_int_equal(w_gzip_stream_seek(stream, &offset, SEEK_SET), 0);
+    assert_int_equal(offset, LARGE_LINE_LEN);
+    assert_int_equal(stream->base, LARGE_LINE_LEN);
+    assert_int_equal(stream->length, 0);
+
+    assert_int_equal(w_gzip_stream_read(stream, buffer, sizeof(buffer)), sizeof(buffer));
+    assert_memory_equal(buffer, data->large + LARGE_LINE_LEN, sizeof(buffer));
+
+    assert_int_equal(w_gzip_stream_close(stream), 0);
+}
+
+void test_w_gzip_stream_seek_ahead_window(void ** state) {
+    test_gzip_t * data = *state;
+    w_gzip_stream_t * stream = open_stream(data->large_path);
+    char buffer[LARGE_LINE_LEN];
+    int64_t offset = 4000 * LARGE_LINE_LEN;
+
+    assert_int_equal(w_gzip_stream_refill(stream), GZIP_STREAM_CHUNK);
+
+    assert_int_equal(w_gzip_stream_seek(stream, &offset, SEEK_SET), 0);
+    assert_int_equal(offset, 4000 * LARGE_LINE_LEN);
+    assert_int_equal(stream->base, offset);
+    assert_int_equal(stream->length, 0);
+
+    assert_int_equal(w_gzip_stream_read(stream, buffer, sizeof(buffer)), sizeof(buffer));
+    assert_memory_equal(buffer, data->large + offset, sizeof(buffer));
+
+    assert_int_equal(w_gzip_stream_close(stream), 0);
+}
+
+void test_w_gzip_stream_seek_end(void ** state) {
+    test_gzip_t * data = *state;
+    w_gzip_stream_t * stream = open_stream(data->large_path);
+    char buffer[LARGE_LINE_LEN];
+    int64_t offset = -LARGE_LINE_LEN;
+
+    assert_int_equal(w_gzip_stream_seek(stream, &offset, SEEK_END), 0);
+    assert_int_equal(offset, data->large_len - LARGE_LINE_LEN);
+    assert_int_equal(stream->base + stream->length, data->large_len);
+
+    assert_int_equal(w_gzip_stream_read(stream, buffer, sizeof(buffer)), sizeof(buffer));
+    assert_memory_equal(buffer, data->large + offset, sizeof(buffer));
+    assert_int_equal(w_gzip_stream_read(stream, buffer, sizeof(buffer)), 0);
+
+    assert_int_equal(w_gzip_stream_close(stream), 0);
+}
+
+void test_w_gzip_stream_seek_invalid(void ** state) {
+    test_gzip_t * data = *state;
+    w_gzip_stream_t * stream = open_stream(data->small_path);
+    int64_t offset = 0;
+
+    errno = 0;
+    assert_int_equal(w_gzip_stream_seek(stream, &offset, 42), -1);
+    assert_int_equal(errno, EINVAL);
+
+    offset = -1;
+    errno = 0;
+    assert_int_equal(w_gzip_stream_seek(stream, &offset, SEEK_SET), -1);
+    assert_int_equal(errno, EINVAL);
+    assert_int_equal(stream->position, 0);
+
+    assert_int_equal(w_gzip_stream_close(stream), 0);
+}
+
+/* w_gzip_stream_read */
+
+void test_w_gzip_stream_read_no_rate(void ** state) {
+    test_gzip_t * data = *state;
+    w_gzip_stream_t * stream = open_stream(data->large_path);
+    char * buffer;
+
+    os_malloc(GZIP_STREAM_CHUNK, buffer);
+
+    assert_int_equal(w_gzip_stream_budget(stream, GZIP_STREAM_CHUNK), GZIP_STREAM_CHUNK);
+    assert_int_equal(w_gzip_stream_read(stream, buffer, GZIP_STREAM_CHUNK), GZIP_STREAM_CHUNK);
+    assert_memory_equal(buffer, data->large, GZIP_STREAM_CHUNK);
+    assert_int_equal(stream->position, GZIP_STREAM_CHUNK);
+
+    os_free(buffer);
+    assert_int_equal(w_gzip_stream_close(stream), 0);
+}
+
+void test_w_gzip_stream_read_rate_budget(void ** state) {
+    test_gzip_t * data = *state;
+    w_gzip_stream_t * stream = open_stream(data->large_path);
+    char buffer[OS_SIZE_4096];
+
+    gzip_max_rate = 1;
+
+    /* The first second delivers 1 KB */
+    will_return(__wrap_time, 1000);
+    assert_int_equal(w_gzip_stream_read(stream, buffer, sizeof(buffer)), 1024);
+    assert_memory_equal(buffer, data->large, 1024);
+
+    /* The budget is exhausted: the reader sees EOF */
+    will_return(__wrap_time, 1000);
+    assert_int_equal(w_gzip_stream_read(stream, buffer, sizeof(buffer)), 0);
+    assert_int_equal(stream->position, 1024);
+
+    /* The next second resumes where it stopped */
+    will_return(__wrap_time, 1001);
+    assert_int_equal(w_gzip_stream_read(stream, buffer, 512), 512);
+    assert_memory_equal(buffer, data->large + 1024, 512);
+
+    will_return(__wrap_time, 1001);
+    assert_int_equal(w_gzip_stream_read(stream, buffer, sizeof(buffer)), 512);
+    assert_memory_equal(buffer, data->large + 1536, 512);
+
+    gzip_max_rate = 0;
+    assert_int_equal(w_gzip_stream_close(stream), 0);
+}
+
+/* w_gzip_sha1_nbytes */
+
+void test_w_gzip_sha1_nbytes_missing(void ** state) {
+    SHA_CTX context;
+    os_sha1 output;
+
+    assert_int_equal(w_gzip_sha1_nbytes("/tmp/test_gzip_stream-missing.gz", &context, output, 10), -1);
+    assert_string_equal(output, "");
+}
+
+void test_w_gzip_sha1_nbytes_prefix(void ** state) {
+    test_gzip_t * data = *state;
+    int64_t offset = 3000 * LARGE_LINE_LEN;
+    unsigned char md[SHA_DIGEST_LENGTH];
+    SHA_CTX context;
+    os_sha1 output;
+    os_sha1 expected;
+
+    assert_int_equal(w_gzip_sha1_nbytes(data->large_path, &context, output, offset), 0);
+    sha1_of(data->large, offset, expected);
+    assert_string_equal(output, expected);
+
+    /* The context resumes the hash from the saved offset */
+    SHA1_Update(&context, data->large + offset, data->large_len - offset);
+    SHA1_Final(md, &context);
+    OS_SHA1_Hexdigest(md, output);
+    sha1_of(data->large, data->large_len, expected);
+    assert_string_equal(output, expected);
+}
+
+void test_w_gzip_sha1_nbytes_beyond_eof(void ** state) {
+    test_gzip_t * data = *state;
+    SHA_CTX context;
+    os_sha1 output;
+    os_sha1 expected;
+
+    assert_int_equal(w_gzip_sha1_nbytes(data->large_path, &context, output, data->large_len + 100), 0);
+    sha1_of(data->large, data->large_len, expected);
+    assert_string_equal(output, expected);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        // Tests w_gzip_is_compressed_file
+        cmocka_unit_test(test_w_gzip_is_compressed_file_gzip),
+        cmocka_unit_test(test_w_gzip_is_compressed_file_plain),
+        cmocka_unit_test(test_w_gzip_is_compressed_file_missing),
+        // Tests w_gzip_fopen
+        cmocka_unit_test(test_w_gzip_fopen_missing),
+        cmocka_unit_test(test_w_gzip_fopen_read_lines),
+        cmocka_unit_test(test_w_gzip_fopen_resume_offset),
+        cmocka_unit_test(test_w_gzip_fopen_seek_end),
+        // Tests w_gzip_stream_refill
+        cmocka_unit_test(test_w_gzip_stream_refill_keeps_history),
+        cmocka_unit_test(test_w_gzip_stream_refill_eof),
+        // Tests w_gzip_stream_seek
+        cmocka_unit_test(test_w_gzip_stream_seek_inside_window),
+        cmocka_unit_test(test_w_gzip_stream_seek_behind_window),
+        cmocka_unit_test(test_w_gzip_stream_seek_ahead_window),
+        cmocka_unit_test(test_w_gzip_stream_seek_end),
+        cmocka_unit_test(test_w_gzip_stream_seek_invalid),
+        // Tests w_gzip_stream_read
+        cmocka_unit_test(test_w_gzip_stream_read_no_rate),
+        cmocka_unit_test(test_w_gzip_stream_read_rate_budget),
+        // Tests w_gzip_sha1_nbytes
+        cmocka_unit_test(test_w_gzip_sha1_nbytes_missing),
+        cmocka_unit_test(test_w_gzip_sha1_nbytes_prefix),
+        cmocka_unit_test(test_w_gzip_sha1_nbytes_beyond_eof),
+    };
+
+    return cmocka_run_group_tests(tests, group_setup, group_teardown);
+}
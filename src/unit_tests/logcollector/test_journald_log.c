@@ -0,0 +1,339 @@
+/*
+ * Copyright (C) 2015, Wazuh Inc.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "../../logcollector/logcollector.h"
+#include "../../headers/shared.h"
+#include "../wrappers/common.h"
+#include "../wrappers/wazuh/logcollector/logcollector_wrappers.h"
+
+/* Defines */
+
+#define TESTING_MAXIMUM_LINES   1000
+
+/* Globals */
+
+extern w_journald_vault_t journald_vault;
+extern int maximum_lines;
+extern int sample_log_length;
+
+/* Fields of the current fake journal entry, as "FIELD=value" */
+static const char ** fake_entry;
+
+/* Fake sd-journal functions */
+
+static int fake_get_data(__attribute__((unused)) void * journal, const char * field, const void ** data, size_t * length) {
+    size_t field_len = strlen(field);
+
+    for (int i = 0; fake_entry != NULL && fake_entry[i] != NULL; i++) {
+        if (strncmp(fake_entry[i], field, field_len) == 0 && fake_entry[i][field_len] == '=') {
+            *data = fake_entry[i];
+            *length = strlen(fake_entry[i]);
+            return 0;
+        }
+    }
+
+    return -ENOENT;
+}
+
+static int fake_get_realtime_usec(__attribute__((unused)) void * journal, __attribute__((unused)) uint64_t * usec) {
+    return -EADDRNOTAVAIL;
+}
+
+static int fake_process(__attribute__((unused)) void * journal) {
+    return 0;
+}
+
+static int fake_next(__attribute__((unused)) void * journal) {
+    return mock_type(int);
+}
+
+static int fake_get_cursor(__attribute__((unused)) void * journal, char ** cursor) {
+    *cursor = strdup(mock_type(char *));
+    return 0;
+}
+
+/* setup/teardown */
+
+static int group_setup(void ** state) {
+    test_mode = 1;
+    maximum_lines = TESTING_MAXIMUM_LINES;
+    sample_log_length = 64;
+
+    journald_lib.get_data = fake_get_data;
+    journald_lib.get_realtime_usec = fake_get_realtime_usec;
+    journald_lib.process = fake_process;
+    journald_lib.next = fake_next;
+    journald_lib.get_cursor = fake_get_cursor;
+    return 0;
+}
+
+static int group_teardown(void ** state) {
+    test_mode = 0;
+    memset(&journald_lib, 0, sizeof(journald_lib));
+    return 0;
+}
+
+static int teardown_vault(void ** state) {
+    os_free(journald_vault.cursor);
+    fake_entry = NULL;
+    return 0;
+}
+
+/* wraps */
+
+int __wrap_w_msg_hash_queues_push(const char * str, char * file, unsigned long size,
+                                  __attribute__((unused)) logtarget * targets,
+                                  __attribute__((unused)) char queue_mq) {
+    check_expected(str);
+    check_expected(file);
+    check_expected(size);
+    return mock_type(int);
+}
+
+/* tests */
+
+/* w_journald_format_entry */
+
+void test_w_journald_format_entry_complete(void ** state) {
+    const char * entry[] = { "MESSAGE=Accepted publickey for root", "_HOSTNAME=ubuntu", "SYSLOG_IDENTIFIER=sshd",
+                             "_COMM=sshd", "_PID=4321", NULL };
+    char buffer[OS_MAXSTR];
+    fake_entry = entry;
+
+    size_t size = w_journald_format_entry(NULL, buffer, sizeof(buffer));
+
+    assert_string_equal(buffer, " ubuntu sshd[4321]: Accepted publickey for root");
+    assert_int_equal(size, strlen(buffer));
+}
+
+void test_w_journald_format_entry_no_pid(void ** state) {
+    const char * entry[] = { "MESSAGE=Started Daily apt upgrade", "_HOSTNAME=ubuntu", "_COMM=systemd", NULL };
+    char buffer[OS_MAXSTR];
+    fake_entry = entry;
+
+    size_t size = w_journald_format_entry(NULL, buffer, sizeof(buffer));
+
+    assert_string_equal(buffer, " ubuntu systemd: Started Daily apt upgrade");
+    assert_int_equal(size, strlen(buffer));
+}
+
+void test_w_journald_format_entry_no_message(void ** state) {
+    const char * entry[] = { "_HOSTNAME=ubuntu", "SYSLOG_IDENTIFIER=kernel", NULL };
+    char buffer[OS_MAXSTR];
+    fake_entry = entry;
+
+    assert_int_equal(w_journald_format_entry(NULL, buffer, sizeof(buffer)), 0);
+}
+
+void test_w_journald_format_entry_truncated(void ** state) {
+    const char * entry[] = { "MESSAGE=0123456789", "_HOSTNAME=host", "SYSLOG_IDENTIFIER=id", NULL };
+    char buffer[16];
+    fake_entry = entry;
+
+    size_t size = w_journald_format_entry(NULL, buffer, sizeof(buffer));
+
+    assert_int_equal(size, sizeof(buffer) - 1);
+    assert_string_equal(buffer, " host id: 01234");
+}
+
+/* w_journald_set_cursor / w_journald_get_cursor */
+
+void test_w_journald_cursor_empty(void ** state) {
+    assert_null(w_journald_get_cursor());
+}
+
+void test_w_journald_cursor_set_get(void ** state) {
+    w_journald_set_cursor("s=abc;i=1");
+    w_journald_set_cursor("s=abc;i=2");
+
+    char * cursor = w_journald_get_cursor();
+    assert_string_equal(cursor, "s=abc;i=2");
+    os_free(cursor);
+}
+
+/* w_journald_get_status_as_JSON / w_journald_set_status_from_JSON */
+
+void test_w_journald_get_status_as_JSON_no_cursor(void ** state) {
+    assert_null(w_journald_get_status_as_JSON());
+}
+
+void test_w_journald_status_JSON_roundtrip(void ** state) {
+    w_journald_set_cursor("s=abc;i=2a");
+
+    cJSON * status = w_journald_get_status_as_JSON();
+    assert_non_null(status);
+    assert_string_equal(cJSON_GetStringValue(cJSON_GetObjectItem(status, "cursor")), "s=abc;i=2a");
+
+    cJSON * global_json = cJSON_CreateObject();
+    cJSON_AddItemToObject(global_json, "journald", status);
+    os_free(journald_vault.cursor);
+
+    w_journald_set_status_from_JSON(global_json);
+    assert_string_equal(journald_vault.cursor, "s=abc;i=2a");
+
+    cJSON_Delete(global_json);
+}
+
+void test_w_journald_set_status_from_JSON_missing(void ** state) {
+    cJSON * global_json = cJSON_Parse("{\"macos\":{\"timestamp\":\"2021-04-27 08:07:20-0700\"}}");
+
+    w_journald_set_status_from_JSON(global_json);
+    assert_null(journald_vault.cursor);
+
+    cJSON_Delete(global_json);
+}
+
+/* read_journald */
+
+void test_read_journald_no_journal(void ** state) {
+    logreader lf = { .journald_log = NULL };
+    w_journald_config_t journald_log = { .journal = NULL };
+    int rc = 1;
+
+    lf.journald_log = &journald_log;
+
+    assert_null(read_journald(&lf, &rc, 0));
+    assert_int_equal(rc, 0);
+}
+
+void test_read_journald_no_entries(void ** state) {
+    logreader lf = { .journald_log = NULL };
+    w_journald_config_t journald_log = { .journal = (void *) 1 };
+    int rc;
+
+    lf.journald_log = &journald_log;
+
+    will_return(__wrap_can_read, 1);
+    will_return(fake_next, 0);
+
+    assert_null(read_journald(&lf, &rc, 0));
+    assert_null(journald_vault.cursor);
+}
+
+void test_read_journald_read_error(void ** state) {
+    logreader lf = { .journald_log = NULL };
+    w_journald_config_t journald_log = { .journal = (void *) 1 };
+    int rc;
+
+    lf.journald_log = &journald_log;
+
+    will_return(__wrap_can_read, 1);
+    will_return(fake_next, -EBADMSG);
+    expect_string(__wrap__merror, formatted_msg, "(1977): Unable to read the systemd journal: Bad message (74).");
+
+    assert_null(read_journald(&lf, &rc, 0));
+    assert_null(journald_vault.cursor);
+}
+
+void test_read_journald_entries(void ** state) {
+    const char * entry[] = { "MESSAGE=hello", "_HOSTNAME=host", "SYSLOG_IDENTIFIER=app", "_PID=7", NULL };
+    const char * expected = " host app[7]: hello";
+    logreader lf = { .journald_log = NULL };
+    w_journald_config_t journald_log = { .journal = (void *) 1 };
+    int rc;
+
+    lf.journald_log = &journald_log;
+    fake_entry = entry;
+
+    for (int i = 0; i < 2; i++) {
+        will_return(__wrap_can_read, 1);
+        will_return(fake_next, 1);
+        expect_string(__wrap__mdebug2, formatted_msg, "Reading journal message: ' host app[7]: hello'");
+        expect_string(__wrap_w_msg_hash_queues_push, str, expected);
+        expect_string(__wrap_w_msg_hash_queues_push, file, "journald");
+        expect_value(__wrap_w_msg_hash_queues_push, size, strlen(expected) + 1);
+        will_return(__wrap_w_msg_hash_queues_push, 0);
+    }
+
+    will_return(__wrap_can_read, 1);
+    will_return(fake_next, 0);
+
+    will_return(fake_get_cursor, "s=abc;i=3");
+
+    assert_null(read_journald(&lf, &rc, 0));
+    assert_string_equal(journald_vault.cursor, "s=abc;i=3");
+}
+
+void test_read_journald_maximum_lines(void ** state) {
+    const char * entry[] = { "MESSAGE=hello", "_HOSTNAME=host", "SYSLOG_IDENTIFIER=app", NULL };
+    logreader lf = { .journald_log = NULL };
+    w_journald_config_t journald_log = { .journal = (void *) 1 };
+    int rc;
+
+    lf.journald_log = &journald_log;
+    fake_entry = entry;
+    maximum_lines = 1;
+
+    will_return(__wrap_can_read, 1);
+    will_return(fake_next, 1);
+    expect_string(__wrap__mdebug2, formatted_msg, "Reading journal message: ' host app: hello'");
+    expect_any(__wrap_w_msg_hash_queues_push, str);
+    expect_any(__wrap_w_msg_hash_queues_push, file);
+    expect_any(__wrap_w_msg_hash_queues_push, size);
+    will_return(__wrap_w_msg_hash_queues_push, 0);
+
+    will_return(fake_get_cursor, "s=abc;i=4");
+
+    assert_null(read_journald(&lf, &rc, 0));
+    assert_string_equal(journald_vault.cursor, "s=abc;i=4");
+
+    maximum_lines = TESTING_MAXIMUM_LINES;
+}
+
+void test_read_journald_drop_it(void ** state) {
+    const char * entry[] = { "MESSAGE=hello", NULL };
+    logreader lf = { .journald_log = NULL };
+    w_journald_config_t journald_log = { .journal = (void *) 1 };
+    int rc;
+
+    lf.journald_log = &journald_log;
+    fake_entry = entry;
+
+    will_return(__wrap_can_read, 1);
+    will_return(fake_next, 1);
+    will_return(__wrap_can_read, 0);
+
+    will_return(fake_get_cursor, "s=abc;i=5");
+
+    assert_null(read_journald(&lf, &rc, 1));
+    assert_string_equal(journald_vault.cursor, "s=abc;i=5");
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        // Test w_journald_format_entry
+        cmocka_unit_test_teardown(test_w_journald_format_entry_complete, teardown_vault),
+        cmocka_unit_test_teardown(test_w_journald_format_entry_no_pid, teardown_vault),
+        cmocka_unit_test_teardown(test_w_journald_format_entry_no_message, teardown_vault),
+        cmocka_unit_test_teardown(test_w_journald_format_entry_truncated, teardown_vault),
+        // Test w_journald_set_cursor / w_journald_get_cursor
+        cmocka_unit_test_teardown(test_w_journald_cursor_empty, teardown_vault),
+        cmocka_unit_test_teardown(test_w_journald_cursor_set_get, teardown_vault),
+        // Test w_journald_get_status_as_JSON / w_journald_set_status_from_JSON
+        cmocka_unit_test_teardown(test_w_journald_get_status_as_JSON_no_cursor, teardown_vault),
+        cmocka_unit_test_teardown(test_w_journald_status_JSON_roundtrip, teardown_vault),
+        cmocka_unit_test_teardown(test_w_journald_set_status_from_JSON_missing, teardown_vault),
+        // Test read_journald
+        cmocka_unit_test_teardown(test_read_journald_no_journal, teardown_vault),
+        cmocka_unit_test_teardown(test_read_journald_no_entries, teardown_vault),
+        cmocka_unit_test_teardown(test_read_journald_read_error, teardown_vault),
+        cmocka_unit_test_teardown(test_read_journald_entries, teardown_vault),
+        cmocka_unit_test_teardown(test_read_journald_maximum_lines, teardown_vault),
+        cmocka_unit_test_teardown(test_read_journald_drop_it, teardown_vault),
+    };
+
+    return cmocka_run_group_tests(tests, group_setup, group_teardown);
+}
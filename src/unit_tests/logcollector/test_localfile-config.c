@@ -24,6 +24,9 @@ unsigned int w_get_attr_timeout(xml_node * node);
 w_multiline_replace_type_t w_get_attr_replace(xml_node * node);
 w_multiline_match_type_t w_get_attr_match(xml_node * node);
 int w_logcollector_get_macos_log_type(const char * content);
+char * w_multiline_get_start_prefix(const char * pattern, bool * literal_only);
+w_multiline_config_t * w_multiline_config_clone(const w_multiline_config_t * ml_cfg);
+void w_multiline_config_free(w_multiline_config_t ** ml_cfg);
 
 /* setup/teardown */
 
@@ -345,6 +348,153 @@ void test_w_get_attr_match_end(void ** state) {
     assert_int_equal(expect_retval, retval);
 }
 
+/*  w_multiline_get_start_prefix  */
+void test_w_multiline_get_start_prefix_not_anchored(void ** state) {
+
+    bool literal_only = true;
+
+    assert_null(w_multiline_get_start_prefix("Date: \\d+", &literal_only));
+    assert_false(literal_only);
+}
+
+void test_w_multiline_get_start_prefix_alternation(void ** state) {
+
+    bool literal_only = true;
+
+    assert_null(w_multiline_get_start_prefix("^Date|^Time", &literal_only));
+    assert_false(literal_only);
+}
+
+void test_w_multiline_get_start_prefix_no_literal(void ** state) {
+
+    bool literal_only = true;
+
+    assert_null(w_multiline_get_start_prefix("^\\d{4}-\\d{2}", &literal_only));
+    assert_false(literal_only);
+}
+
+void test_w_multiline_get_start_prefix_literal_only(void ** state) {
+
+    bool literal_only = false;
+    char * prefix = w_multiline_get_start_prefix("^\\[Date\\]", &literal_only);
+
+    assert_string_equal(prefix, "[Date]");
+    assert_true(literal_only);
+    os_free(prefix);
+}
+
+void test_w_multiline_get_start_prefix_stop_metachar(void ** state) {
+
+    bool literal_only = true;
+    char * prefix = w_multiline_get_start_prefix("^Date: \\d+", &literal_only);
+
+    assert_string_equal(prefix, "Date: ");
+    assert_false(literal_only);
+    os_free(prefix);
+}
+
+void test_w_multiline_get_start_prefix_quantifier(void ** state) {
+
+    bool literal_only = true;
+    char * prefix = w_multiline_get_start_prefix("^Dates?", &literal_only);
+
+    assert_string_equal(prefix, "Date");
+    assert_false(literal_only);
+    os_free(prefix);
+
+    prefix = w_multiline_get_start_prefix("^Date+s", &literal_only);
+
+    assert_string_equal(prefix, "Date");
+    assert_false(literal_only);
+    os_free(prefix);
+}
+
+/* w_multiline_config_clone */
+
+void test_w_multiline_config_clone_NULL(void ** state) {
+
+    assert_null(w_multiline_config_clone(NULL));
+}
+
+void test_w_multiline_config_clone_empty_state(void ** state) {
+
+    w_multiline_config_t * ml_cfg = NULL;
+    w_multiline_config_t * clone = NULL;
+
+    os_calloc(1, sizeof(w_multiline_config_t), ml_cfg);
+    w_calloc_expression_t(&ml_cfg->regex, EXP_TYPE_PCRE2);
+    assert_true(w_expression_compile(ml_cfg->regex, "^\\[Date\\]", 0));
+    ml_cfg->match_type = ML_MATCH_END;
+    ml_cfg->replace_type = ML_REPLACE_TAB;
+    ml_cfg->timeout = 10;
+    ml_cfg->match_data = w_expression_create_match_data(ml_cfg->regex);
+    ml_cfg->start_prefix = w_multiline_get_start_prefix("^\\[Date\\]", &ml_cfg->start_prefix_only);
+    ml_cfg->start_prefix_len = strlen(ml_cfg->start_prefix);
+
+    /* Reading state of the file that was matched first */
+    ml_cfg->offset_last_read = 100;
+    os_strdup("[Date] next log", ml_cfg->pending_line);
+    os_strdup("[Date] log\n", ml_cfg->raw_data);
+    ml_cfg->raw_len = strlen(ml_cfg->raw_data);
+    ml_cfg->raw_size = ml_cfg->raw_len + 1;
+
+    clone = w_multiline_config_clone(ml_cfg);
+
+    assert_non_null(clone);
+    assert_ptr_not_equal(clone->regex, ml_cfg->regex);
+    assert_string_equal(w_expression_get_regex_pattern(clone->regex), "^\\[Date\\]");
+    assert_non_null(clone->match_data);
+    assert_ptr_not_equal(clone->match_data, ml_cfg->match_data);
+    assert_int_equal(clone->match_type, ML_MATCH_END);
+    assert_int_equal(clone->replace_type, ML_REPLACE_TAB);
+    assert_int_equal(clone->timeout, 10);
+    assert_string_equal(clone->start_prefix, "[Date]");
+    assert_ptr_not_equal(clone->start_prefix, ml_cfg->start_prefix);
+    assert_int_equal(clone->start_prefix_len, 6);
+    assert_true(clone->start_prefix_only);
+
+    assert_null(clone->ctxt);
+    assert_int_equal(clone->offset_last_read, 0);
+    assert_null(clone->pending_line);
+    assert_null(clone->raw_data);
+    assert_int_equal(clone->raw_len, 0);
+    assert_int_equal(clone->raw_size, 0);
+
+    w_multiline_config_free(&clone);
+    assert_null(clone);
+    w_multiline_config_free(&ml_cfg);
+    assert_null(ml_cfg);
+}
+
+/* w_multiline_config_free */
+
+void test_w_multiline_config_free_NULL(void ** state) {
+
+    w_multiline_config_t * ml_cfg = NULL;
+
+    w_multiline_config_free(NULL);
+    w_multiline_config_free(&ml_cfg);
+    assert_null(ml_cfg);
+}
+
+void test_w_multiline_config_free_reading_state(void ** state) {
+
+    w_multiline_config_t * ml_cfg = NULL;
+
+    os_calloc(1, sizeof(w_multiline_config_t), ml_cfg);
+    w_calloc_expression_t(&ml_cfg->regex, EXP_TYPE_PCRE2);
+    assert_true(w_expression_compile(ml_cfg->regex, "^Date", 0));
+    ml_cfg->match_data = w_expression_create_match_data(ml_cfg->regex);
+
+    os_calloc(1, sizeof(w_multiline_ctxt_t), ml_cfg->ctxt);
+    os_strdup("Date partial log", ml_cfg->ctxt->buffer);
+    os_strdup("Date next log", ml_cfg->pending_line);
+    os_strdup("Date log\n", ml_cfg->raw_data);
+
+    w_multiline_config_free(&ml_cfg);
+    assert_null(ml_cfg);
+}
+
 /*  w_logcollector_get_macos_log_type  */
 void test_w_logcollector_get_macos_log_type_content_NULL(void ** state) {
     const char * content = NULL;
@@ -451,6 +601,19 @@ int main(void) {
         cmocka_unit_test(test_w_get_attr_match_all),
         cmocka_unit_test(test_w_get_attr_match_end),
         cmocka_unit_test(test_w_get_attr_match_invalid),
+        // Tests w_multiline_get_start_prefix
+        cmocka_unit_test(test_w_multiline_get_start_prefix_not_anchored),
+        cmocka_unit_test(test_w_multiline_get_start_prefix_alternation),
+        cmocka_unit_test(test_w_multiline_get_start_prefix_no_literal),
+        cmocka_unit_test(test_w_multiline_get_start_prefix_literal_only),
+        cmocka_unit_test(test_w_multiline_get_start_prefix_stop_metachar),
+        cmocka_unit_test(test_w_multiline_get_start_prefix_quantifier),
+        // Tests w_multiline_config_clone
+        cmocka_unit_test(test_w_multiline_config_clone_NULL),
+        cmocka_unit_test(test_w_multiline_config_clone_empty_state),
+        // Tests w_multiline_config_free
+        cmocka_unit_test(test_w_multiline_config_free_NULL),
+        cmocka_unit_test(test_w_multiline_config_free_reading_state),
         // Tests w_logcollector_get_macos_log_type
         cmocka_unit_test(test_w_logcollector_get_macos_log_type_content_NULL),
         cmocka_unit_test(test_w_logcollector_get_macos_log_type_content_empty),
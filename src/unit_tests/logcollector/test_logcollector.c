@@ -40,6 +40,7 @@ void w_save_file_status();
 void w_load_files_status(cJSON *global_json);
 void w_initialize_file_status();
 int w_update_hash_node(char * path, int64_t pos);
+int w_update_hash_node_ex(char * path, int64_t pos, bool compressed);
 int w_set_to_last_line_read(logreader *lf);
 
 // Auxiliar structs
@@ -50,6 +51,10 @@ typedef struct test_logcollector_s {
     OSHashNode *node;
 } test_logcollector_t;
 
+// Content of the gzip-compressed file created by setup_gzip_file
+static const char gzip_content[] = "line 1\nline 2\nline 3\n";
+static char gzip_path[PATH_MAX];
+
 extern w_macos_log_vault_t macos_log_vault;
 extern w_macos_log_procceses_t * macos_processes;
 static wfd_t * stream_backup;
@@ -150,6 +155,35 @@ static int teardown_process(void **state) {
     return 0;
 }
 
+static int setup_gzip_file(void **state) {
+    gzFile gz;
+    int fd;
+
+    if (setup_local_hashmap(state) != 0) {
+        return 1;
+    }
+
+    strcpy(gzip_path, "/tmp/test_logcollector-XXXXXX");
+
+    if (fd = mkstemp(gzip_path), fd < 0) {
+        return 1;
+    }
+
+    if (gz = gzdopen(fd, "wb"), gz == NULL) {
+        close(fd);
+        return 1;
+    }
+
+    gzwrite(gz, gzip_content, strlen(gzip_content));
+
+    return gzclose(gz) == Z_OK ? 0 : 1;
+}
+
+static int teardown_gzip_file(void **state) {
+    unlink(gzip_path);
+    return teardown_local_hashmap(state);
+}
+
 /* wraps */
 
 /* tests */
@@ -231,6 +265,27 @@ void test_w_get_hash_context_done(void ** state) {
     assert_false(ret);
 }
 
+void test_w_get_hash_context_compressed(void ** state) {
+    SHA_CTX context;
+    unsigned char md[SHA_DIGEST_LENGTH];
+    os_sha1 output;
+    os_sha1 expected;
+    logreader lf = {.file = gzip_path, .compressed = true};
+
+    expect_any(__wrap_OSHash_Get_ex, self);
+    expect_string(__wrap_OSHash_Get_ex, key, gzip_path);
+    will_return(__wrap_OSHash_Get_ex, NULL);
+
+    bool ret = w_get_hash_context(&lf, &context, 7);
+
+    assert_true(ret);
+
+    SHA1_Final(md, &context);
+    OS_SHA1_Hexdigest(md, output);
+    OS_SHA1_Str("line 1\n", 7, expected);
+    assert_string_equal(output, expected);
+}
+
 /* w_update_file_status */
 void test_w_update_file_status_fail_update_add_table_hash(void ** state) {
     char * path = "test/test.log";
@@ -277,8 +332,10 @@ void test_w_update_file_status_update_fail_add_OK(void ** state) {
 void test_w_update_file_status_update_OK(void ** state) {
     char * path = "test/test.log";
 
+    expect_function_call(__wrap_pthread_rwlock_rdlock);
     expect_function_call(__wrap_pthread_rwlock_wrlock);
     expect_function_call(__wrap_pthread_rwlock_unlock);
+    expect_function_call(__wrap_pthread_rwlock_unlock);
 
     __real_OSHash_Add_ex(mock_hashmap, path, strdup("data_to_replace"));
 
@@ -364,7 +421,7 @@ void test_w_set_to_pos_OK(void ** state) {
 void test_w_save_files_status_to_cJSON_begin_NULL(void ** state) {
     OSHashNode *hash_node = NULL;
 
-    expect_function_call(__wrap_pthread_rwlock_rdlock);
+    expect_function_call(__wrap_pthread_rwlock_wrlock);
     expect_value(__wrap_OSHash_Begin, self, files_status);
     will_return(__wrap_OSHash_Begin, hash_node);
     expect_function_call(__wrap_pthread_rwlock_unlock);
@@ -378,6 +435,9 @@ void test_w_save_files_status_to_cJSON_begin_NULL(void ** state) {
     expect_function_call(__wrap_pthread_rwlock_rdlock);
     expect_function_call(__wrap_pthread_rwlock_unlock);
 
+    expect_function_call(__wrap_pthread_rwlock_rdlock);
+    expect_function_call(__wrap_pthread_rwlock_unlock);
+
     char * ret = w_save_files_status_to_cJSON();
     assert_null(ret);
 }
@@ -394,7 +454,7 @@ void test_w_save_files_status_to_cJSON_OK(void ** state) {
     hash_node->key = "test";
     hash_node->data = data;
 
-    expect_function_call(__wrap_pthread_rwlock_rdlock);
+    expect_function_call(__wrap_pthread_rwlock_wrlock);
     strcpy(macos_log_vault.timestamp,"hi 123");
     macos_log_vault.settings = "my settings";
 
@@ -437,6 +497,9 @@ void test_w_save_files_status_to_cJSON_OK(void ** state) {
     expect_function_call(__wrap_pthread_rwlock_rdlock);
     expect_function_call(__wrap_pthread_rwlock_unlock);
 
+    expect_function_call(__wrap_pthread_rwlock_rdlock);
+    expect_function_call(__wrap_pthread_rwlock_unlock);
+
     will_return(__wrap_cJSON_PrintUnformatted, "test_1234");
 
     expect_function_call(__wrap_cJSON_Delete);
@@ -454,7 +517,7 @@ void test_w_save_files_status_to_cJSON_macos_invalid_vault(void ** state) {
     strcpy(macos_log_vault.timestamp,"any timestamp");
     macos_log_vault.settings = "my settings";
 
-    expect_function_call(__wrap_pthread_rwlock_rdlock);
+    expect_function_call(__wrap_pthread_rwlock_wrlock);
 
     expect_value(__wrap_OSHash_Begin, self, files_status);
     will_return(__wrap_OSHash_Begin, hash_node);
@@ -470,6 +533,9 @@ void test_w_save_files_status_to_cJSON_macos_invalid_vault(void ** state) {
     expect_function_call(__wrap_pthread_rwlock_rdlock);
     expect_function_call(__wrap_pthread_rwlock_unlock);
 
+    expect_function_call(__wrap_pthread_rwlock_rdlock);
+    expect_function_call(__wrap_pthread_rwlock_unlock);
+
     char * ret = w_save_files_status_to_cJSON();
     assert_null(ret);
 
@@ -485,7 +551,7 @@ void test_w_save_files_status_to_cJSON_macos_valid_vault(void ** state) {
     strcpy(macos_log_vault.timestamp,"2021-04-27 08:07:20-0700");
     macos_log_vault.settings = "/usr/bin/log stream --style syslog";
 
-    expect_function_call(__wrap_pthread_rwlock_rdlock);
+    expect_function_call(__wrap_pthread_rwlock_wrlock);
 
     expect_value(__wrap_OSHash_Begin, self, files_status);
     will_return(__wrap_OSHash_Begin, hash_node);
@@ -501,6 +567,9 @@ void test_w_save_files_status_to_cJSON_macos_valid_vault(void ** state) {
     expect_function_call(__wrap_pthread_rwlock_rdlock);
     expect_function_call(__wrap_pthread_rwlock_unlock);
 
+    expect_function_call(__wrap_pthread_rwlock_rdlock);
+    expect_function_call(__wrap_pthread_rwlock_unlock);
+
     will_return(__wrap_cJSON_CreateObject, (cJSON *) 1);
 
     expect_string(__wrap_cJSON_CreateString, string, "2021-04-27 08:07:20-0700");
@@ -539,7 +608,7 @@ void test_w_save_files_status_invalid_vault(void ** state) {
 
     OSHashNode *hash_node = NULL;
 
-    expect_function_call(__wrap_pthread_rwlock_rdlock);
+    expect_function_call(__wrap_pthread_rwlock_wrlock);
     expect_value(__wrap_OSHash_Begin, self, files_status);
     will_return(__wrap_OSHash_Begin, hash_node);
     expect_function_call(__wrap_pthread_rwlock_unlock);
@@ -547,6 +616,9 @@ void test_w_save_files_status_invalid_vault(void ** state) {
     expect_function_call(__wrap_pthread_rwlock_rdlock);
     expect_function_call(__wrap_pthread_rwlock_unlock);
 
+    expect_function_call(__wrap_pthread_rwlock_rdlock);
+    expect_function_call(__wrap_pthread_rwlock_unlock);
+
     char * ret = w_save_files_status_to_cJSON();
     assert_null(ret);
     assert_false(macos_log_vault.is_valid_data);
@@ -572,7 +644,7 @@ void test_w_save_files_status_to_cJSON_data(void ** state) {
     strcpy(macos_log_vault.timestamp,"2021-04-27 08:07:20-0700");
     macos_log_vault.settings = "/usr/bin/log stream --style syslog";
 
-    expect_function_call(__wrap_pthread_rwlock_rdlock);
+    expect_function_call(__wrap_pthread_rwlock_wrlock);
 
     expect_value(__wrap_OSHash_Begin, self, files_status);
     will_return(__wrap_OSHash_Begin, hash_node);
@@ -613,6 +685,9 @@ void test_w_save_files_status_to_cJSON_data(void ** state) {
     expect_function_call(__wrap_pthread_rwlock_rdlock);
     expect_function_call(__wrap_pthread_rwlock_unlock);
 
+    expect_function_call(__wrap_pthread_rwlock_rdlock);
+    expect_function_call(__wrap_pthread_rwlock_unlock);
+
     will_return(__wrap_cJSON_CreateObject, (cJSON *) 1);
 
     expect_string(__wrap_cJSON_CreateString, string, "2021-04-27 08:07:20-0700");
@@ -650,7 +725,7 @@ void test_w_save_file_status_str_NULL(void ** state) {
     strcpy(macos_log_vault.timestamp,"any timestamp");
     macos_log_vault.settings = "my settings";
 
-    expect_function_call(__wrap_pthread_rwlock_rdlock);
+    expect_function_call(__wrap_pthread_rwlock_wrlock);
     expect_value(__wrap_OSHash_Begin, self, files_status);
     will_return(__wrap_OSHash_Begin, hash_node);
     expect_function_call(__wrap_pthread_rwlock_unlock);
@@ -664,6 +739,9 @@ void test_w_save_file_status_str_NULL(void ** state) {
     expect_function_call(__wrap_pthread_rwlock_rdlock);
     expect_function_call(__wrap_pthread_rwlock_unlock);
 
+    expect_function_call(__wrap_pthread_rwlock_rdlock);
+    expect_function_call(__wrap_pthread_rwlock_unlock);
+
     w_save_file_status();
 
 }
@@ -681,7 +759,7 @@ void test_w_save_file_status_wfopen_error(void ** state) {
     hash_node->key = "test";
     hash_node->data = data;
 
-    expect_function_call(__wrap_pthread_rwlock_rdlock);
+    expect_function_call(__wrap_pthread_rwlock_wrlock);
     strcpy(macos_log_vault.timestamp,"hi 123");
     macos_log_vault.settings = "my settings";
 
@@ -723,6 +801,9 @@ void test_w_save_file_status_wfopen_error(void ** state) {
     expect_function_call(__wrap_pthread_rwlock_rdlock);
     expect_function_call(__wrap_pthread_rwlock_unlock);
 
+    expect_function_call(__wrap_pthread_rwlock_rdlock);
+    expect_function_call(__wrap_pthread_rwlock_unlock);
+
     will_return(__wrap_cJSON_PrintUnformatted, "test_1234");
 
     expect_function_call(__wrap_cJSON_Delete);
@@ -747,7 +828,7 @@ void test_w_save_file_status_fwrite_error(void ** state) {
     hash_node->key = "test";
     hash_node->data = data;
 
-    expect_function_call(__wrap_pthread_rwlock_rdlock);
+    expect_function_call(__wrap_pthread_rwlock_wrlock);
     strcpy(macos_log_vault.timestamp,"hi 123");
     macos_log_vault.settings = "my settings";
 
@@ -790,6 +871,9 @@ void test_w_save_file_status_fwrite_error(void ** state) {
     expect_function_call(__wrap_pthread_rwlock_rdlock);
     expect_function_call(__wrap_pthread_rwlock_unlock);
 
+    expect_function_call(__wrap_pthread_rwlock_rdlock);
+    expect_function_call(__wrap_pthread_rwlock_unlock);
+
     will_return(__wrap_cJSON_PrintUnformatted, strdup("test_1234"));
 
     expect_function_call(__wrap_cJSON_Delete);
@@ -823,7 +907,7 @@ void test_w_save_file_status_OK(void ** state) {
     hash_node->key = "test";
     hash_node->data = data;
 
-    expect_function_call(__wrap_pthread_rwlock_rdlock);
+    expect_function_call(__wrap_pthread_rwlock_wrlock);
     strcpy(macos_log_vault.timestamp,"hi 123");
     macos_log_vault.settings = "my settings";
 
@@ -865,6 +949,9 @@ void test_w_save_file_status_OK(void ** state) {
     expect_function_call(__wrap_pthread_rwlock_rdlock);
     expect_function_call(__wrap_pthread_rwlock_unlock);
 
+    expect_function_call(__wrap_pthread_rwlock_rdlock);
+    expect_function_call(__wrap_pthread_rwlock_unlock);
+
     will_return(__wrap_cJSON_PrintUnformatted, strdup("test_1234"));
 
     expect_function_call(__wrap_cJSON_Delete);
@@ -903,6 +990,12 @@ void test_w_load_files_status_empty_array(void ** state) {
 
     will_return(__wrap_cJSON_GetStringValue, NULL);
 
+    will_return(__wrap_cJSON_GetObjectItem, NULL);
+
+    will_return(__wrap_cJSON_GetObjectItem, NULL);
+
+    will_return(__wrap_cJSON_GetStringValue, NULL);
+
     w_load_files_status(global_json);
 
 }
@@ -931,6 +1024,12 @@ void test_w_load_files_status_path_NULL(void ** state) {
 
     will_return(__wrap_cJSON_GetStringValue, NULL);
 
+    will_return(__wrap_cJSON_GetObjectItem, NULL);
+
+    will_return(__wrap_cJSON_GetObjectItem, NULL);
+
+    will_return(__wrap_cJSON_GetStringValue, NULL);
+
     w_load_files_status(global_json);
 
 }
@@ -961,6 +1060,12 @@ void test_w_load_files_status_path_str_NULL(void ** state) {
 
     will_return(__wrap_cJSON_GetStringValue, NULL);
 
+    will_return(__wrap_cJSON_GetObjectItem, NULL);
+
+    will_return(__wrap_cJSON_GetObjectItem, NULL);
+
+    will_return(__wrap_cJSON_GetStringValue, NULL);
+
     w_load_files_status(global_json);
 
 }
@@ -998,6 +1103,12 @@ void test_w_load_files_status_no_file(void ** state) {
 
     will_return(__wrap_cJSON_GetStringValue, NULL);
 
+    will_return(__wrap_cJSON_GetObjectItem, NULL);
+
+    will_return(__wrap_cJSON_GetObjectItem, NULL);
+
+    will_return(__wrap_cJSON_GetStringValue, NULL);
+
     w_load_files_status(global_json);
 
 }
@@ -1038,6 +1149,12 @@ void test_w_load_files_status_hash_NULL(void ** state) {
 
     will_return(__wrap_cJSON_GetStringValue, NULL);
 
+    will_return(__wrap_cJSON_GetObjectItem, NULL);
+
+    will_return(__wrap_cJSON_GetObjectItem, NULL);
+
+    will_return(__wrap_cJSON_GetStringValue, NULL);
+
     w_load_files_status(global_json);
 
 }
@@ -1080,6 +1197,12 @@ void test_w_load_files_status_hash_str_NULL(void ** state) {
 
     will_return(__wrap_cJSON_GetStringValue, NULL);
 
+    will_return(__wrap_cJSON_GetObjectItem, NULL);
+
+    will_return(__wrap_cJSON_GetObjectItem, NULL);
+
+    will_return(__wrap_cJSON_GetStringValue, NULL);
+
     w_load_files_status(global_json);
 
 }
@@ -1125,6 +1248,12 @@ void test_w_load_files_status_offset_NULL(void ** state) {
 
     will_return(__wrap_cJSON_GetStringValue, NULL);
 
+    will_return(__wrap_cJSON_GetObjectItem, NULL);
+
+    will_return(__wrap_cJSON_GetObjectItem, NULL);
+
+    will_return(__wrap_cJSON_GetStringValue, NULL);
+
     w_load_files_status(global_json);
 
 }
@@ -1172,6 +1301,12 @@ void test_w_load_files_status_offset_str_NULL(void ** state) {
 
     will_return(__wrap_cJSON_GetStringValue, NULL);
 
+    will_return(__wrap_cJSON_GetObjectItem, NULL);
+
+    will_return(__wrap_cJSON_GetObjectItem, NULL);
+
+    will_return(__wrap_cJSON_GetStringValue, NULL);
+
     w_load_files_status(global_json);
 }
 
@@ -1218,6 +1353,12 @@ void test_w_load_files_status_invalid_offset(void ** state) {
 
     will_return(__wrap_cJSON_GetStringValue, NULL);
 
+    will_return(__wrap_cJSON_GetObjectItem, NULL);
+
+    will_return(__wrap_cJSON_GetObjectItem, NULL);
+
+    will_return(__wrap_cJSON_GetStringValue, NULL);
+
     w_load_files_status(global_json);
 
 }
@@ -1281,6 +1422,12 @@ void test_w_load_files_status_update_add_fail(void ** state) {
 
     will_return(__wrap_cJSON_GetStringValue, NULL);
 
+    will_return(__wrap_cJSON_GetObjectItem, NULL);
+
+    will_return(__wrap_cJSON_GetObjectItem, NULL);
+
+    will_return(__wrap_cJSON_GetStringValue, NULL);
+
     w_load_files_status(global_json);
 }
 
@@ -1387,14 +1534,22 @@ void test_w_load_files_status_update_fail(void ** state) {
 
     will_return(__wrap_cJSON_GetStringValue, NULL);
 
+    will_return(__wrap_cJSON_GetObjectItem, NULL);
+
+    will_return(__wrap_cJSON_GetObjectItem, NULL);
+
+    will_return(__wrap_cJSON_GetStringValue, NULL);
+
     w_load_files_status(global_json);
 
 }
 
 void test_w_load_files_status_OK(void ** state) {
     char * file = "test";
+    expect_function_call(__wrap_pthread_rwlock_rdlock);
     expect_function_call(__wrap_pthread_rwlock_wrlock);
     expect_function_call(__wrap_pthread_rwlock_unlock);
+    expect_function_call(__wrap_pthread_rwlock_unlock);
 
     __real_OSHash_Add_ex(mock_hashmap, file, strdup("data to be replaced"));
     cJSON *global_json = (cJSON*)1;
@@ -1445,6 +1600,12 @@ void test_w_load_files_status_OK(void ** state) {
 
     will_return(__wrap_cJSON_GetStringValue, NULL);
 
+    will_return(__wrap_cJSON_GetObjectItem, NULL);
+
+    will_return(__wrap_cJSON_GetObjectItem, NULL);
+
+    will_return(__wrap_cJSON_GetStringValue, NULL);
+
     w_load_files_status(global_json);
 
 }
@@ -1470,6 +1631,12 @@ void test_w_load_files_status_valid_timestamp_only(void ** state) {
 
     will_return(__wrap_cJSON_GetStringValue, NULL);
 
+    will_return(__wrap_cJSON_GetObjectItem, NULL);
+
+    will_return(__wrap_cJSON_GetObjectItem, NULL);
+
+    will_return(__wrap_cJSON_GetStringValue, NULL);
+
     w_load_files_status(global_json);
 
     assert_string_equal(macos_log_vault.settings, "my settings");
@@ -1497,6 +1664,12 @@ void test_w_load_files_status_valid_settings_only(void ** state) {
 
     will_return(__wrap_cJSON_GetStringValue, "/usr/bin/log stream --style syslog");
 
+    will_return(__wrap_cJSON_GetObjectItem, NULL);
+
+    will_return(__wrap_cJSON_GetObjectItem, NULL);
+
+    will_return(__wrap_cJSON_GetStringValue, NULL);
+
     w_load_files_status(global_json);
 
     assert_string_equal(macos_log_vault.settings, "my settings");
@@ -1535,6 +1708,12 @@ void test_w_load_files_status_valid_vault(void ** state) {
     expect_function_call(__wrap_pthread_rwlock_wrlock);
     expect_function_call(__wrap_pthread_rwlock_unlock);
 
+    will_return(__wrap_cJSON_GetObjectItem, NULL);
+
+    will_return(__wrap_cJSON_GetObjectItem, NULL);
+
+    will_return(__wrap_cJSON_GetStringValue, NULL);
+
     w_load_files_status(global_json);
 
     assert_string_equal(macos_log_vault.timestamp, "2021-04-27 08:07:20-0700");
@@ -1616,8 +1795,10 @@ void test_w_initialize_file_status_OK(void ** state) {
     char * file = "test";
     struct stat stat_buf = { .st_mode = 0040000 };
 
+    expect_function_call(__wrap_pthread_rwlock_rdlock);
     expect_function_call(__wrap_pthread_rwlock_wrlock);
     expect_function_call(__wrap_pthread_rwlock_unlock);
+    expect_function_call(__wrap_pthread_rwlock_unlock);
     __real_OSHash_Add_ex(mock_hashmap, file, strdup("data to be replaced"));
 
     expect_function_call(__wrap_OSHash_Create);
@@ -1680,6 +1861,12 @@ void test_w_initialize_file_status_OK(void ** state) {
 
     will_return(__wrap_cJSON_GetStringValue, NULL);
 
+    will_return(__wrap_cJSON_GetObjectItem, NULL);
+
+    will_return(__wrap_cJSON_GetObjectItem, NULL);
+
+    will_return(__wrap_cJSON_GetStringValue, NULL);
+
     expect_function_call(__wrap_cJSON_Delete);
 
     expect_value(__wrap_fclose, _File, "test");
@@ -1766,8 +1953,10 @@ void test_w_update_hash_node_OK(void ** state) {
     int mode = OS_BINARY;
     char * path = "test";
 
+    expect_function_call(__wrap_pthread_rwlock_rdlock);
     expect_function_call(__wrap_pthread_rwlock_wrlock);
     expect_function_call(__wrap_pthread_rwlock_unlock);
+    expect_function_call(__wrap_pthread_rwlock_unlock);
     __real_OSHash_Add_ex(mock_hashmap, path, strdup("data to be replaced"));
 
     expect_string(__wrap_OS_SHA1_File_Nbytes, fname, path);
@@ -1783,6 +1972,39 @@ void test_w_update_hash_node_OK(void ** state) {
     assert_int_equal(ret, 0);
 }
 
+void test_w_update_hash_node_compressed(void ** state) {
+    os_file_status_t * data;
+    os_sha1 expected;
+
+    expect_function_call(__wrap_pthread_rwlock_rdlock);
+    expect_function_call(__wrap_pthread_rwlock_wrlock);
+    expect_function_call(__wrap_pthread_rwlock_unlock);
+    expect_function_call(__wrap_pthread_rwlock_unlock);
+    __real_OSHash_Add_ex(mock_hashmap, gzip_path, strdup("data to be replaced"));
+
+    will_return(__wrap_OSHash_Update_ex, 1);
+
+    int ret = w_update_hash_node_ex(gzip_path, 14, true);
+
+    assert_int_equal(ret, 0);
+
+    /* The hash covers the decompressed content */
+    data = __real_OSHash_Get(mock_hashmap, gzip_path);
+    OS_SHA1_Str("line 1\nline 2\n", 14, expected);
+    assert_int_equal(data->offset, 14);
+    assert_string_equal(data->hash, expected);
+}
+
+void test_w_update_hash_node_compressed_sha_fail(void ** state) {
+    char * path = "/tmp/test_logcollector-missing.gz";
+
+    expect_string(__wrap__merror, formatted_msg, "(1969): Failure to generate the SHA1 hash from file '/tmp/test_logcollector-missing.gz'");
+
+    int ret = w_update_hash_node_ex(path, 14, true);
+
+    assert_int_equal(ret, -1);
+}
+
 /*  w_set_to_last_line_read */
 void test_w_set_to_last_line_read_null_reader(void ** state) {
     logreader lf = {0};
@@ -1797,8 +2019,10 @@ void test_w_set_to_last_line_read_OSHash_Get_ex_fail(void ** state) {
 
     test_position = &position_stack;
 
+    expect_function_call(__wrap_pthread_rwlock_rdlock);
     expect_function_call(__wrap_pthread_rwlock_wrlock);
     expect_function_call(__wrap_pthread_rwlock_unlock);
+    expect_function_call(__wrap_pthread_rwlock_unlock);
     __real_OSHash_Add_ex(mock_hashmap, log_reader.file, strdup("data to be replaced"));
 
     expect_any(__wrap_OSHash_Get_ex, self);
@@ -2061,6 +2285,175 @@ void test_w_set_to_last_line_read_update_hash_node_error(void ** state) {
     assert_int_equal(ret, 1);
 }
 
+void test_w_set_to_last_line_read_compressed_same_file(void ** state) {
+    unsigned char md[SHA_DIGEST_LENGTH];
+    os_sha1 output;
+    logreader log_reader = {.fp = (FILE *)1, .file = gzip_path, .compressed = true, .diff_max_size = 0};
+    os_file_status_t data = {.offset = 14};
+
+    OS_SHA1_Str("line 1\nline 2\n", 14, data.hash);
+
+    expect_any(__wrap_OSHash_Get_ex, self);
+    expect_string(__wrap_OSHash_Get_ex, key, gzip_path);
+    will_return(__wrap_OSHash_Get_ex, &data);
+
+    /* The size of the archive is not compared with the decompressed offset */
+    expect_string(__wrap_stat, __file, gzip_path);
+    will_return(__wrap_stat, NULL);
+    will_return(__wrap_stat, 0);
+
+    //w_set_pos
+    expect_any(__wrap_w_fseek, x);
+    expect_value(__wrap_w_fseek, pos, 14);
+    will_return(__wrap_w_fseek, 0);
+
+    expect_value(__wrap_w_ftell, x, 1);
+    will_return(__wrap_w_ftell, 14);
+
+    int ret = w_set_to_last_line_read(&log_reader);
+
+    assert_int_equal(ret, 14);
+
+    /* The saved context resumes the hash of the decompressed content */
+    SHA1_Final(md, &data.context);
+    OS_SHA1_Hexdigest(md, output);
+    assert_string_equal(output, data.hash);
+}
+
+void test_w_set_to_last_line_read_compressed_diferent_file(void ** state) {
+    logreader log_reader = {.fp = (FILE *)1, .file = gzip_path, .compressed = true, .diff_max_size = 0};
+    os_file_status_t data = {.hash = "1234", .offset = 14};
+    os_file_status_t * node;
+
+    expect_any(__wrap_OSHash_Get_ex, self);
+    expect_string(__wrap_OSHash_Get_ex, key, gzip_path);
+    will_return(__wrap_OSHash_Get_ex, &data);
+
+    expect_string(__wrap_stat, __file, gzip_path);
+    will_return(__wrap_stat, NULL);
+    will_return(__wrap_stat, 0);
+
+    //w_set_pos
+    expect_any(__wrap_w_fseek, x);
+    expect_value(__wrap_w_fseek, pos, 0);
+    will_return(__wrap_w_fseek, 0);
+
+    expect_value(__wrap_w_ftell, x, 1);
+    will_return(__wrap_w_ftell, 0);
+
+    //w_update_hash_node_ex
+    expect_function_call(__wrap_pthread_rwlock_rdlock);
+    expect_function_call(__wrap_pthread_rwlock_wrlock);
+    expect_function_call(__wrap_pthread_rwlock_unlock);
+    expect_function_call(__wrap_pthread_rwlock_unlock);
+    __real_OSHash_Add_ex(mock_hashmap, gzip_path, strdup("data to be replaced"));
+
+    will_return(__wrap_OSHash_Update_ex, 1);
+
+    int ret = w_set_to_last_line_read(&log_reader);
+
+    assert_int_equal(ret, 0);
+
+    node = __real_OSHash_Get(mock_hashmap, gzip_path);
+    assert_int_equal(node->offset, 0);
+    assert_string_equal(node->hash, "da39a3ee5e6b4b0d3255bfef95601890afd80709");
+}
+
+void test_w_set_to_last_line_read_compressed_sha_fail(void ** state) {
+    char * path = "/tmp/test_logcollector-missing.gz";
+    logreader log_reader = {.fp = (FILE *)1, .file = path, .compressed = true};
+    os_file_status_t data = {.hash = "1234", .offset = 14};
+
+    expect_any(__wrap_OSHash_Get_ex, self);
+    expect_string(__wrap_OSHash_Get_ex, key, path);
+    will_return(__wrap_OSHash_Get_ex, &data);
+
+    expect_string(__wrap_stat, __file, path);
+    will_return(__wrap_stat, NULL);
+    will_return(__wrap_stat, 0);
+
+    expect_string(__wrap__merror, formatted_msg, "(1969): Failure to generate the SHA1 hash from file '/tmp/test_logcollector-missing.gz'");
+
+    int ret = w_set_to_last_line_read(&log_reader);
+
+    assert_int_equal(ret, -1);
+}
+
+/* handle_file */
+
+void test_handle_file_compressed(void ** state) {
+    char msg[OS_SIZE_1024];
+    FILE * fp;
+    os_file_status_t * node;
+
+    /* handle_file rewinds the file after checking the magic number */
+    test_mode = 0;
+    fp = fopen(gzip_path, "r");
+    test_mode = 1;
+    assert_non_null(fp);
+
+    os_calloc(2, sizeof(logreader), logff);
+    logff[0].file = gzip_path;
+    logff[0].logformat = "syslog";
+    logff[0].future = 1;
+
+    expect_fopen(gzip_path, "r", fp);
+
+    expect_value(__wrap_fileno, __stream, fp);
+    will_return(__wrap_fileno, 3);
+
+    expect_value(__wrap_fstat, __fd, 3);
+    will_return(__wrap_fstat, 0100644);
+    will_return(__wrap_fstat, 42);
+    will_return(__wrap_fstat, 0);
+
+    expect_fread("\x1f\x8b", 2);
+
+    expect_fclose(fp, 0);
+
+    snprintf(msg, sizeof(msg), "Reading gzip-compressed file '%s'.", gzip_path);
+    expect_string(__wrap__mdebug1, formatted_msg, msg);
+
+    //w_set_pos
+    expect_any(__wrap_w_fseek, x);
+    expect_value(__wrap_w_fseek, pos, 0);
+    will_return(__wrap_w_fseek, 0);
+
+    expect_any(__wrap_w_ftell, x);
+    will_return(__wrap_w_ftell, strlen(gzip_content));
+
+    //w_update_hash_node_ex
+    expect_function_call(__wrap_pthread_rwlock_rdlock);
+    expect_function_call(__wrap_pthread_rwlock_wrlock);
+    expect_function_call(__wrap_pthread_rwlock_unlock);
+    expect_function_call(__wrap_pthread_rwlock_unlock);
+    __real_OSHash_Add_ex(mock_hashmap, gzip_path, strdup("data to be replaced"));
+
+    will_return(__wrap_OSHash_Update_ex, 1);
+
+    int ret = handle_file(0, -1, 1, 1);
+
+    assert_int_equal(ret, 0);
+    assert_true(logff[0].compressed);
+    assert_non_null(logff[0].fp);
+    assert_ptr_not_equal(logff[0].fp, fp);
+
+    node = __real_OSHash_Get(mock_hashmap, gzip_path);
+    assert_int_equal(node->offset, strlen(gzip_content));
+
+    /* The file is read through its decompressed content */
+    char buffer[OS_SIZE_128];
+
+    test_mode = 0;
+    assert_non_null(fgets(buffer, sizeof(buffer), logff[0].fp));
+    assert_string_equal(buffer, "line 1\n");
+    fclose(logff[0].fp);
+    fclose(fp);
+    test_mode = 1;
+
+    os_free(logff);
+}
+
 /* _macos_release_log_show */
 
 void test_w_macos_release_log_show_not_launched(void ** state) {
@@ -2261,6 +2654,7 @@ int main(void) {
         cmocka_unit_test_setup_teardown(test_w_get_hash_context_NULL_file_exist, setup_log_context, teardown_log_context),
         cmocka_unit_test_setup_teardown(test_w_get_hash_context_NULL_file_not_exist, setup_log_context, teardown_log_context),
         cmocka_unit_test_setup_teardown(test_w_get_hash_context_done, setup_log_context, teardown_log_context),
+        cmocka_unit_test_setup_teardown(test_w_get_hash_context_compressed, setup_gzip_file, teardown_gzip_file),
 
         // Test w_update_file_status
         cmocka_unit_test_setup_teardown(test_w_update_file_status_fail_update_add_table_hash, setup_local_hashmap, teardown_local_hashmap),
@@ -2321,6 +2715,8 @@ int main(void) {
         cmocka_unit_test_setup_teardown(test_w_update_hash_node_update_fail, setup_local_hashmap, teardown_local_hashmap),
         cmocka_unit_test_setup_teardown(test_w_update_hash_node_add_fail, setup_local_hashmap, teardown_local_hashmap),
         cmocka_unit_test_setup_teardown(test_w_update_hash_node_OK, setup_local_hashmap, teardown_local_hashmap),
+        cmocka_unit_test_setup_teardown(test_w_update_hash_node_compressed, setup_gzip_file, teardown_gzip_file),
+        cmocka_unit_test(test_w_update_hash_node_compressed_sha_fail),
 
         // Test w_set_to_last_line_read
         cmocka_unit_test(test_w_set_to_last_line_read_null_reader),
@@ -2331,6 +2727,12 @@ int main(void) {
         cmocka_unit_test_setup_teardown(test_w_set_to_last_line_read_same_file, setup_local_hashmap, teardown_local_hashmap),
         cmocka_unit_test_setup_teardown(test_w_set_to_last_line_read_same_file_rotate, setup_local_hashmap, teardown_local_hashmap),
         cmocka_unit_test_setup_teardown(test_w_set_to_last_line_read_update_hash_node_error, setup_local_hashmap, teardown_local_hashmap),
+        cmocka_unit_test_setup_teardown(test_w_set_to_last_line_read_compressed_same_file, setup_gzip_file, teardown_gzip_file),
+        cmocka_unit_test_setup_teardown(test_w_set_to_last_line_read_compressed_diferent_file, setup_gzip_file, teardown_gzip_file),
+        cmocka_unit_test(test_w_set_to_last_line_read_compressed_sha_fail),
+
+        // Test handle_file
+        cmocka_unit_test_setup_teardown(test_handle_file_compressed, setup_gzip_file, teardown_gzip_file),
 
         // Test w_macos_release_log_show
         cmocka_unit_test_setup_teardown(test_w_macos_release_log_show_not_launched, setup_process, teardown_process),
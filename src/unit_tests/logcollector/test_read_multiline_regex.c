@@ -31,7 +31,6 @@ int multiline_getlog_end(char * buffer, int length, FILE * stream, w_multiline_c
 int multiline_getlog_all(char * buffer, int length, FILE * stream, w_multiline_config_t * ml_cfg);
 int multiline_getlog(char * buffer, int length, FILE * stream, w_multiline_config_t * ml_cfg);
 void * read_multiline_regex(logreader * lf, int * rc, int drop_it);
-char * get_file_chunk(FILE * stream, int64_t initial_pos, int64_t final_pos);
 
 /* setup/teardown */
 
@@ -524,14 +523,10 @@ void test_multiline_getlog_start_single_no_context(void ** state) {
     ml_confg.replace_type = ML_REPLACE_NO_REPLACE;
     ml_confg.match_type = ML_MATCH_START;
 
-    expect_any(__wrap_w_ftell, x);
-    will_return(__wrap_w_ftell, (int64_t) 0);
     will_return(__wrap_can_read, 1);
     expect_any(__wrap_fgets, __stream);
     will_return(__wrap_fgets, "no match\n");
 
-    expect_any(__wrap_w_ftell, x);
-    will_return(__wrap_w_ftell, (int64_t) 0);
     will_return(__wrap_can_read, 1);
     expect_any(__wrap_fgets, __stream);
     will_return(__wrap_fgets, NULL);
@@ -562,8 +557,6 @@ void test_multiline_getlog_start_ctxt_timeout(void ** state) {
     ml_confg.ctxt->lines_count = 1;
     ml_confg.ctxt->timestamp = 0;
 
-    expect_any(__wrap_w_ftell, x);
-    will_return(__wrap_w_ftell, (int64_t) 0);
     will_return(__wrap_time, timeout + 1);
 
     retval = multiline_getlog_start(buffer, buffer_size, 0, &ml_confg);
@@ -587,16 +580,12 @@ void test_multiline_getlog_start_ctxt_append_ctxt(void ** state) {
     ml_confg.ctxt->timestamp = 0;
     ml_confg.timeout = timeout;
 
-    expect_any(__wrap_w_ftell, x);
-    will_return(__wrap_w_ftell, 0);
     will_return(__wrap_time, timeout - 1);
 
     will_return(__wrap_can_read, 1);
     expect_any(__wrap_fgets, __stream);
     will_return(__wrap_fgets, "no match3\n");
     will_return(__wrap_w_expression_match, false);
-    expect_any(__wrap_w_ftell, x);
-    will_return(__wrap_w_ftell, 0);
 
     will_return(__wrap_can_read, 1);
     expect_any(__wrap_fgets, __stream);
@@ -627,8 +616,6 @@ void test_multiline_getlog_start_ctxt_match(void ** state) {
     ml_confg.ctxt->timestamp = 0;
     ml_confg.timeout = timeout;
 
-    expect_any(__wrap_w_ftell, x);
-    will_return(__wrap_w_ftell, 0);
     will_return(__wrap_time, timeout - 1);
 
     will_return(__wrap_can_read, 1);
@@ -636,15 +623,15 @@ void test_multiline_getlog_start_ctxt_match(void ** state) {
     will_return(__wrap_fgets, "match");
     will_return(__wrap_w_expression_match, true);
 
-    expect_any(__wrap_w_fseek, x);
-    expect_value(__wrap_w_fseek, pos, 0);
-    will_return(__wrap_w_fseek, 0);
-
     retval = multiline_getlog_start(buffer, buffer_size, 0, &ml_confg);
 
     assert_int_equal(retval, 2);
     assert_null(ml_confg.ctxt);
     assert_string_equal(buffer, "no match\nno match2");
+    assert_string_equal(ml_confg.pending_line, "match");
+    assert_int_equal(ml_confg.raw_len, 0);
+    os_free(ml_confg.pending_line);
+    os_free(ml_confg.raw_data);
 }
 
 void test_multiline_getlog_start_no_ctxt_match(void ** state) {
@@ -659,36 +646,29 @@ void test_multiline_getlog_start_no_ctxt_match(void ** state) {
     ml_confg.replace_type = ML_REPLACE_NO_REPLACE;
     ml_confg.match_type = ML_MATCH_START;
 
-    expect_any(__wrap_w_ftell, x);
-    will_return(__wrap_w_ftell, (int64_t) 0);
-
     will_return(__wrap_can_read, 1);
     expect_any(__wrap_fgets, __stream);
     will_return(__wrap_fgets, "no match\n");
-    expect_any(__wrap_w_ftell, x);
-    will_return(__wrap_w_ftell, (int64_t) 0);
 
     will_return(__wrap_can_read, 1);
     expect_any(__wrap_fgets, __stream);
     will_return(__wrap_fgets, "no match2\n");
     will_return(__wrap_w_expression_match, false);
-    expect_any(__wrap_w_ftell, x);
-    will_return(__wrap_w_ftell, (int64_t) 0);
 
     will_return(__wrap_can_read, 1);
     expect_any(__wrap_fgets, __stream);
     will_return(__wrap_fgets, "match");
     will_return(__wrap_w_expression_match, true);
 
-    expect_any(__wrap_w_fseek, x);
-    expect_value(__wrap_w_fseek, pos, 0);
-    will_return(__wrap_w_fseek, 0);
-
     retval = multiline_getlog_start(buffer, buffer_size, 0, &ml_confg);
 
     assert_int_equal(retval, 2);
     assert_string_equal(buffer, "no match\nno match2");
     assert_null(ml_confg.ctxt);
+    assert_string_equal(ml_confg.pending_line, "match");
+    assert_int_equal(ml_confg.raw_len, 19);
+    os_free(ml_confg.pending_line);
+    os_free(ml_confg.raw_data);
 }
 
 void test_multiline_getlog_start_no_ctxt_overflow(void ** state) {
@@ -703,14 +683,10 @@ void test_multiline_getlog_start_no_ctxt_overflow(void ** state) {
     ml_confg.replace_type = ML_REPLACE_NO_REPLACE;
     ml_confg.match_type = ML_MATCH_START;
 
-    expect_any(__wrap_w_ftell, x);
-    will_return(__wrap_w_ftell, 0);
     will_return(__wrap_can_read, 1);
     expect_any(__wrap_fgets, __stream);
     will_return(__wrap_fgets, "01234567890123456789------");
 
-    expect_any(__wrap_w_ftell, x);
-    will_return(__wrap_w_ftell, 0);
     will_return(__wrap_fgetc, '-');
     will_return(__wrap_fgetc, '-');
     will_return(__wrap_fgetc, '-');
@@ -740,8 +716,6 @@ void test_multiline_getlog_start_ctxt_overflow(void ** state) {
     ml_confg.replace_type = ML_REPLACE_NO_REPLACE;
     ml_confg.match_type = ML_MATCH_START;
 
-    expect_any(__wrap_w_ftell, x);
-    will_return(__wrap_w_ftell, 0);
     will_return(__wrap_time, 0);
 
     will_return(__wrap_can_read, 1);
@@ -749,8 +723,6 @@ void test_multiline_getlog_start_ctxt_overflow(void ** state) {
     will_return(__wrap_fgets, "0123456789------");
 
     will_return(__wrap_w_expression_match, false);
-    expect_any(__wrap_w_ftell, x);
-    will_return(__wrap_w_ftell, 0);
     will_return(__wrap_fgetc, '-');
     will_return(__wrap_fgetc, '-');
     will_return(__wrap_fgetc, '-');
@@ -777,8 +749,6 @@ void test_multiline_getlog_start_no_ctxt_cant_read(void ** state) {
     ml_confg.replace_type = ML_REPLACE_NO_REPLACE;
     ml_confg.match_type = ML_MATCH_START;
 
-    expect_any(__wrap_w_ftell, x);
-    will_return(__wrap_w_ftell, 0);
     will_return(__wrap_can_read, 0);
     retval = multiline_getlog_start(buffer, buffer_size, 0, &ml_confg);
     assert_int_equal(retval, 0);
@@ -801,8 +771,6 @@ void test_multiline_getlog_start_ctxt_cant_read(void ** state) {
     ml_confg.match_type = ML_MATCH_START;
     ml_confg.ctxt->lines_count = 1;
 
-    expect_any(__wrap_w_ftell, x);
-    will_return(__wrap_w_ftell, 0);
     will_return(__wrap_time, 0);
 
     will_return(__wrap_can_read, 0);
@@ -825,35 +793,102 @@ void test_multiline_getlog_start_match_multi_replace(void ** state) {
     ml_confg.replace_type = ML_REPLACE_NONE;
     ml_confg.match_type = ML_MATCH_START;
 
-    expect_any(__wrap_w_ftell, x);
-    will_return(__wrap_w_ftell, 0);
     will_return(__wrap_can_read, 1);
     expect_any(__wrap_fgets, __stream);
     will_return(__wrap_fgets, "no match-\n");
 
-    expect_any(__wrap_w_ftell, x);
-    will_return(__wrap_w_ftell, 0);
     will_return(__wrap_can_read, 1);
     expect_any(__wrap_fgets, __stream);
     will_return(__wrap_fgets, ">no match2\n");
 
     will_return(__wrap_w_expression_match, false);
 
-    expect_any(__wrap_w_ftell, x);
-    will_return(__wrap_w_ftell, 0);
     will_return(__wrap_can_read, 1);
     expect_any(__wrap_fgets, __stream);
     will_return(__wrap_fgets, "next header");
     will_return(__wrap_w_expression_match, true);
-    expect_any(__wrap_w_fseek, x);
-    expect_value(__wrap_w_fseek, pos, 0);
-    will_return(__wrap_w_fseek, 0);
 
     retval = multiline_getlog_start(buffer, buffer_size, 0, &ml_confg);
 
     assert_int_equal(retval, 2);
     assert_null(ml_confg.ctxt);
     assert_string_equal(buffer, "no match->no match2");
+    assert_string_equal(ml_confg.pending_line, "next header");
+    assert_int_equal(ml_confg.raw_len, 21);
+    os_free(ml_confg.pending_line);
+    os_free(ml_confg.raw_data);
+}
+
+void test_multiline_getlog_start_pending_line(void ** state) {
+
+    int retval;
+    const size_t buffer_size = 500;
+    const time_t timeout = (time_t) 100;
+    char buffer[500 + 1];
+    w_multiline_config_t ml_confg = {0};
+
+    ml_confg.timeout = timeout;
+    ml_confg.replace_type = ML_REPLACE_NO_REPLACE;
+    ml_confg.match_type = ML_MATCH_START;
+    os_strdup("header\n", ml_confg.pending_line);
+
+    /* The line read ahead is taken without reading the file */
+    will_return(__wrap_can_read, 1);
+
+    will_return(__wrap_can_read, 1);
+    expect_any(__wrap_fgets, __stream);
+    will_return(__wrap_fgets, NULL);
+
+    will_return(__wrap_time, 1);
+
+    retval = multiline_getlog_start(buffer, buffer_size, 0, &ml_confg);
+
+    assert_int_equal(retval, 0);
+    assert_null(ml_confg.pending_line);
+    assert_string_equal(ml_confg.ctxt->buffer, "header\n");
+    assert_string_equal(ml_confg.raw_data, "header\n");
+    multiline_ctxt_free(&ml_confg.ctxt);
+    os_free(ml_confg.raw_data);
+}
+
+void test_multiline_getlog_start_prefix(void ** state) {
+
+    int retval;
+    const size_t buffer_size = 500;
+    const time_t timeout = (time_t) 100;
+    char buffer[500 + 1];
+    w_multiline_config_t ml_confg = {0};
+
+    ml_confg.timeout = timeout;
+    ml_confg.replace_type = ML_REPLACE_NO_REPLACE;
+    ml_confg.match_type = ML_MATCH_START;
+    os_strdup("20", ml_confg.start_prefix);
+    ml_confg.start_prefix_len = 2;
+    ml_confg.start_prefix_only = true;
+
+    will_return(__wrap_can_read, 1);
+    expect_any(__wrap_fgets, __stream);
+    will_return(__wrap_fgets, "2022 header\n");
+
+    /* Lines are discarded or matched by the literal prefix without running the regex */
+    will_return(__wrap_can_read, 1);
+    expect_any(__wrap_fgets, __stream);
+    will_return(__wrap_fgets, "no match\n");
+
+    will_return(__wrap_can_read, 1);
+    expect_any(__wrap_fgets, __stream);
+    will_return(__wrap_fgets, "2022 next header\n");
+
+    retval = multiline_getlog_start(buffer, buffer_size, 0, &ml_confg);
+
+    assert_int_equal(retval, 2);
+    assert_null(ml_confg.ctxt);
+    assert_string_equal(buffer, "2022 header\nno match");
+    assert_string_equal(ml_confg.pending_line, "2022 next header\n");
+    assert_string_equal(ml_confg.raw_data, "2022 header\nno match\n");
+    os_free(ml_confg.start_prefix);
+    os_free(ml_confg.pending_line);
+    os_free(ml_confg.raw_data);
 }
 
 /* multiline_getlog_end_single */
@@ -1471,23 +1506,22 @@ void test_multiline_getlog_start(void ** state) {
     ml_confg.timeout = timeout;
     ml_confg.match_type = ML_MATCH_START;
 
-    expect_any(__wrap_w_ftell, x);
-    will_return(__wrap_w_ftell, 0);
     will_return(__wrap_time, timeout - 1);
 
     will_return(__wrap_can_read, 1);
     expect_any(__wrap_fgets, __stream);
     will_return(__wrap_fgets, "match");
     will_return(__wrap_w_expression_match, true);
-    expect_any(__wrap_w_fseek, x);
-    expect_value(__wrap_w_fseek, pos, 0);
-    will_return(__wrap_w_fseek, 0);
 
     retval = multiline_getlog(buffer, buffer_size, 0, &ml_confg);
 
     assert_int_equal(retval, 2);
     assert_null(ml_confg.ctxt);
     assert_string_equal(buffer, "no match\nno match2");
+    assert_string_equal(ml_confg.pending_line, "match");
+    assert_int_equal(ml_confg.raw_len, 0);
+    os_free(ml_confg.pending_line);
+    os_free(ml_confg.raw_data);
 }
 
 void test_multiline_getlog_end(void ** state) {
@@ -1567,13 +1601,6 @@ void test_read_multiline_regex_log_process(void ** state) {
     expect_any(__wrap_w_ftell, x);
     will_return(__wrap_w_ftell, (int64_t) 10);
 
-    expect_any(__wrap_w_fseek, x);
-    expect_value(__wrap_w_fseek, pos, 5);
-    will_return(__wrap_w_fseek, 0);
-
-    will_return(__wrap_fread, "test0");
-    will_return(__wrap_fread, 5);
-
     will_return(__wrap_can_read, 1);
     expect_any(__wrap_fgets, __stream);
     will_return(__wrap_fgets, NULL);
@@ -1662,13 +1689,6 @@ void test_read_multiline_regex_invalid_context(void ** state) {
     expect_any(__wrap_w_ftell, x);
     will_return(__wrap_w_ftell, (int64_t) 10);
 
-    expect_any(__wrap_w_fseek, x);
-    expect_value(__wrap_w_fseek, pos, 5);
-    will_return(__wrap_w_fseek, 0);
-
-    will_return(__wrap_fread, "test0");
-    will_return(__wrap_fread, 5);
-
     will_return(__wrap_can_read, 1);
     expect_any(__wrap_fgets, __stream);
     will_return(__wrap_fgets, NULL);
@@ -1678,51 +1698,6 @@ void test_read_multiline_regex_invalid_context(void ** state) {
     assert_null(ml_confg.ctxt);
 }
 
-// Test get_file_chunk
-void test_get_file_chunk_fseek_fail(void ** state) {
-
-    char * retval;
-    int64_t initial_pos = 10;
-    int64_t final_pos = 5;
-
-    retval = get_file_chunk(NULL, initial_pos, final_pos);
-    assert_null(retval);
-}
-
-void test_get_file_chunk_size_reduce(void ** state) {
-
-    char * retval;
-    int64_t initial_pos = 5;
-    int64_t final_pos = 10;
-
-    will_return(__wrap_fread, "test");
-    will_return(__wrap_fread, 4);
-
-    expect_any(__wrap_w_fseek, x);
-    expect_value(__wrap_w_fseek, pos, 5);
-    will_return(__wrap_w_fseek, 0);
-
-    retval = get_file_chunk(NULL, initial_pos, final_pos);
-    assert_null(retval);
-}
-
-void test_get_file_chunk_ok(void ** state) {
-
-    char * retval;
-    int64_t initial_pos = 5;
-    int64_t final_pos = 10;
-
-    expect_any(__wrap_w_fseek, x);
-    expect_value(__wrap_w_fseek, pos, 5);
-    will_return(__wrap_w_fseek, 0);
-    will_return(__wrap_fread, "test");
-    will_return(__wrap_fread, 5);
-
-    retval = get_file_chunk(NULL, initial_pos, final_pos);
-    assert_string_equal("test", retval);
-    os_free(retval);
-}
-
 int main(void) {
     const struct CMUnitTest tests[] = {
         // Test replace_char
@@ -1786,6 +1761,8 @@ int main(void) {
         cmocka_unit_test(test_multiline_getlog_start_no_ctxt_cant_read),
         cmocka_unit_test(test_multiline_getlog_start_ctxt_cant_read),
         cmocka_unit_test(test_multiline_getlog_start_match_multi_replace),
+        cmocka_unit_test(test_multiline_getlog_start_pending_line),
+        cmocka_unit_test(test_multiline_getlog_start_prefix),
         // Test multiline_getlog_end
         cmocka_unit_test(test_multiline_getlog_end_single_match_no_context),
         cmocka_unit_test(test_multiline_getlog_end_ctxt_timeout),
@@ -1818,10 +1795,6 @@ int main(void) {
         cmocka_unit_test(test_read_multiline_regex_log_process),
         cmocka_unit_test(test_read_multiline_regex_cant_read),
         cmocka_unit_test(test_read_multiline_regex_invalid_context),
-        // Test get_file_chunk
-        cmocka_unit_test(test_get_file_chunk_fseek_fail),
-        cmocka_unit_test(test_get_file_chunk_size_reduce),
-        cmocka_unit_test(test_get_file_chunk_ok),
     };
 
     return cmocka_run_group_tests(tests, group_setup, group_teardown);
@@ -361,6 +361,7 @@ void test_getMonitorInternalOptions_success(void **state) {
     mond.rotate_log = 1;
     mond.size_rotate = 0;
     mond.daily_rotations = 100;
+    mond.rotation_threads = 4;
     mond.delete_old_agents = 3;
 
     root = getMonitorInternalOptions();
@@ -382,6 +383,8 @@ void test_getMonitorInternalOptions_success(void **state) {
         assert_int_equal(object->valueint, mond.size_rotate);
         object = cJSON_GetObjectItem(root->child, "daily_rotations");
         assert_int_equal(object->valueint, mond.daily_rotations);
+        object = cJSON_GetObjectItem(root->child, "rotation_threads");
+        assert_int_equal(object->valueint, mond.rotation_threads);
         object = cJSON_GetObjectItem(root->child, "delete_old_agents");
         assert_int_equal(object->valueint, mond.delete_old_agents);
     }
@@ -491,6 +494,7 @@ void test_MonitordConfig_success(void **state) {
     assert_int_equal(mond.keep_log_days, 1);
     assert_int_equal(mond.size_rotate, 1 * 1024 * 1024);
     assert_int_equal(mond.daily_rotations, 1);
+    assert_int_equal(mond.rotation_threads, 1);
     assert_int_equal(mond.delete_old_agents, 1);
 }
 
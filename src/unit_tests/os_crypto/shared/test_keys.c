@@ -19,6 +19,7 @@
 #include "../../wrappers/common.h"
 #include "../../wrappers/wazuh/shared/debug_op_wrappers.h"
 #include "../../wrappers/wazuh/shared/rbtree_op_wrappers.h"
+#include "../../wrappers/wazuh/shared/file_op_wrappers.h"
 #include "../../wrappers/libc/stdio_wrappers.h"
 
 int OS_IsAllowedID(keystore *keys, const char *id);
@@ -406,6 +407,84 @@ void test_OS_WriteTimestamps_move_error(void **state)
     assert_int_equal(r, -1);
 }
 
+// Test OS_AppendKeys
+
+void test_OS_AppendKeys_file_missing(void **state)
+{
+    keystore *keys = *(keystore **)state;
+
+    expect_string(__wrap_FileSize, path, KEYS_FILE);
+    will_return(__wrap_FileSize, -1);
+    expect_string(__wrap__mdebug1, formatted_msg, "Cannot append keys: 'etc/client.keys' or 'queue/agents-timestamp' does not exist.");
+
+    int r = OS_AppendKeys(keys->keyentries, keys->keysize);
+    assert_int_equal(r, -1);
+}
+
+void test_OS_AppendKeys_file_error(void **state)
+{
+    keystore *keys = *(keystore **)state;
+
+    expect_string(__wrap_FileSize, path, KEYS_FILE);
+    will_return(__wrap_FileSize, 0);
+    expect_string(__wrap_FileSize, path, TIMESTAMP_FILE);
+    will_return(__wrap_FileSize, 0);
+    expect_fopen(KEYS_FILE, "a", NULL);
+    expect_string(__wrap__merror, formatted_msg, "(1103): Could not open file 'etc/client.keys' due to [(13)-(Permission denied)].");
+    errno = EACCES;
+
+    int r = OS_AppendKeys(keys->keyentries, keys->keysize);
+    assert_int_equal(r, -1);
+}
+
+void test_OS_AppendKeys_file_write(void **state)
+{
+    keystore *keys = *(keystore **)state;
+    char timestamp[40];
+    struct tm tm = { .tm_sec = 0 };
+
+    keys->keyentries[0]->raw_key = "key1";
+    keys->keyentries[1]->raw_key = "key2";
+    strftime(timestamp, 40, "002 agent2 2.2.2.2 %Y-%m-%d %H:%M:%S\n", localtime_r(&keys->keyentries[1]->time_added, &tm));
+
+    expect_string(__wrap_FileSize, path, KEYS_FILE);
+    will_return(__wrap_FileSize, 100);
+    expect_string(__wrap_FileSize, path, TIMESTAMP_FILE);
+    will_return(__wrap_FileSize, 100);
+    expect_fopen(KEYS_FILE, "a", (FILE *)1);
+    expect_fopen(TIMESTAMP_FILE, "a", (FILE *)2);
+    expect_fprintf((FILE *)1, "001 agent1 1.1.1.1 key1\n", 0);
+    expect_fprintf((FILE *)1, "002 agent2 2.2.2.2 key2\n", 0);
+    expect_fprintf((FILE *)2, timestamp, 0);
+    expect_fclose((FILE *)1, 0);
+    expect_fclose((FILE *)2, 0);
+
+    int r = OS_AppendKeys(keys->keyentries, keys->keysize);
+    assert_int_equal(r, 0);
+}
+
+void test_OS_AppendKeys_write_error(void **state)
+{
+    keystore *keys = *(keystore **)state;
+
+    keys->keyentries[0]->raw_key = "key1";
+
+    expect_string(__wrap_FileSize, path, KEYS_FILE);
+    will_return(__wrap_FileSize, 100);
+    expect_string(__wrap_FileSize, path, TIMESTAMP_FILE);
+    will_return(__wrap_FileSize, 100);
+    expect_fopen(KEYS_FILE, "a", (FILE *)1);
+    expect_fopen(TIMESTAMP_FILE, "a", (FILE *)2);
+    expect_fprintf((FILE *)1, "001 agent1 1.1.1.1 key1\n", -1);
+    expect_string(__wrap__merror, formatted_msg, "(1110): Could not write file 'etc/client.keys' due to [(28)-(No space left on device)].");
+    expect_fclose((FILE *)1, 0);
+    expect_fclose((FILE *)2, 0);
+    errno = ENOSPC;
+
+    int r = OS_AppendKeys(keys->keyentries, keys->keysize);
+    assert_int_equal(r, -1);
+}
+
 // Test w_get_key_hash
 
 void test_w_get_key_hash_empty_parameters(void **state){
@@ -473,6 +552,11 @@ int main(void)
         cmocka_unit_test_setup_teardown(test_OS_WriteTimestamps_write_error, setup_config, teardown_config),
         cmocka_unit_test_setup_teardown(test_OS_WriteTimestamps_close_error, setup_config, teardown_config),
         cmocka_unit_test_setup_teardown(test_OS_WriteTimestamps_move_error, setup_config, teardown_config),
+        // Test OS_AppendKeys
+        cmocka_unit_test_setup_teardown(test_OS_AppendKeys_file_missing, setup_config, teardown_config),
+        cmocka_unit_test_setup_teardown(test_OS_AppendKeys_file_error, setup_config, teardown_config),
+        cmocka_unit_test_setup_teardown(test_OS_AppendKeys_file_write, setup_config, teardown_config),
+        cmocka_unit_test_setup_teardown(test_OS_AppendKeys_write_error, setup_config, teardown_config),
         // Test w_get_key_hash
         cmocka_unit_test(test_w_get_key_hash_empty_parameters),
         cmocka_unit_test(test_w_get_key_hash_empty_value),
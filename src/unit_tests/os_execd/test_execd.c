@@ -31,7 +31,6 @@
 #include "../wrappers/wazuh/shared/exec_op_wrappers.h"
 
 extern int test_mode;
-extern OSList *timeout_list;
 
 void ExecdStart(int q);
 
@@ -52,7 +51,7 @@ static int test_setup_file(void **state) {
     os_calloc(1, sizeof(wfd_t), wfd);
     wfd->file_in = (FILE *)1;
     wfd->file_out = (FILE *)2;
-    timeout_list = OSList_Create();
+    CreateTimeoutList();
     *state = wfd;
     return 0;
 }
@@ -62,7 +61,7 @@ static int test_setup_file_timeout(void **state) {
     os_calloc(1, sizeof(wfd_t), wfd);
     wfd->file_in = (FILE *)1;
     wfd->file_out = (FILE *)2;
-    timeout_list = OSList_Create();
+    CreateTimeoutList();
     timeout_data *timeout_entry;
     os_calloc(1, sizeof(timeout_data), timeout_entry);
     os_calloc(2, sizeof(char *), timeout_entry->command);
@@ -71,7 +70,7 @@ static int test_setup_file_timeout(void **state) {
     os_strdup("restart-wazuh-10.0.0.1-root", timeout_entry->rkey);
     timeout_entry->time_of_addition = 123456789;
     timeout_entry->time_to_block = 10;
-    OSList_AddData(timeout_list, timeout_entry);
+    AddTimeoutEntry(timeout_entry);
     *state = wfd;
     return 0;
 }
@@ -83,6 +82,18 @@ static int test_teardown_file(void **state) {
     return 0;
 }
 
+static void add_timeout_entry(const char *rkey, time_t time_of_addition, int time_to_block) {
+    timeout_data *timeout_entry;
+    os_calloc(1, sizeof(timeout_data), timeout_entry);
+    os_calloc(2, sizeof(char *), timeout_entry->command);
+    os_strdup("restart-wazuh", timeout_entry->command[0]);
+    os_strdup(rkey, timeout_entry->parameters);
+    os_strdup(rkey, timeout_entry->rkey);
+    timeout_entry->time_of_addition = time_of_addition;
+    timeout_entry->time_to_block = time_to_block;
+    assert_int_equal(AddTimeoutEntry(timeout_entry), 0);
+}
+
 /* Tests */
 
 static void test_ExecdStart_ok(void **state) {
@@ -1128,6 +1139,43 @@ static void test_ExecdStart_json_err(void **state) {
     ExecdStart(queue);
 }
 
+static void test_ExecdTimeoutRun_order(void **state) {
+    wfd_t * wfd = *state;
+    int childcount = 0;
+
+    add_timeout_entry("rkey-a", 100, 10);
+    add_timeout_entry("rkey-b", 100, 50);
+    add_timeout_entry("rkey-c", 100, 5);
+    add_timeout_entry("rkey-d", 110, 20);
+
+    // Duplicated rkey
+    timeout_data *timeout_entry;
+    os_calloc(1, sizeof(timeout_data), timeout_entry);
+    timeout_entry->rkey = "rkey-a";
+    assert_int_equal(AddTimeoutEntry(timeout_entry), -1);
+    os_free(timeout_entry);
+
+    will_return(__wrap_time, 120);
+
+    expect_string(__wrap__mdebug1, formatted_msg, "Executing command 'restart-wazuh rkey-c' after a timeout of '5s'");
+    will_return(__wrap_wpopenv, wfd);
+    expect_value(__wrap_fprintf, __stream, wfd->file_in);
+    expect_string(__wrap_fprintf, formatted_msg, "rkey-c\n");
+    will_return(__wrap_fprintf, 0);
+    will_return(__wrap_wpclose, 0);
+
+    expect_string(__wrap__mdebug1, formatted_msg, "Executing command 'restart-wazuh rkey-a' after a timeout of '10s'");
+    will_return(__wrap_wpopenv, wfd);
+    expect_value(__wrap_fprintf, __stream, wfd->file_in);
+    expect_string(__wrap_fprintf, formatted_msg, "rkey-a\n");
+    will_return(__wrap_fprintf, 0);
+    will_return(__wrap_wpclose, 0);
+
+    // rkey-d expires at 130
+    assert_int_equal(ExecdTimeoutRun(&childcount), 11);
+    assert_int_equal(childcount, 2);
+}
+
 int main(void) {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test_setup_teardown(test_ExecdStart_ok, test_setup_file, test_teardown_file),
@@ -1138,6 +1186,7 @@ int main(void) {
         cmocka_unit_test_setup_teardown(test_ExecdStart_get_command_err, test_setup_file, test_teardown_file),
         cmocka_unit_test_setup_teardown(test_ExecdStart_get_name_err, test_setup_file, test_teardown_file),
         cmocka_unit_test_setup_teardown(test_ExecdStart_json_err, test_setup_file, test_teardown_file),
+        cmocka_unit_test_setup_teardown(test_ExecdTimeoutRun_order, test_setup_file, test_teardown_file),
     };
 
     return cmocka_run_group_tests(tests, group_setup, group_teardown);
@@ -28,7 +28,6 @@
 #include "../wrappers/windows/libc/stdio_wrappers.h"
 
 extern int test_mode;
-extern OSList *timeout_list;
 
 /* Setup/Teardown */
 
@@ -47,7 +46,7 @@ static int test_setup_file(void **state) {
     os_calloc(1, sizeof(wfd_t), wfd);
     wfd->file_in = (FILE *)1;
     wfd->file_out = (FILE *)2;
-    timeout_list = OSList_Create();
+    CreateTimeoutList();
     *state = wfd;
     return 0;
 }
@@ -57,7 +56,7 @@ static int test_setup_file_timeout(void **state) {
     os_calloc(1, sizeof(wfd_t), wfd);
     wfd->file_in = (FILE *)1;
     wfd->file_out = (FILE *)2;
-    timeout_list = OSList_Create();
+    CreateTimeoutList();
     timeout_data *timeout_entry;
     os_calloc(1, sizeof(timeout_data), timeout_entry);
     os_calloc(2, sizeof(char *), timeout_entry->command);
@@ -66,7 +65,7 @@ static int test_setup_file_timeout(void **state) {
     os_strdup("restart-wazuh-10.0.0.1-root", timeout_entry->rkey);
     timeout_entry->time_of_addition = 123456789;
     timeout_entry->time_to_block = 10;
-    OSList_AddData(timeout_list, timeout_entry);
+    AddTimeoutEntry(timeout_entry);
     *state = wfd;
     return 0;
 }
@@ -413,6 +413,37 @@ void test_line_counter(void **state) {
     assert_int_equal(data->xml.ln[2], 3);
 }
 
+void test_many_nodes(void **state) {
+    test_struct_t *data  = (test_struct_t *)*state;
+    char *xml_string = NULL;
+    char node[64];
+    int i;
+
+    os_calloc(1000 * sizeof(node), sizeof(char), xml_string);
+    for (i = 0; i < 1000; i++) {
+        snprintf(node, sizeof(node), "<node id=\"%d\">%d</node>\n", i, i);
+        strcat(xml_string, node);
+    }
+    create_xml_file(xml_string, data->xml_file_name, 256);
+    os_free(xml_string);
+
+    assert_int_equal(OS_ReadXML(data->xml_file_name, &data->xml), 0);
+    assert_int_equal(data->xml.cur, 2000);
+
+    data->node = OS_GetElementsbyNode(&data->xml, NULL);
+    assert_non_null(data->node);
+
+    for (i = 0; i < 1000; i++) {
+        snprintf(node, sizeof(node), "%d", i);
+        assert_non_null(data->node[i]);
+        assert_string_equal(data->node[i]->element, "node");
+        assert_string_equal(data->node[i]->content, node);
+        assert_string_equal(data->node[i]->values[0], node);
+        assert_int_equal(data->xml.ln[2 * i], i + 1);
+    }
+    assert_null(data->node[1000]);
+}
+
 void test_invalid_file(void **state) {
     test_struct_t *data  = (test_struct_t *)*state;
 
@@ -1082,6 +1113,7 @@ int main(void) {
 
         // Line counter inside XML test
         cmocka_unit_test_setup_teardown(test_line_counter, test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_many_nodes, test_setup, test_teardown),
 
         // Invalid XML test
         cmocka_unit_test_setup_teardown(test_invalid_file, test_setup, test_teardown),
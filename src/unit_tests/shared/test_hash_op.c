@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2015, Wazuh Inc.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+
+#include "shared.h"
+
+#define TEST_KEYS 1000
+
+/* setup/teardown */
+static int setup_hash(void **state) {
+    OSHash *hash = OSHash_Create();
+
+    if (hash == NULL) {
+        return -1;
+    }
+
+    *state = hash;
+    return 0;
+}
+
+static int teardown_hash(void **state) {
+    OSHash_Free(*state);
+    return 0;
+}
+
+static void add_keys(OSHash *hash, int count) {
+    char key[16];
+    int i;
+
+    for (i = 0; i < count; i++) {
+        snprintf(key, sizeof(key), "key-%d", i);
+        assert_int_equal(OSHash_Add_ex(hash, key, (void *)(intptr_t)(i + 1)), 2);
+    }
+}
+
+static void check_keys(const OSHash *hash, int count) {
+    char key[16];
+    int i;
+
+    for (i = 0; i < count; i++) {
+        snprintf(key, sizeof(key), "key-%d", i);
+        assert_ptr_equal(OSHash_Get_ex(hash, key), (void *)(intptr_t)(i + 1));
+    }
+}
+
+static unsigned int count_nodes(const OSHash *hash) {
+    unsigned int i = 0;
+    unsigned int count = 0;
+    OSHashNode *node;
+
+    for (node = OSHash_Begin(hash, &i); node; node = OSHash_Next(hash, &i, node)) {
+        count++;
+    }
+
+    return count;
+}
+
+/****************TESTS***************************/
+void test_OSHash_Add_ex_grow(void **state) {
+    OSHash *hash = *state;
+
+    add_keys(hash, TEST_KEYS);
+
+    assert_int_equal(hash->elements, TEST_KEYS);
+    assert_true(hash->rows >= TEST_KEYS);
+    assert_int_equal(hash->rows & (hash->rows - 1), 0);
+    check_keys(hash, TEST_KEYS);
+    assert_int_equal(count_nodes(hash), TEST_KEYS);
+}
+
+void test_OSHash_Add_ex_duplicated(void **state) {
+    OSHash *hash = *state;
+
+    add_keys(hash, TEST_KEYS);
+
+    assert_int_equal(OSHash_Add_ex(hash, "key-7", (void *)1), 1);
+    assert_int_equal(OSHash_Update_ex(hash, "key-7", (void *)8), 1);
+    assert_int_equal(hash->elements, TEST_KEYS);
+    check_keys(hash, TEST_KEYS);
+}
+
+void test_OSHash_Delete_ex_while_growing(void **state) {
+    OSHash *hash = *state;
+    char key[16];
+    int i;
+
+    add_keys(hash, TEST_KEYS);
+
+    for (i = 0; i < TEST_KEYS; i += 2) {
+        snprintf(key, sizeof(key), "key-%d", i);
+        assert_ptr_equal(OSHash_Delete_ex(hash, key), (void *)(intptr_t)(i + 1));
+    }
+
+    for (i = 0; i < TEST_KEYS; i++) {
+        snprintf(key, sizeof(key), "key-%d", i);
+        assert_ptr_equal(OSHash_Get_ex(hash, key), i % 2 ? (void *)(intptr_t)(i + 1) : NULL);
+    }
+
+    assert_int_equal(hash->elements, TEST_KEYS / 2);
+    assert_int_equal(count_nodes(hash), TEST_KEYS / 2);
+}
+
+void test_OSHash_setSize_keeps_entries(void **state) {
+    OSHash *hash = *state;
+
+    add_keys(hash, TEST_KEYS);
+
+    assert_int_equal(OSHash_setSize_ex(hash, 5000), 1);
+    assert_int_equal(hash->rows, 8192);
+    assert_int_equal(hash->elements, TEST_KEYS);
+    check_keys(hash, TEST_KEYS);
+    assert_int_equal(count_nodes(hash), TEST_KEYS);
+}
+
+void test_OSHash_Duplicate_ex(void **state) {
+    OSHash *hash = *state;
+    OSHash *copy;
+
+    add_keys(hash, TEST_KEYS);
+
+    copy = OSHash_Duplicate_ex(hash);
+    assert_non_null(copy);
+    assert_int_equal(copy->elements, TEST_KEYS);
+    check_keys(copy, TEST_KEYS);
+    assert_int_equal(count_nodes(copy), TEST_KEYS);
+
+    OSHash_Free(copy);
+}
+/************************************************/
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_OSHash_Add_ex_grow, setup_hash, teardown_hash),
+        cmocka_unit_test_setup_teardown(test_OSHash_Add_ex_duplicated, setup_hash, teardown_hash),
+        cmocka_unit_test_setup_teardown(test_OSHash_Delete_ex_while_growing, setup_hash, teardown_hash),
+        cmocka_unit_test_setup_teardown(test_OSHash_setSize_keeps_entries, setup_hash, teardown_hash),
+        cmocka_unit_test_setup_teardown(test_OSHash_Duplicate_ex, setup_hash, teardown_hash),
+    };
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
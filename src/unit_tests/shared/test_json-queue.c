@@ -44,6 +44,7 @@ int setup_queue(void **state) {
 
 int teardown_queue(void **state) {
     file_queue * queue = *state;
+    os_free(queue->buffer);
     os_free(queue);
 
     return 0;
@@ -53,20 +54,10 @@ int teardown_queue(void **state) {
 
 void test_jqueue_parse_json_valid(void ** state) {
     file_queue * queue = *state;
-    char buffer[OS_MAXSTR + 1];
-    int64_t current_pos = 0;
     cJSON * object = NULL;
     char * output = NULL;
 
-    snprintf(buffer, OS_MAXSTR, "%s\n", "{\"test\":\"valid_json\"}");
-
-    expect_any(__wrap_w_ftell, x);
-    will_return(__wrap_w_ftell, 1);
-    expect_any(__wrap_w_ftell, x);
-    will_return(__wrap_w_ftell, 23);
-
-    expect_value(__wrap_fgets, __stream, queue->fp);
-    will_return(__wrap_fgets, buffer);
+    expect_fread("{\"test\":\"valid_json\"}\n", 22);
 
     object = jqueue_parse_json(queue);
 
@@ -78,78 +69,99 @@ void test_jqueue_parse_json_valid(void ** state) {
     cJSON_Delete(object);
 }
 
+void test_jqueue_parse_json_buffered(void ** state) {
+    file_queue * queue = *state;
+    cJSON * object = NULL;
+    char * output = NULL;
+
+    // Both alerts are read at once
+    expect_fread("{\"test\":\"first\"}\n{\"test\":\"second\"}\n", 35);
+
+    object = jqueue_parse_json(queue);
+    output = cJSON_PrintUnformatted(object);
+    assert_string_equal(output, "{\"test\":\"first\"}");
+    os_free(output);
+    cJSON_Delete(object);
+
+    object = jqueue_parse_json(queue);
+    output = cJSON_PrintUnformatted(object);
+    assert_string_equal(output, "{\"test\":\"second\"}");
+    os_free(output);
+    cJSON_Delete(object);
+
+    assert_int_equal(queue->flags, 0);
+}
+
 void test_jqueue_parse_json_invalid(void ** state) {
     file_queue * queue = *state;
-    char buffer[OS_MAXSTR + 1];
-    int64_t current_pos = 0;
     cJSON * object = NULL;
 
     snprintf(queue->file_name, MAX_FQUEUE, "%s", "/home/test");
-    snprintf(buffer, OS_MAXSTR, "%s\n", "{\"test\":\"invalid_value");
 
-    expect_any(__wrap_w_ftell, x);
-    will_return(__wrap_w_ftell, 1);
-    expect_any(__wrap_w_ftell, x);
-    will_return(__wrap_w_ftell, 24);
-    expect_value(__wrap_fgets, __stream, queue->fp);
-    will_return(__wrap_fgets, buffer);
+    expect_fread("{\"test\":\"invalid_value\n", 23);
 
     expect_string(__wrap__mwarn, formatted_msg, "Invalid JSON alert read from '/home/test': '{\"test\":\"invalid_value'");
 
+    expect_fread("", 0);
+
     object = jqueue_parse_json(queue);
 
     assert_null(object);
+    assert_int_equal(queue->flags, CRALERT_READ_FAILED);
+}
+
+void test_jqueue_parse_json_invalid_then_valid(void ** state) {
+    file_queue * queue = *state;
+    cJSON * object = NULL;
+    char * output = NULL;
+
+    snprintf(queue->file_name, MAX_FQUEUE, "%s", "/home/test");
+
+    // The buffered alert after the invalid one is returned at once
+    expect_fread("{\"test\":\"invalid_value\n{\"test\":\"valid_json\"}\n", 45);
+
+    expect_string(__wrap__mwarn, formatted_msg, "Invalid JSON alert read from '/home/test': '{\"test\":\"invalid_value'");
+
+    object = jqueue_parse_json(queue);
+
+    output = cJSON_PrintUnformatted(object);
+    assert_string_equal(output, "{\"test\":\"valid_json\"}");
     assert_int_equal(queue->flags, 0);
+
+    os_free(output);
+    cJSON_Delete(object);
 }
 
 void test_jqueue_parse_json_overlong_alert(void ** state) {
     file_queue * queue = *state;
-    char buffer1[OS_MAXSTR + 1];
-    char buffer2[OS_MAXSTR + 1];
-    int64_t current_pos = 0;
+    char buffer[OS_MAXSTR + 1];
     cJSON * object = NULL;
 
     snprintf(queue->file_name, MAX_FQUEUE, "%s", "/home/test");
 
     for (int i = 0; i < OS_MAXSTR; i++) {
-        buffer1[i] = 'a';
+        buffer[i] = 'a';
     }
-    buffer1[OS_MAXSTR]='\0';
-
-    snprintf(buffer2, OS_MAXSTR, "%s\n","aaaa");
-    expect_any(__wrap_w_ftell, x);
-    will_return(__wrap_w_ftell, 1);
-
-    expect_value(__wrap_fgets, __stream, queue->fp);
-    will_return(__wrap_fgets, buffer1);
-    expect_any(__wrap_w_ftell, x);
-    will_return(__wrap_w_ftell, 65537);
-    expect_value(__wrap_fgets, __stream, queue->fp);
-    will_return(__wrap_fgets, buffer1);
-    expect_any(__wrap_w_ftell, x);
-    will_return(__wrap_w_ftell, 131073);
-    expect_any(__wrap_w_ftell, x);
-    will_return(__wrap_w_ftell, 131078);
-    expect_value(__wrap_fgets, __stream, queue->fp);
-    will_return(__wrap_fgets, buffer2);
+    buffer[OS_MAXSTR]='\0';
+
+    expect_fread(buffer, OS_MAXSTR);
+    expect_fread("aaaa\n{\"test\":\"valid_json\"}\n", 27);
 
     expect_string(__wrap__mwarn, formatted_msg, "Overlong JSON alert read from '/home/test'");
 
+    // The next alert is returned after dropping the overlong one
     object = jqueue_parse_json(queue);
 
-    assert_null(object);
+    assert_non_null(object);
     assert_int_equal(queue->flags, 0);
+    cJSON_Delete(object);
 }
 
-void test_jqueue_parse_json_fgets_fail(void ** state) {
+void test_jqueue_parse_json_fread_fail(void ** state) {
     file_queue * queue = *state;
-    int64_t current_pos = 0;
     cJSON * object = NULL;
 
-    expect_any(__wrap_w_ftell, x);
-    will_return(__wrap_w_ftell, 1);
-    expect_value(__wrap_fgets, __stream, queue->fp);
-    will_return(__wrap_fgets, NULL);
+    expect_fread("", 0);
 
     object = jqueue_parse_json(queue);
 
@@ -157,41 +169,34 @@ void test_jqueue_parse_json_fgets_fail(void ** state) {
     assert_int_equal(queue->flags, CRALERT_READ_FAILED);
 }
 
-void test_jqueue_parse_json_fgets_fail_and_retry(void ** state) {
+void test_jqueue_parse_json_incomplete_and_retry(void ** state) {
     file_queue * queue = *state;
-    char buffer[OS_MAXSTR + 1];
-    int64_t current_pos = 0;
     cJSON * object = NULL;
+    char * output = NULL;
 
-    snprintf(queue->file_name, MAX_FQUEUE, "%s", "/home/test");
-
-    for (int i = 0; i < OS_MAXSTR; i++) {
-        buffer[i] = 'a';
-    }
-    buffer[OS_MAXSTR]='\0';
+    expect_fread("{\"test\":", 8);
+    expect_fread("", 0);
 
-    expect_any(__wrap_w_ftell, x);
-    will_return(__wrap_w_ftell, 1);
-    expect_value(__wrap_fgets, __stream, queue->fp);
-    will_return(__wrap_fgets, buffer);
-    expect_any(__wrap_w_ftell, x);
-    will_return(__wrap_w_ftell, 65537);
-    expect_value(__wrap_fgets, __stream, queue->fp);
-    will_return(__wrap_fgets, NULL);
+    object = jqueue_parse_json(queue);
 
-    expect_string(__wrap__mdebug2, formatted_msg, "Can't read from '/home/test'. Trying again");
+    assert_null(object);
+    assert_int_equal(queue->flags, CRALERT_READ_FAILED);
 
-    will_return(__wrap_fseek, 1);
+    // The rest of the alert is written
+    expect_fread("\"valid_json\"}\n", 14);
 
     object = jqueue_parse_json(queue);
 
-    assert_null(object);
-    assert_int_equal(queue->flags, CRALERT_READ_FAILED);
+    output = cJSON_PrintUnformatted(object);
+    assert_string_equal(output, "{\"test\":\"valid_json\"}");
+    assert_int_equal(queue->flags, 0);
+
+    os_free(output);
+    cJSON_Delete(object);
 }
 
 void test_jqueue_parse_json_stat_fail_and_retry(void ** state) {
     file_queue * queue = *state;
-    int64_t current_pos = 0;
     cJSON * object = NULL;
     struct stat st = { .st_dev = 0 };
 
@@ -200,11 +205,7 @@ void test_jqueue_parse_json_stat_fail_and_retry(void ** state) {
     expect_function_call(__wrap_clearerr);
     expect_value(__wrap_clearerr, __stream, 1);
 
-    expect_any(__wrap_w_ftell, x);
-    will_return(__wrap_w_ftell, 0);
-
-    expect_value(__wrap_fgets, __stream, queue->fp);
-    will_return(__wrap_fgets, NULL);
+    expect_fread("", 0);
 
     errno = ENOENT;
 
@@ -233,10 +234,12 @@ void test_jqueue_parse_json_stat_fail_and_retry(void ** state) {
 int main(void) {
     const struct CMUnitTest tests[] = {
             cmocka_unit_test_setup_teardown(test_jqueue_parse_json_valid, setup_queue, teardown_queue),
+            cmocka_unit_test_setup_teardown(test_jqueue_parse_json_buffered, setup_queue, teardown_queue),
             cmocka_unit_test_setup_teardown(test_jqueue_parse_json_invalid, setup_queue, teardown_queue),
+            cmocka_unit_test_setup_teardown(test_jqueue_parse_json_invalid_then_valid, setup_queue, teardown_queue),
             cmocka_unit_test_setup_teardown(test_jqueue_parse_json_overlong_alert, setup_queue, teardown_queue),
-            cmocka_unit_test_setup_teardown(test_jqueue_parse_json_fgets_fail, setup_queue, teardown_queue),
-            cmocka_unit_test_setup_teardown(test_jqueue_parse_json_fgets_fail_and_retry, setup_queue, teardown_queue),
+            cmocka_unit_test_setup_teardown(test_jqueue_parse_json_fread_fail, setup_queue, teardown_queue),
+            cmocka_unit_test_setup_teardown(test_jqueue_parse_json_incomplete_and_retry, setup_queue, teardown_queue),
             cmocka_unit_test_setup_teardown(test_jqueue_parse_json_stat_fail_and_retry, setup_queue, teardown_queue),
 
     };
@@ -532,8 +532,10 @@ void test_realtime_adddir_realtime_update(void **state) {
 
     directory_t config = { .options = REALTIME_ACTIVE };
 
+    expect_function_call(__wrap_pthread_rwlock_rdlock);
     expect_function_call(__wrap_pthread_rwlock_wrlock);
     expect_function_call(__wrap_pthread_rwlock_unlock);
+    expect_function_call(__wrap_pthread_rwlock_unlock);
     __real_OSHash_Add_ex(syscheck.realtime->dirtb, dummy_key, (void *) path);
 
     expect_function_call(__wrap_pthread_mutex_lock);
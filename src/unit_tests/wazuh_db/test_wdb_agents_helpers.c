@@ -381,6 +381,79 @@ void test_wdb_insert_vuln_cves_success(void **state)
     free_strarray(external_references);
 }
 
+/* Tests wdb_vuln_cves_batch_add */
+
+void test_wdb_vuln_cves_batch_add_full(void **state)
+{
+    wdb_vuln_cves_batch batch = {0};
+    batch.count = WDB_VULN_CVES_BATCH_MAX;
+
+    int ret = wdb_vuln_cves_batch_add(&batch, "test_package", "1.0", "x86", "CVE-2021-1001", "High", 6.9, 3.6,
+                                      "69ac04fa9b4a0dcfccd7c2237b366e501b678cc7", "PACKAGE", "VALID", NULL,
+                                      "Package unfixed", "CVE-2021-1001 affects package", "01-01-2021", "02-01-2021", true);
+
+    assert_int_equal(1, ret);
+    assert_int_equal(WDB_VULN_CVES_BATCH_MAX, batch.count);
+}
+
+/* Tests wdb_vuln_cves_batch_flush */
+
+void test_wdb_vuln_cves_batch_flush_empty(void **state)
+{
+    wdb_vuln_cves_batch batch = {0};
+
+    cJSON *ret = wdb_vuln_cves_batch_flush(1, &batch, NULL);
+
+    assert_null(ret);
+}
+
+void test_wdb_vuln_cves_batch_flush_error_result(void **state)
+{
+    wdb_vuln_cves_batch batch = {0};
+    cJSON *result = __real_cJSON_CreateArray();
+
+    os_strdup("[{\"name\":\"test_package\"},{\"name\":\"test_package_2\"}", batch.entries);
+    batch.length = strlen(batch.entries);
+    batch.count = 2;
+
+    // Only one result for two entries
+    __real_cJSON_AddItemToArray(result, __real_cJSON_CreateObject());
+    will_return(__wrap_wdbc_query_parse_json, 0);
+    will_return(__wrap_wdbc_query_parse_json, result);
+    expect_function_call(__wrap_cJSON_Delete);
+
+    expect_string(__wrap__merror, formatted_msg, "Agents DB (1) Error querying Wazuh DB to insert a batch of 2 vuln_cves");
+
+    cJSON *ret = wdb_vuln_cves_batch_flush(1, &batch, NULL);
+
+    assert_null(ret);
+    assert_null(batch.entries);
+    assert_int_equal(0, batch.count);
+    __real_cJSON_Delete(result);
+}
+
+void test_wdb_vuln_cves_batch_flush_success(void **state)
+{
+    wdb_vuln_cves_batch batch = {0};
+    cJSON *result = __real_cJSON_CreateArray();
+
+    os_strdup("[{\"name\":\"test_package\"}", batch.entries);
+    batch.length = strlen(batch.entries);
+    batch.count = 1;
+
+    __real_cJSON_AddItemToArray(result, __real_cJSON_CreateObject());
+    will_return(__wrap_wdbc_query_parse_json, 0);
+    will_return(__wrap_wdbc_query_parse_json, result);
+
+    cJSON *ret = wdb_vuln_cves_batch_flush(1, &batch, NULL);
+
+    assert_ptr_equal(result, ret);
+    assert_null(batch.entries);
+    assert_int_equal(0, batch.length);
+    assert_int_equal(0, batch.count);
+    __real_cJSON_Delete(result);
+}
+
 /* Tests wdb_update_vuln_cves_status */
 
 void test_wdb_update_vuln_cves_status_error_json(void **state){
@@ -741,6 +814,91 @@ void test_wdb_update_vuln_cves_status_by_type_success(void **state){
     assert_int_equal(OS_SUCCESS, ret);
 }
 
+/* Tests wdb_update_vuln_cves_status_by_reference */
+
+void test_wdb_update_vuln_cves_status_by_reference_error_result(void **state){
+    int ret = 0;
+    int id = 1;
+    const char *reference = "ref-pkg";
+    const char *new_status = "PENDING";
+    const char *json_str = NULL;
+    const char *response = "err";
+    char query_str[OS_SIZE_256];
+
+    os_strdup("{\"reference\":\"ref-pkg\",\"new_status\":\"PENDING\"}", json_str);
+    snprintf(query_str, OS_SIZE_256, "agent 1 vuln_cves update_status %s", json_str);
+
+    will_return(__wrap_cJSON_CreateObject, 1);
+    will_return_always(__wrap_cJSON_AddStringToObject, 1);
+
+    // Adding data to JSON
+    expect_string(__wrap_cJSON_AddStringToObject, name, "reference");
+    expect_string(__wrap_cJSON_AddStringToObject, string, "ref-pkg");
+    expect_string(__wrap_cJSON_AddStringToObject, name, "new_status");
+    expect_string(__wrap_cJSON_AddStringToObject, string, "PENDING");
+
+    // Printing JSON
+    will_return(__wrap_cJSON_PrintUnformatted, json_str);
+    expect_function_call(__wrap_cJSON_Delete);
+
+    // Calling Wazuh DB
+    expect_any(__wrap_wdbc_query_ex, *sock);
+    expect_string(__wrap_wdbc_query_ex, query, query_str);
+    expect_value(__wrap_wdbc_query_ex, len, WDBOUTPUT_SIZE);
+    will_return(__wrap_wdbc_query_ex, response);
+    will_return(__wrap_wdbc_query_ex, OS_SUCCESS);
+
+    // Parsing Wazuh DB result
+    expect_any(__wrap_wdbc_parse_result, result);
+    will_return(__wrap_wdbc_parse_result, WDBC_ERROR);
+    expect_string(__wrap__mdebug1, formatted_msg, "Agents DB (1) Error reported in the result of the query");
+
+    ret = wdb_update_vuln_cves_status_by_reference(id, reference, new_status, NULL);
+
+    assert_int_equal(OS_INVALID, ret);
+}
+
+void test_wdb_update_vuln_cves_status_by_reference_success(void **state){
+    int ret = 0;
+    int id = 1;
+    const char *reference = "ref-pkg";
+    const char *new_status = "PENDING";
+    const char *json_str = NULL;
+    char query_str[OS_SIZE_256];
+    const char *response = "ok";
+
+    os_strdup("{\"reference\":\"ref-pkg\",\"new_status\":\"PENDING\"}", json_str);
+    snprintf(query_str, OS_SIZE_256, "agent 1 vuln_cves update_status %s", json_str);
+
+    will_return(__wrap_cJSON_CreateObject, 1);
+    will_return_always(__wrap_cJSON_AddStringToObject, 1);
+
+    // Adding data to JSON
+    expect_string(__wrap_cJSON_AddStringToObject, name, "reference");
+    expect_string(__wrap_cJSON_AddStringToObject, string, "ref-pkg");
+    expect_string(__wrap_cJSON_AddStringToObject, name, "new_status");
+    expect_string(__wrap_cJSON_AddStringToObject, string, "PENDING");
+
+    // Printing JSON
+    will_return(__wrap_cJSON_PrintUnformatted, json_str);
+    expect_function_call(__wrap_cJSON_Delete);
+
+    // Calling Wazuh DB
+    expect_any(__wrap_wdbc_query_ex, *sock);
+    expect_string(__wrap_wdbc_query_ex, query, query_str);
+    expect_value(__wrap_wdbc_query_ex, len, WDBOUTPUT_SIZE);
+    will_return(__wrap_wdbc_query_ex, response);
+    will_return(__wrap_wdbc_query_ex, OS_SUCCESS);
+
+    // Parsing Wazuh DB result
+    expect_any(__wrap_wdbc_parse_result, result);
+    will_return(__wrap_wdbc_parse_result, WDBC_OK);
+
+    ret = wdb_update_vuln_cves_status_by_reference(id, reference, new_status, NULL);
+
+    assert_int_equal(OS_SUCCESS, ret);
+}
+
 /* Tests wdb_remove_vuln_cves_by_status */
 
 void test_wdb_remove_vuln_cves_by_status_error_json(void **state)
@@ -1124,6 +1282,12 @@ int main()
         cmocka_unit_test_setup_teardown(test_wdb_insert_vuln_cves_null_parameters, setup_wdb_agents_helpers, teardown_wdb_agents_helpers),
         cmocka_unit_test_setup_teardown(test_wdb_insert_vuln_cves_error_sql_execution, setup_wdb_agents_helpers, teardown_wdb_agents_helpers),
         cmocka_unit_test_setup_teardown(test_wdb_insert_vuln_cves_success, setup_wdb_agents_helpers, teardown_wdb_agents_helpers),
+        /* Tests wdb_vuln_cves_batch_add */
+        cmocka_unit_test_setup_teardown(test_wdb_vuln_cves_batch_add_full, setup_wdb_agents_helpers, teardown_wdb_agents_helpers),
+        /* Tests wdb_vuln_cves_batch_flush */
+        cmocka_unit_test_setup_teardown(test_wdb_vuln_cves_batch_flush_empty, setup_wdb_agents_helpers, teardown_wdb_agents_helpers),
+        cmocka_unit_test_setup_teardown(test_wdb_vuln_cves_batch_flush_error_result, setup_wdb_agents_helpers, teardown_wdb_agents_helpers),
+        cmocka_unit_test_setup_teardown(test_wdb_vuln_cves_batch_flush_success, setup_wdb_agents_helpers, teardown_wdb_agents_helpers),
         /* Tests wdb_update_vuln_cves_status*/
         cmocka_unit_test_setup_teardown(test_wdb_update_vuln_cves_status_error_json, setup_wdb_agents_helpers, teardown_wdb_agents_helpers),
         cmocka_unit_test_setup_teardown(test_wdb_update_vuln_cves_status_error_socket, setup_wdb_agents_helpers, teardown_wdb_agents_helpers),
@@ -1136,6 +1300,9 @@ int main()
         cmocka_unit_test_setup_teardown(test_wdb_update_vuln_cves_status_by_type_error_sql_execution, setup_wdb_agents_helpers, teardown_wdb_agents_helpers),
         cmocka_unit_test_setup_teardown(test_wdb_update_vuln_cves_status_by_type_error_result, setup_wdb_agents_helpers, teardown_wdb_agents_helpers),
         cmocka_unit_test_setup_teardown(test_wdb_update_vuln_cves_status_by_type_success, setup_wdb_agents_helpers, teardown_wdb_agents_helpers),
+        /* Tests wdb_update_vuln_cves_status_by_reference*/
+        cmocka_unit_test_setup_teardown(test_wdb_update_vuln_cves_status_by_reference_error_result, setup_wdb_agents_helpers, teardown_wdb_agents_helpers),
+        cmocka_unit_test_setup_teardown(test_wdb_update_vuln_cves_status_by_reference_success, setup_wdb_agents_helpers, teardown_wdb_agents_helpers),
         /* Tests wdb_remove_vuln_cves_by_status */
         cmocka_unit_test_setup_teardown(test_wdb_remove_vuln_cves_by_status_error_json, setup_wdb_agents_helpers, teardown_wdb_agents_helpers),
         cmocka_unit_test_setup_teardown(test_wdb_remove_vuln_cves_by_status_error_wdb_query, setup_wdb_agents_helpers, teardown_wdb_agents_helpers),
@@ -1409,6 +1409,86 @@ void test_vuln_cves_insert_command_success(void **state) {
     os_free(query);
 }
 
+void test_vuln_cves_insert_batch_syntax_error(void **state) {
+    int ret = OS_INVALID;
+    test_struct_t *data  = (test_struct_t *)*state;
+    char *query = NULL;
+
+    os_strdup("insert_batch [{\"name\":\"package\",\"version\":}]", query);
+
+    // wdb_parse_agents_insert_vuln_cves_batch
+    expect_string(__wrap__mdebug1, formatted_msg, "Invalid vuln_cves JSON syntax when inserting vulnerable packages batch.");
+    expect_string(__wrap__mdebug2, formatted_msg, "JSON error near: }]");
+
+    ret = wdb_parse_vuln_cves(data->wdb, query, data->output);
+
+    assert_string_equal(data->output, "err Invalid JSON syntax, near '[{\"name\":\"package\",\"version\":}]'");
+    assert_int_equal(ret, OS_INVALID);
+
+    os_free(query);
+}
+
+void test_vuln_cves_insert_batch_not_array(void **state) {
+    int ret = OS_INVALID;
+    test_struct_t *data  = (test_struct_t *)*state;
+    char *query = NULL;
+
+    os_strdup("insert_batch {\"name\":\"package\"}", query);
+
+    // wdb_parse_agents_insert_vuln_cves_batch
+    expect_string(__wrap__mdebug1, formatted_msg, "Invalid vuln_cves JSON data when inserting vulnerable packages batch. An array is expected.");
+
+    ret = wdb_parse_vuln_cves(data->wdb, query, data->output);
+
+    assert_string_equal(data->output, "err Invalid JSON data, array expected");
+    assert_int_equal(ret, OS_INVALID);
+
+    os_free(query);
+}
+
+void test_vuln_cves_insert_batch_success(void **state) {
+    int ret = OS_INVALID;
+    test_struct_t *data  = (test_struct_t *)*state;
+    char *query = NULL;
+    char *result = NULL;
+    os_strdup("[{\"test\":\"TEST\"},{\"status\":\"ERROR\"}]", result);
+    os_strdup("insert_batch [{\"name\":\"package\",\"version\":\"2.2\",\"architecture\":\"x86\",\"cve\":\"CVE-2021-1500\","
+              "\"reference\":\"8549fd9faf9b124635298e9311ccf672c2ad05d1\",\"type\":\"PACKAGE\",\"status\":\"VALID\","
+              "\"check_pkg_existence\":true,\"severity\":\"MEDIUM\",\"cvss2_score\":5.2,\"cvss3_score\":6},"
+              "{\"name\":\"package\",\"version\":\"2.2\"}]", query);
+
+    cJSON *test =  cJSON_CreateObject();
+    data->wdb->transaction = 1;
+
+    // wdb_parse_agents_insert_vuln_cves_entry
+    expect_string(__wrap_wdb_agents_insert_vuln_cves, name, "package");
+    expect_string(__wrap_wdb_agents_insert_vuln_cves, version, "2.2");
+    expect_string(__wrap_wdb_agents_insert_vuln_cves, architecture, "x86");
+    expect_string(__wrap_wdb_agents_insert_vuln_cves, cve, "CVE-2021-1500");
+    expect_string(__wrap_wdb_agents_insert_vuln_cves, reference, "8549fd9faf9b124635298e9311ccf672c2ad05d1");
+    expect_string(__wrap_wdb_agents_insert_vuln_cves, type, "PACKAGE");
+    expect_string(__wrap_wdb_agents_insert_vuln_cves, status, "VALID");
+    expect_value(__wrap_wdb_agents_insert_vuln_cves, check_pkg_existence, true);
+    expect_string(__wrap_wdb_agents_insert_vuln_cves, severity, "MEDIUM");
+    expect_value(__wrap_wdb_agents_insert_vuln_cves, cvss2_score, 5.2);
+    expect_value(__wrap_wdb_agents_insert_vuln_cves, cvss3_score, 6);
+    will_return(__wrap_wdb_agents_insert_vuln_cves, test);
+    will_return(__wrap_cJSON_PrintUnformatted, NULL);
+
+    // The second entry is reported as an error
+    expect_string(__wrap__mdebug1, formatted_msg, "Invalid vuln_cves JSON data when inserting vulnerable package."
+    " Not compliant with constraints defined in the database.");
+
+    will_return(__wrap_cJSON_PrintUnformatted, result);
+
+    ret = wdb_parse_vuln_cves(data->wdb, query, data->output);
+
+    assert_string_equal(data->output, "ok [{\"test\":\"TEST\"},{\"status\":\"ERROR\"}]");
+    assert_int_equal(ret, OS_SUCCESS);
+
+    os_free(query);
+}
+
 void test_vuln_cves_update_status_syntax_error(void **state){
     int ret = -1;
     test_struct_t *data  = (test_struct_t *)*state;
@@ -1534,6 +1614,48 @@ void test_vuln_cves_update_status_by_type_command_success(void **state){
     os_free(query);
 }
 
+void test_vuln_cves_update_status_by_reference_command_error(void **state){
+    int ret = -1;
+    test_struct_t *data  = (test_struct_t *)*state;
+    char *query = NULL;
+
+    os_strdup("update_status {\"reference\":\"ref-pkg\",\"new_status\":\"PENDING\"}", query);
+
+    // wdb_parse_agents_update_status_vuln_cves
+    will_return(__wrap_wdb_agents_update_vuln_cves_status_by_reference, OS_INVALID);
+    expect_string(__wrap_wdb_agents_update_vuln_cves_status_by_reference, reference, "ref-pkg");
+    expect_string(__wrap_wdb_agents_update_vuln_cves_status_by_reference, new_status, "PENDING");
+    will_return_count(__wrap_sqlite3_errmsg, "ERROR MESSAGE", -1);
+    expect_string(__wrap__mdebug1, formatted_msg, "DB(000) Cannot execute vuln_cves update_status command; SQL err: ERROR MESSAGE");
+
+    ret = wdb_parse_vuln_cves(data->wdb, query, data->output);
+
+    assert_string_equal(data->output, "err Cannot execute vuln_cves update_status command; SQL err: ERROR MESSAGE");
+    assert_int_equal(ret, OS_INVALID);
+
+    os_free(query);
+}
+
+void test_vuln_cves_update_status_by_reference_command_success(void **state){
+    int ret = -1;
+    test_struct_t *data  = (test_struct_t *)*state;
+    char *query = NULL;
+
+    os_strdup("update_status {\"reference\":\"ref-pkg\",\"new_status\":\"PENDING\"}", query);
+
+    // wdb_parse_agents_update_status_vuln_cves
+    will_return(__wrap_wdb_agents_update_vuln_cves_status_by_reference, OS_SUCCESS);
+    expect_string(__wrap_wdb_agents_update_vuln_cves_status_by_reference, reference, "ref-pkg");
+    expect_string(__wrap_wdb_agents_update_vuln_cves_status_by_reference, new_status, "PENDING");
+
+    ret = wdb_parse_vuln_cves(data->wdb, query, data->output);
+
+    assert_string_equal(data->output, "ok");
+    assert_int_equal(ret, OS_SUCCESS);
+
+    os_free(query);
+}
+
 void test_vuln_cves_remove_syntax_error(void **state){
     int ret = -1;
     test_struct_t *data  = (test_struct_t *)*state;
@@ -3786,6 +3908,10 @@ int main()
         cmocka_unit_test_setup_teardown(test_vuln_cves_insert_constraint_error, test_setup, test_teardown),
         cmocka_unit_test_setup_teardown(test_vuln_cves_insert_command_error, test_setup, test_teardown),
         cmocka_unit_test_setup_teardown(test_vuln_cves_insert_command_success, test_setup, test_teardown),
+        // wdb_parse_agents_insert_vuln_cves_batch
+        cmocka_unit_test_setup_teardown(test_vuln_cves_insert_batch_syntax_error, test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_vuln_cves_insert_batch_not_array, test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_vuln_cves_insert_batch_success, test_setup, test_teardown),
         // wdb_parse_agents_update_vuln_cves_status
         cmocka_unit_test_setup_teardown(test_vuln_cves_update_status_syntax_error, test_setup, test_teardown),
         cmocka_unit_test_setup_teardown(test_vuln_cves_update_status_constraint_error, test_setup, test_teardown),
@@ -3796,6 +3922,9 @@ int main()
         cmocka_unit_test_setup_teardown(test_vuln_cves_update_status_by_type_command_success,
                                         test_setup,
                                         test_teardown),
+        // wdb_parse_agents_update_vuln_cves_status_by_reference
+        cmocka_unit_test_setup_teardown(test_vuln_cves_update_status_by_reference_command_error, test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_vuln_cves_update_status_by_reference_command_success, test_setup, test_teardown),
         // wdb_parse_agents_remove_vuln_cves
         cmocka_unit_test_setup_teardown(test_vuln_cves_remove_syntax_error, test_setup, test_teardown),
         cmocka_unit_test_setup_teardown(test_vuln_cves_remove_json_data_error, test_setup, test_teardown),
@@ -38,6 +38,12 @@ static OS_XML *lxml;
 extern int test_mode;
 
 extern void wm_sca_send_policies_scanned(wm_sca_t * data);
+extern int wm_sca_read_command(char *command, char *pattern, wm_sca_t * data, char **reason);
+extern void wm_sca_scan_cache_init();
+extern void wm_sca_scan_cache_free();
+extern int wm_sca_do_scan(cJSON *checks, OSStore *vars, wm_sca_t * data, int id, cJSON *policy, int requirements_scan, int cis_db_index, unsigned int remote_policy, int first_scan, int *checks_number, char ** sorted_variables);
+extern char *wm_sca_hash_integrity(int policy_index);
+extern void wm_sca_free_hash_data(cis_db_info_t *event);
 
 extern w_queue_t * request_queue;
 extern char **last_sha256;
@@ -354,6 +360,251 @@ void test_wm_sort_variables(void **state)
     cJSON_Delete(variables_list);
 }
 
+static int setup_scan_cache(void **state) {
+    wm_sca_scan_cache_init();
+    return 0;
+}
+
+static int teardown_scan_cache(void **state) {
+    wm_sca_scan_cache_free();
+    return 0;
+}
+
+static void expect_command(char *command, char *output) {
+    expect_string(__wrap_wm_exec, command, command);
+    expect_value(__wrap_wm_exec, secs, 30);
+    expect_value(__wrap_wm_exec, add_path, NULL);
+    will_return(__wrap_wm_exec, output);
+    will_return(__wrap_wm_exec, 0);
+    will_return(__wrap_wm_exec, 0);
+}
+
+void test_wm_sca_read_command_once_per_scan(void **state)
+{
+    wm_sca_t data = { .commands_timeout = 30 };
+    char command[] = "sysctl net.ipv4.ip_forward";
+    char *reason = NULL;
+
+    expect_command(command, "net.ipv4.ip_forward = 0\n");
+
+    assert_int_equal(wm_sca_read_command(command, "r:^net.ipv4.ip_forward\\s*=\\s*0$", &data, &reason), 1);
+    // The second check uses the output of the first run
+    assert_int_equal(wm_sca_read_command(command, "r:^net.ipv4.ip_forward\\s*=\\s*1$", &data, &reason), 0);
+    assert_int_equal(wm_sca_read_command(command, "n:^net.ipv4.ip_forward\\s*=\\s*(\\d+) compare == 0", &data, &reason), 1);
+    assert_null(reason);
+}
+
+void test_wm_sca_read_command_without_scan(void **state)
+{
+    wm_sca_t data = { .commands_timeout = 30 };
+    char command[] = "sysctl net.ipv4.ip_forward";
+    char *reason = NULL;
+
+    expect_command(command, "net.ipv4.ip_forward = 0\n");
+    expect_command(command, "net.ipv4.ip_forward = 0\n");
+
+    assert_int_equal(wm_sca_read_command(command, "r:^net.ipv4.ip_forward\\s*=\\s*0$", &data, &reason), 1);
+    assert_int_equal(wm_sca_read_command(command, "r:^net.ipv4.ip_forward\\s*=\\s*0$", &data, &reason), 1);
+    assert_null(reason);
+}
+
+void test_wm_sca_read_command_failure_once_per_scan(void **state)
+{
+    wm_sca_t data = { .commands_timeout = 30 };
+    char command[] = "systemctl is-enabled rsyncd";
+    char *reason = NULL;
+
+    expect_string(__wrap_wm_exec, command, command);
+    expect_value(__wrap_wm_exec, secs, 30);
+    expect_value(__wrap_wm_exec, add_path, NULL);
+    will_return(__wrap_wm_exec, NULL);
+    will_return(__wrap_wm_exec, EXECVE_ERROR);
+    will_return(__wrap_wm_exec, -1);
+
+    assert_int_equal(wm_sca_read_command(command, "r:enabled", &data, &reason), 2);
+    assert_string_equal(reason, "Invalid path or wrong permissions to run command 'systemctl is-enabled rsyncd'");
+    os_free(reason);
+
+    assert_int_equal(wm_sca_read_command(command, "r:disabled", &data, &reason), 2);
+    assert_string_equal(reason, "Invalid path or wrong permissions to run command 'systemctl is-enabled rsyncd'");
+    os_free(reason);
+}
+
+/* wm_sca_do_scan */
+
+#define TEST_SCAN_CHECKS 12
+
+typedef struct test_scan_t {
+    char file[64];
+    cJSON *policy;
+    cJSON *checks;
+    OSHash **cis_db_bak;
+    cis_db_hash_info_t *cis_db_for_hash_bak;
+} test_scan_t;
+
+static int setup_scan(void **state) {
+    test_scan_t *test;
+    char rule[OS_SIZE_256];
+    int fd;
+
+    os_calloc(1, sizeof(test_scan_t), test);
+    strcpy(test->file, "/tmp/test_wm_sca_XXXXXX");
+
+    if (fd = mkstemp(test->file), fd < 0) {
+        os_free(test);
+        return -1;
+    }
+
+    if (write(fd, "Protocol 2\nPermitRootLogin no\n", 30) != 30) {
+        close(fd);
+        unlink(test->file);
+        os_free(test);
+        return -1;
+    }
+    close(fd);
+
+    test->policy = cJSON_Parse("{\"id\":\"test_policy\",\"name\":\"Test policy\"}");
+    test->checks = cJSON_CreateArray();
+
+    /* Odd checks pass and even checks fail. They all share the file and the patterns. */
+    for (int i = 1; i <= TEST_SCAN_CHECKS; i++) {
+        cJSON *check = cJSON_CreateObject();
+        cJSON *rules = cJSON_CreateArray();
+
+        cJSON_AddNumberToObject(check, "id", i);
+        snprintf(rule, sizeof(rule), "Check %d", i);
+        cJSON_AddStringToObject(check, "title", rule);
+        cJSON_AddStringToObject(check, "condition", "all");
+
+        snprintf(rule, sizeof(rule), "f:%s -> r:^Protocol 2$", test->file);
+        cJSON_AddItemToArray(rules, cJSON_CreateString(rule));
+        snprintf(rule, sizeof(rule), "f:%s -> r:^PermitRootLogin %s$", test->file, i % 2 ? "no" : "yes");
+        cJSON_AddItemToArray(rules, cJSON_CreateString(rule));
+
+        cJSON_AddItemToObject(check, "rules", rules);
+        cJSON_AddItemToArray(test->checks, check);
+    }
+
+    test->cis_db_bak = cis_db;
+    test->cis_db_for_hash_bak = cis_db_for_hash;
+    os_calloc(1, sizeof(OSHash *), cis_db);
+    os_calloc(1, sizeof(cis_db_hash_info_t), cis_db_for_hash);
+
+    *state = test;
+    return 0;
+}
+
+static int teardown_scan(void **state) {
+    test_scan_t *test = *state;
+
+    unlink(test->file);
+    cJSON_Delete(test->policy);
+    cJSON_Delete(test->checks);
+
+    os_free(cis_db);
+    os_free(cis_db_for_hash);
+    cis_db = test->cis_db_bak;
+    cis_db_for_hash = test->cis_db_for_hash_bak;
+
+    os_free(test);
+    return 0;
+}
+
+/* The events must carry the checks in policy order */
+static int check_scan_event(const LargestIntegralType value, const LargestIntegralType check_data) {
+    cJSON *event = cJSON_Parse((const char *)value);
+    const cJSON *check = cJSON_GetObjectItem(event, "check");
+    const cJSON *id = cJSON_GetObjectItem(check, "id");
+    const cJSON *result = cJSON_GetObjectItem(check, "result");
+    const int expected_id = (int)check_data;
+    int ret = 0;
+
+    if (id && result && result->valuestring) {
+        ret = id->valueint == expected_id && strcmp(result->valuestring, expected_id % 2 ? "passed" : "failed") == 0;
+    }
+
+    cJSON_Delete(event);
+    return ret;
+}
+
+static void expect_scan_events(wm_sca_t *data, int count) {
+    for (int i = 1; i <= count; i++) {
+        expect_value(__wrap_wm_sendmsg, usec, data->msg_delay);
+        expect_value(__wrap_wm_sendmsg, queue, data->queue);
+        expect_check(__wrap_wm_sendmsg, message, check_scan_event, i);
+        expect_string(__wrap_wm_sendmsg, locmsg, WM_SCA_STAMP);
+        expect_value(__wrap_wm_sendmsg, loc, SCA_MQ);
+        will_return(__wrap_wm_sendmsg, 0);
+    }
+}
+
+/* Runs the checks on an empty database and returns the result of the scan */
+static int scan_checks(test_scan_t *test, wm_sca_t *data, int *checks_number, char **integrity_hash) {
+    int ret;
+
+    cis_db[0] = OSHash_Create();
+    OSHash_SetFreeDataPointer(cis_db[0], (void (*)(void *))wm_sca_free_hash_data);
+    os_calloc(1, sizeof(cis_db_info_t *), cis_db_for_hash[0].elem);
+
+    wm_sca_scan_cache_init();
+    ret = wm_sca_do_scan(test->checks, NULL, data, 1, test->policy, 0, 0, 0, 0, checks_number, NULL);
+    wm_sca_scan_cache_free();
+
+    *integrity_hash = wm_sca_hash_integrity(0);
+
+    OSHash_Free(cis_db[0]);
+    os_free(cis_db_for_hash[0].elem);
+
+    return ret;
+}
+
+void test_wm_sca_do_scan_concurrent_keeps_order(void **state)
+{
+    test_scan_t *test = *state;
+    wm_sca_t data = { .queue = 1, .scan_threads = 1, .max_running_commands = 2 };
+    char *sequential_hash = NULL;
+    char *concurrent_hash = NULL;
+    int checks_number = 0;
+
+    expect_scan_events(&data, TEST_SCAN_CHECKS);
+    assert_int_equal(scan_checks(test, &data, &checks_number, &sequential_hash), 0);
+    assert_int_equal(checks_number, TEST_SCAN_CHECKS);
+    assert_non_null(sequential_hash);
+
+    data.scan_threads = 4;
+    checks_number = 0;
+
+    expect_scan_events(&data, TEST_SCAN_CHECKS);
+    assert_int_equal(scan_checks(test, &data, &checks_number, &concurrent_hash), 0);
+    assert_int_equal(checks_number, TEST_SCAN_CHECKS);
+    assert_non_null(concurrent_hash);
+
+    assert_string_equal(concurrent_hash, sequential_hash);
+
+    os_free(sequential_hash);
+    os_free(concurrent_hash);
+}
+
+void test_wm_sca_do_scan_concurrent_aborted_check(void **state)
+{
+    test_scan_t *test = *state;
+    wm_sca_t data = { .queue = 1, .scan_threads = 4, .max_running_commands = 2 };
+    char *integrity_hash = NULL;
+    int checks_number = 0;
+
+    /* A rule that is not a string skips the rest of the policy */
+    cJSON *rules = cJSON_GetObjectItem(cJSON_GetArrayItem(test->checks, 2), "rules");
+    cJSON_AddItemToArray(rules, cJSON_CreateNumber(1));
+
+    /* Only the checks before it are sent, even if the workers evaluated the next ones */
+    expect_scan_events(&data, 2);
+    assert_int_equal(scan_checks(test, &data, &checks_number, &integrity_hash), 1);
+    assert_int_equal(checks_number, 0);
+    assert_non_null(integrity_hash);
+
+    os_free(integrity_hash);
+}
+
 /* main */
 
 int main(void) {
@@ -368,7 +619,12 @@ int main(void) {
         cmocka_unit_test_setup_teardown(test_read_scheduling_interval_configuration, setup_test_read, teardown_test_read),
         cmocka_unit_test(test_wm_sort_variables_null),
         cmocka_unit_test(test_wm_sort_variables_duplicated),
-        cmocka_unit_test(test_wm_sort_variables)
+        cmocka_unit_test(test_wm_sort_variables),
+        cmocka_unit_test_setup_teardown(test_wm_sca_read_command_once_per_scan, setup_scan_cache, teardown_scan_cache),
+        cmocka_unit_test(test_wm_sca_read_command_without_scan),
+        cmocka_unit_test_setup_teardown(test_wm_sca_read_command_failure_once_per_scan, setup_scan_cache, teardown_scan_cache),
+        cmocka_unit_test_setup_teardown(test_wm_sca_do_scan_concurrent_keeps_order, setup_scan, teardown_scan),
+        cmocka_unit_test_setup_teardown(test_wm_sca_do_scan_concurrent_aborted_check, setup_scan, teardown_scan)
     };
     int result;
     result = cmocka_run_group_tests(tests_with_startup, setup_module, teardown_module);
@@ -50,6 +50,12 @@ int __wrap_OS_ReadXML_Ex(__attribute__ ((__unused__)) const char *file,
     return mock();
 }
 
+int __wrap_OS_ReadXMLString_Ex(__attribute__ ((__unused__)) const char *string,
+                               __attribute__ ((__unused__)) OS_XML *_lxml,
+                               __attribute__ ((__unused__)) bool flag_truncate) {
+    return mock();
+}
+
 char* __wrap_OS_GetOneContentforElement(__attribute__ ((__unused__)) OS_XML *_lxml,
                                         __attribute__ ((__unused__)) const char **element_name) {
     return mock_type(char *);
@@ -30,6 +30,8 @@ int __wrap_OS_ReadXML(const char *file, OS_XML *_lxml);
 
 int __wrap_OS_ReadXML_Ex(const char *file, OS_XML *_lxml);
 
+int __wrap_OS_ReadXMLString_Ex(const char *string, OS_XML *_lxml, bool flag_truncate);
+
 char* __wrap_OS_GetOneContentforElement(OS_XML *_lxml, const char **element_name);
 
 void __wrap_OS_ClearXML(OS_XML *_lxml);
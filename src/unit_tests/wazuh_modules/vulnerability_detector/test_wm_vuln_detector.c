@@ -74,6 +74,7 @@ char *wm_vuldet_oval_xml_preparser(char *path, vu_feed dist);
 int wm_vuldet_json_rh_parser(cJSON *json_feed, wm_vuldet_db *parsed_vulnerabilities);
 int wm_vuldet_json_arch_parser(cJSON *json_feed, wm_vuldet_db *parsed_vulnerabilities);
 int wm_vuldet_oval_process(update_node *update, char *path, wm_vuldet_db *parsed_vulnerabilities);
+int wm_vuldet_oval_stream(vu_oval_reader *reader, const char *data, size_t length, wm_vuldet_db *parsed_oval, update_node *update);
 int wm_vuldet_oval_xml_parser(OS_XML *xml, XML_NODE node, wm_vuldet_db *parsed_oval, update_node *update, vu_logic condition);
 int wm_vuldet_json_parser(char *json_path, wm_vuldet_db *parsed_vulnerabilities, update_node *update);
 int wm_vuldet_index_debian(sqlite3 *db, const char *target, update_node *update);
@@ -112,6 +113,7 @@ void wm_vuldet_free_alas_pkg(vu_alas_pkg **alas_pkg);
 void wm_vuldet_update_dependency_list_suse(const xml_node *dependency_node, wm_vuldet_db *parsed_oval);
 void wm_vuldet_clean_dependencies(dependencies *deps_it, char **dependency);
 int wm_vuldet_insert_deps(sqlite3 *db, dependencies *deps_it, wm_vuldet_db *parsed_oval);
+scan_agent *wm_vuldet_scan_pool_next(vu_scan_pool *pool);
 
 void wm_vuldet_update_last_scan(scan_ctx_t* scan_ctx);
 time_t wm_vuldet_get_last_scan(scan_ctx_t* scan_ctx);
@@ -483,6 +485,9 @@ static int teardown_scan_agent(void **state) {
         wm_vuldet_free_scan_agent(agent);
     }
 
+    // Force the OVAL conditions to be read again in the next test
+    wm_vuldet_cve_index_clean();
+
     return OS_SUCCESS;
 }
 
@@ -4084,12 +4089,6 @@ void test_wm_vuldet_linux_oval_vulnerabilities_vulnerable(void **state)
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
     expect_value(__wrap_sqlite3_bind_text, pos, 1);
     expect_string(__wrap_sqlite3_bind_text, buffer, "BUSTER");
-    expect_value(__wrap_sqlite3_bind_text, pos, 2);
-    expect_string(__wrap_sqlite3_bind_text, buffer, "CVE-2020-1234");
-    expect_value(__wrap_sqlite3_bind_text, pos, 3);
-    expect_string(__wrap_sqlite3_bind_text, buffer, "package");
-    expect_value(__wrap_sqlite3_bind_text, pos, 4);
-    expect_string(__wrap_sqlite3_bind_text, buffer, "5.1.0");
     expect_sqlite3_step_call(SQLITE_DONE);
 
     expect_sqlite3_step_call(SQLITE_DONE);
@@ -4191,12 +4190,6 @@ void test_wm_vuldet_linux_oval_vulnerabilities_insert_package_error(void **state
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
     expect_value(__wrap_sqlite3_bind_text, pos, 1);
     expect_string(__wrap_sqlite3_bind_text, buffer, "BUSTER");
-    expect_value(__wrap_sqlite3_bind_text, pos, 2);
-    expect_string(__wrap_sqlite3_bind_text, buffer, "CVE-2020-1234");
-    expect_value(__wrap_sqlite3_bind_text, pos, 3);
-    expect_string(__wrap_sqlite3_bind_text, buffer, "package");
-    expect_value(__wrap_sqlite3_bind_text, pos, 4);
-    expect_string(__wrap_sqlite3_bind_text, buffer, "10");
     expect_sqlite3_step_call(SQLITE_DONE);
 
     expect_sqlite3_step_call(SQLITE_DONE);
@@ -4309,12 +4302,6 @@ void test_wm_vuldet_linux_oval_vulnerabilities_duplicated_package(void **state)
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
     expect_value(__wrap_sqlite3_bind_text, pos, 1);
     expect_string(__wrap_sqlite3_bind_text, buffer, "BUSTER");
-    expect_value(__wrap_sqlite3_bind_text, pos, 2);
-    expect_string(__wrap_sqlite3_bind_text, buffer, "CVE-2020-1234");
-    expect_value(__wrap_sqlite3_bind_text, pos, 3);
-    expect_string(__wrap_sqlite3_bind_text, buffer, "package");
-    expect_value(__wrap_sqlite3_bind_text, pos, 4);
-    expect_string(__wrap_sqlite3_bind_text, buffer, "4.0.0");
     expect_sqlite3_step_call(SQLITE_DONE);
 
     expect_sqlite3_step_call(SQLITE_DONE);
@@ -4397,18 +4384,17 @@ void test_wm_vuldet_linux_oval_duplicated_cve_false_positive(void **state)
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
     expect_value(__wrap_sqlite3_bind_text, pos, 1);
     expect_string(__wrap_sqlite3_bind_text, buffer, "BUSTER");
-    expect_value(__wrap_sqlite3_bind_text, pos, 2);
-    expect_string(__wrap_sqlite3_bind_text, buffer, "CVE-2020-1234");
-    expect_value(__wrap_sqlite3_bind_text, pos, 3);
-    expect_string(__wrap_sqlite3_bind_text, buffer, "package");
-    expect_value(__wrap_sqlite3_bind_text, pos, 4);
-    expect_string(__wrap_sqlite3_bind_text, buffer, "4.0.0");
     expect_sqlite3_step_call(SQLITE_ROW);
 
     expect_value(__wrap_sqlite3_column_text, iCol, 0);
-    will_return(__wrap_sqlite3_column_text, "less than");
+    will_return(__wrap_sqlite3_column_text, "CVE-2020-1234");
     expect_value(__wrap_sqlite3_column_text, iCol, 1);
+    will_return(__wrap_sqlite3_column_text, "package");
+    expect_value(__wrap_sqlite3_column_text, iCol, 2);
+    will_return(__wrap_sqlite3_column_text, "less than");
+    expect_value(__wrap_sqlite3_column_text, iCol, 3);
     will_return(__wrap_sqlite3_column_text, "3.0.0");
+    expect_sqlite3_step_call(SQLITE_DONE);
 
     expect_value(__wrap_pkg_version_relate, rel, PKG_RELATION_LT);
     will_return(__wrap_pkg_version_relate, 0);
@@ -4493,21 +4479,16 @@ void test_wm_vuldet_linux_oval_duplicated_cve_false_positive_os_invalid(void **s
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
     expect_value(__wrap_sqlite3_bind_text, pos, 1);
     expect_string(__wrap_sqlite3_bind_text, buffer, "BUSTER");
-    expect_value(__wrap_sqlite3_bind_text, pos, 2);
-    expect_string(__wrap_sqlite3_bind_text, buffer, "CVE-2020-1234");
-    expect_value(__wrap_sqlite3_bind_text, pos, 3);
-    expect_string(__wrap_sqlite3_bind_text, buffer, "package");
-    expect_value(__wrap_sqlite3_bind_text, pos, 4);
-    expect_string(__wrap_sqlite3_bind_text, buffer, "4.0.0");
     expect_sqlite3_step_call(SQLITE_ROW);
 
     expect_value(__wrap_sqlite3_column_text, iCol, 0);
-    will_return(__wrap_sqlite3_column_text, "less than");
+    will_return(__wrap_sqlite3_column_text, "CVE-2020-1234");
     expect_value(__wrap_sqlite3_column_text, iCol, 1);
+    will_return(__wrap_sqlite3_column_text, "package");
+    expect_value(__wrap_sqlite3_column_text, iCol, 2);
+    will_return(__wrap_sqlite3_column_text, "less than");
+    expect_value(__wrap_sqlite3_column_text, iCol, 3);
     will_return(__wrap_sqlite3_column_text, "3.0.0");
-
-    expect_value(__wrap_pkg_version_relate, rel, PKG_RELATION_LT);
-    will_return(__wrap_pkg_version_relate, 1);
     expect_sqlite3_step_call(SQLITE_ERROR);
 
     will_return(__wrap_sqlite3_errmsg, "error");
@@ -4817,12 +4798,6 @@ void test_wm_vuldet_oval_discard_mismatching_cve_entries_not_vulnerable_ubuntu(v
     will_return_always(__wrap_sqlite3_bind_text, 0);
     expect_value(__wrap_sqlite3_bind_text, pos, 1);
     expect_string(__wrap_sqlite3_bind_text, buffer, "BIONIC");
-    expect_value(__wrap_sqlite3_bind_text, pos, 2);
-    expect_string(__wrap_sqlite3_bind_text, buffer, "CVE-2020-1234");
-    expect_value(__wrap_sqlite3_bind_text, pos, 3);
-    expect_string(__wrap_sqlite3_bind_text, buffer, "package");
-    expect_value(__wrap_sqlite3_bind_text, pos, 4);
-    expect_string(__wrap_sqlite3_bind_text, buffer, "4.0.0");
     expect_sqlite3_step_call(SQLITE_DONE);
 
     int ret = wm_vuldet_oval_discard_mismatching_cve_entries(db, agents_it, cve_id, pkg_version, pkg_name, vertype);
@@ -4844,18 +4819,17 @@ void test_wm_vuldet_oval_discard_mismatching_cve_entries_not_vulnerable(void **s
     will_return_always(__wrap_sqlite3_bind_text, 0);
     expect_value(__wrap_sqlite3_bind_text, pos, 1);
     expect_string(__wrap_sqlite3_bind_text, buffer, "BUSTER");
-    expect_value(__wrap_sqlite3_bind_text, pos, 2);
-    expect_string(__wrap_sqlite3_bind_text, buffer, "CVE-2020-1234");
-    expect_value(__wrap_sqlite3_bind_text, pos, 3);
-    expect_string(__wrap_sqlite3_bind_text, buffer, "package");
-    expect_value(__wrap_sqlite3_bind_text, pos, 4);
-    expect_string(__wrap_sqlite3_bind_text, buffer, "4.0.0");
     expect_sqlite3_step_call(SQLITE_ROW);
 
     expect_value(__wrap_sqlite3_column_text, iCol, 0);
-    will_return(__wrap_sqlite3_column_text, "less than");
+    will_return(__wrap_sqlite3_column_text, "CVE-2020-1234");
     expect_value(__wrap_sqlite3_column_text, iCol, 1);
+    will_return(__wrap_sqlite3_column_text, "package");
+    expect_value(__wrap_sqlite3_column_text, iCol, 2);
+    will_return(__wrap_sqlite3_column_text, "less than");
+    expect_value(__wrap_sqlite3_column_text, iCol, 3);
     will_return(__wrap_sqlite3_column_text, "3.0.0");
+    expect_sqlite3_step_call(SQLITE_DONE);
 
     expect_value(__wrap_pkg_version_relate, rel, PKG_RELATION_LT);
     will_return(__wrap_pkg_version_relate, 0);
@@ -4879,22 +4853,31 @@ void test_wm_vuldet_oval_discard_mismatching_cve_entries_vulnerable(void **state
     will_return_always(__wrap_sqlite3_bind_text, 0);
     expect_value(__wrap_sqlite3_bind_text, pos, 1);
     expect_string(__wrap_sqlite3_bind_text, buffer, "BUSTER");
-    expect_value(__wrap_sqlite3_bind_text, pos, 2);
-    expect_string(__wrap_sqlite3_bind_text, buffer, "CVE-2020-1234");
-    expect_value(__wrap_sqlite3_bind_text, pos, 3);
-    expect_string(__wrap_sqlite3_bind_text, buffer, "package");
-    expect_value(__wrap_sqlite3_bind_text, pos, 4);
-    expect_string(__wrap_sqlite3_bind_text, buffer, "4.0.0");
     expect_sqlite3_step_call(SQLITE_ROW);
 
     expect_value(__wrap_sqlite3_column_text, iCol, 0);
+    will_return(__wrap_sqlite3_column_text, "CVE-2020-1234");
+    expect_value(__wrap_sqlite3_column_text, iCol, 1);
+    will_return(__wrap_sqlite3_column_text, "package");
+    expect_value(__wrap_sqlite3_column_text, iCol, 2);
     will_return(__wrap_sqlite3_column_text, "less than");
+    expect_value(__wrap_sqlite3_column_text, iCol, 3);
+    will_return(__wrap_sqlite3_column_text, "5.0.0");
+    expect_sqlite3_step_call(SQLITE_ROW);
+
+    // Entries with the version of the package are not compared
+    expect_value(__wrap_sqlite3_column_text, iCol, 0);
+    will_return(__wrap_sqlite3_column_text, "CVE-2020-1234");
     expect_value(__wrap_sqlite3_column_text, iCol, 1);
+    will_return(__wrap_sqlite3_column_text, "package");
+    expect_value(__wrap_sqlite3_column_text, iCol, 2);
+    will_return(__wrap_sqlite3_column_text, "less than");
+    expect_value(__wrap_sqlite3_column_text, iCol, 3);
     will_return(__wrap_sqlite3_column_text, "4.0.0");
+    expect_sqlite3_step_call(SQLITE_DONE);
 
     expect_value(__wrap_pkg_version_relate, rel, PKG_RELATION_LT);
     will_return(__wrap_pkg_version_relate, 1);
-    expect_sqlite3_step_call(SQLITE_DONE);
 
     int ret = wm_vuldet_oval_discard_mismatching_cve_entries(db, agents_it, cve_id, pkg_version, pkg_name, vertype);
     assert_int_equal(ret, VU_VULNERABLE);
@@ -4934,12 +4917,6 @@ void test_wm_vuldet_oval_discard_mismatching_cve_entries_set_error(void **state)
     will_return_always(__wrap_sqlite3_bind_text, 0);
     expect_value(__wrap_sqlite3_bind_text, pos, 1);
     expect_string(__wrap_sqlite3_bind_text, buffer, "BUSTER");
-    expect_value(__wrap_sqlite3_bind_text, pos, 2);
-    expect_string(__wrap_sqlite3_bind_text, buffer, "CVE-2020-1234");
-    expect_value(__wrap_sqlite3_bind_text, pos, 3);
-    expect_string(__wrap_sqlite3_bind_text, buffer, "package");
-    expect_value(__wrap_sqlite3_bind_text, pos, 4);
-    expect_string(__wrap_sqlite3_bind_text, buffer, "4.0.0");
 
     expect_sqlite3_step_call(SQLITE_ERROR);
     will_return(__wrap_sqlite3_errmsg, "error");
@@ -4951,6 +4928,75 @@ void test_wm_vuldet_oval_discard_mismatching_cve_entries_set_error(void **state)
     assert_int_equal(ret, OS_INVALID);
 }
 
+void test_wm_vuldet_oval_discard_mismatching_cve_entries_cached_index(void **state)
+{
+    sqlite3 *db = (sqlite3 *)1;
+    scan_agent *agents_it = *state;
+    char *pkg_version = "4.0.0";
+    char *pkg_name = "package";
+    version_type vertype = VER_TYPE_DEB;
+    agents_it->dist = FEED_DEBIAN;
+    agents_it->dist_ver = FEED_BUSTER;
+
+    will_return_always(__wrap_sqlite3_bind_text, 0);
+
+    // The conditions of the target are read only once
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
+    expect_value(__wrap_sqlite3_bind_text, pos, 1);
+    expect_string(__wrap_sqlite3_bind_text, buffer, "BUSTER");
+    expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_text, iCol, 0);
+    will_return(__wrap_sqlite3_column_text, "CVE-2020-1234");
+    expect_value(__wrap_sqlite3_column_text, iCol, 1);
+    will_return(__wrap_sqlite3_column_text, "other");
+    expect_value(__wrap_sqlite3_column_text, iCol, 2);
+    will_return(__wrap_sqlite3_column_text, "less than");
+    expect_value(__wrap_sqlite3_column_text, iCol, 3);
+    will_return(__wrap_sqlite3_column_text, "3.0.0");
+    expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_text, iCol, 0);
+    will_return(__wrap_sqlite3_column_text, "CVE-2020-5678");
+    expect_value(__wrap_sqlite3_column_text, iCol, 1);
+    will_return(__wrap_sqlite3_column_text, "package");
+    expect_value(__wrap_sqlite3_column_text, iCol, 2);
+    will_return(__wrap_sqlite3_column_text, "greater than");
+    expect_value(__wrap_sqlite3_column_text, iCol, 3);
+    will_return(__wrap_sqlite3_column_text, "3.0.0");
+    expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_text, iCol, 0);
+    will_return(__wrap_sqlite3_column_text, "CVE-2020-1234");
+    expect_value(__wrap_sqlite3_column_text, iCol, 1);
+    will_return(__wrap_sqlite3_column_text, "package");
+    expect_value(__wrap_sqlite3_column_text, iCol, 2);
+    will_return(__wrap_sqlite3_column_text, "less than");
+    expect_value(__wrap_sqlite3_column_text, iCol, 3);
+    will_return(__wrap_sqlite3_column_text, "3.0.0");
+    expect_sqlite3_step_call(SQLITE_DONE);
+
+    expect_value(__wrap_pkg_version_relate, rel, PKG_RELATION_LT);
+    will_return(__wrap_pkg_version_relate, 0);
+
+    int ret = wm_vuldet_oval_discard_mismatching_cve_entries(db, agents_it, "CVE-2020-1234", pkg_version, pkg_name, vertype);
+    assert_int_equal(ret, VU_NOT_VULNERABLE);
+
+    expect_value(__wrap_pkg_version_relate, rel, PKG_RELATION_GT);
+    will_return(__wrap_pkg_version_relate, 1);
+
+    ret = wm_vuldet_oval_discard_mismatching_cve_entries(db, agents_it, "CVE-2020-5678", pkg_version, pkg_name, vertype);
+    assert_int_equal(ret, VU_VULNERABLE);
+
+    // A feed update drops the index
+    wm_vuldet_cve_index_clean();
+
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
+    expect_value(__wrap_sqlite3_bind_text, pos, 1);
+    expect_string(__wrap_sqlite3_bind_text, buffer, "BUSTER");
+    expect_sqlite3_step_call(SQLITE_DONE);
+
+    ret = wm_vuldet_oval_discard_mismatching_cve_entries(db, agents_it, "CVE-2020-1234", pkg_version, pkg_name, vertype);
+    assert_int_equal(ret, 0);
+}
+
 /* wm_vuldet_build_nvd_report_condition */
 
 void test_wm_vuldet_build_nvd_report_condition_both_including(void **state)
@@ -6421,24 +6467,25 @@ void test_wm_vuldet_process_agent_vulnerabilities_vuln_cves_insert_error(void **
     will_return(__wrap_sqlite3_column_text, "RHSA-2020:0975");
     expect_sqlite3_step_call(SQLITE_DONE);
     //Save the vulnerability in the agent database
-    expect_value(__wrap_wdb_insert_vuln_cves, id, 0);
-    expect_string(__wrap_wdb_insert_vuln_cves, name, "libhogweed4");
-    expect_string(__wrap_wdb_insert_vuln_cves, version, "5.3.4");
-    expect_string(__wrap_wdb_insert_vuln_cves, architecture, "x86_64");
-    expect_string(__wrap_wdb_insert_vuln_cves, cve, "CVE-2016-6489");
-    expect_string(__wrap_wdb_insert_vuln_cves, severity, "High");
-    expect_value(__wrap_wdb_insert_vuln_cves, cvss2_score, 6.9);
-    expect_value(__wrap_wdb_insert_vuln_cves, cvss3_score, 3.6);
-    expect_string(__wrap_wdb_insert_vuln_cves, reference, "e91d3dd01b9214df53c8f3985f028112268d2173");
-    expect_string(__wrap_wdb_insert_vuln_cves, type, VULN_CVES_TYPE_PACKAGE);
-    expect_string(__wrap_wdb_insert_vuln_cves, status, "VALID");
-    expect_value(__wrap_wdb_insert_vuln_cves, check_pkg_existence, TRUE);
-    expect_string(__wrap_wdb_insert_vuln_cves, external_references_concatenated, "http://rhn.redhat.com/errata/RHSA-2016-2582.html");
-    expect_string(__wrap_wdb_insert_vuln_cves, condition, "Package less than 4.3-2");
-    expect_string(__wrap_wdb_insert_vuln_cves, title, "CVE-2016-6489 affects libhogweed4");
-    expect_string(__wrap_wdb_insert_vuln_cves, published, "2017-04-14");
-    expect_string(__wrap_wdb_insert_vuln_cves, updated, "2017-07-01");
-    will_return(__wrap_wdb_insert_vuln_cves, NULL);
+    expect_string(__wrap_wdb_vuln_cves_batch_add, name, "libhogweed4");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, version, "5.3.4");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, architecture, "x86_64");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, cve, "CVE-2016-6489");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, severity, "High");
+    expect_value(__wrap_wdb_vuln_cves_batch_add, cvss2_score, 6.9);
+    expect_value(__wrap_wdb_vuln_cves_batch_add, cvss3_score, 3.6);
+    expect_string(__wrap_wdb_vuln_cves_batch_add, reference, "e91d3dd01b9214df53c8f3985f028112268d2173");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, type, VULN_CVES_TYPE_PACKAGE);
+    expect_string(__wrap_wdb_vuln_cves_batch_add, status, "VALID");
+    expect_value(__wrap_wdb_vuln_cves_batch_add, check_pkg_existence, TRUE);
+    expect_string(__wrap_wdb_vuln_cves_batch_add, external_references_concatenated, "http://rhn.redhat.com/errata/RHSA-2016-2582.html");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, condition, "Package less than 4.3-2");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, title, "CVE-2016-6489 affects libhogweed4");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, published, "2017-04-14");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, updated, "2017-07-01");
+    will_return(__wrap_wdb_vuln_cves_batch_add, 0);
+    expect_value(__wrap_wdb_vuln_cves_batch_flush, id, 0);
+    will_return(__wrap_wdb_vuln_cves_batch_flush, NULL);
 
     configure_wm_vuldet_give_report_format_success();
 
@@ -6488,6 +6535,8 @@ void test_wm_vuldet_process_agent_vulnerabilities_send_cve_report_error(void **s
     scan_ctx.agent_id = 0;
     cJSON* j_status = __real_cJSON_CreateString("SUCCESS");
     cJSON* j_action = __real_cJSON_CreateString("INSERT");
+    cJSON* j_results = __real_cJSON_CreateArray();
+    __real_cJSON_AddItemToArray(j_results, __real_cJSON_CreateObject());
 
     wm_max_eps = 1000000;
 
@@ -6500,24 +6549,25 @@ void test_wm_vuldet_process_agent_vulnerabilities_send_cve_report_error(void **s
         return;
 
     //Save the vulnerability in the agent database
-    expect_value(__wrap_wdb_insert_vuln_cves, id, 0);
-    expect_string(__wrap_wdb_insert_vuln_cves, name, "libhogweed4");
-    expect_string(__wrap_wdb_insert_vuln_cves, version, "5.3.4");
-    expect_string(__wrap_wdb_insert_vuln_cves, architecture, "x86_64");
-    expect_string(__wrap_wdb_insert_vuln_cves, cve, "CVE-2016-6489");
-    expect_string(__wrap_wdb_insert_vuln_cves, severity, "High");
-    expect_value(__wrap_wdb_insert_vuln_cves, cvss2_score, 6.9);
-    expect_value(__wrap_wdb_insert_vuln_cves, cvss3_score, 3.6);
-    expect_string(__wrap_wdb_insert_vuln_cves, reference, "e91d3dd01b9214df53c8f3985f028112268d2173");
-    expect_string(__wrap_wdb_insert_vuln_cves, type, VULN_CVES_TYPE_PACKAGE);
-    expect_string(__wrap_wdb_insert_vuln_cves, status, "VALID");
-    expect_value(__wrap_wdb_insert_vuln_cves, check_pkg_existence, TRUE);
-    expect_string(__wrap_wdb_insert_vuln_cves, external_references_concatenated, "http://rhn.redhat.com/errata/RHSA-2016-2582.html");
-    expect_string(__wrap_wdb_insert_vuln_cves, condition, "Package less than 4.3-2");
-    expect_string(__wrap_wdb_insert_vuln_cves, title, "CVE-2016-6489 affects libhogweed4");
-    expect_string(__wrap_wdb_insert_vuln_cves, published, "2017-04-14");
-    expect_string(__wrap_wdb_insert_vuln_cves, updated, "2017-07-01");
-    will_return(__wrap_wdb_insert_vuln_cves, (cJSON *)1);
+    expect_string(__wrap_wdb_vuln_cves_batch_add, name, "libhogweed4");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, version, "5.3.4");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, architecture, "x86_64");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, cve, "CVE-2016-6489");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, severity, "High");
+    expect_value(__wrap_wdb_vuln_cves_batch_add, cvss2_score, 6.9);
+    expect_value(__wrap_wdb_vuln_cves_batch_add, cvss3_score, 3.6);
+    expect_string(__wrap_wdb_vuln_cves_batch_add, reference, "e91d3dd01b9214df53c8f3985f028112268d2173");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, type, VULN_CVES_TYPE_PACKAGE);
+    expect_string(__wrap_wdb_vuln_cves_batch_add, status, "VALID");
+    expect_value(__wrap_wdb_vuln_cves_batch_add, check_pkg_existence, TRUE);
+    expect_string(__wrap_wdb_vuln_cves_batch_add, external_references_concatenated, "http://rhn.redhat.com/errata/RHSA-2016-2582.html");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, condition, "Package less than 4.3-2");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, title, "CVE-2016-6489 affects libhogweed4");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, published, "2017-04-14");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, updated, "2017-07-01");
+    will_return(__wrap_wdb_vuln_cves_batch_add, 0);
+    expect_value(__wrap_wdb_vuln_cves_batch_flush, id, 0);
+    will_return(__wrap_wdb_vuln_cves_batch_flush, j_results);
 
     configure_wm_vuldet_give_report_format_success();
 
@@ -6670,6 +6720,7 @@ void test_wm_vuldet_process_agent_vulnerabilities_send_cve_report_error(void **s
     os_free(node);
     __real_cJSON_Delete(j_action);
     __real_cJSON_Delete(j_status);
+    __real_cJSON_Delete(j_results);
 }
 
 void test_wm_vuldet_process_agent_vulnerabilities_send_cve_report_negative_version(void **state)
@@ -6682,6 +6733,8 @@ void test_wm_vuldet_process_agent_vulnerabilities_send_cve_report_negative_versi
     scan_ctx.agent_id = 0;
     cJSON* j_status = __real_cJSON_CreateString("SUCCESS");
     cJSON* j_action = __real_cJSON_CreateString("INSERT");
+    cJSON* j_results = __real_cJSON_CreateArray();
+    __real_cJSON_AddItemToArray(j_results, __real_cJSON_CreateObject());
 
     wm_max_eps = 1000000;
 
@@ -6808,24 +6861,25 @@ void test_wm_vuldet_process_agent_vulnerabilities_send_cve_report_negative_versi
     will_return(__wrap_sqlite3_column_text, "RHSA-2020:0975");
     expect_sqlite3_step_call(SQLITE_DONE);
     //Save the vulnerability in the agent database
-    expect_value(__wrap_wdb_insert_vuln_cves, id, 0);
-    expect_string(__wrap_wdb_insert_vuln_cves, name, "libhogweed4");
-    expect_string(__wrap_wdb_insert_vuln_cves, version, "");
-    expect_string(__wrap_wdb_insert_vuln_cves, architecture, "x86_64");
-    expect_string(__wrap_wdb_insert_vuln_cves, cve, "CVE-2016-6489");
-    expect_string(__wrap_wdb_insert_vuln_cves, severity, "High");
-    expect_value(__wrap_wdb_insert_vuln_cves, cvss2_score, 6.9);
-    expect_value(__wrap_wdb_insert_vuln_cves, cvss3_score, 3.6);
-    expect_string(__wrap_wdb_insert_vuln_cves, reference, "e91d3dd01b9214df53c8f3985f028112268d2173");
-    expect_string(__wrap_wdb_insert_vuln_cves, type, "PACKAGE");
-    expect_string(__wrap_wdb_insert_vuln_cves, status, "VALID");
-    expect_value(__wrap_wdb_insert_vuln_cves, check_pkg_existence, TRUE);
-    expect_string(__wrap_wdb_insert_vuln_cves, external_references_concatenated, "http://rhn.redhat.com/errata/RHSA-2016-2582.html");
-    expect_string(__wrap_wdb_insert_vuln_cves, condition, "Package less than 4.3-2");
-    expect_string(__wrap_wdb_insert_vuln_cves, title, "CVE-2016-6489 affects libhogweed4");
-    expect_string(__wrap_wdb_insert_vuln_cves, published, "2017-04-14");
-    expect_string(__wrap_wdb_insert_vuln_cves, updated, "2017-07-01");
-    will_return(__wrap_wdb_insert_vuln_cves, (cJSON *)1);
+    expect_string(__wrap_wdb_vuln_cves_batch_add, name, "libhogweed4");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, version, "");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, architecture, "x86_64");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, cve, "CVE-2016-6489");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, severity, "High");
+    expect_value(__wrap_wdb_vuln_cves_batch_add, cvss2_score, 6.9);
+    expect_value(__wrap_wdb_vuln_cves_batch_add, cvss3_score, 3.6);
+    expect_string(__wrap_wdb_vuln_cves_batch_add, reference, "e91d3dd01b9214df53c8f3985f028112268d2173");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, type, "PACKAGE");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, status, "VALID");
+    expect_value(__wrap_wdb_vuln_cves_batch_add, check_pkg_existence, TRUE);
+    expect_string(__wrap_wdb_vuln_cves_batch_add, external_references_concatenated, "http://rhn.redhat.com/errata/RHSA-2016-2582.html");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, condition, "Package less than 4.3-2");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, title, "CVE-2016-6489 affects libhogweed4");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, published, "2017-04-14");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, updated, "2017-07-01");
+    will_return(__wrap_wdb_vuln_cves_batch_add, 0);
+    expect_value(__wrap_wdb_vuln_cves_batch_flush, id, 0);
+    will_return(__wrap_wdb_vuln_cves_batch_flush, j_results);
 
     configure_wm_vuldet_give_report_format_success();
 
@@ -6866,6 +6920,7 @@ void test_wm_vuldet_process_agent_vulnerabilities_send_cve_report_negative_versi
     os_free(node);
     __real_cJSON_Delete(j_action);
     __real_cJSON_Delete(j_status);
+    __real_cJSON_Delete(j_results);
 }
 
 void test_wm_vuldet_process_agent_vulnerabilities_send_cve_report_adding_data_from_OVAL_error(void **state)
@@ -7017,6 +7072,8 @@ void test_wm_vuldet_process_agent_vulnerabilities_send_cve_report_without_errors
     scan_ctx.agent_id = 0;
     cJSON* j_status = __real_cJSON_CreateString("SUCCESS");
     cJSON* j_action = __real_cJSON_CreateString("INSERT");
+    cJSON* j_results = __real_cJSON_CreateArray();
+    __real_cJSON_AddItemToArray(j_results, __real_cJSON_CreateObject());
 
     if (!vuldet) {
         return;
@@ -7160,24 +7217,25 @@ void test_wm_vuldet_process_agent_vulnerabilities_send_cve_report_without_errors
     expect_sqlite3_step_call(SQLITE_DONE);
 
     //Save the vulnerability in the agent database
-    expect_value(__wrap_wdb_insert_vuln_cves, id, 0);
-    expect_string(__wrap_wdb_insert_vuln_cves, name, "libhogweed4");
-    expect_string(__wrap_wdb_insert_vuln_cves, version, "5.3.4");
-    expect_string(__wrap_wdb_insert_vuln_cves, architecture, "x86_64");
-    expect_string(__wrap_wdb_insert_vuln_cves, cve, "CVE-2016-6489");
-    expect_string(__wrap_wdb_insert_vuln_cves, severity, "High");
-    expect_value(__wrap_wdb_insert_vuln_cves, cvss2_score, 6.9);
-    expect_value(__wrap_wdb_insert_vuln_cves, cvss3_score, 3.6);
-    expect_string(__wrap_wdb_insert_vuln_cves, reference, "e91d3dd01b9214df53c8f3985f028112268d2173");
-    expect_string(__wrap_wdb_insert_vuln_cves, type, "PACKAGE");
-    expect_string(__wrap_wdb_insert_vuln_cves, status, "VALID");
-    expect_value(__wrap_wdb_insert_vuln_cves, check_pkg_existence, TRUE);
-    expect_string(__wrap_wdb_insert_vuln_cves, external_references_concatenated, "http://rhn.redhat.com/errata/RHSA-2016-2582.html");
-    expect_string(__wrap_wdb_insert_vuln_cves, condition, "Package less than 4.3-2");
-    expect_string(__wrap_wdb_insert_vuln_cves, title, "CVE-2016-6489 affects libhogweed4");
-    expect_string(__wrap_wdb_insert_vuln_cves, published, "2017-04-14");
-    expect_string(__wrap_wdb_insert_vuln_cves, updated, "2017-07-01");
-    will_return(__wrap_wdb_insert_vuln_cves, (cJSON *)1);
+    expect_string(__wrap_wdb_vuln_cves_batch_add, name, "libhogweed4");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, version, "5.3.4");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, architecture, "x86_64");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, cve, "CVE-2016-6489");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, severity, "High");
+    expect_value(__wrap_wdb_vuln_cves_batch_add, cvss2_score, 6.9);
+    expect_value(__wrap_wdb_vuln_cves_batch_add, cvss3_score, 3.6);
+    expect_string(__wrap_wdb_vuln_cves_batch_add, reference, "e91d3dd01b9214df53c8f3985f028112268d2173");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, type, "PACKAGE");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, status, "VALID");
+    expect_value(__wrap_wdb_vuln_cves_batch_add, check_pkg_existence, TRUE);
+    expect_string(__wrap_wdb_vuln_cves_batch_add, external_references_concatenated, "http://rhn.redhat.com/errata/RHSA-2016-2582.html");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, condition, "Package less than 4.3-2");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, title, "CVE-2016-6489 affects libhogweed4");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, published, "2017-04-14");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, updated, "2017-07-01");
+    will_return(__wrap_wdb_vuln_cves_batch_add, 0);
+    expect_value(__wrap_wdb_vuln_cves_batch_flush, id, 0);
+    will_return(__wrap_wdb_vuln_cves_batch_flush, j_results);
 
     configure_wm_vuldet_give_report_format_success();
 
@@ -7357,6 +7415,7 @@ void test_wm_vuldet_process_agent_vulnerabilities_send_cve_report_without_errors
     os_free(vuldet);
     __real_cJSON_Delete(j_action);
     __real_cJSON_Delete(j_status);
+    __real_cJSON_Delete(j_results);
 }
 
 void test_wm_vuldet_process_agent_vulnerabilities_send_cve_report_without_errors_NVD(void **state)
@@ -7368,6 +7427,8 @@ void test_wm_vuldet_process_agent_vulnerabilities_send_cve_report_without_errors
     scan_ctx.agent_id = 0;
     cJSON* j_status = __real_cJSON_CreateString("SUCCESS");
     cJSON* j_action = __real_cJSON_CreateString("INSERT");
+    cJSON* j_results = __real_cJSON_CreateArray();
+    __real_cJSON_AddItemToArray(j_results, __real_cJSON_CreateObject());
 
     if (!vuldet) {
         return;
@@ -7512,24 +7573,25 @@ void test_wm_vuldet_process_agent_vulnerabilities_send_cve_report_without_errors
     expect_sqlite3_step_call(SQLITE_DONE);
 
     //Save the vulnerability in the agent database
-    expect_value(__wrap_wdb_insert_vuln_cves, id, 0);
-    expect_string(__wrap_wdb_insert_vuln_cves, name, "libhogweed4");
-    expect_string(__wrap_wdb_insert_vuln_cves, version, "5.3.4");
-    expect_string(__wrap_wdb_insert_vuln_cves, architecture, "x86_64");
-    expect_string(__wrap_wdb_insert_vuln_cves, cve, "CVE-2016-6489");
-    expect_string(__wrap_wdb_insert_vuln_cves, severity, "High");
-    expect_value(__wrap_wdb_insert_vuln_cves, cvss2_score, 6.9);
-    expect_value(__wrap_wdb_insert_vuln_cves, cvss3_score, 3.6);
-    expect_string(__wrap_wdb_insert_vuln_cves, reference, "e91d3dd01b9214df53c8f3985f028112268d2173");
-    expect_string(__wrap_wdb_insert_vuln_cves, type, "PACKAGE");
-    expect_string(__wrap_wdb_insert_vuln_cves, status, "VALID");
-    expect_value(__wrap_wdb_insert_vuln_cves, check_pkg_existence, TRUE);
-    expect_string(__wrap_wdb_insert_vuln_cves, external_references_concatenated, "http://rhn.redhat.com/errata/RHSA-2016-2582.html");
-    expect_string(__wrap_wdb_insert_vuln_cves, condition, "Package matches a vulnerable version");
-    expect_string(__wrap_wdb_insert_vuln_cves, title, "CVE-2016-6489 affects libhogweed4");
-    expect_string(__wrap_wdb_insert_vuln_cves, published, "2017-04-14");
-    expect_string(__wrap_wdb_insert_vuln_cves, updated, "2017-07-01");
-    will_return(__wrap_wdb_insert_vuln_cves, (cJSON *)1);
+    expect_string(__wrap_wdb_vuln_cves_batch_add, name, "libhogweed4");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, version, "5.3.4");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, architecture, "x86_64");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, cve, "CVE-2016-6489");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, severity, "High");
+    expect_value(__wrap_wdb_vuln_cves_batch_add, cvss2_score, 6.9);
+    expect_value(__wrap_wdb_vuln_cves_batch_add, cvss3_score, 3.6);
+    expect_string(__wrap_wdb_vuln_cves_batch_add, reference, "e91d3dd01b9214df53c8f3985f028112268d2173");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, type, "PACKAGE");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, status, "VALID");
+    expect_value(__wrap_wdb_vuln_cves_batch_add, check_pkg_existence, TRUE);
+    expect_string(__wrap_wdb_vuln_cves_batch_add, external_references_concatenated, "http://rhn.redhat.com/errata/RHSA-2016-2582.html");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, condition, "Package matches a vulnerable version");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, title, "CVE-2016-6489 affects libhogweed4");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, published, "2017-04-14");
+    expect_string(__wrap_wdb_vuln_cves_batch_add, updated, "2017-07-01");
+    will_return(__wrap_wdb_vuln_cves_batch_add, 0);
+    expect_value(__wrap_wdb_vuln_cves_batch_flush, id, 0);
+    will_return(__wrap_wdb_vuln_cves_batch_flush, j_results);
 
     configure_wm_vuldet_give_report_format_success();
 
@@ -7709,6 +7771,7 @@ void test_wm_vuldet_process_agent_vulnerabilities_send_cve_report_without_errors
     os_free(vuldet);
     __real_cJSON_Delete(j_action);
     __real_cJSON_Delete(j_status);
+    __real_cJSON_Delete(j_results);
 }
 
 /* wm_vuldet_get_cvss */
@@ -9755,6 +9818,198 @@ void test_wm_vuldet_send_cve_report_sendmsg_error(void **state)
     os_free(strerr);
 }
 
+void test_wm_vuldet_send_cve_report_sendmsg_retry(void **state)
+{
+    vu_report* report = state[REPORT_CVE_REPORT_POS];
+
+    if (OS_INVALID == build_test_cve_report(report, 1, 1, 0))
+        return;
+
+    cJSON* alert = (cJSON *)1;
+    cJSON* alert_cve = (cJSON *)1;
+    cJSON* j_package = (cJSON *)1;
+    cJSON* j_cvss = (cJSON *)1;
+    cJSON* j_cvss_node = (cJSON *)1;
+    cJSON* cvss_json = (cJSON *)1;
+    cJSON* j_advisories = (cJSON *)1;
+
+    char *json_text = NULL;
+    os_strdup("{\"title\": \"vulnerability detector alert json\"}", json_text);
+
+    will_return_always(__wrap_cJSON_AddStringToObject, (cJSON *)1);
+
+    will_return(__wrap_cJSON_CreateObject, alert);
+    will_return(__wrap_cJSON_CreateObject, alert_cve);
+    expect_function_call(__wrap_cJSON_AddItemToObject);
+    will_return(__wrap_cJSON_AddItemToObject, true);
+    // Adding package information
+    will_return(__wrap_cJSON_CreateObject, j_package);
+    expect_function_call(__wrap_cJSON_AddItemToObject);
+    will_return(__wrap_cJSON_AddItemToObject, true);
+    expect_string(__wrap_cJSON_AddStringToObject, name, "name");
+    expect_string(__wrap_cJSON_AddStringToObject, string, report->software);
+    expect_string(__wrap_cJSON_AddStringToObject, name, "source");
+    expect_string(__wrap_cJSON_AddStringToObject, string, report->source);
+    expect_string(__wrap_cJSON_AddStringToObject, name, "version");
+    expect_string(__wrap_cJSON_AddStringToObject, string, report->version);
+    expect_string(__wrap_cJSON_AddStringToObject, name, "architecture");
+    expect_string(__wrap_cJSON_AddStringToObject, string, report->arch);
+    expect_string(__wrap_cJSON_AddStringToObject, name, "condition");
+    expect_string(__wrap_cJSON_AddStringToObject, string, report->condition);
+    // Adding cvss information
+    will_return(__wrap_cJSON_CreateObject, j_cvss);
+    expect_function_call(__wrap_cJSON_AddItemToObject);
+    will_return(__wrap_cJSON_AddItemToObject, true);
+    will_return(__wrap_cJSON_CreateObject, j_cvss_node);
+    expect_function_call(__wrap_cJSON_AddItemToObject);
+    will_return(__wrap_cJSON_AddItemToObject, true);
+    will_return(__wrap_cJSON_CreateObject, cvss_json);
+    expect_string(__wrap_cJSON_AddStringToObject, name, "attack_vector");
+    expect_string(__wrap_cJSON_AddStringToObject, string, "network");
+    expect_string(__wrap_cJSON_AddStringToObject, name, "access_complexity");
+    expect_string(__wrap_cJSON_AddStringToObject, string, "medium");
+    expect_string(__wrap_cJSON_AddStringToObject, name, "authentication");
+    expect_string(__wrap_cJSON_AddStringToObject, string, "none");
+    expect_string(__wrap_cJSON_AddStringToObject, name, "confidentiality_impact");
+    expect_string(__wrap_cJSON_AddStringToObject, string, "none");
+    expect_string(__wrap_cJSON_AddStringToObject, name, "integrity_impact");
+    expect_string(__wrap_cJSON_AddStringToObject, string, "none");
+    expect_string(__wrap_cJSON_AddStringToObject, name, "availability");
+    expect_string(__wrap_cJSON_AddStringToObject, string, "complete");
+    expect_function_call(__wrap_cJSON_AddItemToObject);
+    will_return(__wrap_cJSON_AddItemToObject, true);
+    expect_value(__wrap_cJSON_CreateNumber, num, 7.1);
+    will_return(__wrap_cJSON_CreateNumber, NULL);
+    expect_function_call(__wrap_cJSON_AddItemToObject);
+    will_return(__wrap_cJSON_AddItemToObject, true);
+    expect_value(__wrap_cJSON_CreateNumber, num, 8.6);
+    will_return(__wrap_cJSON_CreateNumber, NULL);
+    expect_function_call(__wrap_cJSON_AddItemToObject);
+    will_return(__wrap_cJSON_AddItemToObject, true);
+    expect_value(__wrap_cJSON_CreateNumber, num, 6.9);
+    will_return(__wrap_cJSON_CreateNumber, NULL);
+    expect_function_call(__wrap_cJSON_AddItemToObject);
+    will_return(__wrap_cJSON_AddItemToObject, true);
+    will_return(__wrap_cJSON_CreateObject, j_cvss_node);
+    expect_function_call(__wrap_cJSON_AddItemToObject);
+    will_return(__wrap_cJSON_AddItemToObject, true);
+    will_return(__wrap_cJSON_CreateObject, cvss_json);
+    expect_string(__wrap_cJSON_AddStringToObject, name, "attack_vector");
+    expect_string(__wrap_cJSON_AddStringToObject, string, "network");
+    expect_string(__wrap_cJSON_AddStringToObject, name, "access_complexity");
+    expect_string(__wrap_cJSON_AddStringToObject, string, "high");
+    expect_string(__wrap_cJSON_AddStringToObject, name, "privileges_required");
+    expect_string(__wrap_cJSON_AddStringToObject, string, "none");
+    expect_string(__wrap_cJSON_AddStringToObject, name, "user_interaction");
+    expect_string(__wrap_cJSON_AddStringToObject, string, "none");
+    expect_string(__wrap_cJSON_AddStringToObject, name, "scope");
+    expect_string(__wrap_cJSON_AddStringToObject, string, "unchanged");
+    expect_string(__wrap_cJSON_AddStringToObject, name, "confidentiality_impact");
+    expect_string(__wrap_cJSON_AddStringToObject, string, "none");
+    expect_string(__wrap_cJSON_AddStringToObject, name, "integrity_impact");
+    expect_string(__wrap_cJSON_AddStringToObject, string, "none");
+    expect_string(__wrap_cJSON_AddStringToObject, name, "availability");
+    expect_string(__wrap_cJSON_AddStringToObject, string, "high");
+    expect_function_call(__wrap_cJSON_AddItemToObject);
+    will_return(__wrap_cJSON_AddItemToObject, true);
+    expect_value(__wrap_cJSON_CreateNumber, num, 5.9);
+    will_return(__wrap_cJSON_CreateNumber, NULL);
+    expect_function_call(__wrap_cJSON_AddItemToObject);
+    will_return(__wrap_cJSON_AddItemToObject, true);
+    expect_value(__wrap_cJSON_CreateNumber, num, 2.2);
+    will_return(__wrap_cJSON_CreateNumber, NULL);
+    expect_function_call(__wrap_cJSON_AddItemToObject);
+    will_return(__wrap_cJSON_AddItemToObject, true);
+    expect_value(__wrap_cJSON_CreateNumber, num, 3.6);
+    will_return(__wrap_cJSON_CreateNumber, NULL);
+    expect_function_call(__wrap_cJSON_AddItemToObject);
+    will_return(__wrap_cJSON_AddItemToObject, true);
+    // Adding CVE information
+    expect_string(__wrap_cJSON_AddStringToObject, name, "cve");
+    expect_string(__wrap_cJSON_AddStringToObject, string, report->cve);
+    expect_string(__wrap_cJSON_AddStringToObject, name, "title");
+    expect_string(__wrap_cJSON_AddStringToObject, string, "CVE-2016-6489 affects libhogweed4");
+    expect_string(__wrap_cJSON_AddStringToObject, name, "rationale");
+    expect_string(__wrap_cJSON_AddStringToObject, string, report->rationale);
+    expect_string(__wrap_cJSON_AddStringToObject, name, "severity");
+    expect_string(__wrap_cJSON_AddStringToObject, string, vu_severities[VU_HIGH]);
+    expect_string(__wrap_cJSON_AddStringToObject, name, "published");
+    expect_string(__wrap_cJSON_AddStringToObject, string, "2020-03-05T15:15:00Z");
+    expect_string(__wrap_cJSON_AddStringToObject, name, "updated");
+    expect_string(__wrap_cJSON_AddStringToObject, string, "2020-05-25T15:15:00Z");
+    expect_string(__wrap_cJSON_AddStringToObject, name, "cwe_reference");
+    expect_string(__wrap_cJSON_AddStringToObject, string, report->cwe);
+
+    expect_string(__wrap_cJSON_AddStringToObject, name, "status");
+    expect_string(__wrap_cJSON_AddStringToObject, string, VULN_CVES_STATUS_ACTIVE_LOWERCASE);
+
+    expect_string(__wrap_cJSON_AddStringToObject, name, "type");
+    expect_string(__wrap_cJSON_AddStringToObject, string, report->type);
+    // Adding advisories data
+    will_return(__wrap_cJSON_CreateArray, j_advisories);
+    expect_string(__wrap_cJSON_CreateString, string, "RHSA-2020:0975");
+    will_return(__wrap_cJSON_CreateString, NULL);
+    expect_function_call(__wrap_cJSON_AddItemToArray);
+    will_return(__wrap_cJSON_AddItemToArray, true);
+    expect_function_call(__wrap_cJSON_AddItemToObject);
+    will_return(__wrap_cJSON_AddItemToObject, true);
+    // Adding bugzilla references data
+    will_return(__wrap_cJSON_CreateArray, j_advisories);
+    expect_string(__wrap_cJSON_CreateString, string, "http://rhn.redhat.org/cgi-bin/bugreport.cgi?bug=925286");
+    will_return(__wrap_cJSON_CreateString, NULL);
+    expect_function_call(__wrap_cJSON_AddItemToArray);
+    will_return(__wrap_cJSON_AddItemToArray, true);
+    expect_function_call(__wrap_cJSON_AddItemToObject);
+    will_return(__wrap_cJSON_AddItemToObject, true);
+    // Adding references data
+    will_return(__wrap_cJSON_CreateArray, j_advisories);
+    expect_string(__wrap_cJSON_CreateString, string, "http://rhn.redhat.com/errata/RHSA-2016-2582.html");
+    will_return(__wrap_cJSON_CreateString, NULL);
+    expect_function_call(__wrap_cJSON_AddItemToArray);
+    will_return(__wrap_cJSON_AddItemToArray, true);
+    expect_function_call(__wrap_cJSON_AddItemToObject);
+    will_return(__wrap_cJSON_AddItemToObject, true);
+    expect_string(__wrap_cJSON_AddStringToObject, name, "assigner");
+    expect_string(__wrap_cJSON_AddStringToObject, string, report->assigner);
+    expect_string(__wrap_cJSON_AddStringToObject, name, "cve_version");
+    expect_string(__wrap_cJSON_AddStringToObject, string, report->cve_version);
+    will_return(__wrap_cJSON_PrintUnformatted, json_text);
+
+    will_return(__wrap_wm_sendmsg, OS_INVALID);
+    expect_value(__wrap_wm_sendmsg, usec, 1000000 / wm_max_eps);
+    expect_value(__wrap_wm_sendmsg, queue, 1);
+    expect_string(__wrap_wm_sendmsg, message, "1:vulnerability-detector:{\"title\": \"vulnerability detector alert json\"}");
+    expect_string(__wrap_wm_sendmsg, locmsg, "[001] (Ubuntu_WAgent) 192.168.0.125");
+    expect_value(__wrap_wm_sendmsg, loc, SECURE_MQ);
+
+    char* strerr = NULL;
+    os_strdup("Error sending message", strerr);
+    will_return(__wrap_strerror, strerr);
+
+    expect_string(__wrap__mterror, tag, "wazuh-modulesd:vulnerability-detector");
+    expect_string(__wrap__mterror, formatted_msg, "(1210): Queue 'queue/sockets/queue' not accessible: 'Error sending message'");
+
+    expect_string(__wrap_StartMQ, path, DEFAULTQUEUE);
+    expect_value(__wrap_StartMQ, type, WRITE);
+    will_return(__wrap_StartMQ, 2);
+
+    // The alert is sent again through the new queue
+    will_return(__wrap_wm_sendmsg, 0);
+    expect_value(__wrap_wm_sendmsg, usec, 1000000 / wm_max_eps);
+    expect_value(__wrap_wm_sendmsg, queue, 2);
+    expect_string(__wrap_wm_sendmsg, message, "1:vulnerability-detector:{\"title\": \"vulnerability detector alert json\"}");
+    expect_string(__wrap_wm_sendmsg, locmsg, "[001] (Ubuntu_WAgent) 192.168.0.125");
+    expect_value(__wrap_wm_sendmsg, loc, SECURE_MQ);
+
+    expect_function_call(__wrap_cJSON_Delete);
+
+    int retval = wm_vuldet_send_cve_report(report);
+
+    assert_int_equal(retval, OS_SUCCESS);
+
+    os_free(strerr);
+}
+
 /* wm_vuldet_extract_advisories */
 
 void test_wm_vuldet_extract_advisories_no_advisories(void **state)
@@ -12824,6 +13079,8 @@ void test_wm_vuldet_json_rh_parser_decode_pkg_version_error(void **state)
 
 /* Test wm_vuldet_oval_process */
 
+#define VU_TEST_OVAL_STREAM "<oval_definitions><definitions><definition/></definitions></oval_definitions>"
+
 void test_wm_vuldet_oval_process_xml_preparser_Ubuntu_fail(void **state)
 {
     update_node *update = NULL;
@@ -12977,7 +13234,17 @@ void test_wm_vuldet_oval_process_xml_preparser_ReadXML_fail_Ubuntu(void **state)
     expect_string(__wrap__mtdebug2, tag, "wazuh-modulesd:vulnerability-detector");
     expect_string(__wrap__mtdebug2, formatted_msg, "(5412): Starting parse step of feed 'UBUNTU'");
 
-    will_return(__wrap_OS_ReadXML_Ex, -1);
+    // stream the fitted file
+    expect_string(__wrap_fopen, path, VU_FIT_TEMP_FILE);
+    expect_string(__wrap_fopen, mode, "r");
+    will_return(__wrap_fopen, 1);
+
+    expect_fread(VU_TEST_OVAL_STREAM, strlen(VU_TEST_OVAL_STREAM));
+
+    expect_value(__wrap_fclose, _File, 1);
+    will_return(__wrap_fclose, 1);
+
+    will_return(__wrap_OS_ReadXMLString_Ex, -1);
 
     expect_string(__wrap__mterror, tag, "wazuh-modulesd:vulnerability-detector");
     expect_string(__wrap__mterror, formatted_msg, "(5502): Could not load the CVE OVAL for 'UBUNTU'. ''");
@@ -13049,7 +13316,17 @@ void test_wm_vuldet_oval_process_xml_preparser_ReadXML_fail_Debian(void **state)
     expect_string(__wrap__mtdebug2, tag, "wazuh-modulesd:vulnerability-detector");
     expect_string(__wrap__mtdebug2, formatted_msg, "(5412): Starting parse step of feed 'DEBIAN'");
 
-    will_return(__wrap_OS_ReadXML_Ex, -1);
+    // stream the fitted file
+    expect_string(__wrap_fopen, path, VU_FIT_TEMP_FILE);
+    expect_string(__wrap_fopen, mode, "r");
+    will_return(__wrap_fopen, 1);
+
+    expect_fread(VU_TEST_OVAL_STREAM, strlen(VU_TEST_OVAL_STREAM));
+
+    expect_value(__wrap_fclose, _File, 1);
+    will_return(__wrap_fclose, 1);
+
+    will_return(__wrap_OS_ReadXMLString_Ex, -1);
 
     expect_string(__wrap__mterror, tag, "wazuh-modulesd:vulnerability-detector");
     expect_string(__wrap__mterror, formatted_msg, "(5502): Could not load the CVE OVAL for 'DEBIAN'. ''");
@@ -13123,7 +13400,17 @@ void test_wm_vuldet_oval_process_xml_preparser_node_NULL_Ubuntu(void **state)
     expect_string(__wrap__mtdebug2, tag, "wazuh-modulesd:vulnerability-detector");
     expect_string(__wrap__mtdebug2, formatted_msg, "(5412): Starting parse step of feed 'UBUNTU'");
 
-    will_return(__wrap_OS_ReadXML_Ex, 1);
+    // stream the fitted file
+    expect_string(__wrap_fopen, path, VU_FIT_TEMP_FILE);
+    expect_string(__wrap_fopen, mode, "r");
+    will_return(__wrap_fopen, 1);
+
+    expect_fread(VU_TEST_OVAL_STREAM, strlen(VU_TEST_OVAL_STREAM));
+
+    expect_value(__wrap_fclose, _File, 1);
+    will_return(__wrap_fclose, 1);
+
+    will_return(__wrap_OS_ReadXMLString_Ex, 1);
 
     will_return(__wrap_OS_GetElementsbyNode, node);
 
@@ -13196,7 +13483,17 @@ void test_wm_vuldet_oval_process_xml_preparser_node_NULL_Debian(void **state)
     expect_string(__wrap__mtdebug2, tag, "wazuh-modulesd:vulnerability-detector");
     expect_string(__wrap__mtdebug2, formatted_msg, "(5412): Starting parse step of feed 'DEBIAN'");
 
-    will_return(__wrap_OS_ReadXML_Ex, 1);
+    // stream the fitted file
+    expect_string(__wrap_fopen, path, VU_FIT_TEMP_FILE);
+    expect_string(__wrap_fopen, mode, "r");
+    will_return(__wrap_fopen, 1);
+
+    expect_fread(VU_TEST_OVAL_STREAM, strlen(VU_TEST_OVAL_STREAM));
+
+    expect_value(__wrap_fclose, _File, 1);
+    will_return(__wrap_fclose, 1);
+
+    will_return(__wrap_OS_ReadXMLString_Ex, 1);
 
     will_return(__wrap_OS_GetElementsbyNode, node);
 
@@ -13272,7 +13569,17 @@ void test_wm_vuldet_oval_process_xml_preparser_child_node_NULL_Ubuntu(void **sta
     expect_string(__wrap__mtdebug2, tag, "wazuh-modulesd:vulnerability-detector");
     expect_string(__wrap__mtdebug2, formatted_msg, "(5412): Starting parse step of feed 'UBUNTU'");
 
-    will_return(__wrap_OS_ReadXML_Ex, 1);
+    // stream the fitted file
+    expect_string(__wrap_fopen, path, VU_FIT_TEMP_FILE);
+    expect_string(__wrap_fopen, mode, "r");
+    will_return(__wrap_fopen, 1);
+
+    expect_fread(VU_TEST_OVAL_STREAM, strlen(VU_TEST_OVAL_STREAM));
+
+    expect_value(__wrap_fclose, _File, 1);
+    will_return(__wrap_fclose, 1);
+
+    will_return(__wrap_OS_ReadXMLString_Ex, 1);
 
     will_return(__wrap_OS_GetElementsbyNode, node);
 
@@ -13350,7 +13657,17 @@ void test_wm_vuldet_oval_process_xml_preparser_child_node_NULL_Debian(void **sta
     expect_string(__wrap__mtdebug2, tag, "wazuh-modulesd:vulnerability-detector");
     expect_string(__wrap__mtdebug2, formatted_msg, "(5412): Starting parse step of feed 'DEBIAN'");
 
-    will_return(__wrap_OS_ReadXML_Ex, 1);
+    // stream the fitted file
+    expect_string(__wrap_fopen, path, VU_FIT_TEMP_FILE);
+    expect_string(__wrap_fopen, mode, "r");
+    will_return(__wrap_fopen, 1);
+
+    expect_fread(VU_TEST_OVAL_STREAM, strlen(VU_TEST_OVAL_STREAM));
+
+    expect_value(__wrap_fclose, _File, 1);
+    will_return(__wrap_fclose, 1);
+
+    will_return(__wrap_OS_ReadXMLString_Ex, 1);
 
     will_return(__wrap_OS_GetElementsbyNode, node);
 
@@ -13433,7 +13750,17 @@ void test_wm_vuldet_oval_process_oval_xml_parser_invalid_Ubuntu(void **state)
     expect_string(__wrap__mtdebug2, tag, "wazuh-modulesd:vulnerability-detector");
     expect_string(__wrap__mtdebug2, formatted_msg, "(5412): Starting parse step of feed 'UBUNTU'");
 
-    will_return(__wrap_OS_ReadXML_Ex, 1);
+    // stream the fitted file
+    expect_string(__wrap_fopen, path, VU_FIT_TEMP_FILE);
+    expect_string(__wrap_fopen, mode, "r");
+    will_return(__wrap_fopen, 1);
+
+    expect_fread(VU_TEST_OVAL_STREAM, strlen(VU_TEST_OVAL_STREAM));
+
+    expect_value(__wrap_fclose, _File, 1);
+    will_return(__wrap_fclose, 1);
+
+    will_return(__wrap_OS_ReadXMLString_Ex, 1);
 
     will_return(__wrap_OS_GetElementsbyNode, node);
 
@@ -13522,7 +13849,17 @@ void test_wm_vuldet_oval_process_oval_xml_parser_invalid_Debian(void **state)
     expect_string(__wrap__mtdebug2, tag, "wazuh-modulesd:vulnerability-detector");
     expect_string(__wrap__mtdebug2, formatted_msg, "(5412): Starting parse step of feed 'DEBIAN'");
 
-    will_return(__wrap_OS_ReadXML_Ex, 1);
+    // stream the fitted file
+    expect_string(__wrap_fopen, path, VU_FIT_TEMP_FILE);
+    expect_string(__wrap_fopen, mode, "r");
+    will_return(__wrap_fopen, 1);
+
+    expect_fread(VU_TEST_OVAL_STREAM, strlen(VU_TEST_OVAL_STREAM));
+
+    expect_value(__wrap_fclose, _File, 1);
+    will_return(__wrap_fclose, 1);
+
+    will_return(__wrap_OS_ReadXMLString_Ex, 1);
 
     will_return(__wrap_OS_GetElementsbyNode, node);
 
@@ -13615,7 +13952,18 @@ void test_wm_vuldet_oval_process_OK_Ubuntu(void **state)
     expect_string(__wrap__mtdebug2, tag, "wazuh-modulesd:vulnerability-detector");
     expect_string(__wrap__mtdebug2, formatted_msg, "(5412): Starting parse step of feed 'UBUNTU'");
 
-    will_return(__wrap_OS_ReadXML_Ex, 1);
+    // stream the fitted file
+    expect_string(__wrap_fopen, path, VU_FIT_TEMP_FILE);
+    expect_string(__wrap_fopen, mode, "r");
+    will_return(__wrap_fopen, 1);
+
+    expect_fread(VU_TEST_OVAL_STREAM, strlen(VU_TEST_OVAL_STREAM));
+    expect_fread("", 0);
+
+    expect_value(__wrap_fclose, _File, 1);
+    will_return(__wrap_fclose, 1);
+
+    will_return(__wrap_OS_ReadXMLString_Ex, 1);
 
     will_return(__wrap_OS_GetElementsbyNode, node);
 
@@ -13702,7 +14050,18 @@ void test_wm_vuldet_oval_process_OK_Debian(void **state)
     expect_string(__wrap__mtdebug2, tag, "wazuh-modulesd:vulnerability-detector");
     expect_string(__wrap__mtdebug2, formatted_msg, "(5412): Starting parse step of feed 'DEBIAN'");
 
-    will_return(__wrap_OS_ReadXML_Ex, 1);
+    // stream the fitted file
+    expect_string(__wrap_fopen, path, VU_FIT_TEMP_FILE);
+    expect_string(__wrap_fopen, mode, "r");
+    will_return(__wrap_fopen, 1);
+
+    expect_fread(VU_TEST_OVAL_STREAM, strlen(VU_TEST_OVAL_STREAM));
+    expect_fread("", 0);
+
+    expect_value(__wrap_fclose, _File, 1);
+    will_return(__wrap_fclose, 1);
+
+    will_return(__wrap_OS_ReadXMLString_Ex, 1);
 
     will_return(__wrap_OS_GetElementsbyNode, node);
 
@@ -13718,6 +14077,33 @@ void test_wm_vuldet_oval_process_OK_Debian(void **state)
     os_free(parsed_vulnerabilities);
 }
 
+void test_wm_vuldet_oval_stream_split_unit(void **state)
+{
+    update_node update = { .dist_tag_ref = FEED_UBUNTU };
+    wm_vuldet_db parsed_oval;
+    vu_oval_reader reader;
+    const char *first = "<?xml version=\"1.0\"?><oval_definitions><!-- c --><tests><!-- x --><te";
+    const char *second = "st id=\"a>b\"/></tests></oval_definitions>";
+
+    memset(&parsed_oval, 0, sizeof(parsed_oval));
+    memset(&reader, 0, sizeof(reader));
+
+    assert_int_equal(wm_vuldet_oval_stream(&reader, first, strlen(first), &parsed_oval, &update), 0);
+    assert_int_equal(reader.depth, 2);
+    assert_string_equal(reader.section, "tests");
+
+    will_return(__wrap_OS_ReadXMLString_Ex, -1);
+
+    expect_string(__wrap__mterror, tag, "wazuh-modulesd:vulnerability-detector");
+    expect_string(__wrap__mterror, formatted_msg, "(5502): Could not load the CVE OVAL for 'UBUNTU'. ''");
+
+    assert_int_equal(wm_vuldet_oval_stream(&reader, second, strlen(second), &parsed_oval, &update), OS_INVALID);
+    assert_string_equal(reader.doc, "<oval_definitions><tests><test id=\"a>b\"/></tests></oval_definitions>");
+
+    os_free(reader.unit);
+    os_free(reader.doc);
+}
+
 // wm_vuldet_oval_xml_parser
 
 void test_wm_vuldet_oval_xml_parser_null_element()
@@ -21113,6 +21499,34 @@ void test_wm_vuldet_update_last_scan_partial_success(void **state)
     wm_vuldet_update_last_scan(&scan_ctx);
 }
 
+void test_wm_vuldet_update_last_scan_feeds_covered(void **state)
+{
+    scan_ctx_t scan_ctx = {0};
+    scan_ctx.agent_id = 0;
+    scan_ctx.scan_type = VU_PARTIAL_SCAN;
+    scan_ctx.feeds_covered = true;
+
+    const char *query = "agent 0 sql UPDATE VULN_METADATA SET LAST_PARTIAL_SCAN='1', LAST_FULL_SCAN='1';";
+    size_t query_size = strlen(query) + 1;
+
+    char *response = "ok";
+    size_t response_size = strlen(response) + 1;
+
+    will_return(__wrap_time, (time_t)1);
+
+    expect_value(__wrap_OS_SendSecureTCP, sock, 1);
+    expect_value(__wrap_OS_SendSecureTCP, size, query_size);
+    expect_string(__wrap_OS_SendSecureTCP, msg, query);
+    will_return(__wrap_OS_SendSecureTCP, 0);
+
+    expect_value(__wrap_OS_RecvSecureTCP, sock, 1);
+    expect_value(__wrap_OS_RecvSecureTCP, size, OS_SIZE_256);
+    will_return(__wrap_OS_RecvSecureTCP, response);
+    will_return(__wrap_OS_RecvSecureTCP, response_size);
+
+    wm_vuldet_update_last_scan(&scan_ctx);
+}
+
 void test_wm_vuldet_update_last_scan_fail(void **state)
 {
     scan_ctx_t scan_ctx = {0};
@@ -22266,6 +22680,39 @@ void test_wm_vuldet_get_software_success() {
     assert_int_equal(result, OS_SUCCESS);
 }
 
+/* wm_vuldet_scan_pool_next */
+
+void test_wm_vuldet_scan_pool_next_skip_done(void **state)
+{
+    scan_agent agents[3] = {{0}};
+    vu_scan_pool pool = { .mutex = PTHREAD_MUTEX_INITIALIZER };
+
+    agents[0].pending_attempts = WM_VULNDETECTOR_MAX_AGENT_SCAN_ATTEMPS;
+    agents[0].next = &agents[1];
+    agents[1].pending_attempts = 0;
+    agents[1].next = &agents[2];
+    agents[2].pending_attempts = 1;
+    pool.next_agent = agents;
+
+    assert_ptr_equal(wm_vuldet_scan_pool_next(&pool), &agents[0]);
+    assert_ptr_equal(wm_vuldet_scan_pool_next(&pool), &agents[2]);
+    assert_null(wm_vuldet_scan_pool_next(&pool));
+    assert_null(pool.next_agent);
+}
+
+void test_wm_vuldet_scan_pool_next_aborted(void **state)
+{
+    scan_agent agent = {0};
+    vu_scan_pool pool = { .mutex = PTHREAD_MUTEX_INITIALIZER };
+
+    agent.pending_attempts = WM_VULNDETECTOR_MAX_AGENT_SCAN_ATTEMPS;
+    pool.next_agent = &agent;
+    pool.abort_scan = true;
+
+    assert_null(wm_vuldet_scan_pool_next(&pool));
+    assert_ptr_equal(pool.next_agent, &agent);
+}
+
 int main(void)
 {
     const struct CMUnitTest tests[] = {
@@ -22402,6 +22849,7 @@ int main(void)
         cmocka_unit_test_setup_teardown(test_wm_vuldet_oval_discard_mismatching_cve_entries_not_vulnerable, setup_scan_agent, teardown_scan_agent),
         cmocka_unit_test_setup_teardown(test_wm_vuldet_oval_discard_mismatching_cve_entries_vulnerable, setup_scan_agent, teardown_scan_agent),
         cmocka_unit_test_setup_teardown(test_wm_vuldet_oval_discard_mismatching_cve_entries_set_error, setup_scan_agent, teardown_scan_agent),
+        cmocka_unit_test_setup_teardown(test_wm_vuldet_oval_discard_mismatching_cve_entries_cached_index, setup_scan_agent, teardown_scan_agent),
         // Tests wm_vuldet_build_nvd_report
         cmocka_unit_test(test_wm_vuldet_build_nvd_report_condition_both_including),
         cmocka_unit_test(test_wm_vuldet_build_nvd_report_condition_both_excluding),
@@ -22500,6 +22948,7 @@ int main(void)
         cmocka_unit_test_setup_teardown(test_wm_vuldet_send_cve_report_without_ip, setup_cve_report, teardown_cve_report),
         cmocka_unit_test_setup_teardown(test_wm_vuldet_send_cve_report_without_hotfix, setup_cve_report, teardown_cve_report),
         cmocka_unit_test_setup_teardown(test_wm_vuldet_send_cve_report_sendmsg_error, setup_cve_report, teardown_cve_report),
+        cmocka_unit_test_setup_teardown(test_wm_vuldet_send_cve_report_sendmsg_retry, setup_cve_report, teardown_cve_report),
         // Tests wm_vuldet_extract_advisories
         cmocka_unit_test(test_wm_vuldet_extract_advisories_no_advisories),
         cmocka_unit_test(test_wm_vuldet_extract_advisories),
@@ -22602,6 +23051,7 @@ int main(void)
         cmocka_unit_test_setup_teardown(test_wm_vuldet_oval_process_oval_xml_parser_invalid_Debian, setup_group, teardown_group),
         cmocka_unit_test_setup_teardown(test_wm_vuldet_oval_process_OK_Ubuntu, setup_group, teardown_group),
         cmocka_unit_test_setup_teardown(test_wm_vuldet_oval_process_OK_Debian, setup_group, teardown_group),
+        cmocka_unit_test(test_wm_vuldet_oval_stream_split_unit),
         // wm_vuldet_oval_xml_parser
         cmocka_unit_test(test_wm_vuldet_oval_xml_parser_null_element),
         cmocka_unit_test(test_wm_vuldet_oval_xml_parser_ubuntu_dpkg_invalid_element),
@@ -22822,6 +23272,7 @@ int main(void)
         // Tests wm_vuldet_update_last_scan
         cmocka_unit_test_setup_teardown(test_wm_vuldet_update_last_scan_full_success, setup_scan_agent, teardown_scan_agent),
         cmocka_unit_test_setup_teardown(test_wm_vuldet_update_last_scan_partial_success, setup_scan_agent, teardown_scan_agent),
+        cmocka_unit_test_setup_teardown(test_wm_vuldet_update_last_scan_feeds_covered, setup_scan_agent, teardown_scan_agent),
         cmocka_unit_test_setup_teardown(test_wm_vuldet_update_last_scan_fail, setup_scan_agent, teardown_scan_agent),
         // Tests wm_vuldet_get_last_scan
         cmocka_unit_test_setup_teardown(test_wm_vuldet_get_last_full_scan_success, setup_scan_agent, teardown_scan_agent),
@@ -22874,6 +23325,9 @@ int main(void)
         cmocka_unit_test_setup_teardown(test_wm_vuldet_insert_deps, setup_parsed_oval_for_deps, teardown_parsed_oval_for_deps),
         cmocka_unit_test_setup_teardown(test_wm_vuldet_insert_deps_prepare_error, setup_parsed_oval_for_deps, teardown_parsed_oval_for_deps),
         cmocka_unit_test_setup_teardown(test_wm_vuldet_insert_deps_step_error, setup_parsed_oval_for_deps, teardown_parsed_oval_for_deps),
+        // Tests wm_vuldet_scan_pool_next
+        cmocka_unit_test(test_wm_vuldet_scan_pool_next_skip_done),
+        cmocka_unit_test(test_wm_vuldet_scan_pool_next_aborted),
         };
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
@@ -27,6 +27,8 @@ bool pkg_version_relate(const struct pkg_version *a, enum pkg_relation rel, cons
 int deb_verrevcmp(const char *a, const char *b, __attribute__((unused)) int revision);
 int nvd_verrevcmp(const char *a, const char *b, int revision);
 
+extern pkg_version_cache_entry *pkg_version_cache;
+
 /* setup/teardown */
 
 static int setup_versions(void **state) {
@@ -61,6 +63,28 @@ static int teardown_versions(void **state) {
     return 0;
 }
 
+static int setup_versions_cache(void **state) {
+    pkg_version_cache_init();
+    return setup_versions(state);
+}
+
+static int teardown_versions_cache(void **state) {
+    pkg_version_cache_free();
+    return teardown_versions(state);
+}
+
+static pkg_version_cache_entry *get_cached_comparison() {
+    int i;
+
+    for (i = 0; pkg_version_cache && i < PKG_VERSION_CACHE_SIZE; i++) {
+        if (pkg_version_cache[i].key) {
+            return &pkg_version_cache[i];
+        }
+    }
+
+    return NULL;
+}
+
 /* tests */
 
 /* order */
@@ -1046,6 +1070,98 @@ void test_nvd_verrevcmp_version_a_truncated_number(void **state)
     assert_int_equal(ret, 0);
 }
 
+/* pkg_version_cache */
+
+void test_pkg_version_cache_disabled(void **state)
+{
+    struct pkg_version *version_a = state[0];
+    struct pkg_version *version_b = state[1];
+
+    version_a->epoch = 0;
+    version_a->version = "1.0";
+    version_a->revision = "1";
+    version_b->epoch = 0;
+    version_b->version = "1.0";
+    version_b->revision = "1";
+
+    int ret = pkg_version_relate(version_a, PKG_RELATION_EQ, version_b, VER_TYPE_RPM);
+    assert_int_equal(ret, 1);
+    assert_null(pkg_version_cache);
+}
+
+void test_pkg_version_cache_hit(void **state)
+{
+    struct pkg_version *version_a = state[0];
+    struct pkg_version *version_b = state[1];
+    pkg_version_cache_entry *entry;
+
+    version_a->epoch = 0;
+    version_a->version = "1.0";
+    version_a->revision = "1";
+    version_b->epoch = 0;
+    version_b->version = "1.0";
+    version_b->revision = "1";
+
+    int ret = pkg_version_relate(version_a, PKG_RELATION_EQ, version_b, VER_TYPE_RPM);
+    assert_int_equal(ret, 1);
+
+    entry = get_cached_comparison();
+    assert_non_null(entry);
+    assert_int_equal(entry->result, 0);
+    assert_int_equal(entry->vertype, VER_TYPE_RPM);
+    assert_int_equal(entry->key_size, sizeof("1.0\0" "1\0" "1.0\0" "1"));
+
+    // The second comparison is answered by the cache
+    entry->result = 1;
+
+    ret = pkg_version_relate(version_a, PKG_RELATION_EQ, version_b, VER_TYPE_RPM);
+    assert_int_equal(ret, 0);
+    ret = pkg_version_relate(version_a, PKG_RELATION_GT, version_b, VER_TYPE_RPM);
+    assert_int_equal(ret, 1);
+}
+
+void test_pkg_version_cache_other_type(void **state)
+{
+    struct pkg_version *version_a = state[0];
+    struct pkg_version *version_b = state[1];
+    pkg_version_cache_entry *entry;
+
+    version_a->epoch = 0;
+    version_a->version = "1.0";
+    version_a->revision = "1";
+    version_b->epoch = 0;
+    version_b->version = "1.0";
+    version_b->revision = "1";
+
+    int ret = pkg_version_relate(version_a, PKG_RELATION_EQ, version_b, VER_TYPE_RPM);
+    assert_int_equal(ret, 1);
+
+    entry = get_cached_comparison();
+    assert_non_null(entry);
+    entry->result = 1;
+
+    // The same versions with another comparator are compared again
+    ret = pkg_version_relate(version_a, PKG_RELATION_EQ, version_b, VER_TYPE_RPM_CENTOS);
+    assert_int_equal(ret, 1);
+}
+
+void test_pkg_version_cache_null_revision(void **state)
+{
+    struct pkg_version *version_a = state[0];
+    struct pkg_version *version_b = state[1];
+
+    version_a->epoch = 0;
+    version_a->version = "1";
+    version_a->revision = NULL;
+    version_b->epoch = 0;
+    version_b->version = "1";
+    version_b->revision = NULL;
+
+    int ret = pkg_version_relate(version_a, PKG_RELATION_EQ, version_b, VER_TYPE_NVD);
+    assert_int_equal(ret, 1);
+    assert_null(get_cached_comparison());
+}
+
 int main(void) {
     const struct CMUnitTest tests[] = {
         //Tests order
@@ -1120,7 +1236,12 @@ int main(void) {
         cmocka_unit_test(test_nvd_verrevcmp_version_a_longer),
         cmocka_unit_test(test_nvd_verrevcmp_version_b_longer),
         cmocka_unit_test(test_nvd_verrevcmp_version_a_truncated),
-        cmocka_unit_test(test_nvd_verrevcmp_version_a_truncated_number)
+        cmocka_unit_test(test_nvd_verrevcmp_version_a_truncated_number),
+        //Tests pkg_version_cache
+        cmocka_unit_test_setup_teardown(test_pkg_version_cache_disabled, setup_versions, teardown_versions),
+        cmocka_unit_test_setup_teardown(test_pkg_version_cache_hit, setup_versions_cache, teardown_versions_cache),
+        cmocka_unit_test_setup_teardown(test_pkg_version_cache_other_type, setup_versions_cache, teardown_versions_cache),
+        cmocka_unit_test_setup_teardown(test_pkg_version_cache_null_revision, setup_versions_cache, teardown_versions_cache)
     };
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
@@ -49,6 +49,7 @@ int wm_vuldet_check_specific_package(sqlite3 *dbCVE,
                                      int *vuln_count);
 int wm_vuldet_get_children(sqlite3 * dbCVE, int configuration_id, int package_id, int *children);
 int wm_vuldet_get_siblings(sqlite3 * dbCVE, int parent, int configuration_id, int *siblings);
+int wm_vuldet_nvd_stream(vu_json_reader *reader, const char *data, size_t length, wm_vuldet_db *parsed_vulnerabilities, update_node *update);
 
 /* setup */
 
@@ -128,6 +129,15 @@ static int teardown_scan_agent(void **state) {
         wm_vuldet_free_scan_agent(agent);
     }
 
+    // Force the NVD configuration index to be read again in the next test
+    wm_vuldet_nvd_index_clean();
+
+    return 0;
+}
+
+static int teardown_nvd_index(void **state) {
+    wm_vuldet_nvd_index_clean();
+
     return 0;
 }
 
@@ -138,6 +148,8 @@ static int teardown_children(void **state) {
         free(children);
     }
 
+    wm_vuldet_nvd_index_clean();
+
     return 0;
 }
 
@@ -148,6 +160,8 @@ static int teardown_siblings(void **state) {
         free(siblings);
     }
 
+    wm_vuldet_nvd_index_clean();
+
     return 0;
 }
 
@@ -214,13 +228,40 @@ void test_wm_vuldet_get_children_prepare_error(void **state)
 
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_ERROR);
     will_return(__wrap_sqlite3_errmsg, "error");
+    expect_string(__wrap__mterror, tag, "wazuh-modulesd:vulnerability-detector");
+    expect_string(__wrap__mterror, formatted_msg, "(5503): SQL error: 'error'");
+
+    will_return(__wrap_sqlite3_close_v2, SQLITE_OK);
+
     expect_string(__wrap__mterror, tag, "wazuh-modulesd:vulnerability-detector");
     expect_string(__wrap__mterror, formatted_msg, "(5571): Couldn't get from the NVD the 'children' dependencies of the package with ID '0'");
+
+    int ret = wm_vuldet_get_children(db, configuration_id, package_id, children);
+    assert_int_equal(ret, -1);
+}
+
+void test_wm_vuldet_get_children_conf_error(void **state)
+{
+    sqlite3 *db = (sqlite3 *)1;
+    int configuration_id = 0;
+    int package_id = 0;
+    int *children = state[0];
+
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
+    expect_sqlite3_step_call(SQLITE_DONE);
+
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
+    expect_sqlite3_step_call(SQLITE_ERROR);
+
+    will_return(__wrap_sqlite3_errmsg, "error");
     expect_string(__wrap__mterror, tag, "wazuh-modulesd:vulnerability-detector");
     expect_string(__wrap__mterror, formatted_msg, "(5503): SQL error: 'error'");
 
     will_return(__wrap_sqlite3_close_v2, SQLITE_OK);
 
+    expect_string(__wrap__mterror, tag, "wazuh-modulesd:vulnerability-detector");
+    expect_string(__wrap__mterror, formatted_msg, "(5571): Couldn't get from the NVD the 'children' dependencies of the package with ID '0'");
+
     int ret = wm_vuldet_get_children(db, configuration_id, package_id, children);
     assert_int_equal(ret, -1);
 }
@@ -234,46 +275,64 @@ void test_wm_vuldet_get_children_done(void **state)
     int *children = state[0];
 
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
+    expect_sqlite3_step_call(SQLITE_DONE);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
-
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
     expect_sqlite3_step_call(SQLITE_DONE);
 
     int ret = wm_vuldet_get_children(db, configuration_id, package_id, children);
     assert_int_equal(ret, 0);
+    assert_int_equal(children[0], 0);
 }
 
 void test_wm_vuldet_get_children_OK(void **state)
 {
     sqlite3 *db = (sqlite3 *)1;
-    int configuration_id = 0;
-    int package_id = 0;
-
-    int *children = state[0];
+    int configuration_id = 2;
+    int package_id = 5;
+    int children[MAX_RELATED_PKGS] = {0};
 
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
+    expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 3);
+
+    expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 2);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 4);
 
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 2);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 5);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
-    will_return(__wrap_sqlite3_column_int, 1);
+    will_return(__wrap_sqlite3_column_int, 2);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 6);
+
+    expect_sqlite3_step_call(SQLITE_DONE);
 
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
     expect_sqlite3_step_call(SQLITE_DONE);
 
     int ret = wm_vuldet_get_children(db, configuration_id, package_id, children);
     assert_int_equal(ret, 0);
+    assert_int_equal(children[0], 4);
+    assert_int_equal(children[1], 6);
+    assert_int_equal(children[2], 0);
+
+    // The index is reused in the next lookups
+    ret = wm_vuldet_get_children(db, 1, 0, children);
+    assert_int_equal(ret, 0);
+    assert_int_equal(children[0], 3);
 }
 
 /* wm_vuldet_get_siblings */
@@ -289,13 +348,14 @@ void test_wm_vuldet_get_siblings_prepare_error(void **state)
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_ERROR);
     will_return(__wrap_sqlite3_errmsg, "error");
     expect_string(__wrap__mterror, tag, "wazuh-modulesd:vulnerability-detector");
-    expect_string(__wrap__mterror, formatted_msg, "(5571): Couldn't get from the NVD the 'siblings' dependencies of the package with ID '0'");
-    expect_string(__wrap__mterror, tag, "wazuh-modulesd:vulnerability-detector");
     expect_string(__wrap__mterror, formatted_msg, "(5503): SQL error: 'error'");
 
     will_return(__wrap_sqlite3_close_v2, SQLITE_OK);
 
-    int ret = wm_vuldet_get_siblings(db, configuration_id, parent, siblings);
+    expect_string(__wrap__mterror, tag, "wazuh-modulesd:vulnerability-detector");
+    expect_string(__wrap__mterror, formatted_msg, "(5571): Couldn't get from the NVD the 'siblings' dependencies of the package with ID '0'");
+
+    int ret = wm_vuldet_get_siblings(db, parent, configuration_id, siblings);
     assert_int_equal(ret, -1);
 }
 
@@ -308,46 +368,59 @@ void test_wm_vuldet_get_siblings_done(void **state)
     int *siblings = state[0];
 
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
+    expect_sqlite3_step_call(SQLITE_DONE);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
-
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
     expect_sqlite3_step_call(SQLITE_DONE);
 
-    int ret = wm_vuldet_get_siblings(db, configuration_id, parent, siblings);
+    int ret = wm_vuldet_get_siblings(db, parent, configuration_id, siblings);
     assert_int_equal(ret, 0);
+    assert_int_equal(siblings[0], 0);
 }
 
 void test_wm_vuldet_get_siblings_OK(void **state)
 {
     sqlite3 *db = (sqlite3 *)1;
-    int configuration_id = 0;
-    int parent = 0;
+    int configuration_id = 11;
+    int parent = 10;
+    int siblings[MAX_RELATED_PKGS] = {0};
 
-    int *siblings = state[0];
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
+    expect_sqlite3_step_call(SQLITE_DONE);
 
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
+    expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 10);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 11);
+
+    expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 10);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 12);
 
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 10);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 13);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
-    will_return(__wrap_sqlite3_column_int, 1);
+    will_return(__wrap_sqlite3_column_int, 20);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 21);
 
     expect_sqlite3_step_call(SQLITE_DONE);
 
-    int ret = wm_vuldet_get_siblings(db, configuration_id, parent, siblings);
+    int ret = wm_vuldet_get_siblings(db, parent, configuration_id, siblings);
     assert_int_equal(ret, 0);
+    assert_int_equal(siblings[0], 12);
+    assert_int_equal(siblings[1], 13);
+    assert_int_equal(siblings[2], 0);
 }
 
 /* test vw_vuldet_filter_vulnerabilities */
@@ -1566,23 +1639,27 @@ void test_wm_vuldet_check_generic_package_no_starts_no_ends_children(void **stat
     expect_value(__wrap_sqlite3_column_text, iCol, 11);
     will_return(__wrap_sqlite3_column_text, "*");       //target_sw
 
-//Children
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
-
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 0);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 0);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 0);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
     will_return(__wrap_sqlite3_column_int, 1);
 
     expect_sqlite3_step_call(SQLITE_DONE);
 
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
+
+    expect_sqlite3_step_call(SQLITE_DONE);
+
     will_return(__wrap_wm_vuldet_add_cve_node,0);
     expect_string(__wrap__mtdebug2, tag, "wazuh-modulesd:vulnerability-detector");
     expect_string(__wrap__mtdebug2, formatted_msg, "(5458): Package 'test' inserted into the vulnerability 'CVE-0000-0000'. Version (0.0.0) 'equals' '*' (feed 'NVD').");
@@ -1733,16 +1810,17 @@ void test_wm_vuldet_check_generic_package_children_invalid(void **state)
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Children
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_ERROR);
     will_return(__wrap_sqlite3_errmsg, "error");
     expect_string(__wrap__mterror, tag, "wazuh-modulesd:vulnerability-detector");
-    expect_string(__wrap__mterror, formatted_msg, "(5571): Couldn't get from the NVD the 'children' dependencies of the package with ID '0'");
-    expect_string(__wrap__mterror, tag, "wazuh-modulesd:vulnerability-detector");
     expect_string(__wrap__mterror, formatted_msg, "(5503): SQL error: 'error'");
 
     will_return(__wrap_sqlite3_close_v2, SQLITE_OK);
 
+    expect_string(__wrap__mterror, tag, "wazuh-modulesd:vulnerability-detector");
+    expect_string(__wrap__mterror, formatted_msg, "(5571): Couldn't get from the NVD the 'children' dependencies of the package with ID '0'");
+
     int ret = wm_vuldet_check_generic_package(db,
                                               FEED_DEBIAN,
                                               pkg_name,
@@ -1812,23 +1890,27 @@ void test_wm_vuldet_check_generic_package_children_OK(void **state)
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Children
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
-
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 0);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 0);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 0);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
     will_return(__wrap_sqlite3_column_int, 1);
 
     expect_sqlite3_step_call(SQLITE_DONE);
 
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
+
+    expect_sqlite3_step_call(SQLITE_DONE);
+
     will_return(__wrap_wm_vuldet_add_cve_node,0);
     expect_string(__wrap__mtdebug2, tag, "wazuh-modulesd:vulnerability-detector");
     expect_string(__wrap__mtdebug2, formatted_msg, "(5458): Package 'test' inserted into the vulnerability 'CVE-0000-0000'. Version (1.0.0) 'less than or equal' '1.0.0' (feed 'NVD').");
@@ -1904,16 +1986,17 @@ void test_wm_vuldet_check_generic_package_siblings_invalid(void **state)
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Siblings
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_ERROR);
     will_return(__wrap_sqlite3_errmsg, "error");
     expect_string(__wrap__mterror, tag, "wazuh-modulesd:vulnerability-detector");
-    expect_string(__wrap__mterror, formatted_msg, "(5571): Couldn't get from the NVD the 'siblings' dependencies of the package with ID '0'");
-    expect_string(__wrap__mterror, tag, "wazuh-modulesd:vulnerability-detector");
     expect_string(__wrap__mterror, formatted_msg, "(5503): SQL error: 'error'");
 
     will_return(__wrap_sqlite3_close_v2, SQLITE_OK);
 
+    expect_string(__wrap__mterror, tag, "wazuh-modulesd:vulnerability-detector");
+    expect_string(__wrap__mterror, formatted_msg, "(5571): Couldn't get from the NVD the 'siblings' dependencies of the package with ID '0'");
+
     int ret = wm_vuldet_check_generic_package(db,
                                               FEED_DEBIAN,
                                               pkg_name,
@@ -1983,19 +2066,23 @@ void test_wm_vuldet_check_generic_package_siblings_OK(void **state)
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Siblings
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 1000);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
+    expect_sqlite3_step_call(SQLITE_DONE);
+
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 0);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
     will_return(__wrap_sqlite3_column_int, 1);
 
     expect_sqlite3_step_call(SQLITE_DONE);
@@ -2142,19 +2229,23 @@ void test_wm_vuldet_check_generic_package_insert_package_error(void **state)
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Siblings
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 1000);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
+    expect_sqlite3_step_call(SQLITE_DONE);
+
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 0);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
     will_return(__wrap_sqlite3_column_int, 1);
 
     expect_sqlite3_step_call(SQLITE_DONE);
@@ -2234,19 +2325,23 @@ void test_wm_vuldet_check_generic_package_duplicated_package(void **state)
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Siblings
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 1000);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
+    expect_sqlite3_step_call(SQLITE_DONE);
+
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 0);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
     will_return(__wrap_sqlite3_column_int, 1);
 
     expect_sqlite3_step_call(SQLITE_DONE);
@@ -2326,19 +2421,23 @@ void test_wm_vuldet_check_generic_package_insert_package_OK(void **state)
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Siblings
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 1000);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
+    expect_sqlite3_step_call(SQLITE_DONE);
+
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 0);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
     will_return(__wrap_sqlite3_column_int, 1);
 
     expect_sqlite3_step_call(SQLITE_DONE);
@@ -2421,19 +2520,23 @@ void test_wm_vuldet_check_generic_package_insert_package_Ubuntu(void **state)
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Siblings
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 1000);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
+    expect_sqlite3_step_call(SQLITE_DONE);
+
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 0);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
     will_return(__wrap_sqlite3_column_int, 1);
 
     expect_sqlite3_step_call(SQLITE_DONE);
@@ -2516,19 +2619,23 @@ void test_wm_vuldet_check_generic_package_insert_package_Debian(void **state)
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Siblings
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 1000);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
+    expect_sqlite3_step_call(SQLITE_DONE);
+
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 0);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
     will_return(__wrap_sqlite3_column_int, 1);
 
     expect_sqlite3_step_call(SQLITE_DONE);
@@ -2611,19 +2718,23 @@ void test_wm_vuldet_check_generic_package_insert_package_RedHat(void **state)
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Siblings
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 1000);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
+    expect_sqlite3_step_call(SQLITE_DONE);
+
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 0);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
     will_return(__wrap_sqlite3_column_int, 1);
 
     expect_sqlite3_step_call(SQLITE_DONE);
@@ -2706,19 +2817,23 @@ void test_wm_vuldet_check_generic_package_insert_package_Arch(void **state)
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Siblings
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 1000);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
+    expect_sqlite3_step_call(SQLITE_DONE);
+
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 0);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
     will_return(__wrap_sqlite3_column_int, 1);
 
     expect_sqlite3_step_call(SQLITE_DONE);
@@ -2801,19 +2916,23 @@ void test_wm_vuldet_check_generic_package_insert_package_linux_kernel(void **sta
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Siblings
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 1000);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
+    expect_sqlite3_step_call(SQLITE_DONE);
+
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 0);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
     will_return(__wrap_sqlite3_column_int, 1);
 
     expect_sqlite3_step_call(SQLITE_DONE);
@@ -2893,19 +3012,23 @@ void test_wm_vuldet_check_generic_package_insert_package_mac_os_x(void **state)
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Siblings
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 1000);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
+    expect_sqlite3_step_call(SQLITE_DONE);
+
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 0);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
     will_return(__wrap_sqlite3_column_int, 1);
 
     expect_sqlite3_step_call(SQLITE_DONE);
@@ -2985,19 +3108,23 @@ void test_wm_vuldet_check_generic_package_insert_package_mac_os_x_server(void **
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Siblings
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 1000);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
+    expect_sqlite3_step_call(SQLITE_DONE);
+
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 0);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
     will_return(__wrap_sqlite3_column_int, 1);
 
     expect_sqlite3_step_call(SQLITE_DONE);
@@ -3077,19 +3204,23 @@ void test_wm_vuldet_check_generic_package_insert_package_mac_os(void **state)
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Siblings
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 1000);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
+    expect_sqlite3_step_call(SQLITE_DONE);
+
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 0);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
     will_return(__wrap_sqlite3_column_int, 1);
 
     expect_sqlite3_step_call(SQLITE_DONE);
@@ -3169,19 +3300,23 @@ void test_wm_vuldet_check_generic_package_insert_package_macos(void **state)
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Siblings
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 1000);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
+    expect_sqlite3_step_call(SQLITE_DONE);
+
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 0);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
     will_return(__wrap_sqlite3_column_int, 1);
 
     expect_sqlite3_step_call(SQLITE_DONE);
@@ -3267,19 +3402,23 @@ void test_wm_vuldet_check_generic_package_insert_package_mac_no_vendor(void **st
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Siblings
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 1000);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
+    expect_sqlite3_step_call(SQLITE_DONE);
+
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 0);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
     will_return(__wrap_sqlite3_column_int, 1);
 
     expect_sqlite3_step_call(SQLITE_DONE);
@@ -3365,19 +3504,23 @@ void test_wm_vuldet_check_generic_package_insert_package_mac_with_vendor(void **
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Siblings
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 1000);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
+    expect_sqlite3_step_call(SQLITE_DONE);
+
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 0);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
     will_return(__wrap_sqlite3_column_int, 1);
 
     expect_sqlite3_step_call(SQLITE_DONE);
@@ -3875,16 +4018,17 @@ void test_wm_vuldet_check_specific_package_children_invalid(void **state)
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Children
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_ERROR);
     will_return(__wrap_sqlite3_errmsg, "error");
     expect_string(__wrap__mterror, tag, "wazuh-modulesd:vulnerability-detector");
-    expect_string(__wrap__mterror, formatted_msg, "(5571): Couldn't get from the NVD the 'children' dependencies of the package with ID '0'");
-    expect_string(__wrap__mterror, tag, "wazuh-modulesd:vulnerability-detector");
     expect_string(__wrap__mterror, formatted_msg, "(5503): SQL error: 'error'");
 
     will_return(__wrap_sqlite3_close_v2, SQLITE_OK);
 
+    expect_string(__wrap__mterror, tag, "wazuh-modulesd:vulnerability-detector");
+    expect_string(__wrap__mterror, formatted_msg, "(5571): Couldn't get from the NVD the 'children' dependencies of the package with ID '0'");
+
     int ret = wm_vuldet_check_specific_package(db,
                                                FEED_DEBIAN,
                                                pkg_name,
@@ -3949,23 +4093,27 @@ void test_wm_vuldet_check_specific_package_children_OK(void **state)
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Children
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
-
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 0);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 0);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 0);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
     will_return(__wrap_sqlite3_column_int, 1);
 
     expect_sqlite3_step_call(SQLITE_DONE);
 
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
+
+    expect_sqlite3_step_call(SQLITE_DONE);
+
     will_return(__wrap_wm_vuldet_add_cve_node,0);
     expect_string(__wrap__mtdebug2, tag, "wazuh-modulesd:vulnerability-detector");
     expect_string(__wrap__mtdebug2, formatted_msg, "(5458): Package 'test' inserted into the vulnerability 'CVE-0000-0000'. Version (0.0.0) 'equals' '0.0.0' (feed 'NVD').");
@@ -4036,16 +4184,17 @@ void test_wm_vuldet_check_specific_package_siblings_invalid(void **state)
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Siblings
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_ERROR);
     will_return(__wrap_sqlite3_errmsg, "error");
     expect_string(__wrap__mterror, tag, "wazuh-modulesd:vulnerability-detector");
-    expect_string(__wrap__mterror, formatted_msg, "(5571): Couldn't get from the NVD the 'siblings' dependencies of the package with ID '0'");
-    expect_string(__wrap__mterror, tag, "wazuh-modulesd:vulnerability-detector");
     expect_string(__wrap__mterror, formatted_msg, "(5503): SQL error: 'error'");
 
     will_return(__wrap_sqlite3_close_v2, SQLITE_OK);
 
+    expect_string(__wrap__mterror, tag, "wazuh-modulesd:vulnerability-detector");
+    expect_string(__wrap__mterror, formatted_msg, "(5571): Couldn't get from the NVD the 'siblings' dependencies of the package with ID '0'");
+
     int ret = wm_vuldet_check_specific_package(db,
                                                FEED_DEBIAN,
                                                pkg_name,
@@ -4110,19 +4259,23 @@ void test_wm_vuldet_check_specific_package_siblings_OK(void **state)
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Siblings
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 1000);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
+    expect_sqlite3_step_call(SQLITE_DONE);
+
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 0);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
     will_return(__wrap_sqlite3_column_int, 1);
 
     expect_sqlite3_step_call(SQLITE_DONE);
@@ -4200,19 +4353,23 @@ void test_wm_vuldet_check_specific_package_os_package_valid(void **state)
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Siblings
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 1000);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
+    expect_sqlite3_step_call(SQLITE_DONE);
+
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 0);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
     will_return(__wrap_sqlite3_column_int, 1);
 
     expect_sqlite3_step_call(SQLITE_DONE);
@@ -4356,19 +4513,23 @@ void test_wm_vuldet_check_specific_package_insert_package_error(void **state)
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Siblings
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 1000);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
+    expect_sqlite3_step_call(SQLITE_DONE);
+
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 0);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
     will_return(__wrap_sqlite3_column_int, 1);
 
     expect_sqlite3_step_call(SQLITE_DONE);
@@ -4443,19 +4604,23 @@ void test_wm_vuldet_check_specific_package_duplicated_package(void **state)
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Siblings
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 1000);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
+    expect_sqlite3_step_call(SQLITE_DONE);
+
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 0);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
     will_return(__wrap_sqlite3_column_int, 1);
 
     expect_sqlite3_step_call(SQLITE_DONE);
@@ -4530,19 +4695,23 @@ void test_wm_vuldet_check_specific_package_insert_package_OK(void **state)
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Siblings
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 1000);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
+    expect_sqlite3_step_call(SQLITE_DONE);
+
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 0);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
     will_return(__wrap_sqlite3_column_int, 1);
 
     expect_sqlite3_step_call(SQLITE_DONE);
@@ -4620,19 +4789,23 @@ void test_wm_vuldet_check_specific_package_insert_package_Ubuntu(void **state)
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Siblings
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 1000);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
+    expect_sqlite3_step_call(SQLITE_DONE);
+
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 0);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
     will_return(__wrap_sqlite3_column_int, 1);
 
     expect_sqlite3_step_call(SQLITE_DONE);
@@ -4710,19 +4883,23 @@ void test_wm_vuldet_check_specific_package_insert_package_Debian(void **state)
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Siblings
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 1000);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
+    expect_sqlite3_step_call(SQLITE_DONE);
+
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 0);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
     will_return(__wrap_sqlite3_column_int, 1);
 
     expect_sqlite3_step_call(SQLITE_DONE);
@@ -4800,19 +4977,23 @@ void test_wm_vuldet_check_specific_package_insert_package_Arch(void **state)
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Siblings
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 1000);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
+    expect_sqlite3_step_call(SQLITE_DONE);
+
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 0);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
     will_return(__wrap_sqlite3_column_int, 1);
 
     expect_sqlite3_step_call(SQLITE_DONE);
@@ -4890,19 +5071,23 @@ void test_wm_vuldet_check_specific_package_insert_package_RedHat(void **state)
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Siblings
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 1000);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
+    expect_sqlite3_step_call(SQLITE_DONE);
+
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 0);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
     will_return(__wrap_sqlite3_column_int, 1);
 
     expect_sqlite3_step_call(SQLITE_DONE);
@@ -4980,19 +5165,23 @@ void test_wm_vuldet_check_specific_package_insert_package_linux_kernel(void **st
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Siblings
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 1000);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
+    expect_sqlite3_step_call(SQLITE_DONE);
+
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 0);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
     will_return(__wrap_sqlite3_column_int, 1);
 
     expect_sqlite3_step_call(SQLITE_DONE);
@@ -5067,19 +5256,23 @@ void test_wm_vuldet_check_specific_package_insert_package_mac_os_x(void **state)
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Siblings
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 1000);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
+    expect_sqlite3_step_call(SQLITE_DONE);
+
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 0);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
     will_return(__wrap_sqlite3_column_int, 1);
 
     expect_sqlite3_step_call(SQLITE_DONE);
@@ -5154,19 +5347,23 @@ void test_wm_vuldet_check_specific_package_insert_package_mac_os_x_server(void *
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Siblings
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 1000);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
+    expect_sqlite3_step_call(SQLITE_DONE);
+
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 0);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
     will_return(__wrap_sqlite3_column_int, 1);
 
     expect_sqlite3_step_call(SQLITE_DONE);
@@ -5241,19 +5438,23 @@ void test_wm_vuldet_check_specific_package_insert_package_mac_os(void **state)
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Siblings
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 1000);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
+    expect_sqlite3_step_call(SQLITE_DONE);
+
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 0);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
     will_return(__wrap_sqlite3_column_int, 1);
 
     expect_sqlite3_step_call(SQLITE_DONE);
@@ -5328,19 +5529,23 @@ void test_wm_vuldet_check_specific_package_insert_package_macos(void **state)
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Siblings
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 1000);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
+    expect_sqlite3_step_call(SQLITE_DONE);
+
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 0);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
     will_return(__wrap_sqlite3_column_int, 1);
 
     expect_sqlite3_step_call(SQLITE_DONE);
@@ -5421,19 +5626,23 @@ void test_wm_vuldet_check_specific_package_insert_package_mac_no_vendor(void **s
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Siblings
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 1000);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
+    expect_sqlite3_step_call(SQLITE_DONE);
+
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 0);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
     will_return(__wrap_sqlite3_column_int, 1);
 
     expect_sqlite3_step_call(SQLITE_DONE);
@@ -5514,19 +5723,23 @@ void test_wm_vuldet_check_specific_package_insert_package_mac_with_vendor(void *
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Siblings
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 1000);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
+    expect_sqlite3_step_call(SQLITE_DONE);
+
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 0);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
     will_return(__wrap_sqlite3_column_int, 1);
 
     expect_sqlite3_step_call(SQLITE_DONE);
@@ -5779,19 +5992,23 @@ void test_wm_vuldet_linux_nvd_vulnerabilities_source_specific_invalid(void **sta
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Siblings
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 1000);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
+    expect_sqlite3_step_call(SQLITE_DONE);
+
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 0);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
     will_return(__wrap_sqlite3_column_int, 1);
 
     expect_sqlite3_step_call(SQLITE_DONE);
@@ -6017,19 +6234,23 @@ void test_wm_vuldet_linux_nvd_vulnerabilities_source_vulnerable(void **state)
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Siblings
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 1000);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
+    expect_sqlite3_step_call(SQLITE_DONE);
+
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 0);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
     will_return(__wrap_sqlite3_column_int, 1);
 
     expect_sqlite3_step_call(SQLITE_DONE);
@@ -6216,19 +6437,23 @@ void test_wm_vuldet_linux_nvd_vulnerabilities_name_specific_invalid(void **state
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Siblings
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 1000);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
+    expect_sqlite3_step_call(SQLITE_DONE);
+
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 0);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
     will_return(__wrap_sqlite3_column_int, 1);
 
     expect_sqlite3_step_call(SQLITE_DONE);
@@ -6454,19 +6679,23 @@ void test_wm_vuldet_linux_nvd_vulnerabilities_name_vulnerable(void **state)
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Siblings
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 1000);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
+    expect_sqlite3_step_call(SQLITE_DONE);
+
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 0);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
     will_return(__wrap_sqlite3_column_int, 1);
 
     expect_sqlite3_step_call(SQLITE_DONE);
@@ -6603,19 +6832,23 @@ void test_wm_vuldet_linux_nvd_vulnerabilities_pkg_source_version_NULL(void **sta
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Siblings
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 1000);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
+    expect_sqlite3_step_call(SQLITE_DONE);
+
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 0);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
     will_return(__wrap_sqlite3_column_int, 1);
 
     expect_sqlite3_step_call(SQLITE_DONE);
@@ -6753,19 +6986,23 @@ void test_wm_vuldet_linux_nvd_vulnerabilities_os_pkg_mac(void **state)
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Siblings
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 1000);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
+    expect_sqlite3_step_call(SQLITE_DONE);
+
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 0);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
     will_return(__wrap_sqlite3_column_int, 1);
 
     expect_sqlite3_step_call(SQLITE_DONE);
@@ -6905,19 +7142,23 @@ void test_wm_vuldet_linux_nvd_vulnerabilities_app_pkg_mac_no_vendor(void **state
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Siblings
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 1000);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
+    expect_sqlite3_step_call(SQLITE_DONE);
+
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 0);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
     will_return(__wrap_sqlite3_column_int, 1);
 
     expect_sqlite3_step_call(SQLITE_DONE);
@@ -7067,19 +7308,23 @@ void test_wm_vuldet_linux_nvd_vulnerabilities_app_pkg_mac_with_vendor(void **sta
 
     will_return(__wrap_wm_checks_package_vulnerability, VU_VULNERABLE);
 
-    //Siblings
+    //NVD configuration index
     will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
-    expect_value(__wrap_sqlite3_bind_int, index, 1);
-    expect_value(__wrap_sqlite3_bind_int, value, 1000);
-    will_return(__wrap_sqlite3_bind_int, 0);
-    expect_value(__wrap_sqlite3_bind_int, index, 2);
-    expect_value(__wrap_sqlite3_bind_int, value, 0);
-    will_return(__wrap_sqlite3_bind_int, 0);
+    expect_sqlite3_step_call(SQLITE_DONE);
+
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
 
     expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 0);
 
+    expect_sqlite3_step_call(SQLITE_ROW);
     expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 1000);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
     will_return(__wrap_sqlite3_column_int, 1);
 
     expect_sqlite3_step_call(SQLITE_DONE);
@@ -7148,6 +7393,31 @@ void test_wm_vuldet_linux_nvd_vulnerabilities_app_pkg_mac_with_vendor(void **sta
     assert_int_equal(ret, 0);
 }
 
+// Tests wm_vuldet_nvd_stream
+
+void test_wm_vuldet_nvd_stream_invalid_item(void **state)
+{
+    update_node update = { .dist_ref = FEED_NVD };
+    wm_vuldet_db parsed_vulnerabilities;
+    vu_json_reader reader;
+    const char *first = "{\"CVE_data_type\" : \"CVE\", \"CVE_Items\" : [ {\"cve\" : \"}{]";
+    const char *second = "\\\"\",} ] }";
+
+    memset(&parsed_vulnerabilities, 0, sizeof(parsed_vulnerabilities));
+    memset(&reader, 0, sizeof(reader));
+
+    assert_int_equal(wm_vuldet_nvd_stream(&reader, first, strlen(first), &parsed_vulnerabilities, &update), 0);
+    assert_int_equal(reader.items_depth, 2);
+    assert_true(reader.capturing);
+
+    // The item is cut out of the feed, but it is not valid JSON
+    assert_int_equal(wm_vuldet_nvd_stream(&reader, second, strlen(second), &parsed_vulnerabilities, &update), OS_INVALID);
+    assert_string_equal(reader.item, "{\"cve\" : \"}{]\\\"\",}");
+    assert_int_equal(parsed_vulnerabilities.insert.nvd_cves, 0);
+
+    os_free(reader.item);
+}
+
 /* Tests */
 
 int main(void) {
@@ -7159,6 +7429,7 @@ int main(void) {
         cmocka_unit_test_setup_teardown(test_wm_vuldet_clean_version_no_epoch_release, setup_version, teardown_version),
         //Tests wm_vuldet_get_children
         cmocka_unit_test_setup_teardown(test_wm_vuldet_get_children_prepare_error, setup_children, teardown_children),
+        cmocka_unit_test_setup_teardown(test_wm_vuldet_get_children_conf_error, setup_children, teardown_children),
         cmocka_unit_test_setup_teardown(test_wm_vuldet_get_children_done, setup_children, teardown_children),
         cmocka_unit_test_setup_teardown(test_wm_vuldet_get_children_OK, setup_children, teardown_children),
         //Tests wm_vuldet_get_siblings
@@ -7178,71 +7449,71 @@ int main(void) {
         cmocka_unit_test(test_vw_vuldet_filter_vulnerabilities_vendor_target_sw_mac_OK),
         cmocka_unit_test(test_vw_vuldet_filter_vulnerabilities_vendor_target_sw_mac_Err),
         //Tests wm_vuldet_check_generic_package
-        cmocka_unit_test(test_wm_vuldet_check_generic_package_prepare_error),
-        cmocka_unit_test(test_wm_vuldet_check_generic_package_done),
-        cmocka_unit_test(test_wm_vuldet_check_generic_package_skip),
-        cmocka_unit_test(test_wm_vuldet_check_generic_package_start_including_no_vulnerable),
-        cmocka_unit_test(test_wm_vuldet_check_generic_package_start_including_vulnerable),
-        cmocka_unit_test(test_wm_vuldet_check_generic_package_start_excluding_no_vulnerable),
-        cmocka_unit_test(test_wm_vuldet_check_generic_package_start_excluding_vulnerable),
-        cmocka_unit_test(test_wm_vuldet_check_generic_package_no_starts_no_vulnerable),
-        cmocka_unit_test(test_wm_vuldet_check_generic_package_no_starts_vulnerable),
-        cmocka_unit_test(test_wm_vuldet_check_generic_package_end_including_no_vulnerable),
-        cmocka_unit_test(test_wm_vuldet_check_generic_package_end_including_vulnerable),
-        cmocka_unit_test(test_wm_vuldet_check_generic_package_end_excluding_no_vulnerable),
-        cmocka_unit_test(test_wm_vuldet_check_generic_package_end_excluding_vulnerable),
-        cmocka_unit_test(test_wm_vuldet_check_generic_package_no_ends_no_vulnerable),
-        cmocka_unit_test(test_wm_vuldet_check_generic_package_no_ends_vulnerable),
-        cmocka_unit_test(test_wm_vuldet_check_generic_package_no_starts_no_ends_children),
-        cmocka_unit_test(test_wm_vuldet_check_generic_package_no_children_no_siblings),
-        cmocka_unit_test(test_wm_vuldet_check_generic_package_children_invalid),
-        cmocka_unit_test(test_wm_vuldet_check_generic_package_children_OK),
-        cmocka_unit_test(test_wm_vuldet_check_generic_package_siblings_invalid),
-        cmocka_unit_test(test_wm_vuldet_check_generic_package_siblings_OK),
-        cmocka_unit_test(test_wm_vuldet_check_generic_package_ignore_package),
-        cmocka_unit_test(test_wm_vuldet_check_generic_package_insert_package_error),
-        cmocka_unit_test(test_wm_vuldet_check_generic_package_duplicated_package),
-        cmocka_unit_test(test_wm_vuldet_check_generic_package_insert_package_OK),
-        cmocka_unit_test(test_wm_vuldet_check_generic_package_insert_package_Ubuntu),
-        cmocka_unit_test(test_wm_vuldet_check_generic_package_insert_package_Debian),
-        cmocka_unit_test(test_wm_vuldet_check_generic_package_insert_package_RedHat),
-        cmocka_unit_test(test_wm_vuldet_check_generic_package_insert_package_Arch),
-        cmocka_unit_test(test_wm_vuldet_check_generic_package_insert_package_linux_kernel),
-        cmocka_unit_test(test_wm_vuldet_check_generic_package_insert_package_mac_os_x),
-        cmocka_unit_test(test_wm_vuldet_check_generic_package_insert_package_mac_os_x_server),
-        cmocka_unit_test(test_wm_vuldet_check_generic_package_insert_package_mac_os),
-        cmocka_unit_test(test_wm_vuldet_check_generic_package_insert_package_macos),
-        cmocka_unit_test(test_wm_vuldet_check_generic_package_insert_package_mac_no_vendor),
-        cmocka_unit_test(test_wm_vuldet_check_generic_package_insert_package_mac_with_vendor),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_generic_package_prepare_error, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_generic_package_done, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_generic_package_skip, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_generic_package_start_including_no_vulnerable, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_generic_package_start_including_vulnerable, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_generic_package_start_excluding_no_vulnerable, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_generic_package_start_excluding_vulnerable, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_generic_package_no_starts_no_vulnerable, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_generic_package_no_starts_vulnerable, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_generic_package_end_including_no_vulnerable, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_generic_package_end_including_vulnerable, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_generic_package_end_excluding_no_vulnerable, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_generic_package_end_excluding_vulnerable, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_generic_package_no_ends_no_vulnerable, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_generic_package_no_ends_vulnerable, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_generic_package_no_starts_no_ends_children, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_generic_package_no_children_no_siblings, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_generic_package_children_invalid, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_generic_package_children_OK, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_generic_package_siblings_invalid, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_generic_package_siblings_OK, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_generic_package_ignore_package, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_generic_package_insert_package_error, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_generic_package_duplicated_package, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_generic_package_insert_package_OK, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_generic_package_insert_package_Ubuntu, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_generic_package_insert_package_Debian, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_generic_package_insert_package_RedHat, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_generic_package_insert_package_Arch, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_generic_package_insert_package_linux_kernel, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_generic_package_insert_package_mac_os_x, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_generic_package_insert_package_mac_os_x_server, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_generic_package_insert_package_mac_os, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_generic_package_insert_package_macos, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_generic_package_insert_package_mac_no_vendor, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_generic_package_insert_package_mac_with_vendor, teardown_nvd_index),
         //Tests wm_vuldet_check_specific_package
-        cmocka_unit_test(test_wm_vuldet_check_specific_package_pkg_version_NULL),
-        cmocka_unit_test(test_wm_vuldet_check_specific_package_pkg_version_empty),
-        cmocka_unit_test(test_wm_vuldet_check_specific_package_prepare_error),
-        cmocka_unit_test(test_wm_vuldet_check_specific_package_done),
-        cmocka_unit_test(test_wm_vuldet_check_specific_package_skip),
-        cmocka_unit_test(test_wm_vuldet_check_specific_package_no_vulnerable),
-        cmocka_unit_test(test_wm_vuldet_check_specific_package_vulnerable),
-        cmocka_unit_test(test_wm_vuldet_check_specific_package_no_children_no_siblings),
-        cmocka_unit_test(test_wm_vuldet_check_specific_package_children_invalid),
-        cmocka_unit_test(test_wm_vuldet_check_specific_package_children_OK),
-        cmocka_unit_test(test_wm_vuldet_check_specific_package_siblings_invalid),
-        cmocka_unit_test(test_wm_vuldet_check_specific_package_siblings_OK),
-        cmocka_unit_test(test_wm_vuldet_check_specific_package_os_package_valid),
-        cmocka_unit_test(test_wm_vuldet_check_specific_package_ignore_package),
-        cmocka_unit_test(test_wm_vuldet_check_specific_package_insert_package_error),
-        cmocka_unit_test(test_wm_vuldet_check_specific_package_duplicated_package),
-        cmocka_unit_test(test_wm_vuldet_check_specific_package_insert_package_OK),
-        cmocka_unit_test(test_wm_vuldet_check_specific_package_insert_package_Ubuntu),
-        cmocka_unit_test(test_wm_vuldet_check_specific_package_insert_package_Debian),
-        cmocka_unit_test(test_wm_vuldet_check_specific_package_insert_package_Arch),
-        cmocka_unit_test(test_wm_vuldet_check_specific_package_insert_package_RedHat),
-        cmocka_unit_test(test_wm_vuldet_check_specific_package_insert_package_linux_kernel),
-        cmocka_unit_test(test_wm_vuldet_check_specific_package_insert_package_mac_os_x),
-        cmocka_unit_test(test_wm_vuldet_check_specific_package_insert_package_mac_os_x_server),
-        cmocka_unit_test(test_wm_vuldet_check_specific_package_insert_package_mac_os),
-        cmocka_unit_test(test_wm_vuldet_check_specific_package_insert_package_macos),
-        cmocka_unit_test(test_wm_vuldet_check_specific_package_insert_package_mac_no_vendor),
-        cmocka_unit_test(test_wm_vuldet_check_specific_package_insert_package_mac_with_vendor),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_specific_package_pkg_version_NULL, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_specific_package_pkg_version_empty, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_specific_package_prepare_error, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_specific_package_done, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_specific_package_skip, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_specific_package_no_vulnerable, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_specific_package_vulnerable, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_specific_package_no_children_no_siblings, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_specific_package_children_invalid, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_specific_package_children_OK, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_specific_package_siblings_invalid, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_specific_package_siblings_OK, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_specific_package_os_package_valid, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_specific_package_ignore_package, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_specific_package_insert_package_error, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_specific_package_duplicated_package, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_specific_package_insert_package_OK, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_specific_package_insert_package_Ubuntu, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_specific_package_insert_package_Debian, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_specific_package_insert_package_Arch, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_specific_package_insert_package_RedHat, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_specific_package_insert_package_linux_kernel, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_specific_package_insert_package_mac_os_x, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_specific_package_insert_package_mac_os_x_server, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_specific_package_insert_package_mac_os, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_specific_package_insert_package_macos, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_specific_package_insert_package_mac_no_vendor, teardown_nvd_index),
+        cmocka_unit_test_teardown(test_wm_vuldet_check_specific_package_insert_package_mac_with_vendor, teardown_nvd_index),
         //Tests wm_vuldet_linux_nvd_vulnerabilities
         cmocka_unit_test_setup_teardown(test_wm_vuldet_linux_nvd_vulnerabilities_prepare_error, setup_scan_agent, teardown_scan_agent),
         cmocka_unit_test_setup_teardown(test_wm_vuldet_linux_nvd_vulnerabilities_done, setup_scan_agent, teardown_scan_agent),
@@ -7259,6 +7530,8 @@ int main(void) {
         cmocka_unit_test_setup_teardown(test_wm_vuldet_linux_nvd_vulnerabilities_os_pkg_mac, setup_scan_agent, teardown_scan_agent),
         cmocka_unit_test_setup_teardown(test_wm_vuldet_linux_nvd_vulnerabilities_app_pkg_mac_no_vendor, setup_scan_agent, teardown_scan_agent),
         cmocka_unit_test_setup_teardown(test_wm_vuldet_linux_nvd_vulnerabilities_app_pkg_mac_with_vendor, setup_scan_agent, teardown_scan_agent),
+        // Tests wm_vuldet_nvd_stream
+        cmocka_unit_test(test_wm_vuldet_nvd_stream_invalid_item),
     };
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
@@ -56,6 +56,53 @@ cJSON* __wrap_wdb_insert_vuln_cves(int id,
     return mock_ptr_type(cJSON*);
 }
 
+int __wrap_wdb_vuln_cves_batch_add(__attribute__((unused)) wdb_vuln_cves_batch *batch,
+                                   const char *name,
+                                   const char *version,
+                                   const char *architecture,
+                                   const char *cve,
+                                   const char *severity,
+                                   double cvss2_score,
+                                   double cvss3_score,
+                                   const char *reference,
+                                   const char *type,
+                                   const char *status,
+                                   char **external_references,
+                                   const char *condition,
+                                   const char *title,
+                                   const char *published,
+                                   const char *updated,
+                                   bool check_pkg_existence) {
+    check_expected(name);
+    check_expected(version);
+    check_expected(architecture);
+    check_expected(cve);
+    check_expected(severity);
+    check_expected(cvss2_score);
+    check_expected(cvss3_score);
+    check_expected(reference);
+    check_expected(type);
+    check_expected(status);
+
+    char* external_references_concatenated = w_strcat_list(external_references, ',');
+    check_expected(external_references_concatenated);
+    os_free(external_references_concatenated);
+
+    check_expected(condition);
+    check_expected(title);
+    check_expected(published);
+    check_expected(updated);
+    check_expected(check_pkg_existence);
+    return mock_type(int);
+}
+
+cJSON* __wrap_wdb_vuln_cves_batch_flush(int id,
+                                        __attribute__((unused)) wdb_vuln_cves_batch *batch,
+                                        __attribute__((unused)) int *sock) {
+    check_expected(id);
+    return mock_ptr_type(cJSON*);
+}
+
 cJSON* __wrap_wdb_remove_vuln_cves_by_status(int id,
                                              const char *status,
                                              __attribute__((unused)) int *sock) {
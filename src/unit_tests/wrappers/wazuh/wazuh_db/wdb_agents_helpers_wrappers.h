@@ -12,6 +12,7 @@
 #define WDB_AGENTS_HELPERS_WRAPPERS_H
 
 #include "wazuh_db/wdb.h"
+#include "wazuh_db/helpers/wdb_agents_helpers.h"
 
 cJSON* __wrap_wdb_insert_vuln_cves(int id,
                                    const char *name,
@@ -32,6 +33,28 @@ cJSON* __wrap_wdb_insert_vuln_cves(int id,
                                    bool check_pkg_existence,
                                    __attribute__((unused)) int *sock);
 
+int __wrap_wdb_vuln_cves_batch_add(wdb_vuln_cves_batch *batch,
+                                   const char *name,
+                                   const char *version,
+                                   const char *architecture,
+                                   const char *cve,
+                                   const char *severity,
+                                   double cvss2_score,
+                                   double cvss3_score,
+                                   const char *reference,
+                                   const char *type,
+                                   const char *status,
+                                   char **external_references,
+                                   const char *condition,
+                                   const char *title,
+                                   const char *published,
+                                   const char *updated,
+                                   bool check_pkg_existence);
+
+cJSON* __wrap_wdb_vuln_cves_batch_flush(int id,
+                                        wdb_vuln_cves_batch *batch,
+                                        int *sock);
+
 cJSON* __wrap_wdb_remove_vuln_cves_by_status(int id,
                                              const char *status,
                                              __attribute__((unused)) int *sock);
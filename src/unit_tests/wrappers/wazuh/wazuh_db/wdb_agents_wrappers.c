@@ -55,6 +55,12 @@ int __wrap_wdb_agents_update_vuln_cves_status(__attribute__((unused)) wdb_t *wdb
     return mock();
 }
 
+int __wrap_wdb_agents_update_vuln_cves_status_by_reference(__attribute__((unused)) wdb_t *wdb, const char* reference, const char* new_status) {
+    check_expected(reference);
+    check_expected(new_status);
+    return mock();
+}
+
 int __wrap_wdb_agents_remove_vuln_cves(__attribute__((unused)) wdb_t *wdb, const char* cve, const char* reference) {
     check_expected(cve);
     check_expected(reference);
@@ -28,6 +28,7 @@ cJSON* __wrap_wdb_agents_insert_vuln_cves(wdb_t *wdb,
                                           double cvss2_score,
                                           double cvss3_score);
 int __wrap_wdb_agents_update_vuln_cves_status(wdb_t *wdb, const char* old_status, const char* new_status, const char* type);
+int __wrap_wdb_agents_update_vuln_cves_status_by_reference(wdb_t *wdb, const char* reference, const char* new_status);
 int __wrap_wdb_agents_remove_vuln_cves(wdb_t *wdb, const char* cve, const char* reference);
 wdbc_result __wrap_wdb_agents_remove_vuln_cves_by_status(wdb_t *wdb, const char* status, char **output);
 bool __wrap_wdb_agents_find_package(wdb_t *wdb, const char* reference);
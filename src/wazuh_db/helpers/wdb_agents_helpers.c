@@ -16,6 +16,7 @@ static const char *agents_db_commands[] = {
     [WDB_AGENTS_SYS_OSINFO_GET] = "agent %d osinfo get",
     [WDB_AGENTS_SYS_OSINFO_SET_TRIAGGED] = "agent %d osinfo set_triaged",
     [WDB_AGENTS_VULN_CVES_INSERT] = "agent %d vuln_cves insert %s",
+    [WDB_AGENTS_VULN_CVES_INSERT_BATCH] = "agent %d vuln_cves insert_batch %s]",
     [WDB_AGENTS_VULN_CVES_UPDATE_STATUS] = "agent %d vuln_cves update_status %s",
     [WDB_AGENTS_VULN_CVES_REMOVE] = "agent %d vuln_cves remove %s",
 };
@@ -89,29 +90,28 @@ int wdb_set_agent_sys_osinfo_triaged(int id,
     return result;
 }
 
-cJSON* wdb_insert_vuln_cves(int id,
-                            const char *name,
-                            const char *version,
-                            const char *architecture,
-                            const char *cve,
-                            const char *severity,
-                            double cvss2_score,
-                            double cvss3_score,
-                            const char *reference,
-                            const char *type,
-                            const char *status,
-                            char **external_references,
-                            const char *condition,
-                            const char *title,
-                            const char *published,
-                            const char *updated,
-                            bool check_pkg_existence,
-                            int *sock) {
+/**
+ * @brief Builds the JSON object of a vuln_cves insert request.
+ *
+ * @return The cJSON object, or NULL on error. It must be freed by the caller.
+ */
+static cJSON* wdb_vuln_cves_data(const char *name,
+                                 const char *version,
+                                 const char *architecture,
+                                 const char *cve,
+                                 const char *severity,
+                                 double cvss2_score,
+                                 double cvss3_score,
+                                 const char *reference,
+                                 const char *type,
+                                 const char *status,
+                                 char **external_references,
+                                 const char *condition,
+                                 const char *title,
+                                 const char *published,
+                                 const char *updated,
+                                 bool check_pkg_existence) {
     cJSON *data_in = NULL;
-    char *data_in_str = NULL;
-    char *wdbquery = NULL;
-    char *wdboutput = NULL;
-    int aux_sock = -1;
 
     data_in = cJSON_CreateObject();
     if (!data_in) {
@@ -157,6 +157,39 @@ cJSON* wdb_insert_vuln_cves(int id,
         os_free(str_cvs_references);
     }
 
+    return data_in;
+}
+
+cJSON* wdb_insert_vuln_cves(int id,
+                            const char *name,
+                            const char *version,
+                            const char *architecture,
+                            const char *cve,
+                            const char *severity,
+                            double cvss2_score,
+                            double cvss3_score,
+                            const char *reference,
+                            const char *type,
+                            const char *status,
+                            char **external_references,
+                            const char *condition,
+                            const char *title,
+                            const char *published,
+                            const char *updated,
+                            bool check_pkg_existence,
+                            int *sock) {
+    cJSON *data_in = NULL;
+    char *data_in_str = NULL;
+    char *wdbquery = NULL;
+    char *wdboutput = NULL;
+    int aux_sock = -1;
+
+    data_in = wdb_vuln_cves_data(name, version, architecture, cve, severity, cvss2_score, cvss3_score, reference, type, status,
+                                 external_references, condition, title, published, updated, check_pkg_existence);
+    if (!data_in) {
+        return NULL;
+    }
+
     data_in_str = cJSON_PrintUnformatted(data_in);
     os_malloc(WDB_MAX_QUERY_SIZE, wdbquery);
     snprintf(wdbquery, WDB_MAX_QUERY_SIZE, agents_db_commands[WDB_AGENTS_VULN_CVES_INSERT], id, data_in_str);
@@ -180,6 +213,105 @@ cJSON* wdb_insert_vuln_cves(int id,
     return result;
 }
 
+int wdb_vuln_cves_batch_add(wdb_vuln_cves_batch *batch,
+                            const char *name,
+                            const char *version,
+                            const char *architecture,
+                            const char *cve,
+                            const char *severity,
+                            double cvss2_score,
+                            double cvss3_score,
+                            const char *reference,
+                            const char *type,
+                            const char *status,
+                            char **external_references,
+                            const char *condition,
+                            const char *title,
+                            const char *published,
+                            const char *updated,
+                            bool check_pkg_existence) {
+    cJSON *data_in = NULL;
+    char *data_in_str = NULL;
+    size_t length;
+
+    if (batch->count >= WDB_VULN_CVES_BATCH_MAX) {
+        return 1;
+    }
+
+    data_in = wdb_vuln_cves_data(name, version, architecture, cve, severity, cvss2_score, cvss3_score, reference, type, status,
+                                 external_references, condition, title, published, updated, check_pkg_existence);
+    if (!data_in) {
+        return OS_INVALID;
+    }
+
+    data_in_str = cJSON_PrintUnformatted(data_in);
+    cJSON_Delete(data_in);
+
+    if (!data_in_str) {
+        return OS_INVALID;
+    }
+
+    length = strlen(data_in_str);
+
+    // An entry that doesn't fit in an empty batch is sent alone anyway
+    if (batch->count && batch->length + length + 2 >= WDB_MAX_QUERY_SIZE) {
+        os_free(data_in_str);
+        return 1;
+    }
+
+    os_realloc(batch->entries, batch->length + length + 2, batch->entries);
+    batch->entries[batch->length++] = batch->count ? ',' : '[';
+    memcpy(batch->entries + batch->length, data_in_str, length + 1);
+    batch->length += length;
+    batch->count++;
+
+    os_free(data_in_str);
+
+    return 0;
+}
+
+cJSON* wdb_vuln_cves_batch_flush(int id,
+                                 wdb_vuln_cves_batch *batch,
+                                 int *sock) {
+    char *wdbquery = NULL;
+    char *wdboutput = NULL;
+    cJSON *result = NULL;
+    int aux_sock = -1;
+    int count = batch->count;
+
+    if (!count) {
+        return NULL;
+    }
+
+    os_malloc(OS_MAXSTR, wdbquery);
+    snprintf(wdbquery, OS_MAXSTR, agents_db_commands[WDB_AGENTS_VULN_CVES_INSERT_BATCH], id, batch->entries);
+
+    os_free(batch->entries);
+    batch->length = 0;
+    batch->count = 0;
+
+    os_malloc(WDBOUTPUT_SIZE, wdboutput);
+    result = wdbc_query_parse_json(sock?sock:&aux_sock, wdbquery, wdboutput, WDBOUTPUT_SIZE);
+
+    os_free(wdbquery);
+    os_free(wdboutput);
+
+    if (!sock) {
+        wdbc_close(&aux_sock);
+    }
+
+    if (result && (!cJSON_IsArray(result) || cJSON_GetArraySize(result) != count)) {
+        cJSON_Delete(result);
+        result = NULL;
+    }
+
+    if (!result) {
+        merror("Agents DB (%d) Error querying Wazuh DB to insert a batch of %d vuln_cves", id, count);
+    }
+
+    return result;
+}
+
 int wdb_update_vuln_cves_status(int id,
                                 const char *old_status,
                                 const char *new_status,
@@ -298,6 +430,65 @@ int wdb_update_vuln_cves_status_by_type(int id,
     return result;
 }
 
+int wdb_update_vuln_cves_status_by_reference(int id,
+                                             const char *reference,
+                                             const char *new_status,
+                                             int *sock) {
+    int result = 0;
+    cJSON *data_in = NULL;
+    char *data_in_str = NULL;
+    char *wdbquery = NULL;
+    char *wdboutput = NULL;
+    char *payload = NULL;
+    int aux_sock = -1;
+
+    data_in = cJSON_CreateObject();
+
+    if (!data_in) {
+        mdebug1("Error creating data JSON for Wazuh DB.");
+        return OS_INVALID;
+    }
+
+    cJSON_AddStringToObject(data_in, "reference", reference);
+    cJSON_AddStringToObject(data_in, "new_status", new_status);
+
+    data_in_str = cJSON_PrintUnformatted(data_in);
+    os_malloc(WDBQUERY_SIZE, wdbquery);
+    snprintf(wdbquery, WDBQUERY_SIZE, agents_db_commands[WDB_AGENTS_VULN_CVES_UPDATE_STATUS], id, data_in_str);
+
+    os_malloc(WDBOUTPUT_SIZE, wdboutput);
+    result = wdbc_query_ex(sock?sock:&aux_sock, wdbquery, wdboutput, WDBOUTPUT_SIZE);
+
+    switch (result) {
+        case OS_SUCCESS:
+            if (WDBC_OK != wdbc_parse_result(wdboutput, &payload)) {
+                mdebug1("Agents DB (%d) Error reported in the result of the query", id);
+                result = OS_INVALID;
+            }
+            break;
+        case OS_INVALID:
+            mdebug1("Agents DB (%d) Error in the response from socket", id);
+            mdebug2("Agents DB (%d) SQL query: %s", id, wdbquery);
+            result = OS_INVALID;
+            break;
+        default:
+            mdebug1("Agents DB (%d) Cannot execute SQL query", id);
+            mdebug2("Agents DB (%d) SQL query: %s", id, wdbquery);
+            result = OS_INVALID;
+    }
+
+    if (!sock) {
+        wdbc_close(&aux_sock);
+    }
+
+    cJSON_Delete(data_in);
+    os_free(data_in_str);
+    os_free(wdbquery);
+    os_free(wdboutput);
+
+    return result;
+}
+
 cJSON* wdb_remove_vuln_cves_by_status(int id,
                                       const char *status,
                                       int *sock) {
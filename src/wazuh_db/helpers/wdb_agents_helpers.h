@@ -18,10 +18,22 @@ typedef enum agents_db_access {
     WDB_AGENTS_SYS_OSINFO_GET,
     WDB_AGENTS_SYS_OSINFO_SET_TRIAGGED,
     WDB_AGENTS_VULN_CVES_INSERT,
+    WDB_AGENTS_VULN_CVES_INSERT_BATCH,
     WDB_AGENTS_VULN_CVES_REMOVE,
     WDB_AGENTS_VULN_CVES_UPDATE_STATUS
 } agents_db_access;
 
+#define WDB_VULN_CVES_BATCH_MAX 256     // Limited by the size of the response with the result of every entry
+
+/**
+ * @brief Vulnerabilities pending to be inserted in an agent's database with a single request.
+ */
+typedef struct wdb_vuln_cves_batch {
+    char *entries;      ///< JSON array with the vulnerabilities, without the closing bracket
+    size_t length;      ///< Length of the entries string
+    int count;          ///< Number of vulnerabilities in the batch
+} wdb_vuln_cves_batch;
+
 /**
  * @brief Gets the sys_osinfo table data of the specified agent's database.
  *
@@ -91,6 +103,47 @@ cJSON* wdb_insert_vuln_cves(int id,
                             bool check_pkg_existence,
                             int *sock);
 
+/**
+ * @brief Adds a vulnerability to a batch to be inserted in the vuln_cves table by wdb_vuln_cves_batch_flush.
+ *        The parameters are the same as in wdb_insert_vuln_cves.
+ *
+ * @param[in] batch The batch where the vulnerability is added.
+ * @return Returns 0 if the vulnerability was added, 1 if the batch is full and must be flushed before adding it
+ *         or OS_INVALID if the vulnerability data could not be built.
+ */
+int wdb_vuln_cves_batch_add(wdb_vuln_cves_batch *batch,
+                            const char *name,
+                            const char *version,
+                            const char *architecture,
+                            const char *cve,
+                            const char *severity,
+                            double cvss2_score,
+                            double cvss3_score,
+                            const char *reference,
+                            const char *type,
+                            const char *status,
+                            char **external_references,
+                            const char *condition,
+                            const char *title,
+                            const char *published,
+                            const char *updated,
+                            bool check_pkg_existence);
+
+/**
+ * @brief Inserts or updates all the vulnerabilities of a batch in the vuln_cves table with a single request.
+ *        The batch is emptied, whatever the result.
+ *
+ * @param[in] id The agent ID.
+ * @param[in] batch The batch of vulnerabilities.
+ * @param[in] sock The Wazuh DB socket connection. If NULL, a new connection will be created and closed locally.
+ * @return Returns a cJSON array with the result of each vulnerability, in the same order they were added.
+ *         Every item has the same format as the result of wdb_insert_vuln_cves.
+ *         On any error, NULL is returned. The cJSON array must be freed by the caller.
+ */
+cJSON* wdb_vuln_cves_batch_flush(int id,
+                                 wdb_vuln_cves_batch *batch,
+                                 int *sock);
+
 /**
  * @brief Removes all the entries from the vuln_cves table in the agent's database that have the specified status.
  *
@@ -131,4 +184,18 @@ int wdb_update_vuln_cves_status_by_type(int id,
                                         const char *new_status,
                                         int *sock);
 
+/**
+ * @brief Updates the status of the CVEs of a package from the vuln_cves table.
+ *
+ * @param[in] id The agent ID.
+ * @param[in] reference The package reference in the sys_programs table.
+ * @param[in] new_status The new status.
+ * @param[in] sock The Wazuh DB socket connection. If NULL, a new connection will be created and closed locally.
+ * @return Returns 0 on success or -1 on error.
+ */
+int wdb_update_vuln_cves_status_by_reference(int id,
+                                             const char *reference,
+                                             const char *new_status,
+                                             int *sock);
+
 #endif
@@ -173,6 +173,15 @@ CREATE INDEX IF NOT EXISTS IN_ARCH_ID ON ARCHITECTURES (ID);
 CREATE INDEX IF NOT EXISTS IN_ARCH_TARGET ON ARCHITECTURES (TARGET);
 CREATE INDEX IF NOT EXISTS IN_ARCH_VALUE ON ARCHITECTURES (ARCHITECTURE);
 
+CREATE TABLE IF NOT EXISTS PACKAGE_HASHES (
+    TARGET TEXT NOT NULL,
+    PACKAGE TEXT NOT NULL,
+    HASH TEXT NOT NULL,
+    LAST_CHANGE INTEGER,
+    PRIMARY KEY(TARGET, PACKAGE)
+);
+CREATE INDEX IF NOT EXISTS IN_PKGH_CHANGE ON PACKAGE_HASHES (LAST_CHANGE);
+
 CREATE TABLE IF NOT EXISTS CPE_INDEX (
 	ID INTEGER,
     POS INTEGER,
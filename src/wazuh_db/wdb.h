@@ -313,6 +313,7 @@ typedef enum wdb_stmt {
     WDB_STMT_VULN_CVES_INSERT,
     WDB_STMT_VULN_CVES_UPDATE,
     WDB_STMT_VULN_CVES_UPDATE_BY_TYPE,
+    WDB_STMT_VULN_CVES_UPDATE_BY_REFERENCE,
     WDB_STMT_VULN_CVES_UPDATE_ALL,
     WDB_STMT_VULN_CVES_FIND_CVE,
     WDB_STMT_VULN_CVES_SELECT_BY_STATUS,
@@ -2299,6 +2300,28 @@ int wdb_parse_task_delete_old(wdb_t* wdb, const cJSON *parameters, char* output)
  */
  int wdb_parse_agents_insert_vuln_cves(wdb_t* wdb, char* input, char* output);
 
+/**
+ * @brief Function to parse the vuln_cves insert_batch action.
+ *        All the entries of the batch are inserted within the same transaction.
+ *
+ * @param [in] wdb The global struct database.
+ * @param [in] input String with an array of vulnerabilities in json format, as expected by the insert action.
+ * @param [out] output Response of the query. It contains an array with the result of each entry, in the same order.
+ * @return 0 Success: response contains "ok".
+ *        -1 On error: response contains "err" and an error description.
+ */
+ int wdb_parse_agents_insert_vuln_cves_batch(wdb_t* wdb, char* input, char* output);
+
+/**
+ * @brief Inserts a single vulnerability of a vuln_cves insert or insert_batch action.
+ *
+ * @param [in] wdb The global struct database.
+ * @param [in] data JSON object with the vulnerability data.
+ * @param [out] output Error description, if any.
+ * @return The cJSON object returned by wdb_agents_insert_vuln_cves, or NULL on error.
+ */
+cJSON* wdb_parse_agents_insert_vuln_cves_entry(wdb_t* wdb, cJSON* data, char* output);
+
 /**
  * @brief Function to parse the vuln_cves update status action.
  *
@@ -214,6 +214,19 @@ int wdb_agents_update_vuln_cves_status(wdb_t *wdb, const char* old_status, const
     return wdb_exec_stmt_silent(stmt);
 }
 
+int wdb_agents_update_vuln_cves_status_by_reference(wdb_t *wdb, const char* reference, const char* new_status) {
+    sqlite3_stmt* stmt = wdb_init_stmt_in_cache(wdb, WDB_STMT_VULN_CVES_UPDATE_BY_REFERENCE);
+
+    if (stmt == NULL) {
+        return OS_INVALID;
+    }
+
+    sqlite3_bind_text(stmt, 1, new_status, -1, NULL);
+    sqlite3_bind_text(stmt, 2, reference, -1, NULL);
+
+    return wdb_exec_stmt_silent(stmt);
+}
+
 int wdb_agents_remove_vuln_cves(wdb_t *wdb, const char* cve, const char* reference) {
     if (!cve || !reference) {
         mdebug1("Invalid data provided");
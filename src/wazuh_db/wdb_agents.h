@@ -104,6 +104,16 @@ cJSON* wdb_agents_insert_vuln_cves(wdb_t *wdb,
  */
 int wdb_agents_update_vuln_cves_status(wdb_t *wdb, const char* old_status, const char* new_status, const char* type);
 
+/**
+ * @brief Function to update the status field of the vulnerabilities of a package in agent database vuln_cves table.
+ *
+ * @param [in] wdb The 'agents' struct database.
+ * @param [in] reference The package reference in the sys_programs table.
+ * @param [in] new_status The new status.
+ * @return Returns 0 on success or -1 on error.
+ */
+int wdb_agents_update_vuln_cves_status_by_reference(wdb_t *wdb, const char* reference, const char* new_status);
+
 /**
  * @brief Function to remove vulnerabilities from the vuln_cves table by specifying the PK of the entry.
  *
@@ -6135,6 +6135,8 @@ int wdb_parse_vuln_cves(wdb_t* wdb, char* input, char* output) {
         snprintf(output, OS_MAXSTR + 1, "err Missing vuln_cves action");
     } else if (strcmp(next, "insert") == 0) {
         result = wdb_parse_agents_insert_vuln_cves(wdb, tail, output);
+    } else if (strcmp(next, "insert_batch") == 0) {
+        result = wdb_parse_agents_insert_vuln_cves_batch(wdb, tail, output);
     } else if (strcmp(next, "update_status") == 0) {
         result = wdb_parse_agents_update_vuln_cves_status(wdb, tail, output);
     } else if (strcmp(next, "remove") == 0) {
@@ -6158,57 +6160,118 @@ int wdb_parse_agents_insert_vuln_cves(wdb_t* wdb, char* input, char* output) {
         snprintf(output, OS_MAXSTR + 1, "err Invalid JSON syntax, near '%.32s'", input);
     }
     else {
-        cJSON* j_name = cJSON_GetObjectItem(data, "name");
-        cJSON* j_version = cJSON_GetObjectItem(data, "version");
-        cJSON* j_architecture = cJSON_GetObjectItem(data, "architecture");
-        cJSON* j_cve = cJSON_GetObjectItem(data, "cve");
-        cJSON* j_reference = cJSON_GetObjectItem(data, "reference");
-        cJSON* j_type = cJSON_GetObjectItem(data, "type");
-        cJSON* j_status = cJSON_GetObjectItem(data, "status");
-        cJSON* j_check_pkg_existence = cJSON_GetObjectItem(data, "check_pkg_existence");
-        cJSON* j_severity = cJSON_GetObjectItem(data, "severity");
-        cJSON* j_cvss2_score = cJSON_GetObjectItem(data, "cvss2_score");
-        cJSON* j_cvss3_score = cJSON_GetObjectItem(data, "cvss3_score");
-        cJSON* j_external_references = cJSON_GetObjectItem(data, "external_references");
-        cJSON* j_condition = cJSON_GetObjectItem(data, "condition");
-        cJSON* j_title = cJSON_GetObjectItem(data, "title");
-        cJSON* j_published = cJSON_GetObjectItem(data, "published");
-        cJSON* j_updated = cJSON_GetObjectItem(data, "updated");
-
-        // Required fields
-        if (!cJSON_IsString(j_name) || !cJSON_IsString(j_version) || !cJSON_IsString(j_architecture) ||!cJSON_IsString(j_cve) ||
-            !cJSON_IsString(j_reference) || !cJSON_IsString(j_type) || !cJSON_IsString(j_status) ||!cJSON_IsBool(j_check_pkg_existence)) {
-            mdebug1("Invalid vuln_cves JSON data when inserting vulnerable package. Not compliant with constraints defined in the database.");
-            snprintf(output, OS_MAXSTR + 1, "err Invalid JSON data, missing required fields");
+        cJSON* result = wdb_parse_agents_insert_vuln_cves_entry(wdb, data, output);
+
+        if (result) {
+            char *out = cJSON_PrintUnformatted(result);
+            snprintf(output, OS_MAXSTR + 1, "ok %s", out);
+            os_free(out);
+            cJSON_Delete(result);
+            ret = OS_SUCCESS;
         }
-        else {
-            char* str_external_references = cJSON_PrintUnformatted(j_external_references);
+    }
 
-            cJSON* result = wdb_agents_insert_vuln_cves(wdb, cJSON_GetStringValue(j_name), cJSON_GetStringValue(j_version), cJSON_GetStringValue(j_architecture), cJSON_GetStringValue(j_cve),
-                                                        cJSON_GetStringValue(j_reference), cJSON_GetStringValue(j_type), cJSON_GetStringValue(j_status), (bool)j_check_pkg_existence->valueint,
-                                                        cJSON_GetStringValue(j_severity), cJSON_IsNumber(j_cvss2_score) ? j_cvss2_score->valuedouble : 0,
-                                                        cJSON_IsNumber(j_cvss3_score) ? j_cvss3_score->valuedouble : 0, str_external_references, cJSON_GetStringValue(j_condition),
-                                                        cJSON_GetStringValue(j_title), cJSON_GetStringValue(j_published), cJSON_GetStringValue(j_updated));
+    cJSON_Delete(data);
+    return ret;
+}
 
-            if (result) {
-                char *out = cJSON_PrintUnformatted(result);
-                snprintf(output, OS_MAXSTR + 1, "ok %s", out);
-                os_free(out);
-                cJSON_Delete(result);
-                ret = OS_SUCCESS;
-            }
-            else {
-                mdebug1("Error inserting vulnerability in vuln_cves.");
-                snprintf(output, OS_MAXSTR + 1, "err Error inserting vulnerability in vuln_cves.");
+int wdb_parse_agents_insert_vuln_cves_batch(wdb_t* wdb, char* input, char* output) {
+    cJSON *data = NULL;
+    const char *error = NULL;
+    int ret = OS_INVALID;
+
+    data = cJSON_ParseWithOpts(input, &error, TRUE);
+    if (!data) {
+        mdebug1("Invalid vuln_cves JSON syntax when inserting vulnerable packages batch.");
+        mdebug2("JSON error near: %s", error);
+        snprintf(output, OS_MAXSTR + 1, "err Invalid JSON syntax, near '%.32s'", input);
+    }
+    else if (!cJSON_IsArray(data)) {
+        mdebug1("Invalid vuln_cves JSON data when inserting vulnerable packages batch. An array is expected.");
+        snprintf(output, OS_MAXSTR + 1, "err Invalid JSON data, array expected");
+    }
+    else if (!wdb->transaction && wdb_begin2(wdb) < 0) {
+        mdebug1("DB(%s) Cannot begin transaction", wdb->id);
+        snprintf(output, OS_MAXSTR + 1, "err Cannot begin transaction");
+    }
+    else {
+        cJSON *results = cJSON_CreateArray();
+        cJSON *item = NULL;
+
+        cJSON_ArrayForEach(item, data) {
+            cJSON* result = wdb_parse_agents_insert_vuln_cves_entry(wdb, item, output);
+
+            // A wrong entry doesn't discard the rest of the batch
+            if (!result) {
+                result = cJSON_CreateObject();
+                cJSON_AddStringToObject(result, "status", "ERROR");
             }
-            os_free(str_external_references);
+            cJSON_AddItemToArray(results, result);
+        }
+
+        char *out = cJSON_PrintUnformatted(results);
+
+        if (out && strlen(out) < OS_MAXSTR - WDB_RESPONSE_OK_SIZE) {
+            snprintf(output, OS_MAXSTR + 1, "ok %s", out);
+            ret = OS_SUCCESS;
         }
+        else {
+            mdebug1("DB(%s) The response of the vuln_cves batch is too long.", wdb->id);
+            snprintf(output, OS_MAXSTR + 1, "err Response of the vuln_cves batch is too long");
+        }
+
+        os_free(out);
+        cJSON_Delete(results);
     }
 
     cJSON_Delete(data);
     return ret;
 }
 
+cJSON* wdb_parse_agents_insert_vuln_cves_entry(wdb_t* wdb, cJSON* data, char* output) {
+    cJSON* j_name = cJSON_GetObjectItem(data, "name");
+    cJSON* j_version = cJSON_GetObjectItem(data, "version");
+    cJSON* j_architecture = cJSON_GetObjectItem(data, "architecture");
+    cJSON* j_cve = cJSON_GetObjectItem(data, "cve");
+    cJSON* j_reference = cJSON_GetObjectItem(data, "reference");
+    cJSON* j_type = cJSON_GetObjectItem(data, "type");
+    cJSON* j_status = cJSON_GetObjectItem(data, "status");
+    cJSON* j_check_pkg_existence = cJSON_GetObjectItem(data, "check_pkg_existence");
+    cJSON* j_severity = cJSON_GetObjectItem(data, "severity");
+    cJSON* j_cvss2_score = cJSON_GetObjectItem(data, "cvss2_score");
+    cJSON* j_cvss3_score = cJSON_GetObjectItem(data, "cvss3_score");
+    cJSON* j_external_references = cJSON_GetObjectItem(data, "external_references");
+    cJSON* j_condition = cJSON_GetObjectItem(data, "condition");
+    cJSON* j_title = cJSON_GetObjectItem(data, "title");
+    cJSON* j_published = cJSON_GetObjectItem(data, "published");
+    cJSON* j_updated = cJSON_GetObjectItem(data, "updated");
+    cJSON* result = NULL;
+
+    // Required fields
+    if (!cJSON_IsString(j_name) || !cJSON_IsString(j_version) || !cJSON_IsString(j_architecture) ||!cJSON_IsString(j_cve) ||
+        !cJSON_IsString(j_reference) || !cJSON_IsString(j_type) || !cJSON_IsString(j_status) ||!cJSON_IsBool(j_check_pkg_existence)) {
+        mdebug1("Invalid vuln_cves JSON data when inserting vulnerable package. Not compliant with constraints defined in the database.");
+        snprintf(output, OS_MAXSTR + 1, "err Invalid JSON data, missing required fields");
+    }
+    else {
+        char* str_external_references = cJSON_PrintUnformatted(j_external_references);
+
+        result = wdb_agents_insert_vuln_cves(wdb, cJSON_GetStringValue(j_name), cJSON_GetStringValue(j_version), cJSON_GetStringValue(j_architecture), cJSON_GetStringValue(j_cve),
+                                             cJSON_GetStringValue(j_reference), cJSON_GetStringValue(j_type), cJSON_GetStringValue(j_status), (bool)j_check_pkg_existence->valueint,
+                                             cJSON_GetStringValue(j_severity), cJSON_IsNumber(j_cvss2_score) ? j_cvss2_score->valuedouble : 0,
+                                             cJSON_IsNumber(j_cvss3_score) ? j_cvss3_score->valuedouble : 0, str_external_references, cJSON_GetStringValue(j_condition),
+                                             cJSON_GetStringValue(j_title), cJSON_GetStringValue(j_published), cJSON_GetStringValue(j_updated));
+
+        if (!result) {
+            mdebug1("Error inserting vulnerability in vuln_cves.");
+            snprintf(output, OS_MAXSTR + 1, "err Error inserting vulnerability in vuln_cves.");
+        }
+        os_free(str_external_references);
+    }
+
+    return result;
+}
+
 int wdb_parse_agents_update_vuln_cves_status(wdb_t* wdb, char* input, char* output) {
     cJSON *data = NULL;
     const char *error = NULL;
@@ -6225,9 +6288,12 @@ int wdb_parse_agents_update_vuln_cves_status(wdb_t* wdb, char* input, char* outp
         const char *old_status = cJSON_GetStringValue(cJSON_GetObjectItem(data, "old_status"));
         const char *new_status = cJSON_GetStringValue(cJSON_GetObjectItem(data, "new_status"));
         const char *type = cJSON_GetStringValue(cJSON_GetObjectItem(data, "type"));
+        const char *reference = cJSON_GetStringValue(cJSON_GetObjectItem(data, "reference"));
+        bool by_reference = new_status && reference && !type && !old_status;
 
-        if (new_status && ((type && !old_status) || (!type && old_status) )) {
-            ret = wdb_agents_update_vuln_cves_status(wdb, old_status, new_status, type);
+        if (by_reference || (new_status && !reference && ((type && !old_status) || (!type && old_status)))) {
+            ret = by_reference ? wdb_agents_update_vuln_cves_status_by_reference(wdb, reference, new_status) :
+                                 wdb_agents_update_vuln_cves_status(wdb, old_status, new_status, type);
             if (OS_SUCCESS != ret) {
                 mdebug1("DB(%s) Cannot execute vuln_cves update_status command; SQL err: %s", wdb->id, sqlite3_errmsg(wdb->db));
                 snprintf(output, OS_MAXSTR + 1, "err Cannot execute vuln_cves update_status command; SQL err: %s", sqlite3_errmsg(wdb->db));
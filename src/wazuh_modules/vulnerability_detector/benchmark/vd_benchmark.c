@@ -0,0 +1,495 @@
+/*
+ * Wazuh Module to analyze system vulnerabilities
+ * Offline benchmark of the vulnerability detector
+ * Copyright (C) 2015, Wazuh Inc.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+/*
+ * The CVE database is built from the fixture feeds and every synthetic agent
+ * is scanned against it. Wazuh DB, the agents' inventory and the alerts queue
+ * are replaced by the __wrap_* functions of this file, so no manager is needed:
+ *
+ *     make TARGET=server vd-benchmark
+ *     ./vd-benchmark -a 100 -p 500
+ */
+
+#include "shared.h"
+#include "../../wmodules.h"
+
+#undef ARGV0
+#define ARGV0 "vd-benchmark"
+
+#define VU_BENCH_FIXTURES   "wazuh_modules/vulnerability_detector/benchmark/fixtures"
+#define VU_BENCH_OVAL       "oval-focal.xml"
+#define VU_BENCH_NVD        "nvd-.*\\.json$"
+#define VU_BENCH_INVENTORY  "inventory-focal.json"
+#define VU_BENCH_AGENTS     10
+#define VU_BENCH_CVE_DB     "queue/vulnerabilities/cve.db"
+
+typedef enum vu_bench_phase {
+    VU_BENCH_PARSE,
+    VU_BENCH_INSERT,
+    VU_BENCH_LOAD,
+    VU_BENCH_MATCH,
+    VU_BENCH_REPORT,
+    VU_BENCH_PHASES
+} vu_bench_phase;
+
+static const char *vu_bench_phase_name[VU_BENCH_PHASES] = {
+    [VU_BENCH_PARSE] = "feed parse",
+    [VU_BENCH_INSERT] = "feed insert",
+    [VU_BENCH_LOAD] = "inventory",
+    [VU_BENCH_MATCH] = "match",
+    [VU_BENCH_REPORT] = "report"
+};
+
+typedef struct vu_bench_stats {
+    double time;                ///< Wall time of the phase, in seconds
+    double sqlite_time;         ///< Time spent running SQLite statements, in seconds
+    unsigned long queries;      ///< SQLite statements run
+} vu_bench_stats;
+
+static vu_bench_stats vu_bench[VU_BENCH_PHASES];
+static vu_bench_phase vu_bench_current = VU_BENCH_INSERT;
+static cJSON *vu_bench_packages;            // Packages returned for every agent
+static int vu_bench_rows = -1;              // Next row of the Wazuh DB answer, -1 if there is no request in progress
+static unsigned long vu_bench_scanned;      // Packages sent to the detector
+static unsigned long vu_bench_wdb;          // Requests answered in place of Wazuh DB
+static unsigned long vu_bench_saved;        // Vulnerabilities saved in the agents' databases
+static unsigned long vu_bench_alerts;       // Alerts sent to analysisd
+static int vu_bench_queue = -1;
+
+extern int *vu_queue;
+
+/* Exposed by the benchmark build of the module (VULDET_BENCHMARK) */
+int wm_vuldet_check_db();
+int wm_vuldet_index_feed(update_node *update);
+int wm_vuldet_collect_agent_software(scan_agent *agent, sqlite3 *db, scan_ctx_t* scan_ctx);
+int wm_vuldet_find_obsolete_vulnerabilities(scan_ctx_t* scan_ctx);
+int wm_vuldet_build_unix_os_release(scan_agent *agent, const char* os_major, const char* os_minor, const char* os_patch);
+void wm_vuldet_reset_tables(sqlite3 *db);
+void wm_vuldet_free_scan_agent(scan_agent *agent);
+void wm_vuldet_free_cve_node(void *data);
+
+int __real_sqlite3_open_v2(const char *filename, sqlite3 **ppDb, int flags, const char *zVfs);
+
+static void helpmsg(void) __attribute__((noreturn));
+
+static void helpmsg()
+{
+    printf("\n%s %s: Offline benchmark of the vulnerability detector.\n", __ossec_name, ARGV0);
+    printf("Available options:\n");
+    printf("\t-h          This help message.\n");
+    printf("\t-d          Debug mode.\n");
+    printf("\t-f <dir>    Fixtures directory. Default: %s\n", VU_BENCH_FIXTURES);
+    printf("\t-a <n>      Number of agents to scan. Default: %d\n", VU_BENCH_AGENTS);
+    printf("\t-p <n>      Synthetic packages added to the inventory of each agent. Default: 0\n");
+    printf("\t-w <dir>    Working directory, kept after the run. Default: a temporary one.\n");
+    exit(1);
+}
+
+static double vu_bench_elapsed(const struct timespec *start) {
+    struct timespec now;
+
+    gettime(&now);
+    return time_diff(start, &now);
+}
+
+/**
+ * @brief Accounts every SQLite statement of the detector to the running phase.
+ */
+static int vu_bench_profile(unsigned int type, __attribute__((unused)) void *context, __attribute__((unused)) void *stmt, void *ns) {
+    if (type == SQLITE_TRACE_PROFILE) {
+        vu_bench[vu_bench_current].queries++;
+        vu_bench[vu_bench_current].sqlite_time += (double)*(sqlite3_int64 *)ns / 1000000000;
+    }
+    return 0;
+}
+
+/**
+ * @brief Loads the inventory fixture, adding the synthetic packages to it.
+ *
+ * @param path Inventory fixture.
+ * @param synthetic Number of synthetic packages.
+ * @return The inventory on success, NULL otherwise.
+ */
+static cJSON *vu_bench_load_inventory(const char *path, int synthetic) {
+    cJSON *inventory;
+    cJSON *packages;
+    char name[OS_SIZE_64];
+    char version[OS_SIZE_64];
+    int i;
+
+    if (inventory = json_fread(path, 0), !inventory) {
+        merror("Invalid inventory fixture '%s'.", path);
+        return NULL;
+    }
+
+    if (packages = cJSON_GetObjectItem(inventory, "packages"), !cJSON_IsArray(packages) ||
+        !cJSON_IsObject(cJSON_GetObjectItem(inventory, "os"))) {
+        merror("Invalid inventory fixture '%s'.", path);
+        cJSON_Delete(inventory);
+        return NULL;
+    }
+
+    // Most of the installed packages are not found in the feeds
+    for (i = 0; i < synthetic; i++) {
+        cJSON *package = cJSON_CreateObject();
+
+        snprintf(name, sizeof(name), "vd-bench-package-%d", i);
+        snprintf(version, sizeof(version), "1.%d.%d-1ubuntu1", i / 100, i % 100);
+        cJSON_AddStringToObject(package, "name", name);
+        cJSON_AddStringToObject(package, "version", version);
+        cJSON_AddStringToObject(package, "architecture", "amd64");
+        cJSON_AddStringToObject(package, "vendor", "Ubuntu Developers <ubuntu-devel-discuss@lists.ubuntu.com>");
+        cJSON_AddStringToObject(package, "format", "deb");
+        cJSON_AddItemToArray(packages, package);
+    }
+
+    return inventory;
+}
+
+/**
+ * @brief Builds a synthetic agent with the operating system of the inventory fixture.
+ *
+ * @param id Agent ID.
+ * @param os Operating system of the inventory fixture.
+ * @return The agent.
+ */
+static scan_agent *vu_bench_build_agent(int id, cJSON *os) {
+    scan_agent *agent;
+    char buffer[OS_SIZE_64];
+
+    os_calloc(1, sizeof(scan_agent), agent);
+    snprintf(buffer, sizeof(buffer), "%.3d", id);
+    os_strdup(buffer, agent->agent_id);
+    snprintf(buffer, sizeof(buffer), "vd-bench-agent-%d", id);
+    os_strdup(buffer, agent->agent_name);
+    snprintf(buffer, sizeof(buffer), "10.0.%d.%d", (id >> 8) & 0xFF, id & 0xFF);
+    os_strdup(buffer, agent->agent_ip);
+    agent->dist = FEED_UBUNTU;
+    agent->dist_ver = FEED_FOCAL;
+    agent->pending_attempts = 1;
+    w_strdup(cJSON_GetStringValue(cJSON_GetObjectItem(os, "name")), agent->os_name);
+    w_strdup(cJSON_GetStringValue(cJSON_GetObjectItem(os, "version")), agent->os_version);
+    w_strdup(cJSON_GetStringValue(cJSON_GetObjectItem(os, "architecture")), agent->arch);
+    w_strdup(cJSON_GetStringValue(cJSON_GetObjectItem(os, "release")), agent->kernel_release);
+    wm_vuldet_build_unix_os_release(agent, cJSON_GetStringValue(cJSON_GetObjectItem(os, "major")),
+                                    cJSON_GetStringValue(cJSON_GetObjectItem(os, "minor")), NULL);
+
+    return agent;
+}
+
+/**
+ * @brief Builds the CVE database from a feed, splitting the time spent parsing it from the time spent inserting it.
+ *
+ * @param update Feed to index.
+ * @return 0 on success, OS_INVALID otherwise.
+ */
+static int vu_bench_index_feed(update_node *update) {
+    struct timespec start;
+    double sqlite_time = vu_bench[VU_BENCH_INSERT].sqlite_time;
+    double elapsed;
+    int result;
+
+    // The feeds are inserted while they are being parsed
+    vu_bench_current = VU_BENCH_INSERT;
+    gettime(&start);
+    result = wm_vuldet_index_feed(update);
+    elapsed = vu_bench_elapsed(&start);
+
+    sqlite_time = vu_bench[VU_BENCH_INSERT].sqlite_time - sqlite_time;
+    vu_bench[VU_BENCH_INSERT].time += sqlite_time;
+    vu_bench[VU_BENCH_PARSE].time += elapsed - sqlite_time;
+
+    printf("Indexed %s in %.3f s.\n", update->dist_ext, elapsed);
+
+    return result;
+}
+
+/**
+ * @brief Runs a full scan of an agent, phase by phase.
+ *
+ * @param db The vulnerabilities database.
+ * @param agent The scanned agent.
+ * @return 0 on success, OS_INVALID otherwise.
+ */
+static int vu_bench_scan_agent(sqlite3 *db, scan_agent *agent) {
+    scan_ctx_t scan_ctx = { .agent_id = atoi(agent->agent_id), .agent_name = agent->agent_name,
+                            .agent_ip = agent->agent_ip, .scan_type = VU_FULL_SCAN };
+    OSHash *cve_table = NULL;
+    struct timespec start;
+    int retval = OS_INVALID;
+
+    vu_bench_current = VU_BENCH_LOAD;
+    gettime(&start);
+    wm_vuldet_reset_tables(db);
+    if (wm_vuldet_collect_agent_software(agent, db, &scan_ctx) != OS_SUCCESS) {
+        merror("Could not collect the software of the agent %.3d.", scan_ctx.agent_id);
+        goto end;
+    }
+    vu_bench[VU_BENCH_LOAD].time += vu_bench_elapsed(&start);
+
+    vu_bench_current = VU_BENCH_MATCH;
+    gettime(&start);
+    if (cve_table = OSHash_Create(), !cve_table || !OSHash_setSize(cve_table, VU_CVE_TABLE_SIZE)) {
+        merror(LIST_ERROR);
+        goto end;
+    }
+    if (wm_vuldet_linux_oval_vulnerabilities(db, agent, cve_table, &scan_ctx) ||
+        wm_vuldet_linux_nvd_vulnerabilities(db, agent, cve_table) ||
+        wm_vuldet_linux_rm_false_positives(db, agent, cve_table)) {
+        merror("Could not find the vulnerabilities of the agent %.3d.", scan_ctx.agent_id);
+        goto end;
+    }
+    vu_bench[VU_BENCH_MATCH].time += vu_bench_elapsed(&start);
+
+    vu_bench_current = VU_BENCH_REPORT;
+    gettime(&start);
+    if (wm_vuldet_process_agent_vulnerabilities(db, cve_table, agent, &scan_ctx) ||
+        wm_vuldet_find_obsolete_vulnerabilities(&scan_ctx)) {
+        merror("Could not report the vulnerabilities of the agent %.3d.", scan_ctx.agent_id);
+        goto end;
+    }
+    vu_bench[VU_BENCH_REPORT].time += vu_bench_elapsed(&start);
+
+    retval = 0;
+end:
+    if (cve_table) {
+        OSHash_Clean(cve_table, wm_vuldet_free_cve_node);
+    }
+
+    return retval;
+}
+
+static void vu_bench_print_report(int agents) {
+    struct rusage usage;
+    double scan_time = vu_bench[VU_BENCH_LOAD].time + vu_bench[VU_BENCH_MATCH].time + vu_bench[VU_BENCH_REPORT].time;
+    int i;
+
+    getrusage(RUSAGE_SELF, &usage);
+
+    printf("\n%-12s %12s %12s %12s\n", "Phase", "Time (s)", "SQLite (s)", "Queries");
+    for (i = 0; i < VU_BENCH_PHASES; i++) {
+        printf("%-12s %12.3f %12.3f %12lu\n", vu_bench_phase_name[i], vu_bench[i].time, vu_bench[i].sqlite_time, vu_bench[i].queries);
+    }
+
+    printf("\nAgents scanned:            %d\n", agents);
+    printf("Packages scanned:          %lu\n", vu_bench_scanned);
+    printf("Packages per second:       %.1f\n", scan_time > 0 ? vu_bench_scanned / scan_time : 0);
+    printf("Vulnerabilities saved:     %lu\n", vu_bench_saved);
+    printf("Alerts sent:               %lu\n", vu_bench_alerts);
+    printf("Wazuh DB requests:         %lu\n", vu_bench_wdb);
+    printf("Peak memory:               %ld KiB\n", usage.ru_maxrss);
+}
+
+int main(int argc, char **argv)
+{
+    const char *fixtures = VU_BENCH_FIXTURES;
+    char *workdir = NULL;
+    char tmpdir[] = "/tmp/vd-benchmark-XXXXXX";
+    char fixtures_path[PATH_MAX + 1];
+    char path[PATH_MAX + 1];
+    update_node oval = { .dist_ref = FEED_UBUNTU, .dist_tag_ref = FEED_FOCAL };
+    update_node nvd = { .dist_ref = FEED_NVD, .dist_tag_ref = FEED_NVD, .json_format = 1 };
+    cJSON *inventory = NULL;
+    sqlite3 *db = NULL;
+    int agents = VU_BENCH_AGENTS;
+    int synthetic = 0;
+    int scanned = 0;
+    int retval = 1;
+    int c;
+    int i;
+
+    OS_SetName(ARGV0);
+
+    while ((c = getopt(argc, argv, "hdf:a:p:w:")) != -1) {
+        switch (c) {
+            case 'h':
+                helpmsg();
+                break;
+            case 'd':
+                nowDebug();
+                break;
+            case 'f':
+                fixtures = optarg;
+                break;
+            case 'a':
+                agents = atoi(optarg);
+                break;
+            case 'p':
+                synthetic = atoi(optarg);
+                break;
+            case 'w':
+                workdir = optarg;
+                break;
+            default:
+                helpmsg();
+        }
+    }
+
+    if (agents < 1 || synthetic < 0) {
+        helpmsg();
+    }
+
+    // The feeds are read from the fixtures, so their path must not depend on the working directory
+    if (!realpath(fixtures, fixtures_path)) {
+        merror_exit("Invalid fixtures directory '%s': %s (%d)", fixtures, strerror(errno), errno);
+    }
+
+    snprintf(path, sizeof(path), "%s/%s", fixtures_path, VU_BENCH_INVENTORY);
+    if (inventory = vu_bench_load_inventory(path, synthetic), !inventory) {
+        return 1;
+    }
+    vu_bench_packages = cJSON_GetObjectItem(inventory, "packages");
+
+    if (!workdir && !(workdir = mkdtemp(tmpdir))) {
+        merror_exit("Could not create a temporary directory: %s (%d)", strerror(errno), errno);
+    }
+
+    if (mkdir_ex(workdir) || chdir(workdir) == -1) {
+        merror_exit(CHDIR_ERROR, workdir, errno, strerror(errno));
+    }
+
+    if (mkdir_ex(VU_DICTIONARIES) || mkdir_ex("tmp")) {
+        goto end;
+    }
+
+    wm_max_eps = 1000000;
+
+    vu_queue = &vu_bench_queue;
+
+    printf("Working directory: %s\n", workdir);
+
+    wm_vuldet_check_db();
+
+    snprintf(path, sizeof(path), "%s/%s", fixtures_path, VU_BENCH_OVAL);
+    os_strdup(path, oval.path);
+    oval.dist_ext = vu_feed_ext[FEED_FOCAL];
+
+    snprintf(path, sizeof(path), "%s/%s", fixtures_path, VU_BENCH_NVD);
+    os_strdup(path, nvd.multi_path);
+    nvd.dist_ext = vu_feed_ext[FEED_NVD];
+
+    if (vu_bench_index_feed(&oval) || vu_bench_index_feed(&nvd)) {
+        merror("Could not build the CVE database from the fixtures.");
+        goto end;
+    }
+
+    if (sqlite3_open_v2(VU_BENCH_CVE_DB, &db, SQLITE_OPEN_READWRITE, NULL) != SQLITE_OK) {
+        merror("Could not open the CVE database: %s", sqlite3_errmsg(db));
+        goto end;
+    }
+
+    for (i = 1; i <= agents; i++) {
+        scan_agent *agent = vu_bench_build_agent(i, cJSON_GetObjectItem(inventory, "os"));
+        int result = vu_bench_scan_agent(db, agent);
+
+        wm_vuldet_free_scan_agent(agent);
+        if (result) {
+            goto end;
+        }
+        scanned++;
+    }
+
+    vu_bench_print_report(scanned);
+    retval = 0;
+
+end:
+    sqlite3_close_v2(db);
+    os_free(oval.path);
+    os_free(nvd.multi_path);
+    cJSON_Delete(inventory);
+
+    if (workdir == tmpdir && chdir("/") == 0) {
+        rmdir_ex(tmpdir);
+    }
+
+    return retval;
+}
+
+/* Wazuh DB, queues and SQLite replacements, linked with -Wl,--wrap */
+
+int __wrap_OS_ConnectUnixDomain(__attribute__((unused)) const char *path, __attribute__((unused)) int type, __attribute__((unused)) int max_msg_size) {
+    return open("/dev/null", O_RDWR);
+}
+
+int __wrap_OS_SendSecureTCP(__attribute__((unused)) int sock, __attribute__((unused)) uint32_t size, const void *msg) {
+    vu_bench_wdb++;
+    // Only the software is returned, the rest of the requests get an empty answer
+    vu_bench_rows = strstr(msg, " package get") ? 0 : cJSON_GetArraySize(vu_bench_packages);
+    return 0;
+}
+
+int __wrap_OS_RecvSecureTCP(__attribute__((unused)) int sock, char *ret, uint32_t size) {
+    cJSON *package;
+
+    if (vu_bench_rows < 0) {
+        return OS_INVALID;
+    }
+
+    if (package = cJSON_GetArrayItem(vu_bench_packages, vu_bench_rows), package) {
+        char *row = cJSON_PrintUnformatted(package);
+
+        snprintf(ret, size, "due %s", row);
+        os_free(row);
+        vu_bench_rows++;
+        vu_bench_scanned++;
+    } else {
+        snprintf(ret, size, "ok {\"status\":\"SUCCESS\"}");
+        vu_bench_rows = -1;
+    }
+
+    return strlen(ret);
+}
+
+int __wrap_wdbc_query_ex(__attribute__((unused)) int *sock, __attribute__((unused)) const char *query, char *response, const int len) {
+    vu_bench_wdb++;
+    snprintf(response, len, "ok []");
+    return 0;
+}
+
+cJSON *__wrap_wdbc_query_parse_json(__attribute__((unused)) int *sock, const char *query, __attribute__((unused)) char *response, __attribute__((unused)) const int len) {
+    cJSON *results = cJSON_CreateArray();
+    const char *batch;
+
+    vu_bench_wdb++;
+
+    // Every vulnerability of a batch is inserted
+    if (batch = strstr(query, "insert_batch "), batch) {
+        cJSON *entries = cJSON_Parse(batch + strlen("insert_batch "));
+        int count = cJSON_GetArraySize(entries);
+
+        for (int i = 0; i < count; i++) {
+            cJSON *result = cJSON_CreateObject();
+            cJSON_AddStringToObject(result, "status", "SUCCESS");
+            cJSON_AddStringToObject(result, "action", "INSERT");
+            cJSON_AddItemToArray(results, result);
+        }
+        vu_bench_saved += count;
+        cJSON_Delete(entries);
+    }
+
+    return results;
+}
+
+int __wrap_wm_sendmsg(__attribute__((unused)) int usec, __attribute__((unused)) int queue, __attribute__((unused)) const char *message,
+                      __attribute__((unused)) const char *locmsg, __attribute__((unused)) char loc) {
+    vu_bench_alerts++;
+    return 0;
+}
+
+int __wrap_sqlite3_open_v2(const char *filename, sqlite3 **ppDb, int flags, const char *zVfs) {
+    int result = __real_sqlite3_open_v2(filename, ppDb, flags, zVfs);
+
+    if (result == SQLITE_OK) {
+        sqlite3_trace_v2(*ppDb, SQLITE_TRACE_PROFILE, vu_bench_profile, NULL);
+    }
+
+    return result;
+}
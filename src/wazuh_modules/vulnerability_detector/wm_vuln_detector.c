@@ -19,6 +19,7 @@
 #include "../wmodules.h"
 #include "wm_vuln_detector_db.h"
 #include "wm_vuln_detector_evr.h"
+#include "os_crypto/sha1/sha1_op.h"
 #include "addagent/manage_agents.h"
 #include "wazuh_db/helpers/wdb_global_helpers.h"
 #include "wazuh_db/helpers/wdb_agents_helpers.h"
@@ -32,6 +33,9 @@
 #undef assert
 #define assert(expression) \
     mock_assert((int)(expression), #expression, __FILE__, __LINE__);
+#elif defined(VULDET_BENCHMARK)
+// The benchmark drives the scan phases by itself
+#define STATIC
 #else
 #define STATIC static
 #endif
@@ -120,6 +124,27 @@ STATIC int wm_vuldet_check_db();
 STATIC int wm_vuldet_insert_cve_info(wm_vuldet_db *parsed_oval, sqlite3 *db, sqlite3_stmt *stmt);
 
 STATIC int wm_vuldet_insert(wm_vuldet_db *parsed_oval, update_node *update);
+
+/**
+ * @brief Open the feed database and clean the tables of the feed.
+ * @param parsed_oval The feed's information. The open database is stored in the insertion context.
+ * @param update Update structure of the feed.
+ * @return 0 if success.
+ */
+STATIC int wm_vuldet_insert_open(wm_vuldet_db *parsed_oval, update_node *update);
+
+/**
+ * @brief Insert the parsed OVAL vulnerabilities and release them.
+ * @param db SQLite3 Database pointer.
+ * @param parsed_oval The feed's information.
+ * @param keep_last Keep the last parsed vulnerability in the list.
+ * @return 0 if success.
+ */
+STATIC int wm_vuldet_insert_oval_vulnerabilities(sqlite3 *db, wm_vuldet_db *parsed_oval, bool keep_last);
+STATIC int wm_vuldet_insert_oval_tests(sqlite3 *db, wm_vuldet_db *parsed_oval);
+STATIC int wm_vuldet_insert_oval_states(sqlite3 *db, wm_vuldet_db *parsed_oval, update_node *update);
+STATIC int wm_vuldet_insert_oval_objects(sqlite3 *db, wm_vuldet_db *parsed_oval);
+STATIC int wm_vuldet_insert_oval_variables(sqlite3 *db, wm_vuldet_db *parsed_oval);
 STATIC int wm_vuldet_remove_target_table(sqlite3 *db, char *TABLE, const char *target);
 
 /**
@@ -180,6 +205,38 @@ STATIC int wm_vuldet_find_obsolete_vulnerabilities(scan_ctx_t* scan_ctx);
  */
 STATIC int wm_vuldet_check_agent_vulnerabilities(wm_vuldet_t *vuldet);
 
+/**
+ * @brief Gather the installed packages of an agent and report its vulnerabilities.
+ * @param vuldet The vulnerability detector main data structure.
+ * @param db Pointer to the cve.db database.
+ * @param agent Agent to be scanned.
+ * @return 0 if the agent is done, 1 if it must be retried, OS_INVALID if the scan has to be aborted.
+ */
+STATIC int wm_vuldet_scan_agent(wm_vuldet_t *vuldet, sqlite3 *db, scan_agent *agent);
+
+/**
+ * @brief Hand out the next agent with pending attempts.
+ * @param pool Structure shared by the scan workers.
+ * @return The agent to be scanned, or NULL if there are no more agents or the scan was aborted.
+ */
+STATIC scan_agent *wm_vuldet_scan_pool_next(vu_scan_pool *pool);
+
+/**
+ * @brief Scan agents from the pool until it is exhausted.
+ * @param pool Structure shared by the scan workers.
+ * @param db Pointer to the cve.db database.
+ * @param private_tables The connection shadows the scan tables with temporary ones.
+ */
+STATIC void wm_vuldet_scan_pool_run(vu_scan_pool *pool, sqlite3 *db, bool private_tables);
+
+/**
+ * @brief Scan worker thread. It owns a read-only connection to the cve.db database
+ * and a connection to wazuh-db.
+ * @param pool Structure shared by the scan workers.
+ * @return NULL.
+ */
+STATIC void *wm_vuldet_scan_worker(vu_scan_pool *pool);
+
 /**
  * @brief Discard any installed Linux kernel package which is not running.
  * @param agent Agent being analyzed.
@@ -202,6 +259,26 @@ STATIC int wm_vuldet_discard_kernel_package(scan_agent *agent, const char *name,
  */
 STATIC int wm_vuldet_oval_discard_mismatching_cve_entries(sqlite3 *db, scan_agent *agents_it, char *cve_id, char *pkg_version, char *pkg_name, version_type vertype);
 
+/**
+ * @brief Get the in-memory index of the OVAL conditions of the agent's target, building it if needed.
+ * @param db The agent's sqlite database.
+ * @param agents_it The agent being analyzed.
+ * @param vertype The version comparisor type.
+ * @return The index of the target, or NULL if it could not be read. The database is closed on error.
+ */
+STATIC vu_cve_index *wm_vuldet_cve_index_get(sqlite3 *db, scan_agent *agents_it, version_type vertype);
+
+/**
+ * @brief Order the OVAL conditions by package, CVE and position in the database.
+ */
+STATIC int wm_vuldet_cve_condition_cmp(const void *a, const void *b);
+
+/**
+ * @brief Free an index of OVAL conditions.
+ * @param index The index to free.
+ */
+STATIC void wm_vuldet_free_cve_index(vu_cve_index *index);
+
 /**
  * @brief Resolve the package-dependencies relation for SUSE agents before the vulnerability scan.
  * @param db The agent's sqlite database.
@@ -245,6 +322,27 @@ STATIC char *wm_vuldet_build_url(char *pattern, char *value);
 STATIC void wm_vuldet_adapt_title(char *title, char *cve);
 STATIC int wm_vuldet_fetch_oval(update_node *update, char *repo);
 STATIC int wm_vuldet_oval_process(update_node *update, char *path, wm_vuldet_db *parsed_vulnerabilities);
+
+/**
+ * @brief Read a chunk of a streamed OVAL, parsing every section child as soon as it is complete.
+ * @param reader Reader state, kept between chunks.
+ * @param data Chunk of the OVAL.
+ * @param length Length of the chunk.
+ * @param parsed_oval The feed's information.
+ * @param update Update structure of the feed.
+ * @return 0 if success. OS_INVALID otherwise.
+ */
+STATIC int wm_vuldet_oval_stream(vu_oval_reader *reader, const char *data, size_t length, wm_vuldet_db *parsed_oval, update_node *update);
+STATIC int wm_vuldet_oval_stream_tag(vu_oval_reader *reader, wm_vuldet_db *parsed_oval, update_node *update);
+STATIC int wm_vuldet_oval_stream_unit(vu_oval_reader *reader, wm_vuldet_db *parsed_oval, update_node *update);
+
+/**
+ * @brief Insert the OVAL elements that no longer depend on the rest of the feed.
+ * @param parsed_oval The feed's information.
+ * @param update Update structure of the feed.
+ * @return 0 if success. OS_INVALID otherwise.
+ */
+STATIC int wm_vuldet_oval_stream_flush(wm_vuldet_db *parsed_oval, update_node *update);
 STATIC int wm_vuldet_json_rh_parser(cJSON *json_feed, wm_vuldet_db *parsed_vulnerabilities);
 STATIC int wm_vuldet_json_arch_parser(cJSON *json_feed, wm_vuldet_db *parsed_vulnerabilities);
 STATIC int wm_vuldet_db_empty(sqlite3 *db, vu_feed version);
@@ -346,7 +444,7 @@ STATIC int wm_vuldet_build_unix_os_release(scan_agent *agent,
 STATIC int wm_vuldet_request_hotfixes(sqlite3 *db, const char *agent_id);
 STATIC void wm_vuldet_reset_tables(sqlite3 *db);
 STATIC int wm_vuldet_index_json(wm_vuldet_db *parsed_vulnerabilities, update_node *update, char *path, char multi_path);
-STATIC int wm_vuldet_index_nvd(sqlite3 *db, update_node *upd, nvd_vulnerability *nvd_it);
+STATIC int wm_vuldet_index_nvd(sqlite3 *db, update_node *upd, nvd_vulnerability *nvd_it, int streamed);
 STATIC int wm_vuldet_clean_rh(sqlite3 *db);
 STATIC int wm_vuldet_clean_wcpe(sqlite3 *db);
 STATIC void wm_vuldet_get_package_os(const char *version, const char **os_major, char **os_minor);
@@ -358,6 +456,7 @@ STATIC void wm_vuldet_run_scan(wm_vuldet_t *vuldet);
 STATIC void wm_vuldet_run_sleep(wm_vuldet_t *vuldet);
 STATIC void wm_vuldet_init(wm_vuldet_t *vuldet);
 STATIC void wm_vuldet_update_last_scan(scan_ctx_t* scan_ctx);
+STATIC void wm_vuldet_report_batch_send(vu_report_batch *batch, vu_report *report, int feed, bool success, bool update);
 STATIC char *wm_vuldet_normalize_date(char **date);
 STATIC int wm_vulndet_insert_msu_vul_entry(sqlite3 *db, vu_msu_vul_entry *vul);
 STATIC void wm_vuldet_json_msu_parser_deps(cJSON *json_feed, vu_msu_dep_entry **msu);
@@ -373,6 +472,61 @@ STATIC void wm_vuldet_free_alas_node(vu_alas_vuln *node);
 STATIC void wm_vuldet_free_alas(vu_alas_vuln *alas_it);
 STATIC int wm_vuldet_insert_deps(sqlite3 *db, dependencies *deps_it, wm_vuldet_db *parsed_oval);
 
+/**
+ * @brief Sends the report of a vulnerability of a batch once the result of its insertion is known, and frees it.
+ *        Vulnerabilities already present in the agent database are not reported again.
+ *
+ * @param batch Batch of the agent, whose counters are updated.
+ * @param report Report of the vulnerability.
+ * @param feed Feeds where the vulnerability was found.
+ * @param success The vulnerability was saved in the agent database.
+ * @param update The vulnerability was already in the agent database.
+ */
+void wm_vuldet_report_batch_send(vu_report_batch *batch, vu_report *report, int feed, bool success, bool update);
+
+/**
+ * @brief Checks if an OVAL file is the same one that was inserted last time.
+ *
+ * @param target Feed tag whose stored hash is compared.
+ * @param path Path of the downloaded OVAL.
+ * @param feed_hash Output buffer for the SHA256 of the file. Empty if it could not be calculated.
+ * @return true if the file hash matches the one stored in the metadata, false otherwise.
+ */
+STATIC bool wm_vuldet_feed_unchanged(const char *target, const char *path, os_sha256 feed_hash);
+
+/**
+ * @brief Calculates a digest of the conditions of each package of a feed and updates the
+ *        change time of the packages whose digest differs from the previous insertion.
+ *
+ * @param db Open transaction where the feed has just been inserted.
+ * @param target Feed tag.
+ * @return 0 on success, OS_INVALID otherwise (the database is closed).
+ */
+STATIC int wm_vuldet_update_package_hashes(sqlite3 *db, const char *target);
+
+/**
+ * @brief Checks if any installed package of the agent changed in its feed after the last full scan.
+ *        The software of the agent must have been collected in the AGENTS table.
+ *
+ * @param db The vulnerabilities database.
+ * @param agent The scanned agent.
+ * @param last_full_scan Time of the last full scan of the agent.
+ * @return 1 if the agent is affected, 0 if it isn't, OS_INVALID on error.
+ */
+STATIC int wm_vuldet_feed_affects_agent(sqlite3 *db, scan_agent *agent, time_t last_full_scan);
+
+/**
+ * @brief Keeps in the AGENTS table only the packages of the agent that changed in its feed after the last full scan,
+ *        and sets their vulnerabilities as pending, so the ones that are no longer found are removed after the scan.
+ *        The OS entries are kept, as the partial scan checks them again.
+ *
+ * @param db The vulnerabilities database.
+ * @param agent The scanned agent.
+ * @param last_full_scan Time of the last full scan of the agent.
+ * @return 0 on success, OS_INVALID on error.
+ */
+STATIC int wm_vuldet_select_feed_packages(sqlite3 *db, scan_agent *agent, time_t last_full_scan);
+
 /**
  * @brief Updates LAST_FULL_SCAN or LAST_PARTIAL_SCAN from VULN_METADATA with the current time.
  *          The item to be updated depends on the scan type of scan_ctx.
@@ -439,9 +593,57 @@ STATIC int wm_vuldet_compare_vendors(char * vendor);
  */
 STATIC void wm_vuldel_truncate_revision(char * revision);
 
+/**
+ * @brief Split a version into epoch, version and revision. The string is modified.
+ *
+ * @param version Version to split.
+ * @param vertype Comparator that will be used.
+ * @param feed The version comes from a feed, so its epoch is never ignored.
+ * @param evr The split version. It points to @version.
+ */
+STATIC void wm_vuldet_split_version(char *version, version_type vertype, bool feed, struct pkg_version *evr);
+
+/**
+ * @brief Get the relation of a feed condition and check that its version can be compared.
+ *
+ * @param operation Comparison operation.
+ * @param feed_evr Split version of the feed.
+ * @param vertype Comparator that will be used.
+ * @param relation The relation of the operation.
+ * @return 0 if the condition can be compared, VU_ERROR_CMP otherwise.
+ */
+STATIC int wm_vuldet_feed_condition(const char *operation, const struct pkg_version *feed_evr, version_type vertype, enum pkg_relation *relation);
+
+/**
+ * @brief Compare two split versions.
+ *
+ * @param package_evr Split version of the package.
+ * @param relation Relation of the feed condition.
+ * @param feed_evr Split version of the feed.
+ * @param vertype Comparator to use.
+ * @return VU_VULNERABLE, VU_NOT_VULNERABLE or VU_ERROR_CMP.
+ */
+STATIC int wm_vuldet_relate_versions(const struct pkg_version *package_evr, enum pkg_relation relation, const struct pkg_version *feed_evr, version_type vertype);
+
+/**
+ * @brief Send an alert to the queue, reconnecting and retrying once if it fails.
+ *
+ * @param usec Time to sleep after sending the message.
+ * @param message Alert to send.
+ * @param locmsg Location header of the alert.
+ * @param loc Queue type.
+ */
+STATIC void wm_vuldet_send_alert(int usec, const char *message, const char *locmsg, char loc);
+
 time_t curr_time;
-int wdb_vuldet_sock = -1;
+// Every scan worker has its own connection to wazuh-db
+__thread int wdb_vuldet_sock = -1;
 int *vu_queue;
+static pthread_mutex_t vu_queue_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t vu_regex_mutex = PTHREAD_MUTEX_INITIALIZER;
+// OVAL conditions of the scanned targets, shared by the scan workers
+static vu_cve_index *vu_cve_indexes;
+static pthread_mutex_t vu_cve_index_mutex = PTHREAD_MUTEX_INITIALIZER;
 // Define time to sleep between messages sent
 int usec;
 int deps_id = 0;
@@ -816,15 +1018,11 @@ int wm_vuldet_step(sqlite3_stmt *stmt) {
 */
 int wm_checks_package_vulnerability(char *version_a, const char *operation, const char *version_b, version_type vertype) {
     int size;
-    int epoch, c_epoch;
     char version_cl[KEY_SIZE];
     char cversion_cl[KEY_SIZE];
-    char *version_it, *release_it;
-    char *cversion_it, *crelease_it;
-    struct pkg_version *package_version;
-    struct pkg_version *package_feed_version;
+    struct pkg_version package_version;
+    struct pkg_version package_feed_version;
     enum pkg_relation feed_condition;
-    int8_t ret = 0;
 
     if (version_b && strcmp(version_b, version_null)) {
         // Copy the original values
@@ -835,98 +1033,89 @@ int wm_checks_package_vulnerability(char *version_a, const char *operation, cons
             return OS_INVALID;
         }
 
-        /*
-        * Check EPOCH:
-        * If the epoch is not present in the version and we are comparing NVD versions
-        * we assign -1 to indicate that it shouldn't be compared.
-        * For Amazon Linux packages we ignore the epoch since the ALAS feed doesn't
-        * provide it.
-        */
-        if (version_it = strchr(version_cl, ':'), version_it) {
-            *(version_it++) = '\0';
-            epoch = (VER_TYPE_RPM_ALAS != vertype) ? strtol(version_cl, NULL, 10) : -1;
-        } else {
-            version_it = version_cl;
-            epoch = (VER_TYPE_NVD != vertype) ? 0 : -1;
-        }
-        if (cversion_it = strchr(cversion_cl, ':'), cversion_it) {
-            *(cversion_it++) = '\0';
-            c_epoch = strtol(cversion_cl, NULL, 10);
-        } else {
-            cversion_it = cversion_cl;
-            c_epoch = (VER_TYPE_NVD != vertype) ? 0 : -1;
-        }
+        wm_vuldet_split_version(version_cl, vertype, false, &package_version);
+        wm_vuldet_split_version(cversion_cl, vertype, true, &package_feed_version);
 
-        // Separate the version from the revision
-        if (release_it = strchr(version_it, '-'), release_it) {
-            if (*(release_it++) = '\0', *release_it == '\0') {
-                release_it = NULL;
-            }
+        if (wm_vuldet_feed_condition(operation, &package_feed_version, vertype, &feed_condition)) {
+            return VU_ERROR_CMP;
         }
 
-        if (crelease_it = strchr(cversion_it, '-'), crelease_it) {
-            if (*(crelease_it++) = '\0', *crelease_it == '\0') {
-                crelease_it = NULL;
-            }
-        }
+        return wm_vuldet_relate_versions(&package_version, feed_condition, &package_feed_version, vertype);
+    }
 
-        // When evaluating CentOS package, the minor target part cannot be compared so it is truncated
-        if (vertype == VER_TYPE_RPM_CENTOS) {
-            wm_vuldel_truncate_revision(release_it);
-            wm_vuldel_truncate_revision(crelease_it);
-        }
+    return VU_NOT_FIXED;
+}
 
-        if (vertype == VER_TYPE_DEB) {
-            // This exception is caused by https://github.com/wazuh/wazuh/issues/11363
-            if (strstr(cversion_it, " only") != NULL) {
-                return VU_ERROR_CMP;
-            }
-        }
+void wm_vuldet_split_version(char *version, version_type vertype, bool feed, struct pkg_version *evr) {
+    char *version_it;
+    char *release_it;
 
-        os_calloc(1, sizeof(struct pkg_version), package_version);
-        os_calloc(1, sizeof(struct pkg_version), package_feed_version);
-        package_version->epoch = epoch;
-        package_version->version = version_it;
-        package_version->revision = release_it ? release_it : "0";
-        package_feed_version->epoch = c_epoch;
-        package_feed_version->version = cversion_it;
-        package_feed_version->revision = crelease_it ? crelease_it : "0";
+    /*
+    * Check EPOCH:
+    * If the epoch is not present in the version and we are comparing NVD versions
+    * we assign -1 to indicate that it shouldn't be compared.
+    * For Amazon Linux packages we ignore the epoch since the ALAS feed doesn't
+    * provide it.
+    */
+    if (version_it = strchr(version, ':'), version_it) {
+        *(version_it++) = '\0';
+        evr->epoch = (feed || VER_TYPE_RPM_ALAS != vertype) ? strtol(version, NULL, 10) : -1;
+    } else {
+        version_it = version;
+        evr->epoch = (VER_TYPE_NVD != vertype) ? 0 : -1;
+    }
 
-        if (!strcmp(operation, vu_package_comp[VU_COMP_L])) {
-            feed_condition = PKG_RELATION_LT;
-        } else if (!strcmp(operation, vu_package_comp[VU_COMP_LE])) {
-            feed_condition = PKG_RELATION_LE;
-        } else if (!strcmp(operation, vu_package_comp[VU_COMP_G])) {
-            feed_condition = PKG_RELATION_GT;
-        } else if (!strcmp(operation, vu_package_comp[VU_COMP_GE])) {
-            feed_condition = PKG_RELATION_GE;
-        } else if (!strcmp(operation, vu_package_comp[VU_COMP_EQ])) {
-            feed_condition = PKG_RELATION_EQ;
-        } else {
-            ret = VU_ERROR_CMP;
-            goto clean;
+    // Separate the version from the revision
+    if (release_it = strchr(version_it, '-'), release_it) {
+        if (*(release_it++) = '\0', *release_it == '\0') {
+            release_it = NULL;
         }
+    }
 
-        // This sanity is included since you cannot always expect a revision to come,
-        // since it is a data provided by the agent.
-        if ((vertype == VER_TYPE_RPM_CENTOS || vertype == VER_TYPE_RPM_ALAS || vertype == VER_TYPE_RPM) && (NULL == package_version->version)) {
-            ret = VU_ERROR_CMP;
-            goto clean;
-        }
+    // When evaluating CentOS package, the minor target part cannot be compared so it is truncated
+    if (vertype == VER_TYPE_RPM_CENTOS) {
+        wm_vuldel_truncate_revision(release_it);
+    }
 
-        if(pkg_version_relate(package_version, feed_condition, package_feed_version, vertype)) {
-            ret = VU_VULNERABLE;
-        } else {
-            ret = VU_NOT_VULNERABLE;
+    evr->version = version_it;
+    evr->revision = release_it ? release_it : "0";
+}
+
+int wm_vuldet_feed_condition(const char *operation, const struct pkg_version *feed_evr, version_type vertype, enum pkg_relation *relation) {
+
+    if (vertype == VER_TYPE_DEB) {
+        // This exception is caused by https://github.com/wazuh/wazuh/issues/11363
+        if (strstr(feed_evr->version, " only") != NULL) {
+            return VU_ERROR_CMP;
         }
+    }
 
-    clean:
-        os_free(package_version);
-        os_free(package_feed_version);
-        return ret;
+    if (!strcmp(operation, vu_package_comp[VU_COMP_L])) {
+        *relation = PKG_RELATION_LT;
+    } else if (!strcmp(operation, vu_package_comp[VU_COMP_LE])) {
+        *relation = PKG_RELATION_LE;
+    } else if (!strcmp(operation, vu_package_comp[VU_COMP_G])) {
+        *relation = PKG_RELATION_GT;
+    } else if (!strcmp(operation, vu_package_comp[VU_COMP_GE])) {
+        *relation = PKG_RELATION_GE;
+    } else if (!strcmp(operation, vu_package_comp[VU_COMP_EQ])) {
+        *relation = PKG_RELATION_EQ;
+    } else {
+        return VU_ERROR_CMP;
     }
 
-    return VU_NOT_FIXED;
+    return 0;
+}
+
+int wm_vuldet_relate_versions(const struct pkg_version *package_evr, enum pkg_relation relation, const struct pkg_version *feed_evr, version_type vertype) {
+
+    // This sanity is included since you cannot always expect a revision to come,
+    // since it is a data provided by the agent.
+    if ((vertype == VER_TYPE_RPM_CENTOS || vertype == VER_TYPE_RPM_ALAS || vertype == VER_TYPE_RPM) && (NULL == package_evr->version)) {
+        return VU_ERROR_CMP;
+    }
+
+    return pkg_version_relate(package_evr, relation, feed_evr, vertype) ? VU_VULNERABLE : VU_NOT_VULNERABLE;
 }
 
 char *wm_vuldet_build_url(char *pattern, char *value) {
@@ -1464,16 +1653,16 @@ int wm_vuldet_process_agent_vulnerabilities(sqlite3 *db, OSHash *cve_table, scan
     unsigned int inode_it = 0;
     sqlite3_stmt *stmt = NULL;
     vu_report *report = NULL;
+    vu_report_batch batch = {0};
     time_t start_time;
-    int vuln_reported = 0;
-    int vuln_reported_nvd = 0;
-    int vuln_reported_vendor = 0;
 
     mtdebug1(WM_VULNDETECTOR_LOGTAG, VU_START_VUL_AG_SEND, scan_ctx->agent_id);
 
     start_time = time(NULL);
 
     int sock = wm_vuldet_get_wdb_socket();
+    batch.agent_id = scan_ctx->agent_id;
+    batch.sock = &sock;
     hash_node = OSHash_Begin(cve_table, &inode_it);
 
     while(hash_node) {
@@ -1544,59 +1733,10 @@ int wm_vuldet_process_agent_vulnerabilities(sqlite3 *db, OSHash *cve_table, scan
             // Adjusting some fields before inserting and sending
             wm_vuldet_give_report_format(report);
 
-            //Save the vulnerability in the agent database
-            bool check_pkg_existence = pkg->type && !strcmp(pkg->type, VULN_CVES_TYPE_PACKAGE);
-            cJSON* j_result = wdb_insert_vuln_cves(scan_ctx->agent_id, report->software, report->version, report->arch, report->cve,
-                                                   report->severity, report->cvss2 ? report->cvss2->base_score : 0,
-                                                   report->cvss3 ? report->cvss3->base_score : 0, pkg->reference, pkg->type, VULN_CVES_STATUS_VALID,
-                                                   report->references, report->condition, report->title, report->published,
-                                                   report->updated, check_pkg_existence, &sock);
-
-            bool success = FALSE;
-            bool update = FALSE;
-
-            if (j_result) {
-                cJSON* j_status = cJSON_GetObjectItem(j_result, "status");
-                success = (cJSON_IsString(j_status) && 0 == strcmp(j_status->valuestring, "SUCCESS"));
-                cJSON* j_action = cJSON_GetObjectItem(j_result, "action");
-                update = (cJSON_IsString(j_action) && 0 == strcmp(j_action->valuestring, "UPDATE"));
-                cJSON_Delete(j_result);
-            }
-            if (!success) {
-                mtdebug1(WM_VULNDETECTOR_LOGTAG, "Failed to insert %s for package %s in the agent %.3d database",
-                        cve ? cve : "null",
-                        pkg->reference ? pkg->reference : "null",
-                        scan_ctx->agent_id);
-            }
-
-            if (report->is_hotfix) {
-                mtdebug2(WM_VULNDETECTOR_LOGTAG, VU_HOTFIX_VUL,
-                    atoi(report->agent_id),
-                    report->cve,
-                    report->condition ? report->condition : "Hotfix is not installed.");
-            }
-            else if (report->software && report->version && report->agent_id && report->cve) {
-                mtdebug2(WM_VULNDETECTOR_LOGTAG, VU_PACK_VER_VULN, report->software,
-                    report->version, atoi(report->agent_id), report->cve,
-                    report->condition && *report->condition != '\0' ? report->condition :
-                    "exists");
-            }
-
-            if (!update) {
-                // Sending CVE report
-                if (wm_vuldet_send_cve_report(report)) {
-                    mterror(WM_VULNDETECTOR_LOGTAG, VU_SEND_AGENT_REPORT_ERROR, report->cve ? report->cve : "", report->software ? report->software : "" , scan_ctx->agent_id);
-                } else {
-                    if (pkg->feed & VU_SRC_NVD) {
-                        vuln_reported_nvd++;
-                    }
-                    if (pkg->feed & VU_SRC_OVAL) {
-                        vuln_reported_vendor++;
-                    }
-                    vuln_reported++;
-                }
-            }
-            wm_vuldet_free_report(report);
+            // Save the vulnerability in the agent database and send the report
+            w_strdup(pkg->reference, report->reference);
+            wm_vuldet_report_batch_add(&batch, report, pkg->feed);
+            report = NULL;
 
             pkg = next;
         } while (pkg);
@@ -1605,22 +1745,136 @@ int wm_vuldet_process_agent_vulnerabilities(sqlite3 *db, OSHash *cve_table, scan
     }
 
     wdb_finalize(stmt);
+    wm_vuldet_report_batch_flush(&batch);
 
     if (agents_it->dist != FEED_MAC) {
-        mtdebug2(WM_VULNDETECTOR_LOGTAG, VU_VULN_SEND_AG_FEED, vuln_reported_nvd, scan_ctx->agent_id, "NVD");
-        mtdebug2(WM_VULNDETECTOR_LOGTAG, VU_VULN_SEND_AG_FEED, vuln_reported_vendor, scan_ctx->agent_id, "vendor");
+        mtdebug2(WM_VULNDETECTOR_LOGTAG, VU_VULN_SEND_AG_FEED, batch.reported_nvd, scan_ctx->agent_id, "NVD");
+        mtdebug2(WM_VULNDETECTOR_LOGTAG, VU_VULN_SEND_AG_FEED, batch.reported_vendor, scan_ctx->agent_id, "vendor");
     }
-    mtdebug1(WM_VULNDETECTOR_LOGTAG, VU_VULN_SEND_AG, vuln_reported, scan_ctx->agent_id);
+    mtdebug1(WM_VULNDETECTOR_LOGTAG, VU_VULN_SEND_AG, batch.reported, scan_ctx->agent_id);
     mtdebug1(WM_VULNDETECTOR_LOGTAG, VU_FUNCTION_TIME, time(NULL) - start_time, "report", scan_ctx->agent_id);
 
     return 0;
 
 error:
 
+    // The vulnerabilities processed so far are still saved and reported
+    wm_vuldet_report_batch_flush(&batch);
     wm_vuldet_free_report(report);
     return wm_vuldet_sql_error(db, stmt);
 }
 
+void wm_vuldet_report_batch_add(vu_report_batch *batch, vu_report *report, int feed) {
+    bool check_pkg_existence = report->type && !strcmp(report->type, VULN_CVES_TYPE_PACKAGE);
+    int result;
+
+    if (batch->count == WDB_VULN_CVES_BATCH_MAX) {
+        wm_vuldet_report_batch_flush(batch);
+    }
+
+    while (result = wdb_vuln_cves_batch_add(&batch->entries, report->software, report->version, report->arch, report->cve,
+                                            report->severity, report->cvss2 ? report->cvss2->base_score : 0,
+                                            report->cvss3 ? report->cvss3->base_score : 0, report->reference, report->type, VULN_CVES_STATUS_VALID,
+                                            report->references, report->condition, report->title, report->published,
+                                            report->updated, check_pkg_existence), result == 1) {
+        wm_vuldet_report_batch_flush(batch);
+    }
+
+    if (report->is_hotfix) {
+        mtdebug2(WM_VULNDETECTOR_LOGTAG, VU_HOTFIX_VUL,
+            atoi(report->agent_id),
+            report->cve,
+            report->condition ? report->condition : "Hotfix is not installed.");
+    }
+    else if (report->software && report->version && report->agent_id && report->cve) {
+        mtdebug2(WM_VULNDETECTOR_LOGTAG, VU_PACK_VER_VULN, report->software,
+            report->version, atoi(report->agent_id), report->cve,
+            report->condition && *report->condition != '\0' ? report->condition :
+            "exists");
+    }
+
+    // It can't be saved, so it's reported as if its insertion failed
+    if (result == OS_INVALID) {
+        wm_vuldet_report_batch_send(batch, report, feed, false, false);
+        return;
+    }
+
+    batch->reports[batch->count] = report;
+    batch->feeds[batch->count] = feed;
+    batch->count++;
+}
+
+void wm_vuldet_report_batch_flush(vu_report_batch *batch) {
+    bool success[WDB_VULN_CVES_BATCH_MAX] = {0};
+    bool update[WDB_VULN_CVES_BATCH_MAX] = {0};
+    cJSON *results = NULL;
+
+    if (!batch->count) {
+        return;
+    }
+
+    if (results = wdb_vuln_cves_batch_flush(batch->agent_id, &batch->entries, batch->sock), results) {
+        for (int i = 0; i < batch->count; i++) {
+            cJSON* j_result = cJSON_GetArrayItem(results, i);
+            cJSON* j_status = cJSON_GetObjectItem(j_result, "status");
+            success[i] = (cJSON_IsString(j_status) && 0 == strcmp(j_status->valuestring, "SUCCESS"));
+            cJSON* j_action = cJSON_GetObjectItem(j_result, "action");
+            update[i] = (cJSON_IsString(j_action) && 0 == strcmp(j_action->valuestring, "UPDATE"));
+        }
+        cJSON_Delete(results);
+    }
+
+    for (int i = 0; i < batch->count; i++) {
+        wm_vuldet_report_batch_send(batch, batch->reports[i], batch->feeds[i], success[i], update[i]);
+        batch->reports[i] = NULL;
+    }
+
+    batch->count = 0;
+}
+
+void wm_vuldet_report_batch_send(vu_report_batch *batch, vu_report *report, int feed, bool success, bool update) {
+    if (!success) {
+        mtdebug1(WM_VULNDETECTOR_LOGTAG, "Failed to insert %s for package %s in the agent %.3d database",
+                report->cve ? report->cve : "null",
+                report->reference ? report->reference : "null",
+                batch->agent_id);
+    }
+
+    // No report should be generated for vulnerabilities already reported
+    if (!update) {
+        if (wm_vuldet_send_cve_report(report)) {
+            mterror(WM_VULNDETECTOR_LOGTAG, VU_SEND_AGENT_REPORT_ERROR, report->cve ? report->cve : "", report->software ? report->software : "" , batch->agent_id);
+        } else {
+            if (feed & VU_SRC_NVD) {
+                batch->reported_nvd++;
+            }
+            if (feed & VU_SRC_OVAL) {
+                batch->reported_vendor++;
+            }
+            batch->reported++;
+        }
+    }
+
+    wm_vuldet_free_report(report);
+}
+
+STATIC void wm_vuldet_send_alert(int usec, const char *message, const char *locmsg, char loc) {
+    // The queue is shared by the scan workers
+    w_mutex_lock(&vu_queue_mutex);
+
+    if (wm_sendmsg(usec, *vu_queue, message, locmsg, loc) < 0) {
+        mterror(WM_VULNDETECTOR_LOGTAG, QUEUE_ERROR, DEFAULTQUEUE, strerror(errno));
+
+        if ((*vu_queue = StartMQ(DEFAULTQUEUE, WRITE, INFINITE_OPENQ_ATTEMPTS)) < 0) {
+            mterror_exit(WM_VULNDETECTOR_LOGTAG, QUEUE_FATAL, DEFAULTQUEUE);
+        } else {
+            wm_sendmsg(usec, *vu_queue, message, locmsg, loc);
+        }
+    }
+
+    w_mutex_unlock(&vu_queue_mutex);
+}
+
 int wm_vuldet_send_cve_report(vu_report *report) {
     cJSON *alert = NULL;
     cJSON *alert_cve = NULL;
@@ -1756,12 +2010,7 @@ int wm_vuldet_send_cve_report(vu_report *report) {
         send_queue = LOCALFILE_MQ;
     }
 
-    if (wm_sendmsg(usec, *vu_queue, alert_msg, header, send_queue) < 0) {
-        mterror(WM_VULNDETECTOR_LOGTAG, QUEUE_ERROR, DEFAULTQUEUE, strerror(errno));
-        if ((*vu_queue = StartMQ(DEFAULTQUEUE, WRITE, INFINITE_OPENQ_ATTEMPTS)) < 0) {
-            mterror_exit(WM_VULNDETECTOR_LOGTAG, QUEUE_FATAL, DEFAULTQUEUE);
-        }
-    }
+    wm_vuldet_send_alert(usec, alert_msg, header, send_queue);
 
     retval = 0;
 end:
@@ -1853,12 +2102,7 @@ int wm_vuldet_send_removed_cve_report (cJSON* j_vuln, scan_ctx_t* scan_ctx) {
             send_queue = LOCALFILE_MQ;
         }
 
-        if (wm_sendmsg(usec, *vu_queue, alert_msg, header, send_queue) < 0) {
-            mterror(WM_VULNDETECTOR_LOGTAG, QUEUE_ERROR, DEFAULTQUEUE, strerror(errno));
-            if ((*vu_queue = StartMQ(DEFAULTQUEUE, WRITE, INFINITE_OPENQ_ATTEMPTS)) < 0) {
-                mterror_exit(WM_VULNDETECTOR_LOGTAG, QUEUE_FATAL, DEFAULTQUEUE);
-            }
-        }
+        wm_vuldet_send_alert(usec, alert_msg, header, send_queue);
 
         retval = OS_SUCCESS;
     }
@@ -2208,85 +2452,240 @@ int wm_vuldet_get_cve_year(const char *cve) {
 }
 
 int wm_vuldet_oval_discard_mismatching_cve_entries(sqlite3 *db, scan_agent *agents_it, char *cve_id, char *pkg_version, char *pkg_name, version_type vertype) {
-    sqlite3_stmt    *stmt = NULL;
-    char            *operation;
-    char            *operation_value;
-    const char      *query;
-    int             result;
-    int             ret = 0;
-
-    if (agents_it->dist == FEED_UBUNTU) {
-        query = vu_queries[VU_GET_MULTIPLE_CVE_ENTRIES_UBUNTU];
-    } else {
-        query = vu_queries[VU_GET_MULTIPLE_CVE_ENTRIES];
+    vu_cve_index        *index;
+    vu_cve_condition    *cond;
+    struct pkg_version  package_evr;
+    char                version_cl[KEY_SIZE];
+    bool                version_fits;
+    size_t              low = 0;
+    size_t              high;
+    size_t              mid;
+    int                 cmp;
+    int                 ret = 0;
+
+    if (index = wm_vuldet_cve_index_get(db, agents_it, vertype), !index) {
+        return OS_INVALID;
     }
 
-    if (wm_vuldet_prepare(db, query, -1, &stmt, NULL) != SQLITE_OK) {
-        return wm_vuldet_sql_error(db, stmt);
+    if (version_fits = snprintf(version_cl, KEY_SIZE, "%s", pkg_version) < KEY_SIZE, version_fits) {
+        wm_vuldet_split_version(version_cl, vertype, false, &package_evr);
     }
 
-    sqlite3_bind_text(stmt, 1, vu_feed_tag[agents_it->dist_ver], -1, NULL);
-    sqlite3_bind_text(stmt, 2, cve_id, -1, NULL);
-    sqlite3_bind_text(stmt, 3, pkg_name, -1, NULL);
-    sqlite3_bind_text(stmt, 4, pkg_version, -1, NULL);
+    // Look for the first condition of the package and CVE
+    for (high = index->size; low < high;) {
+        mid = low + (high - low) / 2;
+        cond = &index->conditions[mid];
 
-    while (result = wm_vuldet_step(stmt), result == SQLITE_ROW) {
-        operation = (char *)sqlite3_column_text(stmt, 0);
-        operation_value = (char *)sqlite3_column_text(stmt, 1);
-        if (ret = wm_checks_package_vulnerability(pkg_version, operation, operation_value, vertype), ret == VU_NOT_VULNERABLE) {
-            break;
+        if (cmp = strcmp(cond->package, pkg_name), !cmp) {
+            cmp = strcmp(cond->cve, cve_id);
+        }
+
+        if (cmp < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
         }
     }
 
-    if (result != SQLITE_DONE && result != SQLITE_ROW) {
-        return wm_vuldet_sql_error(db, stmt);
+    for (cond = &index->conditions[low]; low < index->size; low++, cond++) {
+        if (strcmp(cond->package, pkg_name) || strcmp(cond->cve, cve_id)) {
+            break;
+        }
+
+        if (!strcmp(cond->operation_value, pkg_version)) {
+            continue;
+        }
+
+        if (cond->status == VU_NOT_FIXED) {
+            ret = VU_NOT_FIXED;
+        } else if (!version_fits) {
+            ret = OS_INVALID;
+        } else if (cond->status) {
+            ret = cond->status;
+        } else {
+            ret = wm_vuldet_relate_versions(&package_evr, cond->relation, &cond->feed_evr, vertype);
+        }
+
+        if (ret == VU_NOT_VULNERABLE) {
+            break;
+        }
     }
 
-    wdb_finalize(stmt);
     return ret;
 }
 
-int wm_vuldet_oval_prescan_SUSE_dependencies(sqlite3 *db, scan_agent *agents_it) {
-    sqlite3_stmt    *stmt = NULL;
-    sqlite3_stmt    *stmt_update = NULL;
-    char            *operation;
-    char            *operation_value;
-    char            *version;
-    char            *pkg_name;
-    char            *revision_delimiter;
-    int             result;
-    int             ret = 0;
+vu_cve_index *wm_vuldet_cve_index_get(sqlite3 *db, scan_agent *agents_it, version_type vertype) {
+    const char          *target = vu_feed_tag[agents_it->dist_ver];
+    sqlite3_stmt        *stmt = NULL;
+    vu_cve_index        *index;
+    vu_cve_condition    *cond;
+    char                *cve;
+    char                *package;
+    char                *operation;
+    char                *operation_value;
+    size_t              allocated = 0;
+    int                 result;
 
-    if (wm_vuldet_prepare(db, vu_queries[VU_GET_SUSE_DEPS], -1, &stmt, NULL) != SQLITE_OK) {
-        return wm_vuldet_sql_error(db, stmt);
+    w_mutex_lock(&vu_cve_index_mutex);
+
+    for (index = vu_cve_indexes; index; index = index->next) {
+        if (index->vertype == vertype && !strcmp(index->target, target)) {
+            goto end;
+        }
     }
-    sqlite3_bind_text(stmt, 1, agents_it->agent_id, -1, NULL);
-    sqlite3_bind_text(stmt, 2, vu_feed_tag[agents_it->dist_ver], -1, NULL);
+
+    if (wm_vuldet_prepare(db, vu_queries[agents_it->dist == FEED_UBUNTU ? VU_GET_CVE_INDEX_UBUNTU : VU_GET_CVE_INDEX], -1, &stmt, NULL) != SQLITE_OK) {
+        wm_vuldet_sql_error(db, stmt);
+        goto end;
+    }
+
+    sqlite3_bind_text(stmt, 1, target, -1, NULL);
+
+    os_calloc(1, sizeof(vu_cve_index), index);
+    os_strdup(target, index->target);
+    index->vertype = vertype;
 
     while (result = wm_vuldet_step(stmt), result == SQLITE_ROW) {
-        version = (char *)sqlite3_column_text(stmt, 0);
-        operation_value = (char *)sqlite3_column_text(stmt, 1);
-        pkg_name = (char *)sqlite3_column_text(stmt, 2);
-        operation = (char *)sqlite3_column_text(stmt, 3);
+        cve = (char *)sqlite3_column_text(stmt, 0);
+        package = (char *)sqlite3_column_text(stmt, 1);
+        operation = (char *)sqlite3_column_text(stmt, 2);
+        operation_value = (char *)sqlite3_column_text(stmt, 3);
 
-        if (!version || !pkg_name || !operation_value || !operation) {
+        if (!cve || !package || !operation || !operation_value) {
             continue;
         }
 
-        /*
-        * Dependency revisions are not included / considered in SUSE feeds comparisons,
-        * so we remove the '-' delimiter to only take the version into account.
-        * Example: (12.3-1.267) turns to (12.3)
-        */
-        if (revision_delimiter = strchr(version, '-'), revision_delimiter) {
-            *(revision_delimiter) = '\0';
+        if (index->size == allocated) {
+            allocated = allocated ? allocated * 2 : VU_CVE_INDEX_SIZE;
+            os_realloc(index->conditions, allocated * sizeof(vu_cve_condition), index->conditions);
         }
-        // Compare the dependency's version against the one in the feed to set the flag if applicable
-        ret = wm_checks_package_vulnerability(version, operation, operation_value, VER_TYPE_RPM);
-        if (ret != VU_NOT_VULNERABLE && ret != OS_INVALID) {
-            if (wm_vuldet_prepare(db, vu_queries[VU_UPDATE_DEPS_FLAG], -1, &stmt_update, NULL) != SQLITE_OK) {
-                return wm_vuldet_sql_error(db, stmt_update);
-            }
+
+        cond = &index->conditions[index->size];
+        memset(cond, 0, sizeof(vu_cve_condition));
+        cond->position = index->size++;
+        os_strdup(package, cond->package);
+        os_strdup(cve, cond->cve);
+        os_strdup(operation, cond->operation);
+        os_strdup(operation_value, cond->operation_value);
+
+        // Split the feed version once, so every package is compared against it directly
+        if (!strcmp(operation_value, version_null)) {
+            cond->status = VU_NOT_FIXED;
+        } else if (strlen(operation_value) >= KEY_SIZE) {
+            cond->status = OS_INVALID;
+        } else {
+            os_strdup(operation_value, cond->feed_version);
+            wm_vuldet_split_version(cond->feed_version, vertype, true, &cond->feed_evr);
+            cond->status = wm_vuldet_feed_condition(operation, &cond->feed_evr, vertype, &cond->relation);
+        }
+    }
+
+    if (result != SQLITE_DONE) {
+        wm_vuldet_free_cve_index(index);
+        index = NULL;
+        wm_vuldet_sql_error(db, stmt);
+        goto end;
+    }
+
+    wdb_finalize(stmt);
+
+    if (index->size) {
+        qsort(index->conditions, index->size, sizeof(vu_cve_condition), wm_vuldet_cve_condition_cmp);
+    }
+
+    index->next = vu_cve_indexes;
+    vu_cve_indexes = index;
+
+end:
+    w_mutex_unlock(&vu_cve_index_mutex);
+    return index;
+}
+
+int wm_vuldet_cve_condition_cmp(const void *a, const void *b) {
+    const vu_cve_condition *cond_a = a;
+    const vu_cve_condition *cond_b = b;
+    int cmp;
+
+    if (cmp = strcmp(cond_a->package, cond_b->package), cmp) {
+        return cmp;
+    }
+    if (cmp = strcmp(cond_a->cve, cond_b->cve), cmp) {
+        return cmp;
+    }
+
+    return (cond_a->position > cond_b->position) - (cond_a->position < cond_b->position);
+}
+
+void wm_vuldet_free_cve_index(vu_cve_index *index) {
+    size_t i;
+
+    for (i = 0; i < index->size; i++) {
+        os_free(index->conditions[i].package);
+        os_free(index->conditions[i].cve);
+        os_free(index->conditions[i].operation);
+        os_free(index->conditions[i].operation_value);
+        os_free(index->conditions[i].feed_version);
+    }
+
+    os_free(index->conditions);
+    os_free(index->target);
+    os_free(index);
+}
+
+void wm_vuldet_cve_index_clean() {
+    vu_cve_index *index;
+
+    w_mutex_lock(&vu_cve_index_mutex);
+
+    while (index = vu_cve_indexes, index) {
+        vu_cve_indexes = index->next;
+        wm_vuldet_free_cve_index(index);
+    }
+
+    w_mutex_unlock(&vu_cve_index_mutex);
+}
+
+int wm_vuldet_oval_prescan_SUSE_dependencies(sqlite3 *db, scan_agent *agents_it) {
+    sqlite3_stmt    *stmt = NULL;
+    sqlite3_stmt    *stmt_update = NULL;
+    char            *operation;
+    char            *operation_value;
+    char            *version;
+    char            *pkg_name;
+    char            *revision_delimiter;
+    int             result;
+    int             ret = 0;
+
+    if (wm_vuldet_prepare(db, vu_queries[VU_GET_SUSE_DEPS], -1, &stmt, NULL) != SQLITE_OK) {
+        return wm_vuldet_sql_error(db, stmt);
+    }
+    sqlite3_bind_text(stmt, 1, agents_it->agent_id, -1, NULL);
+    sqlite3_bind_text(stmt, 2, vu_feed_tag[agents_it->dist_ver], -1, NULL);
+
+    while (result = wm_vuldet_step(stmt), result == SQLITE_ROW) {
+        version = (char *)sqlite3_column_text(stmt, 0);
+        operation_value = (char *)sqlite3_column_text(stmt, 1);
+        pkg_name = (char *)sqlite3_column_text(stmt, 2);
+        operation = (char *)sqlite3_column_text(stmt, 3);
+
+        if (!version || !pkg_name || !operation_value || !operation) {
+            continue;
+        }
+
+        /*
+        * Dependency revisions are not included / considered in SUSE feeds comparisons,
+        * so we remove the '-' delimiter to only take the version into account.
+        * Example: (12.3-1.267) turns to (12.3)
+        */
+        if (revision_delimiter = strchr(version, '-'), revision_delimiter) {
+            *(revision_delimiter) = '\0';
+        }
+        // Compare the dependency's version against the one in the feed to set the flag if applicable
+        ret = wm_checks_package_vulnerability(version, operation, operation_value, VER_TYPE_RPM);
+        if (ret != VU_NOT_VULNERABLE && ret != OS_INVALID) {
+            if (wm_vuldet_prepare(db, vu_queries[VU_UPDATE_DEPS_FLAG], -1, &stmt_update, NULL) != SQLITE_OK) {
+                return wm_vuldet_sql_error(db, stmt_update);
+            }
             sqlite3_bind_text(stmt_update, 1, pkg_name, -1, NULL);
             sqlite3_bind_text(stmt_update, 2, vu_feed_tag[agents_it->dist_ver], -1, NULL);
             sqlite3_bind_text(stmt_update, 3, operation_value, -1, NULL);
@@ -2648,115 +3047,242 @@ int wm_vuldet_find_obsolete_vulnerabilities(scan_ctx_t* scan_ctx) {
     return retval;
 }
 
+int wm_vuldet_scan_agent(wm_vuldet_t *vuldet, sqlite3 *db, scan_agent *agent) {
+    scan_ctx_t scan_ctx = {0};
+    scan_ctx.agent_id = atoi(agent->agent_id);
+    scan_ctx.agent_name = agent->agent_name;
+    scan_ctx.agent_ip = agent->agent_ip;
+    int result;
+
+    time_t start = time(NULL);
+
+    // Check if there are available vulnerabilities for this agent
+    if (agent->dist != FEED_WIN && agent->dist != FEED_MAC) {
+        result = wm_vuldet_db_empty(db, agent->dist_ver);
+        if (result == 0) {
+            // There is no data in the VULNERABILITIES table for this agent
+            // It has to be skipped instead of being scanned against the NVD to avoid false positives
+            mtwarn(WM_VULNDETECTOR_LOGTAG, VU_OVAL_UNAVAILABLE_DATA, scan_ctx.agent_id);
+            agent->pending_attempts = 0;
+            return 0;
+        } else if (result == OS_INVALID) {
+            // DB error
+            return OS_INVALID;
+        }
+    }
+
+    //Check which type of scan is required
+    time_t last_full_scan = wm_vuldet_get_last_full_scan(&scan_ctx);
+    if (last_full_scan < 0) {
+        // DB error
+        return OS_INVALID;
+    }
+    else if (last_full_scan == 0) {
+        scan_ctx.scan_type = VU_BASELINE_SCAN;
+        mtdebug1(WM_VULNDETECTOR_LOGTAG, VU_AG_BASELINE_SCAN, scan_ctx.agent_id);
+    }
+    else if (curr_time - last_full_scan >= vuldet->min_full_scan_interval &&
+            wm_vuldet_feed_changed (vuldet->updates, agent, last_full_scan)) {
+        scan_ctx.scan_type = VU_FULL_SCAN;
+        mtdebug1(WM_VULNDETECTOR_LOGTAG, VU_AG_FULL_SCAN, scan_ctx.agent_id);
+    }
+    else {
+        scan_ctx.scan_type = VU_PARTIAL_SCAN;
+        mtdebug1(WM_VULNDETECTOR_LOGTAG, VU_AG_PART_SCAN, scan_ctx.agent_id);
+    }
+
+    // Reset the tables before scanning each agent
+    wm_vuldet_reset_tables(db);
+
+    // Collect agent software
+    if (OS_SUCCESS != wm_vuldet_collect_agent_software(agent, db, &scan_ctx)) {
+        agent->pending_attempts--;
+        if (agent->pending_attempts) {
+            return 1;
+        }
+        mtinfo(WM_VULNDETECTOR_LOGTAG, VU_GET_SOFTWARE_ERROR, scan_ctx.agent_id, WM_VULNDETECTOR_MAX_AGENT_SCAN_ATTEMPS);
+        return 0;
+    }
+
+    mtinfo(WM_VULNDETECTOR_LOGTAG, VU_START_AG_AN, scan_ctx.agent_id);
+
+    // A full scan is only worth it for the installed packages that changed in the feeds
+    if (scan_ctx.scan_type == VU_FULL_SCAN &&
+        (agent->dist == FEED_UBUNTU || agent->dist == FEED_DEBIAN || agent->dist == FEED_REDHAT) &&
+        !(vuldet->updates[CVE_NVD] && vuldet->updates[CVE_NVD]->last_update > last_full_scan)) {
+
+        if (result = wm_vuldet_feed_affects_agent(db, agent, last_full_scan), result == OS_INVALID) {
+            return OS_INVALID;
+        } else if (!result) {
+            mtdebug1(WM_VULNDETECTOR_LOGTAG, VU_AG_FEED_UNAFFECTED, scan_ctx.agent_id);
+            wm_vuldet_reset_tables(db);
+        } else {
+            mtdebug1(WM_VULNDETECTOR_LOGTAG, VU_AG_FEED_PACKAGES, scan_ctx.agent_id);
+            if (wm_vuldet_select_feed_packages(db, agent, last_full_scan) == OS_INVALID) {
+                return OS_INVALID;
+            }
+        }
+
+        // The packages that are new or updated since the last scan are added by a partial scan
+        scan_ctx.scan_type = VU_PARTIAL_SCAN;
+        scan_ctx.feeds_covered = true;
+
+        if (OS_SUCCESS != wm_vuldet_collect_agent_software(agent, db, &scan_ctx)) {
+            agent->pending_attempts--;
+            if (agent->pending_attempts) {
+                return 1;
+            }
+            mtinfo(WM_VULNDETECTOR_LOGTAG, VU_GET_SOFTWARE_ERROR, scan_ctx.agent_id, WM_VULNDETECTOR_MAX_AGENT_SCAN_ATTEMPS);
+            return 0;
+        }
+    }
+
+    // Find and report agent vulnerabilities
+    if (OS_SUCCESS != wm_vuldet_find_agent_vulnerabilities(db, agent, &vuldet->flags, &scan_ctx)) {
+        mterror(WM_VULNDETECTOR_LOGTAG, VU_REPORT_ERROR, scan_ctx.agent_id, sqlite3_errmsg(db));
+        return OS_INVALID;
+    }
+
+    // Find and report obsolete vulnerabilities
+    if (OS_SUCCESS != wm_vuldet_find_obsolete_vulnerabilities(&scan_ctx) ) {
+        mterror(WM_VULNDETECTOR_LOGTAG, "The agent '%.3d' obsolete vulnerability could not be processed", scan_ctx.agent_id);
+        return OS_INVALID;
+    }
+
+    // Update the time of the last scan
+    wm_vuldet_update_last_scan(&scan_ctx);
+
+    mtinfo(WM_VULNDETECTOR_LOGTAG, VU_AGENT_FINISH, scan_ctx.agent_id);
+    mtdebug1(WM_VULNDETECTOR_LOGTAG, VU_FUNCTION_TIME, time(NULL) - start, "scan", scan_ctx.agent_id);
+    agent->pending_attempts = 0;
+
+    return 0;
+}
+
+scan_agent *wm_vuldet_scan_pool_next(vu_scan_pool *pool) {
+    scan_agent *agent = NULL;
+
+    w_mutex_lock(&pool->mutex);
+
+    if (!pool->abort_scan) {
+        while (pool->next_agent && pool->next_agent->pending_attempts == 0) {
+            pool->next_agent = pool->next_agent->next;
+        }
+
+        if (agent = pool->next_agent, agent) {
+            pool->next_agent = agent->next;
+        }
+    }
+
+    w_mutex_unlock(&pool->mutex);
+
+    return agent;
+}
+
+void wm_vuldet_scan_pool_run(vu_scan_pool *pool, sqlite3 *db, bool private_tables) {
+    scan_agent *agent;
+    bool private_deps = false;
+    int result;
+
+    while (agent = wm_vuldet_scan_pool_next(pool), agent) {
+        // The SUSE prescan flags the installed dependencies, so those agents need a private copy of the table
+        if (private_tables && !private_deps && agent->dist == FEED_SUSE) {
+            if (sqlite3_exec(db, vu_queries[VU_CREATE_SCAN_DEPS], NULL, NULL, NULL) != SQLITE_OK) {
+                mterror(WM_VULNDETECTOR_LOGTAG, VU_SQL_ERROR, sqlite3_errmsg(db));
+                result = OS_INVALID;
+                goto update;
+            }
+            private_deps = true;
+        }
+
+        result = wm_vuldet_scan_agent(pool->vuldet, db, agent);
+
+update:
+        if (result) {
+            w_mutex_lock(&pool->mutex);
+            if (result == OS_INVALID) {
+                pool->abort_scan = true;
+            } else {
+                pool->retry_agents = true;
+                if (!pool->first_fail_scan) pool->first_fail_scan = time(NULL);
+            }
+            w_mutex_unlock(&pool->mutex);
+        }
+    }
+}
+
+void *wm_vuldet_scan_worker(vu_scan_pool *pool) {
+    sqlite3 *db = NULL;
+
+    // Workers only read the feeds. The tables filled for each agent are private to this connection
+    if (sqlite3_open_v2(CVE_DB, &db, SQLITE_OPEN_READONLY, NULL) != SQLITE_OK ||
+        sqlite3_exec(db, vu_queries[VU_CREATE_SCAN_TABLES], NULL, NULL, NULL) != SQLITE_OK) {
+        mterror(WM_VULNDETECTOR_LOGTAG, VU_SQL_ERROR, sqlite3_errmsg(db));
+        w_mutex_lock(&pool->mutex);
+        pool->abort_scan = true;
+        w_mutex_unlock(&pool->mutex);
+    } else {
+        wm_vuldet_scan_pool_run(pool, db, true);
+    }
+
+    sqlite3_close_v2(db);
+    wm_vuldet_close_wdb();
+
+    return NULL;
+}
+
 int wm_vuldet_check_agent_vulnerabilities(wm_vuldet_t *vuldet) {
-    scan_agent *agents_it;
-    sqlite3 *db;
+    sqlite3 *db = NULL;
     sqlite3_stmt *stmt = NULL;
-    bool retry_agents = false;
-    bool abort_scan = false;
-    int result;
+    pthread_t *workers = NULL;
+    vu_scan_pool pool = { .vuldet = vuldet, .mutex = PTHREAD_MUTEX_INITIALIZER };
+    int i;
 
     if (!vuldet->scan_agents) {
         mtinfo(WM_VULNDETECTOR_LOGTAG, VU_AG_NO_TARGET);
         return 0;
+    }
+
+    if (vuldet->scan_workers > 1) {
+        os_calloc(vuldet->scan_workers, sizeof(pthread_t), workers);
     } else if (sqlite3_open_v2(CVE_DB, &db, SQLITE_OPEN_READWRITE, NULL) != SQLITE_OK) {
         mterror(WM_VULNDETECTOR_LOGTAG, VU_CVEDB_ERROR);
         return wm_vuldet_sql_error(db, stmt);
     }
 
+    // Agents sharing the same images compare the same versions, so the results are kept during the scan
+    pkg_version_cache_init();
+
     // Iterate agents to look for vulnerabilities
     do {
-        retry_agents = false;
-        time_t first_fail_scan = 0;
-        for (agents_it = vuldet->scan_agents; agents_it; agents_it = agents_it->next) {
-            scan_ctx_t scan_ctx = {0};
-            scan_ctx.agent_id = atoi(agents_it->agent_id);
-            scan_ctx.agent_name = agents_it->agent_name;
-            scan_ctx.agent_ip = agents_it->agent_ip;
-
-            if (agents_it->pending_attempts == 0) continue;
-
-            time_t start = time(NULL);
-
-            // Check if there are available vulnerabilities for this agent
-            if (agents_it->dist != FEED_WIN && agents_it->dist != FEED_MAC) {
-                result = wm_vuldet_db_empty(db, agents_it->dist_ver);
-                if (result == 0) {
-                    // There is no data in the VULNERABILITIES table for this agent
-                    // It has to be skipped instead of being scanned against the NVD to avoid false positives
-                    mtwarn(WM_VULNDETECTOR_LOGTAG, VU_OVAL_UNAVAILABLE_DATA, scan_ctx.agent_id);
-                    agents_it->pending_attempts = 0;
-                    continue;
-                } else if (result == OS_INVALID) {
-                    // DB error
-                    abort_scan = true;
-                    break;
-                }
-            }
+        pool.next_agent = vuldet->scan_agents;
+        pool.retry_agents = false;
+        pool.first_fail_scan = 0;
 
-            //Check which type of scan is required
-            time_t last_full_scan = wm_vuldet_get_last_full_scan(&scan_ctx);
-            if (last_full_scan < 0) {
-                // DB error
-                abort_scan = true;
-                break;
-            }
-            else if (last_full_scan == 0) {
-                scan_ctx.scan_type = VU_BASELINE_SCAN;
-                mtdebug1(WM_VULNDETECTOR_LOGTAG, VU_AG_BASELINE_SCAN, scan_ctx.agent_id);
-            }
-            else if (curr_time - last_full_scan >= vuldet->min_full_scan_interval &&
-                    wm_vuldet_feed_changed (vuldet->updates, agents_it, last_full_scan)) {
-                scan_ctx.scan_type = VU_FULL_SCAN;
-                mtdebug1(WM_VULNDETECTOR_LOGTAG, VU_AG_FULL_SCAN, scan_ctx.agent_id);
-            }
-            else {
-                scan_ctx.scan_type = VU_PARTIAL_SCAN;
-                mtdebug1(WM_VULNDETECTOR_LOGTAG, VU_AG_PART_SCAN, scan_ctx.agent_id);
-            }
-
-            // Reset the tables before scanning each agent
-            wm_vuldet_reset_tables(db);
+        if (workers) {
+            int started = 0;
 
-            // Collect agent software
-            if (OS_SUCCESS != wm_vuldet_collect_agent_software(agents_it, db, &scan_ctx)) {
-                agents_it->pending_attempts--;
-                if (agents_it->pending_attempts) {
-                    retry_agents = true;
-                    if (!first_fail_scan) first_fail_scan = time(NULL);
-                }
-                else {
-                    mtinfo(WM_VULNDETECTOR_LOGTAG, VU_GET_SOFTWARE_ERROR, scan_ctx.agent_id, WM_VULNDETECTOR_MAX_AGENT_SCAN_ATTEMPS);
+            for (i = 0; i < vuldet->scan_workers; i++) {
+                if (CreateThreadJoinable(&workers[i], (void *(*)(void *))wm_vuldet_scan_worker, &pool) < 0) {
+                    mterror(WM_VULNDETECTOR_LOGTAG, "Could not create the scan worker %d: %s (%d)", i, strerror(errno), errno);
+                    break;
                 }
-                continue;
+                started++;
             }
 
-            mtinfo(WM_VULNDETECTOR_LOGTAG, VU_START_AG_AN, scan_ctx.agent_id);
-
-            // Find and report agent vulnerabilities
-            if (OS_SUCCESS != wm_vuldet_find_agent_vulnerabilities(db, agents_it, &vuldet->flags, &scan_ctx)) {
-                mterror(WM_VULNDETECTOR_LOGTAG, VU_REPORT_ERROR, scan_ctx.agent_id, sqlite3_errmsg(db));
-                abort_scan = true;
-                break;
+            if (!started) {
+                pool.abort_scan = true;
             }
 
-            // Find and report obsolete vulnerabilities
-            if (OS_SUCCESS != wm_vuldet_find_obsolete_vulnerabilities(&scan_ctx) ) {
-                mterror(WM_VULNDETECTOR_LOGTAG, "The agent '%.3d' obsolete vulnerability could not be processed", scan_ctx.agent_id);
-                abort_scan = true;
-                break;
+            for (i = 0; i < started; i++) {
+                pthread_join(workers[i], NULL);
             }
-
-            // Update the time of the last scan
-            wm_vuldet_update_last_scan(&scan_ctx);
-
-            mtinfo(WM_VULNDETECTOR_LOGTAG, VU_AGENT_FINISH, scan_ctx.agent_id);
-            mtdebug1(WM_VULNDETECTOR_LOGTAG, VU_FUNCTION_TIME, time(NULL) - start, "scan", scan_ctx.agent_id);
-            agents_it->pending_attempts = 0;
+        } else {
+            wm_vuldet_scan_pool_run(&pool, db, false);
         }
 
-        if (retry_agents) {
-            time_t sleep_time = first_fail_scan + vuldet->retry_interval - time(NULL);
+        if (pool.retry_agents && !pool.abort_scan) {
+            time_t sleep_time = pool.first_fail_scan + vuldet->retry_interval - time(NULL);
             if (sleep_time <= 0) {
                 sleep_time = 1;
             }
@@ -2764,7 +3290,15 @@ int wm_vuldet_check_agent_vulnerabilities(wm_vuldet_t *vuldet) {
             sleep (sleep_time);
         }
 
-    } while (retry_agents && !abort_scan);
+    } while (pool.retry_agents && !pool.abort_scan);
+
+    pthread_mutex_destroy(&pool.mutex);
+    pkg_version_cache_free();
+
+    if (workers) {
+        os_free(workers);
+        return 0;
+    }
 
     // Reset the tables
     wm_vuldet_reset_tables(db);
@@ -3054,26 +3588,11 @@ int wm_vuldet_insert_cve_info(wm_vuldet_db *parsed_oval, sqlite3 *db, sqlite3_st
     return 0;
 }
 
-int wm_vuldet_insert(wm_vuldet_db *parsed_oval, update_node *update) {
+int wm_vuldet_insert_open(wm_vuldet_db *parsed_oval, update_node *update) {
     sqlite3 *db;
     sqlite3_stmt *stmt = NULL;
-    int result;
-    const char *query;
-    char **dependency = NULL;
-    int deps_size = 0;
-    bool deps_modified = false;
-    oval_metadata *met_it = &parsed_oval->metadata;
-    vulnerability *vul_it = parsed_oval->vulnerabilities;
-    dependencies *deps_it = parsed_oval->suse_deps;
-    info_state *state_it = parsed_oval->info_states;
-    info_obj *obj_it = parsed_oval->info_objs;
-    info_test *test_it = parsed_oval->info_tests;
-    cpe_list *cpes_it = parsed_oval->nvd_cpes;
-    nvd_vulnerability *nvd_it = parsed_oval->nvd_vulnerabilities;
-    vu_cpe_dic *w_cpes_it = parsed_oval->w_cpes;
-    vu_msu_entries *msu_it = &parsed_oval->msu;
-    variables *vars_it = parsed_oval->vars;
-    vu_alas_vuln *alas_it = parsed_oval->alas_vuln;
+
+    parsed_oval->insert.db = NULL;
 
     if (sqlite3_open_v2(CVE_DB, &db, SQLITE_OPEN_READWRITE, NULL) != SQLITE_OK) {
         return wm_vuldet_sql_error(db, stmt);
@@ -3135,68 +3654,26 @@ int wm_vuldet_insert(wm_vuldet_db *parsed_oval, update_node *update) {
             return OS_INVALID;
     }
 
-    mtdebug2(WM_VULNDETECTOR_LOGTAG, VU_UPDATE_VU);
-
-    if (cpes_it) {
-        mtdebug2(WM_VULNDETECTOR_LOGTAG, VU_INS_CPES_SEC);
-
-        if (wm_vuldet_insert_cpe_db(db, cpes_it, 1)){
-            mterror(WM_VULNDETECTOR_LOGTAG, VU_CPES_INSERT_ERROR);
-            wm_vuldet_free_cpe_list(cpes_it);
-            free(cpes_it);
-            sqlite3_close_v2(db);
-            return OS_INVALID;
-        }
-        wm_vuldet_free_cpe_list(cpes_it);
-        free(cpes_it);
-    }
-
-    if (w_cpes_it) {
-        mtdebug2(WM_VULNDETECTOR_LOGTAG, VU_INS_CPES_DIC);
-
-        if (wm_vuldet_insert_cpe_dic(db, w_cpes_it)){
-            mterror(WM_VULNDETECTOR_LOGTAG, VU_CPES_INSERT_ERROR);
-            return OS_INVALID;
-        }
-        free(w_cpes_it);
-    }
-
-    if (msu_it->vul) {
-        mtdebug2(WM_VULNDETECTOR_LOGTAG, VU_INS_MSU);
-
-        if (wm_vuldet_insert_MSU(db, msu_it)){
-            return OS_INVALID;
-        }
-    }
-
-    if (alas_it) {
-        mtdebug2(WM_VULNDETECTOR_LOGTAG, VU_INS_VUL_SEC, "ALAS");
-
-        if (wm_vuldet_insert_ALAS(db, alas_it, vu_feed_tag[update->dist_tag_ref])){
-            return OS_INVALID;
-        }
-    }
+    parsed_oval->insert.db = db;
+    return 0;
+}
 
-    if (nvd_it) {
-        mtdebug2(WM_VULNDETECTOR_LOGTAG, VU_INS_VUL_SEC, "NVD");
-        if (wm_vuldet_index_nvd(db, update, nvd_it)) {
-            wm_vuldet_sql_error(db, stmt);
-            return OS_INVALID;
-        }
-        parsed_oval->nvd_vulnerabilities = NULL;
-    }
+int wm_vuldet_insert_oval_vulnerabilities(sqlite3 *db, wm_vuldet_db *parsed_oval, bool keep_last) {
+    sqlite3_stmt *stmt = NULL;
+    vu_insert_ctx *ctx = &parsed_oval->insert;
+    vulnerability *vul_it = parsed_oval->vulnerabilities;
+    bool deps_modified = false;
+    int result;
 
-    // Adds the dependencies
-    if (deps_it) {
-        mtdebug2(WM_VULNDETECTOR_LOGTAG, VU_INS_DEPS, "SUSE");
-        if (wm_vuldet_insert_deps(db, deps_it, parsed_oval)){
-            return OS_INVALID;
+    if (keep_last) {
+        // The SUSE dependencies of the next definition may be copied from the last vulnerability
+        if (!vul_it) {
+            return 0;
         }
-    }
-
-    // Adds the vulnerabilities
-    if (vul_it) {
-        mtdebug2(WM_VULNDETECTOR_LOGTAG, VU_INS_VUL_SEC, update->dist_ext);
+        vul_it = parsed_oval->vulnerabilities->prev;
+        parsed_oval->vulnerabilities->prev = NULL;
+    } else {
+        parsed_oval->vulnerabilities = NULL;
     }
 
     while (vul_it) {
@@ -3226,20 +3703,20 @@ int wm_vuldet_insert(wm_vuldet_db *parsed_oval, update_node *update) {
             sqlite3_bind_int(stmt, 9, 0);
             if (vul_it->deps) {
                 // Check the dependency array to avoid inserting more IDs than necessary
-                if (deps_size != vul_it->deps->elements) {
+                if (ctx->deps_size != vul_it->deps->elements) {
                     deps_modified = true;
                 } else {
-                    for (int i = 0; i < deps_size; ++i) {
-                        if (dependency[i] != vul_it->deps->test_ref[i]) {
+                    for (int i = 0; i < ctx->deps_size; ++i) {
+                        if (ctx->dependency[i] != vul_it->deps->test_ref[i]) {
                             deps_modified = true;
                             break;
                         }
                     }
                 }
                 if(deps_modified) {
-                    os_free(dependency);
-                    deps_size = vul_it->deps->elements;
-                    dependency = vul_it->deps->test_ref;
+                    os_free(ctx->dependency);
+                    ctx->deps_size = vul_it->deps->elements;
+                    ctx->dependency = vul_it->deps->test_ref;
                     ++deps_id;
                 } else {
                     os_free(vul_it->deps->test_ref);
@@ -3261,7 +3738,7 @@ int wm_vuldet_insert(wm_vuldet_db *parsed_oval, update_node *update) {
                         return wm_vuldet_sql_error(db, stmt);
                     }
                     sqlite3_bind_int(stmt, 1, deps_id);
-                    sqlite3_bind_text(stmt, 2, dependency[i], -1, NULL);
+                    sqlite3_bind_text(stmt, 2, ctx->dependency[i], -1, NULL);
                     sqlite3_bind_text(stmt, 3, parsed_oval->OS, -1, NULL);
 
                     if (result = wm_vuldet_step(stmt), result != SQLITE_DONE && result != SQLITE_CONSTRAINT) {
@@ -3284,16 +3761,15 @@ int wm_vuldet_insert(wm_vuldet_db *parsed_oval, update_node *update) {
         os_free(vul_aux);
     }
 
-    // Adds Debian vulnerabilities
-    if (update->dist_ref == FEED_DEBIAN) {
-        if (wm_vuldet_index_debian(db, vu_feed_tag[update->dist_tag_ref], update) == OS_INVALID) {
-            return wm_vuldet_sql_error(db, stmt);
-        }
-    }
+    return 0;
+}
 
-    if (test_it) {
-        mtdebug2(WM_VULNDETECTOR_LOGTAG, VU_INS_TEST_SEC, update->dist_ext);
-    }
+int wm_vuldet_insert_oval_tests(sqlite3 *db, wm_vuldet_db *parsed_oval) {
+    sqlite3_stmt *stmt = NULL;
+    info_test *test_it = parsed_oval->info_tests;
+    int result;
+
+    parsed_oval->info_tests = NULL;
 
     // Links vulnerabilities to their conditions
     while (test_it) {
@@ -3339,26 +3815,33 @@ int wm_vuldet_insert(wm_vuldet_db *parsed_oval, update_node *update) {
         free(test_aux);
     }
 
-    if (state_it) {
-        mtdebug2(WM_VULNDETECTOR_LOGTAG, VU_UPDATE_VU_CO, update->dist_ext);
+    return 0;
+}
+
+int wm_vuldet_insert_oval_states(sqlite3 *db, wm_vuldet_db *parsed_oval, update_node *update) {
+    sqlite3_stmt *stmt = NULL;
+    vu_insert_ctx *ctx = &parsed_oval->insert;
+    info_state *state_it = parsed_oval->info_states;
+    int result;
 
+    parsed_oval->info_states = NULL;
+
+    if (state_it && !ctx->unused_vuls_removed) {
         sqlite3_exec(db, vu_queries[VU_REMOVE_UNUSED_VULS], NULL, NULL, NULL);
+        ctx->unused_vuls_removed = true;
     }
 
     // Sets the OVAL operators and values
-    int arch_id = 0;
-
     while (state_it) {
         if (state_it->operation_value != NULL) {
 
             // Get ID to insert architectures
             if (state_it->arch && (update->dist_ref == FEED_REDHAT || update->dist_ref == FEED_SUSE)) {
-                arch_id++;
+                ctx->arch_id++;
             }
 
             // Replace the state ID by the real values
-            query = vu_queries[VU_UPDATE_CVE_VAL];
-            if (wm_vuldet_prepare(db, query, -1, &stmt, NULL) != SQLITE_OK) {
+            if (wm_vuldet_prepare(db, vu_queries[VU_UPDATE_CVE_VAL], -1, &stmt, NULL) != SQLITE_OK) {
                 return wm_vuldet_sql_error(db, stmt);
             }
 
@@ -3371,7 +3854,7 @@ int wm_vuldet_insert(wm_vuldet_db *parsed_oval, update_node *update) {
                 sqlite3_bind_text(stmt, 2, (state_it->operation_value + 2), -1, NULL);
             }
 
-            sqlite3_bind_int(stmt, 3, state_it->arch ? arch_id : 0);
+            sqlite3_bind_int(stmt, 3, state_it->arch ? ctx->arch_id : 0);
             sqlite3_bind_text(stmt, 4, state_it->id, -1, NULL);
 
             if (result = wm_vuldet_step(stmt), result != SQLITE_DONE && result != SQLITE_CONSTRAINT) {
@@ -3380,13 +3863,13 @@ int wm_vuldet_insert(wm_vuldet_db *parsed_oval, update_node *update) {
             wdb_finalize(stmt);
 
             // Insert architecture values
-            if (arch_id && state_it->arch) {
+            if (ctx->arch_id && state_it->arch) {
                 for (int i = 0; state_it->arch[i]; i++) {
                     if (wm_vuldet_prepare(db, vu_queries[VU_UPDATE_ARCH], -1, &stmt, NULL) != SQLITE_OK) {
                         return wm_vuldet_sql_error(db, stmt);
                     }
 
-                    sqlite3_bind_int(stmt, 1, arch_id);
+                    sqlite3_bind_int(stmt, 1, ctx->arch_id);
                     sqlite3_bind_text(stmt, 2, parsed_oval->OS, -1, NULL);
                     sqlite3_bind_text(stmt, 3, state_it->arch[i], -1, NULL);
 
@@ -3408,9 +3891,15 @@ int wm_vuldet_insert(wm_vuldet_db *parsed_oval, update_node *update) {
         os_free(state_aux);
     }
 
-    if (obj_it) {
-        mtdebug2(WM_VULNDETECTOR_LOGTAG, VU_UPDATE_PACK_NAME, update->dist_ext);
-    }
+    return 0;
+}
+
+int wm_vuldet_insert_oval_objects(sqlite3 *db, wm_vuldet_db *parsed_oval) {
+    sqlite3_stmt *stmt = NULL;
+    info_obj *obj_it = parsed_oval->info_objs;
+    int result;
+
+    parsed_oval->info_objs = NULL;
 
     // Sets the OVAL package name
     while (obj_it) {
@@ -3446,14 +3935,19 @@ int wm_vuldet_insert(wm_vuldet_db *parsed_oval, update_node *update) {
         free(obj_aux);
     }
 
-    if (vars_it) {
-        mtdebug2(WM_VULNDETECTOR_LOGTAG, VU_INS_VARIABLES, update->dist_ext);
-    }
+    return 0;
+}
+
+int wm_vuldet_insert_oval_variables(sqlite3 *db, wm_vuldet_db *parsed_oval) {
+    sqlite3_stmt *stmt = NULL;
+    variables *vars_it = parsed_oval->vars;
+    int result;
+
+    parsed_oval->vars = NULL;
 
     // Sets the OVAL variables
     while (vars_it) {
         char *normalized_id = NULL;
-        query = vu_queries[VU_INSERT_VARIABLES];
 
         if (vars_it->id) {
             int j;
@@ -3461,7 +3955,7 @@ int wm_vuldet_insert(wm_vuldet_db *parsed_oval, update_node *update) {
 
             for (j = 0; vars_it->values[j]; j++) {
                 char *normalized_name = NULL;
-                if (wm_vuldet_prepare(db, query, -1, &stmt, NULL) != SQLITE_OK) {
+                if (wm_vuldet_prepare(db, vu_queries[VU_INSERT_VARIABLES], -1, &stmt, NULL) != SQLITE_OK) {
                     os_free(normalized_id);
                     return wm_vuldet_sql_error(db, stmt);
                 }
@@ -3488,6 +3982,136 @@ int wm_vuldet_insert(wm_vuldet_db *parsed_oval, update_node *update) {
         free(var_aux);
     }
 
+    return 0;
+}
+
+int wm_vuldet_insert(wm_vuldet_db *parsed_oval, update_node *update) {
+    sqlite3 *db;
+    sqlite3_stmt *stmt = NULL;
+    int result;
+    oval_metadata *met_it = &parsed_oval->metadata;
+    dependencies *deps_it = parsed_oval->suse_deps;
+    cpe_list *cpes_it = parsed_oval->nvd_cpes;
+    nvd_vulnerability *nvd_it = parsed_oval->nvd_vulnerabilities;
+    vu_cpe_dic *w_cpes_it = parsed_oval->w_cpes;
+    vu_msu_entries *msu_it = &parsed_oval->msu;
+    vu_alas_vuln *alas_it = parsed_oval->alas_vuln;
+
+    // Streamed feeds have already been partially inserted
+    if (!parsed_oval->insert.db && wm_vuldet_insert_open(parsed_oval, update)) {
+        return OS_INVALID;
+    }
+
+    db = parsed_oval->insert.db;
+    parsed_oval->insert.db = NULL;
+
+    mtdebug2(WM_VULNDETECTOR_LOGTAG, VU_UPDATE_VU);
+
+    if (cpes_it) {
+        mtdebug2(WM_VULNDETECTOR_LOGTAG, VU_INS_CPES_SEC);
+
+        if (wm_vuldet_insert_cpe_db(db, cpes_it, 1)){
+            mterror(WM_VULNDETECTOR_LOGTAG, VU_CPES_INSERT_ERROR);
+            wm_vuldet_free_cpe_list(cpes_it);
+            free(cpes_it);
+            sqlite3_close_v2(db);
+            return OS_INVALID;
+        }
+        wm_vuldet_free_cpe_list(cpes_it);
+        free(cpes_it);
+    }
+
+    if (w_cpes_it) {
+        mtdebug2(WM_VULNDETECTOR_LOGTAG, VU_INS_CPES_DIC);
+
+        if (wm_vuldet_insert_cpe_dic(db, w_cpes_it)){
+            mterror(WM_VULNDETECTOR_LOGTAG, VU_CPES_INSERT_ERROR);
+            return OS_INVALID;
+        }
+        free(w_cpes_it);
+    }
+
+    if (msu_it->vul) {
+        mtdebug2(WM_VULNDETECTOR_LOGTAG, VU_INS_MSU);
+
+        if (wm_vuldet_insert_MSU(db, msu_it)){
+            return OS_INVALID;
+        }
+    }
+
+    if (alas_it) {
+        mtdebug2(WM_VULNDETECTOR_LOGTAG, VU_INS_VUL_SEC, "ALAS");
+
+        if (wm_vuldet_insert_ALAS(db, alas_it, vu_feed_tag[update->dist_tag_ref])){
+            return OS_INVALID;
+        }
+    }
+
+    if (nvd_it || parsed_oval->insert.nvd_cves) {
+        mtdebug2(WM_VULNDETECTOR_LOGTAG, VU_INS_VUL_SEC, "NVD");
+        if (wm_vuldet_index_nvd(db, update, nvd_it, parsed_oval->insert.nvd_cves)) {
+            wm_vuldet_sql_error(db, stmt);
+            return OS_INVALID;
+        }
+        parsed_oval->nvd_vulnerabilities = NULL;
+    }
+
+    // Adds the dependencies
+    if (deps_it) {
+        mtdebug2(WM_VULNDETECTOR_LOGTAG, VU_INS_DEPS, "SUSE");
+        if (wm_vuldet_insert_deps(db, deps_it, parsed_oval)){
+            return OS_INVALID;
+        }
+    }
+
+    // Adds the vulnerabilities
+    if (parsed_oval->vulnerabilities) {
+        mtdebug2(WM_VULNDETECTOR_LOGTAG, VU_INS_VUL_SEC, update->dist_ext);
+    }
+
+    if (wm_vuldet_insert_oval_vulnerabilities(db, parsed_oval, false)) {
+        return OS_INVALID;
+    }
+
+    // Adds Debian vulnerabilities
+    if (update->dist_ref == FEED_DEBIAN) {
+        if (wm_vuldet_index_debian(db, vu_feed_tag[update->dist_tag_ref], update) == OS_INVALID) {
+            return wm_vuldet_sql_error(db, stmt);
+        }
+    }
+
+    if (parsed_oval->info_tests) {
+        mtdebug2(WM_VULNDETECTOR_LOGTAG, VU_INS_TEST_SEC, update->dist_ext);
+    }
+
+    if (wm_vuldet_insert_oval_tests(db, parsed_oval)) {
+        return OS_INVALID;
+    }
+
+    if (parsed_oval->info_states) {
+        mtdebug2(WM_VULNDETECTOR_LOGTAG, VU_UPDATE_VU_CO, update->dist_ext);
+    }
+
+    if (wm_vuldet_insert_oval_states(db, parsed_oval, update)) {
+        return OS_INVALID;
+    }
+
+    if (parsed_oval->info_objs) {
+        mtdebug2(WM_VULNDETECTOR_LOGTAG, VU_UPDATE_PACK_NAME, update->dist_ext);
+    }
+
+    if (wm_vuldet_insert_oval_objects(db, parsed_oval)) {
+        return OS_INVALID;
+    }
+
+    if (parsed_oval->vars) {
+        mtdebug2(WM_VULNDETECTOR_LOGTAG, VU_INS_VARIABLES, update->dist_ext);
+    }
+
+    if (wm_vuldet_insert_oval_variables(db, parsed_oval)) {
+        return OS_INVALID;
+    }
+
     // Discard the CVE info from the RHEL OVALs
     if (parsed_oval->info_cves && (update->dist_ref != FEED_REDHAT)) {
         mtdebug2(WM_VULNDETECTOR_LOGTAG, VU_UPDATE_VU_INFO, update->dist_ext);
@@ -3502,8 +4126,16 @@ int wm_vuldet_insert(wm_vuldet_db *parsed_oval, update_node *update) {
     }
 
     wm_vuldet_clean_vulnerability_info(parsed_oval);
+    parsed_oval->info_cves = NULL;
+
+    wm_vuldet_clean_dependencies(deps_it, parsed_oval->insert.dependency);
+    parsed_oval->insert.dependency = NULL;
 
-    wm_vuldet_clean_dependencies(deps_it, dependency);
+    // Keep track of the packages whose conditions changed in this OVAL
+    if ((update->dist_ref == FEED_UBUNTU || update->dist_ref == FEED_DEBIAN || update->dist_ref == FEED_REDHAT) &&
+        wm_vuldet_update_package_hashes(db, parsed_oval->OS)) {
+        return OS_INVALID;
+    }
 
     if (wm_vuldet_prepare(db, vu_queries[VU_INSERT_METADATA], -1, &stmt, NULL) != SQLITE_OK) {
         return wm_vuldet_sql_error(db, stmt);
@@ -3514,22 +4146,140 @@ int wm_vuldet_insert(wm_vuldet_db *parsed_oval, update_node *update) {
     sqlite3_bind_text(stmt, 3, met_it->product_version, -1, NULL);
     sqlite3_bind_text(stmt, 4, met_it->schema_version, -1, NULL);
     sqlite3_bind_text(stmt, 5, met_it->timestamp, -1, NULL);
-    sqlite3_bind_text(stmt, 6, NULL, -1, NULL);
+    sqlite3_bind_text(stmt, 6, *parsed_oval->insert.feed_hash ? parsed_oval->insert.feed_hash : NULL, -1, NULL);
     sqlite3_bind_int(stmt, 7, 0);
     sqlite3_bind_int(stmt, 8, 0);
 
-    if (result = wm_vuldet_step(stmt), result != SQLITE_DONE && result != SQLITE_CONSTRAINT) {
+    if (result = wm_vuldet_step(stmt), result != SQLITE_DONE && result != SQLITE_CONSTRAINT) {
+        return wm_vuldet_sql_error(db, stmt);
+    }
+    wdb_finalize(stmt);
+
+    free(met_it->product_name);
+    free(met_it->product_version);
+    free(met_it->schema_version);
+    free(met_it->timestamp);
+
+    sqlite3_exec(db, vu_queries[END_T], NULL, NULL, NULL);
+    sqlite3_close_v2(db);
+    return 0;
+}
+
+bool wm_vuldet_feed_unchanged(const char *target, const char *path, os_sha256 feed_hash) {
+    char *stored_hash;
+    bool unchanged;
+
+    if (OS_SHA256_File(path, feed_hash, OS_BINARY)) {
+        *feed_hash = '\0';
+        return false;
+    }
+
+    stored_hash = wm_vuldet_get_hash(target);
+    unchanged = stored_hash && !strcmp(stored_hash, feed_hash);
+    os_free(stored_hash);
+
+    return unchanged;
+}
+
+int wm_vuldet_update_package_hashes(sqlite3 *db, const char *target) {
+    sqlite3_stmt *stmt = NULL;
+    sqlite3_stmt *hash_stmt = NULL;
+    char *package = NULL;
+    const char *name;
+    SHA_CTX ctx;
+    os_sha1 hash;
+    int changes;
+    int result;
+
+    if (sqlite3_exec(db, vu_queries[VU_CREATE_FEED_HASHES], NULL, NULL, NULL) != SQLITE_OK) {
+        return wm_vuldet_sql_error(db, NULL);
+    }
+
+    if (wm_vuldet_prepare(db, vu_queries[VU_INSERT_FEED_HASH], -1, &hash_stmt, NULL) != SQLITE_OK) {
+        return wm_vuldet_sql_error(db, hash_stmt);
+    }
+
+    if (wm_vuldet_prepare(db, vu_queries[VU_GET_FEED_PACKAGES], -1, &stmt, NULL) != SQLITE_OK) {
+        wdb_finalize(hash_stmt);
+        return wm_vuldet_sql_error(db, stmt);
+    }
+
+    sqlite3_bind_text(stmt, 1, target, -1, NULL);
+
+    while (1) {
+        result = wm_vuldet_step(stmt);
+        name = result == SQLITE_ROW ? (const char *) sqlite3_column_text(stmt, 0) : NULL;
+
+        if (result == SQLITE_ROW && !name) {
+            continue;
+        }
+
+        // The rows are sorted by package, so its digest is complete when the next one starts
+        if (package && (!name || strcmp(package, name))) {
+            OS_SHA1_Stream(&ctx, hash, NULL);
+            sqlite3_bind_text(hash_stmt, 1, package, -1, NULL);
+            sqlite3_bind_text(hash_stmt, 2, hash, -1, NULL);
+
+            if (wm_vuldet_step(hash_stmt) != SQLITE_DONE) {
+                os_free(package);
+                wdb_finalize(hash_stmt);
+                return wm_vuldet_sql_error(db, stmt);
+            }
+            sqlite3_reset(hash_stmt);
+            os_free(package);
+        }
+
+        if (!name) {
+            break;
+        }
+
+        if (!package) {
+            os_strdup(name, package);
+            SHA1_Init(&ctx);
+        }
+
+        // CVE, operation, operation value and ignore flag
+        for (int i = 1; i < 5; i++) {
+            OS_SHA1_Stream(&ctx, NULL, (char *) sqlite3_column_text(stmt, i));
+            OS_SHA1_Stream(&ctx, NULL, "|");
+        }
+    }
+
+    wdb_finalize(hash_stmt);
+
+    if (result != SQLITE_DONE) {
+        return wm_vuldet_sql_error(db, stmt);
+    }
+    wdb_finalize(stmt);
+
+    // Packages no longer present in the feed
+    if (wm_vuldet_prepare(db, vu_queries[VU_REMOVE_PKG_HASHES], -1, &stmt, NULL) != SQLITE_OK) {
+        return wm_vuldet_sql_error(db, stmt);
+    }
+
+    sqlite3_bind_text(stmt, 1, target, -1, NULL);
+
+    if (wm_vuldet_step(stmt) != SQLITE_DONE) {
+        return wm_vuldet_sql_error(db, stmt);
+    }
+    changes = sqlite3_changes(db);
+    wdb_finalize(stmt);
+
+    // New packages and packages whose conditions changed
+    if (wm_vuldet_prepare(db, vu_queries[VU_UPDATE_PKG_HASHES], -1, &stmt, NULL) != SQLITE_OK) {
+        return wm_vuldet_sql_error(db, stmt);
+    }
+
+    sqlite3_bind_text(stmt, 1, target, -1, NULL);
+
+    if (wm_vuldet_step(stmt) != SQLITE_DONE) {
         return wm_vuldet_sql_error(db, stmt);
     }
+    changes += sqlite3_changes(db);
     wdb_finalize(stmt);
 
-    free(met_it->product_name);
-    free(met_it->product_version);
-    free(met_it->schema_version);
-    free(met_it->timestamp);
+    mtdebug1(WM_VULNDETECTOR_LOGTAG, VU_PKG_HASHES_UPDATE, changes, target);
 
-    sqlite3_exec(db, vu_queries[END_T], NULL, NULL, NULL);
-    sqlite3_close_v2(db);
     return 0;
 }
 
@@ -4468,45 +5218,320 @@ invalid_elem:
     return OS_INVALID;
 }
 
-int wm_vuldet_oval_process(update_node *update, char *path, wm_vuldet_db *parsed_vulnerabilities) {
-    int success = 0;
-    char *tmp_file;
+int wm_vuldet_oval_stream_flush(wm_vuldet_db *parsed_oval, update_node *update) {
+    vu_insert_ctx *ctx = &parsed_oval->insert;
+    sqlite3 *db = ctx->db;
+
+    ctx->pending = 0;
+
+    // Without an open insertion, everything is inserted at the end
+    if (!db) {
+        return 0;
+    }
+
+    // The last vulnerability is kept since the next definition may take its dependencies
+    if (wm_vuldet_insert_oval_vulnerabilities(db, parsed_oval, !ctx->definitions_done)) {
+        goto error;
+    }
+
+    // Discard the CVE info from the RHEL OVALs
+    if (parsed_oval->info_cves && update->dist_ref != FEED_REDHAT) {
+        if (wm_vuldet_insert_cve_info(parsed_oval, db, NULL)) {
+            goto error;
+        }
+    }
+    wm_vuldet_clean_vulnerability_info(parsed_oval);
+    parsed_oval->info_cves = NULL;
+
+    // Tests link every CVE to its conditions, so they need all the definitions.
+    // The SUSE checks are kept until the end to resolve the dependencies.
+    if (ctx->definitions_done && update->dist_ref != FEED_SUSE) {
+        if (wm_vuldet_insert_oval_tests(db, parsed_oval)) {
+            goto error;
+        }
+
+        if (ctx->tests_done) {
+            if (wm_vuldet_insert_oval_states(db, parsed_oval, update) ||
+                wm_vuldet_insert_oval_objects(db, parsed_oval)) {
+                goto error;
+            }
+        }
+    }
+
+    if (wm_vuldet_insert_oval_variables(db, parsed_oval)) {
+        goto error;
+    }
+
+    return 0;
+
+error:
+    // The database has been closed by the failed insert
+    ctx->db = NULL;
+    return OS_INVALID;
+}
+
+int wm_vuldet_oval_stream_unit(vu_oval_reader *reader, wm_vuldet_db *parsed_oval, update_node *update) {
     OS_XML xml;
     XML_NODE node = NULL;
     XML_NODE chld_node = NULL;
+    size_t size;
+    int retval = OS_INVALID;
 
     memset(&xml, 0, sizeof(xml));
+    reader->capturing = false;
+    reader->in_unit = false;
 
-    mtdebug2(WM_VULNDETECTOR_LOGTAG, VU_UPDATE_PRE, vu_feed_tag[update->dist_tag_ref]);
-    if (tmp_file = wm_vuldet_oval_xml_preparser(path, update->dist_ref), !tmp_file) {
-        goto free_mem;
+    // The unit is wrapped into its section so that the OVAL parser reads it as a whole feed
+    size = reader->unit_len + 2 * strlen(reader->section) + OS_SIZE_64;
+    if (size > reader->doc_size) {
+        os_realloc(reader->doc, size, reader->doc);
+        reader->doc_size = size;
     }
+    snprintf(reader->doc, size, "<oval_definitions><%s>%.*s</%s></oval_definitions>",
+             reader->section, (int) reader->unit_len, reader->unit, reader->section);
 
-    mtdebug2(WM_VULNDETECTOR_LOGTAG, VU_UPDATE_PAR, vu_feed_tag[update->dist_tag_ref]);
-    if (OS_ReadXML_Ex(tmp_file, &xml, true) < 0) {
+    if (OS_ReadXMLString_Ex(reader->doc, &xml, true) < 0) {
         mterror(WM_VULNDETECTOR_LOGTAG, VU_LOAD_CVE_ERROR, vu_feed_tag[update->dist_tag_ref], xml.err);
-        goto free_mem;
+        goto end;
     }
 
     if (node = OS_GetElementsbyNode(&xml, NULL), !node) {
-        goto free_mem;
+        goto end;
     };
 
     // Reduces a level of recurrence
     if (chld_node = OS_GetElementsbyNode(&xml, *node), !chld_node) {
+        goto end;
+    }
+
+    if (wm_vuldet_oval_xml_parser(&xml, chld_node, parsed_oval, update, 0) == OS_INVALID) {
+        goto end;
+    }
+
+    if (++parsed_oval->insert.pending >= VU_OVAL_STREAM_BATCH) {
+        retval = wm_vuldet_oval_stream_flush(parsed_oval, update);
+    } else {
+        retval = 0;
+    }
+
+end:
+    OS_ClearNode(node);
+    OS_ClearNode(chld_node);
+    OS_ClearXML(&xml);
+    return retval;
+}
+
+int wm_vuldet_oval_stream_tag(vu_oval_reader *reader, wm_vuldet_db *parsed_oval, update_node *update) {
+    reader->name[reader->name_len] = '\0';
+    reader->state = VU_XML_TEXT;
+
+    if (reader->end_tag) {
+        if (!reader->depth) {
+            mterror(WM_VULNDETECTOR_LOGTAG, VU_LOAD_CVE_ERROR, vu_feed_tag[update->dist_tag_ref], "Unexpected closing tag");
+            return OS_INVALID;
+        }
+
+        if (--reader->depth == 2 && reader->in_unit) {
+            return wm_vuldet_oval_stream_unit(reader, parsed_oval, update);
+        }
+
+        if (reader->depth == 1) {
+            // End of section
+            reader->capturing = false;
+
+            if (!strcmp(reader->section, "definitions")) {
+                parsed_oval->insert.definitions_done = true;
+            } else if (!strcmp(reader->section, "tests")) {
+                parsed_oval->insert.tests_done = true;
+            }
+            *reader->section = '\0';
+
+            return wm_vuldet_oval_stream_flush(parsed_oval, update);
+        }
+
+        return 0;
+    }
+
+    if (reader->depth == 0) {
+        reader->root_found = true;
+    } else if (reader->depth == 1) {
+        snprintf(reader->section, sizeof(reader->section), "%s", reader->name);
+    }
+
+    // Empty element
+    if (reader->last == '/') {
+        if (reader->depth == 2 && reader->capturing && !reader->in_unit) {
+            return wm_vuldet_oval_stream_unit(reader, parsed_oval, update);
+        }
+        return 0;
+    }
+
+    if (reader->depth == 2) {
+        reader->in_unit = true;
+    }
+    reader->depth++;
+
+    return 0;
+}
+
+int wm_vuldet_oval_stream(vu_oval_reader *reader, const char *data, size_t length, wm_vuldet_db *parsed_oval, update_node *update) {
+    size_t i;
+
+    for (i = 0; i < length; i++) {
+        char c = data[i];
+
+        if (c == '<' && reader->state == VU_XML_TEXT && reader->depth == 2 && !reader->capturing) {
+            reader->capturing = true;
+            reader->unit_len = 0;
+        }
+
+        if (reader->capturing) {
+            if (reader->unit_len + 1 >= reader->unit_size) {
+                reader->unit_size = reader->unit_size ? reader->unit_size * 2 : OS_MAXSTR;
+                os_realloc(reader->unit, reader->unit_size, reader->unit);
+            }
+            reader->unit[reader->unit_len++] = c;
+        }
+
+        switch (reader->state) {
+        case VU_XML_TEXT:
+            if (c == '<') {
+                reader->state = VU_XML_TAG_OPEN;
+                reader->end_tag = false;
+                reader->last = '\0';
+                reader->name_len = 0;
+            }
+            break;
+
+        case VU_XML_TAG_OPEN:
+            if (c == '/') {
+                reader->end_tag = true;
+                reader->state = VU_XML_TAG_NAME;
+            } else if (c == '!') {
+                reader->state = VU_XML_DECL;
+            } else if (c == '?') {
+                reader->state = VU_XML_PI;
+            } else {
+                reader->name[reader->name_len++] = c;
+                reader->state = VU_XML_TAG_NAME;
+            }
+            break;
+
+        case VU_XML_TAG_NAME:
+            if (c == '>') {
+                if (wm_vuldet_oval_stream_tag(reader, parsed_oval, update) == OS_INVALID) {
+                    return OS_INVALID;
+                }
+            } else if (c == '/' || isspace((unsigned char) c)) {
+                reader->last = c;
+                reader->state = VU_XML_TAG;
+            } else if (reader->name_len < sizeof(reader->name) - 1) {
+                reader->name[reader->name_len++] = c;
+            }
+            break;
+
+        case VU_XML_TAG:
+            if (c == '"' || c == '\'') {
+                reader->quote = c;
+                reader->state = VU_XML_QUOTE;
+            } else if (c == '>') {
+                if (wm_vuldet_oval_stream_tag(reader, parsed_oval, update) == OS_INVALID) {
+                    return OS_INVALID;
+                }
+            } else if (!isspace((unsigned char) c)) {
+                reader->last = c;
+            }
+            break;
+
+        case VU_XML_QUOTE:
+            if (c == reader->quote) {
+                reader->last = c;
+                reader->state = VU_XML_TAG;
+            }
+            break;
+
+        case VU_XML_DECL:
+            if (c == '-' && reader->prev[1] == '-' && reader->prev[0] == '!') {
+                reader->state = VU_XML_COMMENT;
+            } else if (c == '[' && reader->prev[1] == '!') {
+                reader->state = VU_XML_CDATA;
+            } else if (c == '>') {
+                reader->state = VU_XML_TEXT;
+            }
+            break;
+
+        case VU_XML_COMMENT:
+            if (c == '>' && reader->prev[1] == '-' && reader->prev[0] == '-') {
+                reader->state = VU_XML_TEXT;
+            }
+            break;
+
+        case VU_XML_CDATA:
+            if (c == '>' && reader->prev[1] == ']' && reader->prev[0] == ']') {
+                reader->state = VU_XML_TEXT;
+            }
+            break;
+
+        case VU_XML_PI:
+            if (c == '>' && reader->prev[1] == '?') {
+                reader->state = VU_XML_TEXT;
+            }
+            break;
+        }
+
+        // Comments, declarations and instructions between the section children are not copied
+        if (reader->state == VU_XML_TEXT && reader->capturing && !reader->in_unit && c == '>') {
+            reader->capturing = false;
+        }
+
+        reader->prev[0] = reader->prev[1];
+        reader->prev[1] = c;
+    }
+
+    return 0;
+}
+
+int wm_vuldet_oval_process(update_node *update, char *path, wm_vuldet_db *parsed_vulnerabilities) {
+    int success = 0;
+    char *tmp_file;
+    char buffer[OS_MAXSTR];
+    size_t length;
+    FILE *fp = NULL;
+    vu_oval_reader reader;
+
+    memset(&reader, 0, sizeof(reader));
+
+    mtdebug2(WM_VULNDETECTOR_LOGTAG, VU_UPDATE_PRE, vu_feed_tag[update->dist_tag_ref]);
+    if (tmp_file = wm_vuldet_oval_xml_preparser(path, update->dist_ref), !tmp_file) {
+        goto free_mem;
+    }
+
+    mtdebug2(WM_VULNDETECTOR_LOGTAG, VU_UPDATE_PAR, vu_feed_tag[update->dist_tag_ref]);
+    if (fp = fopen(tmp_file, "r"), !fp) {
+        mterror(WM_VULNDETECTOR_LOGTAG, VU_OPEN_FILE_ERROR, tmp_file);
         goto free_mem;
     }
 
-    if (wm_vuldet_oval_xml_parser(&xml, chld_node, parsed_vulnerabilities, update, 0) == OS_INVALID) {
+    // The feed is parsed one element at a time, so the memory does not grow with its size
+    while (length = fread(buffer, sizeof(char), sizeof(buffer), fp), length > 0) {
+        if (wm_vuldet_oval_stream(&reader, buffer, length, parsed_vulnerabilities, update) == OS_INVALID) {
+            goto free_mem;
+        }
+    }
+
+    if (!reader.root_found || reader.depth) {
+        mterror(WM_VULNDETECTOR_LOGTAG, VU_LOAD_CVE_ERROR, vu_feed_tag[update->dist_tag_ref], "Unexpected end of file");
         goto free_mem;
     }
 
     success = 1;
 free_mem:
+    if (fp) {
+        fclose(fp);
+    }
     os_free(tmp_file);
-    OS_ClearNode(node);
-    OS_ClearNode(chld_node);
-    OS_ClearXML(&xml);
+    os_free(reader.unit);
+    os_free(reader.doc);
     return !success;
 }
 
@@ -4584,6 +5609,13 @@ int wm_vuldet_index_feed(update_node *update) {
 
     if (update->json_format) {
         int result;
+
+        // The NVD is inserted while it is being read
+        if (update->dist_ref == FEED_NVD && wm_vuldet_insert_open(&parsed_vulnerabilities, update)) {
+            mterror(WM_VULNDETECTOR_LOGTAG, VU_REFRESH_DB_ERROR, OS_VERSION);
+            goto free_mem;
+        }
+
         // It is a feed in JSON format
         if (result = wm_vuldet_index_json(&parsed_vulnerabilities, update,
                                 update->multi_path ? update->multi_path :
@@ -4602,6 +5634,13 @@ int wm_vuldet_index_feed(update_node *update) {
             update->dist_ref == FEED_REDHAT ||
             update->dist_ref == FEED_SUSE) {
 
+            // Nothing to refresh if the same OVAL was already inserted
+            if (wm_vuldet_feed_unchanged(OS_VERSION, path, parsed_vulnerabilities.insert.feed_hash)) {
+                mtdebug1(WM_VULNDETECTOR_LOGTAG, VU_FEED_UNCHANGED, update->dist_ext);
+                success = 1;
+                goto free_mem;
+            }
+
             switch (w_uncompress_bz2_gz_file(path, VU_TEMP_FILE)) {
             case -1:
                 mterror(WM_VULNDETECTOR_LOGTAG, VU_CONTENT_FEED_ERROR, update->dist_ext, path);
@@ -4613,6 +5652,12 @@ int wm_vuldet_index_feed(update_node *update) {
                 compress = 0;
             }
 
+            // The OVAL is inserted while it is being parsed
+            if (wm_vuldet_insert_open(&parsed_vulnerabilities, update)) {
+                mterror(WM_VULNDETECTOR_LOGTAG, VU_REFRESH_DB_ERROR, OS_VERSION);
+                goto free_mem;
+            }
+
             if (wm_vuldet_oval_process(update, compress ? VU_TEMP_FILE : path, &parsed_vulnerabilities)) {
                 goto free_mem;
             }
@@ -4632,8 +5677,16 @@ int wm_vuldet_index_feed(update_node *update) {
     }
     mtdebug2(WM_VULNDETECTOR_LOGTAG, VU_STOP_REFRESH_DB, update->dist_ext);
 
+    // The conditions indexed in memory are outdated now
+    wm_vuldet_cve_index_clean();
+    wm_vuldet_nvd_index_clean();
+
     success = 1;
 free_mem:
+    // Discard the partial insertion of a failed feed
+    if (parsed_vulnerabilities.insert.db) {
+        sqlite3_close_v2(parsed_vulnerabilities.insert.db);
+    }
     if (remove(VU_TEMP_FILE) < 0) {
         mtdebug2(WM_VULNDETECTOR_LOGTAG, "remove(%s): %s", VU_TEMP_FILE, strerror(errno));
     }
@@ -5380,6 +6433,15 @@ int wm_vuldet_json_parser(char *json_path, wm_vuldet_db *parsed_vulnerabilities,
 
     if (update->dist_ref == FEED_NVD) {
         char *json_feed;
+
+        // The CVEs are inserted while the feed is being read
+        if (parsed_vulnerabilities->insert.db) {
+            if (retval = wm_vuldet_json_nvd_stream(compress ? VU_FIT_TEMP_FILE : json_path, parsed_vulnerabilities, update), retval == OS_INVALID) {
+                mterror(WM_VULNDETECTOR_LOGTAG, VU_PARSED_FEED_ERROR, update->dist_ext, json_path);
+            }
+            return retval;
+        }
+
         if (json_feed = w_get_file_content(compress ? VU_FIT_TEMP_FILE : json_path, JSON_MAX_FSIZE), !json_feed) {
             mterror(WM_VULNDETECTOR_LOGTAG, VU_CONTENT_FEED_ERROR, update->dist_ext, json_path);
             return retval;
@@ -6057,6 +7119,7 @@ cJSON *wm_vuldet_dump(const wm_vuldet_t * vuldet){
     cJSON_AddNumberToObject(wm_vd,"interval",vuldet->scan_interval);
     cJSON_AddNumberToObject(wm_vd,"min_full_scan_interval",vuldet->min_full_scan_interval);
     cJSON_AddNumberToObject(wm_vd,"retry_interval",vuldet->retry_interval);
+    cJSON_AddNumberToObject(wm_vd,"scan_workers",vuldet->scan_workers);
     cJSON *providers = cJSON_CreateArray();
 
     for (i = 0; i < OS_SUPP_SIZE; i++) {
@@ -7851,19 +8914,29 @@ int wm_vuldet_remove_table(sqlite3 *db, char *table) {
     return wm_vuldet_remove_sequence(db, table);
 }
 
-int wm_vuldet_index_nvd(sqlite3 *db, update_node *upd, nvd_vulnerability *nvd_it) {
-    time_t index_time = time(NULL);
-    int result = 0;
-    int cve_count = 0;
+int wm_vuldet_clean_nvd_feed(sqlite3 *db, update_node *upd) {
+    int result;
 
     // Clean everything only if there are still residues of an offline update
     // made by multi_path update. For the cases of multi_url or the online
     // update, we just need to clean the NVD for the year being indexed.
     if (result = wm_vuldet_has_offline_update(db), result == OS_INVALID) {
-        goto error;
+        return OS_INVALID;
     } else if (result == 1 && upd->multi_path && wm_vuldet_clean_nvd(db)) {
-        goto error;
+        return OS_INVALID;
     } else if (!upd->multi_path && wm_vuldet_clean_nvd_year(db, upd->update_it)) {
+        return OS_INVALID;
+    }
+
+    return 0;
+}
+
+int wm_vuldet_index_nvd(sqlite3 *db, update_node *upd, nvd_vulnerability *nvd_it, int streamed) {
+    time_t index_time = time(NULL);
+    int cve_count = streamed;
+
+    // The streamed CVEs were inserted after cleaning the feed
+    if (!streamed && wm_vuldet_clean_nvd_feed(db, upd)) {
         goto error;
     }
 
@@ -8002,8 +9075,9 @@ cJSON *wm_vuldet_get_cvss(const char *scoring_vector) {
 
     if (cvss_json = cJSON_CreateObject(), cvss_json) {
         char* token = NULL;
+        char* save_ptr = NULL;
 
-        for (token = strtok(vector, "/"); NULL != token; token = strtok(NULL, "/"))
+        for (token = strtok_r(vector, "/", &save_ptr); NULL != token; token = strtok_r(NULL, "/", &save_ptr))
         {
             // Attack vector
             if (vector_it = strstr(token, cvss_attack_vector), vector_it) {
@@ -8134,6 +9208,7 @@ int wm_vuldet_get_term_condition(char *i_term, char **term, char **comp_field, c
         return 1;
     }
 
+    w_mutex_lock(&vu_regex_mutex);
     if (!regex) {
         const char *pattern = "^([^ ]+)[ ]+\\([ ]*([^ ]+)[ ]+([^ ]+)[ ]+([^ ]+)\\)";
         os_calloc(1, sizeof(regex_t), regex);
@@ -8142,6 +9217,7 @@ int wm_vuldet_get_term_condition(char *i_term, char **term, char **comp_field, c
             mterror_exit(WM_VULNDETECTOR_LOGTAG, "Unexpected error when compiling '%s'.", pattern);
         }
     }
+    w_mutex_unlock(&vu_regex_mutex);
 
     int retval = 1;
     if (!regexec(regex, i_term, 5, matches, 0)) {
@@ -8338,9 +9414,15 @@ void wm_vuldet_init(wm_vuldet_t * vuldet) {
 
 void wm_vuldet_update_last_scan(scan_ctx_t* scan_ctx) {
     char query[OS_SIZE_256];
-    const char* vu_query = scan_ctx->scan_type == VU_PARTIAL_SCAN ? vu_queries[VU_SET_LAST_PARTIAL_SCAN] : vu_queries[VU_SET_LAST_FULL_SCAN];
+    time_t now = time(NULL);
 
-    snprintf(query, OS_SIZE_256, vu_query, scan_ctx->agent_id, time(NULL));
+    // A partial scan that covers the feed changes is as good as a full one
+    if (scan_ctx->feeds_covered) {
+        snprintf(query, OS_SIZE_256, vu_queries[VU_SET_LAST_SCANS], scan_ctx->agent_id, now, now);
+    } else {
+        const char* vu_query = scan_ctx->scan_type == VU_PARTIAL_SCAN ? vu_queries[VU_SET_LAST_PARTIAL_SCAN] : vu_queries[VU_SET_LAST_FULL_SCAN];
+        snprintf(query, OS_SIZE_256, vu_query, scan_ctx->agent_id, now);
+    }
     if (wm_vuldet_wdb_request(query, OS_SIZE_256)) {
         mtwarn(WM_VULNDETECTOR_LOGTAG, VU_WDB_LASTSCAN_ERROR, scan_ctx->agent_id);
     }
@@ -8411,6 +9493,74 @@ bool wm_vuldet_feed_changed (update_node** feeds, scan_agent* agent, time_t last
     return ret;
 }
 
+int wm_vuldet_feed_affects_agent(sqlite3 *db, scan_agent *agent, time_t last_full_scan) {
+    sqlite3_stmt *stmt = NULL;
+    int result;
+
+    if (wm_vuldet_prepare(db, vu_queries[VU_GET_CHANGED_AGENT_PACKAGES], -1, &stmt, NULL) != SQLITE_OK) {
+        return wm_vuldet_sql_error(db, stmt);
+    }
+
+    sqlite3_bind_int(stmt, 1, atoi(agent->agent_id));
+    sqlite3_bind_text(stmt, 2, vu_feed_tag[agent->dist_ver], -1, NULL);
+    sqlite3_bind_int64(stmt, 3, last_full_scan);
+
+    if (wm_vuldet_step(stmt) != SQLITE_ROW) {
+        return wm_vuldet_sql_error(db, stmt);
+    }
+
+    result = sqlite3_column_int(stmt, 0) > 0;
+    wdb_finalize(stmt);
+
+    return result;
+}
+
+int wm_vuldet_select_feed_packages(sqlite3 *db, scan_agent *agent, time_t last_full_scan) {
+    sqlite3_stmt *stmt = NULL;
+    int sock = wm_vuldet_get_wdb_socket();
+    int agent_id = atoi(agent->agent_id);
+    int result;
+
+    if (wm_vuldet_prepare(db, vu_queries[VU_GET_CHANGED_AGENT_REFERENCES], -1, &stmt, NULL) != SQLITE_OK) {
+        return wm_vuldet_sql_error(db, stmt);
+    }
+
+    sqlite3_bind_int(stmt, 1, agent_id);
+    sqlite3_bind_text(stmt, 2, vu_feed_tag[agent->dist_ver], -1, NULL);
+    sqlite3_bind_int64(stmt, 3, last_full_scan);
+
+    while (result = wm_vuldet_step(stmt), result == SQLITE_ROW) {
+        const char *reference = (const char *)sqlite3_column_text(stmt, 0);
+
+        if (reference && wdb_update_vuln_cves_status_by_reference(agent_id, reference, VULN_CVES_STATUS_PENDING, &sock)) {
+            wdb_finalize(stmt);
+            return OS_INVALID;
+        }
+    }
+
+    if (result != SQLITE_DONE) {
+        return wm_vuldet_sql_error(db, stmt);
+    }
+
+    wdb_finalize(stmt);
+
+    if (wm_vuldet_prepare(db, vu_queries[VU_REMOVE_UNCHANGED_AGENT_PACKAGES], -1, &stmt, NULL) != SQLITE_OK) {
+        return wm_vuldet_sql_error(db, stmt);
+    }
+
+    sqlite3_bind_int(stmt, 1, agent_id);
+    sqlite3_bind_text(stmt, 2, vu_feed_tag[agent->dist_ver], -1, NULL);
+    sqlite3_bind_int64(stmt, 3, last_full_scan);
+
+    if (wm_vuldet_step(stmt) != SQLITE_DONE) {
+        return wm_vuldet_sql_error(db, stmt);
+    }
+
+    wdb_finalize(stmt);
+
+    return 0;
+}
+
 time_t wm_vuldet_get_last_feed_update(vu_feed feed) {
     sqlite3 *db = NULL;
     sqlite3_stmt *stmt = NULL;
@@ -8501,6 +9651,7 @@ char *wm_vuldet_normalize_date(char **date) {
         goto end;
     }
 
+    w_mutex_lock(&vu_regex_mutex);
     if (!r_timestap) {
         const char *pattern = "([0-9]{4}[-/][0-9]{2}[-/][0-9]{2}[ T][0-9]{2}:[0-9]{2}:[0-9]{2}[A-Z])";
         os_calloc(1, sizeof(regex_t), r_timestap);
@@ -8524,6 +9675,7 @@ char *wm_vuldet_normalize_date(char **date) {
             mterror_exit(WM_VULNDETECTOR_LOGTAG, "Unexpected error when compiling '%s'.", pattern);
         }
     }
+    w_mutex_unlock(&vu_regex_mutex);
 
     regmatch_t matched_date;
     memset(&matched_date, 0, sizeof(regmatch_t));
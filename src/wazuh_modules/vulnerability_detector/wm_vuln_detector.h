@@ -18,6 +18,8 @@
 
 #include "external/sqlite/sqlite3.h"
 #include "wm_vuln_detector_evr.h"
+#include "os_crypto/sha256/sha256_op.h"
+#include "wazuh_db/helpers/wdb_agents_helpers.h"
 #include "cJSON.h"
 
 #define WM_VULNDETECTOR_LOGTAG ARGV0 ":" VU_WM_NAME
@@ -32,6 +34,8 @@
 #define WM_VULNDETECTOR_DOWN_ATTEMPTS  5
 #define VU_DEF_MIN_FULL_SCAN_INTERVAL 21600 // 6 hours
 #define VU_DEF_RETRY_INTERVAL 30 // 30 seconds
+#define VU_DEF_SCAN_WORKERS 1
+#define VU_MAX_SCAN_WORKERS 64
 #define VU_TEMP_FILE "tmp/vuln-temp"
 #define VU_TEMP_FILE_BZ2 VU_TEMP_FILE ".bz2"
 #define VU_FIT_TEMP_FILE VU_TEMP_FILE "-fitted"
@@ -84,6 +88,9 @@
 #define VU_MAX_WAZUH_DB_ATTEMPS 5
 #define VU_MAX_TIMESTAMP_ATTEMPS 4
 #define VU_MAX_VER_COMP_IT 50
+#define VU_OVAL_STREAM_BATCH 500 // OVAL elements parsed between partial inserts
+#define VU_CVE_INDEX_SIZE 1024 // Initial OVAL conditions allocated for a target index
+#define VU_NVD_INDEX_SIZE 4096 // Initial links allocated for each list of the NVD configuration index
 #define VU_TIMESTAMP_FAIL 0
 #define VU_TIMESTAMP_UPDATED 1
 #define VU_TIMESTAMP_OUTDATED 2
@@ -137,7 +144,7 @@ extern const char *vu_feed_ext[];
 extern const char *vu_package_comp[];
 extern const char *vu_severities[];
 extern const char *vu_cpe_tags[];
-extern int wdb_vuldet_sock;
+extern __thread int wdb_vuldet_sock;
 typedef struct cpe_list cpe_list;
 typedef struct nvd_vulnerability nvd_vulnerability;
 typedef struct cv_scoring_system cv_scoring_system;
@@ -499,6 +506,7 @@ typedef struct wm_vuldet_t {
     time_t retry_interval;
     time_t last_scan;
     scan_agent *scan_agents;
+    int scan_workers;
     int queue_fd;
     wm_vuldet_state state;
     wm_vuldet_flags flags;
@@ -660,6 +668,81 @@ typedef struct feed_metadata {
     char *last_mod;
 } feed_metadata;
 
+/**
+ * @brief State of a feed insertion that spans several partial inserts
+ */
+typedef struct vu_insert_ctx {
+    sqlite3 *db;                ///< Open transaction. NULL if the feed is inserted in one go
+    char **dependency;          ///< Last SUSE dependency array inserted
+    int deps_size;              ///< Size of the last dependency array
+    int arch_id;                ///< Last architecture ID inserted
+    bool unused_vuls_removed;   ///< The CVEs without a resolved test were already removed
+    bool definitions_done;      ///< The OVAL definitions section has been parsed
+    bool tests_done;            ///< The OVAL tests section has been parsed
+    int pending;                ///< OVAL elements parsed since the last partial insert
+    int nvd_cves;               ///< NVD CVEs inserted while the feed was being read
+    os_sha256 feed_hash;        ///< SHA256 of the OVAL file. Empty if it could not be calculated
+} vu_insert_ctx;
+
+/**
+ * @brief Markup being read by the streamed OVAL reader
+ */
+typedef enum vu_xml_state {
+    VU_XML_TEXT,
+    VU_XML_TAG_OPEN,
+    VU_XML_TAG_NAME,
+    VU_XML_TAG,
+    VU_XML_QUOTE,
+    VU_XML_DECL,
+    VU_XML_COMMENT,
+    VU_XML_CDATA,
+    VU_XML_PI
+} vu_xml_state;
+
+/**
+ * @brief Streamed OVAL reader
+ *
+ * Every child of an OVAL section (definition, test, object, state, variable...) is read as a unit
+ * and parsed on its own, so only one element is kept in memory at a time.
+ */
+typedef struct vu_oval_reader {
+    vu_xml_state state;
+    int depth;                  ///< Number of open elements. The OVAL sections are at depth 2
+    bool root_found;            ///< The root element has been read
+    bool end_tag;               ///< The tag being read is a closing tag
+    char quote;                 ///< Quote of the attribute value being read
+    char last;                  ///< Last significant character of the tag being read
+    char prev[2];               ///< Last two characters read
+    char name[OS_SIZE_64];      ///< Name of the tag being read
+    size_t name_len;
+    char section[OS_SIZE_64];   ///< Name of the section being read
+    bool capturing;             ///< Copying the markup of a section child
+    bool in_unit;               ///< The section child has been opened
+    char *unit;                 ///< Markup of the section child
+    size_t unit_len;
+    size_t unit_size;
+    char *doc;                  ///< Section child wrapped as an OVAL document
+    size_t doc_size;
+} vu_oval_reader;
+
+/**
+ * @brief Streamed NVD reader
+ *
+ * Every object of the "CVE_Items" list is read and inserted on its own.
+ */
+typedef struct vu_json_reader {
+    int depth;                  ///< Number of open objects and arrays
+    int items_depth;            ///< Depth of the CVE items. 0 outside the list
+    bool in_string;             ///< Reading a string
+    bool escape;                ///< The last character read was an escape
+    char key[OS_SIZE_64];       ///< Last string read at the first level
+    size_t key_len;
+    bool capturing;             ///< Copying a CVE item
+    char *item;                 ///< CVE item being read
+    size_t item_len;
+    size_t item_size;
+} vu_json_reader;
+
 typedef struct wm_vuldet_db {
     vulnerability *vulnerabilities;
     rh_vulnerability *rh_vulnerabilities;
@@ -678,8 +761,58 @@ typedef struct wm_vuldet_db {
     vu_alas_vuln *alas_vuln;
     dependencies *suse_deps;
     const char *OS;
+    vu_insert_ctx insert;
 } wm_vuldet_db;
 
+/**
+ * @brief Feed condition of a package, with its version already split for comparisons
+ */
+typedef struct vu_cve_condition {
+    char *package;              ///< Package name the condition applies to
+    char *cve;                  ///< CVE ID
+    char *operation;            ///< Comparison operation
+    char *operation_value;      ///< Version of the feed, as read from the database
+    char *feed_version;         ///< Copy of the feed version split into feed_evr
+    struct pkg_version feed_evr;
+    enum pkg_relation relation;
+    int status;                 ///< 0 if the condition can be compared, otherwise the result of comparing it
+    unsigned int position;      ///< Order of the condition in the database
+} vu_cve_condition;
+
+/**
+ * @brief In-memory index of the OVAL conditions of a target, sorted by package and CVE
+ *
+ * It is built the first time a target is scanned and dropped when a feed is updated.
+ */
+typedef struct vu_cve_index {
+    char *target;               ///< Feed target (vu_feed_tag)
+    version_type vertype;       ///< Comparator used to split the feed versions
+    vu_cve_condition *conditions;
+    size_t size;
+    struct vu_cve_index *next;
+} vu_cve_index;
+
+/**
+ * @brief Edge of the NVD configuration trees
+ */
+typedef struct vu_nvd_link {
+    int key;                    ///< Configuration of a match, or parent of a configuration
+    int id;                     ///< Match or configuration ID
+} vu_nvd_link;
+
+/**
+ * @brief In-memory index of the NVD configuration trees
+ *
+ * It resolves the children and siblings of every vulnerable match with a binary search
+ * instead of a query. It is built the first time it is needed and dropped when a feed is updated.
+ */
+typedef struct vu_nvd_conf_index {
+    vu_nvd_link *matches;           ///< Matches of each configuration, sorted by configuration and ID
+    size_t matches_size;
+    vu_nvd_link *configurations;    ///< Nested configurations, sorted by parent and ID
+    size_t configurations_size;
+} vu_nvd_conf_index;
+
 // NVD - CPE structures
 
 typedef struct translation_cond {
@@ -887,8 +1020,38 @@ typedef struct scan_ctx_t {
     vu_scan_type_t  scan_type;
     bool            os_scan;
     bool            package_scan;
+    bool            feeds_covered;      ///< Full scan replaced by a partial one that includes every package changed in the feeds
 } scan_ctx_t;
 
+/**
+ * @brief Reports of an agent whose vulnerabilities are pending to be saved in its database.
+ * They are inserted with a single Wazuh DB request and sent once the result of each one is known.
+ */
+typedef struct vu_report_batch {
+    int agent_id;                                   ///< Agent whose database is updated
+    int *sock;                                      ///< Wazuh DB socket
+    wdb_vuln_cves_batch entries;                    ///< Vulnerabilities pending to be inserted
+    vu_report *reports[WDB_VULN_CVES_BATCH_MAX];    ///< Reports of the pending vulnerabilities, in the same order
+    int feeds[WDB_VULN_CVES_BATCH_MAX];             ///< Feeds where each pending vulnerability was found
+    int count;                                      ///< Number of pending reports
+    int reported;                                   ///< Reports sent
+    int reported_nvd;                               ///< Reports sent that were found in the NVD
+    int reported_vendor;                            ///< Reports sent that were found in the vendor feeds
+} vu_report_batch;
+
+/**
+ * @brief Structure shared by the threads that scan the agents.
+ * Every agent is scanned from start to end by a single worker.
+ */
+typedef struct vu_scan_pool {
+    wm_vuldet_t     *vuldet;
+    scan_agent      *next_agent;        ///< Next agent to be handed out
+    pthread_mutex_t mutex;              ///< Protects the cursor and the retry state
+    bool            retry_agents;       ///< Some agent failed and has pending attempts
+    bool            abort_scan;         ///< A database error stops the whole scan
+    time_t          first_fail_scan;    ///< Time of the first failed agent of this round
+} vu_scan_pool;
+
 // Macros
 #define wm_vuldet_is_single_provider(x) (x == FEED_UBUNTU || x == FEED_DEBIAN || x == FEED_REDHAT || x == FEED_ALAS)
 #define wm_vuldet_silent_feed(x) (x == FEED_CPEW)
@@ -921,6 +1084,15 @@ int wm_vuldet_generate_agent_cpes(sqlite3 *db, scan_agent *agent, char dic);
 int wm_vuldet_fetch_nvd_cve(update_node *update);
 int wm_vuldet_fetch_nvd_cpe(const long timeout, char *repo);
 int wm_vuldet_json_nvd_parser(char *json_feed, wm_vuldet_db *parsed_vulnerabilities);
+
+/**
+ * @brief Read an NVD feed and insert its CVEs one at a time into the open feed database
+ * @param path Path of the uncompressed feed.
+ * @param parsed_vulnerabilities Feed information, with an open insertion.
+ * @param update Update structure of the feed.
+ * @return 0 on success, OS_INVALID otherwise.
+ */
+int wm_vuldet_json_nvd_stream(const char *path, wm_vuldet_db *parsed_vulnerabilities, update_node *update);
 int wm_vuldet_clean_nvd_metadata(sqlite3 *db, int year);
 int wm_vuldet_insert_nvd_cve(sqlite3 *db, nvd_vulnerability *nvd_data, int year);
 void wm_vuldet_free_nvd_node(nvd_vulnerability *data);
@@ -1018,6 +1190,16 @@ int wm_vuldet_win_nvd_vulnerabilities(sqlite3 *db, scan_agent *agent, wm_vuldet_
  */
 int wm_checks_package_vulnerability(char *version_a, const char *operation, const char *version_b, version_type vertype);
 
+/**
+ * @brief Drop the in-memory index of the OVAL conditions, so it is rebuilt from the updated feeds.
+ */
+void wm_vuldet_cve_index_clean();
+
+/**
+ * @brief Drop the in-memory index of the NVD configuration trees, so it is rebuilt from the updated feed.
+ */
+void wm_vuldet_nvd_index_clean();
+
 /**
  * @brief Send a report for a specific CVE and the affected packages.
  * @param report An already generated report that must be parsed and sent.
@@ -1025,6 +1207,21 @@ int wm_checks_package_vulnerability(char *version_a, const char *operation, cons
  */
 int wm_vuldet_send_cve_report(vu_report *report);
 
+/**
+ * @brief Queue a report to save its vulnerability in the agent database. The batch is flushed when it's full.
+ * @param batch Batch of the agent.
+ * @param report Report to be saved and sent. The batch takes its ownership.
+ * @param feed Feeds where the vulnerability was found (VU_SRC_OVAL and/or VU_SRC_NVD).
+ */
+void wm_vuldet_report_batch_add(vu_report_batch *batch, vu_report *report, int feed);
+
+/**
+ * @brief Save the pending vulnerabilities of a batch in the agent database, and send the reports
+ * of those that were not already reported.
+ * @param batch Batch of the agent.
+ */
+void wm_vuldet_report_batch_flush(vu_report_batch *batch);
+
 /**
  * @brief Send a report for a removed CVE and the affected package.
  * @param j_vuln A cJSON Object cotaining the CVE's information from vuln_cves table.
@@ -1129,6 +1326,7 @@ int wm_vuldet_remove_table(sqlite3 *db, char *table);
 int wm_vuldet_clean_nvd(sqlite3 *db);
 int wm_vuldet_has_offline_update(sqlite3 *db);
 int wm_vuldet_clean_nvd_year(sqlite3 *db, int year);
+int wm_vuldet_clean_nvd_feed(sqlite3 *db, update_node *upd);
 int wm_vuldet_remove_sequence(sqlite3 *db, char *table);
 char *wm_vuldet_cpe_str(cpe *cpe_s);
 void wm_vuldet_free_cpe(cpe **node);
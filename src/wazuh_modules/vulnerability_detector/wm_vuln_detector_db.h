@@ -30,6 +30,7 @@
 #define ARCHITECTURES_TABLE     "ARCHITECTURES"
 #define PKG_DEPS_TABLE          "PKG_DEPS"
 #define DEPENDENCIES_TABLE      "DEPENDENCIES"
+#define PKG_HASHES_TABLE        "PACKAGE_HASHES"
 #define MAX_QUERY_SIZE          OS_SIZE_1024
 #define MAX_SQL_ATTEMPTS        1000
 #define SQL_BUSY_SLEEP_MS       1
@@ -61,8 +62,8 @@ typedef enum vu_query {
     VU_UPDATE_DEPS_FLAG,
     VU_UPDATE_RESET_DEPS_FLAG,
     VU_REMOVE_UNUSED_ID,
-    VU_GET_MULTIPLE_CVE_ENTRIES,
-    VU_GET_MULTIPLE_CVE_ENTRIES_UBUNTU,
+    VU_GET_CVE_INDEX,
+    VU_GET_CVE_INDEX_UBUNTU,
     VU_JOIN_QUERY,
     VU_JOIN_RH_QUERY,
     VU_JOIN_DEBIAN_QUERY,
@@ -79,6 +80,15 @@ typedef enum vu_query {
     VU_REMOVE_HOTFIXES_TABLE,
     VU_REMOVE_UNUSED_VULS,
     VU_REMOVE_UNUSED_STATES,
+    // FEED CHANGES
+    VU_CREATE_FEED_HASHES,
+    VU_GET_FEED_PACKAGES,
+    VU_INSERT_FEED_HASH,
+    VU_REMOVE_PKG_HASHES,
+    VU_UPDATE_PKG_HASHES,
+    VU_GET_CHANGED_AGENT_PACKAGES,
+    VU_GET_CHANGED_AGENT_REFERENCES,
+    VU_REMOVE_UNCHANGED_AGENT_PACKAGES,
     // WAZUH DB REQUESTS
     VU_HOTFIXES_GET,
     VU_PACKAGES_GET,
@@ -87,6 +97,7 @@ typedef enum vu_query {
     VU_GET_LAST_SCAN,
     VU_SET_LAST_FULL_SCAN,
     VU_SET_LAST_PARTIAL_SCAN,
+    VU_SET_LAST_SCANS,
     // CPE INDEX
     VU_INSERT_CPE,
     VU_REMOVE_AGENT_CPE,
@@ -95,6 +106,9 @@ typedef enum vu_query {
     VU_GET_PACK_WITHOUT_CPE,
     VU_GET_AGENT_CPES,
     VU_UPDATE_AGENT_CPE,
+    // SCAN WORKERS
+    VU_CREATE_SCAN_TABLES,
+    VU_CREATE_SCAN_DEPS,
     // NVD
     VU_GET_NVD_COUNT,
     VU_GET_NVD_CONFIGURED_YEAR,
@@ -139,8 +153,8 @@ typedef enum vu_query {
     VU_GET_GENERIC_PACKAGE_OS,
     VU_GET_SPECIFIC_PACKAGE_APP,
     VU_GET_SPECIFIC_PACKAGE_OS,
-    VU_GET_CHILDREN,
-    VU_GET_SIBLINGS,
+    VU_GET_NVD_MATCH_INDEX,
+    VU_GET_NVD_CONF_INDEX,
     VU_GET_NVD_CVE_COUNT,
     VU_GET_NVD_MATCHES_COUNT,
     VU_GET_GENERIC_PACKAGE_OS_MAC,
@@ -185,7 +199,7 @@ static const char *vu_queries[] = {
     [VU_INSERT_ADVISORY_INFO] = "INSERT INTO " CVE_ADVISORY_TABLE " VALUES(?,?,?);",
     [VU_INSERT_METADATA] = "INSERT OR REPLACE INTO " METADATA_TABLE " VALUES(?,?,?,?,?,?,?,?,strftime('%s', 'now'));",
     [VU_GET_LAST_UPDATE] = "SELECT LAST_UPDATE FROM " METADATA_TABLE " WHERE TARGET = ?;",
-    [VU_INSERT_AGENTS] = "INSERT INTO " AGENTS_TABLE " VALUES(?,?,?,?,?,?,?,?,?,?,?,?);",
+    [VU_INSERT_AGENTS] = "INSERT OR IGNORE INTO " AGENTS_TABLE " VALUES(?,?,?,?,?,?,?,?,?,?,?,?);",
     [VU_INSERT_AGENT_HOTFIXES] = "INSERT INTO AGENT_HOTFIXES VALUES(?,?);",
     [VU_INSERT_VARIABLES] = "INSERT INTO " VARIABLES_TABLE " VALUES(?,?,?);",
     [VU_INSERT_PKG_DEPS] = "INSERT INTO " PKG_DEPS_TABLE " VALUES(?,?,?);",
@@ -199,11 +213,11 @@ static const char *vu_queries[] = {
     [VU_UPDATE_DEPS_FLAG] = "UPDATE DEPENDENCIES SET INSTALLED = 1 WHERE NAME = ? AND TARGET = ? AND OPERATION_VALUE = ?;",
     [VU_UPDATE_RESET_DEPS_FLAG] = "UPDATE DEPENDENCIES SET INSTALLED = 0 WHERE INSTALLED = 1;",
     [VU_REMOVE_UNUSED_ID] = "DELETE FROM " CVE_TABLE " WHERE PACKAGE = ?;",
-    [VU_GET_MULTIPLE_CVE_ENTRIES] = "SELECT OPERATION, OPERATION_VALUE FROM VULNERABILITIES WHERE TARGET = ? \
-                                AND CVEID = ? AND PACKAGE = ? AND OPERATION_VALUE != ? AND OPERATION != 'equals';",
-    [VU_GET_MULTIPLE_CVE_ENTRIES_UBUNTU] = "SELECT OPERATION, OPERATION_VALUE FROM VULNERABILITIES \
+    [VU_GET_CVE_INDEX] = "SELECT CVEID, PACKAGE, OPERATION, OPERATION_VALUE FROM VULNERABILITIES WHERE TARGET = ? \
+                                AND OPERATION != 'equals';",
+    [VU_GET_CVE_INDEX_UBUNTU] = "SELECT CVEID, VARIABLES.VALUE, OPERATION, OPERATION_VALUE FROM VULNERABILITIES \
                                 LEFT JOIN VARIABLES ON VARIABLES.VID = VULNERABILITIES.PACKAGE WHERE \
-                                VULNERABILITIES.TARGET = ? AND CVEID = ? AND VARIABLES.VALUE = ? AND OPERATION_VALUE != ? AND OPERATION != 'equals';",
+                                VULNERABILITIES.TARGET = ? AND OPERATION != 'equals';",
     [VU_JOIN_QUERY] = "SELECT CVEID, (CASE WHEN VALUE IS NOT NULL THEN VALUE ELSE PACKAGE_NAME END), SOURCE, VERSION, ARCH, OPERATION, OPERATION_VALUE, SRC_VERSION, VENDOR, REFERENCE, TYPE \
                  FROM VULNERABILITIES LEFT JOIN VARIABLES ON VARIABLES.VID = VULNERABILITIES.PACKAGE AND VARIABLES.TARGET = VULNERABILITIES.TARGET \
                                       INNER JOIN AGENTS ON PACKAGE_NAME = (CASE WHEN VALUE IS NOT NULL THEN VALUE ELSE PACKAGE END) \
@@ -241,6 +255,22 @@ static const char *vu_queries[] = {
     [VU_REMOVE_HOTFIXES_TABLE] = "DELETE FROM AGENT_HOTFIXES;",
     [VU_REMOVE_UNUSED_VULS] = "DELETE FROM " CVE_TABLE " WHERE PACKAGE LIKE '%:tst:%';",
     [VU_REMOVE_UNUSED_STATES] = "DELETE FROM " CVE_TABLE " WHERE OPERATION LIKE '%:ste:%';",
+    [VU_CREATE_FEED_HASHES] = "CREATE TEMP TABLE IF NOT EXISTS FEED_HASHES (PACKAGE TEXT PRIMARY KEY NOT NULL, HASH TEXT NOT NULL);"
+                              "DELETE FROM temp.FEED_HASHES;",
+    [VU_GET_FEED_PACKAGES] = "SELECT (CASE WHEN VALUE IS NOT NULL THEN VALUE ELSE PACKAGE END) AS NAME, CVEID, OPERATION, IFNULL(OPERATION_VALUE, ''), IGNORE \
+                 FROM " CVE_TABLE " LEFT JOIN " VARIABLES_TABLE " ON VARIABLES.VID = VULNERABILITIES.PACKAGE AND VARIABLES.TARGET = VULNERABILITIES.TARGET \
+                 WHERE VULNERABILITIES.TARGET = ? ORDER BY NAME, CVEID, OPERATION, 4;",
+    [VU_INSERT_FEED_HASH] = "INSERT OR REPLACE INTO temp.FEED_HASHES VALUES(?,?);",
+    [VU_REMOVE_PKG_HASHES] = "UPDATE " PKG_HASHES_TABLE " SET HASH = '', LAST_CHANGE = strftime('%s', 'now') WHERE TARGET = ? AND HASH != '' \
+                 AND PACKAGE NOT IN (SELECT PACKAGE FROM temp.FEED_HASHES);",
+    [VU_UPDATE_PKG_HASHES] = "INSERT OR REPLACE INTO " PKG_HASHES_TABLE " SELECT ?1, NEW.PACKAGE, NEW.HASH, strftime('%s', 'now') FROM temp.FEED_HASHES AS NEW \
+                 LEFT JOIN " PKG_HASHES_TABLE " AS OLD ON OLD.TARGET = ?1 AND OLD.PACKAGE = NEW.PACKAGE WHERE OLD.HASH IS NULL OR OLD.HASH != NEW.HASH;",
+    [VU_GET_CHANGED_AGENT_PACKAGES] = "SELECT COUNT(*) FROM " AGENTS_TABLE " INNER JOIN " PKG_HASHES_TABLE " ON " PKG_HASHES_TABLE ".PACKAGE IN (PACKAGE_NAME, SOURCE) \
+                 WHERE AGENT_ID = ? AND " PKG_HASHES_TABLE ".TARGET = ? AND LAST_CHANGE > ?;",
+    [VU_GET_CHANGED_AGENT_REFERENCES] = "SELECT DISTINCT REFERENCE FROM " AGENTS_TABLE " INNER JOIN " PKG_HASHES_TABLE " ON " PKG_HASHES_TABLE ".PACKAGE IN (PACKAGE_NAME, SOURCE) \
+                 WHERE AGENT_ID = ? AND TYPE = 'PACKAGE' AND " PKG_HASHES_TABLE ".TARGET = ? AND LAST_CHANGE > ?;",
+    [VU_REMOVE_UNCHANGED_AGENT_PACKAGES] = "DELETE FROM " AGENTS_TABLE " WHERE AGENT_ID = ? AND TYPE = 'PACKAGE' AND NOT EXISTS (SELECT 1 FROM " PKG_HASHES_TABLE " \
+                 WHERE " PKG_HASHES_TABLE ".PACKAGE IN (" AGENTS_TABLE ".PACKAGE_NAME, " AGENTS_TABLE ".SOURCE) AND " PKG_HASHES_TABLE ".TARGET = ? AND LAST_CHANGE > ?);",
     // WAZUH DB REQUESTS
     [VU_HOTFIXES_GET] = "agent %d hotfix get",
     [VU_PACKAGES_GET] = "agent %d package get %s",
@@ -249,6 +279,7 @@ static const char *vu_queries[] = {
     [VU_GET_LAST_SCAN] = "agent %d sql SELECT LAST_PARTIAL_SCAN, LAST_FULL_SCAN FROM VULN_METADATA;",
     [VU_SET_LAST_FULL_SCAN] = "agent %d sql UPDATE VULN_METADATA SET LAST_FULL_SCAN='%u';",
     [VU_SET_LAST_PARTIAL_SCAN] = "agent %d sql UPDATE VULN_METADATA SET LAST_PARTIAL_SCAN='%u';",
+    [VU_SET_LAST_SCANS] = "agent %d sql UPDATE VULN_METADATA SET LAST_PARTIAL_SCAN='%u', LAST_FULL_SCAN='%u';",
     // CPE INDEX
     [VU_INSERT_CPE] = "INSERT INTO CPE_INDEX VALUES(?,?,?,?,?,?,?,?,?,?,?,?,?,?);",
     [VU_REMOVE_AGENT_CPE] = "DELETE FROM CPE_INDEX WHERE ID < 0;",
@@ -257,6 +288,18 @@ static const char *vu_queries[] = {
     [VU_GET_PACK_WITHOUT_CPE] = "SELECT VENDOR, PACKAGE_NAME, VERSION, ARCH FROM AGENTS WHERE AGENT_ID = ? AND CPE_INDEX_ID = 0;",
     [VU_GET_AGENT_CPES] = "SELECT PART, CPE_INDEX.VENDOR, PRODUCT, CPE_INDEX.VERSION, UPDATEV, EDITION, LANGUAGE, SW_EDITION, TARGET_SW, TARGET_HW, OTHER, MSU_NAME, AGENTS.VENDOR, PACKAGE_NAME, AGENTS.VERSION, ARCH FROM AGENTS JOIN CPE_INDEX ON CPE_INDEX_ID = ID WHERE AGENT_ID = ?;",
     [VU_UPDATE_AGENT_CPE] = "UPDATE AGENTS SET CPE_INDEX_ID = ? WHERE AGENT_ID = ? AND VENDOR IS ? AND PACKAGE_NAME = ? AND VERSION = ? AND ARCH = ?;",
+    // The scan workers open the database as read-only, so the tables written while scanning an agent are shadowed by private temporary copies
+    [VU_CREATE_SCAN_TABLES] = "CREATE TEMP TABLE " AGENTS_TABLE " (AGENT_ID INT NOT NULL, TARGET_MAJOR TEXT, TARGET_MINOR TEXT, CPE_INDEX_ID INT DEFAULT 0, VENDOR TEXT, PACKAGE_NAME TEXT NOT NULL, SOURCE TEXT DEFAULT NULL, VERSION TEXT NOT NULL, SRC_VERSION TEXT NULL, ARCH TEXT NOT NULL, REFERENCE TEXT NOT NULL, TYPE TEXT NOT NULL, PRIMARY KEY(AGENT_ID, CPE_INDEX_ID, VENDOR, PACKAGE_NAME, VERSION, ARCH));"
+                              "CREATE INDEX temp.IN_AG_CPEID ON " AGENTS_TABLE " (CPE_INDEX_ID);"
+                              "CREATE INDEX temp.IN_AG_PKG ON " AGENTS_TABLE " (PACKAGE_NAME);"
+                              "CREATE TEMP TABLE AGENT_HOTFIXES (AGENT_ID INT NOT NULL, HOTFIX TEXT NOT NULL, PRIMARY KEY(AGENT_ID, HOTFIX));"
+                              "CREATE INDEX temp.IN_AGH_HOTFIX ON AGENT_HOTFIXES (HOTFIX);"
+                              "CREATE TEMP TABLE CPE_INDEX (ID INTEGER, POS INTEGER, PART TEXT NOT NULL, VENDOR TEXT NOT NULL, PRODUCT TEXT NOT NULL, VERSION TEXT NOT NULL, UPDATEV TEXT, EDITION TEXT, LANGUAGE TEXT, SW_EDITION TEXT, TARGET_SW TEXT, TARGET_HW TEXT, OTHER TEXT, MSU_NAME TEXT, PRIMARY KEY(ID, POS));"
+                              "CREATE INDEX temp.IN_CPE_VENDOR_PRODUCT ON CPE_INDEX (VENDOR, PRODUCT);"
+                              "INSERT INTO temp.CPE_INDEX SELECT * FROM main.CPE_INDEX WHERE IFNULL(ID, 0) >= 0;",
+    [VU_CREATE_SCAN_DEPS] = "CREATE TEMP TABLE " DEPENDENCIES_TABLE " AS SELECT * FROM main." DEPENDENCIES_TABLE ";"
+                            "CREATE INDEX temp.IN_VAR_NAME ON " DEPENDENCIES_TABLE " (NAME, TARGET, OPERATION_VALUE);"
+                            "CREATE INDEX temp.IN_VAR_INSTALLED ON " DEPENDENCIES_TABLE " (INSTALLED);",
     // NVD
     [VU_GET_NVD_COUNT] = "SELECT COUNT(*) FROM NVD_CVE;",
     [VU_GET_NVD_CONFIGURED_YEAR] = "SELECT MIN(YEAR) FROM NVD_METADATA;",
@@ -319,8 +362,8 @@ static const char *vu_queries[] = {
                               INNER JOIN NVD_CVE_CONFIGURATION ON  NVD_CVE_CONFIGURATION.ID = NVD_CVE_MATCH.NVD_CVE_CONFIGURATION_ID \
                               INNER JOIN NVD_CVE ON NVD_CVE_CONFIGURATION.NVD_CVE_ID = NVD_CVE.ID \
                  WHERE NVD_CPE.PART = 'o' AND (NVD_CPE.PRODUCT = ? OR NVD_CPE.PRODUCT = 'linux') AND NVD_CPE.VERSION LIKE ? AND NVD_CPE.VENDOR = ?;",
-    [VU_GET_CHILDREN] = "SELECT ID FROM NVD_CVE_MATCH WHERE NVD_CVE_CONFIGURATION_ID = ? AND ID != ?;",
-    [VU_GET_SIBLINGS] = "SELECT ID FROM NVD_CVE_CONFIGURATION WHERE PARENT = ? AND ID != ?;",
+    [VU_GET_NVD_MATCH_INDEX] = "SELECT NVD_CVE_CONFIGURATION_ID, ID FROM NVD_CVE_MATCH ORDER BY NVD_CVE_CONFIGURATION_ID, ID;",
+    [VU_GET_NVD_CONF_INDEX] = "SELECT PARENT, ID FROM NVD_CVE_CONFIGURATION WHERE PARENT != 0 ORDER BY PARENT, ID;",
     [VU_GET_NVD_CVE_COUNT] = "SELECT COUNT(*) FROM NVD_CVE WHERE NVD_CVE.CVE_ID = ?",
     [VU_GET_NVD_MATCHES_COUNT] = "SELECT COUNT(*) \
                  FROM NVD_CPE INNER JOIN NVD_CVE_MATCH ON NVD_CPE.ID = NVD_CVE_MATCH.ID_CPE \
@@ -33,7 +33,12 @@
 #undef D
 #define D C_CTYPE_DIGIT
 
-static int (*comparator) (const char *, const char *, int);
+// Set by every call to pkg_version_relate(), so each scan worker keeps its own
+static __thread int (*comparator) (const char *, const char *, int);
+
+// Comparisons shared by the scan workers. It only exists while a scan is running
+static pkg_version_cache_entry *pkg_version_cache;
+static pthread_mutex_t pkg_version_cache_locks[PKG_VERSION_CACHE_LOCKS];
 
 static unsigned short int c_ctype[256] = {
 /** 0 **/
@@ -505,6 +510,135 @@ int pkg_version_compare(const struct pkg_version *a, const struct pkg_version *b
     return comparator(a->revision, b->revision, 1);
 }
 
+/**
+ * Builds the cache key of a comparison.
+ *
+ * @param a The first version.
+ * @param b The second version.
+ * @param key Buffer of PKG_VERSION_CACHE_KEY bytes.
+ *
+ * @return The size of the key, or 0 if the comparison can't be cached.
+ */
+static size_t pkg_version_cache_key(const struct pkg_version *a, const struct pkg_version *b, char *key)
+{
+    const char *parts[] = { a->version, a->revision, b->version, b->revision };
+    size_t key_size = 0;
+    size_t len;
+    unsigned int i;
+
+    for (i = 0; i < sizeof(parts) / sizeof(parts[0]); i++) {
+        // A missing part isn't the same as an empty one for every comparator
+        if (parts[i] == NULL)
+            return 0;
+
+        len = strlen(parts[i]) + 1;
+        if (key_size + len > PKG_VERSION_CACHE_KEY)
+            return 0;
+
+        memcpy(key + key_size, parts[i], len);
+        key_size += len;
+    }
+
+    return key_size;
+}
+
+/**
+ * Compares two versions, remembering the result while a scan is running.
+ * Agents running the same images check the same pairs of versions against
+ * the same feeds, so most of the comparisons are answered from the cache.
+ *
+ * @param a The first version.
+ * @param b The second version.
+ * @param vertype The package type of the versions being compared.
+ *
+ * @return The same as pkg_version_compare().
+ */
+static int pkg_version_compare_cached(const struct pkg_version *a, const struct pkg_version *b, version_type vertype)
+{
+    pkg_version_cache_entry *entry;
+    pthread_mutex_t *lock;
+    char key[PKG_VERSION_CACHE_KEY];
+    size_t key_size;
+    unsigned int hash = 2166136261u;
+    size_t i;
+    int rc;
+
+    if (!pkg_version_cache || (key_size = pkg_version_cache_key(a, b, key), !key_size))
+        return pkg_version_compare(a, b);
+
+    // FNV-1a
+    for (i = 0; i < key_size; i++)
+        hash = (hash ^ (unsigned char)key[i]) * 16777619u;
+    hash = (hash ^ (unsigned int)vertype) * 16777619u;
+    hash = (hash ^ (unsigned int)a->epoch) * 16777619u;
+    hash = (hash ^ (unsigned int)b->epoch) * 16777619u;
+
+    entry = &pkg_version_cache[hash % PKG_VERSION_CACHE_SIZE];
+    lock = &pkg_version_cache_locks[hash % PKG_VERSION_CACHE_SIZE % PKG_VERSION_CACHE_LOCKS];
+
+    w_mutex_lock(lock);
+
+    if (entry->key && entry->hash == hash && entry->vertype == vertype && entry->epoch_a == a->epoch &&
+        entry->epoch_b == b->epoch && entry->key_size == key_size && !memcmp(entry->key, key, key_size)) {
+        rc = entry->result;
+        w_mutex_unlock(lock);
+        return rc;
+    }
+
+    w_mutex_unlock(lock);
+
+    rc = pkg_version_compare(a, b);
+
+    // The slot keeps the last comparison that fell in it
+    w_mutex_lock(lock);
+    os_realloc(entry->key, key_size, entry->key);
+    memcpy(entry->key, key, key_size);
+    entry->key_size = key_size;
+    entry->hash = hash;
+    entry->vertype = vertype;
+    entry->epoch_a = a->epoch;
+    entry->epoch_b = b->epoch;
+    entry->result = rc;
+    w_mutex_unlock(lock);
+
+    return rc;
+}
+
+/**
+ * Enables the comparison cache. It must be called before the scan workers start.
+ */
+void pkg_version_cache_init(void)
+{
+    int i;
+
+    if (pkg_version_cache)
+        return;
+
+    for (i = 0; i < PKG_VERSION_CACHE_LOCKS; i++)
+        w_mutex_init(&pkg_version_cache_locks[i], NULL);
+
+    os_calloc(PKG_VERSION_CACHE_SIZE, sizeof(pkg_version_cache_entry), pkg_version_cache);
+}
+
+/**
+ * Disables the comparison cache and frees it. It must be called once the scan workers have finished.
+ */
+void pkg_version_cache_free(void)
+{
+    int i;
+
+    if (!pkg_version_cache)
+        return;
+
+    for (i = 0; i < PKG_VERSION_CACHE_SIZE; i++)
+        os_free(pkg_version_cache[i].key);
+
+    os_free(pkg_version_cache);
+
+    for (i = 0; i < PKG_VERSION_CACHE_LOCKS; i++)
+        w_mutex_destroy(&pkg_version_cache_locks[i]);
+}
+
 /**
  * EVR string comparator. It allows to compare two packages versions based on a
  * specific relation and by specifying the package version type (DEB, RPM, NVD).
@@ -544,7 +678,7 @@ bool pkg_version_relate(const struct pkg_version *a, enum pkg_relation rel, cons
         return false;
     }
 
-    rc = pkg_version_compare(a, b);
+    rc = pkg_version_compare_cached(a, b, vertype);
 
     switch (rel) {
     case PKG_RELATION_EQ:
@@ -18,6 +18,10 @@
 #define DPKG_BIT(n) (1UL << (n))
 #define C_CTYPE_BIT(bit)    (1 << (bit))
 
+#define PKG_VERSION_CACHE_SIZE  16384   // Comparisons remembered during a scan
+#define PKG_VERSION_CACHE_LOCKS 64      // Must divide PKG_VERSION_CACHE_SIZE
+#define PKG_VERSION_CACHE_KEY   256     // Longer versions are always compared
+
 enum c_ctype_bit {
     C_CTYPE_BLANK = C_CTYPE_BIT(0),
     C_CTYPE_WHITE = C_CTYPE_BIT(1),
@@ -72,12 +76,28 @@ struct pkg_version {
     const char *revision;
 };
 
+/**
+ * Result of a comparison made during the scan. The key holds the version and
+ * the revision of both sides, each one followed by its null character.
+ */
+typedef struct pkg_version_cache_entry {
+    char *key;
+    size_t key_size;
+    unsigned int hash;
+    version_type vertype;
+    int epoch_a;
+    int epoch_b;
+    int result;
+} pkg_version_cache_entry;
+
 bool c_isbits(int c, enum c_ctype_bit bits);
 bool c_isdigit(int c);
 bool c_isalpha(int c);
 int order(int c);
 int pkg_version_compare(const struct pkg_version *a, const struct pkg_version *b);
 bool pkg_version_relate(const struct pkg_version *a, enum pkg_relation rel, const struct pkg_version *b, version_type vertype);
+void pkg_version_cache_init(void);
+void pkg_version_cache_free(void);
 
 #endif
 #endif
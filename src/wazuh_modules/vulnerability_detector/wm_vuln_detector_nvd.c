@@ -16,6 +16,9 @@
 
 STATIC char *CPE_VER_TAG = "cpe:2.3:";
 
+static vu_nvd_conf_index *vu_nvd_index;
+static pthread_mutex_t vu_nvd_index_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 STATIC char * wm_vuldet_decode_cpe_term(char *term);
 STATIC int wm_vuldet_extract_agent_cpes(scan_agent *agent, sqlite3 *db);
 STATIC int wm_vuldet_update_agent_cpes(scan_agent *agent, sqlite3 *db);
@@ -26,6 +29,9 @@ STATIC int wm_vuldet_parse_nvd_configuration(cJSON *configuration, nvd_vulnerabi
 STATIC int wm_vuldet_parse_nvd_configuration_node(cJSON *config, const char *cve, nvd_configuration **data);
 STATIC int wm_vuldet_parse_nvd_impact(cJSON *impact, nvd_vulnerability *data);
 STATIC int wm_vuldet_parse_nvd_cve(cJSON *node, nvd_vulnerability *data);
+STATIC void wm_vuldet_parse_nvd_item(cJSON *cve_list, nvd_vulnerability *nvd_it);
+STATIC int wm_vuldet_nvd_stream(vu_json_reader *reader, const char *data, size_t length, wm_vuldet_db *parsed_vulnerabilities, update_node *update);
+STATIC int wm_vuldet_nvd_stream_item(vu_json_reader *reader, wm_vuldet_db *parsed_vulnerabilities, update_node *update);
 STATIC int wm_vuldet_insert_nvd_cve_metric_cvss(sqlite3 *db, cv_scoring_system *nvd_data, int node_id);
 STATIC int wm_vuldet_insert_nvd_cve_configuration(sqlite3 *db, nvd_configuration *nvd_data, int node_id, int parent);
 STATIC int wm_vuldet_insert_nvd_cve_references(sqlite3 *db, nvd_references *nvd_data, char *cve, int node_id);
@@ -144,6 +150,35 @@ STATIC int wm_vuldet_get_children(sqlite3 * dbCVE, int configuration_id, int pac
  */
 STATIC int wm_vuldet_get_siblings(sqlite3 * dbCVE, int parent, int configuration_id, int *siblings);
 
+/**
+ * @brief Get the index of the NVD configuration trees, building it if it doesn't exist yet.
+ * @param dbCVE Database with NVD information.
+ * @return The shared index, or NULL on error.
+ */
+STATIC vu_nvd_conf_index *wm_vuldet_nvd_index_get(sqlite3 *dbCVE);
+
+/**
+ * @brief Read a list of links of the NVD configuration trees.
+ * @param dbCVE Database with NVD information.
+ * @param query Query returning the key and the ID of each link, sorted by both.
+ * @param links List to be filled.
+ * @param size Number of links read.
+ * @return 0 on success, -1 otherwise.
+ */
+STATIC int wm_vuldet_nvd_index_load(sqlite3 *dbCVE, const char *query, vu_nvd_link **links, size_t *size);
+
+/**
+ * @brief Fill an array with the IDs linked to a key, except the one given.
+ * @param links Sorted list of links.
+ * @param size Number of links.
+ * @param key Key to look for.
+ * @param exclude ID to be skipped.
+ * @param related Array to be filled.
+ */
+STATIC void wm_vuldet_nvd_index_related(const vu_nvd_link *links, size_t size, int key, int exclude, int *related);
+
+STATIC void wm_vuldet_free_nvd_index(vu_nvd_conf_index *index);
+
 STATIC void wm_vuldet_build_nvd_condition(vu_nvd_report *report, char **condition, char *is_hotfix);
 STATIC int wm_vuldet_check_nvd_logical(sqlite3 *db, char *agent_id, vu_nvd_report *rp, int conf_id, int parent);
 STATIC int wm_vuldet_add_extra_package(vu_nvd_report *rp, char *vendor, char *product);
@@ -1047,10 +1082,8 @@ int wm_vuldet_clean_nvd_metadata(sqlite3 *db, int year) {
     return 0;
 }
 
-int wm_vuldet_json_nvd_parser(char *json_feed, wm_vuldet_db *parsed_vulnerabilities) {
+void wm_vuldet_parse_nvd_item(cJSON *cve_list, nvd_vulnerability *nvd_it) {
     cJSON *cve_content;
-    nvd_vulnerability *nvd_it = NULL;
-    nvd_vulnerability *nvd_first = NULL;
     static char *JSON_CVE = "cve";
     static char *JSON_CONFIGURATIONS = "configurations";
     static char *JSON_IMPACT = "impact";
@@ -1060,6 +1093,31 @@ int wm_vuldet_json_nvd_parser(char *json_feed, wm_vuldet_db *parsed_vulnerabilit
     static char *JSON_DATA_FORMAT = "data_format";
     static char *JSON_DATA_VERSION = "data_version";
 
+    for (cve_content = cve_list->child; json_tagged_obj(cve_content); cve_content = cve_content->next) {
+        if (!strcmp(cve_content->string, JSON_CVE)) {
+            wm_vuldet_parse_nvd_cve(cve_content, nvd_it);
+        } else if (!strcmp(cve_content->string, JSON_CONFIGURATIONS)) {
+            wm_vuldet_parse_nvd_configuration(cve_content, nvd_it);
+        } else if (!strcmp(cve_content->string, JSON_IMPACT)) {
+            wm_vuldet_parse_nvd_impact(cve_content, nvd_it);
+        } else if (!strcmp(cve_content->string, JSON_PUBLISHED)) {
+            w_strdup(cve_content->valuestring, nvd_it->published);
+        } else if (!strcmp(cve_content->string, JSON_LAST_MOD)) {
+            w_strdup(cve_content->valuestring, nvd_it->last_modified);
+        } else if (strcmp(cve_content->string, JSON_DATA_TYPE) &&
+                    strcmp(cve_content->string, JSON_DATA_FORMAT) &&
+                    strcmp(cve_content->string, JSON_DATA_VERSION)) {
+            mtwarn(WM_VULNDETECTOR_LOGTAG, VU_UNKNOWN_NVD_CVE_TAG, cve_content->string);
+        } else {
+            mtwarn(WM_VULNDETECTOR_LOGTAG, VU_UNKNOWN_NVD_TAG, cve_content->string);
+        }
+    }
+}
+
+int wm_vuldet_json_nvd_parser(char *json_feed, wm_vuldet_db *parsed_vulnerabilities) {
+    nvd_vulnerability *nvd_it = NULL;
+    nvd_vulnerability *nvd_first = NULL;
+
     const char * cve;
     const char * next_cve;
     const char * match_cve = " {\r\n    \"cve\" : {\r\n";
@@ -1080,25 +1138,8 @@ int wm_vuldet_json_nvd_parser(char *json_feed, wm_vuldet_db *parsed_vulnerabilit
             os_calloc(1, sizeof(nvd_vulnerability), nvd_it);
             nvd_first = nvd_it;
         }
-        for (cve_content = cve_list->child; json_tagged_obj(cve_content); cve_content = cve_content->next) {
-            if (!strcmp(cve_content->string, JSON_CVE)) {
-                wm_vuldet_parse_nvd_cve(cve_content, nvd_it);
-            } else if (!strcmp(cve_content->string, JSON_CONFIGURATIONS)) {
-                wm_vuldet_parse_nvd_configuration(cve_content, nvd_it);
-            } else if (!strcmp(cve_content->string, JSON_IMPACT)) {
-                wm_vuldet_parse_nvd_impact(cve_content, nvd_it);
-            } else if (!strcmp(cve_content->string, JSON_PUBLISHED)) {
-                w_strdup(cve_content->valuestring, nvd_it->published);
-            } else if (!strcmp(cve_content->string, JSON_LAST_MOD)) {
-                w_strdup(cve_content->valuestring, nvd_it->last_modified);
-            } else if (strcmp(cve_content->string, JSON_DATA_TYPE) &&
-                        strcmp(cve_content->string, JSON_DATA_FORMAT) &&
-                        strcmp(cve_content->string, JSON_DATA_VERSION)) {
-                mtwarn(WM_VULNDETECTOR_LOGTAG, VU_UNKNOWN_NVD_CVE_TAG, cve_content->string);
-            } else {
-                mtwarn(WM_VULNDETECTOR_LOGTAG, VU_UNKNOWN_NVD_TAG, cve_content->string);
-            }
-        }
+
+        wm_vuldet_parse_nvd_item(cve_list, nvd_it);
 
         cJSON_Delete(cve_list);
     }
@@ -1113,6 +1154,146 @@ int wm_vuldet_json_nvd_parser(char *json_feed, wm_vuldet_db *parsed_vulnerabilit
     return 0;
 }
 
+int wm_vuldet_nvd_stream_item(vu_json_reader *reader, wm_vuldet_db *parsed_vulnerabilities, update_node *update) {
+    vu_insert_ctx *ctx = &parsed_vulnerabilities->insert;
+    nvd_vulnerability *nvd_it = NULL;
+    cJSON *cve_list;
+
+    reader->capturing = false;
+    reader->item[reader->item_len] = '\0';
+
+    if (cve_list = cJSON_Parse(reader->item), !cve_list) {
+        return OS_INVALID;
+    }
+
+    os_calloc(1, sizeof(nvd_vulnerability), nvd_it);
+    wm_vuldet_parse_nvd_item(cve_list, nvd_it);
+    cJSON_Delete(cve_list);
+
+    // The previous content of the feed is removed just before its first CVE is inserted
+    if ((!ctx->nvd_cves && wm_vuldet_clean_nvd_feed(ctx->db, update)) ||
+        wm_vuldet_insert_nvd_cve(ctx->db, nvd_it, update->update_it)) {
+        wm_vuldet_free_nvd_node(nvd_it);
+        // The database has been closed by the failed insert
+        ctx->db = NULL;
+        return OS_INVALID;
+    }
+
+    wm_vuldet_free_nvd_node(nvd_it);
+    ctx->nvd_cves++;
+
+    return 0;
+}
+
+int wm_vuldet_nvd_stream(vu_json_reader *reader, const char *data, size_t length, wm_vuldet_db *parsed_vulnerabilities, update_node *update) {
+    static const char *JSON_CVE_ITEMS = "CVE_Items";
+    size_t i;
+
+    for (i = 0; i < length; i++) {
+        char c = data[i];
+
+        if (reader->capturing) {
+            if (reader->item_len + 1 >= reader->item_size) {
+                reader->item_size = reader->item_size ? reader->item_size * 2 : OS_MAXSTR;
+                os_realloc(reader->item, reader->item_size, reader->item);
+            }
+            reader->item[reader->item_len++] = c;
+        }
+
+        if (reader->in_string) {
+            if (reader->escape) {
+                reader->escape = false;
+            } else if (c == '\\') {
+                reader->escape = true;
+            } else if (c == '"') {
+                reader->in_string = false;
+                reader->key[reader->key_len] = '\0';
+            } else if (reader->depth == 1 && reader->key_len < sizeof(reader->key) - 1) {
+                reader->key[reader->key_len++] = c;
+            }
+            continue;
+        }
+
+        switch (c) {
+        case '"':
+            reader->in_string = true;
+            reader->key_len = 0;
+            break;
+
+        case '{':
+            // Every object of the CVE list is a CVE item
+            if (reader->items_depth && reader->depth == reader->items_depth && !reader->capturing) {
+                if (!reader->item_size) {
+                    reader->item_size = OS_MAXSTR;
+                    os_malloc(reader->item_size, reader->item);
+                }
+                reader->capturing = true;
+                reader->item[0] = c;
+                reader->item_len = 1;
+            }
+            reader->depth++;
+            break;
+
+        case '[':
+            if (reader->depth == 1 && !strcmp(reader->key, JSON_CVE_ITEMS)) {
+                reader->items_depth = 2;
+            }
+            reader->depth++;
+            break;
+
+        case '}':
+        case ']':
+            if (!reader->depth) {
+                return OS_INVALID;
+            }
+
+            if (--reader->depth == reader->items_depth) {
+                if (c == '}' && reader->capturing) {
+                    if (wm_vuldet_nvd_stream_item(reader, parsed_vulnerabilities, update) == OS_INVALID) {
+                        return OS_INVALID;
+                    }
+                }
+            } else if (c == ']' && reader->depth + 1 == reader->items_depth) {
+                reader->items_depth = 0;
+            }
+            break;
+        }
+    }
+
+    return 0;
+}
+
+int wm_vuldet_json_nvd_stream(const char *path, wm_vuldet_db *parsed_vulnerabilities, update_node *update) {
+    char buffer[OS_MAXSTR];
+    size_t length;
+    vu_json_reader reader;
+    int retval = OS_INVALID;
+    FILE *fp;
+
+    memset(&reader, 0, sizeof(reader));
+
+    if (fp = fopen(path, "r"), !fp) {
+        mterror(WM_VULNDETECTOR_LOGTAG, VU_OPEN_FILE_ERROR, path);
+        return OS_INVALID;
+    }
+
+    // Only one CVE item is kept in memory at a time
+    while (length = fread(buffer, sizeof(char), sizeof(buffer), fp), length > 0) {
+        if (wm_vuldet_nvd_stream(&reader, buffer, length, parsed_vulnerabilities, update) == OS_INVALID) {
+            goto end;
+        }
+    }
+
+    if (!reader.depth && !reader.in_string) {
+        retval = 0;
+    }
+
+end:
+    fclose(fp);
+    os_free(reader.item);
+    return retval;
+}
+
 int wm_vuldet_parse_nvd_cve(cJSON *node, nvd_vulnerability *data) {
     cJSON *cve_data;
     cJSON *cve_data_it;
@@ -2149,8 +2330,11 @@ int wm_vuldet_process_agent_nvd_vulnerabilities(sqlite3 *db, vu_nvd_report **nvd
     char *url;
     char *ref_source;
     int retval = OS_INVALID;
+    vu_report_batch batch = {0};
 
     int sock = wm_vuldet_get_wdb_socket();
+    batch.agent_id = atoi(agent->agent_id);
+    batch.sock = &sock;
 
     report_node = *nvd_report;
     while(report_node) {
@@ -2298,49 +2482,9 @@ int wm_vuldet_process_agent_nvd_vulnerabilities(sqlite3 *db, vu_nvd_report **nvd
         // Adjusting some fields before inserting and sending
         wm_vuldet_give_report_format(report);
 
-        //Save the vulnerability in the agent database
-        bool check_pkg_existence = report->type && !strcmp(report->type, VULN_CVES_TYPE_PACKAGE);
-        cJSON* j_result = wdb_insert_vuln_cves(atoi(agent->agent_id), report->software, report->version, report->arch, report->cve,
-                                               report->severity, report->cvss2 ? report->cvss2->base_score : 0,
-                                               report->cvss3 ? report->cvss3->base_score : 0, report->reference, report->type, VULN_CVES_STATUS_VALID,
-                                               report->references, report->condition, report->title, report->published,
-                                               report->updated, check_pkg_existence, &sock);
-
-        bool success = FALSE;
-        bool update = FALSE;
-
-        if (j_result) {
-            cJSON* j_status = cJSON_GetObjectItem(j_result, "status");
-             success = (cJSON_IsString(j_status) && 0 == strcmp(j_status->valuestring, "SUCCESS"));
-            cJSON* j_action = cJSON_GetObjectItem(j_result, "action");
-            update = (cJSON_IsString(j_action) && 0 == strcmp(j_action->valuestring, "UPDATE"));
-            cJSON_Delete(j_result);
-        }
-        if(!success) {
-            mtdebug1(WM_VULNDETECTOR_LOGTAG, "Failed to insert %s for package %s in the agent %s database",
-                cve ? cve : "null",
-                report->reference ? report->reference : "null",
-                agent->agent_id ? agent->agent_id : "null");
-        }
-
-        if (report->is_hotfix) {
-            mtdebug2(WM_VULNDETECTOR_LOGTAG, VU_HOTFIX_VUL,
-                atoi(report->agent_id),
-                report->cve,
-                report->condition ? report->condition : "Hotfix is not installed.");
-        }
-        else if (report->software && report->version && report->agent_id && report->cve) {
-            mtdebug2(WM_VULNDETECTOR_LOGTAG, VU_PACK_VER_VULN, report->software,
-                report->version, atoi(report->agent_id), report->cve,
-                report->condition && *report->condition != '\0' ? report->condition :
-                "exists");
-        }
-
-        if (!update) {
-            // No report should be generated for vulnerabilities already reported
-            // Sending CVE report
-            wm_vuldet_send_cve_report(report);
-        }
+        // Save the vulnerability in the agent database and send the report
+        wm_vuldet_report_batch_add(&batch, report, VU_SRC_NVD);
+        report = NULL;
 
         wm_vuldet_free_nvd_report(f_report_node);
         os_free(f_report_node);
@@ -2349,6 +2493,7 @@ int wm_vuldet_process_agent_nvd_vulnerabilities(sqlite3 *db, vu_nvd_report **nvd
 
     retval = 0;
 error:
+    wm_vuldet_report_batch_flush(&batch);
     wm_vuldet_free_report(report);
     return retval ? wm_vuldet_sql_error(db, stmt) : 0;
 }
@@ -2360,10 +2505,12 @@ char *wm_vuldet_clean_version(const char *version) {
 
     os_strdup(version, dup);
 
+    char *save_ptr = NULL;
+
     // Store the data between : and -
-    strtok(dup, ":");
-    data = strtok(NULL, ":");
-    data = strtok((data) ? data : dup, "-");
+    strtok_r(dup, ":", &save_ptr);
+    data = strtok_r(NULL, ":", &save_ptr);
+    data = strtok_r((data) ? data : dup, "-", &save_ptr);
 
     w_strdup(data, clean_version);
     os_free(dup);
@@ -2849,47 +2996,127 @@ end:
 }
 
 int wm_vuldet_get_children(sqlite3 * dbCVE, int configuration_id, int package_id, int *children) {
-    sqlite3_stmt *stmt = NULL;
-    int i;
+    vu_nvd_conf_index *index;
 
-    if (wm_vuldet_prepare(dbCVE, vu_queries[VU_GET_CHILDREN], -1, &stmt, NULL) != SQLITE_OK) {
+    if (index = wm_vuldet_nvd_index_get(dbCVE), !index) {
         mterror(WM_VULNDETECTOR_LOGTAG, VU_GET_PACKAGES_DEP_ERROR, "children", package_id);
-        return wm_vuldet_sql_error(dbCVE, stmt);
+        return OS_INVALID;
     }
 
-    sqlite3_bind_int(stmt, 1, configuration_id);
-    sqlite3_bind_int(stmt, 2, package_id);
+    wm_vuldet_nvd_index_related(index->matches, index->matches_size, configuration_id, package_id, children);
 
-    for(i = 0; SQLITE_ROW == wm_vuldet_step(stmt) && i < MAX_RELATED_PKGS; i++) {
-        children[i] = sqlite3_column_int(stmt, 0);
+    return 0;
+}
+
+int wm_vuldet_get_siblings(sqlite3 * dbCVE, int parent, int configuration_id, int *siblings) {
+    vu_nvd_conf_index *index;
+
+    if (index = wm_vuldet_nvd_index_get(dbCVE), !index) {
+        mterror(WM_VULNDETECTOR_LOGTAG, VU_GET_PACKAGES_DEP_ERROR, "siblings", configuration_id);
+        return OS_INVALID;
     }
 
-    wdb_finalize(stmt);
+    wm_vuldet_nvd_index_related(index->configurations, index->configurations_size, parent, configuration_id, siblings);
 
     return 0;
 }
 
-int wm_vuldet_get_siblings(sqlite3 * dbCVE, int parent, int configuration_id, int *siblings) {
+vu_nvd_conf_index *wm_vuldet_nvd_index_get(sqlite3 *dbCVE) {
+    vu_nvd_conf_index *index;
+
+    w_mutex_lock(&vu_nvd_index_mutex);
+
+    if (index = vu_nvd_index, !index) {
+        os_calloc(1, sizeof(vu_nvd_conf_index), index);
+
+        if (wm_vuldet_nvd_index_load(dbCVE, vu_queries[VU_GET_NVD_MATCH_INDEX], &index->matches, &index->matches_size) ||
+            wm_vuldet_nvd_index_load(dbCVE, vu_queries[VU_GET_NVD_CONF_INDEX], &index->configurations, &index->configurations_size)) {
+            wm_vuldet_free_nvd_index(index);
+            index = NULL;
+        } else {
+            vu_nvd_index = index;
+        }
+    }
+
+    w_mutex_unlock(&vu_nvd_index_mutex);
+    return index;
+}
+
+int wm_vuldet_nvd_index_load(sqlite3 *dbCVE, const char *query, vu_nvd_link **links, size_t *size) {
     sqlite3_stmt *stmt = NULL;
-    int i;
+    size_t allocated = 0;
+    int result;
 
-    if (wm_vuldet_prepare(dbCVE, vu_queries[VU_GET_SIBLINGS], -1, &stmt, NULL) != SQLITE_OK) {
-        mterror(WM_VULNDETECTOR_LOGTAG, VU_GET_PACKAGES_DEP_ERROR, "siblings", configuration_id);
+    if (wm_vuldet_prepare(dbCVE, query, -1, &stmt, NULL) != SQLITE_OK) {
         return wm_vuldet_sql_error(dbCVE, stmt);
     }
 
-    sqlite3_bind_int(stmt, 1, parent);
-    sqlite3_bind_int(stmt, 2, configuration_id);
+    while (result = wm_vuldet_step(stmt), result == SQLITE_ROW) {
+        if (*size == allocated) {
+            allocated = allocated ? allocated * 2 : VU_NVD_INDEX_SIZE;
+            os_realloc(*links, allocated * sizeof(vu_nvd_link), *links);
+        }
 
-    for(i = 0; SQLITE_ROW == wm_vuldet_step(stmt) && i < MAX_RELATED_PKGS; i++) {
-        siblings[i] = sqlite3_column_int(stmt, 0);
+        (*links)[*size].key = sqlite3_column_int(stmt, 0);
+        (*links)[*size].id = sqlite3_column_int(stmt, 1);
+        (*size)++;
+    }
+
+    if (result != SQLITE_DONE) {
+        return wm_vuldet_sql_error(dbCVE, stmt);
     }
 
     wdb_finalize(stmt);
 
+    // The index lives until the next feed update, so give back the unused room
+    if (*size && *size < allocated) {
+        os_realloc(*links, *size * sizeof(vu_nvd_link), *links);
+    }
+
     return 0;
 }
 
+void wm_vuldet_nvd_index_related(const vu_nvd_link *links, size_t size, int key, int exclude, int *related) {
+    size_t low = 0;
+    size_t high = size;
+    size_t mid;
+    int i = 0;
+
+    // Look for the first link of the key
+    while (low < high) {
+        mid = low + (high - low) / 2;
+
+        if (links[mid].key < key) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    for (; low < size && links[low].key == key && i < MAX_RELATED_PKGS; low++) {
+        if (links[low].id != exclude) {
+            related[i++] = links[low].id;
+        }
+    }
+}
+
+void wm_vuldet_free_nvd_index(vu_nvd_conf_index *index) {
+    os_free(index->matches);
+    os_free(index->configurations);
+    os_free(index);
+}
+
+void wm_vuldet_nvd_index_clean() {
+    w_mutex_lock(&vu_nvd_index_mutex);
+
+    if (vu_nvd_index) {
+        wm_vuldet_free_nvd_index(vu_nvd_index);
+        vu_nvd_index = NULL;
+    }
+
+    w_mutex_unlock(&vu_nvd_index_mutex);
+}
+
 void wm_vuldet_build_nvd_condition(vu_nvd_report *report, char **condition, char *is_hotfix) {
     const char *operation = NULL;
     char *operation_value = NULL;
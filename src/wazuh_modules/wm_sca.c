@@ -45,6 +45,91 @@ static const int RETURN_NOT_FOUND = 0;
 static const int RETURN_FOUND = 1;
 static const int RETURN_INVALID = 2;
 
+#define WM_SCA_CACHE_FILE_MAX   (1024 * 1024)   // Larger files are read line by line on every check
+
+#define WM_SCA_PATTERN_REGEX        'r'
+#define WM_SCA_PATTERN_SUBSTRINGS   's'
+#define WM_SCA_PATTERN_MATCH        'm'
+
+/* Inputs of the rules. Each one is read, run or compiled once per scan */
+typedef struct wm_sca_file_t {
+    int error;                  // errno of fopen(), 0 if the file was read
+    char **lines;
+    unsigned int cached:1;
+} wm_sca_file_t;
+
+typedef struct wm_sca_command_t {
+    int status;                 // Return value of wm_exec()
+    int result_code;
+    char **lines;               // NULL if the command yielded no output
+    unsigned int cached:1;
+    unsigned int running:1;     // Another check is waiting for this output
+} wm_sca_command_t;
+
+typedef struct wm_sca_dir_entry_t {
+    char *name;
+    int is_dir;                 // -1 if the entry could not be checked
+} wm_sca_dir_entry_t;
+
+typedef struct wm_sca_dir_t {
+    int error;                  // errno of opendir(), 0 if the directory was listed
+    wm_sca_dir_entry_t *entries;
+    size_t size;
+    unsigned int cached:1;
+} wm_sca_dir_t;
+
+typedef struct wm_sca_pattern_t {
+    char type;
+    int compiled;
+    OSRegex regex;
+    OSMatch match;
+    unsigned int cached:1;
+} wm_sca_pattern_t;
+
+typedef struct wm_sca_scan_cache_t {
+    OSHash *files;              // Keyed by real path
+    OSHash *commands;           // Keyed by command line
+    OSHash *dirs;               // Keyed by real path
+    OSHash *patterns;           // Keyed by pattern type and pattern
+    pthread_mutex_t mutex;      // Protects commands and their running state. The other tables use the _ex calls.
+    pthread_cond_t available;
+    int running_commands;
+    unsigned int synchronized:1;
+} wm_sca_scan_cache_t;
+
+/* Checks are evaluated concurrently and emitted in policy order */
+typedef enum wm_sca_check_status_t {
+    WM_SCA_CHECK_PENDING = 0,
+    WM_SCA_CHECK_EVALUATED,
+    WM_SCA_CHECK_INVALID_ID,    // The check is skipped
+    WM_SCA_CHECK_SKIPPED,       // The check is skipped, or the requirements fail
+    WM_SCA_CHECK_ABORTED        // The policy is skipped
+} wm_sca_check_status_t;
+
+typedef struct wm_sca_check_result_t {
+    wm_sca_check_status_t status;
+    int g_found;
+    char *reason;
+    char *alert_msg[256];
+} wm_sca_check_result_t;
+
+typedef struct wm_sca_scan_t {
+    wm_sca_t *data;
+    OSStore *vars;
+    cJSON *policy;
+    char **sorted_variables;
+    int requirements_scan;
+    unsigned int remote_policy;
+    OSList *p_list;             // Loaded by the first process rule
+    int p_list_loaded;
+    const cJSON *next_check;    // Next check to be taken by a worker
+    int next_index;
+    int aborted;
+    wm_sca_check_result_t *results;
+    pthread_mutex_t mutex;
+    pthread_cond_t evaluated;
+} wm_sca_scan_t;
+
 #ifdef WIN32
 static DWORD WINAPI wm_sca_main(void *arg);         // Module main function. It won't return
 #else
@@ -56,6 +141,12 @@ static cJSON *wm_sca_build_event(const cJSON * const check, const cJSON * const
 static int wm_sca_send_event_check(wm_sca_t * data,cJSON *event);  // Send check event
 static void wm_sca_read_files(wm_sca_t * data);  // Read policy monitoring files
 static int wm_sca_do_scan(cJSON *checks, OSStore *vars, wm_sca_t * data, int id, cJSON *policy, int requirements_scan, int cis_db_index, unsigned int remote_policy, int first_scan, int *checks_number, char ** sorted_variables);
+static wm_sca_check_status_t wm_sca_evaluate_check(wm_sca_scan_t * const scan, const cJSON * const check, wm_sca_check_result_t * const result);
+static void wm_sca_free_check_result(wm_sca_check_result_t *result);
+static OSList *wm_sca_scan_process_list(wm_sca_scan_t * const scan);
+#ifndef WIN32
+static void *wm_sca_scan_worker(wm_sca_scan_t * const scan);
+#endif
 static int wm_sca_send_summary(wm_sca_t * data, int scan_id,unsigned int passed, unsigned int failed,unsigned int invalid,cJSON *policy,int start_time,int end_time, char * integrity_hash, char * integrity_hash_file, int first_scan, int id, int checks_number);
 static int wm_sca_check_policy(const cJSON * const policy, const cJSON * const checks, OSHash *global_check_list);
 static int wm_sca_check_requirements(const cJSON * const requirements);
@@ -74,7 +165,7 @@ static void * wm_sca_dump_db_thread(wm_sca_t * data);
 #endif
 static void wm_sca_send_policies_scanned(wm_sca_t * data);
 static int wm_sca_send_dump_end(wm_sca_t * data, unsigned int elements_sent,char * policy_id,int scan_id);  // Send dump end event
-static int append_msg_to_vm_scat (wm_sca_t * const data, const char * const msg);
+static int append_msg_to_vm_scat (char **alert_msg, const char * const msg);
 static int compare_cis_db_info_t_entry(const void * const a, const void * const  b);
 
 #ifndef WIN32
@@ -96,12 +187,25 @@ static int wm_sca_test_positive_minterm(char * const minterm, const char * const
 static int wm_sca_pattern_matches(const char * const str, const char * const pattern, char **reason); // Check pattern match
 static int wm_sca_check_dir(const char * const dir, const char * const file, char * const pattern, char **reason);
 static int wm_sca_check_dir_existence(const char * const dir, char **reason);
-static int wm_sca_check_dir_list(wm_sca_t * const data, char * const dir_list, char * const file, char * const pattern, char **reason);
+static int wm_sca_check_dir_list(wm_sca_t * const data, char **alert_msg, char * const dir_list, char * const file, char * const pattern, char **reason);
 static int wm_sca_check_process_is_running(OSList *p_list, char *value, char **reason);
 #ifndef WIN32
 static int wm_sca_resolve_symlink(const char * const file, char * realpath_buffer, char **reason);
 #endif
 static int wm_sca_apply_numeric_partial_comparison(const char * const partial_comparison, const long int number, char **reason);
+static void wm_sca_scan_cache_init();
+static void wm_sca_scan_cache_free();
+static wm_sca_file_t *wm_sca_get_file(const char * const path);
+static void wm_sca_free_file(wm_sca_file_t *contents);
+static void wm_sca_run_command(char * const command, wm_sca_t * const data, wm_sca_command_t * const output);
+static wm_sca_command_t *wm_sca_get_command(char * const command, wm_sca_t * const data);
+static void wm_sca_free_command(wm_sca_command_t *output);
+static wm_sca_dir_t *wm_sca_get_dir(const char * const path);
+static void wm_sca_free_dir(wm_sca_dir_t *listing);
+static wm_sca_pattern_t *wm_sca_get_compiled_pattern(const char type, const char * const pattern);
+static void wm_sca_free_pattern(wm_sca_pattern_t *compiled);
+static int wm_sca_regex_matches(const char * const pattern, const char * const str);
+static int wm_sca_match_matches(const char * const pattern, const char * const str);
 
 #ifdef WIN32
 static int wm_check_registry_entry(char * const value, char **reason);
@@ -138,6 +242,9 @@ cJSON **last_summary_json = NULL;
 /* Multiple readers / one write mutex */
 static pthread_rwlock_t dump_rwlock;
 
+/* Files, commands, directories and patterns seen during the running scan */
+static wm_sca_scan_cache_t *scan_cache;
+
 // Module main function. It won't return
 #ifdef WIN32
 DWORD WINAPI wm_sca_main(void *arg) {
@@ -168,9 +275,13 @@ void * wm_sca_main(wm_sca_t * data) {
     data->request_db_interval = 300;
     data->remote_commands = 0;
     data->commands_timeout = 30;
+    data->scan_threads = 4;
+    data->max_running_commands = 2;
 
     data->request_db_interval = getDefine_Int("sca","request_db_interval", 1, 60) * 60;
     data->commands_timeout = getDefine_Int("sca", "commands_timeout", 1, 300);
+    data->scan_threads = getDefine_Int("sca", "scan_threads", 1, 32);
+    data->max_running_commands = getDefine_Int("sca", "max_running_commands", 1, 32);
 #ifdef CLIENT
     data->remote_commands = getDefine_Int("sca", "remote_commands", 0, 1);
 #else
@@ -349,6 +460,8 @@ static void wm_sca_read_files(wm_sca_t * data) {
     if(data->policies) {
         OSHash *check_list = OSHash_Create();
         int i;
+
+        wm_sca_scan_cache_init();
         for(i = 0; data->policies[i]; i++) {
             if(!data->policies[i]->enabled){
                 continue;
@@ -535,6 +648,7 @@ static void wm_sca_read_files(wm_sca_t * data) {
         }
         first_scan = 0;
         OSHash_Clean(check_list, free);
+        wm_sca_scan_cache_free();
     }
 }
 
@@ -824,7 +938,7 @@ static int wm_sca_resolve_symlink(const char * const file, char * realpath_buffe
 }
 #endif
 
-static int wm_sca_check_dir_list(wm_sca_t * const data, char * const dir_list,
+static int wm_sca_check_dir_list(wm_sca_t * const data, char **alert_msg, char * const dir_list,
     char * const file, char * const pattern, char **reason)
 {
     char *f_value_copy;
@@ -863,7 +977,7 @@ static int wm_sca_check_dir_list(wm_sca_t * const data, char * const dir_list,
         char _b_msg[OS_SIZE_1024 + 1];
         _b_msg[OS_SIZE_1024] = '\0';
         snprintf(_b_msg, OS_SIZE_1024, " Directory: %s", dir);
-        append_msg_to_vm_scat(data, _b_msg);
+        append_msg_to_vm_scat(alert_msg, _b_msg);
 
         if (found == RETURN_FOUND) {
             break;
@@ -924,246 +1038,181 @@ ANY and NONE aggregators are complementary.
 
 */
 
-static int wm_sca_do_scan(cJSON *checks, OSStore *vars, wm_sca_t * data, int id,cJSON *policy,
-    int requirements_scan, int cis_db_index, unsigned int remote_policy, int first_scan, int *checks_number, char **sorted_variables)
+static void wm_sca_free_check_result(wm_sca_check_result_t *result)
 {
-    int type = 0;
-    char buf[OS_SIZE_1024 + 2];
-    char final_file[2048 + 1];
-    char *reason = NULL;
-
-    int ret_val = 0;
-    OSList *p_list = NULL;
+    int i;
 
-    /* Initialize variables */
-    memset(buf, '\0', sizeof(buf));
-    memset(final_file, '\0', sizeof(final_file));
+    for (i = 0; result->alert_msg[i]; i++) {
+        os_free(result->alert_msg[i]);
+    }
 
-    int check_count = 0;
-    cJSON *check = NULL;
-    cJSON_ArrayForEach(check, checks) {
-        char _check_id_str[50];
-        if (requirements_scan) {
-            snprintf(_check_id_str, sizeof(_check_id_str), "Requirements check");
-        } else {
-            const cJSON * const c_id = cJSON_GetObjectItem(check, "id");
-            if (!c_id || !c_id->valueint) {
-                merror("Skipping check. Check ID is invalid. Offending check number: %d", check_count);
-                ret_val = 1;
-                continue;
-            }
-            snprintf(_check_id_str, sizeof(_check_id_str), "id: %d", c_id->valueint);
-        }
+    os_free(result->reason);
+}
 
-        const cJSON * const c_title = cJSON_GetObjectItem(check, "title");
-        if (!c_title || !c_title->valuestring) {
-            merror("Skipping check with %s: Check name is invalid.", _check_id_str);
-            if (requirements_scan) {
-                ret_val = 1;
-                goto clean_return;
-            }
-            continue;
-        }
+/* Evaluate the rules of a check. It does not touch the policy state, so checks can be evaluated in any order */
+static wm_sca_check_status_t wm_sca_evaluate_check(wm_sca_scan_t * const scan, const cJSON * const check, wm_sca_check_result_t * const result)
+{
+    wm_sca_t * const data = scan->data;
+    char ** const sorted_variables = scan->sorted_variables;
+    OSStore * const vars = scan->vars;
+    char **reason = &result->reason;
+    int type = 0;
 
-        const cJSON * const c_condition = cJSON_GetObjectItem(check, "condition");
-        if (!c_condition || !c_condition->valuestring) {
-            merror("Skipping check '%s: %s': Check condition not found.", _check_id_str, c_title->valuestring);
-            if (requirements_scan) {
-                ret_val = 1;
-                goto clean_return;
-            }
-            continue;
+    char _check_id_str[50];
+    if (scan->requirements_scan) {
+        snprintf(_check_id_str, sizeof(_check_id_str), "Requirements check");
+    } else {
+        const cJSON * const c_id = cJSON_GetObjectItem(check, "id");
+        if (!c_id || !c_id->valueint) {
+            return WM_SCA_CHECK_INVALID_ID;
         }
+        snprintf(_check_id_str, sizeof(_check_id_str), "id: %d", c_id->valueint);
+    }
 
-        int condition = 0;
-        wm_sca_set_condition(c_condition->valuestring, &condition);
-
-        if (condition == WM_SCA_COND_INV) {
-            merror("Skipping check '%s: %s': Check condition (%s) is invalid.",_check_id_str, c_title->valuestring, c_condition->valuestring);
-            if (requirements_scan) {
-                ret_val = 1;
-                goto clean_return;
-            }
-            continue;
-        }
+    const cJSON * const c_title = cJSON_GetObjectItem(check, "title");
+    if (!c_title || !c_title->valuestring) {
+        merror("Skipping check with %s: Check name is invalid.", _check_id_str);
+        return WM_SCA_CHECK_SKIPPED;
+    }
 
-        int g_found = RETURN_NOT_FOUND;
-        if ((condition & WM_SCA_COND_ANY) || (condition & WM_SCA_COND_NON)) {
-            /* aggregators ANY and NONE break by matching, so they shall return NOT_FOUND if they never break */
-            g_found = RETURN_NOT_FOUND;
-        } else if (condition & WM_SCA_COND_ALL) {
-            /* aggregator ALL breaks the moment a rule does not match. If it doesn't break, all rules have matched */
-            g_found = RETURN_FOUND;
-        }
+    const cJSON * const c_condition = cJSON_GetObjectItem(check, "condition");
+    if (!c_condition || !c_condition->valuestring) {
+        merror("Skipping check '%s: %s': Check condition not found.", _check_id_str, c_title->valuestring);
+        return WM_SCA_CHECK_SKIPPED;
+    }
 
-        mdebug1("Beginning evaluation of check %s '%s'", _check_id_str, c_title->valuestring);
-        mdebug1("Rule aggregation strategy for this check is '%s'", c_condition->valuestring);
-        mdebug2("Initial rule-aggregator value por this type of rule is '%d'",  g_found);
-        mdebug1("Beginning rules evaluation.");
+    int condition = 0;
+    wm_sca_set_condition(c_condition->valuestring, &condition);
 
-        const cJSON *const rules = cJSON_GetObjectItem(check, "rules");
-        if (!rules) {
-            merror("Skipping check %s '%s': No rules found.", _check_id_str, c_title->valuestring);
-            if (requirements_scan) {
-                ret_val = 1;
-                goto clean_return;
-            }
-            continue;
-        }
+    if (condition == WM_SCA_COND_INV) {
+        merror("Skipping check '%s: %s': Check condition (%s) is invalid.",_check_id_str, c_title->valuestring, c_condition->valuestring);
+        return WM_SCA_CHECK_SKIPPED;
+    }
 
-        char *rule_cp = NULL;
-        const cJSON *rule_ref;
-        cJSON_ArrayForEach(rule_ref, rules) {
-            /* this free is responsible of freeing the copy of the previous rule if
-            the loop 'continues', i.e, does not reach the end of its block. */
-            os_free(rule_cp);
+    int g_found = RETURN_NOT_FOUND;
+    if ((condition & WM_SCA_COND_ANY) || (condition & WM_SCA_COND_NON)) {
+        /* aggregators ANY and NONE break by matching, so they shall return NOT_FOUND if they never break */
+        g_found = RETURN_NOT_FOUND;
+    } else if (condition & WM_SCA_COND_ALL) {
+        /* aggregator ALL breaks the moment a rule does not match. If it doesn't break, all rules have matched */
+        g_found = RETURN_FOUND;
+    }
 
-            if(!rule_ref->valuestring) {
-                mdebug1("Field 'rule' must be a string.");
-                ret_val = 1;
-                goto clean_return;
-            }
+    mdebug1("Beginning evaluation of check %s '%s'", _check_id_str, c_title->valuestring);
+    mdebug1("Rule aggregation strategy for this check is '%s'", c_condition->valuestring);
+    mdebug2("Initial rule-aggregator value por this type of rule is '%d'",  g_found);
+    mdebug1("Beginning rules evaluation.");
 
-            mdebug1("Considering rule: '%s'", rule_ref->valuestring);
+    const cJSON *const rules = cJSON_GetObjectItem(check, "rules");
+    if (!rules) {
+        merror("Skipping check %s '%s': No rules found.", _check_id_str, c_title->valuestring);
+        return WM_SCA_CHECK_SKIPPED;
+    }
 
-            os_strdup(rule_ref->valuestring, rule_cp);
-            char *rule_cp_ref = NULL;
+    char *rule_cp = NULL;
+    const cJSON *rule_ref;
+    cJSON_ArrayForEach(rule_ref, rules) {
+        /* this free is responsible of freeing the copy of the previous rule if
+        the loop 'continues', i.e, does not reach the end of its block. */
+        os_free(rule_cp);
 
-        #ifdef WIN32
-            char expanded_rule[2048] = {0};
-            ExpandEnvironmentStrings(rule_cp, expanded_rule, 2048);
-            rule_cp_ref = expanded_rule;
-            mdebug2("Rule after variable expansion: '%s'", rule_cp_ref);
-        #else
-            rule_cp_ref = rule_cp;
-        #endif
+        if(!rule_ref->valuestring) {
+            mdebug1("Field 'rule' must be a string.");
+            return WM_SCA_CHECK_ABORTED;
+        }
 
-            int rule_is_negated = 0;
-            if (rule_cp_ref &&
-                    (strncmp(rule_cp_ref, "NOT ", 4) == 0 ||
-                     strncmp(rule_cp_ref, "not ", 4) == 0))
-            {
-                mdebug2("Rule is negated.");
-                rule_is_negated = 1;
-                rule_cp_ref += 4;
-            }
+        mdebug1("Considering rule: '%s'", rule_ref->valuestring);
 
-            /* Get value to look for. char *value is a reference
-            to rule_cp memory. Do not release value!  */
-            char *value = wm_sca_get_value(rule_cp_ref, &type);
+        os_strdup(rule_ref->valuestring, rule_cp);
+        char *rule_cp_ref = NULL;
 
-            if (value == NULL) {
-                merror("Invalid rule: '%s'. Skipping policy.", rule_ref->valuestring);
-                os_free(rule_cp);
-                ret_val = 1;
-                goto clean_return;
-            }
+    #ifdef WIN32
+        char expanded_rule[2048] = {0};
+        ExpandEnvironmentStrings(rule_cp, expanded_rule, 2048);
+        rule_cp_ref = expanded_rule;
+        mdebug2("Rule after variable expansion: '%s'", rule_cp_ref);
+    #else
+        rule_cp_ref = rule_cp;
+    #endif
 
-            int found = RETURN_NOT_FOUND;
-            if (type == WM_SCA_TYPE_FILE) {
-                /* Check files */
-                char *pattern = wm_sca_get_pattern(value);
-                char *rule_location = NULL;
-                char *aux = NULL;
+        int rule_is_negated = 0;
+        if (rule_cp_ref &&
+                (strncmp(rule_cp_ref, "NOT ", 4) == 0 ||
+                 strncmp(rule_cp_ref, "not ", 4) == 0))
+        {
+            mdebug2("Rule is negated.");
+            rule_is_negated = 1;
+            rule_cp_ref += 4;
+        }
 
-                os_strdup(value, rule_location);
+        /* Get value to look for. char *value is a reference
+        to rule_cp memory. Do not release value!  */
+        char *value = wm_sca_get_value(rule_cp_ref, &type);
 
-                /* If any, replace the variables by their respective values */
-                if (sorted_variables) {
-                    for (int i = 0; sorted_variables[i]; i++) {
-                        if (strstr(rule_location, sorted_variables[i])) {
-                            mdebug2("Variable '%s' found at rule '%s'. Replacing it.", sorted_variables[i], rule_location);
-                            aux = wstr_replace(rule_location, sorted_variables[i], OSStore_Get(vars, sorted_variables[i]));
-                            os_free(rule_location);
-                            rule_location = aux;
-                            if (!rule_location) {
-                                merror("Invalid variable replacement: '%s'. Skipping check.", sorted_variables[i]);
-                                break;
-                            }
-                            mdebug2("Variable replaced: '%s'", rule_location);
+        if (value == NULL) {
+            merror("Invalid rule: '%s'. Skipping policy.", rule_ref->valuestring);
+            os_free(rule_cp);
+            return WM_SCA_CHECK_ABORTED;
+        }
+
+        int found = RETURN_NOT_FOUND;
+        if (type == WM_SCA_TYPE_FILE) {
+            /* Check files */
+            char *pattern = wm_sca_get_pattern(value);
+            char *rule_location = NULL;
+            char *aux = NULL;
+
+            os_strdup(value, rule_location);
+
+            /* If any, replace the variables by their respective values */
+            if (sorted_variables) {
+                for (int i = 0; sorted_variables[i]; i++) {
+                    if (strstr(rule_location, sorted_variables[i])) {
+                        mdebug2("Variable '%s' found at rule '%s'. Replacing it.", sorted_variables[i], rule_location);
+                        aux = wstr_replace(rule_location, sorted_variables[i], OSStore_Get(vars, sorted_variables[i]));
+                        os_free(rule_location);
+                        rule_location = aux;
+                        if (!rule_location) {
+                            merror("Invalid variable replacement: '%s'. Skipping check.", sorted_variables[i]);
+                            break;
                         }
+                        mdebug2("Variable replaced: '%s'", rule_location);
                     }
                 }
+            }
 
-                if (!rule_location) {
-                    continue;
-                }                   
-
-                const int result = wm_sca_check_file_list(rule_location, pattern, &reason);
-                if (result == RETURN_FOUND || result == RETURN_INVALID) {
-                    found = result;
-                }
-
-                char _b_msg[OS_SIZE_1024 + 1];
-                _b_msg[OS_SIZE_1024] = '\0';
-                snprintf(_b_msg, OS_SIZE_1024, " File: %s", rule_location);
-                append_msg_to_vm_scat(data, _b_msg);
-                os_free(rule_location);
-
-            } else if (type == WM_SCA_TYPE_COMMAND) {
-                /* Check command output */
-                char *pattern = wm_sca_get_pattern(value);
-                char *rule_location = NULL;
-                char *aux = NULL;
-
-                os_strdup(value, rule_location);
-                
-                if (!data->remote_commands && remote_policy) {
-                    mwarn("Ignoring check for policy '%s'. The internal option 'sca.remote_commands' is disabled.", cJSON_GetObjectItem(policy, "name")->valuestring);
-                    if (reason == NULL) {
-                        os_malloc(OS_MAXSTR, reason);
-                        sprintf(reason, "Ignoring check for running command '%s'. The internal option 'sca.remote_commands' is disabled", rule_location);
-                    }
-                    found = RETURN_INVALID;
+            if (!rule_location) {
+                continue;
+            }
 
-                } else {
-                    /* If any, replace the variables by their respective values */
-                    if (sorted_variables) {
-                        for (int i = 0; sorted_variables[i]; i++) {
-                            if (strstr(rule_location, sorted_variables[i])) {
-                                mdebug2("Variable '%s' found at rule '%s'. Replacing it.", sorted_variables[i], rule_location);
-                                aux = wstr_replace(rule_location, sorted_variables[i], OSStore_Get(vars, sorted_variables[i]));
-                                os_free(rule_location);
-                                rule_location = aux;
-                                if (!rule_location) {
-                                    merror("Invalid variable: '%s'. Skipping check.", sorted_variables[i]);
-                                    break;
-                                }
-                                mdebug2("Variable replaced: '%s'", rule_location);
-                            }
-                        }
-                    }
+            const int file_result = wm_sca_check_file_list(rule_location, pattern, reason);
+            if (file_result == RETURN_FOUND || file_result == RETURN_INVALID) {
+                found = file_result;
+            }
 
-                    if (!rule_location) {
-                        continue;
-                    }    
-
-                    mdebug2("Running command: '%s'", rule_location);
-                    const int val = wm_sca_read_command(rule_location, pattern, data, &reason);
-                    if (val == RETURN_FOUND) {
-                        mdebug2("Command output matched.");
-                        found = RETURN_FOUND;
-                    } else if (val == RETURN_INVALID){
-                        mdebug2("Command output did not match.");
-                        found = RETURN_INVALID;
-                    }
-                }
+            char _b_msg[OS_SIZE_1024 + 1];
+            _b_msg[OS_SIZE_1024] = '\0';
+            snprintf(_b_msg, OS_SIZE_1024, " File: %s", rule_location);
+            append_msg_to_vm_scat(result->alert_msg, _b_msg);
+            os_free(rule_location);
 
-                char _b_msg[OS_SIZE_1024 + 1];
-                _b_msg[OS_SIZE_1024] = '\0';
-                snprintf(_b_msg, OS_SIZE_1024, " Command: %s", rule_location);
-                append_msg_to_vm_scat(data, _b_msg);
-                os_free(rule_location);
+        } else if (type == WM_SCA_TYPE_COMMAND) {
+            /* Check command output */
+            char *pattern = wm_sca_get_pattern(value);
+            char *rule_location = NULL;
+            char *aux = NULL;
 
-            } else if (type == WM_SCA_TYPE_DIR) {
-                /* Check directory */
-                mdebug2("Processing directory rule '%s'", value);
-                char * const file = wm_sca_get_pattern(value);
-                char *rule_location = NULL;
-                char *aux = NULL;
+            os_strdup(value, rule_location);
 
-                os_strdup(value, rule_location);
+            if (!data->remote_commands && scan->remote_policy) {
+                mwarn("Ignoring check for policy '%s'. The internal option 'sca.remote_commands' is disabled.", cJSON_GetObjectItem(scan->policy, "name")->valuestring);
+                if (*reason == NULL) {
+                    os_malloc(OS_MAXSTR, *reason);
+                    sprintf(*reason, "Ignoring check for running command '%s'. The internal option 'sca.remote_commands' is disabled", rule_location);
+                }
+                found = RETURN_INVALID;
 
+            } else {
                 /* If any, replace the variables by their respective values */
                 if (sorted_variables) {
                     for (int i = 0; sorted_variables[i]; i++) {
@@ -1183,94 +1232,258 @@ static int wm_sca_do_scan(cJSON *checks, OSStore *vars, wm_sca_t * data, int id,
 
                 if (!rule_location) {
                     continue;
-                }    
-
-                char * const pattern = wm_sca_get_pattern(file);
-                found = wm_sca_check_dir_list(data, rule_location, file, pattern, &reason);
-                mdebug2("Check directory rule result: %d", found);
-                os_free(rule_location);
-
-            } else if (type == WM_SCA_TYPE_PROCESS) {
-                /* Check process existence */
-                if (!p_list) {
-                    /* Lazy evaluation */
-                    p_list = w_os_get_process_list();
                 }
 
-                mdebug2("Checking process: '%s'", value);
-                if (wm_sca_check_process_is_running(p_list, value, &reason)) {
-                    mdebug2("Process found.");
+                mdebug2("Running command: '%s'", rule_location);
+                const int val = wm_sca_read_command(rule_location, pattern, data, reason);
+                if (val == RETURN_FOUND) {
+                    mdebug2("Command output matched.");
                     found = RETURN_FOUND;
-                } else {
-                    mdebug2("Process not found.");
+                } else if (val == RETURN_INVALID){
+                    mdebug2("Command output did not match.");
+                    found = RETURN_INVALID;
                 }
+            }
 
-                char _b_msg[OS_SIZE_1024 + 1];
-                _b_msg[OS_SIZE_1024] = '\0';
-                snprintf(_b_msg, OS_SIZE_1024, " Process: %s", value);
-                append_msg_to_vm_scat(data, _b_msg);
+            char _b_msg[OS_SIZE_1024 + 1];
+            _b_msg[OS_SIZE_1024] = '\0';
+            snprintf(_b_msg, OS_SIZE_1024, " Command: %s", rule_location);
+            append_msg_to_vm_scat(result->alert_msg, _b_msg);
+            os_free(rule_location);
+
+        } else if (type == WM_SCA_TYPE_DIR) {
+            /* Check directory */
+            mdebug2("Processing directory rule '%s'", value);
+            char * const file = wm_sca_get_pattern(value);
+            char *rule_location = NULL;
+            char *aux = NULL;
+
+            os_strdup(value, rule_location);
+
+            /* If any, replace the variables by their respective values */
+            if (sorted_variables) {
+                for (int i = 0; sorted_variables[i]; i++) {
+                    if (strstr(rule_location, sorted_variables[i])) {
+                        mdebug2("Variable '%s' found at rule '%s'. Replacing it.", sorted_variables[i], rule_location);
+                        aux = wstr_replace(rule_location, sorted_variables[i], OSStore_Get(vars, sorted_variables[i]));
+                        os_free(rule_location);
+                        rule_location = aux;
+                        if (!rule_location) {
+                            merror("Invalid variable: '%s'. Skipping check.", sorted_variables[i]);
+                            break;
+                        }
+                        mdebug2("Variable replaced: '%s'", rule_location);
+                    }
+                }
             }
-        #ifdef WIN32
-            else if (type == WM_SCA_TYPE_REGISTRY) {
-                /* Check windows registry */
-                found = wm_check_registry_entry(value, &reason);
 
-                char _b_msg[OS_SIZE_1024 + 1];
-                _b_msg[OS_SIZE_1024] = '\0';
-                snprintf(_b_msg, OS_SIZE_1024, " Registry: %s", value);
-                append_msg_to_vm_scat(data, _b_msg);
+            if (!rule_location) {
+                continue;
             }
-        #endif
 
-            /* Rule result processing */
+            char * const pattern = wm_sca_get_pattern(file);
+            found = wm_sca_check_dir_list(data, result->alert_msg, rule_location, file, pattern, reason);
+            mdebug2("Check directory rule result: %d", found);
+            os_free(rule_location);
 
-            if (found != RETURN_INVALID) {
-                found = rule_is_negated ^ found;
+        } else if (type == WM_SCA_TYPE_PROCESS) {
+            /* Check process existence */
+            mdebug2("Checking process: '%s'", value);
+            if (wm_sca_check_process_is_running(wm_sca_scan_process_list(scan), value, reason)) {
+                mdebug2("Process found.");
+                found = RETURN_FOUND;
+            } else {
+                mdebug2("Process not found.");
             }
 
-            mdebug1("Result for rule '%s': %d", rule_ref->valuestring, found);
+            char _b_msg[OS_SIZE_1024 + 1];
+            _b_msg[OS_SIZE_1024] = '\0';
+            snprintf(_b_msg, OS_SIZE_1024, " Process: %s", value);
+            append_msg_to_vm_scat(result->alert_msg, _b_msg);
+        }
+    #ifdef WIN32
+        else if (type == WM_SCA_TYPE_REGISTRY) {
+            /* Check windows registry */
+            found = wm_check_registry_entry(value, reason);
+
+            char _b_msg[OS_SIZE_1024 + 1];
+            _b_msg[OS_SIZE_1024] = '\0';
+            snprintf(_b_msg, OS_SIZE_1024, " Registry: %s", value);
+            append_msg_to_vm_scat(result->alert_msg, _b_msg);
+        }
+    #endif
+
+        /* Rule result processing */
+
+        if (found != RETURN_INVALID) {
+            found = rule_is_negated ^ found;
+        }
+
+        mdebug1("Result for rule '%s': %d", rule_ref->valuestring, found);
+
+        if (((condition & WM_SCA_COND_ALL) && found == RETURN_NOT_FOUND) ||
+            ((condition & WM_SCA_COND_ANY) && found == RETURN_FOUND) ||
+            ((condition & WM_SCA_COND_NON) && found == RETURN_FOUND))
+        {
+            g_found = found;
+            mdebug1("Breaking from rule aggregator '%s' with found = %d", c_condition->valuestring, g_found);
+            break;
+        }
+
+        if (found == RETURN_INVALID) {
+            /* Rules that agreggate by ANY are the only that can success after an INVALID
+            On the other hand ALL and NONE agregators can fail after an INVALID. */
+            g_found = found;
+            mdebug1("Rule evaluation returned INVALID. Continuing.");
+        }
+    }
+
+    if ((condition & WM_SCA_COND_NON) && g_found != RETURN_INVALID) {
+        g_found = !g_found;
+    }
+
+    mdebug1("Result for check %s '%s' -> %d", _check_id_str, c_title->valuestring, g_found);
+
+    if (g_found != RETURN_INVALID) {
+        os_free(*reason);
+    }
+
+    /* if the loop breaks, rule_cp shall be released.
+        Also frees the the memory reserved on the last iteration */
+    os_free(rule_cp);
+
+    result->g_found = g_found;
+    return WM_SCA_CHECK_EVALUATED;
+}
+
+/* Process rules share the list of processes, taken the first time a check needs it */
+static OSList *wm_sca_scan_process_list(wm_sca_scan_t * const scan)
+{
+    w_mutex_lock(&scan->mutex);
+
+    if (!scan->p_list_loaded) {
+        scan->p_list = w_os_get_process_list();
+        scan->p_list_loaded = 1;
+    }
+
+    w_mutex_unlock(&scan->mutex);
+    return scan->p_list;
+}
+
+#ifndef WIN32
+/* Workers take checks in policy order and leave their results for wm_sca_do_scan() */
+static void *wm_sca_scan_worker(wm_sca_scan_t * const scan)
+{
+    while (1) {
+        w_mutex_lock(&scan->mutex);
+
+        if (scan->aborted || !scan->next_check) {
+            w_mutex_unlock(&scan->mutex);
+            break;
+        }
+
+        const cJSON * const check = scan->next_check;
+        wm_sca_check_result_t * const result = &scan->results[scan->next_index++];
+        scan->next_check = check->next;
+
+        w_mutex_unlock(&scan->mutex);
+
+        const wm_sca_check_status_t status = wm_sca_evaluate_check(scan, check, result);
+
+        w_mutex_lock(&scan->mutex);
+        result->status = status;
+        if (status == WM_SCA_CHECK_ABORTED) {
+            scan->aborted = 1;
+        }
+        w_cond_broadcast(&scan->evaluated);
+        w_mutex_unlock(&scan->mutex);
+    }
+
+    return NULL;
+}
+#endif
+
+static int wm_sca_do_scan(cJSON *checks, OSStore *vars, wm_sca_t * data, int id,cJSON *policy,
+    int requirements_scan, int cis_db_index, unsigned int remote_policy, int first_scan, int *checks_number, char **sorted_variables)
+{
+    int ret_val = 0;
+    int workers = 0;
+    int check_index = 0;
+    wm_sca_scan_t scan;
+
+    memset(&scan, 0, sizeof(wm_sca_scan_t));
+    scan.data = data;
+    scan.vars = vars;
+    scan.policy = policy;
+    scan.sorted_variables = sorted_variables;
+    scan.requirements_scan = requirements_scan;
+    scan.remote_policy = remote_policy;
+    scan.next_check = checks ? checks->child : NULL;
+
+    const int checks_size = cJSON_GetArraySize(checks);
+    os_calloc(checks_size + 1, sizeof(wm_sca_check_result_t), scan.results);
+    w_mutex_init(&scan.mutex, NULL);
+    w_cond_init(&scan.evaluated, NULL);
+
+#ifndef WIN32
+    /* Requirements are a single check, and registry checks are not thread-safe on Windows */
+    pthread_t *threads = NULL;
+
+    if (!requirements_scan && data->scan_threads > 1 && checks_size > 1) {
+        const int threads_size = data->scan_threads < checks_size ? data->scan_threads : checks_size;
+        os_calloc(threads_size, sizeof(pthread_t), threads);
 
-            if (((condition & WM_SCA_COND_ALL) && found == RETURN_NOT_FOUND) ||
-                ((condition & WM_SCA_COND_ANY) && found == RETURN_FOUND) ||
-                ((condition & WM_SCA_COND_NON) && found == RETURN_FOUND))
-            {
-                g_found = found;
-                mdebug1("Breaking from rule aggregator '%s' with found = %d", c_condition->valuestring, g_found);
+        for (workers = 0; workers < threads_size; workers++) {
+            if (CreateThreadJoinable(&threads[workers], (void *(*)(void *))wm_sca_scan_worker, &scan) < 0) {
                 break;
             }
+        }
+    }
+#endif
+
+    int check_count = 0;
+    cJSON *check = NULL;
+    cJSON_ArrayForEach(check, checks) {
+        wm_sca_check_result_t * const result = &scan.results[check_index++];
 
-            if (found == RETURN_INVALID) {
-                /* Rules that agreggate by ANY are the only that can success after an INVALID
-                On the other hand ALL and NONE agregators can fail after an INVALID. */
-                g_found = found;
-                mdebug1("Rule evaluation returned INVALID. Continuing.");
+        if (workers) {
+            w_mutex_lock(&scan.mutex);
+            while (result->status == WM_SCA_CHECK_PENDING) {
+                w_cond_wait(&scan.evaluated, &scan.mutex);
             }
+            w_mutex_unlock(&scan.mutex);
+        } else {
+            result->status = wm_sca_evaluate_check(&scan, check, result);
         }
 
-        if ((condition & WM_SCA_COND_NON) && g_found != RETURN_INVALID) {
-            g_found = !g_found;
-        }
+        switch (result->status) {
+        case WM_SCA_CHECK_INVALID_ID:
+            merror("Skipping check. Check ID is invalid. Offending check number: %d", check_count);
+            ret_val = 1;
+            continue;
 
-        mdebug1("Result for check %s '%s' -> %d", _check_id_str, c_title->valuestring, g_found);
+        case WM_SCA_CHECK_SKIPPED:
+            if (requirements_scan) {
+                ret_val = 1;
+                goto clean_return;
+            }
+            continue;
+
+        case WM_SCA_CHECK_ABORTED:
+            ret_val = 1;
+            goto clean_return;
 
-        if (g_found != RETURN_INVALID) {
-            os_free(reason);
+        default:
+            break;
         }
 
-        /* if the loop breaks, rule_cp shall be released.
-            Also frees the the memory reserved on the last iteration */
-        os_free(rule_cp);
+        const int g_found = result->g_found;
 
         /* Determine if requirements are satisfied */
         if (requirements_scan) {
             /*  return value for requirement scans is the inverse of the result,
                 unless the result is INVALID */
             ret_val = g_found == RETURN_INVALID ? 1 : !g_found;
-            int i;
-            for (i=0; data->alert_msg[i]; i++){
-                free(data->alert_msg[i]);
-                data->alert_msg[i] = NULL;
-            }
             goto clean_return;
         }
 
@@ -1290,14 +1503,14 @@ static int wm_sca_do_scan(cJSON *checks, OSStore *vars, wm_sca_t * data, int id,
             wm_sca_summary_increment_invalid();
             message_ref = invalid;
 
-            if (reason == NULL) {
-                os_malloc(OS_MAXSTR, reason);
-                sprintf(reason, "Unknown reason");
+            if (result->reason == NULL) {
+                os_malloc(OS_MAXSTR, result->reason);
+                sprintf(result->reason, "Unknown reason");
                 mdebug1("A check returned INVALID for an unknown reason.");
             }
         }
 
-        cJSON *event = wm_sca_build_event(check, policy, data->alert_msg, id, message_ref, reason);
+        cJSON *event = wm_sca_build_event(check, policy, result->alert_msg, id, message_ref, result->reason);
         if (event) {
             /* Alert if necessary */
             if(!cis_db_for_hash[cis_db_index].elem[check_count]) {
@@ -1314,25 +1527,39 @@ static int wm_sca_do_scan(cJSON *checks, OSStore *vars, wm_sca_t * data, int id,
 
             cJSON_Delete(event);
         } else {
+            const cJSON * const c_title = cJSON_GetObjectItem(check, "title");
             merror("Error constructing event for check: %s. Set debug mode for more information.", c_title->valuestring);
             ret_val = 1;
         }
 
-        int i;
-        for (i=0; data->alert_msg[i]; i++){
-            free(data->alert_msg[i]);
-            data->alert_msg[i] = NULL;
-        }
-
-        os_free(reason);
+        wm_sca_free_check_result(result);
     }
 
     *checks_number = check_count;
 
 /* Clean up memory */
 clean_return:
-    os_free(reason);
-    w_del_plist(p_list);
+#ifndef WIN32
+    if (threads) {
+        w_mutex_lock(&scan.mutex);
+        scan.aborted = 1;
+        w_mutex_unlock(&scan.mutex);
+
+        while (workers > 0) {
+            pthread_join(threads[--workers], NULL);
+        }
+        os_free(threads);
+    }
+#endif
+
+    for (check_index = 0; check_index < checks_size; check_index++) {
+        wm_sca_free_check_result(&scan.results[check_index]);
+    }
+    os_free(scan.results);
+
+    w_del_plist(scan.p_list);
+    w_cond_destroy(&scan.evaluated);
+    w_mutex_destroy(&scan.mutex);
 
     return ret_val;
 }
@@ -1495,6 +1722,34 @@ static int wm_sca_check_file_contents(const char * const file, const char * cons
     }
     #endif
 
+    int result = RETURN_NOT_FOUND;
+    const wm_sca_file_t * const contents = wm_sca_get_file(realpath_buffer);
+
+    if (contents) {
+        if (contents->error) {
+            if (*reason == NULL) {
+                os_malloc(OS_MAXSTR, *reason);
+                sprintf(*reason, "Could not open file '%s': %s", file, strerror(contents->error));
+            }
+            mdebug2("Could not open file '%s': %s", file, strerror(contents->error));
+            return RETURN_INVALID;
+        }
+
+        char **line;
+        for (line = contents->lines; *line; line++) {
+            result = wm_sca_pattern_matches(*line, pattern, reason);
+            mdebug2("(%s)(%s) -> %d", pattern, **line != '\0' ? *line : "EMPTY_LINE" , result);
+
+            if (result) {
+                mdebug2("Match found. Skipping the rest.");
+                break;
+            }
+        }
+
+        mdebug2("Result for (%s)(%s) -> %d", pattern, file, result);
+        return result;
+    }
+
     FILE *fp = fopen(realpath_buffer, "r");
     const int fopen_errno = errno;
     if (!fp) {
@@ -1506,7 +1761,6 @@ static int wm_sca_check_file_contents(const char * const file, const char * cons
         return RETURN_INVALID;
     }
 
-    int result = RETURN_NOT_FOUND;
     char buf[OS_SIZE_2048 + 1];
     while (fgets(buf, OS_SIZE_2048, fp) != NULL) {
         os_trimcrlf(buf);
@@ -1634,68 +1888,58 @@ static int wm_sca_read_command(char *command, char *pattern, wm_sca_t * data, ch
     }
 
     mdebug1("Executing command '%s', and testing output with pattern '%s'", command, pattern);
-    char *cmd_output = NULL;
-    int result_code;
+    wm_sca_command_t * const output = wm_sca_get_command(command, data);
+    int result = RETURN_NOT_FOUND;
 
-    switch (wm_exec(command, &cmd_output, &result_code, data->commands_timeout, NULL)) {
+    switch (output->status) {
     case 0:
-        mdebug1("Command '%s' returned code %d", command, result_code);
+        mdebug1("Command '%s' returned code %d", command, output->result_code);
         break;
     case WM_ERROR_TIMEOUT:
-        os_free(cmd_output);
         mdebug1("Timeout overtaken running command '%s'", command);
         if (*reason == NULL) {
             os_malloc(OS_MAXSTR, *reason);
             sprintf(*reason, "Timeout overtaken running command '%s'", command);
         }
-        os_free(cmd_output);
-        return RETURN_INVALID;
+        result = RETURN_INVALID;
+        goto end;
     default:
-        if (result_code == EXECVE_ERROR) {
+        if (output->result_code == EXECVE_ERROR) {
             mdebug1("Invalid path or wrong permissions to run command '%s'", command);
             if (*reason == NULL) {
                 os_malloc(OS_MAXSTR, *reason);
                 sprintf(*reason, "Invalid path or wrong permissions to run command '%s'", command);
             }
         } else {
-            mdebug1("Failed to run command '%s'. Returned code %d", command, result_code);
+            mdebug1("Failed to run command '%s'. Returned code %d", command, output->result_code);
             if (*reason == NULL) {
                 os_malloc(OS_MAXSTR, *reason);
-                sprintf(*reason, "Failed to run command '%s'. Returned code %d", command, result_code);
+                sprintf(*reason, "Failed to run command '%s'. Returned code %d", command, output->result_code);
             }
         }
-        return RETURN_INVALID;
+        result = RETURN_INVALID;
+        goto end;
     }
 
-    if(!cmd_output) {
+    if (!output->lines) {
         mdebug2("Command yielded no output. Returning.");
-        return RETURN_NOT_FOUND;
+        goto end;
     }
 
-    char **output_line;
-    output_line = OS_StrBreak('\n', cmd_output, 256);
-
-    if(!output_line) {
-        mdebug1("Command output could not be processed. Output dump:\n%s", cmd_output);
-        os_free(cmd_output);
-        return RETURN_NOT_FOUND;
-    }
-
-    os_free(cmd_output);
-
     int i;
-    int result = RETURN_NOT_FOUND;
-    for (i=0; output_line[i] != NULL; i++) {
-        char *buf = output_line[i];
-        os_trimcrlf(buf);
-        result = wm_sca_pattern_matches(buf, pattern, reason);
+    for (i = 0; output->lines[i] != NULL; i++) {
+        result = wm_sca_pattern_matches(output->lines[i], pattern, reason);
         if (result == RETURN_FOUND){
             break;
         }
     }
 
-    free_strarray(output_line);
     mdebug2("Result for (%s)(%s) -> %d", pattern, command, result);
+
+end:
+    if (!output->cached) {
+        wm_sca_free_command(output);
+    }
     return result;
 }
 
@@ -1712,53 +1956,66 @@ static int wm_sca_apply_numeric_partial_comparison(const char * const partial_co
 
     mdebug2("Partial comparison '%s'", partial_comparison);
 
-    OSRegex regex;
-    if (!OSRegex_Compile("(\\d+)", &regex, OS_RETURN_SUBSTRING)) {
+    wm_sca_pattern_t * const number_regex = wm_sca_get_compiled_pattern(WM_SCA_PATTERN_SUBSTRINGS, "(\\d+)");
+    regex_matching match;
+    long int value_given = 0;
+    int result = RETURN_INVALID;
+
+    memset(&match, 0, sizeof(regex_matching));
+
+    if (!number_regex->compiled) {
         if (*reason == NULL) {
             os_malloc(OS_MAXSTR, *reason);
             sprintf(*reason, "Cannot compile regex.");
         }
         mwarn("Cannot compile regex");
-        return RETURN_INVALID;
+        goto end;
     }
 
-    if (!OSRegex_Execute(partial_comparison, &regex)) {
+    if (!OSRegex_Execute_ex(partial_comparison, &number_regex->regex, &match)) {
         if (*reason == NULL) {
             os_malloc(OS_MAXSTR, *reason);
             sprintf(*reason, "No integer was found within the comparison '%s' ", partial_comparison);
         }
         mwarn("No integer was found within the comparison '%s' ", partial_comparison);
-        OSRegex_FreePattern(&regex);
-        return RETURN_INVALID;
+        goto end;
     }
 
-    if (!regex.d_sub_strings[0]) {
+    if (!match.sub_strings || !match.sub_strings[0]) {
         if (*reason == NULL) {
             os_malloc(OS_MAXSTR, *reason);
             sprintf(*reason, "No number was captured.");
         }
         mwarn("No number was captured.");
-        OSRegex_FreePattern(&regex);
-        return RETURN_INVALID;
+        goto end;
     }
 
-    mdebug2("Value given for comparison: '%s'", regex.d_sub_strings[0]);
+    mdebug2("Value given for comparison: '%s'", match.sub_strings[0]);
 
     errno = 0;
     char *strtol_end_ptr = NULL;
-    const long int value_given = strtol(regex.d_sub_strings[0], &strtol_end_ptr, 10);
+    value_given = strtol(match.sub_strings[0], &strtol_end_ptr, 10);
 
-    if (errno != 0 || strtol_end_ptr == regex.d_sub_strings[0]) {
+    if (errno != 0 || strtol_end_ptr == match.sub_strings[0]) {
         if (*reason == NULL) {
             os_malloc(OS_MAXSTR, *reason);
-            sprintf(*reason, "Conversion error. Cannot convert '%s' to integer.", regex.d_sub_strings[0]);
+            sprintf(*reason, "Conversion error. Cannot convert '%s' to integer.", match.sub_strings[0]);
         }
-        mwarn("Conversion error. Cannot convert '%s' to integer.", regex.d_sub_strings[0]);
-        OSRegex_FreePattern(&regex);
-        return RETURN_INVALID;
+        mwarn("Conversion error. Cannot convert '%s' to integer.", match.sub_strings[0]);
+        goto end;
+    }
+
+    result = RETURN_FOUND;
+
+end:
+    OSRegex_free_regex_matching(&match);
+    if (!number_regex->cached) {
+        wm_sca_free_pattern(number_regex);
     }
 
-    OSRegex_FreePattern(&regex);
+    if (result == RETURN_INVALID) {
+        return result;
+    }
 
     mdebug2("Value converted: '%ld'", value_given);
 
@@ -1810,58 +2067,68 @@ int wm_sca_regex_numeric_comparison (const char * const pattern, const char *con
     partial_comparison_ref += 9;
     mdebug2("REGEX: '%s'. Partial comparison: '%s'", pattern_copy_ref, partial_comparison_ref);
 
-    OSRegex regex;
-    memset(&regex, 0, sizeof(OSRegex));
-    if (!OSRegex_Compile(pattern_copy_ref, &regex, OS_RETURN_SUBSTRING)) {
+    wm_sca_pattern_t * const regex = wm_sca_get_compiled_pattern(WM_SCA_PATTERN_SUBSTRINGS, pattern_copy_ref);
+    regex_matching match;
+    long int value_captured = 0;
+    int result = RETURN_INVALID;
+
+    memset(&match, 0, sizeof(regex_matching));
+
+    if (!regex->compiled) {
         mdebug2("Cannot compile regex '%s'", pattern_copy_ref);
         if (*reason == NULL) {
             os_malloc(OS_MAXSTR, *reason);
             sprintf(*reason, "Cannot compile regex '%s'", pattern_copy_ref);
         }
-        os_free(pattern_copy);
-        return RETURN_INVALID;
+        goto end;
     }
 
-    if (!OSRegex_Execute(str, &regex)) {
+    if (!OSRegex_Execute_ex(str, &regex->regex, &match)) {
         mdebug2("No match found for regex '%s'", pattern_copy_ref);
-        os_free(pattern_copy);
-        OSRegex_FreePattern(&regex);
-        return RETURN_NOT_FOUND;
+        result = RETURN_NOT_FOUND;
+        goto end;
     }
 
-    if (!regex.d_sub_strings[0]) {
+    if (!match.sub_strings || !match.sub_strings[0]) {
         mdebug2("Regex '%s' matched, but no string was captured by it. Did you forget specifying a capture group?", pattern_copy_ref);
         if (*reason == NULL) {
             os_malloc(OS_MAXSTR, *reason);
             sprintf(*reason, "Regex '%s' matched, but no string was captured by it. Did you forget specifying a capture group?", pattern_copy_ref);
         }
-        os_free(pattern_copy);
-        OSRegex_FreePattern(&regex);
-        return RETURN_INVALID;
+        goto end;
     }
 
-    mdebug2("Captured value: '%s'", regex.d_sub_strings[0]);
+    mdebug2("Captured value: '%s'", match.sub_strings[0]);
 
     errno = 0;
     char *strtol_end_ptr = NULL;
-    const long int value_captured = strtol(regex.d_sub_strings[0], &strtol_end_ptr, 10);
+    value_captured = strtol(match.sub_strings[0], &strtol_end_ptr, 10);
 
-    if (errno != 0 || strtol_end_ptr == regex.d_sub_strings[0]) {
-        mdebug2("Conversion error. Cannot convert '%s' to integer.", regex.d_sub_strings[0]);
+    if (errno != 0 || strtol_end_ptr == match.sub_strings[0]) {
+        mdebug2("Conversion error. Cannot convert '%s' to integer.", match.sub_strings[0]);
         if (*reason == NULL) {
             os_malloc(OS_MAXSTR, *reason);
-            sprintf(*reason, "Conversion error. Cannot convert '%s' to integer.", regex.d_sub_strings[0]);
+            sprintf(*reason, "Conversion error. Cannot convert '%s' to integer.", match.sub_strings[0]);
         }
-        os_free(pattern_copy);
-        OSRegex_FreePattern(&regex);
-        return RETURN_INVALID;
+        goto end;
     }
 
-    OSRegex_FreePattern(&regex);
+    result = RETURN_FOUND;
+
+end:
+    OSRegex_free_regex_matching(&match);
+    if (!regex->cached) {
+        wm_sca_free_pattern(regex);
+    }
+
+    if (result != RETURN_FOUND) {
+        os_free(pattern_copy);
+        return result;
+    }
 
     mdebug2("Converted value: '%ld'", value_captured);
 
-    const int result = wm_sca_apply_numeric_partial_comparison(partial_comparison_ref, value_captured, reason);
+    result = wm_sca_apply_numeric_partial_comparison(partial_comparison_ref, value_captured, reason);
     mdebug2("Comparison result '%ld %s' -> %d", value_captured, partial_comparison_ref, result);
 
     os_free(pattern_copy);
@@ -1873,7 +2140,7 @@ int wm_sca_test_positive_minterm(char * const minterm, const char * const str, c
     const char *pattern_ref = minterm;
     if (strncasecmp(pattern_ref, "r:", 2) == 0) {
         pattern_ref += 2;
-        if (OS_Regex(pattern_ref, str)) {
+        if (wm_sca_regex_matches(pattern_ref, str)) {
             return RETURN_FOUND;
         }
     } else if (strncasecmp(pattern_ref, "n:", 2) == 0) {
@@ -1970,36 +2237,34 @@ static int wm_sca_check_dir(const char * const dir, const char * const file, cha
     }
     #endif
 
-    DIR *dp = opendir(realpath_buffer);
-    if (!dp) {
-        const int open_dir_errno = errno;
+    wm_sca_dir_t * const listing = wm_sca_get_dir(realpath_buffer);
+    if (listing->error) {
         if (*reason == NULL) {
             os_malloc(OS_MAXSTR, *reason);
-            sprintf(*reason, "Could not open '%s': %s", dir, strerror(open_dir_errno));
+            sprintf(*reason, "Could not open '%s': %s", dir, strerror(listing->error));
+        }
+        mdebug2("Could not open '%s': %s", dir, strerror(listing->error));
+        if (!listing->cached) {
+            wm_sca_free_dir(listing);
         }
-        mdebug2("Could not open '%s': %s", dir, strerror(open_dir_errno));
         return RETURN_INVALID;
     }
 
     int result_accumulator = RETURN_NOT_FOUND;
-    struct dirent *entry = NULL;
+    size_t i;
 
-    while ((entry = readdir(dp)) != NULL) {
-        /* Ignore . and ..  */
-        if ((strcmp(entry->d_name, ".") == 0) || (strcmp(entry->d_name, "..") == 0)) {
-            continue;
-        }
+    for (i = 0; i < listing->size; i++) {
+        const wm_sca_dir_entry_t * const entry = &listing->entries[i];
 
         /* Create new file + path string */
         char f_name[PATH_MAX + 2];
         f_name[PATH_MAX + 1] = '\0';
-        snprintf(f_name, PATH_MAX + 1, "%s/%s", dir, entry->d_name);
+        snprintf(f_name, PATH_MAX + 1, "%s/%s", dir, entry->name);
 
         mdebug2("Considering directory entry '%s'", f_name);
 
         int result;
-        struct stat statbuf_local;
-        if (lstat(f_name, &statbuf_local) != 0) {
+        if (entry->is_dir < 0) {
             mdebug2("Cannot check directory entry '%s'", f_name);
             if (*reason == NULL){
                 os_malloc(OS_MAXSTR, *reason);
@@ -2009,10 +2274,10 @@ static int wm_sca_check_dir(const char * const dir, const char * const file, cha
             continue;
         }
 
-        if (S_ISDIR(statbuf_local.st_mode)) {
+        if (entry->is_dir) {
             result = wm_sca_check_dir(f_name, file, pattern, reason);
-        } else if (((file && strncasecmp(file, "r:", 2) == 0) && OS_Regex(file + 2, entry->d_name))
-                || OS_Match2(file, entry->d_name))
+        } else if (((file && strncasecmp(file, "r:", 2) == 0) && wm_sca_regex_matches(file + 2, entry->name))
+                || wm_sca_match_matches(file, entry->name))
         {
             result = wm_sca_check_file_list(f_name, pattern, reason);
         } else {
@@ -2031,7 +2296,9 @@ static int wm_sca_check_dir(const char * const dir, const char * const file, cha
         }
     }
 
-    closedir(dp);
+    if (!listing->cached) {
+        wm_sca_free_dir(listing);
+    }
     mdebug2("Check result for dir '%s': %d", dir, result_accumulator);
     return result_accumulator;
 }
@@ -2050,20 +2317,403 @@ static int wm_sca_check_process_is_running(OSList *p_list, char *value, char **r
         return RETURN_NOT_FOUND;
     }
 
-    OSListNode *l_node = OSList_GetFirstNode(p_list);
-    while (l_node) {
+    /* The list is shared by the checks of the scan, so walk it without moving its cursor */
+    OSListNode *l_node;
+    for (l_node = p_list->first_node; l_node; l_node = l_node->next) {
         W_Proc_Info *pinfo = (W_Proc_Info *)l_node->data;
         /* Check if value matches */
         if (wm_sca_pattern_matches(pinfo->p_path, value, reason)) {
             return RETURN_FOUND;
         }
-
-        l_node = OSList_GetNextNode(p_list);
     }
 
     return RETURN_NOT_FOUND;
 }
 
+static void wm_sca_scan_cache_init()
+{
+    os_calloc(1, sizeof(wm_sca_scan_cache_t), scan_cache);
+
+    scan_cache->files = OSHash_Create();
+    scan_cache->commands = OSHash_Create();
+    scan_cache->dirs = OSHash_Create();
+    scan_cache->patterns = OSHash_Create();
+
+    if (!scan_cache->files || !scan_cache->commands || !scan_cache->dirs || !scan_cache->patterns) {
+        merror(LIST_ERROR);
+        wm_sca_scan_cache_free();
+        return;
+    }
+
+    OSHash_SetFreeDataPointer(scan_cache->files, (void (*)(void *))wm_sca_free_file);
+    OSHash_SetFreeDataPointer(scan_cache->commands, (void (*)(void *))wm_sca_free_command);
+    OSHash_SetFreeDataPointer(scan_cache->dirs, (void (*)(void *))wm_sca_free_dir);
+    OSHash_SetFreeDataPointer(scan_cache->patterns, (void (*)(void *))wm_sca_free_pattern);
+
+    w_mutex_init(&scan_cache->mutex, NULL);
+    w_cond_init(&scan_cache->available, NULL);
+    scan_cache->synchronized = 1;
+}
+
+static void wm_sca_scan_cache_free()
+{
+    if (!scan_cache) {
+        return;
+    }
+
+    mdebug1("Scan inputs: %u files, %u commands, %u directories, %u patterns.",
+        scan_cache->files ? scan_cache->files->elements : 0, scan_cache->commands ? scan_cache->commands->elements : 0,
+        scan_cache->dirs ? scan_cache->dirs->elements : 0, scan_cache->patterns ? scan_cache->patterns->elements : 0);
+
+    if (scan_cache->files) {
+        OSHash_Free(scan_cache->files);
+    }
+    if (scan_cache->commands) {
+        OSHash_Free(scan_cache->commands);
+    }
+    if (scan_cache->dirs) {
+        OSHash_Free(scan_cache->dirs);
+    }
+    if (scan_cache->patterns) {
+        OSHash_Free(scan_cache->patterns);
+    }
+    if (scan_cache->synchronized) {
+        w_cond_destroy(&scan_cache->available);
+        w_mutex_destroy(&scan_cache->mutex);
+    }
+
+    os_free(scan_cache);
+}
+
+/* Returns the lines of a file, or NULL if it must be read line by line */
+static wm_sca_file_t *wm_sca_get_file(const char * const path)
+{
+    wm_sca_file_t *contents;
+
+    if (!scan_cache || !scan_cache->files) {
+        return NULL;
+    }
+
+    if (contents = OSHash_Get_ex(scan_cache->files, path), contents) {
+        return contents;
+    }
+
+    FILE *fp = fopen(path, "r");
+    const int fopen_errno = errno;
+    os_calloc(1, sizeof(wm_sca_file_t), contents);
+
+    if (!fp) {
+        contents->error = fopen_errno;
+    } else {
+        struct stat statbuf;
+        if (fstat(fileno(fp), &statbuf) == 0 && statbuf.st_size > WM_SCA_CACHE_FILE_MAX) {
+            mdebug2("File '%s' is too large to keep it during the scan.", path);
+            fclose(fp);
+            os_free(contents);
+            return NULL;
+        }
+
+        char buf[OS_SIZE_2048 + 1];
+        size_t size = 0;
+        size_t allocated = 16;
+
+        os_calloc(allocated, sizeof(char *), contents->lines);
+
+        while (fgets(buf, OS_SIZE_2048, fp) != NULL) {
+            os_trimcrlf(buf);
+
+            if (size + 1 == allocated) {
+                allocated *= 2;
+                os_realloc(contents->lines, allocated * sizeof(char *), contents->lines);
+            }
+
+            os_strdup(buf, contents->lines[size++]);
+            contents->lines[size] = NULL;
+        }
+
+        fclose(fp);
+    }
+
+    /* Other workers may use the entry as soon as it is added */
+    contents->cached = 1;
+
+    switch (OSHash_Add_ex(scan_cache->files, path, contents)) {
+    case 2:
+        return contents;
+    case 1:
+        /* Another check read the file at the same time: keep its copy */
+        wm_sca_free_file(contents);
+        return OSHash_Get_ex(scan_cache->files, path);
+    default:
+        wm_sca_free_file(contents);
+        return NULL;
+    }
+}
+
+static void wm_sca_free_file(wm_sca_file_t *contents)
+{
+    if (contents) {
+        free_strarray(contents->lines);
+        os_free(contents);
+    }
+}
+
+static void wm_sca_run_command(char * const command, wm_sca_t * const data, wm_sca_command_t * const output)
+{
+    char *cmd_output = NULL;
+
+    output->status = wm_exec(command, &cmd_output, &output->result_code, data->commands_timeout, NULL);
+
+    if (output->status == 0 && cmd_output) {
+        if (output->lines = OS_StrBreak('\n', cmd_output, 256), output->lines) {
+            int i;
+            for (i = 0; output->lines[i]; i++) {
+                os_trimcrlf(output->lines[i]);
+            }
+        } else {
+            mdebug1("Command output could not be processed. Output dump:\n%s", cmd_output);
+        }
+    }
+
+    os_free(cmd_output);
+}
+
+/* Runs a command once per scan, with at most max_running_commands at the same time */
+static wm_sca_command_t *wm_sca_get_command(char * const command, wm_sca_t * const data)
+{
+    wm_sca_command_t *output;
+
+    if (!scan_cache || !scan_cache->commands) {
+        os_calloc(1, sizeof(wm_sca_command_t), output);
+        wm_sca_run_command(command, data, output);
+        return output;
+    }
+
+    w_mutex_lock(&scan_cache->mutex);
+
+    /* Another check may be running this command: wait for its output */
+    while (output = OSHash_Get(scan_cache->commands, command), output && output->running) {
+        w_cond_wait(&scan_cache->available, &scan_cache->mutex);
+    }
+
+    if (output) {
+        w_mutex_unlock(&scan_cache->mutex);
+        mdebug2("Reusing the output of command '%s'", command);
+        return output;
+    }
+
+    os_calloc(1, sizeof(wm_sca_command_t), output);
+    output->running = 1;
+
+    if (OSHash_Add(scan_cache->commands, command, output) == 2) {
+        output->cached = 1;
+    }
+
+    while (data->max_running_commands > 0 && scan_cache->running_commands >= data->max_running_commands) {
+        w_cond_wait(&scan_cache->available, &scan_cache->mutex);
+    }
+
+    scan_cache->running_commands++;
+    w_mutex_unlock(&scan_cache->mutex);
+
+    wm_sca_run_command(command, data, output);
+
+    w_mutex_lock(&scan_cache->mutex);
+    scan_cache->running_commands--;
+    output->running = 0;
+    w_cond_broadcast(&scan_cache->available);
+    w_mutex_unlock(&scan_cache->mutex);
+
+    return output;
+}
+
+static void wm_sca_free_command(wm_sca_command_t *output)
+{
+    if (output) {
+        free_strarray(output->lines);
+        os_free(output);
+    }
+}
+
+static wm_sca_dir_t *wm_sca_get_dir(const char * const path)
+{
+    wm_sca_dir_t *listing;
+
+    if (scan_cache && scan_cache->dirs && (listing = OSHash_Get_ex(scan_cache->dirs, path), listing)) {
+        return listing;
+    }
+
+    os_calloc(1, sizeof(wm_sca_dir_t), listing);
+
+    DIR *dp = opendir(path);
+    if (!dp) {
+        listing->error = errno;
+    } else {
+        struct dirent *entry = NULL;
+        size_t allocated = 0;
+
+        while ((entry = readdir(dp)) != NULL) {
+            /* Ignore . and ..  */
+            if ((strcmp(entry->d_name, ".") == 0) || (strcmp(entry->d_name, "..") == 0)) {
+                continue;
+            }
+
+            if (listing->size == allocated) {
+                allocated = allocated ? allocated * 2 : 16;
+                os_realloc(listing->entries, allocated * sizeof(wm_sca_dir_entry_t), listing->entries);
+            }
+
+            char f_name[PATH_MAX + 2];
+            f_name[PATH_MAX + 1] = '\0';
+            snprintf(f_name, PATH_MAX + 1, "%s/%s", path, entry->d_name);
+
+            struct stat statbuf_local;
+            wm_sca_dir_entry_t * const dir_entry = &listing->entries[listing->size++];
+            os_strdup(entry->d_name, dir_entry->name);
+            dir_entry->is_dir = lstat(f_name, &statbuf_local) != 0 ? -1 : S_ISDIR(statbuf_local.st_mode) ? 1 : 0;
+        }
+
+        closedir(dp);
+    }
+
+    if (scan_cache && scan_cache->dirs) {
+        /* Other workers may use the entry as soon as it is added */
+        listing->cached = 1;
+
+        switch (OSHash_Add_ex(scan_cache->dirs, path, listing)) {
+        case 2:
+            break;
+        case 1:
+            /* Another check listed the directory at the same time: keep its copy */
+            wm_sca_free_dir(listing);
+            listing = OSHash_Get_ex(scan_cache->dirs, path);
+            break;
+        default:
+            listing->cached = 0;
+        }
+    }
+
+    return listing;
+}
+
+static void wm_sca_free_dir(wm_sca_dir_t *listing)
+{
+    size_t i;
+
+    if (listing) {
+        for (i = 0; i < listing->size; i++) {
+            os_free(listing->entries[i].name);
+        }
+        os_free(listing->entries);
+        os_free(listing);
+    }
+}
+
+static wm_sca_pattern_t *wm_sca_get_compiled_pattern(const char type, const char * const pattern)
+{
+    wm_sca_pattern_t *compiled = NULL;
+    char *key = NULL;
+
+    if (scan_cache && scan_cache->patterns) {
+        os_malloc(strlen(pattern) + 3, key);
+        sprintf(key, "%c:%s", type, pattern);
+
+        if (compiled = OSHash_Get_ex(scan_cache->patterns, key), compiled) {
+            os_free(key);
+            return compiled;
+        }
+    }
+
+    os_calloc(1, sizeof(wm_sca_pattern_t), compiled);
+    compiled->type = type;
+
+    switch (type) {
+    case WM_SCA_PATTERN_MATCH:
+        compiled->compiled = OSMatch_Compile(pattern, &compiled->match, 0);
+        break;
+    case WM_SCA_PATTERN_SUBSTRINGS:
+        compiled->compiled = OSRegex_Compile(pattern, &compiled->regex, OS_RETURN_SUBSTRING);
+        break;
+    default:
+        compiled->compiled = OSRegex_Compile(pattern, &compiled->regex, 0);
+    }
+
+    if (key) {
+        /* Other workers may use the entry as soon as it is added */
+        compiled->cached = 1;
+
+        switch (OSHash_Add_ex(scan_cache->patterns, key, compiled)) {
+        case 2:
+            break;
+        case 1:
+            /* Another check compiled the pattern at the same time: keep its copy */
+            wm_sca_free_pattern(compiled);
+            compiled = OSHash_Get_ex(scan_cache->patterns, key);
+            break;
+        default:
+            compiled->cached = 0;
+        }
+        os_free(key);
+    }
+
+    return compiled;
+}
+
+static void wm_sca_free_pattern(wm_sca_pattern_t *compiled)
+{
+    if (!compiled) {
+        return;
+    }
+
+    if (compiled->compiled) {
+        if (compiled->type == WM_SCA_PATTERN_MATCH) {
+            OSMatch_FreePattern(&compiled->match);
+        } else {
+            OSRegex_FreePattern(&compiled->regex);
+        }
+    }
+
+    os_free(compiled);
+}
+
+/* Same as OS_Regex(), but the pattern is compiled once per scan */
+static int wm_sca_regex_matches(const char * const pattern, const char * const str)
+{
+    wm_sca_pattern_t * const compiled = wm_sca_get_compiled_pattern(WM_SCA_PATTERN_REGEX, pattern);
+    regex_matching match;
+    int result = 0;
+
+    memset(&match, 0, sizeof(regex_matching));
+
+    if (compiled->compiled && OSRegex_Execute_ex(str, &compiled->regex, &match)) {
+        result = 1;
+    }
+
+    OSRegex_free_regex_matching(&match);
+    if (!compiled->cached) {
+        wm_sca_free_pattern(compiled);
+    }
+
+    return result;
+}
+
+/* Same as OS_Match2(), but the pattern is compiled once per scan */
+static int wm_sca_match_matches(const char * const pattern, const char * const str)
+{
+    wm_sca_pattern_t * const compiled = wm_sca_get_compiled_pattern(WM_SCA_PATTERN_MATCH, pattern);
+    int result = 0;
+
+    if (compiled->compiled && OSMatch_Execute(str, strlen(str), &compiled->match)) {
+        result = 1;
+    }
+
+    if (!compiled->cached) {
+        wm_sca_free_pattern(compiled);
+    }
+
+    return result;
+}
+
 // Destroy data
 void wm_sca_destroy(wm_sca_t * data) {
     os_free(data);
@@ -3152,20 +3802,20 @@ cJSON *wm_sca_dump(const wm_sca_t *data) {
     return root;
 }
 
-static int append_msg_to_vm_scat (wm_sca_t * const data, const char * const msg)
+static int append_msg_to_vm_scat (char **alert_msg, const char * const msg)
 {
     /* Already present */
-    if (w_is_str_in_array(data->alert_msg, msg)) {
+    if (w_is_str_in_array(alert_msg, msg)) {
         return 1;
     }
 
     int i = 0;
-    while (data->alert_msg[i] && (i < 255)) {
+    while (alert_msg[i] && (i < 255)) {
         i++;
     }
 
-    if (!data->alert_msg[i]) {
-        os_strdup(msg, data->alert_msg[i]);
+    if (!alert_msg[i]) {
+        os_strdup(msg, alert_msg[i]);
     }
     return 0;
 }
@@ -49,6 +49,8 @@ typedef struct wm_sca_t {
     int queue;
     int remote_commands:1;
     int commands_timeout;
+    int scan_threads;
+    int max_running_commands;
     sched_scan_config scan_config;
 } wm_sca_t;
 